@@ -3,6 +3,7 @@
 //          Kept: Method channel, audio control, P2P connection
 //
 import 'dart:async';
+import 'dart:typed_data';
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 
@@ -81,6 +82,10 @@ Future<dynamic> _handleMethodCall(MethodCall call) async {
       case 'setMute':
         return await _setMute(call.arguments);
 
+      // ===== Camera CGI =====
+      case 'writeCgi':
+        return await _writeCgi(call.arguments);
+
       // ===== Utility =====
       default:
         print('[VeepaAudio] ❌ Unknown method: ${call.method}');
@@ -279,3 +284,66 @@ Future<bool> _setMute(dynamic arguments) async {
 
   return result;
 }
+
+// ===== Camera CGI Methods =====
+
+/// Serialises CGI round trips: responses arrive on the client's command
+/// listener without the request they answer, so one is in flight at a time
+Future<void> _cgiQueue = Future.value();
+
+/// Send a CGI command and return the camera's text response
+/// (`var name=value;` lines)
+Future<Map<String, dynamic>> _writeCgi(dynamic arguments) {
+  final done = _cgiQueue.then((_) => _writeCgiNow(arguments));
+  _cgiQueue = done.then((_) {}, onError: (_) {});
+  return done;
+}
+
+/// Command id of each CGI's response, keyed by CGI name: get_status.cgi as
+/// documented by the SDK, others learned from their first reply. A write
+/// only accepts a response carrying its CGI's id once that id is known.
+final Map<String, int> _cgiResponseCommands = {'get_status.cgi': 24577};
+
+Future<Map<String, dynamic>> _writeCgiNow(dynamic arguments) async {
+  final Map<String, dynamic> args = Map<String, dynamic>.from(arguments);
+  final String cgi = args['cgi'] as String;
+  final int timeout = args['timeout'] as int? ?? 5;
+  final String name = cgi.split('?').first;
+  final int? expected = args['cmd'] as int? ?? _cgiResponseCommands[name];
+
+  if (_p2pApi == null || _clientPtr == null) {
+    return {'success': false, 'error': 'Not connected'};
+  }
+  final api = _p2pApi!;
+  final clientPtr = _clientPtr!;
+
+  print('[VeepaAudio] _writeCgi: $cgi');
+  final response = Completer<String>();
+  api.setCommandListener(clientPtr, (int cmd, Uint8List data) {
+    if (response.isCompleted) return;
+    if (expected != null && cmd != expected) {
+      print('[VeepaAudio] Ignoring command $cmd while waiting for $expected ($name)');
+      return;
+    }
+    _cgiResponseCommands[name] ??= cmd;
+    response.complete(String.fromCharCodes(data));
+  });
+
+  // Removed however this ends, so a late reply finds no listener instead
+  // of resolving the next write
+  try {
+    final sent = await api.clientWriteCgi(clientPtr, cgi, timeout: timeout);
+    if (!sent) {
+      print('[VeepaAudio] ❌ CGI write failed: $cgi');
+      return {'success': false, 'error': 'CGI write failed'};
+    }
+
+    final text = await response.future.timeout(Duration(seconds: timeout));
+    return {'success': true, 'response': text};
+  } on TimeoutException {
+    print('[VeepaAudio] ❌ No CGI response within ${timeout}s: $cgi');
+    return {'success': false, 'error': 'No response'};
+  } finally {
+    api.removeCommandListener(clientPtr);
+  }
+}
@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# run-benchmarks.sh
+# Runs the benchmark tests headless on the iOS Simulator.
+#
+# Usage:
+#   Scripts/run-benchmarks.sh                      # all benchmark tests
+#   Scripts/run-benchmarks.sh StartupBenchmarkTests  # one test class
+#
+# Exits non-zero when any benchmark exceeds its budget. Startup traces are
+# written to the app's Caches/StartupTraces folder in the simulator; open
+# them in ui.perfetto.dev or chrome://tracing. Benchmarks run in Debug with
+# the real-time sanitizer, so one that allocates or locks on a real-time
+# path fails with the offending stacks.
+
+# pipefail: the exit status is xcodebuild's, not the filter's at the end
+set -eo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_DIR="${SCRIPT_DIR}/.."
+DESTINATION="${DESTINATION:-platform=iOS Simulator,name=iPhone 15}"
+TEST_CLASS="${1:-StartupBenchmarkTests}"
+
+cd "${PROJECT_DIR}"
+
+echo "=== VeepaAudioTest Benchmarks ==="
+echo "Destination: ${DESTINATION}"
+echo "Tests: ${TEST_CLASS}"
+
+xcodegen generate
+
+xcodebuild test \
+    -project VeepaAudioTest.xcodeproj \
+    -scheme VeepaAudioTest \
+    -destination "${DESTINATION}" \
+    -only-testing:"VeepaAudioTestTests/${TEST_CLASS}" \
+    | tee /tmp/veepa-benchmarks.log \
+    | { grep -E "Time-to-first-audio|  [a-zA-Z]+: |Test Case|error:|failed|passed" || true; }
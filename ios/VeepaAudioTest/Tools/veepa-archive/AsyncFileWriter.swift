@@ -0,0 +1,109 @@
+//
+//  AsyncFileWriter.swift
+//  veepa-archive
+//
+//  Created for batch archive transcoding
+//  Purpose: Write whole output files through DispatchIO without blocking the
+//           decode workers, with a cap on buffers in flight
+//
+//  Each output file is one malloc'd buffer (header + samples) handed to
+//  DispatchIO as a single write, so the kernel sees large sequential writes
+//  and the buffer is freed by DispatchData once the write completes.
+//
+
+import Foundation
+
+final class AsyncFileWriter {
+
+    /// Output file that could not be written, with its errno
+    struct Failure {
+        let url: URL
+        let code: Int32
+    }
+
+    private let queue = DispatchQueue(label: "com.veepatest.archive-io", attributes: .concurrent)
+    private let group = DispatchGroup()
+    private let inFlight: DispatchSemaphore
+
+    private let lock = NSLock()
+    private var failures: [Failure] = []
+    private(set) var bytesWritten: Int = 0
+
+    /// - Parameter maxBuffersInFlight: Decoded buffers allowed to wait for I/O
+    ///   before workers block in `reserve()` (bounds peak memory)
+    init(maxBuffersInFlight: Int) {
+        inFlight = DispatchSemaphore(value: max(1, maxBuffersInFlight))
+    }
+
+    /// Wait for a free in-flight slot; call before allocating an output buffer
+    func reserve() {
+        inFlight.wait()
+    }
+
+    /// Give back a slot reserved with `reserve()` without writing
+    func cancelReservation() {
+        inFlight.signal()
+    }
+
+    /// Write `length` bytes of a malloc'd buffer to `url` and free it when done.
+    /// Consumes the reservation taken by `reserve()`.
+    func write(mallocBuffer buffer: UnsafeMutableRawPointer, length: Int, to url: URL) {
+        group.enter()
+
+        let fd = open(url.path, O_WRONLY | O_CREAT | O_TRUNC, 0o644)
+        guard fd >= 0 else {
+            record(Failure(url: url, code: errno))
+            free(buffer)
+            inFlight.signal()
+            group.leave()
+            return
+        }
+
+        let channel = DispatchIO(type: .stream, fileDescriptor: fd, queue: queue) { _ in
+            close(fd)
+        }
+        let data = DispatchData(
+            bytesNoCopy: UnsafeRawBufferPointer(start: buffer, count: length),
+            deallocator: .free
+        )
+
+        channel.write(offset: 0, data: data, queue: queue) { [self] done, _, error in
+            if error != 0 {
+                record(Failure(url: url, code: error))
+            }
+            guard done else { return }
+
+            channel.close()
+            if error == 0 {
+                lock.lock()
+                bytesWritten += length
+                lock.unlock()
+            }
+            inFlight.signal()
+            group.leave()
+        }
+    }
+
+    /// Write an encoded file image (copied once into a buffer DispatchIO can own).
+    /// Consumes the reservation taken by `reserve()`.
+    func write(_ data: Data, to url: URL) {
+        let buffer = malloc(max(data.count, 1))!
+        data.copyBytes(to: buffer.assumingMemoryBound(to: UInt8.self), count: data.count)
+        write(mallocBuffer: buffer, length: data.count, to: url)
+    }
+
+    /// Block until every queued write has finished
+    /// - Returns: Files that failed to write
+    func waitForAll() -> [Failure] {
+        group.wait()
+        lock.lock()
+        defer { lock.unlock() }
+        return failures
+    }
+
+    private func record(_ failure: Failure) {
+        lock.lock()
+        failures.append(failure)
+        lock.unlock()
+    }
+}
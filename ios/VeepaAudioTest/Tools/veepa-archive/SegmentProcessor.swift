@@ -0,0 +1,202 @@
+//
+//  SegmentProcessor.swift
+//  veepa-archive
+//
+//  Created for batch archive transcoding
+//  Purpose: Decode and analyze one capture archive segment
+//
+//  The segment is mmap'd read-only, so records are parsed in place and the
+//  A-law payloads stream straight into the G.711 kernel. The decode pass and
+//  the analysis pass are the same loop (CaptureArchive.c), so every sample is
+//  touched once while it is still in cache.
+//
+//  Loudness comes from the segment's *.vaci index, measured by the app while
+//  it recorded, so reports and --normalize need no K-weighting pass. Only
+//  segments without a (current) index are metered after decoding.
+//
+
+import Foundation
+
+/// Output container for decoded audio
+enum OutputFormat: String, CaseIterable {
+    case wav
+    case flac
+
+    var fileExtension: String { rawValue }
+}
+
+/// Options shared by every segment of a run
+struct ProcessingOptions {
+    var outputFormat: OutputFormat?
+    var outputDirectory: URL?
+    var silenceThresholdDBFS: Double = CAPTURE_ARCHIVE_SILENCE_DBFS
+    /// Scale each output file to this integrated loudness (LUFS)
+    var normalizeLUFS: Double?
+}
+
+/// EBU R128 loudness of a segment
+struct SegmentLoudness {
+    /// Gating blocks per 0.1 LU bin (Loudness.h); segments add up
+    var histogram: [UInt32]
+    var maxShortTermLUFS: Double?
+    /// Read from the index rather than measured here
+    var indexed: Bool
+
+    var integratedLUFS: Double? { lufs(loudness_integrated_from_histogram(histogram)) }
+
+    static func merged(_ segments: [SegmentLoudness]) -> SegmentLoudness? {
+        guard var total = segments.first else { return nil }
+        for segment in segments.dropFirst() {
+            for bin in total.histogram.indices { total.histogram[bin] &+= segment.histogram[bin] }
+            total.maxShortTermLUFS = [total.maxShortTermLUFS, segment.maxShortTermLUFS].compactMap { $0 }.max()
+            total.indexed = total.indexed && segment.indexed
+        }
+        return total
+    }
+}
+
+/// Centi-LU to LUFS (nil for LOUDNESS_NONE)
+func lufs(_ centiLU: Int16) -> Double? {
+    Int32(centiLU) == LOUDNESS_NONE ? nil : Double(centiLU) / 100
+}
+
+/// Analysis (and optional output) of one segment
+struct SegmentResult {
+    let input: URL
+    let output: URL?
+    let stats: capture_archive_stats
+    let loudness: SegmentLoudness?
+    let inputBytes: Int
+    let error: String?
+
+    var duration: TimeInterval {
+        stats.sample_rate > 0 ? Double(stats.samples) / Double(stats.sample_rate) : 0
+    }
+}
+
+enum SegmentProcessor {
+
+    /// Decode, analyze and (if an output format is set) queue the output write
+    static func process(_ url: URL, options: ProcessingOptions, writer: AsyncFileWriter?) -> SegmentResult {
+        var stats = capture_archive_stats()
+        capture_archive_stats_init(&stats, options.silenceThresholdDBFS)
+
+        func failed(_ message: String, bytes: Int = 0) -> SegmentResult {
+            SegmentResult(input: url, output: nil, stats: stats, loudness: nil, inputBytes: bytes, error: message)
+        }
+
+        // Map the segment
+        let fd = open(url.path, O_RDONLY)
+        guard fd >= 0 else { return failed("open: \(String(cString: strerror(errno)))") }
+        defer { close(fd) }
+
+        var info = stat()
+        guard fstat(fd, &info) == 0 else { return failed("fstat: \(String(cString: strerror(errno)))") }
+        let size = Int(info.st_size)
+        guard size > 0 else { return failed("empty segment") }
+
+        guard let base = mmap(nil, size, PROT_READ, MAP_PRIVATE, fd, 0), base != MAP_FAILED else {
+            return failed("mmap: \(String(cString: strerror(errno)))", bytes: size)
+        }
+        defer { munmap(base, size) }
+        madvise(base, size, MADV_SEQUENTIAL)
+
+        // Size the output from the record headers alone
+        var frames: UInt64 = 0
+        var samples: UInt64 = 0
+        capture_archive_scan(base, size, &frames, &samples)
+
+        let headerSize = Int(WAV_HEADER_SIZE)
+        let dataBytes = Int(samples) * MemoryLayout<Int16>.size
+        guard dataBytes <= Int(UInt32.max) - headerSize else {
+            return failed("segment too long for a single WAV file", bytes: size)
+        }
+
+        let writesOutput = options.outputFormat != nil && writer != nil
+        if writesOutput { writer?.reserve() }
+
+        guard let buffer = malloc(headerSize + max(dataBytes, 1)) else {
+            if writesOutput { writer?.cancelReservation() }
+            return failed("out of memory", bytes: size)
+        }
+        let pcm = (buffer + headerSize).assumingMemoryBound(to: Int16.self)
+
+        // Decode + analyze
+        var written = 0
+        let status = capture_archive_decode(base, size, pcm, Int(samples), &written, &stats)
+        guard status == Int32(CAPTURE_ARCHIVE_OK) else {
+            free(buffer)
+            if writesOutput { writer?.cancelReservation() }
+            return failed(status == Int32(CAPTURE_ARCHIVE_ERR_FORMAT) ? "not a capture archive segment"
+                                                                      : "unsupported segment (error \(status))",
+                          bytes: size)
+        }
+
+        let loudness = readIndex(of: url, samples: samples)
+            ?? measure(UnsafeBufferPointer(start: pcm, count: written), sampleRate: stats.sample_rate)
+
+        guard writesOutput, let writer = writer, let format = options.outputFormat else {
+            free(buffer)
+            return SegmentResult(input: url, output: nil, stats: stats, loudness: loudness, inputBytes: size, error: nil)
+        }
+
+        if let target = options.normalizeLUFS, let integrated = loudness?.integratedLUFS {
+            let gain = auto_gain_q11_from_cb(Int32(((target - integrated) * 100).rounded()))
+            auto_gain_apply_ramp(pcm, written, gain, gain)
+        }
+
+        // Hand the buffer to the async writer (it frees it)
+        let directory = options.outputDirectory ?? url.deletingLastPathComponent()
+        let output = directory
+            .appendingPathComponent(url.deletingPathExtension().lastPathComponent)
+            .appendingPathExtension(format.fileExtension)
+
+        switch format {
+        case .wav:
+            let outputBytes = written * MemoryLayout<Int16>.size
+            wav_write_header(buffer.assumingMemoryBound(to: UInt8.self), stats.sample_rate, 1, 16, UInt32(outputBytes))
+            writer.write(mallocBuffer: buffer, length: headerSize + outputBytes, to: output)
+        case .flac:
+            // Blocks are encoded in parallel on top of the per-segment workers
+            let encoder = FlacBlockEncoder(sampleRate: Int(stats.sample_rate))
+            let file = encoder.encodeFile(UnsafeBufferPointer(start: pcm, count: written))
+            free(buffer)
+            writer.write(file, to: output)
+        }
+
+        return SegmentResult(input: url, output: output, stats: stats, loudness: loudness, inputBytes: size, error: nil)
+    }
+
+    /// Loudness from the segment's index, if it was written for this segment as it is now
+    private static func readIndex(of url: URL, samples: UInt64) -> SegmentLoudness? {
+        let indexURL = url.deletingPathExtension().appendingPathExtension(CAPTURE_ARCHIVE_INDEX_EXTENSION)
+        guard let data = try? Data(contentsOf: indexURL) else { return nil }
+
+        return data.withUnsafeBytes { bytes -> SegmentLoudness? in
+            var index = capture_archive_index()
+            var histogram: UnsafePointer<UInt32>?
+            guard capture_archive_read_index(bytes.baseAddress, bytes.count, &index, &histogram) == Int32(CAPTURE_ARCHIVE_OK),
+                  let histogram = histogram,
+                  Int32(index.histogram_bins) == LOUDNESS_HISTOGRAM_BINS,
+                  index.samples == samples else {
+                return nil
+            }
+            return SegmentLoudness(histogram: Array(UnsafeBufferPointer(start: histogram, count: Int(index.histogram_bins))),
+                                   maxShortTermLUFS: lufs(index.max_short_term_clu),
+                                   indexed: true)
+        }
+    }
+
+    /// Meter decoded samples (segments recorded without an index)
+    private static func measure(_ pcm: UnsafeBufferPointer<Int16>, sampleRate: UInt32) -> SegmentLoudness? {
+        guard let meter = loudness_meter_create(sampleRate), let base = pcm.baseAddress else { return nil }
+        defer { loudness_meter_destroy(meter) }
+
+        loudness_meter_add(meter, base, pcm.count)
+        var histogram = [UInt32](repeating: 0, count: Int(LOUDNESS_HISTOGRAM_BINS))
+        loudness_meter_histogram(meter, &histogram)
+        return SegmentLoudness(histogram: histogram,
+                               maxShortTermLUFS: lufs(loudness_meter_read(meter).max_short_term_clu),
+                               indexed: false)
+    }
+}
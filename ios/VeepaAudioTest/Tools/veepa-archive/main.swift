@@ -0,0 +1,310 @@
+//
+//  main.swift
+//  veepa-archive
+//
+//  Created for batch archive transcoding
+//  Purpose: Offline batch transcoder/analyzer for capture archives recorded
+//           by AudioHookBridge (startArchivingToDirectory:)
+//
+//  Usage:
+//    veepa-archive analyze   [options] <segment.vaca | directory>...
+//    veepa-archive transcode [options] <segment.vaca | directory>...
+//
+//  Segments are spread over a pool of workers (one per core by default) that
+//  pull the next segment as they finish, largest first, so uneven segment
+//  sizes still keep every core busy. Output files are written asynchronously
+//  while the workers move on to the next segment.
+//
+
+import Foundation
+
+// MARK: - Arguments
+
+struct Arguments {
+    enum Command: String {
+        case analyze
+        case transcode
+    }
+
+    var command: Command = .analyze
+    var inputs: [URL] = []
+    var options = ProcessingOptions()
+    var jobs = ProcessInfo.processInfo.activeProcessorCount
+    var json = false
+
+    static let usage = """
+    Usage: veepa-archive <analyze|transcode> [options] <segment.vaca | directory>...
+
+    Commands:
+      analyze            Decode and report level, EBU R128 loudness, silence and
+                         frame continuity
+      transcode          Same as analyze, and write one audio file per segment
+                         (flac: lossless, typically 2-3x smaller than wav)
+
+    Options:
+      -f, --format FMT   Output format for transcode: \(OutputFormat.allCases.map(\.rawValue).joined(separator: ", ")) (default: wav)
+      -o, --output DIR   Output directory (default: next to each segment)
+      -j, --jobs N       Worker threads (default: \(ProcessInfo.processInfo.activeProcessorCount))
+      --silence-db DB    Silence threshold per 20ms window (default: \(Int(CAPTURE_ARCHIVE_SILENCE_DBFS)) dBFS)
+      --normalize LUFS   Scale transcoded files to this integrated loudness (e.g. -16)
+      --json             Print the report as JSON
+    """
+
+    static func parse(_ argv: [String]) throws -> Arguments {
+        var args = Arguments()
+        var remaining = argv.dropFirst()
+
+        guard let first = remaining.popFirst(), let command = Command(rawValue: first) else {
+            throw ToolError.usage("Missing or unknown command")
+        }
+        args.command = command
+        if command == .transcode {
+            args.options.outputFormat = .wav
+        }
+
+        func value(for flag: String) throws -> String {
+            guard let value = remaining.popFirst() else { throw ToolError.usage("\(flag) needs a value") }
+            return value
+        }
+
+        while let arg = remaining.popFirst() {
+            switch arg {
+            case "-f", "--format":
+                let name = try value(for: arg)
+                guard let format = OutputFormat(rawValue: name) else { throw ToolError.usage("Unknown format \(name)") }
+                if command == .transcode { args.options.outputFormat = format }
+            case "-o", "--output":
+                args.options.outputDirectory = URL(fileURLWithPath: try value(for: arg), isDirectory: true)
+            case "-j", "--jobs":
+                guard let jobs = Int(try value(for: arg)), jobs > 0 else { throw ToolError.usage("--jobs needs a positive number") }
+                args.jobs = jobs
+            case "--silence-db":
+                guard let db = Double(try value(for: arg)) else { throw ToolError.usage("--silence-db needs a number") }
+                args.options.silenceThresholdDBFS = db
+            case "--normalize":
+                guard let target = Double(try value(for: arg)) else { throw ToolError.usage("--normalize needs a loudness in LUFS") }
+                args.options.normalizeLUFS = target
+            case "--json":
+                args.json = true
+            case "-h", "--help":
+                throw ToolError.usage(nil)
+            default:
+                if arg.hasPrefix("-") { throw ToolError.usage("Unknown option \(arg)") }
+                args.inputs.append(URL(fileURLWithPath: arg))
+            }
+        }
+
+        if args.inputs.isEmpty {
+            throw ToolError.usage("No segments given")
+        }
+        return args
+    }
+}
+
+enum ToolError: Error, LocalizedError {
+    case usage(String?)
+    case noSegments
+
+    var errorDescription: String? {
+        switch self {
+        case .usage(let message):
+            return [message, Arguments.usage].compactMap { $0 }.joined(separator: "\n\n")
+        case .noSegments:
+            return "No .\(CAPTURE_ARCHIVE_EXTENSION) segments found"
+        }
+    }
+}
+
+// MARK: - Segment Discovery
+
+/// Expand directories to their segment files, largest first
+func findSegments(_ inputs: [URL]) -> [URL] {
+    let fileManager = FileManager.default
+    var segments: [URL] = []
+
+    for input in inputs {
+        var isDirectory: ObjCBool = false
+        guard fileManager.fileExists(atPath: input.path, isDirectory: &isDirectory) else {
+            fputs("⚠️ \(input.path) does not exist\n", stderr)
+            continue
+        }
+        guard isDirectory.boolValue else {
+            segments.append(input)
+            continue
+        }
+
+        let enumerator = fileManager.enumerator(at: input, includingPropertiesForKeys: [.fileSizeKey])
+        while let url = enumerator?.nextObject() as? URL {
+            if url.pathExtension == CAPTURE_ARCHIVE_EXTENSION {
+                segments.append(url)
+            }
+        }
+    }
+
+    func size(_ url: URL) -> Int {
+        (try? url.resourceValues(forKeys: [.fileSizeKey]).fileSize) ?? 0
+    }
+    return segments.sorted { size($0) > size($1) }
+}
+
+// MARK: - Batch Run
+
+/// Process every segment on `jobs` workers
+func runBatch(_ segments: [URL], arguments: Arguments) -> (results: [SegmentResult], failures: [AsyncFileWriter.Failure]) {
+    if let directory = arguments.options.outputDirectory {
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    let writer = arguments.options.outputFormat == nil ? nil : AsyncFileWriter(maxBuffersInFlight: arguments.jobs * 2)
+    var results = [SegmentResult?](repeating: nil, count: segments.count)
+    let lock = NSLock()
+    var nextIndex = 0
+
+    DispatchQueue.concurrentPerform(iterations: min(arguments.jobs, segments.count)) { _ in
+        while true {
+            lock.lock()
+            let index = nextIndex
+            nextIndex += 1
+            lock.unlock()
+            guard index < segments.count else { return }
+
+            let result = SegmentProcessor.process(segments[index], options: arguments.options, writer: writer)
+
+            lock.lock()
+            results[index] = result
+            lock.unlock()
+        }
+    }
+
+    let failures = writer?.waitForAll() ?? []
+    return (results.compactMap { $0 }, failures)
+}
+
+// MARK: - Report
+
+struct SegmentReport: Encodable {
+    let segment: String
+    let output: String?
+    let error: String?
+    let durationSeconds: Double
+    let frames: UInt64
+    let lostFrames: UInt64
+    let duplicateFrames: UInt64
+    let rmsDBFS: Double
+    let peakDBFS: Double
+    let silenceRatio: Double
+    let integratedLUFS: Double?
+    let maxShortTermLUFS: Double?
+    let loudnessFromIndex: Bool
+
+    init(name: String, output: URL?, error: String?, stats: capture_archive_stats, loudness: SegmentLoudness?) {
+        var stats = stats
+        self.segment = name
+        self.output = output?.path
+        self.error = error
+        self.durationSeconds = stats.sample_rate > 0 ? Double(stats.samples) / Double(stats.sample_rate) : 0
+        self.frames = stats.frames
+        self.lostFrames = stats.lost_frames
+        self.duplicateFrames = stats.duplicate_frames
+        self.rmsDBFS = capture_archive_rms_dbfs(&stats)
+        self.peakDBFS = capture_archive_peak_dbfs(&stats)
+        self.silenceRatio = stats.windows > 0 ? Double(stats.silent_windows) / Double(stats.windows) : 0
+        self.integratedLUFS = loudness?.integratedLUFS
+        self.maxShortTermLUFS = loudness?.maxShortTermLUFS
+        self.loudnessFromIndex = loudness?.indexed ?? false
+    }
+
+    var line: String {
+        if let error = error {
+            return "❌ \(segment): \(error)"
+        }
+        let loudness = integratedLUFS.map { String(format: "%6.1f LUFS", $0) } ?? "   - LUFS"
+        return String(
+            format: "%@  %8.1fs  rms %6.1f dBFS  peak %6.1f dBFS  %@  silence %5.1f%%  lost %llu",
+            segment, durationSeconds, rmsDBFS, peakDBFS, loudness, silenceRatio * 100, lostFrames
+        )
+    }
+}
+
+struct BatchReport: Encodable {
+    let segments: [SegmentReport]
+    let total: SegmentReport
+    let wallSeconds: Double
+    let jobs: Int
+    let inputMegabytes: Double
+    let outputMegabytes: Double
+
+    /// Seconds of audio processed per wall-clock second
+    var realtimeFactor: Double { wallSeconds > 0 ? total.durationSeconds / wallSeconds : 0 }
+}
+
+// MARK: - Main
+
+func run() -> Int32 {
+    let arguments: Arguments
+    do {
+        arguments = try Arguments.parse(CommandLine.arguments)
+    } catch {
+        fputs("\(error.localizedDescription)\n", stderr)
+        return 64  // EX_USAGE
+    }
+
+    let segments = findSegments(arguments.inputs)
+    guard !segments.isEmpty else {
+        fputs("\(ToolError.noSegments.localizedDescription)\n", stderr)
+        return 66  // EX_NOINPUT
+    }
+
+    let start = DispatchTime.now().uptimeNanoseconds
+    let (results, writeFailures) = runBatch(segments, arguments: arguments)
+    let wallSeconds = Double(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000_000
+
+    var total = capture_archive_stats()
+    capture_archive_stats_init(&total, arguments.options.silenceThresholdDBFS)
+    for result in results where result.error == nil {
+        var stats = result.stats
+        capture_archive_stats_merge(&total, &stats)
+    }
+
+    let outputBytes = results.compactMap(\.output).reduce(0) { sum, url in
+        sum + ((try? url.resourceValues(forKeys: [.fileSizeKey]).fileSize) ?? 0)
+    }
+    let report = BatchReport(
+        segments: results.map {
+            SegmentReport(name: $0.input.lastPathComponent, output: $0.output, error: $0.error, stats: $0.stats, loudness: $0.loudness)
+        },
+        total: SegmentReport(name: "total", output: nil, error: nil, stats: total,
+                             loudness: SegmentLoudness.merged(results.compactMap(\.loudness))),
+        wallSeconds: wallSeconds,
+        jobs: arguments.jobs,
+        inputMegabytes: Double(results.reduce(0) { $0 + $1.inputBytes }) / 1_048_576,
+        outputMegabytes: Double(outputBytes) / 1_048_576
+    )
+
+    if arguments.json {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        encoder.nonConformingFloatEncodingStrategy = .convertToString(positiveInfinity: "inf", negativeInfinity: "-inf", nan: "nan")
+        if let data = try? encoder.encode(report), let text = String(data: data, encoding: .utf8) {
+            print(text)
+        }
+    } else {
+        for segment in report.segments.sorted(by: { $0.segment < $1.segment }) {
+            print(segment.line)
+        }
+        print(report.total.line)
+        print(String(
+            format: "%d segments, %.1f MB in, %.1f MB out, %.2fs on %d workers (%.0fx realtime)",
+            results.count, report.inputMegabytes, report.outputMegabytes, wallSeconds, arguments.jobs, report.realtimeFactor
+        ))
+    }
+
+    for failure in writeFailures {
+        fputs("❌ write \(failure.url.path): \(String(cString: strerror(failure.code)))\n", stderr)
+    }
+
+    let failed = results.contains { $0.error != nil } || !writeFailures.isEmpty
+    return failed ? 1 : 0
+}
+
+exit(run())
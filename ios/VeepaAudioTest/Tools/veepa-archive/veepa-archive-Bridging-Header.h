@@ -0,0 +1,17 @@
+//
+//  veepa-archive-Bridging-Header.h
+//  veepa-archive
+//
+//  Exposes the app's C audio kernels and archive format to the tool
+//
+
+#ifndef veepa_archive_Bridging_Header_h
+#define veepa_archive_Bridging_Header_h
+
+#import "G711.h"
+#import "CaptureArchive.h"
+#import "AutoGain.h"
+#import "Loudness.h"
+#import "FlacEncoder.h"
+
+#endif /* veepa_archive_Bridging_Header_h */
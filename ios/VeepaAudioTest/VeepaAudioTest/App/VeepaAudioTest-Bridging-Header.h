@@ -14,4 +14,27 @@
 // Import Audio Hook Bridge for SDK interception
 #import "AudioHookBridge.h"
 
+// Import C audio modules (G.711, IMA ADPCM, automatic gain, loudness meter, filter bank, capture archive, FLAC, RTP, WebSocket, shared-memory ring, session table, CPU meter, frame pool, frame queue, sample ring, playout settings, stream format detection, real-time sanitizer, pipeline trace, flight recorder)
+#import "G711.h"
+#import "ImaAdpcm.h"
+#import "AutoGain.h"
+#import "Loudness.h"
+#import "FilterBank.h"
+#import "BatchDecoder.h"
+#import "CaptureArchive.h"
+#import "FlacEncoder.h"
+#import "RtpPublisher.h"
+#import "WebSocketFanout.h"
+#import "SharedAudioRing.h"
+#import "SessionTable.h"
+#import "SessionCpuMeter.h"
+#import "FramePool.h"
+#import "FrameQueue.h"
+#import "SampleRing.h"
+#import "PlayoutSettings.h"
+#import "StreamFormatDetector.h"
+#import "RealtimeSanitizer.h"
+#import "PipelineTrace.h"
+#import "FlightRecorder.h"
+
 #endif /* VeepaAudioTest_Bridging_Header_h */
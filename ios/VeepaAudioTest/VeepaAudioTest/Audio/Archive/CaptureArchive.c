@@ -0,0 +1,301 @@
+//
+//  CaptureArchive.c
+//  VeepaAudioTest
+//
+//  Created for batch archive transcoding
+//  Purpose: Capture archive segment reader/writer, decode + analysis pass
+//
+
+#include "CaptureArchive.h"
+#include "G711.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#pragma mark - Reading
+
+int capture_archive_open(capture_archive_cursor *cursor, const void *data, size_t size) {
+    memset(cursor, 0, sizeof(*cursor));
+    if (data == NULL || size < sizeof(capture_archive_header)) {
+        return CAPTURE_ARCHIVE_ERR_FORMAT;
+    }
+
+    memcpy(&cursor->header, data, sizeof(capture_archive_header));
+    if (cursor->header.magic != CAPTURE_ARCHIVE_MAGIC) {
+        return CAPTURE_ARCHIVE_ERR_FORMAT;
+    }
+    if (cursor->header.version != CAPTURE_ARCHIVE_VERSION ||
+        cursor->header.codec != CAPTURE_ARCHIVE_CODEC_ALAW ||
+        cursor->header.sample_rate == 0) {
+        return CAPTURE_ARCHIVE_ERR_VERSION;
+    }
+
+    cursor->base = (const uint8_t *)data;
+    cursor->size = size;
+    cursor->offset = sizeof(capture_archive_header);
+    return CAPTURE_ARCHIVE_OK;
+}
+
+int capture_archive_next(capture_archive_cursor *cursor, capture_archive_record *record, const uint8_t **payload) {
+    size_t remaining = cursor->size - cursor->offset;
+    if (remaining == 0) {
+        return 0;
+    }
+    if (remaining < sizeof(capture_archive_record)) {
+        cursor->truncated = 1;
+        return 0;
+    }
+
+    memcpy(record, cursor->base + cursor->offset, sizeof(capture_archive_record));
+    if (remaining - sizeof(capture_archive_record) < record->length) {
+        cursor->truncated = 1;
+        return 0;
+    }
+
+    *payload = cursor->base + cursor->offset + sizeof(capture_archive_record);
+    cursor->offset += sizeof(capture_archive_record) + record->length;
+    return 1;
+}
+
+void capture_archive_scan(const void *data, size_t size, uint64_t *frames, uint64_t *samples) {
+    capture_archive_cursor cursor;
+    capture_archive_record record;
+    const uint8_t *payload;
+
+    *frames = 0;
+    *samples = 0;
+    if (capture_archive_open(&cursor, data, size) != CAPTURE_ARCHIVE_OK) return;
+
+    while (capture_archive_next(&cursor, &record, &payload)) {
+        *frames += 1;
+        *samples += record.length;
+    }
+}
+
+#pragma mark - Decoding & Analysis
+
+void capture_archive_stats_init(capture_archive_stats *stats, double silence_threshold_dbfs) {
+    memset(stats, 0, sizeof(*stats));
+    stats->silence_threshold_dbfs = silence_threshold_dbfs;
+}
+
+int capture_archive_decode(const void *data, size_t size,
+                           int16_t *pcm, size_t capacity, size_t *written,
+                           capture_archive_stats *stats) {
+    capture_archive_cursor cursor;
+    capture_archive_record record;
+    const uint8_t *payload;
+
+    *written = 0;
+    int status = capture_archive_open(&cursor, data, size);
+    if (status != CAPTURE_ARCHIVE_OK) return status;
+
+    stats->sample_rate = cursor.header.sample_rate;
+
+    // 20ms windows; silence compares the window's mean square against the threshold
+    const size_t windowSamples = cursor.header.sample_rate / 50;
+    const double thresholdLinear = 32768.0 * pow(10.0, stats->silence_threshold_dbfs / 20.0);
+    const double silentWindowEnergy = thresholdLinear * thresholdLinear * (double)windowSamples;
+    double windowEnergy = 0;
+    size_t windowFill = 0;
+
+    size_t position = 0;
+    int havePrevious = 0;
+    uint32_t previousFrameNo = 0;
+
+    while (capture_archive_next(&cursor, &record, &payload)) {
+        // Same dedupe rule as the live path (lastProcessedFrameNo)
+        if (havePrevious && record.frame_no == previousFrameNo) {
+            stats->duplicate_frames++;
+            continue;
+        }
+        if (havePrevious && record.frame_no > previousFrameNo + 1) {
+            stats->lost_frames += record.frame_no - previousFrameNo - 1;
+        }
+        if (!havePrevious) {
+            stats->first_frame_no = record.frame_no;
+        }
+        havePrevious = 1;
+        previousFrameNo = record.frame_no;
+        stats->last_frame_no = record.frame_no;
+
+        if (capacity - position < record.length) {
+            return CAPTURE_ARCHIVE_ERR_SPACE;
+        }
+
+        int16_t *out = pcm + position;
+        g711_alaw_decode(payload, out, record.length);
+        position += record.length;
+        stats->frames++;
+
+        // Analysis runs on the block just decoded while it is still in cache
+        for (size_t i = 0; i < record.length; i++) {
+            int32_t sample = out[i];
+            int32_t magnitude = sample < 0 ? -sample : sample;
+            if (magnitude > stats->peak) stats->peak = magnitude;
+
+            double energy = (double)sample * (double)sample;
+            stats->sum_squares += energy;
+            windowEnergy += energy;
+
+            if (++windowFill == windowSamples) {
+                stats->windows++;
+                if (windowEnergy < silentWindowEnergy) stats->silent_windows++;
+                windowEnergy = 0;
+                windowFill = 0;
+            }
+        }
+    }
+
+    stats->samples += position;
+    *written = position;
+    return CAPTURE_ARCHIVE_OK;
+}
+
+void capture_archive_stats_merge(capture_archive_stats *total, const capture_archive_stats *segment) {
+    if (total->frames == 0) {
+        total->sample_rate = segment->sample_rate;
+        total->first_frame_no = segment->first_frame_no;
+    }
+    if (segment->frames > 0) {
+        total->last_frame_no = segment->last_frame_no;
+    }
+    total->frames += segment->frames;
+    total->samples += segment->samples;
+    total->lost_frames += segment->lost_frames;
+    total->duplicate_frames += segment->duplicate_frames;
+    if (segment->peak > total->peak) total->peak = segment->peak;
+    total->sum_squares += segment->sum_squares;
+    total->windows += segment->windows;
+    total->silent_windows += segment->silent_windows;
+}
+
+double capture_archive_rms_dbfs(const capture_archive_stats *stats) {
+    if (stats->samples == 0 || stats->sum_squares <= 0) return -INFINITY;
+    double rms = sqrt(stats->sum_squares / (double)stats->samples);
+    return 20.0 * log10(rms / 32768.0);
+}
+
+double capture_archive_peak_dbfs(const capture_archive_stats *stats) {
+    if (stats->peak <= 0) return -INFINITY;
+    return 20.0 * log10((double)stats->peak / 32768.0);
+}
+
+#pragma mark - Writing
+
+/// write() the whole iovec list, retrying short writes and EINTR
+static int write_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return CAPTURE_ARCHIVE_ERR_IO;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return CAPTURE_ARCHIVE_OK;
+}
+
+int capture_archive_write_header(int fd, uint32_t sample_rate, int64_t start_time_ms) {
+    capture_archive_header header = {
+        .magic = CAPTURE_ARCHIVE_MAGIC,
+        .version = CAPTURE_ARCHIVE_VERSION,
+        .codec = CAPTURE_ARCHIVE_CODEC_ALAW,
+        .sample_rate = sample_rate,
+        .reserved = 0,
+        .start_time_ms = start_time_ms,
+    };
+    struct iovec iov = { &header, sizeof(header) };
+    return write_all(fd, &iov, 1);
+}
+
+int capture_archive_append(int fd, uint32_t frame_no, uint32_t timestamp, const uint8_t *payload, uint16_t length) {
+    capture_archive_record record = {
+        .frame_no = frame_no,
+        .timestamp = timestamp,
+        .length = length,
+        .flags = 0,
+    };
+    struct iovec iov[2] = {
+        { &record, sizeof(record) },
+        { (void *)payload, length },
+    };
+    return write_all(fd, iov, 2);
+}
+
+#pragma mark - Index
+
+_Static_assert(sizeof(capture_archive_index) == 32, "histogram starts 4-byte aligned");
+
+int capture_archive_write_index(int fd, const capture_archive_index *index, const uint32_t *histogram) {
+    struct iovec iov[2] = {
+        { (void *)index, sizeof(*index) },
+        { (void *)histogram, (size_t)index->histogram_bins * sizeof(uint32_t) },
+    };
+    return write_all(fd, iov, 2);
+}
+
+int capture_archive_read_index(const void *data, size_t size,
+                               capture_archive_index *index, const uint32_t **histogram) {
+    if (data == NULL || size < sizeof(capture_archive_index)) {
+        return CAPTURE_ARCHIVE_ERR_FORMAT;
+    }
+
+    memcpy(index, data, sizeof(capture_archive_index));
+    if (index->magic != CAPTURE_ARCHIVE_INDEX_MAGIC) {
+        return CAPTURE_ARCHIVE_ERR_FORMAT;
+    }
+    if (index->version != CAPTURE_ARCHIVE_INDEX_VERSION) {
+        return CAPTURE_ARCHIVE_ERR_VERSION;
+    }
+    if (size - sizeof(capture_archive_index) < (size_t)index->histogram_bins * sizeof(uint32_t)) {
+        return CAPTURE_ARCHIVE_ERR_FORMAT;
+    }
+
+    *histogram = (const uint32_t *)((const uint8_t *)data + sizeof(capture_archive_index));
+    return CAPTURE_ARCHIVE_OK;
+}
+
+#pragma mark - WAV
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void wav_write_header(uint8_t header[WAV_HEADER_SIZE], uint32_t sample_rate, uint16_t channels,
+                      uint16_t bits_per_sample, uint32_t data_bytes) {
+    uint16_t blockAlign = (uint16_t)(channels * bits_per_sample / 8);
+
+    memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + data_bytes);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    put_u32(header + 16, 16);                        // fmt chunk size
+    put_u16(header + 20, 1);                         // PCM
+    put_u16(header + 22, channels);
+    put_u32(header + 24, sample_rate);
+    put_u32(header + 28, sample_rate * blockAlign);  // byte rate
+    put_u16(header + 32, blockAlign);
+    put_u16(header + 34, bits_per_sample);
+    memcpy(header + 36, "data", 4);
+    put_u32(header + 40, data_bytes);
+}
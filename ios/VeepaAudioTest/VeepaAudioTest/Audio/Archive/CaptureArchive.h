@@ -0,0 +1,192 @@
+//
+//  CaptureArchive.h
+//  VeepaAudioTest
+//
+//  Created for batch archive transcoding
+//  Purpose: On-disk format for recorded camera audio (original A-law
+//           frames, not decoded PCM) plus reader, writer and analysis
+//
+//  A capture archive is a directory of segment files (*.vaca). Each segment:
+//
+//  ```
+//  capture_archive_header                      24 bytes
+//  { capture_archive_record, payload[length] } repeated until EOF
+//  ```
+//
+//  All fields are little-endian. Records mirror the SDK's app_frame_header
+//  (frameno, timestamp), so a segment can be replayed exactly as received.
+//  A segment that ends in a partial record (app killed while writing) is
+//  still readable up to the last complete record.
+//
+//  Next to each closed segment the recorder writes an index file with the
+//  same name and the *.vaci extension: a summary of the segment measured
+//  while it was being recorded (frame and sample counts, EBU R128 loudness
+//  and its gating histogram), so exports can report and normalise loudness
+//  without decoding the segment first.
+//
+//  ```
+//  capture_archive_index                       32 bytes
+//  uint32_t histogram[histogram_bins]          gating blocks per 0.1 LU bin
+//  ```
+//
+
+#ifndef CaptureArchive_h
+#define CaptureArchive_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_ARCHIVE_MAGIC        0x41434156u  /* "VACA" */
+#define CAPTURE_ARCHIVE_VERSION      1
+#define CAPTURE_ARCHIVE_CODEC_ALAW   1
+#define CAPTURE_ARCHIVE_EXTENSION    "vaca"
+
+#define CAPTURE_ARCHIVE_INDEX_MAGIC      0x49434156u  /* "VACI" */
+#define CAPTURE_ARCHIVE_INDEX_VERSION    1
+#define CAPTURE_ARCHIVE_INDEX_EXTENSION  "vaci"
+
+/// Default silence threshold for analysis (dBFS of a 20ms window)
+#define CAPTURE_ARCHIVE_SILENCE_DBFS (-50.0)
+
+/// Segment file header
+typedef struct __attribute__((packed)) {
+    uint32_t magic;          ///< CAPTURE_ARCHIVE_MAGIC
+    uint16_t version;        ///< CAPTURE_ARCHIVE_VERSION
+    uint16_t codec;          ///< CAPTURE_ARCHIVE_CODEC_*
+    uint32_t sample_rate;    ///< Hz
+    uint32_t reserved;
+    int64_t  start_time_ms;  ///< Unix time of the first frame
+} capture_archive_header;
+
+/// Per-frame record header, followed by `length` payload bytes
+typedef struct __attribute__((packed)) {
+    uint32_t frame_no;       ///< app_frame_header.frameno
+    uint32_t timestamp;      ///< app_frame_header.timestamp (ms)
+    uint16_t length;         ///< Payload bytes (= samples for A-law)
+    uint16_t flags;
+} capture_archive_record;
+
+/// Error codes (negative return values)
+enum {
+    CAPTURE_ARCHIVE_OK          = 0,
+    CAPTURE_ARCHIVE_ERR_FORMAT  = -1,  ///< Not a capture archive segment
+    CAPTURE_ARCHIVE_ERR_VERSION = -2,  ///< Unsupported version or codec
+    CAPTURE_ARCHIVE_ERR_SPACE   = -3,  ///< Output buffer too small
+    CAPTURE_ARCHIVE_ERR_IO      = -4,  ///< write() failed (see errno)
+};
+
+#pragma mark - Reading
+
+/// Sequential reader over a segment held in memory (typically mmap'd)
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    size_t offset;
+    capture_archive_header header;
+    int truncated;           ///< Set when the segment ends in a partial record
+} capture_archive_cursor;
+
+/// Validate the header and position the cursor on the first record
+/// @return CAPTURE_ARCHIVE_OK or a negative error code
+int capture_archive_open(capture_archive_cursor *cursor, const void *data, size_t size);
+
+/// Advance to the next record
+/// @param record Receives the record header
+/// @param payload Receives a pointer into the segment (no copy)
+/// @return 1 if a record was read, 0 at the end of the segment
+int capture_archive_next(capture_archive_cursor *cursor, capture_archive_record *record, const uint8_t **payload);
+
+/// Count records and samples without touching payload bytes
+/// (sizes the decode buffer before the decode pass)
+void capture_archive_scan(const void *data, size_t size, uint64_t *frames, uint64_t *samples);
+
+#pragma mark - Decoding & Analysis
+
+/// Loudness and continuity statistics of a decoded segment
+typedef struct {
+    uint32_t sample_rate;
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t lost_frames;      ///< Gaps in frame_no
+    uint64_t duplicate_frames; ///< frame_no not advancing (dropped from output)
+    uint32_t first_frame_no;
+    uint32_t last_frame_no;
+    int32_t  peak;             ///< Largest |sample|
+    double   sum_squares;
+    uint64_t windows;          ///< 20ms analysis windows
+    uint64_t silent_windows;   ///< Windows below the silence threshold
+    double   silence_threshold_dbfs;
+} capture_archive_stats;
+
+/// Reset stats before a decode
+void capture_archive_stats_init(capture_archive_stats *stats, double silence_threshold_dbfs);
+
+/// Decode every frame of a segment to PCM and analyze it in the same pass
+/// @param pcm Output buffer, at least the `samples` reported by capture_archive_scan
+/// @param capacity Capacity of pcm in samples
+/// @param written Receives the number of samples written
+/// @return CAPTURE_ARCHIVE_OK or a negative error code
+int capture_archive_decode(const void *data, size_t size,
+                           int16_t *pcm, size_t capacity, size_t *written,
+                           capture_archive_stats *stats);
+
+/// Fold the stats of one segment into a running total
+void capture_archive_stats_merge(capture_archive_stats *total, const capture_archive_stats *segment);
+
+/// RMS level in dBFS (-inf for digital silence)
+double capture_archive_rms_dbfs(const capture_archive_stats *stats);
+
+/// Peak level in dBFS (-inf for digital silence)
+double capture_archive_peak_dbfs(const capture_archive_stats *stats);
+
+#pragma mark - Writing
+
+/// Write a segment header to a freshly created file
+int capture_archive_write_header(int fd, uint32_t sample_rate, int64_t start_time_ms);
+
+/// Append one frame (single writev, so a crash leaves at most one partial record)
+int capture_archive_append(int fd, uint32_t frame_no, uint32_t timestamp, const uint8_t *payload, uint16_t length);
+
+#pragma mark - Index
+
+/// Segment index file header, followed by `histogram_bins` uint32 counts
+typedef struct __attribute__((packed)) {
+    uint32_t magic;              ///< CAPTURE_ARCHIVE_INDEX_MAGIC
+    uint16_t version;            ///< CAPTURE_ARCHIVE_INDEX_VERSION
+    uint16_t histogram_bins;     ///< LOUDNESS_HISTOGRAM_BINS (0.1 LU from -70 LUFS)
+    uint32_t sample_rate;        ///< Hz
+    uint32_t frames;             ///< Records in the segment
+    uint64_t samples;
+    int16_t  integrated_clu;     ///< Gated loudness, centi-LU (LOUDNESS_NONE if none)
+    int16_t  max_momentary_clu;
+    int16_t  max_short_term_clu;
+    int16_t  reserved;
+} capture_archive_index;
+
+/// Write an index file (header and histogram in one writev)
+int capture_archive_write_index(int fd, const capture_archive_index *index, const uint32_t *histogram);
+
+/// Validate an index file held in memory
+/// @param histogram Receives a pointer into the data (no copy; aligned
+///   whenever the data is, as the header is 32 bytes)
+/// @return CAPTURE_ARCHIVE_OK or a negative error code
+int capture_archive_read_index(const void *data, size_t size,
+                               capture_archive_index *index, const uint32_t **histogram);
+
+#pragma mark - WAV
+
+#define WAV_HEADER_SIZE 44
+
+/// Fill a canonical 44-byte PCM WAV header
+void wav_write_header(uint8_t header[WAV_HEADER_SIZE], uint32_t sample_rate, uint16_t channels,
+                      uint16_t bits_per_sample, uint32_t data_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CaptureArchive_h */
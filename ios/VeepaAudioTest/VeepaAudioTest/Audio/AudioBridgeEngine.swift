@@ -3,7 +3,7 @@
 //  VeepaAudioTest
 //
 //  Created for AudioUnit Hook implementation
-//  Purpose: AVAudioEngine-based playback pipeline that accepts 16kHz audio
+//  Purpose: AVAudioEngine-based playback pipeline that accepts 8/16kHz audio
 //           and plays it through iOS at 48kHz (automatic conversion)
 //
 //  Based on O-KAM Pro approach:
@@ -13,17 +13,20 @@
 import AVFoundation
 import AudioToolbox
 
-/// Audio bridge engine that plays 16kHz audio from SDK through AVAudioEngine
+/// Audio bridge engine that plays 8/16kHz audio from SDK through AVAudioEngine
+///
+/// The input rate starts at 16 kHz and follows the stream once
+/// AudioHookBridge has detected its format (`configureInput(for:)`).
 ///
 /// Architecture:
 /// ```
-/// SDK Render Callback (16kHz Int16)
+/// SDK Render Callback (8/16kHz Int16)
 ///         │
 ///         ▼
 ///   CircularAudioBuffer
 ///         │
 ///         ▼
-///   AVAudioSourceNode (pulls 16kHz Int16)
+///   AVAudioSourceNode (pulls 8/16kHz Int16)
 ///         │
 ///         ▼
 ///   AVAudioEngine (auto-converts to 48kHz)
@@ -41,8 +44,9 @@ final class AudioBridgeEngine {
     // MARK: - Audio Format Constants
 
     /// Input format: What the camera/SDK produces after G.711a decoding
-    /// Verified from O-KAM Pro logs: "1 ch, 16000 Hz, Int16"
-    private let inputSampleRate: Double = 16000
+    /// Verified from O-KAM Pro logs: "1 ch, 16000 Hz, Int16" - the default
+    /// until the stream's own rate is detected (many cameras send 8000 Hz)
+    private(set) var inputSampleRate: Double = 16000
     private let inputChannels: AVAudioChannelCount = 1
 
     /// Output format: What iOS hardware requires
@@ -58,13 +62,125 @@ final class AudioBridgeEngine {
     // MARK: - Buffer
 
     /// Circular buffer to receive samples from SDK
-    let circularBuffer = CircularAudioBuffer(capacity: 32000)  // ~2 seconds at 16kHz
+    let circularBuffer = CircularAudioBuffer(capacity: 32000)  // ~2 seconds at 16kHz, 4 at 8kHz
+
+    /// Prefill, latency cap and concealment applied on top of the ring
+    /// (no prefill or cap until the stream format is known)
+    let playout = PlayoutController()
+
+    /// Latency/resilience preset; switching takes effect immediately, without
+    /// restarting the engine (the hardware rate preference applies at the next start)
+    var playoutProfile: PlayoutProfile {
+        get { playout.profile }
+        set { applyPlayoutProfile(newValue) }
+    }
+
+    /// Current jitter bounds in samples
+    var jitterBounds: JitterBufferBounds { playout.bounds }
 
     // MARK: - State
 
     private(set) var isRunning = false
     private var renderCallbackCount: UInt64 = 0
 
+    /// Silence the output without stopping the engine. While muted with
+    /// nothing recording, pushSamples has no use for the audio, so the bridge
+    /// stops decoding for it (rewind history and loudness skip the gap).
+    /// A stopped engine stays a consumer: pushes prefill the next start.
+    var isOutputMuted = false {
+        didSet {
+            audioEngine?.mainMixerNode.outputVolume = isOutputMuted ? 0 : 1
+            updateCaptureDemand()
+        }
+    }
+
+    /// Mark the bridge's capture callback idle while its samples would be discarded
+    private func updateCaptureDemand() {
+        AudioHookBridge.shared.captureCallbackIdle = isOutputMuted && recorder == nil
+    }
+
+    // MARK: - CPU Accounting
+
+    /// Per-session CPU time (AudioHookBridge's meter); the render callback
+    /// charges the SDK session's render stage, the status log samples it
+    private(set) var cpuMeter: SessionCpuMeter?
+    private var renderCpuMeter: OpaquePointer?
+
+    /// SDK voice session slot: CPU accounting and pipeline trace events
+    private var sdkSession: session_slot = .max  // SESSION_SLOT_NONE
+    private var tracedUnderflows: UInt64 = 0
+
+    // MARK: - Capture Sinks
+
+    /// What pushSamples feeds besides the ring. Created and replaced on the
+    /// main thread, used on the capture thread; both sides hold
+    /// `captureLock`, the capture thread for the whole push, so a sink is
+    /// never swapped out or freed in the middle of a frame.
+    private struct CaptureSinks {
+        var recorder: DecodedAudioRecorder?
+        var flightRecorder: FlightRecorder?
+        var rewindHistory: RewindHistory?
+        var rewind: RewindPosition?     // nil while playing live
+        var ringIsStale = false         // ring holds audio from before a rewind or return to live
+        var loudnessMeter: LoudnessMeter?
+        var loudnessTarget: Double?
+    }
+
+    private let captureLock = NSLock()
+    private var sinks = CaptureSinks()  // guarded by captureLock
+
+    private func withSinks<T>(_ body: (inout CaptureSinks) throws -> T) rethrows -> T {
+        captureLock.lock()
+        defer { captureLock.unlock() }
+        return try body(&sinks)
+    }
+
+    // MARK: - Flight Recorder
+
+    /// Last seconds of the SDK stream (frames via AudioHookBridge, decoded
+    /// audio via pushSamples); dumped on underflow bursts and engine restarts
+    var flightRecorder: FlightRecorder? { withSinks { $0.flightRecorder } }
+
+    // MARK: - Live Rewind
+
+    private struct RewindPosition {
+        var offset: UInt64   // ns behind live
+        var cursor: UInt64   // arrival time of the next frame to play
+    }
+
+    /// Last minutes of the SDK stream as received frames
+    var rewindHistory: RewindHistory? { withSinks { $0.rewindHistory } }
+
+    /// While rewinding, pushSamples fills the ring from the history instead
+    /// of the live frame (which keeps feeding the recorders). The capture
+    /// thread stays the ring's only producer; the main thread only flips
+    /// the state under captureLock.
+    var isRewinding: Bool { withSinks { $0.rewind != nil } }
+
+    // MARK: - Loudness
+
+    /// EBU R128 meter of the stream as pushed (after automatic gain), at
+    /// the input rate; integrated since the stream started or resetLoudness()
+    var loudnessMeter: LoudnessMeter? { withSinks { $0.loudnessMeter } }
+
+    /// Programme loudness to normalise playback to (LUFS), or nil to play
+    /// the stream as is. The render callback applies target - integrated,
+    /// ramped per render slice, up to `maxNormalizationBoostDb`.
+    var loudnessTarget: Double? {
+        get { withSinks { $0.loudnessTarget } }
+        set {
+            withSinks { sinks in
+                sinks.loudnessTarget = newValue
+                updateNormalizationGain(sinks)
+            }
+        }
+    }
+    let maxNormalizationBoostDb = 20.0
+
+    /// Q11 gain: set on the capture thread, ramped towards on the render thread
+    private var normalizationGainQ11 = Int32(AUTO_GAIN_UNITY_Q11)
+    private var renderGainQ11 = Int32(AUTO_GAIN_UNITY_Q11)
+
     // MARK: - Debug
 
     private var lastLogTime: Date = Date()
@@ -94,7 +210,7 @@ final class AudioBridgeEngine {
             throw AudioBridgeError.engineCreationFailed
         }
 
-        // Create input format (16kHz, mono, Int16)
+        // Create input format (stream rate, mono, Int16)
         // Note: AVAudioSourceNode requires non-interleaved format
         guard let format = AVAudioFormat(
             commonFormat: .pcmFormatInt16,
@@ -108,6 +224,49 @@ final class AudioBridgeEngine {
         inputFormat = format
         print("[AudioBridgeEngine] Input format: \(format)")
 
+        // Initialize lazy statics the render callback uses here, not on the audio thread
+        _ = AudioBridgeEngine.hostTicksToNanoseconds(0)
+        if cpuMeter == nil, let meter = AudioHookBridge.shared.cpuMeter {
+            cpuMeter = SessionCpuMeter(unowned: meter)
+            renderCpuMeter = meter
+        }
+        sdkSession = AudioHookBridge.shared.sdkSessionSlot
+        if flightRecorder == nil {
+            do {
+                let recorder = try FlightRecorder(name: "sdk-voice", sampleRate: Int(inputSampleRate))
+                AudioHookBridge.shared.flightRecorder = recorder.recorder
+                withSinks { $0.flightRecorder = recorder }
+            } catch {
+                print("[AudioBridgeEngine] ⚠️ No flight recorder: \(error.localizedDescription)")
+            }
+        }
+        withSinks { $0.flightRecorder?.sampleRate = Int(inputSampleRate) }
+        if rewindHistory == nil {
+            do {
+                let history = try RewindHistory(name: "sdk-voice", sampleRate: Int(inputSampleRate))
+                history.start()
+                withSinks { $0.rewindHistory = history }
+            } catch {
+                print("[AudioBridgeEngine] ⚠️ No rewind history: \(error.localizedDescription)")
+            }
+        }
+        withSinks { $0.rewindHistory?.sampleRate = Int(inputSampleRate) }
+        if loudnessMeter?.sampleRate != Int(inputSampleRate) {
+            // Built outside the lock; only the swap holds up the capture thread
+            let meter: LoudnessMeter?
+            do {
+                meter = try LoudnessMeter(sampleRate: Int(inputSampleRate))
+            } catch {
+                meter = nil
+                print("[AudioBridgeEngine] ⚠️ No loudness meter: \(error.localizedDescription)")
+            }
+            withSinks { sinks in
+                sinks.loudnessMeter = meter
+                updateNormalizationGain(sinks)
+            }
+        }
+        print("[AudioBridgeEngine] 📍 Render buffer ID: \(ObjectIdentifier(circularBuffer))")
+
         // Create source node that pulls from our circular buffer
         sourceNode = AVAudioSourceNode(format: format) { [weak self] (isSilence, timestamp, frameCount, audioBufferList) -> OSStatus in
             guard let self = self else {
@@ -131,9 +290,10 @@ final class AudioBridgeEngine {
         engine.attach(sourceNode)
 
         // Connect source node to main mixer
-        // AVAudioEngine will automatically handle format conversion (16kHz → 48kHz)
+        // AVAudioEngine will automatically handle format conversion (8/16kHz → 48kHz)
         let mainMixer = engine.mainMixerNode
         engine.connect(sourceNode, to: mainMixer, format: format)
+        mainMixer.outputVolume = isOutputMuted ? 0 : 1
 
         print("[AudioBridgeEngine] Audio graph connected:")
         print("[AudioBridgeEngine]   SourceNode (\(format.sampleRate) Hz)")
@@ -146,28 +306,43 @@ final class AudioBridgeEngine {
     /// Track if we've ever received real samples
     private var hasReceivedRealSamples = false
     private var lastNonZeroSampleCount = 0
-    private var renderBufferIDLogged = false
 
-    /// Track when capture starts to enable aggressive logging
+    /// Track when capture starts (the health check only restarts a capturing engine)
     private var captureHasStarted = false
-    private var renderLogCountAfterCapture = 0
+
+    /// Set once the first audible (non-silent) samples have been rendered
+    private var hasRenderedNonSilence = false
+
+    /// Render thread → main thread handoff: the render callback only stores
+    /// plain values, reportRenderProgress logs and marks the trace
+    private var lastRenderRead = 0
+    private var firstNonSilentRenderNanoseconds: UInt64 = 0
+    private var firstRealSamplesReported = false
+
+    /// Samples with a magnitude at or below this count as silence (~ -60 dBFS)
+    private let silenceThreshold: Int16 = 32
 
     /// Called by AVAudioSourceNode when it needs audio data
-    /// This runs on a high-priority audio thread
+    /// This runs on a high-priority audio thread: no allocation, locks or
+    /// logging here (RealtimeSanitizer flags them in Debug builds)
     private func renderCallback(
         isSilence: UnsafeMutablePointer<ObjCBool>,
         timestamp: UnsafePointer<AudioTimeStamp>,
         frameCount: AVAudioFrameCount,
         audioBufferList: UnsafeMutablePointer<AudioBufferList>
     ) -> OSStatus {
+        rt_sanitizer_enter()
+        let cpuStart = session_cpu_thread_ns()
+        let traceStart = pipeline_trace_begin()
+        var samplesPulled = 0
+        defer {
+            pipeline_trace_span(PIPELINE_TRACE_RENDER_PULL, traceStart, sdkSession, Int64(samplesPulled))
+            _ = session_cpu_lap(renderCpuMeter, sdkSession, SESSION_CPU_RENDER, cpuStart)
+            rt_sanitizer_leave()
+        }
 
         renderCallbackCount += 1
 
-        // CRITICAL DEBUG: Log every 100th callback to prove render is still running
-        if renderCallbackCount % 100 == 0 {
-            print("[AudioBridgeEngine] 💓 HEARTBEAT Render #\(renderCallbackCount) still running")
-        }
-
         // Get the buffer to fill
         let ablPointer = UnsafeMutableAudioBufferListPointer(audioBufferList)
 
@@ -177,65 +352,83 @@ final class AudioBridgeEngine {
             return noErr
         }
 
-        // Log buffer identity once to verify same instance
-        if !renderBufferIDLogged {
-            renderBufferIDLogged = true
-            let bufferID = ObjectIdentifier(circularBuffer)
-            print("[AudioBridgeEngine] 📍 Render buffer ID: \(bufferID)")
-        }
-
-        // Check buffer state BEFORE read
-        let availableBefore = circularBuffer.availableSamples
-
-        // Read samples from circular buffer
-        let samplesRead = circularBuffer.read(into: dataPointer, count: Int(frameCount))
-
-        // ALWAYS log if we found samples (this is the key diagnostic)
-        if availableBefore > 0 || samplesRead > 0 {
-            print("[AudioBridgeEngine] 🎵 FOUND SAMPLES! Render #\(renderCallbackCount): available=\(availableBefore), read=\(samplesRead)")
-        }
-
-        // Log first few, every 500th, or after capture starts
-        let shouldLog = renderCallbackCount <= 5 ||
-                        (renderCallbackCount % 500 == 0) ||
-                        (captureHasStarted && renderLogCountAfterCapture < 20)
-
-        if captureHasStarted {
-            renderLogCountAfterCapture += 1
-        }
+        // Read samples from circular buffer through the playout policy
+        // (jitter prefill, latency cap, concealment of gaps)
+        let (samplesRead, samplesConcealed) = playout.render(into: dataPointer, count: Int(frameCount), from: circularBuffer)
 
-        if shouldLog {
-            let totalWritten = circularBuffer.totalSamplesWritten
-            let totalRead = circularBuffer.totalSamplesRead
-            print("[AudioBridgeEngine] 🔍 Render #\(renderCallbackCount): requested=\(frameCount), available=\(availableBefore), read=\(samplesRead), written=\(totalWritten), totalRead=\(totalRead)")
+        // Loudness normalization, ramped so a new gain never clicks
+        let targetGainQ11 = normalizationGainQ11
+        if samplesRead + samplesConcealed > 0 && (targetGainQ11 != AUTO_GAIN_UNITY_Q11 || renderGainQ11 != AUTO_GAIN_UNITY_Q11) {
+            auto_gain_apply_ramp(dataPointer, Int(frameCount), renderGainQ11, targetGainQ11)
+            renderGainQ11 = targetGainQ11
         }
 
         // Update buffer size
         audioBufferList.pointee.mBuffers.mDataByteSize = UInt32(frameCount) * UInt32(MemoryLayout<Int16>.size)
 
-        // Mark as silence if we didn't get any real samples
-        isSilence.pointee = ObjCBool(samplesRead == 0)
+        // Mark as silence if we didn't get any real or concealed samples
+        isSilence.pointee = ObjCBool(samplesRead == 0 && samplesConcealed == 0)
 
-        // Track when we first receive real samples
-        if samplesRead > 0 && !hasReceivedRealSamples {
-            hasReceivedRealSamples = true
-            print("[AudioBridgeEngine] 🎵 FIRST REAL SAMPLES! Playing \(samplesRead) samples")
-            print("[AudioBridgeEngine] 🎵 Buffer ID: \(ObjectIdentifier(circularBuffer))")
+        lastRenderRead = samplesRead
+        samplesPulled = samplesRead
+        if playout.statistics.underflows != tracedUnderflows {
+            tracedUnderflows = playout.statistics.underflows
+            pipeline_trace_instant(PIPELINE_TRACE_UNDERFLOW, sdkSession, Int64(Int(frameCount) - samplesRead))
         }
-
-        // Track last non-zero read
         if samplesRead > 0 {
+            hasReceivedRealSamples = true
             lastNonZeroSampleCount = samplesRead
         }
 
-        // Periodic logging (not every callback - that would flood logs)
-        periodicLog(samplesRead: samplesRead, frameCount: frameCount)
+        // Time-to-first-audio: first sample the listener can actually hear
+        // (the trace mark itself is made on the main thread)
+        if !hasRenderedNonSilence && samplesRead > 0 &&
+            containsNonSilence(dataPointer, count: samplesRead) {
+            hasRenderedNonSilence = true
+            firstNonSilentRenderNanoseconds = uptimeNanoseconds(of: timestamp.pointee)
+        }
 
         return noErr
     }
 
-    /// Log buffer status periodically (not on every callback)
-    private func periodicLog(samplesRead: Int, frameCount: AVAudioFrameCount) {
+    /// Whether any sample in the block is louder than `silenceThreshold`
+    private func containsNonSilence(_ samples: UnsafePointer<Int16>, count: Int) -> Bool {
+        for i in 0..<count where samples[i] > silenceThreshold || samples[i] < -silenceThreshold {
+            return true
+        }
+        return false
+    }
+
+    /// Convert a render timestamp to uptime nanoseconds (falls back to now)
+    private func uptimeNanoseconds(of timestamp: AudioTimeStamp) -> UInt64 {
+        guard timestamp.mFlags.contains(.hostTimeValid) else {
+            return StartupTrace.now()
+        }
+        return AudioBridgeEngine.hostTicksToNanoseconds(timestamp.mHostTime)
+    }
+
+    /// Mach host ticks → nanoseconds
+    private static let hostTicksToNanoseconds: (UInt64) -> UInt64 = {
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+        let numer = UInt64(timebase.numer)
+        let denom = UInt64(timebase.denom)
+        return { ticks in ticks * numer / denom }
+    }()
+
+    /// Main-thread side of the render diagnostics (called by the health
+    /// check): first-audio milestones, then buffer status every `logInterval`
+    private func reportRenderProgress() {
+        if firstNonSilentRenderNanoseconds != 0 {
+            StartupTrace.shared.mark(.firstNonSilentRender, at: firstNonSilentRenderNanoseconds)
+            firstNonSilentRenderNanoseconds = 0
+        }
+        if hasReceivedRealSamples && !firstRealSamplesReported {
+            firstRealSamplesReported = true
+            print("[AudioBridgeEngine] 🎵 FIRST REAL SAMPLES! Playing \(lastNonZeroSampleCount) samples")
+            print("[AudioBridgeEngine] 🎵 Buffer ID: \(ObjectIdentifier(circularBuffer))")
+        }
+
         let now = Date()
         if now.timeIntervalSince(lastLogTime) >= logInterval {
             lastLogTime = now
@@ -249,7 +442,7 @@ final class AudioBridgeEngine {
             print("[AudioBridgeEngine]    Engine running: \(engineRunning)")
             print("[AudioBridgeEngine]    Buffered: \(available) samples (\(fillPercent)%)")
             print("[AudioBridgeEngine]    Callbacks: \(renderCallbackCount)")
-            print("[AudioBridgeEngine]    Last read: \(samplesRead) samples")
+            print("[AudioBridgeEngine]    Last read: \(lastRenderRead) samples")
             print("[AudioBridgeEngine]    Has received audio: \(hasReceivedRealSamples)")
 
             if circularBuffer.underflowCount > 0 {
@@ -259,11 +452,35 @@ final class AudioBridgeEngine {
                 print("[AudioBridgeEngine]    Total written: \(circularBuffer.totalSamplesWritten)")
                 print("[AudioBridgeEngine]    Total read: \(circularBuffer.totalSamplesRead)")
             }
+            if let usage = cpuMeter?.sample(), Int(sdkSession) < usage.sessions.count {
+                print("[AudioBridgeEngine]    CPU: \(usage.sessions[Int(sdkSession)].description)")
+            }
+            if RealtimeSanitizer.violationCount > 0 {
+                print("[AudioBridgeEngine]    ⚠️ \(RealtimeSanitizer.report())")
+                RealtimeSanitizer.reset()
+            }
         }
     }
 
     // MARK: - Control
 
+    /// Build and prepare the audio graph ahead of `start()`
+    ///
+    /// Called by the connection bring-up so engine and format setup overlap
+    /// the P2P handshake; `start()` then only has to configure the session
+    /// and start the hardware. Does nothing if the graph already exists.
+    ///
+    /// Main actor only, like `start()` and the graph rebuilds: they all
+    /// create or replace the same engine state.
+    @MainActor
+    func prewarm() throws {
+        guard !isRunning, audioEngine == nil else { return }
+
+        try setupAudioEngine()
+        audioEngine?.prepare()
+        print("[AudioBridgeEngine] 🔥 Prewarmed (graph built and prepared)")
+    }
+
     /// Start the audio engine
     func start() throws {
         guard !isRunning else {
@@ -289,9 +506,11 @@ final class AudioBridgeEngine {
         hasReceivedRealSamples = false
         lastNonZeroSampleCount = 0
         renderCallbackCount = 0
-        renderBufferIDLogged = false
         captureHasStarted = false
-        renderLogCountAfterCapture = 0
+        hasRenderedNonSilence = false
+        lastRenderRead = 0
+        firstNonSilentRenderNanoseconds = 0
+        firstRealSamplesReported = false
 
         // Register for audio session interruption notifications
         setupInterruptionHandling()
@@ -320,6 +539,9 @@ final class AudioBridgeEngine {
             self?.healthCheckTimer = Timer.scheduledTimer(withTimeInterval: 1.0, repeats: true) { [weak self] _ in
                 guard let self = self else { return }
 
+                self.reportRenderProgress()
+                self.flightRecorder?.noteUnderflows(total: self.playout.statistics.underflows)
+
                 let currentCount = self.renderCallbackCount
                 let engineRunning = self.audioEngine?.isRunning ?? false
                 let buffered = self.circularBuffer.availableSamples
@@ -349,6 +571,8 @@ final class AudioBridgeEngine {
                     }
 
                     self.restartAttempts += 1
+                    pipeline_trace_instant(PIPELINE_TRACE_ENGINE_RESTART, self.sdkSession, Int64(self.restartAttempts))
+                    self.flightRecorder?.trigger(.engineRestart(attempt: self.restartAttempts))
                     print("[AudioBridgeEngine] 🚨 ENGINE NEEDS RESTART (attempt \(self.restartAttempts)/3)!")
                     print("[AudioBridgeEngine] 🚨   Engine running: \(engineRunning)")
                     print("[AudioBridgeEngine] 🚨   Callbacks/sec: \(callbacksPerSecond)")
@@ -402,8 +626,8 @@ final class AudioBridgeEngine {
                             print("[AudioBridgeEngine] 🔊 Mixer volume: \(mixer.outputVolume)")
                             print("[AudioBridgeEngine] 🔊 Output format: \(output.outputFormat(forBus: 0))")
 
-                            // Ensure volume is up
-                            if mixer.outputVolume < 1.0 {
+                            // Ensure volume is up (unless muted)
+                            if !self.isOutputMuted && mixer.outputVolume < 1.0 {
                                 mixer.outputVolume = 1.0
                                 print("[AudioBridgeEngine] 🔊 Set mixer volume to 1.0")
                             }
@@ -539,11 +763,13 @@ final class AudioBridgeEngine {
                 options: [.defaultToSpeaker, .allowBluetoothA2DP]
             )
 
-            // Request 48kHz (will be accepted by iOS)
-            try session.setPreferredSampleRate(outputSampleRate)
+            // Request 48kHz (will be accepted by iOS), or the stream's own
+            // rate when the profile avoids resampling
+            let profile = playout.profile
+            try session.setPreferredSampleRate(profile.resampling == .streamRate ? inputSampleRate : outputSampleRate)
 
-            // Small buffer for low latency
-            try session.setPreferredIOBufferDuration(0.01)  // 10ms
+            // Small buffer for low latency (profile decides how small)
+            try session.setPreferredIOBufferDuration(profile.ioBufferDuration)
 
             try session.setActive(true)
 
@@ -560,6 +786,70 @@ final class AudioBridgeEngine {
 
     // MARK: - Input Methods (Called by SDK Hook)
 
+    /// Match the input format to a detected stream format
+    ///
+    /// Sets the rate AVAudioEngine converts from (rebuilding the graph if the
+    /// rate changes) and sizes the jitter bounds from the frame duration.
+    /// Samples already buffered are kept - they are at the stream's true rate.
+    func configureInput(for format: DetectedStreamFormat) {
+        guard format.detected, format.sampleRate > 0 else { return }
+        configureInput(sampleRate: Int(format.sampleRate), frameSamples: Int(format.frameSamples))
+    }
+
+    func configureInput(sampleRate: Int, frameSamples: Int) {
+        playout.configure(sampleRate: sampleRate, frameSamples: frameSamples)
+        print("[AudioBridgeEngine] 🎚️ Input: \(sampleRate) Hz, \(frameSamples)-sample frames; "
+              + "jitter target \(jitterBounds.targetSamples), max \(jitterBounds.maxSamples) samples")
+
+        guard Double(sampleRate) != inputSampleRate else { return }
+        inputSampleRate = Double(sampleRate)
+
+        // Not built yet: setupAudioEngine picks up the new rate
+        guard audioEngine != nil else { return }
+
+        let wasRunning = isRunning
+        if let sourceNode = sourceNode, let engine = audioEngine {
+            engine.detach(sourceNode)
+        }
+        audioEngine?.stop()
+        sourceNode = nil
+        audioEngine = nil
+
+        do {
+            try setupAudioEngine()
+            audioEngine?.prepare()
+            if wasRunning {
+                try audioEngine?.start()
+                renderCallbackCount = 0
+                lastKnownCallbackCount = 0
+            }
+            print("[AudioBridgeEngine] ✅ Graph rebuilt for \(sampleRate) Hz input")
+        } catch {
+            isRunning = false
+            print("[AudioBridgeEngine] ❌ Failed to rebuild graph for \(sampleRate) Hz: \(error)")
+        }
+    }
+
+    // MARK: - Playout Profile
+
+    /// Apply every knob of a profile: render policy now, IO buffer on the
+    /// active session, frame poll interval on the capture timer
+    private func applyPlayoutProfile(_ profile: PlayoutProfile) {
+        playout.apply(profile)
+        AudioHookBridge.shared.voiceFramePollIntervalMs = UInt32(profile.framePollIntervalMs)
+
+        if isRunning {
+            do {
+                try AVAudioSession.sharedInstance().setPreferredIOBufferDuration(profile.ioBufferDuration)
+            } catch {
+                print("[AudioBridgeEngine] ⚠️ IO buffer change failed: \(error)")
+            }
+        }
+        print("[AudioBridgeEngine] 🎛️ Playout profile: \(profile.name) (jitter \(jitterBounds.targetSamples)/"
+              + "\(jitterBounds.maxSamples == .max ? "∞" : String(jitterBounds.maxSamples)) samples, "
+              + "IO \(Int(profile.ioBufferDuration * 1000)) ms, poll \(profile.framePollIntervalMs) ms)")
+    }
+
     /// Push audio samples from SDK render callback
     ///
     /// Call this from the swizzled AudioUnit render callback
@@ -572,10 +862,31 @@ final class AudioBridgeEngine {
         // Signal that capture has started (for debug logging)
         if !captureHasStarted {
             captureHasStarted = true
-            renderLogCountAfterCapture = 0
-            print("[AudioBridgeEngine] 🎬 CAPTURE STARTED - enabling aggressive render logging")
+            print("[AudioBridgeEngine] 🎬 CAPTURE STARTED")
+            StartupTrace.shared.mark(.firstSamplesBuffered)
+        }
+        withSinks { sinks in
+            if sinks.ringIsStale {
+                circularBuffer.clear()
+                sinks.ringIsStale = false
+            }
+            if sinks.rewind != nil {
+                feedRewind(&sinks)
+            } else {
+                let traceStart = pipeline_trace_begin()
+                circularBuffer.write(from: samples, count: count)
+                if traceStart != 0 {
+                    pipeline_trace_span(PIPELINE_TRACE_RING_WRITE, traceStart, sdkSession, Int64(count))
+                    pipeline_trace_counter(PIPELINE_TRACE_RING_FILL, sdkSession, Int64(circularBuffer.availableSamples))
+                }
+            }
+            sinks.recorder?.append(samples, count: count)
+            sinks.flightRecorder?.recordSamples(samples, count: count)
+            if let meter = sinks.loudnessMeter {
+                meter.add(samples, count: count)
+                updateNormalizationGain(sinks)
+            }
         }
-        circularBuffer.write(from: samples, count: count)
     }
 
     /// Push audio samples from an array (for testing)
@@ -588,6 +899,119 @@ final class AudioBridgeEngine {
         circularBuffer.write(from: bufferList, frameCount: frameCount)
     }
 
+    // MARK: - Loudness
+
+    /// Start measuring the programme afresh (e.g. for a new camera)
+    func resetLoudness() {
+        withSinks { sinks in
+            sinks.loudnessMeter?.reset()
+            normalizationGainQ11 = Int32(AUTO_GAIN_UNITY_Q11)
+        }
+    }
+
+    /// Gain that brings the integrated loudness to the target (unity while
+    /// normalization is off or nothing has passed the gate yet); called
+    /// with captureLock held
+    private func updateNormalizationGain(_ sinks: CaptureSinks) {
+        guard let target = sinks.loudnessTarget, let integrated = sinks.loudnessMeter?.reading.integrated else {
+            normalizationGainQ11 = Int32(AUTO_GAIN_UNITY_Q11)
+            return
+        }
+        let gainDb = min(target - integrated, maxNormalizationBoostDb)
+        normalizationGainQ11 = auto_gain_q11_from_cb(Int32((gainDb * 100).rounded()))
+    }
+
+    // MARK: - Recording
+
+    /// Active recording of the decoded stream (fed from pushSamples)
+    var recorder: DecodedAudioRecorder? { withSinks { $0.recorder } }
+
+    /// Record everything pushed into the engine from now on
+    /// - Parameters:
+    ///   - directory: Folder for the recording (created if needed)
+    ///   - format: `.flac` for lossless compression, `.wav` for raw PCM
+    ///   - preRoll: Seconds of rewind history to start the recording with,
+    ///     so an event-triggered recording includes what led up to it
+    /// - Returns: URL of the new recording
+    @discardableResult
+    func startRecording(to directory: URL, format: DecodedAudioRecorder.Format = .flac,
+                        preRoll: TimeInterval = 0) throws -> URL {
+        stopRecording()
+
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        let url = directory
+            .appendingPathComponent("decoded-\(Int(Date().timeIntervalSince1970))")
+            .appendingPathExtension(format.fileExtension)
+        let recorder = try DecodedAudioRecorder(url: url, format: format, sampleRate: Int(inputSampleRate))
+        if preRoll > 0, let clip = rewindHistory?.clip(last: preRoll), !clip.isEmpty {
+            clip.decoded().withUnsafeBufferPointer { recorder.append($0.baseAddress!, count: $0.count) }
+        }
+        withSinks { $0.recorder = recorder }
+        updateCaptureDemand()
+        return url
+    }
+
+    /// Finish the active recording (encoding of the tail continues in the background)
+    func stopRecording(completion: ((DecodedAudioRecorder.Summary) -> Void)? = nil) {
+        // Taken out under the capture lock: once it is released no push is
+        // still appending, so the encoder is finished after the last frame
+        let recorder: DecodedAudioRecorder? = withSinks { sinks in
+            defer { sinks.recorder = nil }
+            return sinks.recorder
+        }
+        recorder?.finish(completion: completion)
+        updateCaptureDemand()
+    }
+
+    // MARK: - Live Rewind
+
+    /// Play the stream from `seconds` ago (clamped to the history). Calling
+    /// again scrubs to a new point; live audio keeps being recorded meanwhile.
+    /// - Returns: false if there is no history yet
+    @discardableResult
+    func startRewind(seconds: TimeInterval) -> Bool {
+        guard let history = rewindHistory, history.availableSeconds > 0 else { return false }
+        let offset = UInt64(min(seconds, history.availableSeconds) * 1e9)
+        let now = pipeline_trace_now()
+
+        // Picked up by the next pushSamples, which drops the live audio
+        // still in the ring and plays from the history from then on
+        withSinks { sinks in
+            sinks.rewind = RewindPosition(offset: offset, cursor: now - offset)
+            sinks.ringIsStale = true
+        }
+        print("[AudioBridgeEngine] ⏪ Rewind \(String(format: "%.1f", Double(offset) / 1e9)) s")
+        return true
+    }
+
+    /// Stop rewind playback and play live audio again
+    func returnToLive() {
+        let wasRewinding: Bool = withSinks { sinks in
+            guard sinks.rewind != nil else { return false }
+            sinks.rewind = nil
+            sinks.ringIsStale = true
+            return true
+        }
+        if wasRewinding {
+            print("[AudioBridgeEngine] ⏩ Back to live")
+        }
+    }
+
+    /// Write the history frames that are due, `offset` behind live, into the
+    /// ring (capture thread, with captureLock held)
+    private func feedRewind(_ sinks: inout CaptureSinks) {
+        guard let history = sinks.rewindHistory, var rewind = sinks.rewind else { return }
+        let due = pipeline_trace_now() - rewind.offset
+        guard due > rewind.cursor else { return }
+
+        let clip = history.clip(from: rewind.cursor, to: due)
+        rewind.cursor = due
+        sinks.rewind = rewind
+        if !clip.isEmpty {
+            circularBuffer.write(from: clip.decoded())
+        }
+    }
+
     // MARK: - Helpers
 
     /// Description for route change reason
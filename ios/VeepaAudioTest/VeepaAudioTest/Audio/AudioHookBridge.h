@@ -13,12 +13,62 @@
 
 #import <Foundation/Foundation.h>
 #import <AudioToolbox/AudioToolbox.h>
+#import "FramePool.h"
+#import "SessionCpuMeter.h"
+#import "FlightRecorder.h"
+#import "ImaAdpcm.h"
+#import "AutoGain.h"
+#import "FilterBank.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 /// Callback block for audio data capture
 typedef void (^AudioCaptureBlock)(const int16_t *samples, uint32_t count);
 
+/// Observer block for received G.711a frames, before decoding
+/// @param alaw Frame payload (valid only during the call)
+/// @param length Payload size in bytes (= samples)
+/// @param frameNo app_frame_header.frameno
+/// @param timestampMs app_frame_header.timestamp (0 if unknown)
+typedef void (^AudioRawFrameBlock)(const uint8_t *alaw, uint32_t length, uint32_t frameNo, uint32_t timestampMs);
+
+/// Observer block for decoded frames (same frame identity as the raw observer)
+/// @param samples Decoded 16-bit PCM (valid only during the call)
+typedef void (^AudioDecodedFrameBlock)(const int16_t *samples, uint32_t count, uint32_t frameNo, uint32_t timestampMs);
+
+/// Observer block for received G.711a frames as one pooled buffer shared by
+/// every observer (see FramePool.h)
+/// @param buffer Lent for the call; frame_buffer_retain it to keep the frame
+///               past the call, and frame_buffer_release it when done
+typedef void (^AudioFrameBufferBlock)(frame_buffer *buffer);
+
+/// Sample rate and frame size of the stream, inferred from its first frames
+/// (see StreamFormatDetector.h)
+typedef struct {
+    uint32_t sampleRate;        ///< Hz (0 until detected)
+    uint32_t frameSamples;      ///< Samples per frame (= A-law bytes)
+    uint32_t frameMs;           ///< Duration of one frame
+    BOOL detected;
+    BOOL fromTimestamps;        ///< Decided by head.timestamp rather than arrival cadence or fallback
+} DetectedStreamFormat;
+
+/// Called on the main queue once a stream's format is known
+typedef void (^DetectedStreamFormatBlock)(DetectedStreamFormat format);
+
+/// Per-stream activity tracked for every received frame, decoded or not
+/// (read field by field from the stream's session table slot, see SessionTable.h)
+typedef struct {
+    uint64_t frames;            ///< Frames received
+    uint64_t lostFrames;        ///< Gaps in frameNo
+    uint64_t decodeSkipped;     ///< Frames not decoded because no consumer needed PCM
+    uint32_t lastFrameNo;
+    uint32_t lastTimestampMs;   ///< app_frame_header.timestamp of the last frame
+    uint32_t lastArrivalMs;     ///< session_table_now_ms() when the last frame arrived
+    double jitterMs;            ///< Interarrival jitter (RFC 3550), smoothed over ~16 frames
+    double levelDbfs;           ///< RMS of the last frame, from the A-law bytes (0.01 dB steps)
+    double peakDbfs;            ///< Peak of the last frame
+} AudioFrameActivity;
+
 /// Objective-C bridge for hooking into SDK's audio handling
 ///
 /// This class uses the Objective-C runtime to:
@@ -41,7 +91,9 @@ typedef void (^AudioCaptureBlock)(const int16_t *samples, uint32_t count);
 /// Number of frames captured
 @property (nonatomic, readonly) uint64_t capturedFrameCount;
 
-/// Callback for captured audio data
+/// Callback for captured audio data. May be set or cleared from any thread
+/// while frames flow: each frame loads it once, so it is called whole or not
+/// at all, and the replaced block is released once that frame is done.
 @property (nonatomic, copy, nullable) AudioCaptureBlock captureCallback;
 
 #pragma mark - Discovery
@@ -82,6 +134,20 @@ typedef void (^AudioCaptureBlock)(const int16_t *samples, uint32_t count);
 /// Increment captured frame count (for internal use by callback)
 - (void)incrementCapturedFrameCount:(uint32_t)count;
 
+#pragma mark - Warm-up
+
+/// Preallocate the G.711 decode buffer so the first captured frames
+/// don't have to allocate (the render conversion buffer is static).
+/// Runs on the capture queue, so it is safe while frames are decoding;
+/// buffers already large enough are kept.
+/// @param maxSamples Largest frame (in samples) expected from the SDK
+- (void)preallocateDecodeBuffers:(size_t)maxSamples;
+
+/// Resolve every SDK symbol the bridge uses (pcmp2, CGI, CSession) up front
+/// Each group resolves once per process under dispatch_once, so this and
+/// the resolve... methods below are safe from any thread, concurrently
+- (void)resolveSDKSymbols;
+
 #pragma mark - Voice Frame Direct Capture (G.711a Bypass)
 
 /// Start polling the SDK's voice_frame directly and decoding G.711a
@@ -92,6 +158,163 @@ typedef void (^AudioCaptureBlock)(const int16_t *samples, uint32_t count);
 /// Stop voice frame capture
 - (void)stopVoiceFrameCapture;
 
+/// voice_frame poll interval in ms (default 10); applies to a running capture immediately
+@property (nonatomic) uint32_t voiceFramePollIntervalMs;
+
+/// Feed one G.711a frame through the same decode → captureCallback path
+/// used for SDK voice frames (used by CameraEmulator to run without a camera).
+/// Runs on the capture queue and returns once the frame has been delivered
+/// @param data A-law payload (1 byte per sample)
+/// @param length Payload size in bytes
+/// @param frameNo Frame number from the frame header
+/// @param timestampMs Stream time in ms from the frame header
+- (void)injectAlawFrame:(const uint8_t *)data length:(size_t)length frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs;
+
+/// Feed one IMA ADPCM frame; it is transcoded to A-law and takes the
+/// injectAlawFrame path
+/// @param length Payload size in bytes (2 samples per byte)
+/// @param state Predictor state the frame starts from
+- (void)injectAdpcmFrame:(const uint8_t *)data length:(size_t)length state:(ima_adpcm_state)state
+                 frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs;
+
+#pragma mark - Frame Codec
+
+/// Encoding of the camera's voice frames
+typedef NS_ENUM(NSInteger, AudioFrameCodec) {
+    AudioFrameCodecG711a = 0,       ///< 1 byte per sample
+    AudioFrameCodecImaAdpcm = 1,    ///< 4 bits per sample, predictor state in the frame header
+};
+
+/// Codec SDK frames are currently decoded as (default G.711a)
+@property (nonatomic, readonly) AudioFrameCodec frameCodec;
+
+/// Announce settings just asked of the camera, before sending the CGI
+///
+/// Frames already in flight keep the old settings, so the capture path
+/// switches on the first frame whose payload has the new size
+/// (`frameSamples` bytes for G.711a, half that for ADPCM) rather than when
+/// the CGI returns.
+/// @return NO if the new settings have the current payload size but another
+///         codec: frames cannot prove that switch, so the current decoder
+///         stays and the settings must not be sent
+- (BOOL)expectFrameCodec:(AudioFrameCodec)codec frameSamples:(uint32_t)frameSamples;
+
+/// Withdraw settings announced with expectFrameCodec that the camera did
+/// not take (rejected, or not reported back). No-op once other settings
+/// were announced or a frame in these settings arrived.
+- (void)cancelFrameCodecExpectation:(AudioFrameCodec)codec frameSamples:(uint32_t)frameSamples;
+
+#pragma mark - Frame Observers
+
+/// Receive every new G.711a frame before it is decoded (called on the
+/// capture thread - observers must not block)
+/// @return Token for removeRawFrameObserver:
+- (NSUInteger)addRawFrameObserver:(AudioRawFrameBlock)observer;
+
+/// Remove an observer added with addRawFrameObserver:
+- (void)removeRawFrameObserver:(NSUInteger)token;
+
+/// Receive every frame after G.711a decoding, with its frame number and
+/// timestamp (called on the capture thread - observers must not block)
+/// @return Token for removeDecodedFrameObserver:
+- (NSUInteger)addDecodedFrameObserver:(AudioDecodedFrameBlock)observer;
+
+/// Remove an observer added with addDecodedFrameObserver:
+- (void)removeDecodedFrameObserver:(NSUInteger)token;
+
+/// Receive every new G.711a frame as a pooled, refcounted buffer. The frame
+/// is copied once per frame however many of these observers there are, so
+/// consumers that keep frames (recorder, relay, analytics) share one payload.
+/// Frames are dropped for these observers while every pooled buffer is held.
+/// @return Token for removeFrameBufferObserver:
+- (NSUInteger)addFrameBufferObserver:(AudioFrameBufferBlock)observer;
+
+/// Remove an observer added with addFrameBufferObserver:
+- (void)removeFrameBufferObserver:(NSUInteger)token;
+
+/// Counters of the pool behind frame buffer observers (zero before the first one)
+- (frame_pool_stats)framePoolStats;
+
+#pragma mark - Lazy Decode
+
+/// Skip G.711a decoding while nothing consumes PCM (no active
+/// captureCallback, no decoded frame observers). Frames are still
+/// deduplicated, archived, passed to raw observers and measured for
+/// frameActivity. Decoding resumes with the first frame after a consumer
+/// attaches. Default YES.
+@property (nonatomic) BOOL lazyDecodeEnabled;
+
+/// Set by the captureCallback's owner while it would discard what it is
+/// given (e.g. engine stopped or muted with nothing recording). An idle
+/// callback is not called and does not count as a consumer. Default NO.
+@property (nonatomic) BOOL captureCallbackIdle;
+
+/// Whether the next frame will be decoded
+@property (nonatomic, readonly) BOOL needsDecodedAudio;
+
+/// Sequence, timing and level of the stream (cheap; safe from any thread)
+- (AudioFrameActivity)frameActivity;
+
+#pragma mark - CPU Accounting
+
+/// Thread CPU time per session and stage. Frame processing charges the SDK
+/// session's receive/publish/decode/deliver stages; AudioBridgeEngine charges
+/// its render callback. NULL only if allocation failed.
+@property (nonatomic, readonly, nullable) session_cpu_meter *cpuMeter;
+
+/// Slot of the SDK voice session in cpuMeter (and the session table)
+@property (nonatomic, readonly) uint32_t sdkSessionSlot;
+
+#pragma mark - Automatic Gain
+
+/// AGC per session (see AutoGain.h), applied to decoded frames before
+/// observers, the capture callback and playout see them. Disabled until
+/// parameters with `enabled` are set for sdkSessionSlot. NULL only if
+/// allocation failed.
+@property (nonatomic, readonly, nullable) auto_gain_bank *autoGain;
+
+#pragma mark - Filters
+
+/// Clean-up filter preset per session (see FilterBank.h): DC block,
+/// high-pass or hum notch on decoded frames, ahead of the AGC. Off until
+/// a preset is set for sdkSessionSlot. NULL only if allocation failed.
+@property (nonatomic, readonly, nullable) filter_bank *filterBank;
+
+#pragma mark - Flight Recorder
+
+/// Recorder that keeps every received frame (see FlightRecorder.h). Must
+/// outlive its attachment: set to NULL before destroying it.
+@property (nonatomic, nullable) flight_recorder *flightRecorder;
+
+#pragma mark - Stream Format
+
+/// Format detected from the first second of frames (detected == NO before;
+/// detection restarts with stopVoiceFrameCapture)
+- (DetectedStreamFormat)streamFormat;
+
+/// Called once per stream when its format is detected, e.g. to configure
+/// AudioBridgeEngine's input rate and jitter bounds
+@property (nonatomic, copy, nullable) DetectedStreamFormatBlock streamFormatCallback;
+
+#pragma mark - Capture Archive
+
+/// Whether received G.711a frames are being recorded to disk
+@property (nonatomic, readonly) BOOL isArchiving;
+
+/// Record every received G.711a frame (undecoded, with frameno/timestamp)
+/// as capture archive segments - see CaptureArchive.h for the format.
+/// Segments are processed offline by the veepa-archive tool. Each closed
+/// segment gets a *.vaci index with its loudness (see Loudness.h). A
+/// segment's header and index carry the detected stream rate; a new rate
+/// starts a new segment.
+/// @param directory Directory for *.vaca segment files (created if needed)
+/// @param segmentDuration Seconds of audio per segment file before rotating
+/// @return NO if the directory could not be created
+- (BOOL)startArchivingToDirectory:(NSString *)directory segmentDuration:(NSTimeInterval)segmentDuration;
+
+/// Stop recording and close the current segment
+- (void)stopArchiving;
+
 #pragma mark - pcmp2 API (Story 10.1)
 
 /// Resolve pcmp2_* symbols from the SDK using dlsym
@@ -10,6 +10,20 @@
 #import <objc/runtime.h>
 #import <AVFoundation/AVFoundation.h>
 #import <dlfcn.h>
+#import <fcntl.h>
+#import <os/lock.h>
+#import "G711.h"
+#import "ImaAdpcm.h"
+#import "AutoGain.h"
+#import "Loudness.h"
+#import "FilterBank.h"
+#import "CaptureArchive.h"
+#import "SessionTable.h"
+#import "SessionCpuMeter.h"
+#import "FramePool.h"
+#import "StreamFormatDetector.h"
+#import "RealtimeSanitizer.h"
+#import "PipelineTrace.h"
 
 // Forward declare the SDK's class
 @class AppIOSPlayer;
@@ -79,11 +93,11 @@ static void testPcmp2ListenerCallback(void *context, const void *data, size_t si
 
         // Forward to AudioHookBridge if this looks like audio
         if (nonZeroCount > 10) {
-            AudioHookBridge *bridge = (__bridge AudioHookBridge *)context;
-            if (bridge.captureCallback) {
+            AudioCaptureBlock callback = capture_callback();
+            if (callback) {
                 // Assume data is PCM16 for now (might need adjustment)
                 size_t sampleCount = size / sizeof(int16_t);
-                bridge.captureCallback((const int16_t *)data, (uint32_t)sampleCount);
+                callback((const int16_t *)data, (uint32_t)sampleCount);
                 NSLog(@"[PCMP2-LISTENER] Forwarded %zu samples to Swift", sampleCount);
             }
         }
@@ -97,51 +111,12 @@ static void testPcmp2ListenerCallbackNoContext(const void *data, size_t size) {
 
 #pragma mark - G.711 A-law Decoder
 
-/// G.711 A-law to 16-bit linear PCM lookup table
-/// A-law is used in European telephony and many IP cameras
-static const int16_t alaw_to_linear[256] = {
-    -5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
-    -7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
-    -2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
-    -3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
-    -22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
-    -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
-    -11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
-    -15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
-    -344, -328, -376, -360, -280, -264, -312, -296,
-    -472, -456, -504, -488, -408, -392, -440, -424,
-    -88, -72, -120, -104, -24, -8, -56, -40,
-    -216, -200, -248, -232, -152, -136, -184, -168,
-    -1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
-    -1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
-    -688, -656, -752, -720, -560, -528, -624, -592,
-    -944, -912, -1008, -976, -816, -784, -880, -848,
-    5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
-    7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
-    2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
-    3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
-    22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
-    30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
-    11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
-    15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
-    344, 328, 376, 360, 280, 264, 312, 296,
-    472, 456, 504, 488, 408, 392, 440, 424,
-    88, 72, 120, 104, 24, 8, 56, 40,
-    216, 200, 248, 232, 152, 136, 184, 168,
-    1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
-    1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
-    688, 656, 752, 720, 560, 528, 624, 592,
-    944, 912, 1008, 976, 816, 784, 880, 848
-};
-
-/// Decode G.711 A-law data to 16-bit PCM
+/// Decode G.711 A-law data to 16-bit PCM (NEON kernel in DSP/G711.c)
 /// @param alaw Input A-law encoded bytes
 /// @param pcm Output 16-bit PCM samples
 /// @param count Number of samples to decode
-static void decode_alaw(const uint8_t *alaw, int16_t *pcm, size_t count) {
-    for (size_t i = 0; i < count; i++) {
-        pcm[i] = alaw_to_linear[alaw[i]];
-    }
+static inline void decode_alaw(const uint8_t *alaw, int16_t *pcm, size_t count) {
+    g711_alaw_decode(alaw, pcm, count);
 }
 
 #pragma mark - Voice Frame Structure
@@ -177,21 +152,509 @@ typedef struct {
     // ... more fields we don't need
 } app_source_frame;
 
-/// Buffer for decoded PCM samples
+/// Buffer for decoded PCM samples (capture queue only)
 static int16_t *g711DecodeBuffer = NULL;
 static size_t g711DecodeBufferSize = 0;
 
-/// Last processed frame number to avoid duplicates
-static uint32_t lastProcessedFrameNo = 0;
+/// Serial queue the voice frame timer decodes on. The decode buffers are
+/// only allocated, grown and freed on it, so warm-up and stop can never
+/// pull a buffer out from under a frame being decoded.
+static const void *const kCaptureQueueKey = &kCaptureQueueKey;
+
+static dispatch_queue_t capture_queue(void) {
+    static dispatch_queue_t queue;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        dispatch_queue_attr_t attributes =
+            dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
+        queue = dispatch_queue_create("com.veepatest.voice-capture", attributes);
+        dispatch_queue_set_specific(queue, kCaptureQueueKey, (void *)kCaptureQueueKey, NULL);
+    });
+    return queue;
+}
+
+/// Run `block` on the capture queue and wait for it (inline if already there)
+static void sync_on_capture_queue(dispatch_block_t block) {
+    if (dispatch_get_specific(kCaptureQueueKey) == kCaptureQueueKey) {
+        block();
+    } else {
+        dispatch_sync(capture_queue(), block);
+    }
+}
+
+/// Make g711DecodeBuffer hold at least `samples` (capture queue; only
+/// allocates when the buffer is absent or too small)
+static void reserve_decode_buffer(size_t samples) {
+    if (g711DecodeBuffer != NULL && g711DecodeBufferSize >= samples) return;
+    int16_t *buffer = (int16_t *)malloc(samples * sizeof(int16_t));
+    if (buffer == NULL) return;
+    free(g711DecodeBuffer);
+    g711DecodeBuffer = buffer;
+    g711DecodeBufferSize = samples;
+}
+
+/// Per-stream hot state (last processed frame number for deduplication,
+/// activity counters, levels) lives in a session table slot; the SDK's
+/// voice stream is the one session this bridge feeds
+static session_table *g_sessions = NULL;
+static session_slot g_sdkSession = SESSION_SLOT_NONE;
+
+/// Thread CPU time charged per session slot and stage (same slots as g_sessions)
+static session_cpu_meter *g_cpuMeter = NULL;
+
+/// Automatic gain per session slot (same slots as g_sessions)
+static auto_gain_bank *g_autoGain = NULL;
+
+/// Clean-up filter preset per session slot (same slots as g_sessions)
+static filter_bank *g_filterBank = NULL;
+
+static session_slot sdk_session(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        g_sessions = session_table_create(8);
+        if (g_sessions == NULL) return;
+        g_cpuMeter = session_cpu_meter_create(session_table_capacity(g_sessions));
+        g_sdkSession = session_table_acquire(g_sessions);
+        if (g_cpuMeter != NULL) session_cpu_meter_reset_slot(g_cpuMeter, g_sdkSession);
+        g_autoGain = auto_gain_bank_create(session_table_capacity(g_sessions));
+        g_filterBank = filter_bank_create(session_table_capacity(g_sessions));
+        session_cold *cold = session_table_cold(g_sessions, g_sdkSession);
+        strlcpy(cold->name, "sdk-voice", sizeof(cold->name));
+        cold->sample_rate = 16000;
+    });
+    return g_sdkSession;
+}
+
+static uint32_t last_processed_frame_no(void) {
+    session_slot slot = sdk_session();
+    if (slot == SESSION_SLOT_NONE) return 0;
+    return __atomic_load_n(&session_table_columns(g_sessions)->last_frame_no[slot], __ATOMIC_RELAXED);
+}
 
 /// Timer for polling voice frames
 static dispatch_source_t voiceFrameTimer = NULL;
 
+#pragma mark - Frame Observers
+
+/// Observer registry; `snapshot` is immutable and replaced on add/remove,
+/// so the capture thread only takes the lock long enough to retain it
+typedef struct {
+    NSArray *snapshot;
+    NSMutableDictionary<NSNumber *, id> *byToken;
+} observer_list;
+
+static observer_list g_rawFrameObservers;
+static observer_list g_decodedFrameObservers;
+static observer_list g_frameBufferObservers;
+static NSUInteger g_nextObserverToken = 1;
+static os_unfair_lock g_observerLock = OS_UNFAIR_LOCK_INIT;
+
+static NSUInteger observer_list_add(observer_list *list, id observer) {
+    os_unfair_lock_lock(&g_observerLock);
+    if (list->byToken == nil) {
+        list->byToken = [NSMutableDictionary dictionary];
+    }
+    NSUInteger token = g_nextObserverToken++;
+    list->byToken[@(token)] = [observer copy];
+    list->snapshot = [list->byToken.allValues copy];
+    os_unfair_lock_unlock(&g_observerLock);
+    return token;
+}
+
+static void observer_list_remove(observer_list *list, NSUInteger token) {
+    os_unfair_lock_lock(&g_observerLock);
+    [list->byToken removeObjectForKey:@(token)];
+    list->snapshot = [list->byToken.allValues copy];
+    os_unfair_lock_unlock(&g_observerLock);
+}
+
+static NSArray *observer_list_snapshot(observer_list *list) {
+    os_unfair_lock_lock(&g_observerLock);
+    NSArray *snapshot = list->snapshot;
+    os_unfair_lock_unlock(&g_observerLock);
+    return snapshot;
+}
+
+static NSUInteger observer_list_count(observer_list *list) {
+    return observer_list_snapshot(list).count;
+}
+
+/// Hand a received frame to every raw frame observer
+static void notify_raw_frame(const uint8_t *alaw, size_t length, uint32_t frameNo, uint32_t timestamp) {
+    for (AudioRawFrameBlock observer in observer_list_snapshot(&g_rawFrameObservers)) {
+        observer(alaw, (uint32_t)length, frameNo, timestamp);
+    }
+}
+
+/// Hand a decoded frame to every decoded frame observer
+static void notify_decoded_frame(const int16_t *samples, size_t count, uint32_t frameNo, uint32_t timestamp) {
+    for (AudioDecodedFrameBlock observer in observer_list_snapshot(&g_decodedFrameObservers)) {
+        observer(samples, (uint32_t)count, frameNo, timestamp);
+    }
+}
+
+/// Pool behind frame buffer observers, created with the first one and
+/// never destroyed (observers may hold its buffers at any time)
+static frame_pool *g_framePool = NULL;
+static dispatch_once_t g_framePoolOnce;
+
+static frame_pool *shared_frame_pool(void) {
+    dispatch_once(&g_framePoolOnce, ^{
+        frame_pool_config config;
+        frame_pool_config_init(&config);
+        g_framePool = frame_pool_create(&config);
+        if (g_framePool == NULL) {
+            NSLog(@"[AudioHookBridge] ❌ Cannot create frame pool");
+        }
+    });
+    return g_framePool;
+}
+
+/// Copy a received frame into one pooled buffer and lend it to every frame
+/// buffer observer; observers that keep it hold their own reference
+static void notify_frame_buffer(const uint8_t *alaw, size_t length, uint32_t frameNo, uint32_t timestamp) {
+    NSArray *observers = observer_list_snapshot(&g_frameBufferObservers);
+    if (observers.count == 0) return;
+
+    frame_pool *pool = shared_frame_pool();
+    if (pool == NULL) return;
+    frame_buffer *buffer = frame_pool_copy(pool, alaw, (uint32_t)length, frameNo, timestamp, NULL);
+    if (buffer == NULL) return;  // Exhausted (counted in framePoolStats) or oversized
+
+    for (AudioFrameBufferBlock observer in observers) {
+        observer(buffer);
+    }
+    frame_buffer_release(buffer);
+}
+
+#pragma mark - Frame Activity
+
+/// Record sequence, timing and level of a frame from its A-law bytes
+static void track_frame_activity(const uint8_t *alaw, size_t length, uint32_t frameNo, uint32_t timestamp, BOOL skipped) {
+    session_slot slot = sdk_session();
+    if (slot == SESSION_SLOT_NONE) return;
+
+    g711_alaw_level level = {0};
+    g711_alaw_measure(alaw, length, &level);
+    session_table_on_frame(g_sessions, slot, frameNo, timestamp,
+                           g711_alaw_level_rms_dbfs(&level), g711_alaw_level_peak_dbfs(&level), !skipped);
+}
+
+/// Run the SDK session's AGC on a frame, with the level and peak that
+/// track_frame_activity just stored (no second measurement)
+/// @param pcm Decoded frame, or NULL to only track the level
+static void apply_auto_gain(int16_t *pcm, size_t count) {
+    session_slot slot = sdk_session();
+    if (slot == SESSION_SLOT_NONE || g_autoGain == NULL) return;
+
+    const session_hot_columns *columns = session_table_columns(g_sessions);
+    auto_gain_process(g_autoGain, slot, pcm, count, session_table_cold(g_sessions, slot)->sample_rate,
+                      __atomic_load_n(&columns->level_cb[slot], __ATOMIC_RELAXED),
+                      __atomic_load_n(&columns->peak_cb[slot], __ATOMIC_RELAXED));
+}
+
+/// Run the SDK session's clean-up filter preset on a decoded frame
+static void apply_filters(int16_t *pcm, size_t count) {
+    session_slot slot = sdk_session();
+    if (slot == SESSION_SLOT_NONE || g_filterBank == NULL) return;
+    filter_bank_process(g_filterBank, slot, pcm, count, session_table_cold(g_sessions, slot)->sample_rate);
+}
+
+#pragma mark - Stream Format Detection
+
+/// Detector for the SDK stream (capture thread; initialized in -init); the
+/// result is published once to g_streamFormat for other threads
+static stream_format_detector g_formatDetector;
+static stream_format g_streamFormat;
+static int g_streamFormatDecided = 0;  // (atomic)
+
+static void reset_stream_format(void) {
+    __atomic_store_n(&g_streamFormatDecided, 0, __ATOMIC_RELEASE);
+    stream_format_detector_init(&g_formatDetector, NULL);
+}
+
+/// Feed one frame; @return YES if it completed detection
+static BOOL detect_stream_format(size_t length, uint32_t frameNo, uint32_t timestamp) {
+    if (__atomic_load_n(&g_streamFormatDecided, __ATOMIC_RELAXED)) return NO;
+    if (sdk_session() == SESSION_SLOT_NONE) return NO;
+
+    uint32_t arrival = session_table_now_ms(g_sessions);
+    if (!stream_format_detector_observe(&g_formatDetector, frameNo, (uint32_t)length, timestamp, arrival)) {
+        return NO;
+    }
+    g_streamFormat = g_formatDetector.format;
+    session_table_cold(g_sessions, g_sdkSession)->sample_rate = g_streamFormat.sample_rate;
+    __atomic_store_n(&g_streamFormatDecided, 1, __ATOMIC_RELEASE);
+    return YES;
+}
+
+static DetectedStreamFormat published_stream_format(void) {
+    DetectedStreamFormat format = {0};
+    if (!__atomic_load_n(&g_streamFormatDecided, __ATOMIC_ACQUIRE)) return format;
+    format.sampleRate = g_streamFormat.sample_rate;
+    format.frameSamples = g_streamFormat.frame_samples;
+    format.frameMs = g_streamFormat.frame_ms;
+    format.detected = YES;
+    format.fromTimestamps = g_streamFormat.source == STREAM_FORMAT_TIMESTAMPS;
+    return format;
+}
+
+#pragma mark - Frame Codec State
+
+/// Codec and payload size of SDK frames, packed as (codec << 32 | bytes):
+/// the settings frames arrive in now (bytes 0 = not known), and the ones
+/// last asked of the camera (0 = nothing pending). Set from the main
+/// thread by expectFrameCodec, promoted per frame on the capture thread.
+static uint64_t g_currentFrameCodec = 0;   // (atomic)
+static uint64_t g_expectedFrameCodec = 0;  // (atomic)
+
+static inline uint64_t pack_frame_codec(AudioFrameCodec codec, uint32_t bytes) {
+    return ((uint64_t)codec << 32) | bytes;
+}
+
+/// Codec of an SDK frame from its payload size: the first frame of the
+/// expected size switches over, anything else keeps the current codec
+static AudioFrameCodec classify_frame(size_t length) {
+    uint64_t expected = __atomic_load_n(&g_expectedFrameCodec, __ATOMIC_ACQUIRE);
+    if (expected != 0 && (uint32_t)expected == length) {
+        uint64_t pending = expected;
+        __atomic_store_n(&g_currentFrameCodec, expected, __ATOMIC_RELEASE);
+        __atomic_compare_exchange_n(&g_expectedFrameCodec, &pending, 0, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+        return (AudioFrameCodec)(expected >> 32);
+    }
+
+    uint64_t current = __atomic_load_n(&g_currentFrameCodec, __ATOMIC_ACQUIRE);
+    if ((uint32_t)current == 0 && expected == 0) {
+        // Learn the size in use, so a later switch to the same size is seen as ambiguous
+        __atomic_store_n(&g_currentFrameCodec, current | (uint32_t)length, __ATOMIC_RELEASE);
+    }
+    return (AudioFrameCodec)(current >> 32);
+}
+
+/// A-law transcode of the last ADPCM frame (capture thread)
+static uint8_t *g_adpcmAlawBuffer = NULL;
+static size_t g_adpcmAlawBufferSize = 0;
+
+/// Capture queue only, like g711DecodeBuffer
+static void reserve_adpcm_buffer(size_t samples) {
+    if (g_adpcmAlawBuffer != NULL && g_adpcmAlawBufferSize >= samples) return;
+    uint8_t *buffer = (uint8_t *)malloc(samples);
+    if (buffer == NULL) return;
+    free(g_adpcmAlawBuffer);
+    g_adpcmAlawBuffer = buffer;
+    g_adpcmAlawBufferSize = samples;
+}
+
+/// Transcode an ADPCM frame into g_adpcmAlawBuffer (2 samples per byte)
+/// @return The A-law frame, or NULL if the buffer cannot grow
+static const uint8_t *transcode_adpcm_frame(const uint8_t *adpcm, size_t length, ima_adpcm_state state) {
+    reserve_adpcm_buffer(length * 2);
+    if (g_adpcmAlawBuffer == NULL || g_adpcmAlawBufferSize < length * 2) return NULL;
+    ima_adpcm_transcode_alaw(adpcm, length, &state, g_adpcmAlawBuffer);
+    return g_adpcmAlawBuffer;
+}
+
+#pragma mark - Capture Callback State
+
+/// The capture callback: set and cleared from any thread, loaded once
+/// per frame on the capture thread. Guarded by g_observerLock like the
+/// observer snapshots, so a reader retains the block it calls.
+static AudioCaptureBlock g_captureCallback = nil;
+
+static AudioCaptureBlock capture_callback(void) {
+    os_unfair_lock_lock(&g_observerLock);
+    AudioCaptureBlock callback = g_captureCallback;
+    os_unfair_lock_unlock(&g_observerLock);
+    return callback;
+}
+
+/// The same block for the render notify, which may neither lock nor
+/// retain: published unretained, and while the notify is installed a
+/// replaced block is kept in g_retiredCaptureCallbacks (g_observerLock) until
+/// the notify is removed, so a render cycle that loaded it can still call it
+static void *g_renderCaptureCallback = NULL;  // (atomic)
+static NSMutableArray *g_retiredCaptureCallbacks = nil;
+
+/// Samples handed to the capture callback (any thread)
+static uint64_t g_capturedSamples = 0;  // (atomic)
+
+#pragma mark - Flight Recorder State
+
+/// Set from the main thread, read per frame on the capture thread
+static flight_recorder *g_flightRecorder = NULL;  // (atomic)
+
+#pragma mark - Lazy Decode State
+
+/// Set by the engine on the main thread, read per frame on the capture thread
+static BOOL g_captureCallbackIdle = NO;  // (atomic)
+
+#pragma mark - Capture Archive State
+
+/// Serial queue for segment file I/O (keeps write() off the poll timer)
+static dispatch_queue_t g_archiveQueue = NULL;
+static NSString *g_archiveDirectory = nil;
+static NSTimeInterval g_archiveSegmentDuration = 600;
+static int g_archiveFd = -1;
+static int64_t g_archiveSegmentStartMs = 0;
+static uint32_t g_archiveSegmentRate = 0;   // Rate in the open segment's header
+static volatile BOOL g_archiving = NO;
+
+/// Segment index: loudness and counts measured as frames are written, so
+/// the *.vaci next to each segment is ready when the segment closes
+static NSString *g_archiveSegmentPath = nil;
+static loudness_meter *g_archiveLoudness = NULL;
+static uint32_t g_archiveSegmentFrames = 0;
+static uint64_t g_archiveSegmentSamples = 0;
+static int16_t g_archiveDecodeBuffer[4096];
+
+/// Write the index of the segment being closed (archive queue only)
+static void archive_write_index(void) {
+    if (g_archiveSegmentPath == nil || g_archiveLoudness == NULL) return;
+
+    capture_archive_index index = {
+        .magic = CAPTURE_ARCHIVE_INDEX_MAGIC,
+        .version = CAPTURE_ARCHIVE_INDEX_VERSION,
+        .histogram_bins = LOUDNESS_HISTOGRAM_BINS,
+        .sample_rate = g_archiveSegmentRate,
+        .frames = g_archiveSegmentFrames,
+        .samples = g_archiveSegmentSamples,
+    };
+    loudness_reading reading = loudness_meter_read(g_archiveLoudness);
+    index.integrated_clu = reading.integrated_clu;
+    index.max_momentary_clu = reading.max_momentary_clu;
+    index.max_short_term_clu = reading.max_short_term_clu;
+    uint32_t histogram[LOUDNESS_HISTOGRAM_BINS];
+    loudness_meter_histogram(g_archiveLoudness, histogram);
+
+    NSString *path = [[g_archiveSegmentPath stringByDeletingPathExtension]
+                      stringByAppendingPathExtension:@CAPTURE_ARCHIVE_INDEX_EXTENSION];
+    int fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || capture_archive_write_index(fd, &index, histogram) != CAPTURE_ARCHIVE_OK) {
+        NSLog(@"[AudioHookBridge] ⚠️ Cannot write archive index %@ (errno %d)", path.lastPathComponent, errno);
+    }
+    if (fd >= 0) close(fd);
+}
+
+/// Close the current segment (archive queue only)
+static void archive_close_segment(void) {
+    if (g_archiveFd >= 0) {
+        close(g_archiveFd);
+        g_archiveFd = -1;
+        archive_write_index();
+        g_archiveSegmentPath = nil;
+    }
+}
+
+/// Open a new segment named after its start time (archive queue only)
+/// @param sampleRate Stream rate of the frames that go into it
+static BOOL archive_open_segment(int64_t nowMs, uint32_t sampleRate) {
+    archive_close_segment();
+
+    // A rate change can rotate within the millisecond the previous segment
+    // started: later segments of that millisecond get -1, -2, ...
+    NSString *name = nil;
+    NSString *path = nil;
+    int fd = -1;
+    for (unsigned attempt = 0; fd < 0 && attempt < 100; attempt++) {
+        name = attempt == 0
+            ? [NSString stringWithFormat:@"capture-%lld.%s", nowMs, CAPTURE_ARCHIVE_EXTENSION]
+            : [NSString stringWithFormat:@"capture-%lld-%u.%s", nowMs, attempt, CAPTURE_ARCHIVE_EXTENSION];
+        path = [g_archiveDirectory stringByAppendingPathComponent:name];
+        fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        NSLog(@"[AudioHookBridge] ❌ Cannot create archive segment %@ (errno %d)", path, errno);
+        return NO;
+    }
+    if (capture_archive_write_header(fd, sampleRate, nowMs) != CAPTURE_ARCHIVE_OK) {
+        close(fd);
+        return NO;
+    }
+
+    g_archiveFd = fd;
+    g_archiveSegmentStartMs = nowMs;
+    g_archiveSegmentPath = path;
+    g_archiveSegmentFrames = 0;
+    g_archiveSegmentSamples = 0;
+    if (g_archiveLoudness == NULL || g_archiveSegmentRate != sampleRate) {
+        // K-weighting is designed for one rate
+        loudness_meter_destroy(g_archiveLoudness);
+        g_archiveLoudness = loudness_meter_create(sampleRate);
+    }
+    g_archiveSegmentRate = sampleRate;
+    if (g_archiveLoudness != NULL) loudness_meter_reset(g_archiveLoudness);
+    NSLog(@"[AudioHookBridge] 💾 Archive segment: %@ (%u Hz)", name, sampleRate);
+    return YES;
+}
+
+/// Queue one received frame for the archive (no-op when not archiving).
+/// Segments carry the SDK session's rate as detected so far (capture
+/// thread); a new rate starts a new segment, so every header, index and
+/// loudness measurement matches the frames it describes.
+static void archive_frame(const uint8_t *alaw, size_t length, uint32_t frameNo, uint32_t timestamp) {
+    if (!g_archiving || length == 0 || length > UINT16_MAX) return;
+
+    session_slot slot = sdk_session();
+    uint32_t sampleRate = slot == SESSION_SLOT_NONE ? 16000 : session_table_cold(g_sessions, slot)->sample_rate;
+    NSData *payload = [NSData dataWithBytes:alaw length:length];
+    dispatch_async(g_archiveQueue, ^{
+        if (!g_archiving) return;
+
+        int64_t nowMs = (int64_t)([[NSDate date] timeIntervalSince1970] * 1000);
+        BOOL rotate = g_archiveFd < 0 || sampleRate != g_archiveSegmentRate
+            || nowMs - g_archiveSegmentStartMs >= (int64_t)(g_archiveSegmentDuration * 1000);
+        if (rotate && !archive_open_segment(nowMs, sampleRate)) return;
+
+        if (capture_archive_append(g_archiveFd, frameNo, timestamp, payload.bytes, (uint16_t)payload.length) != CAPTURE_ARCHIVE_OK) {
+            NSLog(@"[AudioHookBridge] ❌ Archive write failed (errno %d) - stopping", errno);
+            g_archiving = NO;
+            archive_close_segment();
+            return;
+        }
+
+        // Measure the segment for its index while the frame is at hand
+        g_archiveSegmentFrames++;
+        g_archiveSegmentSamples += payload.length;
+        const uint8_t *bytes = payload.bytes;
+        for (size_t offset = 0; offset < payload.length && g_archiveLoudness != NULL; offset += 4096) {
+            size_t count = MIN((size_t)payload.length - offset, (size_t)4096);
+            g711_alaw_decode(bytes + offset, g_archiveDecodeBuffer, count);
+            loudness_meter_add(g_archiveLoudness, g_archiveDecodeBuffer, count);
+        }
+    });
+}
+
 #pragma mark - Render Notify Callback
 
-/// Temporary buffer for format conversion (Float32 stereo → Int16 mono)
-static int16_t *conversionBuffer = NULL;
-static uint32_t conversionBufferSize = 0;
+/// Conversion buffer (Float32 stereo → Int16 mono), preallocated: render
+/// slices never exceed kAudioUnitProperty_MaximumFramesPerSlice (4096)
+#define kMaxConversionFrames 4096
+static int16_t conversionBuffer[kMaxConversionFrames];
+
+/// What the render notify saw in one of its first callbacks. Recorded on the
+/// audio thread and logged by the diagnostics timer - the callback itself
+/// never logs (NSLog allocates and takes locks).
+typedef struct {
+    uint32_t channels;
+    uint32_t frames;
+    uint32_t byteSize;
+    BOOL isFloat32;
+    float minValue;
+    float maxValue;
+    float avgAbs;
+    uint32_t rawByteCount;
+    uint8_t rawBytes[32];
+} render_notify_snapshot;
+
+#define kRenderNotifySnapshots 5
+static render_notify_snapshot g_renderSnapshots[kRenderNotifySnapshots];
+static uint32_t g_renderSnapshotCount = 0;      ///< (atomic) Written by the audio thread
+static uint32_t g_renderSnapshotsLogged = 0;    ///< Diagnostics timer only
+static uint64_t g_renderNotifyCalls = 0;        ///< (atomic)
+static uint32_t g_renderCallbackMissing = 0;    ///< (atomic) Callbacks with nothing forwarded
+static uint32_t g_renderStatusLogs = 0;         ///< Diagnostics timer only
+static dispatch_source_t g_renderDiagnosticsTimer = NULL;
 
 /// C callback for AudioUnitAddRenderNotify
 static OSStatus RenderNotifyCallback(
@@ -207,17 +670,18 @@ static OSStatus RenderNotifyCallback(
         return noErr;
     }
 
-    // Get our bridge instance
-    AudioHookBridge *bridge = (__bridge AudioHookBridge *)inRefCon;
+    rt_sanitizer_enter();
 
     // Need valid data
     if (ioData == NULL || ioData->mNumberBuffers == 0) {
+        rt_sanitizer_leave();
         return noErr;
     }
 
     // Get the audio data
     AudioBuffer *buffer = &ioData->mBuffers[0];
     if (buffer->mData == NULL || buffer->mDataByteSize == 0) {
+        rt_sanitizer_leave();
         return noErr;
     }
 
@@ -227,23 +691,19 @@ static OSStatus RenderNotifyCallback(
     if (channels == 0) channels = 2;  // Default to stereo if not set
 
     // Calculate frame count (inNumberFrames is the authoritative count)
-    uint32_t frameCount = inNumberFrames;
-
-    // Log format detection once
-    static BOOL formatLogged = NO;
-    if (!formatLogged) {
-        formatLogged = YES;
-        NSLog(@"[AudioHookBridge] 📊 Audio buffer format:");
-        NSLog(@"[AudioHookBridge]    Channels: %u", channels);
-        NSLog(@"[AudioHookBridge]    Frames: %u", frameCount);
-        NSLog(@"[AudioHookBridge]    Byte size: %u", buffer->mDataByteSize);
-        NSLog(@"[AudioHookBridge]    Bytes per frame: %u", frameCount > 0 ? buffer->mDataByteSize / frameCount : 0);
-    }
-
-    // Check if data is actually non-zero (not silence)
-    static int sampleCheckCount = 0;
-    if (sampleCheckCount < 5) {
-        sampleCheckCount++;
+    uint32_t frameCount = MIN((uint32_t)inNumberFrames, (uint32_t)kMaxConversionFrames);
+
+    // Determine if data is Float32 or Int16
+    // Float32 stereo: bytesPerFrame = 4 * 2 = 8
+    // Int16 stereo: bytesPerFrame = 2 * 2 = 4
+    // Int16 mono: bytesPerFrame = 2
+    uint32_t bytesPerFrame = frameCount > 0 ? buffer->mDataByteSize / frameCount : 0;
+    BOOL isFloat32 = (bytesPerFrame >= 4 * channels);  // 4 bytes per Float32 sample per channel
+
+    // Snapshot the first few buffers for the diagnostics timer
+    uint32_t snapshotIndex = __atomic_load_n(&g_renderSnapshotCount, __ATOMIC_RELAXED);
+    if (snapshotIndex < kRenderNotifySnapshots) {
+        render_notify_snapshot *snapshot = &g_renderSnapshots[snapshotIndex];
         float *floatCheck = (float *)buffer->mData;
         float minVal = floatCheck[0], maxVal = floatCheck[0], sumAbs = 0;
         for (uint32_t i = 0; i < frameCount && i < 480; i++) {
@@ -252,59 +712,24 @@ static OSStatus RenderNotifyCallback(
             if (val > maxVal) maxVal = val;
             sumAbs += fabsf(val);
         }
-        float avgAbs = sumAbs / (frameCount > 0 ? frameCount : 1);
-        NSLog(@"[AudioHookBridge] 📈 Sample values check #%d:", sampleCheckCount);
-        NSLog(@"[AudioHookBridge]    Min: %.6f, Max: %.6f, AvgAbs: %.6f", minVal, maxVal, avgAbs);
-
-        // RAW DATA DUMP - Show first 32 bytes as hex and first 8 float values
-        NSLog(@"[AudioHookBridge] 🔬 RAW DATA DUMP (first 32 bytes as hex):");
-        uint8_t *rawBytes = (uint8_t *)buffer->mData;
-        NSMutableString *hexStr = [NSMutableString string];
-        for (int i = 0; i < 32 && i < buffer->mDataByteSize; i++) {
-            [hexStr appendFormat:@"%02X ", rawBytes[i]];
-            if ((i + 1) % 16 == 0) [hexStr appendString:@"\n                                      "];
-        }
-        NSLog(@"[AudioHookBridge]    Hex: %@", hexStr);
-
-        NSLog(@"[AudioHookBridge] 🔬 First 8 Float32 values:");
-        for (int i = 0; i < 8 && i < frameCount; i++) {
-            NSLog(@"[AudioHookBridge]    [%d] = %.10f (hex: 0x%08X)", i, floatCheck[i], *(uint32_t*)&floatCheck[i]);
-        }
-
-        if (avgAbs < 0.0001f) {
-            NSLog(@"[AudioHookBridge] ⚠️ WARNING: Data appears to be SILENCE (avgAbs < 0.0001)");
-            NSLog(@"[AudioHookBridge] ════════════════════════════════════════════════════════════");
-            NSLog(@"[AudioHookBridge] 🛑 DIAGNOSIS: SDK's AudioUnit render buffer is EMPTY!");
-            NSLog(@"[AudioHookBridge]    The SDK failed with error -50 when configuring its AudioUnit.");
-            NSLog(@"[AudioHookBridge]    Because of this failure, the SDK never connects its audio");
-            NSLog(@"[AudioHookBridge]    decoder output to this render buffer.");
-            NSLog(@"[AudioHookBridge]    We are capturing from the WRONG place in the audio pipeline.");
-            NSLog(@"[AudioHookBridge]    The decoded audio exists somewhere BEFORE this render callback.");
-            NSLog(@"[AudioHookBridge] ════════════════════════════════════════════════════════════");
-        } else {
-            NSLog(@"[AudioHookBridge] ✅ Data contains real audio (avgAbs = %.6f)", avgAbs);
-        }
-    }
-
-    // Determine if data is Float32 or Int16
-    // Float32 stereo: bytesPerFrame = 4 * 2 = 8
-    // Int16 stereo: bytesPerFrame = 2 * 2 = 4
-    // Int16 mono: bytesPerFrame = 2
-    uint32_t bytesPerFrame = frameCount > 0 ? buffer->mDataByteSize / frameCount : 0;
-    BOOL isFloat32 = (bytesPerFrame >= 4 * channels);  // 4 bytes per Float32 sample per channel
+        snapshot->channels = channels;
+        snapshot->frames = frameCount;
+        snapshot->byteSize = buffer->mDataByteSize;
+        snapshot->isFloat32 = isFloat32;
+        snapshot->minValue = minVal;
+        snapshot->maxValue = maxVal;
+        snapshot->avgAbs = sumAbs / (frameCount > 0 ? frameCount : 1);
+        snapshot->rawByteCount = MIN(buffer->mDataByteSize, (uint32_t)sizeof(snapshot->rawBytes));
+        memcpy(snapshot->rawBytes, buffer->mData, snapshot->rawByteCount);
+        __atomic_store_n(&g_renderSnapshotCount, snapshotIndex + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_fetch_add(&g_renderNotifyCalls, 1, __ATOMIC_RELAXED);
 
     int16_t *outputSamples = NULL;
     uint32_t outputSampleCount = 0;
 
     if (isFloat32) {
         // Convert Float32 to Int16 mono
-        // Ensure conversion buffer is large enough
-        if (conversionBuffer == NULL || conversionBufferSize < frameCount) {
-            if (conversionBuffer) free(conversionBuffer);
-            conversionBufferSize = frameCount * 2;  // Extra room
-            conversionBuffer = (int16_t *)malloc(conversionBufferSize * sizeof(int16_t));
-        }
-
         float *floatData = (float *)buffer->mData;
 
         for (uint32_t i = 0; i < frameCount; i++) {
@@ -327,25 +752,12 @@ static OSStatus RenderNotifyCallback(
 
         outputSamples = conversionBuffer;
         outputSampleCount = frameCount;
-
-        static BOOL conversionLogged = NO;
-        if (!conversionLogged) {
-            conversionLogged = YES;
-            NSLog(@"[AudioHookBridge] 🔄 Converting Float32 %s → Int16 mono (%u frames)",
-                  channels >= 2 ? "stereo" : "mono", frameCount);
-        }
     } else {
         // Assume Int16 format
         int16_t *int16Data = (int16_t *)buffer->mData;
 
         if (channels >= 2) {
             // Stereo Int16: convert to mono
-            if (conversionBuffer == NULL || conversionBufferSize < frameCount) {
-                if (conversionBuffer) free(conversionBuffer);
-                conversionBufferSize = frameCount * 2;
-                conversionBuffer = (int16_t *)malloc(conversionBufferSize * sizeof(int16_t));
-            }
-
             for (uint32_t i = 0; i < frameCount; i++) {
                 int32_t left = int16Data[i * 2];
                 int32_t right = int16Data[i * 2 + 1];
@@ -361,37 +773,90 @@ static OSStatus RenderNotifyCallback(
         }
     }
 
-    // Update statistics via method
-    [bridge incrementCapturedFrameCount:outputSampleCount];
+    __atomic_fetch_add(&g_capturedSamples, outputSampleCount, __ATOMIC_RELAXED);
 
-    // Call the capture callback if set
-    static BOOL callbackLogged = NO;
-    if (bridge.captureCallback && outputSamples) {
-        if (!callbackLogged) {
-            NSLog(@"[AudioHookBridge] 📤 Calling Swift captureCallback with %u samples (converted)", outputSampleCount);
-            callbackLogged = YES;
-        }
-        bridge.captureCallback(outputSamples, outputSampleCount);
+    // Call the capture callback if set (unretained: see g_renderCaptureCallback)
+    __unsafe_unretained AudioCaptureBlock callback =
+        (__bridge AudioCaptureBlock)__atomic_load_n(&g_renderCaptureCallback, __ATOMIC_ACQUIRE);
+    if (callback && outputSamples) {
+        callback(outputSamples, outputSampleCount);
     } else {
-        static BOOL noCallbackLogged = NO;
-        if (!noCallbackLogged) {
-            NSLog(@"[AudioHookBridge] ⚠️ captureCallback is NULL or no samples - audio not forwarded!");
-            noCallbackLogged = YES;
+        __atomic_fetch_add(&g_renderCallbackMissing, 1, __ATOMIC_RELAXED);
+    }
+
+    rt_sanitizer_leave();
+    return noErr;
+}
+
+/// Log what the render notify recorded since the last tick (main queue)
+static void log_render_notify_diagnostics(AudioHookBridge *bridge) {
+    uint32_t recorded = __atomic_load_n(&g_renderSnapshotCount, __ATOMIC_ACQUIRE);
+    for (; g_renderSnapshotsLogged < recorded; g_renderSnapshotsLogged++) {
+        const render_notify_snapshot *snapshot = &g_renderSnapshots[g_renderSnapshotsLogged];
+
+        if (g_renderSnapshotsLogged == 0) {
+            NSLog(@"[AudioHookBridge] 📊 Audio buffer format:");
+            NSLog(@"[AudioHookBridge]    Channels: %u", snapshot->channels);
+            NSLog(@"[AudioHookBridge]    Frames: %u", snapshot->frames);
+            NSLog(@"[AudioHookBridge]    Byte size: %u", snapshot->byteSize);
+            NSLog(@"[AudioHookBridge]    Bytes per frame: %u", snapshot->frames > 0 ? snapshot->byteSize / snapshot->frames : 0);
+            if (snapshot->isFloat32) {
+                NSLog(@"[AudioHookBridge] 🔄 Converting Float32 %s → Int16 mono (%u frames)",
+                      snapshot->channels >= 2 ? "stereo" : "mono", snapshot->frames);
+            }
+        }
+
+        NSLog(@"[AudioHookBridge] 📈 Sample values check #%u:", g_renderSnapshotsLogged + 1);
+        NSLog(@"[AudioHookBridge]    Min: %.6f, Max: %.6f, AvgAbs: %.6f",
+              snapshot->minValue, snapshot->maxValue, snapshot->avgAbs);
+
+        // RAW DATA DUMP - Show first 32 bytes as hex and first 8 float values
+        NSLog(@"[AudioHookBridge] 🔬 RAW DATA DUMP (first 32 bytes as hex):");
+        NSMutableString *hexStr = [NSMutableString string];
+        for (uint32_t i = 0; i < snapshot->rawByteCount; i++) {
+            [hexStr appendFormat:@"%02X ", snapshot->rawBytes[i]];
+            if ((i + 1) % 16 == 0) [hexStr appendString:@"\n                                      "];
+        }
+        NSLog(@"[AudioHookBridge]    Hex: %@", hexStr);
+
+        NSLog(@"[AudioHookBridge] 🔬 First 8 Float32 values:");
+        const float *floatCheck = (const float *)snapshot->rawBytes;
+        for (uint32_t i = 0; i < 8 && i < snapshot->frames && (i + 1) * sizeof(float) <= snapshot->rawByteCount; i++) {
+            uint32_t bits;
+            memcpy(&bits, &floatCheck[i], sizeof(bits));
+            NSLog(@"[AudioHookBridge]    [%u] = %.10f (hex: 0x%08X)", i, floatCheck[i], bits);
+        }
+
+        if (snapshot->avgAbs < 0.0001f) {
+            NSLog(@"[AudioHookBridge] ⚠️ WARNING: Data appears to be SILENCE (avgAbs < 0.0001)");
+            NSLog(@"[AudioHookBridge] ════════════════════════════════════════════════════════════");
+            NSLog(@"[AudioHookBridge] 🛑 DIAGNOSIS: SDK's AudioUnit render buffer is EMPTY!");
+            NSLog(@"[AudioHookBridge]    The SDK failed with error -50 when configuring its AudioUnit.");
+            NSLog(@"[AudioHookBridge]    Because of this failure, the SDK never connects its audio");
+            NSLog(@"[AudioHookBridge]    decoder output to this render buffer.");
+            NSLog(@"[AudioHookBridge]    We are capturing from the WRONG place in the audio pipeline.");
+            NSLog(@"[AudioHookBridge]    The decoded audio exists somewhere BEFORE this render callback.");
+            NSLog(@"[AudioHookBridge] ════════════════════════════════════════════════════════════");
+        } else {
+            NSLog(@"[AudioHookBridge] ✅ Data contains real audio (avgAbs = %.6f)", snapshot->avgAbs);
         }
     }
 
     // Limited logging
-    static int logCount = 0;
-    if (logCount < 20) {
-        logCount++;
-        NSLog(@"[AudioHookBridge] 🎤 Captured %u frames → %u Int16 mono samples (callback: %@)",
-              frameCount, outputSampleCount, bridge.captureCallback ? @"SET" : @"NULL");
-    } else if (logCount == 20) {
-        logCount++;
+    uint64_t calls = __atomic_load_n(&g_renderNotifyCalls, __ATOMIC_RELAXED);
+    if (calls == 0) return;
+    if (g_renderStatusLogs < 20) {
+        g_renderStatusLogs++;
+        uint32_t missing = __atomic_load_n(&g_renderCallbackMissing, __ATOMIC_RELAXED);
+        NSLog(@"[AudioHookBridge] 🎤 Render notify: %llu callbacks, %llu Int16 mono samples captured (callback: %@)",
+              calls, bridge.capturedFrameCount, bridge.captureCallback ? @"SET" : @"NULL");
+        if (missing > 0) {
+            NSLog(@"[AudioHookBridge] ⚠️ captureCallback is NULL or no samples - %u buffers not forwarded!", missing);
+        }
+    } else if (g_renderStatusLogs == 20) {
+        g_renderStatusLogs++;
         NSLog(@"[AudioHookBridge] 🔇 Silencing further capture logs...");
     }
-
-    return noErr;
 }
 
 #pragma mark - AudioHookBridge Implementation
@@ -402,8 +867,6 @@ static OSStatus RenderNotifyCallback(
     BOOL _renderNotifyInstalled;
 }
 
-@synthesize capturedFrameCount = _capturedFrameCount;
-
 #pragma mark - Singleton
 
 + (AudioHookBridge *)shared {
@@ -420,8 +883,10 @@ static OSStatus RenderNotifyCallback(
     if (self) {
         _isHooked = NO;
         _interceptedUnit = NULL;
-        _capturedFrameCount = 0;
         _renderNotifyInstalled = NO;
+        _lazyDecodeEnabled = YES;
+        _voiceFramePollIntervalMs = 10;
+        reset_stream_format();
         NSLog(@"[AudioHookBridge] Initialized");
     }
     return self;
@@ -437,6 +902,17 @@ static OSStatus RenderNotifyCallback(
     return _interceptedUnit;
 }
 
+- (void)setVoiceFramePollIntervalMs:(uint32_t)intervalMs {
+    _voiceFramePollIntervalMs = MAX(intervalMs, 1u);
+    if (voiceFrameTimer != NULL) {
+        dispatch_source_set_timer(voiceFrameTimer,
+                                  dispatch_time(DISPATCH_TIME_NOW, 0),
+                                  _voiceFramePollIntervalMs * NSEC_PER_MSEC,
+                                  1 * NSEC_PER_MSEC);
+        NSLog(@"[AudioHookBridge] Voice frame poll interval: %ums", _voiceFramePollIntervalMs);
+    }
+}
+
 #pragma mark - Discovery
 
 - (NSArray<NSString *> *)discoverSDKClasses {
@@ -764,7 +1240,8 @@ static void swizzled_startVoice(id self, SEL _cmd) {
 
     if (status == noErr) {
         _renderNotifyInstalled = YES;
-        _capturedFrameCount = 0;
+        __atomic_store_n(&g_capturedSamples, 0, __ATOMIC_RELAXED);
+        [self startRenderDiagnostics];
         NSLog(@"[AudioHookBridge] ✅ Render notify installed on unit %p", unit);
         return YES;
     } else {
@@ -784,13 +1261,46 @@ static void swizzled_startVoice(id self, SEL _cmd) {
         (__bridge void *)self
     );
 
+    if (g_renderDiagnosticsTimer != NULL) {
+        dispatch_source_cancel(g_renderDiagnosticsTimer);
+        g_renderDiagnosticsTimer = NULL;
+    }
+    log_render_notify_diagnostics(self);
+
     NSLog(@"[AudioHookBridge] ✅ Render notify removed");
-    NSLog(@"[AudioHookBridge] Total captured: %llu frames", _capturedFrameCount);
+    NSLog(@"[AudioHookBridge] Total captured: %llu frames", self.capturedFrameCount);
 
     _renderNotifyInstalled = NO;
+    os_unfair_lock_lock(&g_observerLock);
+    NSArray *retired = [g_retiredCaptureCallbacks copy];
+    [g_retiredCaptureCallbacks removeAllObjects];
+    os_unfair_lock_unlock(&g_observerLock);
+    retired = nil;  // Released outside the lock
     _interceptedUnit = NULL;
 }
 
+/// Log the render notify's recorded diagnostics from the main queue twice a second
+- (void)startRenderDiagnostics {
+    g_renderSnapshotsLogged = 0;
+    g_renderStatusLogs = 0;
+    __atomic_store_n(&g_renderNotifyCalls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_renderCallbackMissing, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_renderSnapshotCount, 0, __ATOMIC_RELEASE);
+
+    if (g_renderDiagnosticsTimer != NULL) return;
+    g_renderDiagnosticsTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(g_renderDiagnosticsTimer,
+                              dispatch_time(DISPATCH_TIME_NOW, 500 * NSEC_PER_MSEC),
+                              500 * NSEC_PER_MSEC,  // 500ms interval
+                              50 * NSEC_PER_MSEC);  // 50ms leeway
+    __weak AudioHookBridge *weakSelf = self;
+    dispatch_source_set_event_handler(g_renderDiagnosticsTimer, ^{
+        AudioHookBridge *bridge = weakSelf;
+        if (bridge) log_render_notify_diagnostics(bridge);
+    });
+    dispatch_resume(g_renderDiagnosticsTimer);
+}
+
 #pragma mark - Testing
 
 - (BOOL)runSelfTest {
@@ -849,12 +1359,38 @@ static void swizzled_startVoice(id self, SEL _cmd) {
         _isHooked ? @"YES" : @"NO",
         _renderNotifyInstalled ? @"YES" : @"NO",
         _interceptedUnit,
-        _capturedFrameCount
+        self.capturedFrameCount
     ];
 }
 
+- (uint64_t)capturedFrameCount {
+    return __atomic_load_n(&g_capturedSamples, __ATOMIC_RELAXED);
+}
+
 - (void)incrementCapturedFrameCount:(uint32_t)count {
-    _capturedFrameCount += count;
+    __atomic_fetch_add(&g_capturedSamples, count, __ATOMIC_RELAXED);
+}
+
+#pragma mark - Warm-up
+
+- (void)preallocateDecodeBuffers:(size_t)maxSamples {
+    // On the capture queue: the timer may already be decoding into them
+    sync_on_capture_queue(^{
+        reserve_decode_buffer(maxSamples);
+
+        // ADPCM frames transcode to as many A-law bytes as they have samples
+        reserve_adpcm_buffer(maxSamples);
+    });
+
+    // conversionBuffer is static (kMaxConversionFrames) - nothing to do
+
+    NSLog(@"[AudioHookBridge] 🔥 Preallocated decode buffers (%zu samples)", maxSamples);
+}
+
+- (void)resolveSDKSymbols {
+    [self resolvePcmp2Symbols];
+    [self resolveCgiSymbols];
+    [self resolveCSessionSymbols];
 }
 
 #pragma mark - Voice Frame Direct Capture (G.711a Bypass)
@@ -890,13 +1426,12 @@ static void swizzled_startVoice(id self, SEL _cmd) {
 
     // Create a high-frequency timer to poll for voice frames
     // Audio at 16kHz with 480 sample frames = ~33ms per frame
-    // Poll at 10ms to catch every frame
-    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0);
-    voiceFrameTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+    // Poll at 10ms (voiceFramePollIntervalMs) to catch every frame
+    voiceFrameTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, capture_queue());
 
     dispatch_source_set_timer(voiceFrameTimer,
                               dispatch_time(DISPATCH_TIME_NOW, 0),
-                              10 * NSEC_PER_MSEC,  // 10ms interval
+                              _voiceFramePollIntervalMs * NSEC_PER_MSEC,
                               1 * NSEC_PER_MSEC);  // 1ms leeway
 
     __weak AudioHookBridge *weakSelf = self;
@@ -906,7 +1441,7 @@ static void swizzled_startVoice(id self, SEL _cmd) {
     });
 
     dispatch_resume(voiceFrameTimer);
-    NSLog(@"[AudioHookBridge] ✅ Voice frame polling started (10ms interval)");
+    NSLog(@"[AudioHookBridge] ✅ Voice frame polling started (%ums interval)", _voiceFramePollIntervalMs);
 }
 
 /// Poll voice_frame AND upstream buffers for audio data
@@ -935,7 +1470,7 @@ static void swizzled_startVoice(id self, SEL _cmd) {
     }
 
     // Check if we have new data
-    if (frame->head.frameno == lastProcessedFrameNo) {
+    if (frame->head.frameno == last_processed_frame_no()) {
         return;  // Same frame, skip
     }
 
@@ -972,23 +1507,22 @@ static void swizzled_startVoice(id self, SEL _cmd) {
         }
     }
 
-    lastProcessedFrameNo = frameNo;
-
-    // Decode G.711a to PCM
+    // ADPCM frames become A-law first, so every later stage sees one format
+    const uint8_t *alaw = (const uint8_t *)rawData;
     size_t sampleCount = dataSize;  // G.711: 1 byte = 1 sample
-
-    // Ensure decode buffer is large enough
-    if (g711DecodeBuffer == NULL || g711DecodeBufferSize < sampleCount) {
-        if (g711DecodeBuffer) free(g711DecodeBuffer);
-        g711DecodeBufferSize = sampleCount * 2;  // Extra room
-        g711DecodeBuffer = (int16_t *)malloc(g711DecodeBufferSize * sizeof(int16_t));
+    if (classify_frame(dataSize) == AudioFrameCodecImaAdpcm) {
+        ima_adpcm_state state = { frame->head.sample, (uint8_t)(frame->head.index < 0 ? 0 : frame->head.index) };
+        alaw = transcode_adpcm_frame(alaw, dataSize, state);
+        sampleCount = dataSize * 2;
+        if (alaw == NULL) return;
     }
 
-    // Decode!
-    decode_alaw((const uint8_t *)rawData, g711DecodeBuffer, sampleCount);
+    // Decode G.711a to PCM (skipped while nothing consumes it)
+    BOOL decoded = [self processAlawFrame:alaw length:sampleCount
+                                  frameNo:frameNo timestamp:frame->head.timestamp];
 
     // Log decoded sample values for first few frames
-    if (frameLogCount <= 10) {
+    if (decoded && frameLogCount <= 10) {
         float minVal = g711DecodeBuffer[0], maxVal = g711DecodeBuffer[0], sumAbs = 0;
         for (size_t i = 0; i < sampleCount && i < 480; i++) {
             float val = g711DecodeBuffer[i];
@@ -1005,11 +1539,76 @@ static void swizzled_startVoice(id self, SEL _cmd) {
             NSLog(@"[AudioHookBridge] ⚠️ Decoded values are low - might be silence or wrong format");
         }
     }
+}
+
+/// Common path for SDK and injected frames: observers, archive, flight recorder, activity,
+/// then decode + forward unless lazy decode applies. Each step's thread CPU
+/// time is charged to the SDK session (g_cpuMeter).
+/// @return YES if the frame was decoded into g711DecodeBuffer
+- (BOOL)processAlawFrame:(const uint8_t *)alaw length:(size_t)length frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs {
+    session_slot slot = sdk_session();
+    uint64_t lap = session_cpu_thread_ns();
+    pipeline_trace_instant(PIPELINE_TRACE_FRAME_ARRIVAL, slot, frameNo);
+
+    notify_raw_frame(alaw, length, frameNo, timestampMs);
+    notify_frame_buffer(alaw, length, frameNo, timestampMs);
+    lap = session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_PUBLISH, lap);
+
+    // Before archiving, so the frame that settles the format is archived at its rate
+    if (detect_stream_format(length, frameNo, timestampMs)) {
+        [self announceStreamFormat];
+    }
+    archive_frame(alaw, length, frameNo, timestampMs);
+    flight_recorder_record_frame(__atomic_load_n(&g_flightRecorder, __ATOMIC_ACQUIRE), alaw, (uint32_t)length,
+                                 frameNo, timestampMs);
+
+    // Evaluated per frame, so an attaching consumer gets the very next frame
+    BOOL decode = self.needsDecodedAudio;
+    track_frame_activity(alaw, length, frameNo, timestampMs, !decode);
+    lap = session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_RECEIVE, lap);
+    if (!decode) {
+        // Keep the gain envelope current for when decoding resumes
+        apply_auto_gain(NULL, length);
+        session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_PROCESS, lap);
+        return NO;
+    }
+
+    uint64_t decodeStart = pipeline_trace_begin();
+    if (![self decodeAlawFrame:alaw length:length]) return NO;
+    pipeline_trace_span(PIPELINE_TRACE_DECODE, decodeStart, slot, (int64_t)length);
+    lap = session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_DECODE, lap);
+    apply_filters(g711DecodeBuffer, length);
+    apply_auto_gain(g711DecodeBuffer, length);
+    lap = session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_PROCESS, lap);
+    [self forwardDecodedSamples:length frameNo:frameNo timestamp:timestampMs];
+    session_cpu_lap(g_cpuMeter, slot, SESSION_CPU_DELIVER, lap);
+    return YES;
+}
+
+/// Decode one G.711a frame into g711DecodeBuffer (grows the buffer if needed)
+/// @return NO if the buffer could not grow
+- (BOOL)decodeAlawFrame:(const uint8_t *)alaw length:(size_t)sampleCount {
+    // Ensure decode buffer is large enough
+    if (g711DecodeBuffer == NULL || g711DecodeBufferSize < sampleCount) {
+        reserve_decode_buffer(sampleCount * 2);  // Extra room
+        if (g711DecodeBuffer == NULL || g711DecodeBufferSize < sampleCount) return NO;
+    }
 
-    // Send to capture callback
-    if (self.captureCallback) {
-        self.captureCallback(g711DecodeBuffer, (uint32_t)sampleCount);
-        _capturedFrameCount += sampleCount;
+    // Decode!
+    decode_alaw(alaw, g711DecodeBuffer, sampleCount);
+    return YES;
+}
+
+/// Hand the decoded contents of g711DecodeBuffer to the decoded frame
+/// observers and the capture callback
+- (void)forwardDecodedSamples:(size_t)sampleCount frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs {
+    notify_decoded_frame(g711DecodeBuffer, sampleCount, frameNo, timestampMs);
+
+    // Loaded once: the main thread may clear it while this frame is delivered
+    AudioCaptureBlock callback = capture_callback();
+    if (callback && !self.captureCallbackIdle) {
+        callback(g711DecodeBuffer, (uint32_t)sampleCount);
+        __atomic_fetch_add(&g_capturedSamples, sampleCount, __ATOMIC_RELAXED);
 
         static int callbackLogCount = 0;
         if (callbackLogCount < 5) {
@@ -1019,6 +1618,66 @@ static void swizzled_startVoice(id self, SEL _cmd) {
     }
 }
 
+- (void)injectAlawFrame:(const uint8_t *)data length:(size_t)length frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs {
+    if (data == NULL || length == 0) return;
+
+    // The decode buffers, session table and filter/AGC state are capture
+    // queue only; `data` stays valid because the caller waits
+    sync_on_capture_queue(^{
+        [self processAlawFrame:data length:length frameNo:frameNo timestamp:timestampMs];
+    });
+}
+
+- (void)injectAdpcmFrame:(const uint8_t *)data length:(size_t)length state:(ima_adpcm_state)state
+                 frameNo:(uint32_t)frameNo timestamp:(uint32_t)timestampMs {
+    if (data == NULL || length == 0) return;
+
+    // g_adpcmAlawBuffer is capture queue only, like the decode buffers
+    sync_on_capture_queue(^{
+        const uint8_t *alaw = transcode_adpcm_frame(data, length, state);
+        if (alaw == NULL) return;
+        [self processAlawFrame:alaw length:length * 2 frameNo:frameNo timestamp:timestampMs];
+    });
+}
+
+#pragma mark - Frame Codec
+
+- (AudioFrameCodec)frameCodec {
+    return (AudioFrameCodec)(__atomic_load_n(&g_currentFrameCodec, __ATOMIC_ACQUIRE) >> 32);
+}
+
+- (BOOL)expectFrameCodec:(AudioFrameCodec)codec frameSamples:(uint32_t)frameSamples {
+    uint32_t bytes = codec == AudioFrameCodecImaAdpcm ? frameSamples / 2 : frameSamples;
+    uint64_t next = pack_frame_codec(codec, bytes);
+    uint64_t current = __atomic_load_n(&g_currentFrameCodec, __ATOMIC_ACQUIRE);
+
+    if ((uint32_t)current == bytes) {
+        __atomic_store_n(&g_expectedFrameCodec, 0, __ATOMIC_RELEASE);
+        if (current == next) return YES;  // Nothing changes
+
+        // Another codec at the same payload size (ADPCM at 2N ms is G.711a
+        // at N ms): no frame could prove the switch, so keep decoding as now
+        NSLog(@"[AudioHookBridge] ⚠️ %@ frames of %u bytes look like the current ones; not switching",
+              codec == AudioFrameCodecImaAdpcm ? @"IMA ADPCM" : @"G.711a", bytes);
+        return NO;
+    }
+
+    __atomic_store_n(&g_expectedFrameCodec, next, __ATOMIC_RELEASE);
+    NSLog(@"[AudioHookBridge] 🎚️ Expecting %@ frames of %u bytes",
+          codec == AudioFrameCodecImaAdpcm ? @"IMA ADPCM" : @"G.711a", bytes);
+    return YES;
+}
+
+- (void)cancelFrameCodecExpectation:(AudioFrameCodec)codec frameSamples:(uint32_t)frameSamples {
+    uint32_t bytes = codec == AudioFrameCodecImaAdpcm ? frameSamples / 2 : frameSamples;
+    uint64_t expected = pack_frame_codec(codec, bytes);
+    if (__atomic_compare_exchange_n(&g_expectedFrameCodec, &expected, 0, false,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        NSLog(@"[AudioHookBridge] 🎚️ No longer expecting %@ frames of %u bytes",
+              codec == AudioFrameCodecImaAdpcm ? @"IMA ADPCM" : @"G.711a", bytes);
+    }
+}
+
 /// Check upstream buffers for audio data
 /// These buffers exist BEFORE voice_frame in the pipeline and might have data
 /// even when voice_frame is empty (if startVoice() failed)
@@ -1175,60 +1834,257 @@ static void swizzled_startVoice(id self, SEL _cmd) {
         NSLog(@"[AudioHookBridge] ✅ Voice frame capture stopped");
     }
 
-    if (g711DecodeBuffer) {
+    // After any poll already running on the capture queue has finished
+    dispatch_async(capture_queue(), ^{
         free(g711DecodeBuffer);
         g711DecodeBuffer = NULL;
         g711DecodeBufferSize = 0;
+    });
+
+    if (sdk_session() != SESSION_SLOT_NONE) {
+        session_table_set_last_frame_no(g_sessions, g_sdkSession, 0);
     }
+    reset_stream_format();
+}
+
+#pragma mark - Lazy Decode
 
-    lastProcessedFrameNo = 0;
+- (BOOL)needsDecodedAudio {
+    return !self.lazyDecodeEnabled
+        || (capture_callback() != nil && !self.captureCallbackIdle)
+        || observer_list_count(&g_decodedFrameObservers) > 0;
 }
 
-#pragma mark - pcmp2 API (Story 10.1)
+- (AudioCaptureBlock)captureCallback {
+    return capture_callback();
+}
 
-/// Resolve pcmp2_* symbols from the SDK using dlsym
-- (BOOL)resolvePcmp2Symbols {
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
-    NSLog(@"[AudioHookBridge] 🔍 Story 10.1: Resolving pcmp2 Symbols");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+- (void)setCaptureCallback:(AudioCaptureBlock)captureCallback {
+    AudioCaptureBlock callback = [captureCallback copy];
+    os_unfair_lock_lock(&g_observerLock);
+    AudioCaptureBlock previous = g_captureCallback;
+    g_captureCallback = callback;
+    __atomic_store_n(&g_renderCaptureCallback, (__bridge void *)callback, __ATOMIC_RELEASE);
+    if (previous != nil && _renderNotifyInstalled) {
+        if (g_retiredCaptureCallbacks == nil) {
+            g_retiredCaptureCallbacks = [NSMutableArray array];
+        }
+        [g_retiredCaptureCallbacks addObject:previous];
+    }
+    os_unfair_lock_unlock(&g_observerLock);
+    previous = nil;  // Otherwise released here, outside the lock
+}
+
+- (BOOL)captureCallbackIdle {
+    return __atomic_load_n(&g_captureCallbackIdle, __ATOMIC_ACQUIRE);
+}
+
+- (void)setCaptureCallbackIdle:(BOOL)idle {
+    __atomic_store_n(&g_captureCallbackIdle, idle, __ATOMIC_RELEASE);
+}
+
+- (AudioFrameActivity)frameActivity {
+    AudioFrameActivity activity = {0};
+    session_slot slot = sdk_session();
+    if (slot == SESSION_SLOT_NONE) return activity;
+
+    const session_hot_columns *columns = session_table_columns(g_sessions);
+    activity.frames = __atomic_load_n(&columns->frames[slot], __ATOMIC_RELAXED);
+    activity.lostFrames = __atomic_load_n(&columns->lost_frames[slot], __ATOMIC_RELAXED);
+    activity.decodeSkipped = __atomic_load_n(&columns->decode_skipped[slot], __ATOMIC_RELAXED);
+    activity.lastFrameNo = __atomic_load_n(&columns->last_frame_no[slot], __ATOMIC_RELAXED);
+    activity.lastTimestampMs = __atomic_load_n(&columns->last_timestamp_ms[slot], __ATOMIC_RELAXED);
+    activity.lastArrivalMs = __atomic_load_n(&columns->last_arrival_ms[slot], __ATOMIC_RELAXED);
+    activity.jitterMs = __atomic_load_n(&columns->jitter_q4[slot], __ATOMIC_RELAXED) / 16.0;
+    activity.levelDbfs = session_level_to_dbfs(__atomic_load_n(&columns->level_cb[slot], __ATOMIC_RELAXED));
+    activity.peakDbfs = session_level_to_dbfs(__atomic_load_n(&columns->peak_cb[slot], __ATOMIC_RELAXED));
+    return activity;
+}
+
+#pragma mark - CPU Accounting
+
+- (session_cpu_meter *)cpuMeter {
+    sdk_session();  // Creates the meter along with the session
+    return g_cpuMeter;
+}
+
+- (uint32_t)sdkSessionSlot {
+    return sdk_session();
+}
+
+#pragma mark - Automatic Gain
+
+- (auto_gain_bank *)autoGain {
+    sdk_session();  // Creates the bank along with the session
+    return g_autoGain;
+}
+
+#pragma mark - Filters
+
+- (filter_bank *)filterBank {
+    sdk_session();  // Creates the bank along with the session
+    return g_filterBank;
+}
+
+#pragma mark - Flight Recorder
+
+- (flight_recorder *)flightRecorder {
+    return __atomic_load_n(&g_flightRecorder, __ATOMIC_ACQUIRE);
+}
 
-    // Use RTLD_DEFAULT to search all loaded libraries
-    g_pcmp2_init = (pcmp2_init_fn)dlsym(RTLD_DEFAULT, "pcmp2_init");
-    g_pcmp2_finalize = (pcmp2_finalize_fn)dlsym(RTLD_DEFAULT, "pcmp2_finalize");
-    g_pcmp2_setListener = (pcmp2_setListener_fn)dlsym(RTLD_DEFAULT, "pcmp2_setListener");
-    g_pcmp2_setAudioPlayer = (pcmp2_setAudioPlayer_fn)dlsym(RTLD_DEFAULT, "pcmp2_setAudioPlayer");
-    g_pcmp2_start = (pcmp2_start_fn)dlsym(RTLD_DEFAULT, "pcmp2_start");
-    g_pcmp2_stop = (pcmp2_stop_fn)dlsym(RTLD_DEFAULT, "pcmp2_stop");
+- (void)setFlightRecorder:(flight_recorder *)flightRecorder {
+    __atomic_store_n(&g_flightRecorder, flightRecorder, __ATOMIC_RELEASE);
+}
 
-    NSLog(@"[PCMP2] pcmp2_init:          %p %s", g_pcmp2_init, g_pcmp2_init ? "✅" : "❌");
-    NSLog(@"[PCMP2] pcmp2_finalize:      %p %s", g_pcmp2_finalize, g_pcmp2_finalize ? "✅" : "❌");
-    NSLog(@"[PCMP2] pcmp2_setListener:   %p %s", g_pcmp2_setListener, g_pcmp2_setListener ? "✅" : "❌");
-    NSLog(@"[PCMP2] pcmp2_setAudioPlayer:%p %s", g_pcmp2_setAudioPlayer, g_pcmp2_setAudioPlayer ? "✅" : "❌");
-    NSLog(@"[PCMP2] pcmp2_start:         %p %s", g_pcmp2_start, g_pcmp2_start ? "✅" : "❌");
-    NSLog(@"[PCMP2] pcmp2_stop:          %p %s", g_pcmp2_stop, g_pcmp2_stop ? "✅" : "❌");
+#pragma mark - Stream Format
 
-    // Also try some alternative symbol names
-    if (!g_pcmp2_init) {
-        NSLog(@"[PCMP2] Trying alternative symbol names...");
+- (DetectedStreamFormat)streamFormat {
+    return published_stream_format();
+}
 
-        void *alt1 = dlsym(RTLD_DEFAULT, "_pcmp2_init");
-        void *alt2 = dlsym(RTLD_DEFAULT, "Pcmp2_init");
-        void *alt3 = dlsym(RTLD_DEFAULT, "pcmp_init");
-        void *alt4 = dlsym(RTLD_DEFAULT, "pcm_player_init");
+/// Log the detected format and hand it to streamFormatCallback (main queue)
+- (void)announceStreamFormat {
+    DetectedStreamFormat format = published_stream_format();
+    static const char *sources[] = { "undecided", "timestamps", "arrival cadence", "fallback" };
+    NSLog(@"[AudioHookBridge] 🎚️ Stream format: %u Hz, %u samples/frame (%u ms) from %s",
+          format.sampleRate, format.frameSamples, format.frameMs, sources[g_streamFormat.source]);
+
+    DetectedStreamFormatBlock callback = self.streamFormatCallback;
+    if (callback == nil) return;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        callback(format);
+    });
+}
+
+#pragma mark - Frame Observers
+
+- (NSUInteger)addRawFrameObserver:(AudioRawFrameBlock)observer {
+    return observer_list_add(&g_rawFrameObservers, observer);
+}
+
+- (void)removeRawFrameObserver:(NSUInteger)token {
+    observer_list_remove(&g_rawFrameObservers, token);
+}
+
+- (NSUInteger)addDecodedFrameObserver:(AudioDecodedFrameBlock)observer {
+    return observer_list_add(&g_decodedFrameObservers, observer);
+}
+
+- (void)removeDecodedFrameObserver:(NSUInteger)token {
+    observer_list_remove(&g_decodedFrameObservers, token);
+}
 
-        NSLog(@"[PCMP2]   _pcmp2_init:       %p", alt1);
-        NSLog(@"[PCMP2]   Pcmp2_init:        %p", alt2);
-        NSLog(@"[PCMP2]   pcmp_init:         %p", alt3);
-        NSLog(@"[PCMP2]   pcm_player_init:   %p", alt4);
+- (NSUInteger)addFrameBufferObserver:(AudioFrameBufferBlock)observer {
+    shared_frame_pool();
+    return observer_list_add(&g_frameBufferObservers, observer);
+}
+
+- (void)removeFrameBufferObserver:(NSUInteger)token {
+    observer_list_remove(&g_frameBufferObservers, token);
+}
+
+- (frame_pool_stats)framePoolStats {
+    frame_pool_stats stats = {0};
+    if (g_framePool != NULL) {
+        frame_pool_get_stats(g_framePool, &stats);
     }
+    return stats;
+}
 
-    BOOL success = (g_pcmp2_init != NULL && g_pcmp2_setListener != NULL);
+#pragma mark - Capture Archive
 
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
-    NSLog(@"[PCMP2] Resolution result: %s", success ? "SUCCESS ✅" : "FAILED ❌");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+- (BOOL)isArchiving {
+    return g_archiving;
+}
+
+- (BOOL)startArchivingToDirectory:(NSString *)directory segmentDuration:(NSTimeInterval)segmentDuration {
+    NSError *error = nil;
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:directory
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:&error]) {
+        NSLog(@"[AudioHookBridge] ❌ Cannot create archive directory: %@", error);
+        return NO;
+    }
 
-    return success;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        g_archiveQueue = dispatch_queue_create("com.veepatest.capture-archive", DISPATCH_QUEUE_SERIAL);
+    });
+
+    dispatch_sync(g_archiveQueue, ^{
+        archive_close_segment();
+        g_archiveDirectory = [directory copy];
+        g_archiveSegmentDuration = segmentDuration > 0 ? segmentDuration : 600;
+        g_archiving = YES;
+    });
+
+    NSLog(@"[AudioHookBridge] 💾 Archiving G.711a frames to %@ (%.0fs segments)", directory, g_archiveSegmentDuration);
+    return YES;
+}
+
+- (void)stopArchiving {
+    if (g_archiveQueue == NULL) return;
+
+    g_archiving = NO;
+    dispatch_sync(g_archiveQueue, ^{
+        archive_close_segment();
+    });
+    NSLog(@"[AudioHookBridge] 💾 Archiving stopped");
+}
+
+#pragma mark - pcmp2 API (Story 10.1)
+
+/// Resolve pcmp2_* symbols from the SDK using dlsym
+- (BOOL)resolvePcmp2Symbols {
+    // Once per process: the function pointers are then only read, from any
+    // thread (dispatch_once orders the writes before every later call)
+    static dispatch_once_t once;
+    static BOOL resolved = NO;
+    dispatch_once(&once, ^{
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        NSLog(@"[AudioHookBridge] 🔍 Story 10.1: Resolving pcmp2 Symbols");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+
+        // Use RTLD_DEFAULT to search all loaded libraries
+        g_pcmp2_init = (pcmp2_init_fn)dlsym(RTLD_DEFAULT, "pcmp2_init");
+        g_pcmp2_finalize = (pcmp2_finalize_fn)dlsym(RTLD_DEFAULT, "pcmp2_finalize");
+        g_pcmp2_setListener = (pcmp2_setListener_fn)dlsym(RTLD_DEFAULT, "pcmp2_setListener");
+        g_pcmp2_setAudioPlayer = (pcmp2_setAudioPlayer_fn)dlsym(RTLD_DEFAULT, "pcmp2_setAudioPlayer");
+        g_pcmp2_start = (pcmp2_start_fn)dlsym(RTLD_DEFAULT, "pcmp2_start");
+        g_pcmp2_stop = (pcmp2_stop_fn)dlsym(RTLD_DEFAULT, "pcmp2_stop");
+
+        NSLog(@"[PCMP2] pcmp2_init:          %p %s", g_pcmp2_init, g_pcmp2_init ? "✅" : "❌");
+        NSLog(@"[PCMP2] pcmp2_finalize:      %p %s", g_pcmp2_finalize, g_pcmp2_finalize ? "✅" : "❌");
+        NSLog(@"[PCMP2] pcmp2_setListener:   %p %s", g_pcmp2_setListener, g_pcmp2_setListener ? "✅" : "❌");
+        NSLog(@"[PCMP2] pcmp2_setAudioPlayer:%p %s", g_pcmp2_setAudioPlayer, g_pcmp2_setAudioPlayer ? "✅" : "❌");
+        NSLog(@"[PCMP2] pcmp2_start:         %p %s", g_pcmp2_start, g_pcmp2_start ? "✅" : "❌");
+        NSLog(@"[PCMP2] pcmp2_stop:          %p %s", g_pcmp2_stop, g_pcmp2_stop ? "✅" : "❌");
+
+        // Also try some alternative symbol names
+        if (!g_pcmp2_init) {
+            NSLog(@"[PCMP2] Trying alternative symbol names...");
+
+            void *alt1 = dlsym(RTLD_DEFAULT, "_pcmp2_init");
+            void *alt2 = dlsym(RTLD_DEFAULT, "Pcmp2_init");
+            void *alt3 = dlsym(RTLD_DEFAULT, "pcmp_init");
+            void *alt4 = dlsym(RTLD_DEFAULT, "pcm_player_init");
+
+            NSLog(@"[PCMP2]   _pcmp2_init:       %p", alt1);
+            NSLog(@"[PCMP2]   Pcmp2_init:        %p", alt2);
+            NSLog(@"[PCMP2]   pcmp_init:         %p", alt3);
+            NSLog(@"[PCMP2]   pcm_player_init:   %p", alt4);
+        }
+
+        BOOL success = (g_pcmp2_init != NULL && g_pcmp2_setListener != NULL);
+
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        NSLog(@"[PCMP2] Resolution result: %s", success ? "SUCCESS ✅" : "FAILED ❌");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+
+        resolved = success;
+    });
+    return resolved;
 }
 
 /// Test the pcmp2 listener by initializing and registering a callback
@@ -1237,12 +2093,10 @@ static void swizzled_startVoice(id self, SEL _cmd) {
     NSLog(@"[AudioHookBridge] 🧪 Story 10.1: Testing pcmp2 Listener");
     NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
 
-    // First resolve symbols if not done
-    if (g_pcmp2_init == NULL) {
-        if (![self resolvePcmp2Symbols]) {
-            NSLog(@"[PCMP2] ❌ Cannot test - symbols not resolved");
-            return;
-        }
+    // Resolves on first use; later calls only read the pointers
+    if (![self resolvePcmp2Symbols]) {
+        NSLog(@"[PCMP2] ❌ Cannot test - symbols not resolved");
+        return;
     }
 
     // Try to initialize pcmp2
@@ -1392,25 +2246,30 @@ static void swizzled_startVoice(id self, SEL _cmd) {
 
 /// Resolve client_write_cgi symbol from SDK
 - (BOOL)resolveCgiSymbols {
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
-    NSLog(@"[AudioHookBridge] 🔍 Story 10.2: Resolving CGI Symbols");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+    static dispatch_once_t once;
+    static BOOL resolved = NO;
+    dispatch_once(&once, ^{
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        NSLog(@"[AudioHookBridge] 🔍 Story 10.2: Resolving CGI Symbols");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
 
-    g_client_write_cgi = (client_write_cgi_fn)dlsym(RTLD_DEFAULT, "client_write_cgi");
+        g_client_write_cgi = (client_write_cgi_fn)dlsym(RTLD_DEFAULT, "client_write_cgi");
 
-    NSLog(@"[CGI] client_write_cgi: %p %s", g_client_write_cgi, g_client_write_cgi ? "✅" : "❌");
+        NSLog(@"[CGI] client_write_cgi: %p %s", g_client_write_cgi, g_client_write_cgi ? "✅" : "❌");
 
-    if (!g_client_write_cgi) {
-        // Try with underscore prefix
-        g_client_write_cgi = (client_write_cgi_fn)dlsym(RTLD_DEFAULT, "_client_write_cgi");
-        NSLog(@"[CGI] _client_write_cgi: %p %s", g_client_write_cgi, g_client_write_cgi ? "✅" : "❌");
-    }
+        if (!g_client_write_cgi) {
+            // Try with underscore prefix
+            g_client_write_cgi = (client_write_cgi_fn)dlsym(RTLD_DEFAULT, "_client_write_cgi");
+            NSLog(@"[CGI] _client_write_cgi: %p %s", g_client_write_cgi, g_client_write_cgi ? "✅" : "❌");
+        }
 
-    BOOL success = (g_client_write_cgi != NULL);
-    NSLog(@"[CGI] Resolution result: %s", success ? "SUCCESS ✅" : "FAILED ❌");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        BOOL success = (g_client_write_cgi != NULL);
+        NSLog(@"[CGI] Resolution result: %s", success ? "SUCCESS ✅" : "FAILED ❌");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
 
-    return success;
+        resolved = success;
+    });
+    return resolved;
 }
 
 /// Send a CGI command to the camera
@@ -1422,11 +2281,9 @@ static void swizzled_startVoice(id self, SEL _cmd) {
     NSLog(@"[CGI] Sending: %@", cgiCommand);
     NSLog(@"[CGI] Client: %p", clientPtr);
 
-    if (!g_client_write_cgi) {
-        if (![self resolveCgiSymbols]) {
-            NSLog(@"[CGI] ❌ client_write_cgi not resolved");
-            return -1;
-        }
+    if (![self resolveCgiSymbols]) {
+        NSLog(@"[CGI] ❌ client_write_cgi not resolved");
+        return -1;
     }
 
     if (!clientPtr) {
@@ -1654,41 +2511,46 @@ static size_t g_allocatedVoiceBufferSize = 0;
 
 /// Resolve CSession symbols for direct P2P channel access
 - (BOOL)resolveCSessionSymbols {
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
-    NSLog(@"[AudioHookBridge] 🔍 Story 10.3: Resolving CSession Symbols");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
-
-    // Try to resolve CSession functions
-    g_CSession_ChannelBuffer_Get = (CSession_ChannelBuffer_Get_fn)dlsym(RTLD_DEFAULT, "CSession_ChannelBuffer_Get");
-    g_CSession_Data_Read = (CSession_Data_Read_fn)dlsym(RTLD_DEFAULT, "CSession_Data_Read");
-    g_CSession_SessionInfo_Get = (CSession_SessionInfo_Get_fn)dlsym(RTLD_DEFAULT, "CSession_SessionInfo_Get");
-
-    NSLog(@"[CSESSION] CSession_ChannelBuffer_Get: %p %s",
-          g_CSession_ChannelBuffer_Get, g_CSession_ChannelBuffer_Get ? "✅" : "❌");
-    NSLog(@"[CSESSION] CSession_Data_Read: %p %s",
-          g_CSession_Data_Read, g_CSession_Data_Read ? "✅" : "❌");
-    NSLog(@"[CSESSION] CSession_SessionInfo_Get: %p %s",
-          g_CSession_SessionInfo_Get, g_CSession_SessionInfo_Get ? "✅" : "❌");
+    static dispatch_once_t once;
+    static BOOL resolved = NO;
+    dispatch_once(&once, ^{
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        NSLog(@"[AudioHookBridge] 🔍 Story 10.3: Resolving CSession Symbols");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
 
-    // Also try with underscore prefix
-    if (!g_CSession_ChannelBuffer_Get) {
-        g_CSession_ChannelBuffer_Get = (CSession_ChannelBuffer_Get_fn)dlsym(RTLD_DEFAULT, "_CSession_ChannelBuffer_Get");
-        if (g_CSession_ChannelBuffer_Get) NSLog(@"[CSESSION] Found _CSession_ChannelBuffer_Get: %p ✅", g_CSession_ChannelBuffer_Get);
-    }
-    if (!g_CSession_Data_Read) {
-        g_CSession_Data_Read = (CSession_Data_Read_fn)dlsym(RTLD_DEFAULT, "_CSession_Data_Read");
-        if (g_CSession_Data_Read) NSLog(@"[CSESSION] Found _CSession_Data_Read: %p ✅", g_CSession_Data_Read);
-    }
-    if (!g_CSession_SessionInfo_Get) {
-        g_CSession_SessionInfo_Get = (CSession_SessionInfo_Get_fn)dlsym(RTLD_DEFAULT, "_CSession_SessionInfo_Get");
-        if (g_CSession_SessionInfo_Get) NSLog(@"[CSESSION] Found _CSession_SessionInfo_Get: %p ✅", g_CSession_SessionInfo_Get);
-    }
+        // Try to resolve CSession functions
+        g_CSession_ChannelBuffer_Get = (CSession_ChannelBuffer_Get_fn)dlsym(RTLD_DEFAULT, "CSession_ChannelBuffer_Get");
+        g_CSession_Data_Read = (CSession_Data_Read_fn)dlsym(RTLD_DEFAULT, "CSession_Data_Read");
+        g_CSession_SessionInfo_Get = (CSession_SessionInfo_Get_fn)dlsym(RTLD_DEFAULT, "CSession_SessionInfo_Get");
+
+        NSLog(@"[CSESSION] CSession_ChannelBuffer_Get: %p %s",
+              g_CSession_ChannelBuffer_Get, g_CSession_ChannelBuffer_Get ? "✅" : "❌");
+        NSLog(@"[CSESSION] CSession_Data_Read: %p %s",
+              g_CSession_Data_Read, g_CSession_Data_Read ? "✅" : "❌");
+        NSLog(@"[CSESSION] CSession_SessionInfo_Get: %p %s",
+              g_CSession_SessionInfo_Get, g_CSession_SessionInfo_Get ? "✅" : "❌");
+
+        // Also try with underscore prefix
+        if (!g_CSession_ChannelBuffer_Get) {
+            g_CSession_ChannelBuffer_Get = (CSession_ChannelBuffer_Get_fn)dlsym(RTLD_DEFAULT, "_CSession_ChannelBuffer_Get");
+            if (g_CSession_ChannelBuffer_Get) NSLog(@"[CSESSION] Found _CSession_ChannelBuffer_Get: %p ✅", g_CSession_ChannelBuffer_Get);
+        }
+        if (!g_CSession_Data_Read) {
+            g_CSession_Data_Read = (CSession_Data_Read_fn)dlsym(RTLD_DEFAULT, "_CSession_Data_Read");
+            if (g_CSession_Data_Read) NSLog(@"[CSESSION] Found _CSession_Data_Read: %p ✅", g_CSession_Data_Read);
+        }
+        if (!g_CSession_SessionInfo_Get) {
+            g_CSession_SessionInfo_Get = (CSession_SessionInfo_Get_fn)dlsym(RTLD_DEFAULT, "_CSession_SessionInfo_Get");
+            if (g_CSession_SessionInfo_Get) NSLog(@"[CSESSION] Found _CSession_SessionInfo_Get: %p ✅", g_CSession_SessionInfo_Get);
+        }
 
-    BOOL success = (g_CSession_ChannelBuffer_Get != NULL || g_CSession_Data_Read != NULL);
-    NSLog(@"[CSESSION] Resolution result: %s", success ? "SUCCESS ✅" : "PARTIAL/FAILED");
-    NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
+        BOOL success = (g_CSession_ChannelBuffer_Get != NULL || g_CSession_Data_Read != NULL);
+        NSLog(@"[CSESSION] Resolution result: %s", success ? "SUCCESS ✅" : "PARTIAL/FAILED");
+        NSLog(@"[AudioHookBridge] ═══════════════════════════════════════");
 
-    return success;
+        resolved = success;
+    });
+    return resolved;
 }
 
 /// Manually allocate the voice_out_buff buffer
@@ -1899,9 +2761,10 @@ static size_t g_allocatedVoiceBufferSize = 0;
                 NSLog(@"[P2P-AUDIO] ✅ REAL AUDIO DETECTED! Forwarding to callback...");
 
                 // Forward to Swift callback
-                if (self.captureCallback) {
-                    self.captureCallback(pcmBuffer, (uint32_t)sampleCount);
-                    _capturedFrameCount += sampleCount;
+                AudioCaptureBlock callback = capture_callback();
+                if (callback) {
+                    callback(pcmBuffer, (uint32_t)sampleCount);
+                    __atomic_fetch_add(&g_capturedSamples, sampleCount, __ATOMIC_RELAXED);
                 }
             }
 
@@ -3,20 +3,22 @@
 //  VeepaAudioTest
 //
 //  Created for AudioUnit Hook implementation
-//  Purpose: Thread-safe ring buffer for transferring audio samples
-//           from SDK render callback to our AVAudioEngine playback
+//  Purpose: Lock-free ring buffer for transferring audio samples
+//           from the capture thread to our AVAudioEngine playback
 //
 
 import Foundation
 
-/// Thread-safe circular buffer for Int16 audio samples
+/// Lock-free circular buffer for Int16 audio samples
 ///
 /// Used to transfer audio data between:
-/// - Producer: SDK's AudioUnit render callback (high-priority audio thread)
-/// - Consumer: Our AVAudioSourceNode render block (high-priority audio thread)
+/// - Producer: the capture thread pushing decoded frames (one thread)
+/// - Consumer: our AVAudioSourceNode render block (high-priority audio thread)
 ///
 /// Design considerations:
-/// - Lock-free would be ideal but NSLock is acceptable for audio at 16kHz
+/// - Single producer, single consumer: the indices are atomics (SampleRing.c),
+///   so neither side ever takes a lock or waits for the other
+/// - Levels and statistics are atomic snapshots, safe from any thread
 /// - Overflow: drops oldest samples (producer wins)
 /// - Underflow: returns silence (consumer gets zeros)
 ///
@@ -24,18 +26,20 @@ final class CircularAudioBuffer {
 
     // MARK: - Properties
 
-    private var buffer: [Int16]
-    private var readIndex: Int = 0
-    private var writeIndex: Int = 0
-    private var count: Int = 0
+    private let ring: OpaquePointer
     private let capacity: Int
-    private let lock = NSLock()
 
     /// Statistics for debugging
-    private(set) var totalSamplesWritten: UInt64 = 0
-    private(set) var totalSamplesRead: UInt64 = 0
-    private(set) var overflowCount: UInt64 = 0
-    private(set) var underflowCount: UInt64 = 0
+    var totalSamplesWritten: UInt64 { statistics.written }
+    var totalSamplesRead: UInt64 { statistics.read }
+    var overflowCount: UInt64 { statistics.overflowed }
+    var underflowCount: UInt64 { statistics.underflowed }
+
+    private var statistics: sample_ring_statistics {
+        var statistics = sample_ring_statistics()
+        sample_ring_get_statistics(ring, &statistics)
+        return statistics
+    }
 
     // MARK: - Initialization
 
@@ -43,45 +47,44 @@ final class CircularAudioBuffer {
     /// - Parameter capacity: Maximum number of Int16 samples to hold
     ///   Recommended: At least 1 second of audio (e.g., 16000 for 16kHz)
     init(capacity: Int) {
+        guard let ring = sample_ring_create(UInt32(capacity)) else {
+            fatalError("Cannot allocate a \(capacity)-sample audio ring")
+        }
+        self.ring = ring
         self.capacity = capacity
-        self.buffer = [Int16](repeating: 0, count: capacity)
+    }
+
+    deinit {
+        sample_ring_destroy(ring)
     }
 
     // MARK: - Public Interface
 
-    /// Number of samples currently available for reading
+    /// Number of samples currently available for reading (any thread)
     var availableSamples: Int {
-        lock.lock()
-        defer { lock.unlock() }
-        return count
+        sample_ring_available(ring)
     }
 
     /// Buffer fill level as percentage (0.0 to 1.0)
     var fillLevel: Float {
-        lock.lock()
-        defer { lock.unlock() }
-        return Float(count) / Float(capacity)
+        Float(availableSamples) / Float(capacity)
     }
 
     /// Check if buffer is empty
     var isEmpty: Bool {
-        lock.lock()
-        defer { lock.unlock() }
-        return count == 0
+        availableSamples == 0
     }
 
     /// Check if buffer is full
     var isFull: Bool {
-        lock.lock()
-        defer { lock.unlock() }
-        return count == capacity
+        availableSamples == capacity
     }
 
     // MARK: - Write (Producer)
 
     /// Write samples into the buffer
     ///
-    /// Called from SDK's AudioUnit render callback thread.
+    /// Called from the capture thread (the only producer).
     /// If buffer is full, oldest samples are overwritten (overflow).
     ///
     /// - Parameters:
@@ -90,24 +93,7 @@ final class CircularAudioBuffer {
     /// - Returns: Number of samples actually written (always equals count)
     @discardableResult
     func write(from samples: UnsafePointer<Int16>, count sampleCount: Int) -> Int {
-        lock.lock()
-        defer { lock.unlock() }
-
-        for i in 0..<sampleCount {
-            buffer[writeIndex] = samples[i]
-            writeIndex = (writeIndex + 1) % capacity
-
-            if count < capacity {
-                count += 1
-            } else {
-                // Overflow - advance read pointer (drop oldest)
-                readIndex = (readIndex + 1) % capacity
-                overflowCount += 1
-            }
-        }
-
-        totalSamplesWritten += UInt64(sampleCount)
-        return sampleCount
+        sample_ring_write(ring, samples, sampleCount)
     }
 
     /// Write samples from an array
@@ -142,38 +128,16 @@ final class CircularAudioBuffer {
 
     /// Read samples from the buffer
     ///
-    /// Called from our AVAudioSourceNode render block.
+    /// Called from our AVAudioSourceNode render block (the only consumer).
     /// If not enough samples available, remaining space is filled with silence (zeros).
+    /// Never waits: a read racing the producer's overflow just copies again.
     ///
     /// - Parameters:
     ///   - destination: Pointer to write samples to
     ///   - count: Number of samples requested
     /// - Returns: Number of actual samples read (rest is silence)
     func read(into destination: UnsafeMutablePointer<Int16>, count requestedCount: Int) -> Int {
-        lock.lock()
-        defer { lock.unlock() }
-
-        let samplesToRead = min(requestedCount, count)
-
-        // Read available samples
-        for i in 0..<samplesToRead {
-            destination[i] = buffer[readIndex]
-            readIndex = (readIndex + 1) % capacity
-        }
-
-        count -= samplesToRead
-        totalSamplesRead += UInt64(samplesToRead)
-
-        // Fill remaining with silence (underflow)
-        if samplesToRead < requestedCount {
-            let silenceCount = requestedCount - samplesToRead
-            for i in samplesToRead..<requestedCount {
-                destination[i] = 0
-            }
-            underflowCount += UInt64(silenceCount)
-        }
-
-        return samplesToRead
+        sample_ring_read(ring, destination, requestedCount)
     }
 
     /// Read samples into an array
@@ -188,44 +152,41 @@ final class CircularAudioBuffer {
         return result
     }
 
+    /// Drop the oldest samples without reading them (latency trimming; any thread)
+    /// - Parameter requestedCount: Samples to drop
+    /// - Returns: Samples actually dropped
+    @discardableResult
+    func discard(count requestedCount: Int) -> Int {
+        sample_ring_discard(ring, max(requestedCount, 0))
+    }
+
     // MARK: - Control
 
-    /// Clear all samples from buffer
+    /// Clear all samples from buffer (any thread)
     func clear() {
-        lock.lock()
-        defer { lock.unlock() }
-
-        readIndex = 0
-        writeIndex = 0
-        count = 0
+        sample_ring_clear(ring)
     }
 
     /// Reset statistics
     func resetStatistics() {
-        lock.lock()
-        defer { lock.unlock() }
-
-        totalSamplesWritten = 0
-        totalSamplesRead = 0
-        overflowCount = 0
-        underflowCount = 0
+        sample_ring_reset_statistics(ring)
     }
 
     // MARK: - Debug
 
     /// Get buffer statistics as string
     var statisticsDescription: String {
-        lock.lock()
-        defer { lock.unlock() }
+        let available = availableSamples
+        let statistics = self.statistics
 
         return """
         CircularAudioBuffer Statistics:
           Capacity: \(capacity) samples
-          Current: \(count) samples (\(String(format: "%.1f", Float(count) / Float(capacity) * 100))% full)
-          Written: \(totalSamplesWritten) samples
-          Read: \(totalSamplesRead) samples
-          Overflows: \(overflowCount)
-          Underflows: \(underflowCount)
+          Current: \(available) samples (\(String(format: "%.1f", Float(available) / Float(capacity) * 100))% full)
+          Written: \(statistics.written) samples
+          Read: \(statistics.read) samples
+          Overflows: \(statistics.overflowed)
+          Underflows: \(statistics.underflowed)
         """
     }
 }
@@ -244,17 +205,8 @@ extension CircularAudioBuffer {
 
     /// Verify buffer integrity (for testing)
     func verifyIntegrity() -> Bool {
-        lock.lock()
-        defer { lock.unlock() }
-
-        // Check that count is within bounds
-        guard count >= 0 && count <= capacity else { return false }
-
-        // Check that indices are within bounds
-        guard readIndex >= 0 && readIndex < capacity else { return false }
-        guard writeIndex >= 0 && writeIndex < capacity else { return false }
-
-        return true
+        let available = availableSamples
+        return available >= 0 && available <= capacity
     }
 }
 #endif
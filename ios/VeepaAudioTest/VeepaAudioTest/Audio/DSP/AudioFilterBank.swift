@@ -0,0 +1,120 @@
+//
+//  AudioFilterBank.swift
+//  VeepaAudioTest
+//
+//  Created for DC offset and mains hum removal
+//  Purpose: Swift access to the per-session clean-up filters - pick a
+//           stream's preset from any thread
+//
+//  The biquad design, presets and SIMD cascade live in Biquad.c, the
+//  per-slot rows in FilterBank.c. The bridge's bank covers the SDK voice
+//  session (AudioHookBridge.filterBank, slot sdkSessionSlot); a gateway
+//  creates one sized like its SessionTable and hands frames of many
+//  cameras to process(jobs:) so they are filtered four at a time.
+//
+
+import Foundation
+
+final class AudioFilterBank {
+
+    enum FilterError: Error, LocalizedError {
+        case creationFailed(capacity: Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed(let capacity):
+                return "Cannot allocate filters for \(capacity) sessions"
+            }
+        }
+    }
+
+    enum Preset: CaseIterable, Equatable {
+        case off
+        case dcBlock
+        case highPass80
+        case highPass120
+        case hum50
+        case hum60
+
+        fileprivate init(_ preset: biquad_preset) {
+            switch preset {
+            case BIQUAD_PRESET_DC_BLOCK: self = .dcBlock
+            case BIQUAD_PRESET_HIGHPASS_80: self = .highPass80
+            case BIQUAD_PRESET_HIGHPASS_120: self = .highPass120
+            case BIQUAD_PRESET_HUM_50: self = .hum50
+            case BIQUAD_PRESET_HUM_60: self = .hum60
+            default: self = .off
+            }
+        }
+
+        var cValue: biquad_preset {
+            switch self {
+            case .off: return BIQUAD_PRESET_NONE
+            case .dcBlock: return BIQUAD_PRESET_DC_BLOCK
+            case .highPass80: return BIQUAD_PRESET_HIGHPASS_80
+            case .highPass120: return BIQUAD_PRESET_HIGHPASS_120
+            case .hum50: return BIQUAD_PRESET_HUM_50
+            case .hum60: return BIQUAD_PRESET_HUM_60
+            }
+        }
+
+        var name: String { String(cString: biquad_preset_name(cValue)) }
+    }
+
+    let bank: OpaquePointer
+    private let owned: Bool
+
+    /// New bank with its own per-slot state
+    init(capacity: Int) throws {
+        guard let bank = filter_bank_create(UInt32(capacity)) else {
+            throw FilterError.creationFailed(capacity: capacity)
+        }
+        self.bank = bank
+        self.owned = true
+    }
+
+    /// Wrap a bank owned elsewhere (e.g. AudioHookBridge.filterBank)
+    init(unowned bank: OpaquePointer) {
+        self.bank = bank
+        self.owned = false
+    }
+
+    deinit {
+        if owned {
+            filter_bank_destroy(bank)
+        }
+    }
+
+    /// The SDK voice session's filters
+    static var bridge: AudioFilterBank? {
+        AudioHookBridge.shared.filterBank.map { AudioFilterBank(unowned: $0) }
+    }
+
+    var capacity: Int { Int(filter_bank_capacity(bank)) }
+
+    // MARK: - Presets (any thread)
+
+    /// Takes effect from the slot's next frame
+    subscript(slot: session_slot) -> Preset {
+        get { Preset(filter_bank_get_preset(bank, slot)) }
+        set { filter_bank_set_preset(bank, slot, newValue.cValue) }
+    }
+
+    /// Clear a slot's filter memory when it is handed to a new stream
+    func resetSession(_ slot: session_slot) {
+        filter_bank_reset_slot(bank, slot)
+    }
+
+    // MARK: - Processing (capture thread of the slot)
+
+    func process(slot: session_slot, samples: UnsafeMutablePointer<Int16>, count: Int, sampleRate: Int) {
+        filter_bank_process(bank, slot, samples, count, UInt32(sampleRate))
+    }
+
+    /// Frames of many slots, all `count` samples at `sampleRate`
+    /// - Returns: Frames filtered
+    @discardableResult
+    func process(jobs: [filter_bank_job], count: Int, sampleRate: Int) -> Int {
+        filter_bank_process_jobs(bank, jobs, jobs.count, count, UInt32(sampleRate))
+    }
+}
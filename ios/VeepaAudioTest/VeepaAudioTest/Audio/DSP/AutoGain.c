@@ -0,0 +1,269 @@
+//
+//  AutoGain.c
+//  VeepaAudioTest
+//
+//  Created for quiet camera microphones
+//  Purpose: Per-stream fixed-point AGC (envelope, gate, limiter, gain ramp)
+//
+
+#include "AutoGain.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define ROW_ALIGN 64
+
+/// Envelope value before the first measured frame
+#define NO_LEVEL INT32_MIN
+
+/// Level column value for -inf (SessionTable's SESSION_LEVEL_SILENT)
+#define LEVEL_SILENT (-32768)
+
+/// One slot: a cache line of its own, so capture threads of different
+/// sessions never share one
+typedef struct {
+    uint64_t params;            ///< (atomic) packed auto_gain_params
+    int32_t  envelope_q8;       ///< Centibels × 256, NO_LEVEL before the first frame
+    int32_t  gate_q8;           ///< Gate attenuation, centibels × 256 (≤ 0)
+    int32_t  gain_q11;          ///< Gain at the end of the last frame
+    int16_t  gain_cb;           ///< (atomic) Same, for readers
+    uint8_t  reset;             ///< (atomic) Set by auto_gain_reset_slot
+} __attribute__((aligned(ROW_ALIGN))) gain_row;
+
+_Static_assert(sizeof(gain_row) == ROW_ALIGN, "one row per cache line");
+_Static_assert(sizeof(auto_gain_params) == sizeof(uint64_t), "parameters pack into one word");
+
+struct auto_gain_bank {
+    gain_row *rows;
+    uint32_t capacity;
+};
+
+#pragma mark - Gain Table
+
+/// Q11 gain per 0.1 dB from AUTO_GAIN_MIN_CB to AUTO_GAIN_MAX_CB (built on first use)
+#define GAIN_TABLE_SIZE ((AUTO_GAIN_MAX_CB - AUTO_GAIN_MIN_CB) / 10 + 1)
+static int32_t gain_table[GAIN_TABLE_SIZE];
+static int gain_table_ready;
+
+static void gain_table_init(void) {
+    if (__atomic_load_n(&gain_table_ready, __ATOMIC_ACQUIRE)) return;
+    for (int i = 0; i < GAIN_TABLE_SIZE; i++) {
+        double db = (AUTO_GAIN_MIN_CB + i * 10) / 100.0;
+        gain_table[i] = (int32_t)lround(AUTO_GAIN_UNITY_Q11 * pow(10.0, db / 20.0));
+    }
+    __atomic_store_n(&gain_table_ready, 1, __ATOMIC_RELEASE);
+}
+
+int32_t auto_gain_q11_from_cb(int32_t centibels) {
+    gain_table_init();
+    if (centibels < AUTO_GAIN_MIN_CB) centibels = AUTO_GAIN_MIN_CB;
+    if (centibels > AUTO_GAIN_MAX_CB) centibels = AUTO_GAIN_MAX_CB;
+    return gain_table[(centibels - AUTO_GAIN_MIN_CB + 5) / 10];
+}
+
+#pragma mark - Lifecycle
+
+auto_gain_params auto_gain_default_params(void) {
+    auto_gain_params params = {
+        .target_dbfs = -20,
+        .gate_dbfs = -55,
+        .ceiling_dbfs = -1,
+        .max_gain_db = 24,
+        .gate_depth_db = 12,
+        .attack_ms = 10,
+        .release_cs = 100,
+        .enabled = 0,
+    };
+    return params;
+}
+
+static uint64_t pack_params(const auto_gain_params *params) {
+    uint64_t word;
+    memcpy(&word, params, sizeof(word));
+    return word;
+}
+
+static auto_gain_params unpack_params(uint64_t word) {
+    auto_gain_params params;
+    memcpy(&params, &word, sizeof(params));
+    return params;
+}
+
+static void reset_row(gain_row *row) {
+    row->envelope_q8 = NO_LEVEL;
+    row->gate_q8 = 0;
+    row->gain_q11 = AUTO_GAIN_UNITY_Q11;
+    __atomic_store_n(&row->gain_cb, 0, __ATOMIC_RELAXED);
+}
+
+auto_gain_bank *auto_gain_bank_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+
+    auto_gain_bank *bank = (auto_gain_bank *)calloc(1, sizeof(auto_gain_bank));
+    if (bank == NULL) return NULL;
+
+    size_t bytes = (size_t)capacity * sizeof(gain_row);
+    bank->rows = (gain_row *)aligned_alloc(ROW_ALIGN, bytes);
+    if (bank->rows == NULL) {
+        free(bank);
+        return NULL;
+    }
+    memset(bank->rows, 0, bytes);
+
+    auto_gain_params params = auto_gain_default_params();
+    uint64_t defaults = pack_params(&params);
+    for (uint32_t slot = 0; slot < capacity; slot++) {
+        bank->rows[slot].params = defaults;
+        reset_row(&bank->rows[slot]);
+    }
+
+    bank->capacity = capacity;
+    gain_table_init();
+    return bank;
+}
+
+void auto_gain_bank_destroy(auto_gain_bank *bank) {
+    if (bank == NULL) return;
+    free(bank->rows);
+    free(bank);
+}
+
+uint32_t auto_gain_bank_capacity(const auto_gain_bank *bank) {
+    return bank->capacity;
+}
+
+#pragma mark - Parameters
+
+void auto_gain_set_params(auto_gain_bank *bank, uint32_t slot, const auto_gain_params *params) {
+    if (bank == NULL || slot >= bank->capacity) return;
+    __atomic_store_n(&bank->rows[slot].params, pack_params(params), __ATOMIC_RELAXED);
+}
+
+auto_gain_params auto_gain_get_params(const auto_gain_bank *bank, uint32_t slot) {
+    if (bank == NULL || slot >= bank->capacity) return auto_gain_default_params();
+    return unpack_params(__atomic_load_n(&bank->rows[slot].params, __ATOMIC_RELAXED));
+}
+
+int16_t auto_gain_current_cb(const auto_gain_bank *bank, uint32_t slot) {
+    if (bank == NULL || slot >= bank->capacity) return 0;
+    return __atomic_load_n(&bank->rows[slot].gain_cb, __ATOMIC_RELAXED);
+}
+
+void auto_gain_reset_slot(auto_gain_bank *bank, uint32_t slot) {
+    if (bank == NULL || slot >= bank->capacity) return;
+    __atomic_store_n(&bank->rows[slot].reset, 1, __ATOMIC_RELEASE);
+}
+
+#pragma mark - Gain Ramp
+
+void auto_gain_apply_ramp(int16_t *pcm, size_t count, int32_t from_q11, int32_t to_q11) {
+    if (count == 0) return;
+
+    // Gain accumulates with 4 extra fraction bits so even long frames move
+    // it every sample; products of int16 and a Q11 gain below 32× fit int32
+    int32_t step = (int32_t)((int64_t)(to_q11 - from_q11) * 16 / (int64_t)count);
+    int32_t acc = from_q11 * 16;
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    const int32_t lanes[4] = {1, 2, 3, 4};
+    int32x4_t accLow = vmlaq_n_s32(vdupq_n_s32(acc), vld1q_s32(lanes), step);
+    int32x4_t accHigh = vaddq_s32(accLow, vdupq_n_s32(4 * step));
+    const int32x4_t advance = vdupq_n_s32(8 * step);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(pcm + i);
+        int32x4_t low = vmulq_s32(vmovl_s16(vget_low_s16(x)), vshrq_n_s32(accLow, 4));
+        int32x4_t high = vmulq_s32(vmovl_s16(vget_high_s16(x)), vshrq_n_s32(accHigh, 4));
+        vst1q_s16(pcm + i, vcombine_s16(vqrshrn_n_s32(low, 11), vqrshrn_n_s32(high, 11)));
+        accLow = vaddq_s32(accLow, advance);
+        accHigh = vaddq_s32(accHigh, advance);
+    }
+    acc += (int32_t)i * step;
+#endif
+
+    // Same rounding and saturation as vqrshrn
+    for (; i < count; i++) {
+        acc += step;
+        int32_t y = (pcm[i] * (acc >> 4) + (1 << 10)) >> 11;
+        if (y > INT16_MAX) y = INT16_MAX;
+        if (y < INT16_MIN) y = INT16_MIN;
+        pcm[i] = (int16_t)y;
+    }
+}
+
+#pragma mark - Processing
+
+/// One-pole smoothing coefficient in Q15 for a frame of `frame_us` against
+/// a time constant of `tc_us` (frame / (tc + frame), integer-only)
+static inline int32_t smoothing_q15(uint32_t frame_us, uint32_t tc_us) {
+    return (int32_t)(((uint64_t)frame_us << 15) / ((uint64_t)tc_us + frame_us));
+}
+
+static inline int32_t smooth(int32_t value, int32_t target, int32_t coefficient_q15) {
+    return value + (int32_t)(((int64_t)(target - value) * coefficient_q15) >> 15);
+}
+
+int16_t auto_gain_process(auto_gain_bank *bank, uint32_t slot, int16_t *pcm, size_t count,
+                          uint32_t sample_rate, int16_t level_cb, int16_t peak_cb) {
+    if (bank == NULL || slot >= bank->capacity || count == 0 || sample_rate == 0) return 0;
+    gain_row *row = &bank->rows[slot];
+    auto_gain_params params = unpack_params(__atomic_load_n(&row->params, __ATOMIC_RELAXED));
+    if (__atomic_exchange_n(&row->reset, 0, __ATOMIC_ACQUIRE)) {
+        reset_row(row);
+    }
+
+    uint32_t frame_us = (uint32_t)((uint64_t)count * 1000000 / sample_rate);
+    uint32_t attack_us = (params.attack_ms ? params.attack_ms : 1) * 1000u;
+    uint32_t release_us = (params.release_cs ? params.release_cs : 1) * 10000u;
+    int32_t attack = smoothing_q15(frame_us, attack_us);
+    int32_t release = smoothing_q15(frame_us, release_us);
+
+    // Envelope: frozen while gated, so pauses do not raise the gain
+    int gated = level_cb < params.gate_dbfs * 100;
+    if (!gated) {
+        int32_t level = level_cb * 256;
+        if (row->envelope_q8 == NO_LEVEL) {
+            row->envelope_q8 = level;
+        } else {
+            row->envelope_q8 = smooth(row->envelope_q8, level, level > row->envelope_q8 ? attack : release);
+        }
+    }
+
+    // Gate: fades down at the release rate, opens at the attack rate
+    int32_t gate_target = gated ? -(int32_t)params.gate_depth_db * 100 * 256 : 0;
+    row->gate_q8 = smooth(row->gate_q8, gate_target, gate_target > row->gate_q8 ? attack : release);
+
+    int32_t max_boost = (params.max_gain_db < AUTO_GAIN_MAX_CB / 100 ? params.max_gain_db : AUTO_GAIN_MAX_CB / 100) * 100;
+    int32_t gain_cb = 0;
+    if (row->envelope_q8 != NO_LEVEL) {
+        gain_cb = params.target_dbfs * 100 - row->envelope_q8 / 256;
+        if (gain_cb > max_boost) gain_cb = max_boost;
+        if (gain_cb < -AUTO_GAIN_MAX_CUT_CB) gain_cb = -AUTO_GAIN_MAX_CUT_CB;
+    }
+    gain_cb += row->gate_q8 / 256;
+
+    // Limiter: keep this frame's peak under the ceiling from its first sample
+    int32_t from = row->gain_q11;
+    if (params.enabled && peak_cb != LEVEL_SILENT) {
+        int32_t headroom = params.ceiling_dbfs * 100 - peak_cb;
+        if (gain_cb > headroom) gain_cb = headroom;
+        int32_t limit = auto_gain_q11_from_cb(headroom);
+        if (from > limit) from = limit;
+    }
+    if (!params.enabled) gain_cb = 0;   // Ramps back to unity from the last gain
+    if (gain_cb < AUTO_GAIN_MIN_CB) gain_cb = AUTO_GAIN_MIN_CB;
+    if (gain_cb > AUTO_GAIN_MAX_CB) gain_cb = AUTO_GAIN_MAX_CB;
+    int32_t to = auto_gain_q11_from_cb(gain_cb);
+
+    if (pcm != NULL && (from != AUTO_GAIN_UNITY_Q11 || to != AUTO_GAIN_UNITY_Q11)) {
+        auto_gain_apply_ramp(pcm, count, from, to);
+    }
+    row->gain_q11 = to;
+    __atomic_store_n(&row->gain_cb, (int16_t)gain_cb, __ATOMIC_RELAXED);
+    return (int16_t)gain_cb;
+}
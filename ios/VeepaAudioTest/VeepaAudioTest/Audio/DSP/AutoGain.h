@@ -0,0 +1,110 @@
+//
+//  AutoGain.h
+//  VeepaAudioTest
+//
+//  Created for quiet camera microphones
+//  Purpose: Fixed-point automatic gain control per stream - fast-attack /
+//           slow-release level envelope, noise gate and peak limiter
+//
+//  Nothing is measured here: each frame's RMS and peak come from the level
+//  meter that already runs on every frame (SessionTable level_cb/peak_cb,
+//  taken from the A-law bytes by g711_alaw_measure). Per frame the bank
+//  updates the envelope in centibels and derives one gain; the gain is
+//  ramped linearly across the frame so changes never click.
+//
+//  - envelope: rises with attack_ms, falls with release_cs; gain =
+//    target - envelope, at most max_gain_db up and AUTO_GAIN_MAX_CUT_CB down
+//  - gate: frames below gate_dbfs freeze the envelope (pauses do not pump
+//    the background up) and fade the gain down by gate_depth_db
+//  - limiter: a frame whose peak would pass ceiling_dbfs gets a lower gain
+//    at once, from its first sample
+//
+//  Samples are scaled in Q11 (gain up to 32×) with a rounding, saturating
+//  narrow. The ramp kernel has a NEON path (8 samples per iteration) and a
+//  scalar path with identical results.
+//
+//  Threading: auto_gain_process runs on the slot's capture thread (one
+//  per slot). Parameters are one packed 64-bit word per slot, so any thread
+//  may change them at any time and a frame always sees a whole set.
+//
+
+#ifndef AutoGain_h
+#define AutoGain_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Largest cut the envelope may ask for, centibels
+#define AUTO_GAIN_MAX_CUT_CB    3000
+/// Gain range the kernel accepts, centibels (+30 dB fits Q11 in 16 bits)
+#define AUTO_GAIN_MIN_CB        (-6000)
+#define AUTO_GAIN_MAX_CB        3000
+/// Unity gain in Q11
+#define AUTO_GAIN_UNITY_Q11     2048
+
+/// Per-stream settings (8 bytes, stored as one atomic word)
+typedef struct {
+    int8_t  target_dbfs;     ///< Level the envelope is steered to
+    int8_t  gate_dbfs;       ///< Frames below this RMS are gated
+    int8_t  ceiling_dbfs;    ///< Limiter ceiling for sample peaks
+    uint8_t max_gain_db;     ///< Largest boost (capped at +30 dB)
+    uint8_t gate_depth_db;   ///< Attenuation while gated (0 = gate only freezes)
+    uint8_t attack_ms;       ///< Envelope rise time constant (≥ 1)
+    uint8_t release_cs;      ///< Envelope fall time constant, 10 ms units (≥ 1)
+    uint8_t enabled;         ///< 0 = pass-through (the envelope still tracks)
+} auto_gain_params;
+
+typedef struct auto_gain_bank auto_gain_bank;
+
+/// -20 dBFS target, +24 dB boost, -55 dBFS gate at 12 dB, -1 dBFS ceiling,
+/// 10 ms attack, 1 s release; disabled
+auto_gain_params auto_gain_default_params(void);
+
+/// @param capacity Session slots (match the SessionTable's capacity)
+/// @return NULL if allocation fails
+auto_gain_bank *auto_gain_bank_create(uint32_t capacity);
+
+void auto_gain_bank_destroy(auto_gain_bank *bank);
+
+uint32_t auto_gain_bank_capacity(const auto_gain_bank *bank);
+
+#pragma mark - Parameters (any thread)
+
+void auto_gain_set_params(auto_gain_bank *bank, uint32_t slot, const auto_gain_params *params);
+
+auto_gain_params auto_gain_get_params(const auto_gain_bank *bank, uint32_t slot);
+
+/// Gain applied at the end of the slot's last frame, centibels
+int16_t auto_gain_current_cb(const auto_gain_bank *bank, uint32_t slot);
+
+/// Forget a slot's envelope and gain when it is handed to a new stream
+/// (its parameters are kept)
+void auto_gain_reset_slot(auto_gain_bank *bank, uint32_t slot);
+
+#pragma mark - Processing (capture thread of the slot)
+
+/// Track one frame and scale its samples in place
+/// @param pcm Decoded samples, or NULL to only track the level (frames
+///   that are not decoded), so the gain is right when decoding resumes
+/// @param level_cb Frame RMS from the level meter (SESSION_LEVEL_SILENT for -inf)
+/// @param peak_cb Frame peak from the level meter
+/// @return Gain at the end of the frame, centibels
+int16_t auto_gain_process(auto_gain_bank *bank, uint32_t slot, int16_t *pcm, size_t count,
+                          uint32_t sample_rate, int16_t level_cb, int16_t peak_cb);
+
+/// Scale `count` samples by a gain ramping linearly from `from_q11` to
+/// `to_q11` (reached, to within rounding, on the last sample); gains in [0, 65535]
+void auto_gain_apply_ramp(int16_t *pcm, size_t count, int32_t from_q11, int32_t to_q11);
+
+/// Centibels to a Q11 gain (0.1 dB steps, clamped to AUTO_GAIN_MIN/MAX_CB)
+int32_t auto_gain_q11_from_cb(int32_t centibels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AutoGain_h */
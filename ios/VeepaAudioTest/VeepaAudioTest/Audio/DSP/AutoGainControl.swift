@@ -0,0 +1,122 @@
+//
+//  AutoGainControl.swift
+//  VeepaAudioTest
+//
+//  Created for quiet camera microphones
+//  Purpose: Swift access to the per-session AGC - read and change a
+//           stream's gain settings from any thread, and see the gain it
+//           currently applies
+//
+//  The envelope, gate, limiter and gain ramp live in AutoGain.c. The
+//  bridge's bank covers the SDK voice session (AudioHookBridge.autoGain,
+//  slot sdkSessionSlot); a gateway serving many cameras creates one sized
+//  like its SessionTable and runs auto_gain_process on each camera's
+//  capture thread with that camera's level columns.
+//
+
+import Foundation
+
+final class AutoGainControl {
+
+    enum GainError: Error, LocalizedError {
+        case creationFailed(capacity: Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed(let capacity):
+                return "Cannot allocate automatic gain for \(capacity) sessions"
+            }
+        }
+    }
+
+    /// One stream's settings, in dB and milliseconds (stored in the C
+    /// bank's whole-dB and 10 ms units, clamped to their ranges)
+    struct Parameters: Equatable {
+        var enabled = false
+        var targetDbfs = -20
+        var gateDbfs = -55
+        var ceilingDbfs = -1
+        var maxGainDb = 24
+        var gateDepthDb = 12
+        var attackMs = 10
+        var releaseMs = 1000
+
+        init() {}
+
+        fileprivate init(_ params: auto_gain_params) {
+            enabled = params.enabled != 0
+            targetDbfs = Int(params.target_dbfs)
+            gateDbfs = Int(params.gate_dbfs)
+            ceilingDbfs = Int(params.ceiling_dbfs)
+            maxGainDb = Int(params.max_gain_db)
+            gateDepthDb = Int(params.gate_depth_db)
+            attackMs = Int(params.attack_ms)
+            releaseMs = Int(params.release_cs) * 10
+        }
+
+        fileprivate var cValue: auto_gain_params {
+            func level(_ dbfs: Int) -> Int8 { Int8(clamping: min(dbfs, 0)) }
+            return auto_gain_params(
+                target_dbfs: level(targetDbfs),
+                gate_dbfs: level(gateDbfs),
+                ceiling_dbfs: level(ceilingDbfs),
+                max_gain_db: UInt8(clamping: min(maxGainDb, Int(AUTO_GAIN_MAX_CB) / 100)),
+                gate_depth_db: UInt8(clamping: gateDepthDb),
+                attack_ms: UInt8(clamping: max(attackMs, 1)),
+                release_cs: UInt8(clamping: max(releaseMs / 10, 1)),
+                enabled: enabled ? 1 : 0)
+        }
+    }
+
+    let bank: OpaquePointer
+    private let owned: Bool
+
+    /// New bank with its own per-slot state
+    init(capacity: Int) throws {
+        guard let bank = auto_gain_bank_create(UInt32(capacity)) else {
+            throw GainError.creationFailed(capacity: capacity)
+        }
+        self.bank = bank
+        self.owned = true
+    }
+
+    /// Wrap a bank owned elsewhere (e.g. AudioHookBridge.autoGain)
+    init(unowned bank: OpaquePointer) {
+        self.bank = bank
+        self.owned = false
+    }
+
+    deinit {
+        if owned {
+            auto_gain_bank_destroy(bank)
+        }
+    }
+
+    /// The SDK voice session's AGC
+    static var bridge: AutoGainControl? {
+        AudioHookBridge.shared.autoGain.map { AutoGainControl(unowned: $0) }
+    }
+
+    var capacity: Int { Int(auto_gain_bank_capacity(bank)) }
+
+    // MARK: - Settings (any thread)
+
+    /// Takes effect from the slot's next frame
+    subscript(slot: session_slot) -> Parameters {
+        get { Parameters(auto_gain_get_params(bank, slot)) }
+        set {
+            var params = newValue.cValue
+            auto_gain_set_params(bank, slot, &params)
+        }
+    }
+
+    /// Gain applied at the end of the slot's last frame
+    func currentGainDb(_ slot: session_slot) -> Double {
+        Double(auto_gain_current_cb(bank, slot)) / 100
+    }
+
+    /// Start a slot's envelope afresh when it is handed to a new stream
+    func resetSession(_ slot: session_slot) {
+        auto_gain_reset_slot(bank, slot)
+    }
+}
@@ -0,0 +1,213 @@
+//
+//  BatchDecoder.c
+//  VeepaAudioTest
+//
+//  Created for many-session decoding
+//  Purpose: Cross-stream batched G.711a decode scheduler
+//
+
+#include "BatchDecoder.h"
+#include "G711.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Write and read indices on separate cache lines (producer vs consumer)
+typedef struct {
+    uint32_t write;             ///< (atomic) Published by the scheduler
+    uint8_t pad0[60];
+    uint32_t read;              ///< (atomic) Advanced by the reader
+    uint8_t pad1[60];
+} ring_indices;
+
+typedef struct {
+    uint32_t stream;
+    uint32_t offset;            ///< Into the arena
+    uint32_t length;
+} staged_frame;
+
+struct batch_decoder {
+    batch_decoder_config config;
+    uint32_t ring_mask;
+
+    // Per-stream state, indexed by stream
+    int16_t *rings;             ///< max_streams × ring_samples
+    ring_indices *indices;
+    uint32_t *pending_write;    ///< Scheduler's unpublished write index
+    uint8_t *touched;
+
+    // Current quantum
+    uint8_t *arena;
+    uint32_t arena_used;
+    staged_frame *frames;
+    uint32_t frame_count;
+
+    // Scratch for run()
+    g711_decode_job *jobs;
+    uint32_t *touched_list;
+
+    batch_decoder_stats stats;
+};
+
+static uint32_t round_up_pow2(uint32_t value) {
+    uint32_t result = 16;
+    while (result < value && result < (1u << 30)) result <<= 1;
+    return result;
+}
+
+void batch_decoder_config_init(batch_decoder_config *config) {
+    config->max_streams = 256;
+    config->ring_samples = 2048;
+    config->arena_bytes = 256 * 1024;
+    config->max_frames = 2048;
+}
+
+batch_decoder *batch_decoder_create(const batch_decoder_config *config) {
+    if (config->max_streams == 0 || config->max_frames == 0 || config->arena_bytes == 0) return NULL;
+
+    batch_decoder *decoder = (batch_decoder *)calloc(1, sizeof(batch_decoder));
+    if (decoder == NULL) return NULL;
+
+    decoder->config = *config;
+    decoder->config.ring_samples = round_up_pow2(config->ring_samples);
+    decoder->ring_mask = decoder->config.ring_samples - 1;
+
+    size_t streams = config->max_streams;
+    decoder->rings = (int16_t *)calloc(streams * decoder->config.ring_samples, sizeof(int16_t));
+    decoder->indices = (ring_indices *)calloc(streams, sizeof(ring_indices));
+    decoder->pending_write = (uint32_t *)calloc(streams, sizeof(uint32_t));
+    decoder->touched = (uint8_t *)calloc(streams, 1);
+    decoder->touched_list = (uint32_t *)calloc(streams, sizeof(uint32_t));
+    decoder->arena = (uint8_t *)malloc(config->arena_bytes);
+    decoder->frames = (staged_frame *)calloc(config->max_frames, sizeof(staged_frame));
+    decoder->jobs = (g711_decode_job *)calloc((size_t)config->max_frames * 2, sizeof(g711_decode_job));
+
+    if (!decoder->rings || !decoder->indices || !decoder->pending_write || !decoder->touched ||
+        !decoder->touched_list || !decoder->arena || !decoder->frames || !decoder->jobs) {
+        batch_decoder_destroy(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+void batch_decoder_destroy(batch_decoder *decoder) {
+    if (decoder == NULL) return;
+    free(decoder->rings);
+    free(decoder->indices);
+    free(decoder->pending_write);
+    free(decoder->touched);
+    free(decoder->touched_list);
+    free(decoder->arena);
+    free(decoder->frames);
+    free(decoder->jobs);
+    free(decoder);
+}
+
+int batch_decoder_submit(batch_decoder *decoder, uint32_t stream, const uint8_t *alaw, uint32_t length) {
+    if (stream >= decoder->config.max_streams) return BATCH_DECODER_ERR_STREAM;
+    if (decoder->frame_count == decoder->config.max_frames ||
+        length > decoder->config.arena_bytes - decoder->arena_used) {
+        decoder->stats.rejected_frames++;
+        return BATCH_DECODER_ERR_FULL;
+    }
+
+    memcpy(decoder->arena + decoder->arena_used, alaw, length);
+    staged_frame *frame = &decoder->frames[decoder->frame_count++];
+    frame->stream = stream;
+    frame->offset = decoder->arena_used;
+    frame->length = length;
+    decoder->arena_used += length;
+    return BATCH_DECODER_OK;
+}
+
+uint32_t batch_decoder_run(batch_decoder *decoder) {
+    const uint32_t capacity = decoder->config.ring_samples;
+    uint32_t job_count = 0;
+    uint32_t touched_count = 0;
+    uint32_t decoded = 0;
+    uint64_t samples = 0;
+
+    // 1. Gather: one job per frame (two where it wraps its ring)
+    for (uint32_t f = 0; f < decoder->frame_count; f++) {
+        const staged_frame *frame = &decoder->frames[f];
+        uint32_t stream = frame->stream;
+        ring_indices *indices = &decoder->indices[stream];
+
+        if (!decoder->touched[stream]) {
+            decoder->touched[stream] = 1;
+            decoder->touched_list[touched_count++] = stream;
+            decoder->pending_write[stream] = __atomic_load_n(&indices->write, __ATOMIC_RELAXED);
+        }
+
+        uint32_t write = decoder->pending_write[stream];
+        uint32_t read = __atomic_load_n(&indices->read, __ATOMIC_ACQUIRE);
+        if (frame->length > capacity - (write - read)) {
+            decoder->stats.dropped_frames++;
+            continue;
+        }
+
+        int16_t *ring = decoder->rings + (size_t)stream * capacity;
+        const uint8_t *alaw = decoder->arena + frame->offset;
+        uint32_t position = write & decoder->ring_mask;
+        uint32_t first = capacity - position;
+        if (first > frame->length) first = frame->length;
+
+        decoder->jobs[job_count++] = (g711_decode_job){ alaw, ring + position, first };
+        if (first < frame->length) {
+            decoder->jobs[job_count++] = (g711_decode_job){ alaw + first, ring, frame->length - first };
+        }
+
+        decoder->pending_write[stream] = write + frame->length;
+        samples += frame->length;
+        decoded++;
+    }
+
+    // 2. One vectorized pass over the work list
+    g711_alaw_decode_jobs(decoder->jobs, job_count);
+
+    // 3. Publish each touched ring once
+    for (uint32_t i = 0; i < touched_count; i++) {
+        uint32_t stream = decoder->touched_list[i];
+        __atomic_store_n(&decoder->indices[stream].write, decoder->pending_write[stream], __ATOMIC_RELEASE);
+        decoder->touched[stream] = 0;
+    }
+
+    if (decoded > 0) decoder->stats.quanta++;
+    decoder->stats.frames += decoded;
+    decoder->stats.samples += samples;
+    decoder->stats.jobs += job_count;
+
+    decoder->frame_count = 0;
+    decoder->arena_used = 0;
+    return decoded;
+}
+
+uint32_t batch_decoder_available(batch_decoder *decoder, uint32_t stream) {
+    if (stream >= decoder->config.max_streams) return 0;
+    ring_indices *indices = &decoder->indices[stream];
+    return __atomic_load_n(&indices->write, __ATOMIC_ACQUIRE) - __atomic_load_n(&indices->read, __ATOMIC_RELAXED);
+}
+
+uint32_t batch_decoder_read(batch_decoder *decoder, uint32_t stream, int16_t *pcm, uint32_t capacity) {
+    if (stream >= decoder->config.max_streams) return 0;
+
+    ring_indices *indices = &decoder->indices[stream];
+    uint32_t write = __atomic_load_n(&indices->write, __ATOMIC_ACQUIRE);
+    uint32_t read = __atomic_load_n(&indices->read, __ATOMIC_RELAXED);
+    uint32_t count = write - read;
+    if (count > capacity) count = capacity;
+
+    const int16_t *ring = decoder->rings + (size_t)stream * decoder->config.ring_samples;
+    uint32_t position = read & decoder->ring_mask;
+    uint32_t first = decoder->config.ring_samples - position;
+    if (first > count) first = count;
+    memcpy(pcm, ring + position, (size_t)first * sizeof(int16_t));
+    memcpy(pcm + first, ring, (size_t)(count - first) * sizeof(int16_t));
+
+    __atomic_store_n(&indices->read, read + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+void batch_decoder_get_stats(const batch_decoder *decoder, batch_decoder_stats *stats) {
+    *stats = decoder->stats;
+}
@@ -0,0 +1,86 @@
+//
+//  BatchDecoder.h
+//  VeepaAudioTest
+//
+//  Created for many-session decoding
+//  Purpose: Decode the frames of many concurrent streams in one batched
+//           pass per scheduling quantum, straight into each stream's ring
+//
+//  With hundreds of sessions delivering 160-480 byte frames, decoding each
+//  frame as it arrives spends more on per-frame overhead (a call, a scratch
+//  buffer, a copy into the stream's ring under its lock) than on the decode
+//  itself. Here the scheduler thread stages every ready frame of the
+//  quantum (one memcpy of A-law bytes into an arena), then batch_decoder_run
+//  builds a work list that targets each stream's ring directly and decodes
+//  it with g711_alaw_decode_jobs in one tight NEON pass. Each touched ring
+//  publishes its new write index once at the end of the pass.
+//
+//  Threading: submit/run belong to one scheduler thread. Each stream ring is
+//  single-producer (the scheduler) / single-consumer (that stream's reader).
+//
+
+#ifndef BatchDecoder_h
+#define BatchDecoder_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct batch_decoder batch_decoder;
+
+typedef struct {
+    uint32_t max_streams;
+    uint32_t ring_samples;      ///< Per-stream PCM ring (rounded up to a power of two)
+    uint32_t arena_bytes;       ///< A-law bytes staged per quantum
+    uint32_t max_frames;        ///< Frames staged per quantum
+} batch_decoder_config;
+
+typedef struct {
+    uint64_t quanta;            ///< batch_decoder_run calls that decoded something
+    uint64_t frames;            ///< Frames decoded
+    uint64_t samples;
+    uint64_t jobs;              ///< Work-list entries (a frame wrapping its ring takes two)
+    uint64_t dropped_frames;    ///< Stream ring full (reader behind)
+    uint64_t rejected_frames;   ///< Arena or frame list full at submit
+} batch_decoder_stats;
+
+/// Error codes (negative return values)
+enum {
+    BATCH_DECODER_OK            = 0,
+    BATCH_DECODER_ERR_STREAM    = -1,  ///< Stream index out of range
+    BATCH_DECODER_ERR_FULL      = -2,  ///< Quantum is full; run it first
+};
+
+/// Defaults: 256 streams, 2048-sample rings, 256 KB arena, 2048 frames
+void batch_decoder_config_init(batch_decoder_config *config);
+
+/// @return NULL if allocation fails
+batch_decoder *batch_decoder_create(const batch_decoder_config *config);
+
+void batch_decoder_destroy(batch_decoder *decoder);
+
+/// Stage one frame for the current quantum (copies the A-law bytes)
+/// @return BATCH_DECODER_OK or a negative error code
+int batch_decoder_submit(batch_decoder *decoder, uint32_t stream, const uint8_t *alaw, uint32_t length);
+
+/// Decode every staged frame into its stream's ring and start a new quantum
+/// @return Frames decoded
+uint32_t batch_decoder_run(batch_decoder *decoder);
+
+/// Decoded samples waiting in a stream's ring (reader side)
+uint32_t batch_decoder_available(batch_decoder *decoder, uint32_t stream);
+
+/// Take up to `capacity` decoded samples from a stream's ring (reader side)
+/// @return Samples copied
+uint32_t batch_decoder_read(batch_decoder *decoder, uint32_t stream, int16_t *pcm, uint32_t capacity);
+
+void batch_decoder_get_stats(const batch_decoder *decoder, batch_decoder_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BatchDecoder_h */
@@ -0,0 +1,345 @@
+//
+//  Biquad.c
+//  VeepaAudioTest
+//
+//  Created for loudness measurement
+//  Purpose: Wavefront biquad cascade (one section per SIMD lane), batch
+//           mode (one stream per lane) and the clean-up presets
+//
+
+#include "Biquad.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+_Static_assert(BIQUAD_LATENCY == BIQUAD_MAX_SECTIONS - 1, "one step per lane");
+
+/// Samples converted per pass (stack buffers)
+#define CHUNK_SAMPLES 256
+#define BATCH_CHUNK_SAMPLES (CHUNK_SAMPLES / BIQUAD_BATCH_STREAMS)
+
+#pragma mark - Setup
+
+int biquad_cascade_init(biquad_cascade *cascade, const biquad_coefficients *sections, uint32_t count) {
+    if (count == 0 || count > BIQUAD_MAX_SECTIONS) return -1;
+
+    // Leading lanes pass samples through, so the last section is always
+    // the last lane and the latency does not depend on the section count
+    uint32_t first = BIQUAD_MAX_SECTIONS - count;
+    for (uint32_t lane = 0; lane < BIQUAD_MAX_SECTIONS; lane++) {
+        biquad_coefficients c = { 1, 0, 0, 0, 0 };
+        if (lane >= first) c = sections[lane - first];
+        cascade->b0[lane] = (float)c.b0;
+        cascade->b1[lane] = (float)c.b1;
+        cascade->b2[lane] = (float)c.b2;
+        cascade->a1[lane] = (float)c.a1;
+        cascade->a2[lane] = (float)c.a2;
+    }
+    cascade->sections = count;
+    return 0;
+}
+
+void biquad_state_reset(biquad_state *state) {
+    memset(state, 0, sizeof(*state));
+}
+
+#pragma mark - Design
+
+biquad_coefficients biquad_highpass(uint32_t sample_rate, double f0, double q) {
+    double w0 = 2.0 * M_PI * f0 / sample_rate;
+    double cosw = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    biquad_coefficients c = {
+        .b0 = (1.0 + cosw) / 2.0 / a0,
+        .b1 = -(1.0 + cosw) / a0,
+        .b2 = (1.0 + cosw) / 2.0 / a0,
+        .a1 = -2.0 * cosw / a0,
+        .a2 = (1.0 - alpha) / a0,
+    };
+    return c;
+}
+
+biquad_coefficients biquad_notch(uint32_t sample_rate, double f0, double bandwidth) {
+    double w0 = 2.0 * M_PI * f0 / sample_rate;
+    double cosw = cos(w0);
+    double alpha = sin(w0) * bandwidth / (2.0 * f0);   // q = f0 / bandwidth
+    double a0 = 1.0 + alpha;
+    biquad_coefficients c = {
+        .b0 = 1.0 / a0,
+        .b1 = -2.0 * cosw / a0,
+        .b2 = 1.0 / a0,
+        .a1 = -2.0 * cosw / a0,
+        .a2 = (1.0 - alpha) / a0,
+    };
+    return c;
+}
+
+biquad_coefficients biquad_dc_blocker(uint32_t sample_rate, double corner) {
+    // y = g·(x - x[-1]) + r·y[-1]
+    double r = exp(-2.0 * M_PI * corner / sample_rate);
+    double g = (1.0 + r) / 2.0;
+    biquad_coefficients c = { .b0 = g, .b1 = -g, .b2 = 0, .a1 = -r, .a2 = 0 };
+    return c;
+}
+
+#pragma mark - Presets
+
+/// Section Qs of a 4th-order Butterworth
+#define BUTTERWORTH4_Q1 0.5411961001461970
+#define BUTTERWORTH4_Q2 1.3065629648763766
+
+/// Hum notch width: tolerates mains drift, keeps the voice band untouched
+#define HUM_NOTCH_BANDWIDTH 4.0
+#define DC_BLOCK_CORNER     5.0
+
+int biquad_preset_init(biquad_cascade *cascade, biquad_preset preset, uint32_t sample_rate) {
+    biquad_coefficients sections[BIQUAD_MAX_SECTIONS];
+    uint32_t count = 0;
+    double mains = 50.0;
+    if (cascade == NULL || sample_rate == 0) return -1;
+
+    switch (preset) {
+        case BIQUAD_PRESET_DC_BLOCK:
+            sections[count++] = biquad_dc_blocker(sample_rate, DC_BLOCK_CORNER);
+            break;
+        case BIQUAD_PRESET_HIGHPASS_80:
+        case BIQUAD_PRESET_HIGHPASS_120: {
+            double f0 = preset == BIQUAD_PRESET_HIGHPASS_80 ? 80.0 : 120.0;
+            sections[count++] = biquad_highpass(sample_rate, f0, BUTTERWORTH4_Q1);
+            sections[count++] = biquad_highpass(sample_rate, f0, BUTTERWORTH4_Q2);
+            break;
+        }
+        case BIQUAD_PRESET_HUM_60:
+            mains = 60.0;
+            // fall through
+        case BIQUAD_PRESET_HUM_50:
+            sections[count++] = biquad_dc_blocker(sample_rate, DC_BLOCK_CORNER);
+            for (int harmonic = 1; harmonic <= 3; harmonic++) {
+                sections[count++] = biquad_notch(sample_rate, mains * harmonic, HUM_NOTCH_BANDWIDTH);
+            }
+            break;
+        default:
+            return -1;
+    }
+    return biquad_cascade_init(cascade, sections, count);
+}
+
+const char *biquad_preset_name(biquad_preset preset) {
+    switch (preset) {
+        case BIQUAD_PRESET_NONE:          return "off";
+        case BIQUAD_PRESET_DC_BLOCK:      return "DC block";
+        case BIQUAD_PRESET_HIGHPASS_80:   return "80 Hz high-pass";
+        case BIQUAD_PRESET_HIGHPASS_120:  return "120 Hz high-pass";
+        case BIQUAD_PRESET_HUM_50:        return "50 Hz hum notch";
+        case BIQUAD_PRESET_HUM_60:        return "60 Hz hum notch";
+        default:                          return "unknown";
+    }
+}
+
+#pragma mark - Processing
+
+void biquad_process(const biquad_cascade *cascade, biquad_state *state,
+                    const float *input, float *output, size_t count) {
+#if defined(__ARM_NEON)
+    const float32x4_t b0 = vld1q_f32(cascade->b0);
+    const float32x4_t b1 = vld1q_f32(cascade->b1);
+    const float32x4_t b2 = vld1q_f32(cascade->b2);
+    const float32x4_t a1 = vld1q_f32(cascade->a1);
+    const float32x4_t a2 = vld1q_f32(cascade->a2);
+    float32x4_t s1 = vld1q_f32(state->s1);
+    float32x4_t s2 = vld1q_f32(state->s2);
+    float32x4_t pipe = vld1q_f32(state->pipe);
+
+    for (size_t i = 0; i < count; i++) {
+        // {x, y0, y1, y2}: the new sample enters lane 0, every other lane
+        // takes the previous output of the lane before it
+        float32x4_t x = vextq_f32(vdupq_n_f32(input[i]), pipe, 3);
+        float32x4_t y = vmlaq_f32(s1, b0, x);
+        s1 = vmlsq_f32(vmlaq_f32(s2, b1, x), a1, y);
+        s2 = vmlsq_f32(vmulq_f32(b2, x), a2, y);
+        pipe = y;
+        output[i] = vgetq_lane_f32(y, BIQUAD_MAX_SECTIONS - 1);
+    }
+
+    vst1q_f32(state->s1, s1);
+    vst1q_f32(state->s2, s2);
+    vst1q_f32(state->pipe, pipe);
+#else
+    biquad_state st = *state;
+
+    // Same lane updates as the NEON path; products are separate statements
+    // so the compiler cannot fuse them into a differently rounded FMA
+    for (size_t i = 0; i < count; i++) {
+        float x[BIQUAD_MAX_SECTIONS];
+        x[0] = input[i];
+        for (int lane = 1; lane < BIQUAD_MAX_SECTIONS; lane++) x[lane] = st.pipe[lane - 1];
+
+        for (int lane = 0; lane < BIQUAD_MAX_SECTIONS; lane++) {
+            float p0 = cascade->b0[lane] * x[lane];
+            float y = st.s1[lane] + p0;
+            float p1 = cascade->b1[lane] * x[lane];
+            float q1 = cascade->a1[lane] * y;
+            float p2 = cascade->b2[lane] * x[lane];
+            float q2 = cascade->a2[lane] * y;
+            st.s1[lane] = (st.s2[lane] + p1) - q1;
+            st.s2[lane] = p2 - q2;
+            st.pipe[lane] = y;
+        }
+        output[i] = st.pipe[BIQUAD_MAX_SECTIONS - 1];
+    }
+
+    *state = st;
+#endif
+}
+
+#pragma mark - 16-bit Samples
+
+static inline void load_s16(const int16_t *pcm, float *samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = (float)pcm[i];
+    }
+}
+
+/// Round to nearest (ties to even) and saturate, like vcvtnq + vqmovn
+static inline void store_s16(const float *samples, int16_t *pcm, size_t count) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t low = vcvtnq_s32_f32(vld1q_f32(samples + i));
+        int32x4_t high = vcvtnq_s32_f32(vld1q_f32(samples + i + 4));
+        vst1q_s16(pcm + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+#endif
+    for (; i < count; i++) {
+        float y = nearbyintf(samples[i]);
+        if (y > INT16_MAX) y = INT16_MAX;
+        if (y < INT16_MIN) y = INT16_MIN;
+        pcm[i] = (int16_t)y;
+    }
+}
+
+void biquad_process_s16(const biquad_cascade *cascade, biquad_state *state, int16_t *pcm, size_t count) {
+    float buffer[CHUNK_SAMPLES];
+    while (count > 0) {
+        size_t n = count < CHUNK_SAMPLES ? count : CHUNK_SAMPLES;
+        load_s16(pcm, buffer, n);
+        biquad_process(cascade, state, buffer, buffer, n);
+        store_s16(buffer, pcm, n);
+        pcm += n;
+        count -= n;
+    }
+}
+
+#pragma mark - Batch
+
+#if defined(__ARM_NEON)
+
+/// One sample of every stream through sections `first` ... 3, then the
+/// pass-through lanes below `first` shift their samples along. Sections are
+/// stepped last to first so each still sees the previous sample of the
+/// section before it - the wavefront's timing, with its arithmetic.
+static inline __attribute__((always_inline))
+float32x4_t batch_step(const biquad_cascade *c, float32x4_t x_new,
+                       float32x4_t s1[BIQUAD_MAX_SECTIONS], float32x4_t s2[BIQUAD_MAX_SECTIONS],
+                       float32x4_t pipe[BIQUAD_MAX_SECTIONS], const int first) {
+    for (int k = BIQUAD_MAX_SECTIONS - 1; k >= first; k--) {
+        float32x4_t x = k == 0 ? x_new : pipe[k - 1];
+        float32x4_t y = vmlaq_n_f32(s1[k], x, c->b0[k]);
+        s1[k] = vmlsq_n_f32(vmlaq_n_f32(s2[k], x, c->b1[k]), y, c->a1[k]);
+        s2[k] = vmlsq_n_f32(vmulq_n_f32(x, c->b2[k]), y, c->a2[k]);
+        pipe[k] = y;
+    }
+    for (int k = first - 1; k >= 0; k--) {
+        pipe[k] = k == 0 ? x_new : pipe[k - 1];
+    }
+    return pipe[BIQUAD_MAX_SECTIONS - 1];
+}
+
+/// Interleaved samples (stream-minor) through the cascade, in place
+static inline __attribute__((always_inline))
+void batch_run(const biquad_cascade *c, float *interleaved, size_t count,
+               float32x4_t s1[BIQUAD_MAX_SECTIONS], float32x4_t s2[BIQUAD_MAX_SECTIONS],
+               float32x4_t pipe[BIQUAD_MAX_SECTIONS], const int first) {
+    for (size_t i = 0; i < count; i++) {
+        float32x4_t y = batch_step(c, vld1q_f32(interleaved + i * BIQUAD_BATCH_STREAMS), s1, s2, pipe, first);
+        vst1q_f32(interleaved + i * BIQUAD_BATCH_STREAMS, y);
+    }
+}
+
+#endif
+
+void biquad_process_s16_batch(const biquad_cascade *cascade,
+                              biquad_state *const states[BIQUAD_BATCH_STREAMS],
+                              int16_t *const pcm[BIQUAD_BATCH_STREAMS], size_t count) {
+#if defined(__ARM_NEON)
+    // State is transposed to one vector per section, one lane per stream
+    float lanes[3][BIQUAD_MAX_SECTIONS][BIQUAD_BATCH_STREAMS] = {{{0}}};
+    for (int j = 0; j < BIQUAD_BATCH_STREAMS; j++) {
+        if (states[j] == NULL) continue;
+        for (int k = 0; k < BIQUAD_MAX_SECTIONS; k++) {
+            lanes[0][k][j] = states[j]->s1[k];
+            lanes[1][k][j] = states[j]->s2[k];
+            lanes[2][k][j] = states[j]->pipe[k];
+        }
+    }
+    float32x4_t s1[BIQUAD_MAX_SECTIONS], s2[BIQUAD_MAX_SECTIONS], pipe[BIQUAD_MAX_SECTIONS];
+    for (int k = 0; k < BIQUAD_MAX_SECTIONS; k++) {
+        s1[k] = vld1q_f32(lanes[0][k]);
+        s2[k] = vld1q_f32(lanes[1][k]);
+        pipe[k] = vld1q_f32(lanes[2][k]);
+    }
+    const int first = BIQUAD_MAX_SECTIONS - (int)cascade->sections;
+
+    float interleaved[BATCH_CHUNK_SAMPLES * BIQUAD_BATCH_STREAMS];
+    float column[BATCH_CHUNK_SAMPLES];
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < BATCH_CHUNK_SAMPLES ? count - done : BATCH_CHUNK_SAMPLES;
+        for (int j = 0; j < BIQUAD_BATCH_STREAMS; j++) {
+            for (size_t i = 0; i < n; i++) {
+                interleaved[i * BIQUAD_BATCH_STREAMS + j] = states[j] ? (float)pcm[j][done + i] : 0.0f;
+            }
+        }
+
+        // Specialised per section count, so the section loop unrolls
+        switch (first) {
+            case 0:  batch_run(cascade, interleaved, n, s1, s2, pipe, 0); break;
+            case 1:  batch_run(cascade, interleaved, n, s1, s2, pipe, 1); break;
+            case 2:  batch_run(cascade, interleaved, n, s1, s2, pipe, 2); break;
+            default: batch_run(cascade, interleaved, n, s1, s2, pipe, 3); break;
+        }
+
+        for (int j = 0; j < BIQUAD_BATCH_STREAMS; j++) {
+            if (states[j] == NULL) continue;
+            for (size_t i = 0; i < n; i++) {
+                column[i] = interleaved[i * BIQUAD_BATCH_STREAMS + j];
+            }
+            store_s16(column, pcm[j] + done, n);
+        }
+        done += n;
+    }
+
+    for (int k = 0; k < BIQUAD_MAX_SECTIONS; k++) {
+        vst1q_f32(lanes[0][k], s1[k]);
+        vst1q_f32(lanes[1][k], s2[k]);
+        vst1q_f32(lanes[2][k], pipe[k]);
+    }
+    for (int j = 0; j < BIQUAD_BATCH_STREAMS; j++) {
+        if (states[j] == NULL) continue;
+        for (int k = 0; k < BIQUAD_MAX_SECTIONS; k++) {
+            states[j]->s1[k] = lanes[0][k][j];
+            states[j]->s2[k] = lanes[1][k][j];
+            states[j]->pipe[k] = lanes[2][k][j];
+        }
+    }
+#else
+    // Without vectors batching buys nothing: stream by stream, same results
+    for (int j = 0; j < BIQUAD_BATCH_STREAMS; j++) {
+        if (states[j] != NULL) biquad_process_s16(cascade, states[j], pcm[j], count);
+    }
+#endif
+}
@@ -0,0 +1,138 @@
+//
+//  Biquad.h
+//  VeepaAudioTest
+//
+//  Created for loudness measurement
+//  Purpose: Cascaded biquad filter with the sections running side by side
+//           in one SIMD register
+//
+//  A cascade is serial - section k filters the output of section k-1 - so
+//  a single sample cannot be spread across lanes. Instead the cascade runs
+//  as a wavefront: at each step lane k filters the sample lane k-1 produced
+//  one step earlier, and the input vector is the new sample shifted in
+//  front of the previous outputs. All four sections advance in one vector
+//  update per sample, at the price of a fixed BIQUAD_LATENCY samples of
+//  delay. Cascades of fewer sections fill the leading lanes with
+//  pass-through sections, so the output always comes from the last lane.
+//
+//  Batch mode turns the vector the other way: up to BIQUAD_BATCH_STREAMS
+//  streams sharing one cascade run in the lanes and the sections are
+//  stepped one after the other. The sections of one sample are then
+//  independent of each other, so the CPU overlaps them instead of waiting
+//  on one lane-to-lane chain. Batch mode keeps the wavefront's timing and
+//  arithmetic, so a stream's output and state are bit-identical in either
+//  mode and a stream can move between them from one frame to the next.
+//
+//  Sections are transposed direct form II in single precision. The NEON
+//  path and the scalar path run the same lane arithmetic in the same order.
+//
+//  Per-stream state is 48 bytes (biquad_state); the coefficients are shared
+//  by every stream that uses the same cascade.
+//
+//  Presets cover the clean-up the camera audio needs: a DC blocker, 80 and
+//  120 Hz high-passes (4th-order Butterworth) against rumble and offset,
+//  and 50/60 Hz mains hum notches at the fundamental and two harmonics
+//  (with a DC blocker in the fourth section).
+//
+
+#ifndef Biquad_h
+#define Biquad_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Sections per cascade (one per SIMD lane)
+#define BIQUAD_MAX_SECTIONS 4
+
+/// Streams per batch call (one per SIMD lane)
+#define BIQUAD_BATCH_STREAMS 4
+
+/// Delay of every cascade in samples (the wavefront depth)
+#define BIQUAD_LATENCY 3
+
+/// One section, normalised so that a0 = 1:
+/// y = b0·x + b1·x[-1] + b2·x[-2] - a1·y[-1] - a2·y[-2]
+typedef struct {
+    double b0, b1, b2, a1, a2;
+} biquad_coefficients;
+
+/// Coefficients laid out one section per lane
+typedef struct {
+    float b0[BIQUAD_MAX_SECTIONS];
+    float b1[BIQUAD_MAX_SECTIONS];
+    float b2[BIQUAD_MAX_SECTIONS];
+    float a1[BIQUAD_MAX_SECTIONS];
+    float a2[BIQUAD_MAX_SECTIONS];
+    uint32_t sections;
+} biquad_cascade;
+
+/// Per-stream filter memory (zero-initialise or biquad_state_reset)
+typedef struct {
+    float s1[BIQUAD_MAX_SECTIONS];
+    float s2[BIQUAD_MAX_SECTIONS];
+    float pipe[BIQUAD_MAX_SECTIONS];  ///< Each section's last output
+} biquad_state;
+
+/// Build a cascade from `count` sections, applied in order
+/// @return 0, or -1 if count is 0 or above BIQUAD_MAX_SECTIONS
+int biquad_cascade_init(biquad_cascade *cascade, const biquad_coefficients *sections, uint32_t count);
+
+void biquad_state_reset(biquad_state *state);
+
+#pragma mark - Design
+
+/// High-pass at `f0` Hz (RBJ cookbook; q = 0.7071 for Butterworth)
+biquad_coefficients biquad_highpass(uint32_t sample_rate, double f0, double q);
+
+/// Notch at `f0` Hz, `bandwidth` Hz wide at -3 dB
+biquad_coefficients biquad_notch(uint32_t sample_rate, double f0, double bandwidth);
+
+/// First-order DC blocker with its -3 dB corner at `corner` Hz, unity gain at Nyquist
+biquad_coefficients biquad_dc_blocker(uint32_t sample_rate, double corner);
+
+#pragma mark - Presets
+
+typedef enum {
+    BIQUAD_PRESET_NONE = 0,      ///< No filtering
+    BIQUAD_PRESET_DC_BLOCK,      ///< DC blocker, 5 Hz corner (1 section)
+    BIQUAD_PRESET_HIGHPASS_80,   ///< 4th-order Butterworth at 80 Hz (2 sections)
+    BIQUAD_PRESET_HIGHPASS_120,  ///< 4th-order Butterworth at 120 Hz (2 sections)
+    BIQUAD_PRESET_HUM_50,        ///< DC blocker + notches at 50, 100, 150 Hz (4 sections)
+    BIQUAD_PRESET_HUM_60,        ///< DC blocker + notches at 60, 120, 180 Hz (4 sections)
+    BIQUAD_PRESET_COUNT
+} biquad_preset;
+
+/// Build a preset's cascade for a sample rate
+/// @return 0, or -1 for BIQUAD_PRESET_NONE or an unknown preset
+int biquad_preset_init(biquad_cascade *cascade, biquad_preset preset, uint32_t sample_rate);
+
+/// Short display name ("off" for BIQUAD_PRESET_NONE)
+const char *biquad_preset_name(biquad_preset preset);
+
+#pragma mark - Processing
+
+/// Filter `count` samples; output[i] is the cascade's response to
+/// input[i - BIQUAD_LATENCY] (input and output may be the same buffer)
+void biquad_process(const biquad_cascade *cascade, biquad_state *state,
+                    const float *input, float *output, size_t count);
+
+/// Filter 16-bit samples in place (rounded to nearest, saturated), same timing
+void biquad_process_s16(const biquad_cascade *cascade, biquad_state *state, int16_t *pcm, size_t count);
+
+/// Filter up to BIQUAD_BATCH_STREAMS streams through one cascade in one pass;
+/// each stream's result is bit-identical to biquad_process_s16 on its own
+/// @param states Per-stream state; NULL lanes are skipped
+/// @param pcm Per-stream samples, `count` each, filtered in place
+void biquad_process_s16_batch(const biquad_cascade *cascade,
+                              biquad_state *const states[BIQUAD_BATCH_STREAMS],
+                              int16_t *const pcm[BIQUAD_BATCH_STREAMS], size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Biquad_h */
@@ -0,0 +1,156 @@
+//
+//  FilterBank.c
+//  VeepaAudioTest
+//
+//  Created for DC offset and mains hum removal
+//  Purpose: Per-session biquad presets, single-stream and batched
+//
+
+#include "FilterBank.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ROW_ALIGN 64
+
+/// One slot: whole cache lines of its own, so capture threads of different
+/// sessions never share one
+typedef struct {
+    biquad_cascade cascade;     ///< Built for built_preset at built_rate
+    biquad_state state;
+    uint32_t preset;            ///< (atomic) Requested biquad_preset
+    uint32_t built_preset;      ///< BIQUAD_PRESET_NONE until first built
+    uint32_t built_rate;
+    uint8_t  reset;             ///< (atomic) Set by filter_bank_reset_slot
+} __attribute__((aligned(ROW_ALIGN))) filter_row;
+
+_Static_assert(sizeof(filter_row) % ROW_ALIGN == 0, "rows are whole cache lines");
+
+struct filter_bank {
+    filter_row *rows;
+    uint32_t capacity;
+};
+
+#pragma mark - Lifecycle
+
+filter_bank *filter_bank_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+
+    filter_bank *bank = (filter_bank *)calloc(1, sizeof(filter_bank));
+    if (bank == NULL) return NULL;
+
+    size_t bytes = (size_t)capacity * sizeof(filter_row);
+    bank->rows = (filter_row *)aligned_alloc(ROW_ALIGN, bytes);
+    if (bank->rows == NULL) {
+        free(bank);
+        return NULL;
+    }
+    memset(bank->rows, 0, bytes);   // BIQUAD_PRESET_NONE, zero state
+
+    bank->capacity = capacity;
+    return bank;
+}
+
+void filter_bank_destroy(filter_bank *bank) {
+    if (bank == NULL) return;
+    free(bank->rows);
+    free(bank);
+}
+
+uint32_t filter_bank_capacity(const filter_bank *bank) {
+    return bank->capacity;
+}
+
+#pragma mark - Presets
+
+void filter_bank_set_preset(filter_bank *bank, uint32_t slot, biquad_preset preset) {
+    if (bank == NULL || slot >= bank->capacity || (uint32_t)preset >= BIQUAD_PRESET_COUNT) return;
+    __atomic_store_n(&bank->rows[slot].preset, (uint32_t)preset, __ATOMIC_RELAXED);
+}
+
+biquad_preset filter_bank_get_preset(const filter_bank *bank, uint32_t slot) {
+    if (bank == NULL || slot >= bank->capacity) return BIQUAD_PRESET_NONE;
+    return (biquad_preset)__atomic_load_n(&bank->rows[slot].preset, __ATOMIC_RELAXED);
+}
+
+void filter_bank_reset_slot(filter_bank *bank, uint32_t slot) {
+    if (bank == NULL || slot >= bank->capacity) return;
+    __atomic_store_n(&bank->rows[slot].reset, 1, __ATOMIC_RELEASE);
+}
+
+#pragma mark - Processing
+
+/// Bring a row up to date with its preset and the stream rate
+/// @return The row's preset, BIQUAD_PRESET_NONE if it filters nothing
+static biquad_preset prepare_row(filter_row *row, uint32_t sample_rate) {
+    if (__atomic_exchange_n(&row->reset, 0, __ATOMIC_ACQUIRE)) {
+        biquad_state_reset(&row->state);
+    }
+
+    uint32_t preset = __atomic_load_n(&row->preset, __ATOMIC_RELAXED);
+    if (preset == BIQUAD_PRESET_NONE) return BIQUAD_PRESET_NONE;
+
+    if (preset != row->built_preset || sample_rate != row->built_rate) {
+        // A new response starts from rest rather than from the old filter's memory
+        if (biquad_preset_init(&row->cascade, (biquad_preset)preset, sample_rate) != 0) {
+            return BIQUAD_PRESET_NONE;
+        }
+        biquad_state_reset(&row->state);
+        row->built_preset = preset;
+        row->built_rate = sample_rate;
+    }
+    return (biquad_preset)preset;
+}
+
+void filter_bank_process(filter_bank *bank, uint32_t slot, int16_t *pcm, size_t count, uint32_t sample_rate) {
+    if (bank == NULL || slot >= bank->capacity || pcm == NULL || count == 0 || sample_rate == 0) return;
+    filter_row *row = &bank->rows[slot];
+    if (prepare_row(row, sample_rate) == BIQUAD_PRESET_NONE) return;
+    biquad_process_s16(&row->cascade, &row->state, pcm, count);
+}
+
+size_t filter_bank_process_jobs(filter_bank *bank, const filter_bank_job *jobs, size_t job_count,
+                                size_t count, uint32_t sample_rate) {
+    if (bank == NULL || jobs == NULL || count == 0 || sample_rate == 0) return 0;
+
+    // Pending lanes per preset: a batch goes out as soon as four slots
+    // with the same preset have gathered, the remainders at the end
+    biquad_state *states[BIQUAD_PRESET_COUNT][BIQUAD_BATCH_STREAMS];
+    int16_t *pcm[BIQUAD_PRESET_COUNT][BIQUAD_BATCH_STREAMS];
+    const biquad_cascade *cascades[BIQUAD_PRESET_COUNT];
+    uint32_t pending[BIQUAD_PRESET_COUNT] = {0};
+    size_t filtered = 0;
+
+    for (size_t i = 0; i < job_count; i++) {
+        uint32_t slot = jobs[i].slot;
+        if (slot >= bank->capacity || jobs[i].pcm == NULL) continue;
+        filter_row *row = &bank->rows[slot];
+        biquad_preset preset = prepare_row(row, sample_rate);
+        if (preset == BIQUAD_PRESET_NONE) continue;
+
+        uint32_t lane = pending[preset]++;
+        states[preset][lane] = &row->state;
+        pcm[preset][lane] = jobs[i].pcm;
+        cascades[preset] = &row->cascade;   // Same preset and rate: same coefficients
+        filtered++;
+
+        if (pending[preset] == BIQUAD_BATCH_STREAMS) {
+            biquad_process_s16_batch(cascades[preset], states[preset], pcm[preset], count);
+            pending[preset] = 0;
+        }
+    }
+
+    for (int preset = 0; preset < BIQUAD_PRESET_COUNT; preset++) {
+        if (pending[preset] == 0) continue;
+        if (pending[preset] == 1) {
+            biquad_process_s16(cascades[preset], states[preset][0], pcm[preset][0], count);
+            continue;
+        }
+        for (uint32_t lane = pending[preset]; lane < BIQUAD_BATCH_STREAMS; lane++) {
+            states[preset][lane] = NULL;
+            pcm[preset][lane] = NULL;
+        }
+        biquad_process_s16_batch(cascades[preset], states[preset], pcm[preset], count);
+    }
+    return filtered;
+}
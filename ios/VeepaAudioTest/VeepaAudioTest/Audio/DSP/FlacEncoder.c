@@ -0,0 +1,620 @@
+//
+//  FlacEncoder.c
+//  VeepaAudioTest
+//
+//  Created for lossless recording
+//  Purpose: FLAC frame encoder for 16-bit mono PCM
+//
+//  Per block the encoder tries a CONSTANT subframe, the best FIXED predictor
+//  (orders 0-4, picked from residual magnitudes in one pass) and an LPC
+//  predictor (Welch-windowed autocorrelation, Levinson-Durbin, 12-bit
+//  quantized coefficients), Rice-codes the residual with the partition order
+//  that minimizes the size, and falls back to VERBATIM if nothing helps.
+//
+//  The prediction loops run over whole int32 blocks with the tap loop
+//  outside, so clang vectorizes them (NEON on device).
+//
+
+#include "FlacEncoder.h"
+
+#include <math.h>
+#include <string.h>
+
+#define FLAC_BITS_PER_SAMPLE   16
+#define FLAC_QLP_PRECISION     12
+#define FLAC_MAX_QLP_SHIFT     15
+#define FLAC_MAX_RICE_PARAM    14
+#define FLAC_MAX_PARTITION_ORDER 8
+
+enum {
+    SUBFRAME_CONSTANT,
+    SUBFRAME_VERBATIM,
+    SUBFRAME_FIXED,
+    SUBFRAME_LPC,
+};
+
+#pragma mark - Bit Writer
+
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t position;
+    uint64_t accumulator;
+    uint32_t pending;   ///< Bits in the accumulator not yet written (< 8 between calls)
+    int overflow;
+} bit_writer;
+
+static inline void bw_put(bit_writer *bw, uint32_t value, uint32_t bits) {
+    if (bits == 0) return;
+    uint64_t masked = bits == 32 ? value : (value & ((1u << bits) - 1));
+    bw->accumulator = (bw->accumulator << bits) | masked;
+    bw->pending += bits;
+
+    while (bw->pending >= 8) {
+        bw->pending -= 8;
+        if (bw->position < bw->capacity) {
+            bw->buffer[bw->position++] = (uint8_t)(bw->accumulator >> bw->pending);
+        } else {
+            bw->overflow = 1;
+        }
+    }
+}
+
+static inline void bw_put_signed(bit_writer *bw, int32_t value, uint32_t bits) {
+    bw_put(bw, (uint32_t)value, bits);
+}
+
+/// Pad with zero bits to the next byte boundary
+static void bw_align(bit_writer *bw) {
+    if (bw->pending > 0) {
+        bw_put(bw, 0, 8 - bw->pending);
+    }
+}
+
+/// Frame numbers use the UTF-8 style variable-length code
+static void bw_put_utf8(bit_writer *bw, uint32_t value) {
+    if (value < 0x80) {
+        bw_put(bw, value, 8);
+        return;
+    }
+
+    int continuation;
+    uint32_t lead;
+    if (value < 0x800)            { continuation = 1; lead = 0xC0; }
+    else if (value < 0x10000)     { continuation = 2; lead = 0xE0; }
+    else if (value < 0x200000)    { continuation = 3; lead = 0xF0; }
+    else if (value < 0x4000000)   { continuation = 4; lead = 0xF8; }
+    else                          { continuation = 5; lead = 0xFC; }
+
+    bw_put(bw, lead | (value >> (6 * continuation)), 8);
+    for (int i = continuation - 1; i >= 0; i--) {
+        bw_put(bw, 0x80 | ((value >> (6 * i)) & 0x3F), 8);
+    }
+}
+
+/// Zigzag-mapped residual Rice code
+static inline void bw_put_rice(bit_writer *bw, int32_t residual, uint32_t parameter) {
+    uint32_t folded = ((uint32_t)residual << 1) ^ (uint32_t)(residual >> 31);
+    uint32_t quotient = folded >> parameter;
+
+    while (quotient >= 32) {
+        bw_put(bw, 0, 32);
+        quotient -= 32;
+    }
+    bw_put(bw, 1, quotient + 1);
+    bw_put(bw, folded, parameter);
+}
+
+#pragma mark - CRC
+
+static uint8_t crc8(const uint8_t *data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t length) {
+    static uint16_t table[256];
+    static int ready = 0;
+    if (!ready) {
+        // Idempotent, so a race between encoder threads only repeats work
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t crc = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+            }
+            table[i] = crc;
+        }
+        ready = 1;
+    }
+
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 8) ^ table[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+#pragma mark - Rice Partitioning
+
+typedef struct {
+    uint32_t partition_order;
+    uint8_t parameters[1 << FLAC_MAX_PARTITION_ORDER];
+} rice_plan;
+
+/// Best parameter and its cost for `count` residuals whose folded values sum to `sum`.
+/// Cost is an upper bound of the exact size: sum(u >> k) <= sum >> k.
+static uint64_t rice_best_parameter(uint64_t sum, uint32_t count, uint8_t *parameter) {
+    uint32_t estimate = 0;
+    if (count > 0 && sum > count) {
+        uint64_t mean = sum / count;
+        while (estimate < FLAC_MAX_RICE_PARAM && (mean >> (estimate + 1)) > 0) estimate++;
+    }
+
+    uint32_t low = estimate > 0 ? estimate - 1 : 0;
+    uint32_t high = estimate < FLAC_MAX_RICE_PARAM ? estimate + 1 : FLAC_MAX_RICE_PARAM;
+    uint64_t bestBits = UINT64_MAX;
+    for (uint32_t k = low; k <= high; k++) {
+        uint64_t bits = (uint64_t)count * (k + 1) + (sum >> k);
+        if (bits < bestBits) {
+            bestBits = bits;
+            *parameter = (uint8_t)k;
+        }
+    }
+    return bestBits;
+}
+
+/// Choose partition order and per-partition parameters
+/// @param residual Residuals of samples [order, block_size)
+/// @return Bits of the residual section, including its headers
+static uint64_t rice_plan_residual(const int32_t *residual, uint32_t block_size, uint32_t order, rice_plan *plan) {
+    uint32_t maxOrder = 0;
+    while (maxOrder < FLAC_MAX_PARTITION_ORDER &&
+           (block_size % (1u << (maxOrder + 1))) == 0 &&
+           (block_size >> (maxOrder + 1)) > order) {
+        maxOrder++;
+    }
+
+    // Folded sums of the finest partitions, merged pairwise for coarser orders
+    uint64_t sums[1 << FLAC_MAX_PARTITION_ORDER];
+    uint32_t partitions = 1u << maxOrder;
+    uint32_t partitionSize = block_size >> maxOrder;
+    const int32_t *cursor = residual;
+    for (uint32_t p = 0; p < partitions; p++) {
+        uint32_t count = p == 0 ? partitionSize - order : partitionSize;
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t r = cursor[i];
+            sum += ((uint32_t)r << 1) ^ (uint32_t)(r >> 31);
+        }
+        sums[p] = sum;
+        cursor += count;
+    }
+
+    uint64_t bestBits = UINT64_MAX;
+    for (int32_t porder = (int32_t)maxOrder; porder >= 0; porder--) {
+        uint32_t count = 1u << porder;
+        uint32_t size = block_size >> porder;
+        uint8_t parameters[1 << FLAC_MAX_PARTITION_ORDER];
+        uint64_t bits = 2 + 4;  // coding method + partition order
+
+        for (uint32_t p = 0; p < count; p++) {
+            bits += 4 + rice_best_parameter(sums[p], p == 0 ? size - order : size, &parameters[p]);
+        }
+        if (bits < bestBits) {
+            bestBits = bits;
+            plan->partition_order = (uint32_t)porder;
+            memcpy(plan->parameters, parameters, count);
+        }
+
+        // Merge neighbours for the next coarser order
+        for (uint32_t p = 0; p < count / 2; p++) {
+            sums[p] = sums[2 * p] + sums[2 * p + 1];
+        }
+    }
+    return bestBits;
+}
+
+static void write_residual(bit_writer *bw, const int32_t *residual, uint32_t block_size, uint32_t order, const rice_plan *plan) {
+    bw_put(bw, 0, 2);                       // Rice, 4-bit parameters
+    bw_put(bw, plan->partition_order, 4);
+
+    uint32_t partitions = 1u << plan->partition_order;
+    uint32_t size = block_size >> plan->partition_order;
+    for (uint32_t p = 0; p < partitions; p++) {
+        uint32_t count = p == 0 ? size - order : size;
+        uint32_t parameter = plan->parameters[p];
+        bw_put(bw, parameter, 4);
+        for (uint32_t i = 0; i < count; i++) {
+            bw_put_rice(bw, residual[i], parameter);
+        }
+        residual += count;
+    }
+}
+
+#pragma mark - Fixed Prediction
+
+/// Pick the fixed order with the smallest residual magnitude (one pass over the block)
+static uint32_t fixed_best_order(const int32_t *x, uint32_t n) {
+    uint64_t total[5] = { 0, 0, 0, 0, 0 };
+    for (uint32_t i = 4; i < n; i++) {
+        int32_t e0 = x[i];
+        int32_t e1 = x[i] - x[i - 1];
+        int32_t e2 = e1 - (x[i - 1] - x[i - 2]);
+        int32_t e3 = e2 - (x[i - 1] - 2 * x[i - 2] + x[i - 3]);
+        int32_t e4 = e3 - (x[i - 1] - 3 * x[i - 2] + 3 * x[i - 3] - x[i - 4]);
+        total[0] += (uint32_t)(e0 < 0 ? -e0 : e0);
+        total[1] += (uint32_t)(e1 < 0 ? -e1 : e1);
+        total[2] += (uint32_t)(e2 < 0 ? -e2 : e2);
+        total[3] += (uint32_t)(e3 < 0 ? -e3 : e3);
+        total[4] += (uint32_t)(e4 < 0 ? -e4 : e4);
+    }
+
+    uint32_t best = 0;
+    for (uint32_t order = 1; order <= 4; order++) {
+        if (total[order] < total[best]) best = order;
+    }
+    return best;
+}
+
+static void fixed_residual(const int32_t *x, uint32_t n, uint32_t order, int32_t *residual) {
+    switch (order) {
+    case 0:
+        for (uint32_t i = 0; i < n; i++) residual[i] = x[i];
+        break;
+    case 1:
+        for (uint32_t i = 1; i < n; i++) residual[i - 1] = x[i] - x[i - 1];
+        break;
+    case 2:
+        for (uint32_t i = 2; i < n; i++) residual[i - 2] = x[i] - 2 * x[i - 1] + x[i - 2];
+        break;
+    case 3:
+        for (uint32_t i = 3; i < n; i++) residual[i - 3] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+        break;
+    default:
+        for (uint32_t i = 4; i < n; i++) residual[i - 4] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+        break;
+    }
+}
+
+#pragma mark - LPC
+
+static void autocorrelation(const int32_t *x, uint32_t n, uint32_t max_lag, double *autoc) {
+    float windowed[FLAC_MAX_BLOCK_SIZE];
+
+    // Welch window
+    const float half = (float)(n - 1) / 2.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        float t = ((float)i - half) / (half + 1.0f);
+        windowed[i] = (float)x[i] * (1.0f - t * t);
+    }
+
+    for (uint32_t lag = 0; lag <= max_lag; lag++) {
+        double sum = 0;
+        for (uint32_t i = lag; i < n; i++) {
+            sum += (double)(windowed[i] * windowed[i - lag]);
+        }
+        autoc[lag] = sum;
+    }
+}
+
+/// Levinson-Durbin recursion; lp[o - 1] holds the predictor of order o
+/// @return Highest order computed
+static uint32_t levinson_durbin(const double *autoc, uint32_t max_order,
+                                double lp[FLAC_MAX_LPC_ORDER][FLAC_MAX_LPC_ORDER], double *error) {
+    double lpc[FLAC_MAX_LPC_ORDER];
+    double err = autoc[0];
+
+    for (uint32_t i = 0; i < max_order; i++) {
+        double r = -autoc[i + 1];
+        for (uint32_t j = 0; j < i; j++) r -= lpc[j] * autoc[i - j];
+        r /= err;
+
+        lpc[i] = r;
+        uint32_t j;
+        for (j = 0; j < (i >> 1); j++) {
+            double tmp = lpc[j];
+            lpc[j] += r * lpc[i - 1 - j];
+            lpc[i - 1 - j] += r * tmp;
+        }
+        if (i & 1) lpc[j] += lpc[j] * r;
+
+        err *= (1.0 - r * r);
+        for (j = 0; j <= i; j++) lp[i][j] = -lpc[j];
+        error[i] = err;
+
+        if (err <= 0.0) return i + 1;
+    }
+    return max_order;
+}
+
+/// Quantize with error feedback
+/// @return 0 on success, -1 if the predictor cannot be represented
+static int quantize_coefficients(const double *lp, uint32_t order, int32_t *qlp, int *shift) {
+    const int32_t qmax = (1 << (FLAC_QLP_PRECISION - 1)) - 1;
+    const int32_t qmin = -(1 << (FLAC_QLP_PRECISION - 1));
+
+    double cmax = 0;
+    for (uint32_t i = 0; i < order; i++) {
+        double magnitude = fabs(lp[i]);
+        if (magnitude > cmax) cmax = magnitude;
+    }
+    if (!(cmax > 0) || !isfinite(cmax)) return -1;
+
+    int log2cmax;
+    frexp(cmax, &log2cmax);
+    log2cmax--;
+    int s = (FLAC_QLP_PRECISION - 1) - log2cmax - 1;
+    if (s > FLAC_MAX_QLP_SHIFT) s = FLAC_MAX_QLP_SHIFT;
+    if (s < 0) return -1;
+
+    double carry = 0;
+    for (uint32_t i = 0; i < order; i++) {
+        carry += lp[i] * (double)(1 << s);
+        long q = lround(carry);
+        if (q > qmax) q = qmax;
+        if (q < qmin) q = qmin;
+        carry -= (double)q;
+        qlp[i] = (int32_t)q;
+    }
+    *shift = s;
+    return 0;
+}
+
+/// 16-bit samples, 12-bit coefficients and order <= 8 keep the sum within int32
+static void lpc_residual(const int32_t *x, uint32_t n, const int32_t *qlp, uint32_t order, int shift,
+                         int32_t *prediction, int32_t *residual) {
+    for (uint32_t i = order; i < n; i++) prediction[i] = 0;
+    for (uint32_t j = 0; j < order; j++) {
+        const int32_t coefficient = qlp[j];
+        const int32_t *history = x - j - 1;
+        for (uint32_t i = order; i < n; i++) {
+            prediction[i] += coefficient * history[i];
+        }
+    }
+    for (uint32_t i = order; i < n; i++) {
+        residual[i - order] = x[i] - (prediction[i] >> shift);
+    }
+}
+
+#pragma mark - Subframe
+
+typedef struct {
+    int type;
+    uint32_t order;
+    int32_t qlp[FLAC_MAX_LPC_ORDER];
+    int shift;
+    rice_plan rice;
+    uint64_t bits;
+} subframe_plan;
+
+static void write_subframe(bit_writer *bw, const int32_t *x, uint32_t n, const subframe_plan *plan, const int32_t *residual) {
+    bw_put(bw, 0, 1);  // zero padding bit
+
+    switch (plan->type) {
+    case SUBFRAME_CONSTANT:
+        bw_put(bw, 0x00, 6);
+        bw_put(bw, 0, 1);  // no wasted bits
+        bw_put_signed(bw, x[0], FLAC_BITS_PER_SAMPLE);
+        return;
+
+    case SUBFRAME_VERBATIM:
+        bw_put(bw, 0x01, 6);
+        bw_put(bw, 0, 1);
+        for (uint32_t i = 0; i < n; i++) bw_put_signed(bw, x[i], FLAC_BITS_PER_SAMPLE);
+        return;
+
+    case SUBFRAME_FIXED:
+        bw_put(bw, 0x08 | plan->order, 6);
+        bw_put(bw, 0, 1);
+        for (uint32_t i = 0; i < plan->order; i++) bw_put_signed(bw, x[i], FLAC_BITS_PER_SAMPLE);
+        write_residual(bw, residual, n, plan->order, &plan->rice);
+        return;
+
+    case SUBFRAME_LPC:
+        bw_put(bw, 0x20 | (plan->order - 1), 6);
+        bw_put(bw, 0, 1);
+        for (uint32_t i = 0; i < plan->order; i++) bw_put_signed(bw, x[i], FLAC_BITS_PER_SAMPLE);
+        bw_put(bw, FLAC_QLP_PRECISION - 1, 4);
+        bw_put_signed(bw, plan->shift, 5);
+        for (uint32_t i = 0; i < plan->order; i++) bw_put_signed(bw, plan->qlp[i], FLAC_QLP_PRECISION);
+        write_residual(bw, residual, n, plan->order, &plan->rice);
+        return;
+    }
+}
+
+/// Choose the cheapest subframe; the winning residual is left in *best
+static void plan_subframe(const flac_encoder_config *config, const int32_t *x, uint32_t n,
+                          subframe_plan *plan, int32_t **best, int32_t **scratch, int32_t *prediction) {
+    // Constant block (digital silence is the common case for camera audio)
+    uint32_t i = 1;
+    while (i < n && x[i] == x[0]) i++;
+    if (i == n) {
+        plan->type = SUBFRAME_CONSTANT;
+        plan->bits = FLAC_BITS_PER_SAMPLE;
+        return;
+    }
+
+    plan->type = SUBFRAME_VERBATIM;
+    plan->bits = (uint64_t)n * FLAC_BITS_PER_SAMPLE;
+    if (n <= FLAC_MAX_LPC_ORDER) return;
+
+    // Fixed predictor
+    uint32_t fixedOrder = fixed_best_order(x, n);
+    fixed_residual(x, n, fixedOrder, *scratch);
+    rice_plan rice;
+    uint64_t bits = fixedOrder * FLAC_BITS_PER_SAMPLE + rice_plan_residual(*scratch, n, fixedOrder, &rice);
+    if (bits < plan->bits) {
+        plan->type = SUBFRAME_FIXED;
+        plan->order = fixedOrder;
+        plan->rice = rice;
+        plan->bits = bits;
+        int32_t *swap = *best; *best = *scratch; *scratch = swap;
+    }
+
+    // LPC predictor: order chosen from the Levinson-Durbin error estimate
+    uint32_t maxOrder = config->max_lpc_order;
+    if (maxOrder == 0) return;
+
+    double autoc[FLAC_MAX_LPC_ORDER + 1];
+    autocorrelation(x, n, maxOrder, autoc);
+    if (!(autoc[0] > 0)) return;
+
+    double lp[FLAC_MAX_LPC_ORDER][FLAC_MAX_LPC_ORDER];
+    double error[FLAC_MAX_LPC_ORDER];
+    uint32_t orders = levinson_durbin(autoc, maxOrder, lp, error);
+
+    uint32_t lpcOrder = 0;
+    double bestEstimate = INFINITY;
+    for (uint32_t order = 1; order <= orders; order++) {
+        double perSample = error[order - 1] > 0 ? 0.5 * log2(0.5 * error[order - 1] / (double)n) : 0;
+        if (perSample < 0) perSample = 0;
+        double estimate = perSample * (double)(n - order) + order * (FLAC_BITS_PER_SAMPLE + FLAC_QLP_PRECISION);
+        if (estimate < bestEstimate) {
+            bestEstimate = estimate;
+            lpcOrder = order;
+        }
+    }
+
+    int32_t qlp[FLAC_MAX_LPC_ORDER];
+    int shift;
+    if (lpcOrder == 0 || quantize_coefficients(lp[lpcOrder - 1], lpcOrder, qlp, &shift) != 0) return;
+
+    lpc_residual(x, n, qlp, lpcOrder, shift, prediction, *scratch);
+    bits = lpcOrder * (FLAC_BITS_PER_SAMPLE + FLAC_QLP_PRECISION) + 4 + 5 +
+           rice_plan_residual(*scratch, n, lpcOrder, &rice);
+    if (bits < plan->bits) {
+        plan->type = SUBFRAME_LPC;
+        plan->order = lpcOrder;
+        plan->shift = shift;
+        memcpy(plan->qlp, qlp, sizeof(qlp));
+        plan->rice = rice;
+        plan->bits = bits;
+        int32_t *swap = *best; *best = *scratch; *scratch = swap;
+    }
+}
+
+#pragma mark - Frame
+
+static uint32_t block_size_code(uint32_t n) {
+    switch (n) {
+    case 192: return 1;
+    case 576: return 2;
+    case 1152: return 3;
+    case 2304: return 4;
+    case 4608: return 5;
+    case 256: return 8;
+    case 512: return 9;
+    case 1024: return 10;
+    case 2048: return 11;
+    case 4096: return 12;
+    default: return n <= 256 ? 6 : 7;
+    }
+}
+
+static uint32_t sample_rate_code(uint32_t rate) {
+    switch (rate) {
+    case 8000: return 4;
+    case 16000: return 5;
+    case 22050: return 6;
+    case 24000: return 7;
+    case 32000: return 8;
+    case 44100: return 9;
+    case 48000: return 10;
+    case 96000: return 11;
+    default:
+        if (rate % 1000 == 0 && rate / 1000 < 256) return 12;
+        if (rate < 65536) return 13;
+        if (rate % 10 == 0 && rate / 10 < 65536) return 14;
+        return 0;  // from STREAMINFO
+    }
+}
+
+void flac_encoder_config_init(flac_encoder_config *config, uint32_t sample_rate) {
+    config->sample_rate = sample_rate;
+    config->block_size = FLAC_DEFAULT_BLOCK_SIZE;
+    config->max_lpc_order = FLAC_MAX_LPC_ORDER;
+}
+
+size_t flac_frame_capacity(uint32_t block_size) {
+    // Header <= 16 bytes, verbatim subframe, CRC-16
+    return 16 + 1 + (size_t)block_size * (FLAC_BITS_PER_SAMPLE / 8) + 2;
+}
+
+size_t flac_encode_frame(const flac_encoder_config *config, const int16_t *pcm, uint32_t count,
+                         uint32_t frame_number, uint8_t *out, size_t capacity) {
+    if (count == 0 || count > FLAC_MAX_BLOCK_SIZE) return 0;
+
+    int32_t samples[FLAC_MAX_BLOCK_SIZE];
+    int32_t residualA[FLAC_MAX_BLOCK_SIZE];
+    int32_t residualB[FLAC_MAX_BLOCK_SIZE];
+    int32_t prediction[FLAC_MAX_BLOCK_SIZE];
+    for (uint32_t i = 0; i < count; i++) samples[i] = pcm[i];
+
+    subframe_plan plan;
+    memset(&plan, 0, sizeof(plan));
+    int32_t *best = residualA;
+    int32_t *scratch = residualB;
+    flac_encoder_config limited = *config;
+    if (limited.max_lpc_order > FLAC_MAX_LPC_ORDER) limited.max_lpc_order = FLAC_MAX_LPC_ORDER;
+    plan_subframe(&limited, samples, count, &plan, &best, &scratch, prediction);
+
+    bit_writer bw = { out, capacity, 0, 0, 0, 0 };
+
+    // Frame header
+    uint32_t bsCode = block_size_code(count);
+    uint32_t srCode = sample_rate_code(config->sample_rate);
+    bw_put(&bw, 0x3FFE, 14);  // sync
+    bw_put(&bw, 0, 1);        // reserved
+    bw_put(&bw, 0, 1);        // fixed block size
+    bw_put(&bw, bsCode, 4);
+    bw_put(&bw, srCode, 4);
+    bw_put(&bw, 0, 4);        // mono
+    bw_put(&bw, 4, 3);        // 16 bits per sample
+    bw_put(&bw, 0, 1);        // reserved
+    bw_put_utf8(&bw, frame_number);
+    if (bsCode == 6) bw_put(&bw, count - 1, 8);
+    if (bsCode == 7) bw_put(&bw, count - 1, 16);
+    if (srCode == 12) bw_put(&bw, config->sample_rate / 1000, 8);
+    if (srCode == 13) bw_put(&bw, config->sample_rate, 16);
+    if (srCode == 14) bw_put(&bw, config->sample_rate / 10, 16);
+    if (bw.overflow) return 0;
+    bw_put(&bw, crc8(out, bw.position), 8);
+
+    write_subframe(&bw, samples, count, &plan, best);
+    bw_align(&bw);
+    if (bw.overflow) return 0;
+
+    bw_put(&bw, crc16(out, bw.position), 16);
+    return bw.overflow ? 0 : bw.position;
+}
+
+void flac_write_stream_header(const flac_encoder_config *config, uint64_t total_samples,
+                              uint32_t min_frame_bytes, uint32_t max_frame_bytes,
+                              uint8_t out[FLAC_STREAM_HEADER_SIZE]) {
+    bit_writer bw = { out, FLAC_STREAM_HEADER_SIZE, 0, 0, 0, 0 };
+
+    bw_put(&bw, 0x664C6143, 32);  // "fLaC"
+
+    bw_put(&bw, 1, 1);            // last metadata block
+    bw_put(&bw, 0, 7);            // STREAMINFO
+    bw_put(&bw, 34, 24);
+
+    bw_put(&bw, config->block_size, 16);
+    bw_put(&bw, config->block_size, 16);
+    bw_put(&bw, min_frame_bytes, 24);
+    bw_put(&bw, max_frame_bytes, 24);
+    bw_put(&bw, config->sample_rate, 20);
+    bw_put(&bw, 0, 3);            // channels - 1
+    bw_put(&bw, FLAC_BITS_PER_SAMPLE - 1, 5);
+    bw_put(&bw, (uint32_t)(total_samples >> 32) & 0x0F, 4);
+    bw_put(&bw, (uint32_t)total_samples, 32);
+    for (int i = 0; i < 4; i++) {
+        bw_put(&bw, 0, 32);       // MD5 unknown
+    }
+}
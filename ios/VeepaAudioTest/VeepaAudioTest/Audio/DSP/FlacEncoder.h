@@ -0,0 +1,63 @@
+//
+//  FlacEncoder.h
+//  VeepaAudioTest
+//
+//  Created for lossless recording
+//  Purpose: Lossless compression of decoded 16-bit mono PCM as a standard
+//           FLAC stream (fixed + LPC prediction, partitioned Rice residuals)
+//
+//  Every FLAC frame is self-contained (its frame number is in the header),
+//  so callers can encode blocks on as many threads as they like and
+//  concatenate the frames in order behind the stream header. Output plays in
+//  any FLAC decoder (ffmpeg, VLC, afplay).
+//
+
+#ifndef FlacEncoder_h
+#define FlacEncoder_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLAC_DEFAULT_BLOCK_SIZE  4096
+#define FLAC_MAX_BLOCK_SIZE      4608
+#define FLAC_MAX_LPC_ORDER       8
+
+/// "fLaC" marker + STREAMINFO metadata block
+#define FLAC_STREAM_HEADER_SIZE  42
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t block_size;     ///< Samples per frame (all frames but the last); <= FLAC_MAX_BLOCK_SIZE
+    uint32_t max_lpc_order;  ///< 0 = fixed predictors only; <= FLAC_MAX_LPC_ORDER
+} flac_encoder_config;
+
+/// Defaults: 4096-sample blocks, LPC up to order 8
+void flac_encoder_config_init(flac_encoder_config *config, uint32_t sample_rate);
+
+/// Worst-case size of one encoded frame (verbatim fallback + headers)
+size_t flac_frame_capacity(uint32_t block_size);
+
+/// Encode one block as a complete FLAC frame
+/// @param pcm Samples of this block
+/// @param count Samples in the block (config->block_size except for the final block)
+/// @param frame_number Index of the block in the stream
+/// @param out Output buffer of at least flac_frame_capacity(count) bytes
+/// @return Bytes written, or 0 if count is 0 or larger than FLAC_MAX_BLOCK_SIZE
+size_t flac_encode_frame(const flac_encoder_config *config, const int16_t *pcm, uint32_t count,
+                         uint32_t frame_number, uint8_t *out, size_t capacity);
+
+/// Write the stream header. Pass 0 for unknown totals/frame sizes when
+/// streaming and rewrite the header once the stream is complete.
+void flac_write_stream_header(const flac_encoder_config *config, uint64_t total_samples,
+                              uint32_t min_frame_bytes, uint32_t max_frame_bytes,
+                              uint8_t out[FLAC_STREAM_HEADER_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FlacEncoder_h */
@@ -0,0 +1,235 @@
+//
+//  G711.c
+//  VeepaAudioTest
+//
+//  Created for batch archive transcoding
+//  Purpose: G.711 A-law decode/encode kernels
+//
+
+#include "G711.h"
+
+#include <math.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#pragma mark - Lookup Table
+
+/// G.711 A-law to 16-bit linear PCM lookup table
+/// A-law is used in European telephony and many IP cameras
+const int16_t g711_alaw_to_linear[256] = {
+    -5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
+    -7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
+    -2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
+    -3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
+    -22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+    -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+    -11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
+    -15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+    -344, -328, -376, -360, -280, -264, -312, -296,
+    -472, -456, -504, -488, -408, -392, -440, -424,
+    -88, -72, -120, -104, -24, -8, -56, -40,
+    -216, -200, -248, -232, -152, -136, -184, -168,
+    -1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
+    -1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
+    -688, -656, -752, -720, -560, -528, -624, -592,
+    -944, -912, -1008, -976, -816, -784, -880, -848,
+    5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
+    7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
+    2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
+    3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
+    22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
+    30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
+    11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
+    15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
+    344, 328, 376, 360, 280, 264, 312, 296,
+    472, 456, 504, 488, 408, 392, 440, 424,
+    88, 72, 120, 104, 24, 8, 56, 40,
+    216, 200, 248, 232, 152, 136, 184, 168,
+    1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
+    1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
+    688, 656, 752, 720, 560, 528, 624, 592,
+    944, 912, 1008, 976, 816, 784, 880, 848
+};
+
+#pragma mark - Decode
+
+#if defined(__ARM_NEON)
+
+/// Expand 8 A-law codes (already XORed with 0x55, widened to 16 bit).
+///
+/// Same arithmetic the table was generated from:
+///   t = mantissa << 4; segment 0: t += 8; otherwise t += 0x108, t <<= segment - 1
+///   bit 7 set → positive, clear → negative
+static inline int16x8_t alaw_expand8(uint16x8_t a) {
+    const uint16x8_t zero = vdupq_n_u16(0);
+
+    int16x8_t t = vreinterpretq_s16_u16(vshlq_n_u16(vandq_u16(a, vdupq_n_u16(0x0F)), 4));
+    uint16x8_t segment = vandq_u16(vshrq_n_u16(a, 4), vdupq_n_u16(0x07));
+
+    uint16x8_t isSegmentZero = vceqq_u16(segment, zero);
+    t = vaddq_s16(t, vbslq_s16(isSegmentZero, vdupq_n_s16(8), vdupq_n_s16(0x108)));
+
+    // Saturating segment - 1 gives a shift of 0 for segments 0 and 1
+    int16x8_t shift = vreinterpretq_s16_u16(vqsubq_u16(segment, vdupq_n_u16(1)));
+    t = vshlq_s16(t, shift);
+
+    uint16x8_t isNegative = vceqq_u16(vandq_u16(a, vdupq_n_u16(0x80)), zero);
+    return vbslq_s16(isNegative, vnegq_s16(t), t);
+}
+
+#endif
+
+void g711_alaw_decode(const uint8_t *alaw, int16_t *pcm, size_t count) {
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    const uint8x16_t evenBits = vdupq_n_u8(0x55);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t codes = veorq_u8(vld1q_u8(alaw + i), evenBits);
+        vst1q_s16(pcm + i, alaw_expand8(vmovl_u8(vget_low_u8(codes))));
+        vst1q_s16(pcm + i + 8, alaw_expand8(vmovl_u8(vget_high_u8(codes))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        pcm[i] = g711_alaw_to_linear[alaw[i]];
+    }
+}
+
+void g711_alaw_decode_jobs(const g711_decode_job *jobs, size_t count) {
+#if defined(__ARM_NEON)
+    const uint8x16_t evenBits = vdupq_n_u8(0x55);
+#endif
+
+    for (size_t j = 0; j < count; j++) {
+        const uint8_t *alaw = jobs[j].alaw;
+        int16_t *pcm = jobs[j].pcm;
+        size_t n = jobs[j].count;
+        if (j + 1 < count) {
+            __builtin_prefetch(jobs[j + 1].alaw);
+            __builtin_prefetch(jobs[j + 1].pcm, 1);
+        }
+
+        size_t i = 0;
+#if defined(__ARM_NEON)
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t codes = veorq_u8(vld1q_u8(alaw + i), evenBits);
+            vst1q_s16(pcm + i, alaw_expand8(vmovl_u8(vget_low_u8(codes))));
+            vst1q_s16(pcm + i + 8, alaw_expand8(vmovl_u8(vget_high_u8(codes))));
+        }
+#endif
+        for (; i < n; i++) {
+            pcm[i] = g711_alaw_to_linear[alaw[i]];
+        }
+    }
+}
+
+#pragma mark - Level Estimate
+
+/// Squared magnitude of each 7-bit magnitude code (built on first use)
+static uint32_t alaw_squares[128];
+static int alaw_squares_ready;
+
+static void alaw_squares_init(void) {
+    if (__atomic_load_n(&alaw_squares_ready, __ATOMIC_ACQUIRE)) return;
+    for (unsigned code = 0; code < 128; code++) {
+        // Positive half of the table: sign bit set before the even-bit XOR
+        int32_t magnitude = g711_alaw_to_linear[(code | 0x80) ^ 0x55];
+        alaw_squares[code] = (uint32_t)(magnitude * magnitude);
+    }
+    __atomic_store_n(&alaw_squares_ready, 1, __ATOMIC_RELEASE);
+}
+
+void g711_alaw_measure(const uint8_t *alaw, size_t count, g711_alaw_level *level) {
+    alaw_squares_init();
+
+    size_t i = 0;
+    uint8_t peak = level->peak_code;
+    uint64_t sum0 = 0, sum1 = 0;
+
+#if defined(__ARM_NEON)
+    const uint8x16_t evenBits = vdupq_n_u8(0x55);
+    const uint8x16_t magnitudeBits = vdupq_n_u8(0x7F);
+    uint8x16_t peaks = vdupq_n_u8(0);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t codes = vandq_u8(veorq_u8(vld1q_u8(alaw + i), evenBits), magnitudeBits);
+        peaks = vmaxq_u8(peaks, codes);
+
+        uint8_t lanes[16];
+        vst1q_u8(lanes, codes);
+        for (int k = 0; k < 16; k += 2) {
+            sum0 += alaw_squares[lanes[k]];
+            sum1 += alaw_squares[lanes[k + 1]];
+        }
+    }
+    uint8_t vectorPeak = vmaxvq_u8(peaks);
+    if (vectorPeak > peak) peak = vectorPeak;
+#endif
+
+    // Two accumulators keep the lookups independent
+    for (; i + 2 <= count; i += 2) {
+        uint8_t a = (alaw[i] ^ 0x55) & 0x7F;
+        uint8_t b = (alaw[i + 1] ^ 0x55) & 0x7F;
+        if (a > peak) peak = a;
+        if (b > peak) peak = b;
+        sum0 += alaw_squares[a];
+        sum1 += alaw_squares[b];
+    }
+    if (i < count) {
+        uint8_t a = (alaw[i] ^ 0x55) & 0x7F;
+        if (a > peak) peak = a;
+        sum0 += alaw_squares[a];
+    }
+
+    level->peak_code = peak;
+    level->sum_squares += sum0 + sum1;
+    level->samples += (uint32_t)count;
+}
+
+double g711_alaw_level_rms_dbfs(const g711_alaw_level *level) {
+    if (level->samples == 0) return -INFINITY;
+    double rms = sqrt((double)level->sum_squares / level->samples);
+    return 20.0 * log10(rms / 32768.0);
+}
+
+double g711_alaw_level_peak_dbfs(const g711_alaw_level *level) {
+    if (level->samples == 0) return -INFINITY;
+    double peak = g711_alaw_to_linear[(level->peak_code | 0x80) ^ 0x55];
+    return 20.0 * log10(peak / 32768.0);
+}
+
+#pragma mark - Encode
+
+/// Segment end points of the 13-bit magnitude
+static const int16_t alaw_segment_ends[8] = { 0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF };
+
+uint8_t g711_alaw_encode_sample(int16_t pcm) {
+    int magnitude = pcm >> 3;
+    int mask;
+    if (magnitude >= 0) {
+        mask = 0xD5;  // Sign bit set + even-bit inversion
+    } else {
+        mask = 0x55;
+        magnitude = -magnitude - 1;
+    }
+
+    int segment = 0;
+    while (segment < 8 && magnitude > alaw_segment_ends[segment]) {
+        segment++;
+    }
+    if (segment >= 8) {
+        return (uint8_t)(0x7F ^ mask);  // Clip to the largest code
+    }
+
+    int code = segment << 4;
+    code |= segment < 2 ? (magnitude >> 1) & 0x0F : (magnitude >> segment) & 0x0F;
+    return (uint8_t)(code ^ mask);
+}
+
+void g711_alaw_encode(const int16_t *pcm, uint8_t *alaw, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        alaw[i] = g711_alaw_encode_sample(pcm[i]);
+    }
+}
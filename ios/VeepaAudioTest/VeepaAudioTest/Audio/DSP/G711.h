@@ -0,0 +1,76 @@
+//
+//  G711.h
+//  VeepaAudioTest
+//
+//  Created for batch archive transcoding
+//  Purpose: G.711 A-law kernels shared by the live pipeline (AudioHookBridge)
+//           and the offline archive tool
+//
+//  Decoding has a NEON path (16 samples per iteration, arithmetic expansion
+//  instead of a table gather) and a scalar lookup-table path for other CPUs
+//  and for the tail of each block. Both produce identical results.
+//
+//  g711_alaw_measure takes levels straight from the A-law bytes: the low
+//  seven bits (after the even-bit XOR) are a magnitude code, so energy is
+//  a lookup of the squared magnitude per byte with no PCM written. Used for
+//  streams that are tracked but not decoded.
+//
+
+#ifndef G711_h
+#define G711_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// G.711 A-law to 16-bit linear PCM lookup table (ITU-T G.711)
+extern const int16_t g711_alaw_to_linear[256];
+
+/// Decode G.711 A-law bytes to 16-bit PCM
+/// @param alaw Input A-law encoded bytes
+/// @param pcm Output 16-bit PCM samples (may not alias alaw)
+/// @param count Number of samples to decode
+void g711_alaw_decode(const uint8_t *alaw, int16_t *pcm, size_t count);
+
+/// Level estimate accumulated from A-law bytes without decoding
+/// (zero-initialize, then call g711_alaw_measure per frame)
+typedef struct {
+    uint32_t samples;
+    uint8_t  peak_code;          ///< Largest magnitude code (0-127, monotonic in |x|)
+    uint64_t sum_squares;        ///< Sum of squared decoded magnitudes
+} g711_alaw_level;
+
+/// Add `count` A-law bytes to a level estimate
+void g711_alaw_measure(const uint8_t *alaw, size_t count, g711_alaw_level *level);
+
+/// RMS level in dBFS of the measured samples (-inf for no samples)
+double g711_alaw_level_rms_dbfs(const g711_alaw_level *level);
+
+/// Exact peak level in dBFS of the measured samples
+double g711_alaw_level_peak_dbfs(const g711_alaw_level *level);
+
+/// One frame of a batched decode
+typedef struct {
+    const uint8_t *alaw;
+    int16_t *pcm;
+    size_t count;
+} g711_decode_job;
+
+/// Decode a gathered list of frames in one pass (prefetching the next
+/// job's input while the current one decodes)
+void g711_alaw_decode_jobs(const g711_decode_job *jobs, size_t count);
+
+/// Encode one 16-bit PCM sample to G.711 A-law
+uint8_t g711_alaw_encode_sample(int16_t pcm);
+
+/// Encode 16-bit PCM samples to G.711 A-law
+void g711_alaw_encode(const int16_t *pcm, uint8_t *alaw, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* G711_h */
@@ -0,0 +1,123 @@
+//
+//  ImaAdpcm.c
+//  VeepaAudioTest
+//
+//  Created for congestion-aware bitrate adaptation
+//  Purpose: IMA ADPCM decode/encode kernels
+//
+
+#include "ImaAdpcm.h"
+
+#include "G711.h"
+
+#pragma mark - Tables
+
+static const int16_t ima_step_table[IMA_ADPCM_MAX_STEP_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+#pragma mark - Decode
+
+/// Apply one 4-bit code to the predictor and step index
+static inline int16_t decode_nibble(uint8_t code, int *predictor, int *index) {
+    int step = ima_step_table[*index];
+    int diff = step >> 3;
+    if (code & 1) diff += step >> 2;
+    if (code & 2) diff += step >> 1;
+    if (code & 4) diff += step;
+
+    int value = (code & 8) ? *predictor - diff : *predictor + diff;
+    if (value > INT16_MAX) value = INT16_MAX;
+    if (value < INT16_MIN) value = INT16_MIN;
+    *predictor = value;
+
+    int next = *index + ima_index_table[code];
+    if (next < 0) next = 0;
+    if (next > IMA_ADPCM_MAX_STEP_INDEX) next = IMA_ADPCM_MAX_STEP_INDEX;
+    *index = next;
+    return (int16_t)value;
+}
+
+/// Working copy of a state (a corrupt step index from the wire is clamped)
+static inline void load_state(const ima_adpcm_state *state, int *predictor, int *index) {
+    *predictor = state->predictor;
+    *index = state->step_index > IMA_ADPCM_MAX_STEP_INDEX ? IMA_ADPCM_MAX_STEP_INDEX : state->step_index;
+}
+
+void ima_adpcm_decode(const uint8_t *adpcm, size_t bytes, ima_adpcm_state *state, int16_t *pcm) {
+    int predictor, index;
+    load_state(state, &predictor, &index);
+
+    for (size_t i = 0; i < bytes; i++) {
+        pcm[2 * i]     = decode_nibble(adpcm[i] & 0x0F, &predictor, &index);
+        pcm[2 * i + 1] = decode_nibble(adpcm[i] >> 4, &predictor, &index);
+    }
+
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+}
+
+void ima_adpcm_transcode_alaw(const uint8_t *adpcm, size_t bytes, ima_adpcm_state *state, uint8_t *alaw) {
+    // Decode in stack-sized blocks, then encode each block in one pass
+    enum { kBlockBytes = 128 };
+    int16_t pcm[2 * kBlockBytes];
+
+    while (bytes > 0) {
+        size_t block = bytes < kBlockBytes ? bytes : kBlockBytes;
+        ima_adpcm_decode(adpcm, block, state, pcm);
+        g711_alaw_encode(pcm, alaw, 2 * block);
+        adpcm += block;
+        alaw += 2 * block;
+        bytes -= block;
+    }
+}
+
+#pragma mark - Encode
+
+/// Quantise the difference to the prediction and track it like the decoder
+static inline uint8_t encode_sample(int16_t sample, int *predictor, int *index) {
+    int step = ima_step_table[*index];
+    int diff = sample - *predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 2; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 1; }
+
+    decode_nibble(code, predictor, index);
+    return code;
+}
+
+size_t ima_adpcm_encode(const int16_t *pcm, size_t count, ima_adpcm_state *state, uint8_t *adpcm) {
+    int predictor, index;
+    load_state(state, &predictor, &index);
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i += 2) {
+        uint8_t low = encode_sample(pcm[i], &predictor, &index);
+        uint8_t high = i + 1 < count ? encode_sample(pcm[i + 1], &predictor, &index) : 0;
+        adpcm[bytes++] = (uint8_t)(low | (high << 4));
+    }
+
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return bytes;
+}
@@ -0,0 +1,55 @@
+//
+//  ImaAdpcm.h
+//  VeepaAudioTest
+//
+//  Created for congestion-aware bitrate adaptation
+//  Purpose: IMA ADPCM kernels for the half-rate (4 bits per sample)
+//           camera stream used when the link is congested
+//
+//  Two samples per byte, first sample in the low nibble. Each frame starts
+//  from the predictor state the camera sends with it (app_frame_header
+//  .sample and .index), so a lost frame never desynchronises the next one.
+//
+//  The live pipeline is built around A-law frames (observers, archive,
+//  rewind history, level measurement), so ADPCM frames are transcoded to
+//  A-law on arrival (ima_adpcm_transcode_alaw) and everything downstream
+//  stays unchanged. ADPCM is a serial recurrence - each sample depends on
+//  the previous one - so there is no vector path.
+//
+
+#ifndef ImaAdpcm_h
+#define ImaAdpcm_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Largest valid step index
+#define IMA_ADPCM_MAX_STEP_INDEX 88
+
+/// Predictor state at a frame boundary
+typedef struct {
+    int16_t predictor;      ///< Last decoded sample
+    uint8_t step_index;     ///< 0 ... IMA_ADPCM_MAX_STEP_INDEX
+} ima_adpcm_state;
+
+/// Decode `bytes` bytes into 2 × `bytes` samples
+/// @param state Frame's initial state, updated to its final state
+void ima_adpcm_decode(const uint8_t *adpcm, size_t bytes, ima_adpcm_state *state, int16_t *pcm);
+
+/// Encode `count` samples (odd counts pad the last byte's high nibble)
+/// @param state Initial state, updated to the final state
+/// @return Bytes written ((count + 1) / 2)
+size_t ima_adpcm_encode(const int16_t *pcm, size_t count, ima_adpcm_state *state, uint8_t *adpcm);
+
+/// Decode `bytes` bytes straight to 2 × `bytes` A-law bytes
+void ima_adpcm_transcode_alaw(const uint8_t *adpcm, size_t bytes, ima_adpcm_state *state, uint8_t *alaw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ImaAdpcm_h */
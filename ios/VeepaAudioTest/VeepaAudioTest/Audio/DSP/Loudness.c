@@ -0,0 +1,303 @@
+//
+//  Loudness.c
+//  VeepaAudioTest
+//
+//  Created for loudness monitoring and normalization
+//  Purpose: K-weighted streaming loudness meter with histogram gating
+//
+
+#include "Loudness.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/// Sub-blocks per momentary (400 ms) and short-term (3 s) window
+#define MOMENTARY_SUBBLOCKS   4
+#define SHORT_TERM_SUBBLOCKS  30
+
+/// Samples filtered per pass (stack buffer)
+#define CHUNK_SAMPLES 256
+
+/// BS.1770 offset: a 997 Hz full-scale sine in one channel reads -3.01 LUFS
+#define LUFS_OFFSET (-0.691)
+
+struct loudness_meter {
+    biquad_cascade filter;
+    biquad_state state;
+    uint32_t sample_rate;
+    uint32_t subblock_samples;      ///< 100 ms
+    uint32_t fill;                  ///< Samples in the current sub-block
+    double energy;                  ///< Their sum of squares
+    double subblocks[SHORT_TERM_SUBBLOCKS];  ///< Mean squares, ring
+    uint32_t head;                  ///< Next ring slot
+    uint32_t completed;             ///< Sub-blocks since the reset (saturating)
+    int16_t momentary_clu;          ///< (atomic)
+    int16_t short_term_clu;         ///< (atomic)
+    int16_t integrated_clu;         ///< (atomic)
+    int16_t max_momentary_clu;      ///< (atomic)
+    int16_t max_short_term_clu;     ///< (atomic)
+    uint32_t gated_blocks;          ///< (atomic)
+    uint8_t reset;                  ///< (atomic) Set by loudness_meter_reset
+    uint32_t histogram[LOUDNESS_HISTOGRAM_BINS];  ///< (atomic) counts
+};
+
+#pragma mark - Histogram Bins
+
+/// Mean square at the centre of each bin (built on first use)
+static double bin_energy[LOUDNESS_HISTOGRAM_BINS];
+static int bin_energy_ready;
+
+static void bin_energy_init(void) {
+    if (__atomic_load_n(&bin_energy_ready, __ATOMIC_ACQUIRE)) return;
+    for (int bin = 0; bin < LOUDNESS_HISTOGRAM_BINS; bin++) {
+        double lufs = (LOUDNESS_ABSOLUTE_GATE_CLU + bin * 10 + 5) / 100.0;
+        bin_energy[bin] = pow(10.0, (lufs - LUFS_OFFSET) / 10.0);
+    }
+    __atomic_store_n(&bin_energy_ready, 1, __ATOMIC_RELEASE);
+}
+
+/// Bin of a loudness in centi-LU, -1 below the absolute gate
+static inline int bin_of(int32_t clu) {
+    if (clu < LOUDNESS_ABSOLUTE_GATE_CLU) return -1;
+    int bin = (clu - LOUDNESS_ABSOLUTE_GATE_CLU) / 10;
+    return bin < LOUDNESS_HISTOGRAM_BINS ? bin : LOUDNESS_HISTOGRAM_BINS - 1;
+}
+
+/// Mean square to centi-LU (LOUDNESS_NONE for silence)
+static int16_t clu_of(double mean_square) {
+    if (!(mean_square > 0)) return LOUDNESS_NONE;
+    double clu = 100.0 * (LUFS_OFFSET + 10.0 * log10(mean_square));
+    if (clu < -32767) return -32767;
+    if (clu > 32767) return 32767;
+    return (int16_t)lround(clu);
+}
+
+/// Mean energy of the bins from `first` up (sum and count)
+static double gated_sum(const uint32_t *counts, int first, uint64_t *blocks) {
+    double sum = 0;
+    *blocks = 0;
+    for (int bin = first; bin < LOUDNESS_HISTOGRAM_BINS; bin++) {
+        uint32_t n = __atomic_load_n(&counts[bin], __ATOMIC_RELAXED);
+        sum += n * bin_energy[bin];
+        *blocks += n;
+    }
+    return sum;
+}
+
+int16_t loudness_integrated_from_histogram(const uint32_t *counts) {
+    bin_energy_init();
+
+    // Absolute gate: every counted block is above it
+    uint64_t blocks;
+    double sum = gated_sum(counts, 0, &blocks);
+    if (blocks == 0) return LOUDNESS_NONE;
+
+    // Relative gate from the absolute-gated mean
+    int first = bin_of(clu_of(sum / (double)blocks) + LOUDNESS_RELATIVE_GATE_CLU);
+    if (first < 0) first = 0;
+    sum = gated_sum(counts, first, &blocks);
+    return blocks > 0 ? clu_of(sum / (double)blocks) : LOUDNESS_NONE;
+}
+
+#pragma mark - K-Weighting
+
+void loudness_k_weighting(uint32_t sample_rate, biquad_coefficients sections[2]) {
+    // BS.1770 stage 1 (head shelf) and stage 2 (RLB high-pass) from their
+    // analogue prototypes, so any rate gets the 48 kHz response
+    double fs = (double)sample_rate;
+
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(M_PI * f0 / fs);
+    double vh = pow(10.0, gain_db / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    sections[0].b0 = (vh + vb * k / q + k * k) / a0;
+    sections[0].b1 = 2.0 * (k * k - vh) / a0;
+    sections[0].b2 = (vh - vb * k / q + k * k) / a0;
+    sections[0].a1 = 2.0 * (k * k - 1.0) / a0;
+    sections[0].a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(M_PI * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    sections[1].b0 = 1.0;
+    sections[1].b1 = -2.0;
+    sections[1].b2 = 1.0;
+    sections[1].a1 = 2.0 * (k * k - 1.0) / a0;
+    sections[1].a2 = (1.0 - k / q + k * k) / a0;
+}
+
+#pragma mark - Lifecycle
+
+static void reset_meter(loudness_meter *meter) {
+    biquad_state_reset(&meter->state);
+    meter->fill = 0;
+    meter->energy = 0;
+    meter->head = 0;
+    meter->completed = 0;
+    __atomic_store_n(&meter->momentary_clu, LOUDNESS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&meter->short_term_clu, LOUDNESS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&meter->integrated_clu, LOUDNESS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&meter->max_momentary_clu, LOUDNESS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&meter->max_short_term_clu, LOUDNESS_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&meter->gated_blocks, 0, __ATOMIC_RELAXED);
+    for (int bin = 0; bin < LOUDNESS_HISTOGRAM_BINS; bin++) {
+        __atomic_store_n(&meter->histogram[bin], 0, __ATOMIC_RELAXED);
+    }
+}
+
+loudness_meter *loudness_meter_create(uint32_t sample_rate) {
+    if (sample_rate < 8000) return NULL;
+
+    loudness_meter *meter = (loudness_meter *)calloc(1, sizeof(loudness_meter));
+    if (meter == NULL) return NULL;
+
+    biquad_coefficients k_weighting[2];
+    loudness_k_weighting(sample_rate, k_weighting);
+    biquad_cascade_init(&meter->filter, k_weighting, 2);
+
+    meter->sample_rate = sample_rate;
+    meter->subblock_samples = sample_rate / 10;
+    reset_meter(meter);
+    bin_energy_init();
+    return meter;
+}
+
+void loudness_meter_destroy(loudness_meter *meter) {
+    free(meter);
+}
+
+uint32_t loudness_meter_sample_rate(const loudness_meter *meter) {
+    return meter->sample_rate;
+}
+
+void loudness_meter_reset(loudness_meter *meter) {
+    if (meter == NULL) return;
+    __atomic_store_n(&meter->reset, 1, __ATOMIC_RELEASE);
+}
+
+#pragma mark - Measurement
+
+static float sum_squares(const float *samples, size_t count) {
+    size_t i = 0;
+    float sum = 0;
+#if defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t x0 = vld1q_f32(samples + i);
+        float32x4_t x1 = vld1q_f32(samples + i + 4);
+        acc0 = vmlaq_f32(acc0, x0, x0);
+        acc1 = vmlaq_f32(acc1, x1, x1);
+    }
+    sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+    for (; i < count; i++) {
+        sum += samples[i] * samples[i];
+    }
+    return sum;
+}
+
+static inline void publish_max(int16_t *max, int16_t value) {
+    if (value == LOUDNESS_NONE) return;
+    int16_t current = __atomic_load_n(max, __ATOMIC_RELAXED);
+    if (current == LOUDNESS_NONE || value > current) {
+        __atomic_store_n(max, value, __ATOMIC_RELAXED);
+    }
+}
+
+/// Mean of the newest `count` sub-blocks
+static double window_mean(const loudness_meter *meter, uint32_t count) {
+    double sum = 0;
+    uint32_t index = meter->head;
+    for (uint32_t i = 0; i < count; i++) {
+        index = index == 0 ? SHORT_TERM_SUBBLOCKS - 1 : index - 1;
+        sum += meter->subblocks[index];
+    }
+    return sum / count;
+}
+
+/// A 100 ms sub-block is complete: update every window and the gate
+static void complete_subblock(loudness_meter *meter) {
+    meter->subblocks[meter->head] = meter->energy / meter->subblock_samples;
+    meter->head = (meter->head + 1) % SHORT_TERM_SUBBLOCKS;
+    if (meter->completed < UINT32_MAX) meter->completed++;
+    meter->energy = 0;
+    meter->fill = 0;
+
+    if (meter->completed >= MOMENTARY_SUBBLOCKS) {
+        // The momentary window is the newest 400 ms gating block
+        int16_t momentary = clu_of(window_mean(meter, MOMENTARY_SUBBLOCKS));
+        __atomic_store_n(&meter->momentary_clu, momentary, __ATOMIC_RELAXED);
+        publish_max(&meter->max_momentary_clu, momentary);
+
+        int bin = momentary == LOUDNESS_NONE ? -1 : bin_of(momentary);
+        if (bin >= 0) {
+            __atomic_store_n(&meter->histogram[bin], meter->histogram[bin] + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&meter->gated_blocks, meter->gated_blocks + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&meter->integrated_clu, loudness_integrated_from_histogram(meter->histogram),
+                             __ATOMIC_RELAXED);
+        }
+    }
+
+    if (meter->completed >= SHORT_TERM_SUBBLOCKS) {
+        int16_t short_term = clu_of(window_mean(meter, SHORT_TERM_SUBBLOCKS));
+        __atomic_store_n(&meter->short_term_clu, short_term, __ATOMIC_RELAXED);
+        publish_max(&meter->max_short_term_clu, short_term);
+    }
+}
+
+void loudness_meter_add(loudness_meter *meter, const int16_t *pcm, size_t count) {
+    if (meter == NULL || pcm == NULL) return;
+    if (__atomic_exchange_n(&meter->reset, 0, __ATOMIC_ACQUIRE)) {
+        reset_meter(meter);
+    }
+
+    float buffer[CHUNK_SAMPLES];
+    while (count > 0) {
+        size_t n = meter->subblock_samples - meter->fill;
+        if (n > CHUNK_SAMPLES) n = CHUNK_SAMPLES;
+        if (n > count) n = count;
+
+        for (size_t i = 0; i < n; i++) {
+            buffer[i] = pcm[i] * (1.0f / 32768.0f);
+        }
+        biquad_process(&meter->filter, &meter->state, buffer, buffer, n);
+        meter->energy += sum_squares(buffer, n);
+        meter->fill += (uint32_t)n;
+        if (meter->fill == meter->subblock_samples) {
+            complete_subblock(meter);
+        }
+
+        pcm += n;
+        count -= n;
+    }
+}
+
+loudness_reading loudness_meter_read(const loudness_meter *meter) {
+    loudness_reading reading = {
+        LOUDNESS_NONE, LOUDNESS_NONE, LOUDNESS_NONE, LOUDNESS_NONE, LOUDNESS_NONE, 0
+    };
+    if (meter == NULL) return reading;
+    reading.momentary_clu = __atomic_load_n(&meter->momentary_clu, __ATOMIC_RELAXED);
+    reading.short_term_clu = __atomic_load_n(&meter->short_term_clu, __ATOMIC_RELAXED);
+    reading.integrated_clu = __atomic_load_n(&meter->integrated_clu, __ATOMIC_RELAXED);
+    reading.max_momentary_clu = __atomic_load_n(&meter->max_momentary_clu, __ATOMIC_RELAXED);
+    reading.max_short_term_clu = __atomic_load_n(&meter->max_short_term_clu, __ATOMIC_RELAXED);
+    reading.gated_blocks = __atomic_load_n(&meter->gated_blocks, __ATOMIC_RELAXED);
+    return reading;
+}
+
+void loudness_meter_histogram(const loudness_meter *meter, uint32_t *counts) {
+    for (int bin = 0; bin < LOUDNESS_HISTOGRAM_BINS; bin++) {
+        counts[bin] = meter == NULL ? 0 : __atomic_load_n(&meter->histogram[bin], __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,96 @@
+//
+//  Loudness.h
+//  VeepaAudioTest
+//
+//  Created for loudness monitoring and normalization
+//  Purpose: Streaming EBU R128 / ITU-R BS.1770 loudness meter per stream -
+//           momentary, short-term and gated integrated loudness
+//
+//  Samples are K-weighted (high shelf + high-pass, designed for the
+//  stream's own rate) by the SIMD biquad cascade, squared and summed into
+//  100 ms sub-blocks. Every sub-block completes a 400 ms gating block
+//  (75 % overlap):
+//
+//  - momentary: the last 4 sub-blocks (400 ms)
+//  - short-term: the last 30 sub-blocks (3 s)
+//  - integrated: blocks above the -70 LUFS absolute gate go into a
+//    histogram of 0.1 LU bins; the relative gate (-10 LU below the
+//    absolute-gated mean) and the gated mean are taken from the histogram,
+//    so each update costs the same after a minute or after a day and no
+//    block history is kept or re-scanned
+//
+//  The histogram quantises block loudness to 0.1 LU, which moves the
+//  integrated value by less than 0.05 LU. Histograms of consecutive
+//  recordings add up, so the integrated loudness of several archive
+//  segments is exact without re-measuring them.
+//
+//  Values are centi-LU (hundredths of LUFS) in int16, LOUDNESS_NONE when
+//  there is nothing to report yet (or the window is digital silence).
+//
+//  Threading: loudness_meter_add runs on one thread per meter. Readings,
+//  the histogram and reset requests are safe from any thread.
+//
+
+#ifndef Loudness_h
+#define Loudness_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Biquad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// No reading yet, or the window is digital silence
+#define LOUDNESS_NONE                (-32768)
+/// Absolute gate and lowest histogram bin, centi-LU
+#define LOUDNESS_ABSOLUTE_GATE_CLU   (-7000)
+/// Relative gate below the absolute-gated mean, centi-LU
+#define LOUDNESS_RELATIVE_GATE_CLU   (-1000)
+/// 0.1 LU bins from -70 to +5 LUFS
+#define LOUDNESS_HISTOGRAM_BINS      750
+
+typedef struct loudness_meter loudness_meter;
+
+typedef struct {
+    int16_t  momentary_clu;       ///< Last 400 ms
+    int16_t  short_term_clu;      ///< Last 3 s (LOUDNESS_NONE for the first 3 s)
+    int16_t  integrated_clu;      ///< Gated, since the start or the last reset
+    int16_t  max_momentary_clu;
+    int16_t  max_short_term_clu;
+    uint32_t gated_blocks;        ///< Blocks above the absolute gate
+} loudness_reading;
+
+/// K-weighting pre-filter for a sample rate: [0] high shelf, [1] high-pass
+void loudness_k_weighting(uint32_t sample_rate, biquad_coefficients sections[2]);
+
+/// @return NULL if allocation fails or sample_rate is below 8000
+loudness_meter *loudness_meter_create(uint32_t sample_rate);
+
+void loudness_meter_destroy(loudness_meter *meter);
+
+uint32_t loudness_meter_sample_rate(const loudness_meter *meter);
+
+/// Start afresh (filters, windows, histogram) before the next block of samples
+void loudness_meter_reset(loudness_meter *meter);
+
+/// Measure `count` samples (the meter's thread)
+void loudness_meter_add(loudness_meter *meter, const int16_t *pcm, size_t count);
+
+/// Latest values, as of the last completed 100 ms sub-block
+loudness_reading loudness_meter_read(const loudness_meter *meter);
+
+/// Copy the gating-block histogram (LOUDNESS_HISTOGRAM_BINS counts)
+void loudness_meter_histogram(const loudness_meter *meter, uint32_t *counts);
+
+/// Gated integrated loudness of a histogram (one meter's, or the sum of several)
+/// @return centi-LU, or LOUDNESS_NONE if no block passed the absolute gate
+int16_t loudness_integrated_from_histogram(const uint32_t *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Loudness_h */
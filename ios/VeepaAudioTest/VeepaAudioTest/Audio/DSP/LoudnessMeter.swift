@@ -0,0 +1,96 @@
+//
+//  LoudnessMeter.swift
+//  VeepaAudioTest
+//
+//  Created for loudness monitoring and normalization
+//  Purpose: Swift access to the streaming EBU R128 meter - feed a stream's
+//           decoded samples on one thread, read LUFS from any thread
+//
+//  K-weighting, windows and histogram gating live in Loudness.c. The
+//  playback engine meters the SDK stream (AudioBridgeEngine.loudnessMeter)
+//  and can normalise it; the capture archive meters each segment into its
+//  *.vaci index.
+//
+
+import Foundation
+
+final class LoudnessMeter {
+
+    enum MeterError: Error, LocalizedError {
+        case creationFailed(sampleRate: Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed(let sampleRate):
+                return "Cannot create a loudness meter for \(sampleRate) Hz"
+            }
+        }
+    }
+
+    /// Latest values in LUFS (nil until the window has filled, or silence)
+    struct Reading: Equatable {
+        var momentary: Double?
+        var shortTerm: Double?
+        var integrated: Double?
+        var maxMomentary: Double?
+        var maxShortTerm: Double?
+        var gatedBlocks: Int
+
+        fileprivate init(_ reading: loudness_reading) {
+            momentary = LoudnessMeter.lufs(reading.momentary_clu)
+            shortTerm = LoudnessMeter.lufs(reading.short_term_clu)
+            integrated = LoudnessMeter.lufs(reading.integrated_clu)
+            maxMomentary = LoudnessMeter.lufs(reading.max_momentary_clu)
+            maxShortTerm = LoudnessMeter.lufs(reading.max_short_term_clu)
+            gatedBlocks = Int(reading.gated_blocks)
+        }
+    }
+
+    let meter: OpaquePointer
+    let sampleRate: Int
+
+    init(sampleRate: Int) throws {
+        guard let meter = loudness_meter_create(UInt32(sampleRate)) else {
+            throw MeterError.creationFailed(sampleRate: sampleRate)
+        }
+        self.meter = meter
+        self.sampleRate = sampleRate
+    }
+
+    deinit {
+        loudness_meter_destroy(meter)
+    }
+
+    // MARK: - Measuring (one thread)
+
+    func add(_ samples: UnsafePointer<Int16>, count: Int) {
+        loudness_meter_add(meter, samples, count)
+    }
+
+    // MARK: - Readings (any thread)
+
+    var reading: Reading { Reading(loudness_meter_read(meter)) }
+
+    /// Gating blocks per 0.1 LU bin from -70 LUFS; histograms of several
+    /// meters or segments add up
+    var histogram: [UInt32] {
+        var counts = [UInt32](repeating: 0, count: Int(LOUDNESS_HISTOGRAM_BINS))
+        loudness_meter_histogram(meter, &counts)
+        return counts
+    }
+
+    /// Start the windows and the integrated value afresh
+    func reset() {
+        loudness_meter_reset(meter)
+    }
+
+    /// Gated loudness of a (summed) histogram
+    static func integratedLoudness(histogram: [UInt32]) -> Double? {
+        precondition(histogram.count == Int(LOUDNESS_HISTOGRAM_BINS))
+        return lufs(loudness_integrated_from_histogram(histogram))
+    }
+
+    static func lufs(_ centiLU: Int16) -> Double? {
+        Int32(centiLU) == LOUDNESS_NONE ? nil : Double(centiLU) / 100
+    }
+}
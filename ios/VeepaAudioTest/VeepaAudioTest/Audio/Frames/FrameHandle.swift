@@ -0,0 +1,154 @@
+//
+//  FrameHandle.swift
+//  VeepaAudioTest
+//
+//  Created for copy-free frame fan-out
+//  Purpose: Move-only Swift handles over FramePool.c buffers
+//
+//  A FrameHandle owns exactly one reference to a pooled frame. It cannot be
+//  copied, so a reference is never dropped twice or leaked by accident:
+//  passing a handle moves it, `share()` takes another reference explicitly,
+//  and the reference is released when the handle's lifetime ends.
+//
+//  Noncopyable values cannot be captured by escaping closures, so a frame
+//  crosses a queue as a FrameReference (`escape()`), which the receiving
+//  side turns back into a handle with FrameHandle(adopting:).
+//
+
+import Foundation
+
+// MARK: - Handle
+
+/// One reference to a pooled frame; released when the handle goes away
+struct FrameHandle: ~Copyable {
+
+    private let buffer: UnsafeMutablePointer<frame_buffer>
+
+    /// Take over a reference the caller already holds (acquire/copy, escape())
+    init(adopting reference: FrameReference) {
+        buffer = reference.buffer
+    }
+
+    /// Take a new reference to a buffer lent to the caller (frame buffer observers)
+    init(retaining buffer: UnsafeMutablePointer<frame_buffer>) {
+        frame_buffer_retain(buffer)
+        self.buffer = buffer
+    }
+
+    deinit {
+        frame_buffer_release(buffer)
+    }
+
+    /// Another handle to the same payload
+    func share() -> FrameHandle {
+        FrameHandle(retaining: buffer)
+    }
+
+    /// Hand this handle's reference to a copyable token, e.g. to send the
+    /// frame to another queue; exactly one FrameHandle(adopting:) must follow
+    consuming func escape() -> FrameReference {
+        // The handle's own release runs when it is consumed here
+        frame_buffer_retain(buffer)
+        return FrameReference(buffer: buffer)
+    }
+
+    // MARK: - Payload
+
+    var frameNo: UInt32 { buffer.pointee.frame_no }
+    var timestampMs: UInt32 { buffer.pointee.timestamp_ms }
+    var count: Int { Int(buffer.pointee.length) }
+
+    /// The payload; valid while this handle is alive
+    var bytes: UnsafeBufferPointer<UInt8> {
+        UnsafeBufferPointer(start: buffer.pointee.data, count: count)
+    }
+
+    /// Identity of the shared storage (two handles to one frame compare equal)
+    var storage: UnsafeRawPointer {
+        UnsafeRawPointer(buffer.pointee.data)
+    }
+}
+
+/// A frame reference in transit; copyable, so it carries no ownership of its
+/// own - whoever adopts it owns the reference
+struct FrameReference: @unchecked Sendable {
+    let buffer: UnsafeMutablePointer<frame_buffer>
+}
+
+// MARK: - Pool
+
+/// Owns a FramePool.c pool; outstanding handles keep its storage alive
+final class FramePool {
+
+    enum PoolError: Error, LocalizedError {
+        case creationFailed
+        case exhausted
+        case tooLarge(Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed:
+                return "Cannot allocate frame pool"
+            case .exhausted:
+                return "Every pooled frame buffer is in use"
+            case .tooLarge(let length):
+                return "Frame of \(length) bytes exceeds the largest pooled buffer"
+            }
+        }
+    }
+
+    private let pool: OpaquePointer
+
+    /// - Parameters:
+    ///   - smallBuffers: Buffers holding up to FRAME_POOL_INLINE_BYTES inline
+    ///   - largeBuffers: Buffers for longer frames
+    ///   - largeBytes: Capacity of each large buffer
+    init(smallBuffers: Int = 64, largeBuffers: Int = 16, largeBytes: Int = 4096) throws {
+        var config = frame_pool_config()
+        frame_pool_config_init(&config)
+        config.small_buffers = UInt32(smallBuffers)
+        config.large_buffers = UInt32(largeBuffers)
+        config.large_bytes = UInt32(largeBytes)
+        guard let pool = frame_pool_create(&config) else {
+            throw PoolError.creationFailed
+        }
+        self.pool = pool
+    }
+
+    deinit {
+        frame_pool_destroy(pool)
+    }
+
+    /// Copy a frame into a pooled buffer - the one copy it makes
+    func copy(_ payload: UnsafeBufferPointer<UInt8>, frameNo: UInt32, timestampMs: UInt32) throws -> FrameHandle {
+        FrameHandle(adopting: try acquireCopy(payload, frameNo: frameNo, timestampMs: timestampMs))
+    }
+
+    /// Copy a frame held in an array (noncopyable handles cannot be returned
+    /// through withUnsafeBufferPointer, so the pointer work stays in here)
+    func copy(_ payload: [UInt8], frameNo: UInt32, timestampMs: UInt32) throws -> FrameHandle {
+        let reference = try payload.withUnsafeBufferPointer {
+            try acquireCopy($0, frameNo: frameNo, timestampMs: timestampMs)
+        }
+        return FrameHandle(adopting: reference)
+    }
+
+    private func acquireCopy(_ payload: UnsafeBufferPointer<UInt8>, frameNo: UInt32,
+                             timestampMs: UInt32) throws -> FrameReference {
+        var error: Int32 = 0
+        guard let buffer = frame_pool_copy(pool, payload.baseAddress, UInt32(payload.count),
+                                           frameNo, timestampMs, &error) else {
+            if error == Int32(FRAME_POOL_ERR_TOO_LARGE) {
+                throw PoolError.tooLarge(payload.count)
+            }
+            throw PoolError.exhausted
+        }
+        return FrameReference(buffer: buffer)
+    }
+
+    var stats: frame_pool_stats {
+        var stats = frame_pool_stats()
+        frame_pool_get_stats(pool, &stats)
+        return stats
+    }
+}
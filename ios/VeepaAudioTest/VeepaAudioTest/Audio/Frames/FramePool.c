@@ -0,0 +1,198 @@
+//
+//  FramePool.c
+//  VeepaAudioTest
+//
+//  Created for copy-free frame fan-out
+//  Purpose: Pooled, intrusively refcounted frame buffers
+//
+
+#include "FramePool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum { SMALL = 0, LARGE = 1, SIZE_CLASSES = 2 };
+
+/// Free-list head: tag (high 32 bits, bumped on every change) | index + 1 (0 = empty)
+typedef struct {
+    uint64_t head;
+    uint8_t pad[56];
+} free_list;
+
+struct frame_pool {
+    free_list free[SIZE_CLASSES];   ///< (atomic) heads, one cache line each
+    frame_buffer *buffers[SIZE_CLASSES];
+    uint32_t counts[SIZE_CLASSES];
+    uint8_t *large_slab;
+    frame_pool_config config;
+
+    uint32_t refs;                  ///< (atomic) Owner + outstanding buffers
+    uint32_t peak_refs;             ///< (atomic)
+    uint64_t acquired;              ///< (atomic)
+    uint64_t exhausted;             ///< (atomic)
+};
+
+static void pool_free(frame_pool *pool) {
+    for (int c = 0; c < SIZE_CLASSES; c++) free(pool->buffers[c]);
+    free(pool->large_slab);
+    free(pool);
+}
+
+static void pool_unref(frame_pool *pool) {
+    if (__atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        pool_free(pool);
+    }
+}
+
+#pragma mark - Free Lists
+
+static void push_free(frame_pool *pool, frame_buffer *buffer) {
+    free_list *list = &pool->free[buffer->size_class];
+    uint64_t head = __atomic_load_n(&list->head, __ATOMIC_RELAXED);
+    uint64_t next;
+    do {
+        __atomic_store_n(&buffer->next_free, (uint32_t)head, __ATOMIC_RELAXED);
+        next = ((head >> 32) + 1) << 32 | (uint64_t)(buffer->index + 1);
+    } while (!__atomic_compare_exchange_n(&list->head, &head, next, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static frame_buffer *pop_free(frame_pool *pool, int size_class) {
+    free_list *list = &pool->free[size_class];
+    uint64_t head = __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t slot = (uint32_t)head;
+        if (slot == 0) return NULL;
+        frame_buffer *buffer = &pool->buffers[size_class][slot - 1];
+        // May read a link that another thread is changing; the tag makes the CAS fail then
+        uint32_t link = __atomic_load_n(&buffer->next_free, __ATOMIC_RELAXED);
+        uint64_t next = ((head >> 32) + 1) << 32 | link;
+        if (__atomic_compare_exchange_n(&list->head, &head, next, 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return buffer;
+        }
+    }
+}
+
+#pragma mark - Lifecycle
+
+void frame_pool_config_init(frame_pool_config *config) {
+    config->small_buffers = 64;
+    config->large_buffers = 16;
+    config->large_bytes = 4096;
+}
+
+frame_pool *frame_pool_create(const frame_pool_config *config) {
+    if (config->small_buffers == 0 && config->large_buffers == 0) return NULL;
+
+    frame_pool *pool = (frame_pool *)aligned_alloc(64, (sizeof(frame_pool) + 63) & ~(size_t)63);
+    if (pool == NULL) return NULL;
+    memset(pool, 0, sizeof(frame_pool));
+    pool->config = *config;
+    pool->refs = 1;
+    pool->peak_refs = 1;
+
+    pool->counts[SMALL] = config->small_buffers;
+    pool->counts[LARGE] = config->large_bytes > FRAME_POOL_INLINE_BYTES ? config->large_buffers : 0;
+    for (int c = 0; c < SIZE_CLASSES; c++) {
+        if (pool->counts[c] == 0) continue;
+        pool->buffers[c] = (frame_buffer *)calloc(pool->counts[c], sizeof(frame_buffer));
+        if (pool->buffers[c] == NULL) {
+            pool_free(pool);
+            return NULL;
+        }
+    }
+    if (pool->counts[LARGE] > 0) {
+        pool->large_slab = (uint8_t *)malloc((size_t)pool->counts[LARGE] * config->large_bytes);
+        if (pool->large_slab == NULL) {
+            pool_free(pool);
+            return NULL;
+        }
+    }
+
+    for (int c = 0; c < SIZE_CLASSES; c++) {
+        for (uint32_t i = pool->counts[c]; i-- > 0;) {
+            frame_buffer *buffer = &pool->buffers[c][i];
+            buffer->pool = pool;
+            buffer->index = i;
+            buffer->size_class = (uint32_t)c;
+            if (c == SMALL) {
+                buffer->data = buffer->inline_data;
+                buffer->capacity = FRAME_POOL_INLINE_BYTES;
+            } else {
+                buffer->data = pool->large_slab + (size_t)i * config->large_bytes;
+                buffer->capacity = config->large_bytes;
+            }
+            push_free(pool, buffer);
+        }
+    }
+    return pool;
+}
+
+void frame_pool_destroy(frame_pool *pool) {
+    if (pool == NULL) return;
+    pool_unref(pool);
+}
+
+#pragma mark - Buffers
+
+frame_buffer *frame_pool_acquire(frame_pool *pool, uint32_t length, int *error) {
+    frame_buffer *buffer = NULL;
+    if (length <= FRAME_POOL_INLINE_BYTES) {
+        buffer = pop_free(pool, SMALL);
+    }
+    if (buffer == NULL && pool->counts[LARGE] > 0 && length <= pool->config.large_bytes) {
+        buffer = pop_free(pool, LARGE);
+    }
+    if (buffer == NULL) {
+        int code = length > FRAME_POOL_INLINE_BYTES &&
+                   (pool->counts[LARGE] == 0 || length > pool->config.large_bytes)
+                 ? FRAME_POOL_ERR_TOO_LARGE : FRAME_POOL_ERR_EXHAUSTED;
+        if (code == FRAME_POOL_ERR_EXHAUSTED) __atomic_add_fetch(&pool->exhausted, 1, __ATOMIC_RELAXED);
+        if (error) *error = code;
+        return NULL;
+    }
+
+    // The pool's refcount doubles as the outstanding-buffer count
+    uint32_t refs = __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->acquired, 1, __ATOMIC_RELAXED);
+    uint32_t peak = __atomic_load_n(&pool->peak_refs, __ATOMIC_RELAXED);
+    while (refs > peak &&
+           !__atomic_compare_exchange_n(&pool->peak_refs, &peak, refs, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    buffer->length = length;
+    buffer->frame_no = 0;
+    buffer->timestamp_ms = 0;
+    __atomic_store_n(&buffer->refcount, 1, __ATOMIC_RELAXED);
+    return buffer;
+}
+
+frame_buffer *frame_pool_copy(frame_pool *pool, const uint8_t *payload, uint32_t length,
+                              uint32_t frame_no, uint32_t timestamp_ms, int *error) {
+    frame_buffer *buffer = frame_pool_acquire(pool, length, error);
+    if (buffer == NULL) return NULL;
+    memcpy(buffer->data, payload, length);
+    buffer->frame_no = frame_no;
+    buffer->timestamp_ms = timestamp_ms;
+    return buffer;
+}
+
+void frame_buffer_retain(frame_buffer *buffer) {
+    __atomic_add_fetch(&buffer->refcount, 1, __ATOMIC_RELAXED);
+}
+
+void frame_buffer_release(frame_buffer *buffer) {
+    if (__atomic_sub_fetch(&buffer->refcount, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    frame_pool *pool = buffer->pool;
+    push_free(pool, buffer);
+    pool_unref(pool);
+}
+
+void frame_pool_get_stats(const frame_pool *pool, frame_pool_stats *stats) {
+    // Called by the owner, whose reference is the 1 in refs
+    stats->outstanding = __atomic_load_n(&pool->refs, __ATOMIC_RELAXED) - 1;
+    stats->peak_outstanding = __atomic_load_n(&pool->peak_refs, __ATOMIC_RELAXED) - 1;
+    stats->acquired = __atomic_load_n(&pool->acquired, __ATOMIC_RELAXED);
+    stats->returned = stats->acquired - stats->outstanding;
+    stats->exhausted = __atomic_load_n(&pool->exhausted, __ATOMIC_RELAXED);
+}
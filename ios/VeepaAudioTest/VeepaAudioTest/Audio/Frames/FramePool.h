@@ -0,0 +1,102 @@
+//
+//  FramePool.h
+//  VeepaAudioTest
+//
+//  Created for copy-free frame fan-out
+//  Purpose: Pooled, intrusively refcounted frame buffers so every consumer
+//           of a frame (recorder, relay, analytics, playback) shares one
+//           payload instead of copying it
+//
+//  A frame is copied once into a pooled buffer; each consumer that keeps it
+//  takes a reference (frame_buffer_retain) and drops it when done. The last
+//  release returns the buffer to its pool's free list. Buffers and their
+//  storage are all allocated when the pool is created - acquire and release
+//  never touch the global allocator.
+//
+//  Size classes: payloads up to FRAME_POOL_INLINE_BYTES (typical 160-640
+//  byte G.711 frames) live inline in the buffer header's cache lines;
+//  larger ones use a slot of the pool's large slab.
+//
+//  Threading: acquire, retain and release are lock-free and may be called
+//  from any thread. The free lists are tagged Treiber stacks.
+//
+
+#ifndef FramePool_h
+#define FramePool_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_POOL_INLINE_BYTES 640
+
+typedef struct frame_pool frame_pool;
+
+/// One pooled frame; fields other than refcount are fixed while shared
+typedef struct {
+    uint32_t refcount;          ///< (atomic) References alive
+    uint32_t length;            ///< Valid payload bytes
+    uint32_t capacity;
+    uint32_t frame_no;          ///< app_frame_header.frameno
+    uint32_t timestamp_ms;      ///< app_frame_header.timestamp
+    uint32_t next_free;         ///< (atomic) Pool-internal free-list link
+    uint32_t index;             ///< Pool-internal
+    uint32_t size_class;        ///< Pool-internal
+    frame_pool *pool;
+    uint8_t *data;              ///< inline_data, or a slot of the large slab
+    uint8_t inline_data[FRAME_POOL_INLINE_BYTES];
+} frame_buffer;
+
+typedef struct {
+    uint32_t small_buffers;     ///< Inline (≤ FRAME_POOL_INLINE_BYTES) buffers
+    uint32_t large_buffers;
+    uint32_t large_bytes;       ///< Capacity of each large buffer
+} frame_pool_config;
+
+typedef struct {
+    uint64_t acquired;
+    uint64_t returned;          ///< Buffers whose last reference was released
+    uint64_t exhausted;         ///< Acquires that found no free buffer of a fitting class
+    uint32_t outstanding;       ///< Buffers currently in use
+    uint32_t peak_outstanding;
+} frame_pool_stats;
+
+/// Error codes (negative return values)
+enum {
+    FRAME_POOL_OK               = 0,
+    FRAME_POOL_ERR_EXHAUSTED    = -1,  ///< Every fitting buffer is in use
+    FRAME_POOL_ERR_TOO_LARGE    = -2,  ///< Longer than the largest size class
+};
+
+/// Defaults: 64 inline buffers, 16 large buffers of 4096 bytes
+void frame_pool_config_init(frame_pool_config *config);
+
+/// @return NULL if allocation fails
+frame_pool *frame_pool_create(const frame_pool_config *config);
+
+/// Drop the owner's reference; storage is freed once every buffer is back
+void frame_pool_destroy(frame_pool *pool);
+
+/// Take a free buffer able to hold `length` bytes (refcount 1, length set)
+/// @param error Receives a FRAME_POOL_ERR_* code when NULL is returned (may be NULL)
+frame_buffer *frame_pool_acquire(frame_pool *pool, uint32_t length, int *error);
+
+/// Acquire and fill: the one copy a frame makes
+frame_buffer *frame_pool_copy(frame_pool *pool, const uint8_t *payload, uint32_t length,
+                              uint32_t frame_no, uint32_t timestamp_ms, int *error);
+
+void frame_buffer_retain(frame_buffer *buffer);
+
+/// Drop one reference; the last one returns the buffer to its pool
+void frame_buffer_release(frame_buffer *buffer);
+
+void frame_pool_get_stats(const frame_pool *pool, frame_pool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FramePool_h */
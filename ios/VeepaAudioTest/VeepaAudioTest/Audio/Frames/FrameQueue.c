@@ -0,0 +1,177 @@
+//
+//  FrameQueue.c
+//  VeepaAudioTest
+//
+//  Created for reader → worker frame handoff
+//  Purpose: Vyukov bounded MPMC queue with batch claims
+//
+
+#include "FrameQueue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// One slot per cache line: `sequence` == position when free for the
+/// producer of that position, position + 1 when holding its frame
+typedef struct {
+    uint64_t sequence;          ///< (atomic)
+    frame_buffer *frame;
+    uint8_t pad[64 - sizeof(uint64_t) - sizeof(frame_buffer *)];
+} queue_slot;
+
+struct frame_queue {
+    uint64_t enqueue_pos;       ///< (atomic)
+    uint8_t pad0[56];
+    uint64_t dequeue_pos;       ///< (atomic)
+    uint8_t pad1[56];
+    uint64_t mask;
+    queue_slot *slots;
+};
+
+#pragma mark - Lifecycle
+
+frame_queue *frame_queue_create(uint32_t capacity) {
+    uint64_t size = 2;
+    while (size < capacity) size <<= 1;
+    if (size > (1u << 31)) return NULL;
+
+    frame_queue *queue = (frame_queue *)aligned_alloc(64, (sizeof(frame_queue) + 63) & ~(size_t)63);
+    if (queue == NULL) return NULL;
+    memset(queue, 0, sizeof(frame_queue));
+    queue->slots = (queue_slot *)aligned_alloc(64, size * sizeof(queue_slot));
+    if (queue->slots == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->mask = size - 1;
+    for (uint64_t i = 0; i < size; i++) {
+        queue->slots[i].sequence = i;
+        queue->slots[i].frame = NULL;
+    }
+    return queue;
+}
+
+void frame_queue_destroy(frame_queue *queue) {
+    if (queue == NULL) return;
+    free(queue->slots);
+    free(queue);
+}
+
+uint32_t frame_queue_capacity(const frame_queue *queue) {
+    return (uint32_t)(queue->mask + 1);
+}
+
+#pragma mark - Single Frames
+
+int frame_queue_enqueue(frame_queue *queue, frame_buffer *frame) {
+    uint64_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        queue_slot *slot = &queue->slots[pos & queue->mask];
+        uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot->frame = frame;
+                __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+            // pos reloaded by the failed CAS
+        } else if (diff < 0) {
+            return 0;  // The slot still holds a frame from one lap ago
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int frame_queue_dequeue(frame_queue *queue, frame_buffer **frame) {
+    uint64_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        queue_slot *slot = &queue->slots[pos & queue->mask];
+        uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->dequeue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *frame = slot->frame;
+                __atomic_store_n(&slot->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;  // Not yet written
+        } else {
+            pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#pragma mark - Batches
+
+// A slot seen ready for position p stays ready until someone claims p, and
+// positions only move through the CAS below - so if the CAS from `pos`
+// succeeds, every slot counted ready before it is still ours.
+
+uint32_t frame_queue_enqueue_batch(frame_queue *queue, frame_buffer *const *frames, uint32_t count) {
+    if (count == 0) return 0;
+    uint64_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t ready = 0;
+        while (ready < count) {
+            queue_slot *slot = &queue->slots[(pos + ready) & queue->mask];
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + ready) break;
+            ready++;
+        }
+        if (ready == 0) {
+            uint64_t sequence = __atomic_load_n(&queue->slots[pos & queue->mask].sequence, __ATOMIC_ACQUIRE);
+            if ((int64_t)(sequence - pos) < 0) return 0;  // Full
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + ready, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (uint32_t i = 0; i < ready; i++) {
+                queue_slot *slot = &queue->slots[(pos + i) & queue->mask];
+                slot->frame = frames[i];
+                __atomic_store_n(&slot->sequence, pos + i + 1, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
+    }
+}
+
+uint32_t frame_queue_dequeue_batch(frame_queue *queue, frame_buffer **frames, uint32_t capacity) {
+    if (capacity == 0) return 0;
+    uint64_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        uint32_t ready = 0;
+        while (ready < capacity) {
+            queue_slot *slot = &queue->slots[(pos + ready) & queue->mask];
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + ready + 1) break;
+            ready++;
+        }
+        if (ready == 0) {
+            uint64_t sequence = __atomic_load_n(&queue->slots[pos & queue->mask].sequence, __ATOMIC_ACQUIRE);
+            if ((int64_t)(sequence - (pos + 1)) < 0) return 0;  // Empty
+            pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&queue->dequeue_pos, &pos, pos + ready, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (uint32_t i = 0; i < ready; i++) {
+                queue_slot *slot = &queue->slots[(pos + i) & queue->mask];
+                frames[i] = slot->frame;
+                __atomic_store_n(&slot->sequence, pos + i + queue->mask + 1, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
+    }
+}
+
+uint32_t frame_queue_size(const frame_queue *queue) {
+    uint64_t head = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    if (tail <= head) return 0;
+    uint64_t size = tail - head;
+    return size > queue->mask + 1 ? (uint32_t)(queue->mask + 1) : (uint32_t)size;
+}
@@ -0,0 +1,70 @@
+//
+//  FrameQueue.h
+//  VeepaAudioTest
+//
+//  Created for reader → worker frame handoff
+//  Purpose: Bounded lock-free multi-producer/multi-consumer queue of pooled
+//           frames between per-client reader threads and a worker pool
+//
+//  Vyukov's bounded MPMC array queue: every slot carries a sequence number
+//  that tells producers and consumers whose turn it is, so an operation is
+//  one CAS on the shared enqueue or dequeue position plus a release store
+//  on the slot. Slots and both positions sit on their own cache lines, so
+//  a producer filling slot i and a consumer draining slot i+1 do not share
+//  a line.
+//
+//  Batch operations claim several consecutive slots with a single CAS,
+//  which is what keeps the shared positions from becoming the bottleneck
+//  when dozens of threads hand off small frames.
+//
+//  Ownership: an enqueued frame_buffer carries one reference; whoever
+//  dequeues it owns that reference and must release it.
+//
+//  Threading: every function except create/destroy may be called from any
+//  number of threads. Full and empty are reported, never waited on.
+//
+
+#ifndef FrameQueue_h
+#define FrameQueue_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FramePool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct frame_queue frame_queue;
+
+/// @param capacity Slots (rounded up to a power of two, at least 2)
+/// @return NULL if allocation fails
+frame_queue *frame_queue_create(uint32_t capacity);
+
+/// Frames still queued are not released
+void frame_queue_destroy(frame_queue *queue);
+
+uint32_t frame_queue_capacity(const frame_queue *queue);
+
+/// @return 1 if queued, 0 if the queue is full (the caller keeps the reference)
+int frame_queue_enqueue(frame_queue *queue, frame_buffer *frame);
+
+/// @return 1 with `*frame` set, 0 if the queue is empty
+int frame_queue_dequeue(frame_queue *queue, frame_buffer **frame);
+
+/// Queue up to `count` frames, in order, with one claim
+/// @return Frames queued (a prefix of `frames`; the caller keeps the rest)
+uint32_t frame_queue_enqueue_batch(frame_queue *queue, frame_buffer *const *frames, uint32_t count);
+
+/// Take up to `capacity` frames, in queue order, with one claim
+/// @return Frames taken
+uint32_t frame_queue_dequeue_batch(frame_queue *queue, frame_buffer **frames, uint32_t capacity);
+
+/// Frames queued right now (approximate while other threads are active)
+uint32_t frame_queue_size(const frame_queue *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FrameQueue_h */
@@ -0,0 +1,98 @@
+//
+//  FrameWorkQueue.swift
+//  VeepaAudioTest
+//
+//  Created for reader → worker frame handoff
+//  Purpose: Hand pooled frames from per-client reader threads to a shared
+//           worker pool through FrameQueue.c
+//
+//  Readers move their FrameHandle into the queue; workers drain it in
+//  batches, each batch one claim on the shared dequeue position. Neither
+//  side ever takes a lock, so the handoff scales with the number of readers
+//  instead of serializing them on a mutex.
+//
+
+import Foundation
+
+/// Bounded lock-free MPMC queue of pooled frames
+final class FrameWorkQueue {
+
+    enum QueueError: Error, LocalizedError {
+        case creationFailed(capacity: Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed(let capacity):
+                return "Cannot allocate a frame queue of \(capacity) slots"
+            }
+        }
+    }
+
+    private let queue: OpaquePointer
+
+    /// Frames workers take per claim in `drain`
+    let batchSize: Int
+
+    /// Frames refused because the queue was full (dropped by `enqueue`)
+    private(set) var droppedFrames: UInt64 = 0
+    private let droppedLock = NSLock()
+
+    /// - Parameters:
+    ///   - capacity: Slots (rounded up to a power of two)
+    ///   - batchSize: Frames a worker takes per claim
+    init(capacity: Int = 1024, batchSize: Int = 16) throws {
+        guard let queue = frame_queue_create(UInt32(capacity)) else {
+            throw QueueError.creationFailed(capacity: capacity)
+        }
+        self.queue = queue
+        self.batchSize = max(1, batchSize)
+    }
+
+    deinit {
+        // Release whatever the workers never took
+        var frame: UnsafeMutablePointer<frame_buffer>?
+        while frame_queue_dequeue(queue, &frame) != 0, let buffer = frame {
+            frame_buffer_release(buffer)
+        }
+        frame_queue_destroy(queue)
+    }
+
+    var capacity: Int { Int(frame_queue_capacity(queue)) }
+
+    /// Frames waiting (approximate while readers and workers run)
+    var count: Int { Int(frame_queue_size(queue)) }
+
+    // MARK: - Readers
+
+    /// Move a frame to the workers
+    /// - Returns: false if the queue was full; the frame is dropped then
+    @discardableResult
+    func enqueue(_ frame: consuming FrameHandle) -> Bool {
+        let reference = frame.escape()
+        if frame_queue_enqueue(queue, reference.buffer) != 0 {
+            return true
+        }
+        _ = FrameHandle(adopting: reference)
+        droppedLock.lock()  // Overflow only, never on the handoff itself
+        droppedFrames += 1
+        droppedLock.unlock()
+        return false
+    }
+
+    // MARK: - Workers
+
+    /// Take up to `batchSize` frames with one claim and hand each to `body`;
+    /// every frame is released after its call (share() it to keep it)
+    /// - Returns: Frames handled (0 if the queue was empty)
+    @discardableResult
+    func drain(_ body: (borrowing FrameHandle) -> Void) -> Int {
+        withUnsafeTemporaryAllocation(of: UnsafeMutablePointer<frame_buffer>?.self, capacity: batchSize) { frames in
+            let taken = Int(frame_queue_dequeue_batch(queue, frames.baseAddress, UInt32(batchSize)))
+            for index in 0..<taken {
+                let frame = FrameHandle(adopting: FrameReference(buffer: frames[index]!))
+                body(frame)
+            }
+            return taken
+        }
+    }
+}
@@ -0,0 +1,172 @@
+//
+//  SampleRing.c
+//  VeepaAudioTest
+//
+//  Created for capture → render sample handoff
+//  Purpose: SPSC int16 ring with CAS-claimed reads and drop-oldest overflow
+//
+
+#include "SampleRing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct sample_ring {
+    uint64_t write_pos;         ///< (atomic) Samples ever written; producer only
+    uint64_t written;           ///< (atomic)
+    uint64_t overflowed;        ///< (atomic)
+    uint8_t pad0[40];
+    uint64_t read_pos;          ///< (atomic) Samples ever consumed or dropped
+    uint64_t read;              ///< (atomic)
+    uint64_t underflowed;       ///< (atomic)
+    uint8_t pad1[40];
+    uint64_t capacity;
+    int16_t *samples;
+};
+
+#pragma mark - Lifecycle
+
+sample_ring *sample_ring_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+
+    sample_ring *ring = (sample_ring *)aligned_alloc(64, (sizeof(sample_ring) + 63) & ~(size_t)63);
+    if (ring == NULL) return NULL;
+    memset(ring, 0, sizeof(sample_ring));
+    ring->samples = (int16_t *)calloc(capacity, sizeof(int16_t));
+    if (ring->samples == NULL) {
+        free(ring);
+        return NULL;
+    }
+    ring->capacity = capacity;
+    return ring;
+}
+
+void sample_ring_destroy(sample_ring *ring) {
+    if (ring == NULL) return;
+    free(ring->samples);
+    free(ring);
+}
+
+uint32_t sample_ring_capacity(const sample_ring *ring) {
+    return (uint32_t)ring->capacity;
+}
+
+size_t sample_ring_available(const sample_ring *ring) {
+    // Read position first: it never passes the write position loaded after it
+    uint64_t read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+    uint64_t write_pos = __atomic_load_n(&ring->write_pos, __ATOMIC_ACQUIRE);
+    uint64_t available = write_pos - read_pos;
+    return (size_t)(available < ring->capacity ? available : ring->capacity);
+}
+
+#pragma mark - Producer
+
+size_t sample_ring_write(sample_ring *ring, const int16_t *samples, size_t count) {
+    if (count == 0) return 0;
+    size_t total = count;
+
+    // More than fits: only the newest capacity samples can survive
+    if (count > ring->capacity) {
+        size_t skipped = count - (size_t)ring->capacity;
+        samples += skipped;
+        count = (size_t)ring->capacity;
+        __atomic_fetch_add(&ring->overflowed, skipped, __ATOMIC_RELAXED);
+    }
+
+    uint64_t write_pos = __atomic_load_n(&ring->write_pos, __ATOMIC_RELAXED);
+    uint64_t end = write_pos + count;
+
+    // Claim the oldest unread samples before overwriting them
+    uint64_t read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+    while (end - read_pos > ring->capacity) {
+        uint64_t oldest = end - ring->capacity;
+        if (__atomic_compare_exchange_n(&ring->read_pos, &read_pos, oldest, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            __atomic_fetch_add(&ring->overflowed, oldest - read_pos, __ATOMIC_RELAXED);
+            break;
+        }
+        // read_pos reloaded by the failed CAS
+    }
+
+    size_t offset = (size_t)(write_pos % ring->capacity);
+    size_t first = (size_t)ring->capacity - offset;
+    if (first > count) first = count;
+    memcpy(ring->samples + offset, samples, first * sizeof(int16_t));
+    memcpy(ring->samples, samples + first, (count - first) * sizeof(int16_t));
+
+    __atomic_store_n(&ring->write_pos, end, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ring->written, total, __ATOMIC_RELAXED);
+    return total;
+}
+
+#pragma mark - Consumer
+
+size_t sample_ring_read(sample_ring *ring, int16_t *destination, size_t count) {
+    uint64_t read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+    size_t taken;
+    for (;;) {
+        uint64_t available = __atomic_load_n(&ring->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+        if (available > ring->capacity) {
+            // Overrun since read_pos was loaded: start again from the oldest sample
+            read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        taken = available < count ? (size_t)available : count;
+
+        size_t offset = (size_t)(read_pos % ring->capacity);
+        size_t first = (size_t)ring->capacity - offset;
+        if (first > taken) first = taken;
+        memcpy(destination, ring->samples + offset, first * sizeof(int16_t));
+        memcpy(destination + first, ring->samples, (taken - first) * sizeof(int16_t));
+
+        // Fails only if the producer dropped (and may have overwritten) what
+        // was copied, or another thread discarded it: copy again
+        if (__atomic_compare_exchange_n(&ring->read_pos, &read_pos, read_pos + taken, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+
+    if (taken < count) {
+        memset(destination + taken, 0, (count - taken) * sizeof(int16_t));
+        __atomic_fetch_add(&ring->underflowed, count - taken, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&ring->read, taken, __ATOMIC_RELAXED);
+    return taken;
+}
+
+size_t sample_ring_discard(sample_ring *ring, size_t count) {
+    uint64_t read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint64_t available = __atomic_load_n(&ring->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+        if (available > ring->capacity) {
+            read_pos = __atomic_load_n(&ring->read_pos, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        size_t dropped = available < count ? (size_t)available : count;
+        if (__atomic_compare_exchange_n(&ring->read_pos, &read_pos, read_pos + dropped, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return dropped;
+        }
+    }
+}
+
+void sample_ring_clear(sample_ring *ring) {
+    sample_ring_discard(ring, SIZE_MAX);
+}
+
+#pragma mark - Statistics
+
+void sample_ring_get_statistics(const sample_ring *ring, sample_ring_statistics *statistics) {
+    statistics->written = __atomic_load_n(&ring->written, __ATOMIC_RELAXED);
+    statistics->read = __atomic_load_n(&ring->read, __ATOMIC_RELAXED);
+    statistics->overflowed = __atomic_load_n(&ring->overflowed, __ATOMIC_RELAXED);
+    statistics->underflowed = __atomic_load_n(&ring->underflowed, __ATOMIC_RELAXED);
+}
+
+void sample_ring_reset_statistics(sample_ring *ring) {
+    __atomic_store_n(&ring->written, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->read, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->overflowed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->underflowed, 0, __ATOMIC_RELAXED);
+}
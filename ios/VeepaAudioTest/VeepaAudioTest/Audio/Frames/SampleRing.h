@@ -0,0 +1,84 @@
+//
+//  SampleRing.h
+//  VeepaAudioTest
+//
+//  Created for capture → render sample handoff
+//  Purpose: Lock-free single-producer/single-consumer ring of int16 samples
+//           between the capture thread and the audio render thread
+//
+//  Both positions are monotonically increasing 64-bit sample counts on
+//  cache lines of their own. The producer publishes samples with a release
+//  store of `write_pos`; the consumer copies them out and claims them with
+//  one CAS on `read_pos`. Neither side ever waits on the other.
+//
+//  Overflow drops the oldest samples (producer wins): the producer moves
+//  `read_pos` forward with the same CAS before it overwrites them. A
+//  consumer whose copy overlapped such an overwrite sees its CAS fail and
+//  copies again from the new position, so it never returns torn audio.
+//  Discard and clear use the same CAS and are safe from any thread.
+//
+//  Threading: one producer thread calls write, one consumer thread calls
+//  read. Levels, statistics, discard and clear are safe from any thread.
+//
+
+#ifndef SampleRing_h
+#define SampleRing_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sample_ring sample_ring;
+
+/// Counters since creation or the last reset (in samples)
+typedef struct {
+    uint64_t written;
+    uint64_t read;
+    uint64_t overflowed;         ///< Dropped unread to make room for newer samples
+    uint64_t underflowed;        ///< Requested by reads but not there (filled with silence)
+} sample_ring_statistics;
+
+/// @param capacity Samples held (any size)
+/// @return NULL if allocation fails
+sample_ring *sample_ring_create(uint32_t capacity);
+
+void sample_ring_destroy(sample_ring *ring);
+
+uint32_t sample_ring_capacity(const sample_ring *ring);
+
+/// Samples ready to read (any thread; a snapshot)
+size_t sample_ring_available(const sample_ring *ring);
+
+#pragma mark - Producer
+
+/// Copy samples in, dropping the oldest unread ones if the ring is full
+/// @return `count` (everything is written; what does not fit is the oldest)
+size_t sample_ring_write(sample_ring *ring, const int16_t *samples, size_t count);
+
+#pragma mark - Consumer
+
+/// Copy out up to `count` samples; the rest of `destination` is zeroed
+/// @return Samples read
+size_t sample_ring_read(sample_ring *ring, int16_t *destination, size_t count);
+
+/// Drop up to `count` of the oldest samples (any thread)
+/// @return Samples dropped
+size_t sample_ring_discard(sample_ring *ring, size_t count);
+
+/// Drop everything buffered (any thread)
+void sample_ring_clear(sample_ring *ring);
+
+#pragma mark - Statistics (any thread)
+
+void sample_ring_get_statistics(const sample_ring *ring, sample_ring_statistics *statistics);
+
+void sample_ring_reset_statistics(sample_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SampleRing_h */
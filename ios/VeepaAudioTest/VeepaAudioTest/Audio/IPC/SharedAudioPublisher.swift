@@ -0,0 +1,109 @@
+//
+//  SharedAudioPublisher.swift
+//  VeepaAudioTest
+//
+//  Created for cross-process audio publishing
+//  Purpose: Publish a stream's decoded audio to other local processes
+//           (analytics, recording services) through shared memory
+//
+//  Decoded frames are taken from AudioHookBridge and written once into the
+//  named ring of SharedAudioRing.c. Readers attach with
+//  shm_audio_reader_open("<streamName>") from any process and consume the
+//  frames in place - adding readers adds no work here.
+//
+
+import Foundation
+
+/// Writes one stream's decoded PCM into a named shared-memory ring
+final class SharedAudioPublisher {
+
+    enum PublisherError: Error, LocalizedError {
+        case invalidName(String)
+        case sharedMemory(String, errno: Int32)
+
+        var errorDescription: String? {
+            switch self {
+            case .invalidName(let name):
+                return "Invalid ring name \"\(name)\" (1-\(SHM_AUDIO_MAX_NAME) characters, no '/')"
+            case .sharedMemory(let name, let code):
+                return "Cannot create shared memory for \"\(name)\": \(String(cString: strerror(code)))"
+            }
+        }
+    }
+
+    /// Owns the C writer; the observer block retains it, so a frame being
+    /// written while `stop()` runs never touches an unmapped ring
+    private final class Handle {
+        let pointer: OpaquePointer
+
+        init(pointer: OpaquePointer) {
+            self.pointer = pointer
+        }
+
+        deinit {
+            shm_audio_writer_destroy(pointer)
+        }
+    }
+
+    // MARK: - Properties
+
+    let streamName: String
+    let sampleRate: Int
+    private let handle: Handle
+    private var observerToken: UInt?
+
+    var isRunning: Bool { observerToken != nil }
+
+    /// Frames (slots) written so far
+    var sequence: UInt64 { shm_audio_writer_sequence(handle.pointer) }
+
+    // MARK: - Initialization
+
+    /// Create the ring "/<streamName>" (replacing a stale one)
+    /// - Parameters:
+    ///   - streamName: Ring name readers open
+    ///   - sampleRate: Sample rate of the decoded stream
+    ///   - slotCount: Frames held for slow readers (rounded up to a power of two)
+    ///   - slotSamples: Largest frame stored in one slot
+    init(streamName: String = "veepa-cam0", sampleRate: Int = 16000,
+         slotCount: Int = 128, slotSamples: Int = 1024) throws {
+        var error: Int32 = 0
+        guard let pointer = shm_audio_writer_create(streamName, UInt32(sampleRate),
+                                                    UInt32(slotCount), UInt32(slotSamples), &error) else {
+            print("[SharedAudioPublisher] ❌ Cannot create ring \(streamName) (error \(error))")
+            if error == Int32(SHM_AUDIO_ERR_NAME) {
+                throw PublisherError.invalidName(streamName)
+            }
+            throw PublisherError.sharedMemory(streamName, errno: errno)
+        }
+
+        self.streamName = streamName
+        self.sampleRate = sampleRate
+        self.handle = Handle(pointer: pointer)
+        print("[SharedAudioPublisher] 🧩 Ring /\(streamName) ready (\(slotCount) slots × \(slotSamples) samples)")
+    }
+
+    deinit {
+        stop()
+    }
+
+    // MARK: - Control
+
+    /// Start writing decoded frames from AudioHookBridge
+    func start() {
+        guard observerToken == nil else { return }
+
+        let handle = self.handle
+        observerToken = AudioHookBridge.shared.addDecodedFrameObserver { samples, count, frameNo, timestampMs in
+            shm_audio_writer_publish(handle.pointer, samples, count, frameNo, timestampMs)
+        }
+        print("[SharedAudioPublisher] ▶️ Publishing to /\(streamName)")
+    }
+
+    func stop() {
+        guard let token = observerToken else { return }
+        AudioHookBridge.shared.removeDecodedFrameObserver(token)
+        observerToken = nil
+        print("[SharedAudioPublisher] ⏹️ Stopped after \(sequence) frames")
+    }
+}
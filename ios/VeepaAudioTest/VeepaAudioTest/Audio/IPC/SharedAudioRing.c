@@ -0,0 +1,399 @@
+//
+//  SharedAudioRing.c
+//  VeepaAudioTest
+//
+//  Created for cross-process audio publishing
+//  Purpose: Single-writer / multi-reader seqlock ring in POSIX shared memory
+//
+
+#include "SharedAudioRing.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <notify.h>
+#include <poll.h>
+#endif
+
+/// Slot 0 starts on the second page so the header can grow
+#define SHM_AUDIO_HEADER_SIZE 4096
+
+struct shm_audio_writer {
+    char path[SHM_AUDIO_MAX_NAME + 2];
+#if !defined(__linux__)
+    char notify_name[SHM_AUDIO_MAX_NAME + 32];
+#endif
+    uint8_t *base;
+    size_t size;
+    int fd;
+    shm_audio_ring_header *header;
+    uint64_t next_sequence;
+};
+
+struct shm_audio_reader {
+    const uint8_t *base;
+    size_t size;
+    const shm_audio_ring_header *header;
+    uint64_t next_sequence;
+    uint64_t lost;
+#if !defined(__linux__)
+    int notify_fd;
+    int notify_token;
+#endif
+};
+
+#pragma mark - Helpers
+
+static int make_path(const char *name, char *path, size_t capacity) {
+    size_t length = name ? strlen(name) : 0;
+    if (length == 0 || length > SHM_AUDIO_MAX_NAME || strchr(name, '/') != NULL) return -1;
+    snprintf(path, capacity, "/%s", name);
+    return 0;
+}
+
+#if !defined(__linux__)
+/// notify(3) name announcing commits to ring `name`
+static void make_notify_name(const char *name, char *out, size_t capacity) {
+    snprintf(out, capacity, "com.veepatest.audio-ring.%s", name);
+}
+#endif
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static uint32_t round_up_pow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value && result < (1u << 30)) result <<= 1;
+    return result;
+}
+
+static inline shm_audio_slot_header *slot_at(const uint8_t *base, const shm_audio_ring_header *header,
+                                             uint64_t sequence) {
+    size_t index = (size_t)(sequence & (header->slot_count - 1));
+    return (shm_audio_slot_header *)(base + header->header_size + index * header->slot_stride);
+}
+
+static void wake_readers(shm_audio_writer *writer) {
+    __atomic_fetch_add(&writer->header->notify, 1, __ATOMIC_RELEASE);
+#if defined(__linux__)
+    // Shared (non-private) futex: readers in other processes map the same page
+    syscall(SYS_futex, &writer->header->notify, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    notify_post(writer->notify_name);
+#endif
+}
+
+#pragma mark - Writer
+
+shm_audio_writer *shm_audio_writer_create(const char *name, uint32_t sample_rate,
+                                          uint32_t slot_count, uint32_t slot_samples, int *error) {
+    int dummy;
+    if (error == NULL) error = &dummy;
+
+    if (slot_count == 0 || slot_samples == 0 || sample_rate == 0) {
+        *error = SHM_AUDIO_ERR_ARGUMENT;
+        return NULL;
+    }
+
+    shm_audio_writer *writer = (shm_audio_writer *)calloc(1, sizeof(shm_audio_writer));
+    if (writer == NULL || make_path(name, writer->path, sizeof(writer->path)) < 0) {
+        free(writer);
+        *error = SHM_AUDIO_ERR_NAME;
+        return NULL;
+    }
+    writer->fd = -1;
+#if !defined(__linux__)
+    make_notify_name(name, writer->notify_name, sizeof(writer->notify_name));
+#endif
+
+    slot_count = round_up_pow2(slot_count);
+    size_t stride = (sizeof(shm_audio_slot_header) + (size_t)slot_samples * sizeof(int16_t) + 63) & ~(size_t)63;
+    writer->size = SHM_AUDIO_HEADER_SIZE + (size_t)slot_count * stride;
+
+    // Replace a ring left behind by a previous (crashed) writer; readers of
+    // the old one keep their mapping and see no new frames
+    shm_unlink(writer->path);
+    writer->fd = shm_open(writer->path, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (writer->fd < 0) goto fail;
+    if (ftruncate(writer->fd, (off_t)writer->size) < 0) goto fail;
+
+    writer->base = (uint8_t *)mmap(NULL, writer->size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (writer->base == MAP_FAILED) {
+        writer->base = NULL;
+        goto fail;
+    }
+
+    shm_audio_ring_header *header = (shm_audio_ring_header *)writer->base;
+    header->version = SHM_AUDIO_VERSION;
+    header->format = SHM_AUDIO_FORMAT_S16;
+    header->header_size = SHM_AUDIO_HEADER_SIZE;
+    header->sample_rate = sample_rate;
+    header->channels = 1;
+    header->slot_count = slot_count;
+    header->slot_samples = slot_samples;
+    header->slot_stride = (uint32_t)stride;
+    header->writer_pid = (uint32_t)getpid();
+    strncpy(header->stream, name, sizeof(header->stream) - 1);
+    // Magic last: a reader that sees it sees a complete header
+    __atomic_store_n(&header->magic, SHM_AUDIO_MAGIC, __ATOMIC_RELEASE);
+
+    writer->header = header;
+    *error = SHM_AUDIO_OK;
+    return writer;
+
+fail:
+    *error = SHM_AUDIO_ERR_SHM;
+    if (writer->fd >= 0) {
+        close(writer->fd);
+        shm_unlink(writer->path);
+    }
+    free(writer);
+    return NULL;
+}
+
+void shm_audio_writer_destroy(shm_audio_writer *writer) {
+    if (writer == NULL) return;
+
+    __atomic_store_n(&writer->header->closed, 1, __ATOMIC_RELEASE);
+    wake_readers(writer);
+
+    munmap(writer->base, writer->size);
+    close(writer->fd);
+    shm_unlink(writer->path);
+    free(writer);
+}
+
+uint64_t shm_audio_writer_publish(shm_audio_writer *writer, const int16_t *samples, uint32_t count,
+                                  uint32_t frame_no, uint32_t timestamp_ms) {
+    shm_audio_ring_header *header = writer->header;
+    uint64_t host_time = monotonic_ns();
+    uint32_t offset = 0;
+
+    do {
+        uint64_t sequence = writer->next_sequence++;
+        uint32_t chunk = count - offset;
+        if (chunk > header->slot_samples) chunk = header->slot_samples;
+
+        shm_audio_slot_header *slot = slot_at(writer->base, header, sequence);
+
+        // Seqlock: odd while writing, then 2*seq+2 once complete
+        __atomic_store_n(&slot->state, 2 * sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        slot->sequence = sequence;
+        slot->host_time_ns = host_time;
+        slot->frame_no = frame_no;
+        slot->timestamp_ms = timestamp_ms;
+        slot->sample_count = chunk;
+        slot->flags = (offset + chunk < count) ? SHM_AUDIO_FRAME_CONTINUED : 0;
+        memcpy((uint8_t *)(slot + 1), samples + offset, (size_t)chunk * sizeof(int16_t));
+
+        __atomic_store_n(&slot->state, 2 * sequence + 2, __ATOMIC_RELEASE);
+        __atomic_store_n(&header->write_sequence, sequence + 1, __ATOMIC_RELEASE);
+
+        offset += chunk;
+    } while (offset < count);
+
+    wake_readers(writer);
+    return writer->next_sequence - 1;
+}
+
+uint64_t shm_audio_writer_sequence(const shm_audio_writer *writer) {
+    return writer->next_sequence;
+}
+
+#pragma mark - Reader
+
+shm_audio_reader *shm_audio_reader_open(const char *name, int *error) {
+    int dummy;
+    if (error == NULL) error = &dummy;
+
+    char path[SHM_AUDIO_MAX_NAME + 2];
+    if (make_path(name, path, sizeof(path)) < 0) {
+        *error = SHM_AUDIO_ERR_NAME;
+        return NULL;
+    }
+
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        *error = SHM_AUDIO_ERR_SHM;
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t)info.st_size < SHM_AUDIO_HEADER_SIZE) {
+        close(fd);
+        *error = SHM_AUDIO_ERR_FORMAT;
+        return NULL;
+    }
+
+    size_t size = (size_t)info.st_size;
+    const uint8_t *base = (const uint8_t *)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the object alive
+    if (base == MAP_FAILED) {
+        *error = SHM_AUDIO_ERR_SHM;
+        return NULL;
+    }
+
+    const shm_audio_ring_header *header = (const shm_audio_ring_header *)base;
+    uint32_t slot_count = header->slot_count;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_AUDIO_MAGIC ||
+        header->version != SHM_AUDIO_VERSION || header->format != SHM_AUDIO_FORMAT_S16 ||
+        slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+        header->slot_stride < sizeof(shm_audio_slot_header) + (size_t)header->slot_samples * sizeof(int16_t) ||
+        (size_t)header->header_size + (size_t)slot_count * header->slot_stride > size) {
+        munmap((void *)base, size);
+        *error = SHM_AUDIO_ERR_FORMAT;
+        return NULL;
+    }
+
+    shm_audio_reader *reader = (shm_audio_reader *)calloc(1, sizeof(shm_audio_reader));
+    if (reader == NULL) {
+        munmap((void *)base, size);
+        *error = SHM_AUDIO_ERR_ARGUMENT;
+        return NULL;
+    }
+    reader->base = base;
+    reader->size = size;
+    reader->header = header;
+    reader->next_sequence = __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+
+#if !defined(__linux__)
+    char notify_name[SHM_AUDIO_MAX_NAME + 32];
+    make_notify_name(name, notify_name, sizeof(notify_name));
+    reader->notify_fd = -1;
+    if (notify_register_file_descriptor(notify_name, &reader->notify_fd, 0, &reader->notify_token) != NOTIFY_STATUS_OK) {
+        reader->notify_fd = -1;  // shm_audio_reader_wait falls back to polling
+    }
+#endif
+
+    *error = SHM_AUDIO_OK;
+    return reader;
+}
+
+void shm_audio_reader_close(shm_audio_reader *reader) {
+    if (reader == NULL) return;
+#if !defined(__linux__)
+    if (reader->notify_fd >= 0) notify_cancel(reader->notify_token);
+#endif
+    munmap((void *)reader->base, reader->size);
+    free(reader);
+}
+
+const shm_audio_ring_header *shm_audio_reader_header(const shm_audio_reader *reader) {
+    return reader->header;
+}
+
+int shm_audio_reader_next(shm_audio_reader *reader, shm_audio_frame_view *view) {
+    const shm_audio_ring_header *header = reader->header;
+
+    for (;;) {
+        uint64_t written = __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+        if (reader->next_sequence >= written) return SHM_AUDIO_EMPTY;
+
+        // Lapped: skip to the oldest frame the ring still holds
+        if (written - reader->next_sequence > header->slot_count) {
+            uint64_t oldest = written - header->slot_count;
+            reader->lost += oldest - reader->next_sequence;
+            reader->next_sequence = oldest;
+        }
+
+        uint64_t sequence = reader->next_sequence++;
+        const shm_audio_slot_header *slot = slot_at(reader->base, header, sequence);
+        if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != 2 * sequence + 2) {
+            reader->lost++;  // Overwritten since write_sequence was read
+            continue;
+        }
+
+        uint32_t count = slot->sample_count;
+        view->sequence = sequence;
+        view->host_time_ns = slot->host_time_ns;
+        view->frame_no = slot->frame_no;
+        view->timestamp_ms = slot->timestamp_ms;
+        view->sample_count = count <= header->slot_samples ? count : header->slot_samples;
+        view->flags = slot->flags;
+        view->samples = (const int16_t *)(slot + 1);
+        view->lost = reader->lost;
+        reader->lost = 0;
+        return SHM_AUDIO_FRAME;
+    }
+}
+
+int shm_audio_reader_validate(const shm_audio_reader *reader, const shm_audio_frame_view *view) {
+    const shm_audio_slot_header *slot = slot_at(reader->base, reader->header, view->sequence);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->state, __ATOMIC_RELAXED) == 2 * view->sequence + 2;
+}
+
+uint32_t shm_audio_reader_read(shm_audio_reader *reader, int16_t *samples, uint32_t capacity,
+                               shm_audio_frame_view *info) {
+    shm_audio_frame_view view;
+    uint64_t lost = 0;
+
+    while (shm_audio_reader_next(reader, &view) == SHM_AUDIO_FRAME) {
+        lost += view.lost;
+        uint32_t count = view.sample_count < capacity ? view.sample_count : capacity;
+        memcpy(samples, view.samples, (size_t)count * sizeof(int16_t));
+        if (!shm_audio_reader_validate(reader, &view)) {
+            lost++;
+            continue;
+        }
+        view.lost = lost;
+        view.samples = samples;
+        if (info != NULL) *info = view;
+        return count;
+    }
+
+    reader->lost += lost;  // Report on the next frame
+    return 0;
+}
+
+int shm_audio_reader_wait(shm_audio_reader *reader, int timeout_ms) {
+    const shm_audio_ring_header *header = reader->header;
+    uint64_t deadline = monotonic_ns() + (uint64_t)(timeout_ms < 0 ? 0 : timeout_ms) * 1000000ull;
+
+    for (;;) {
+        uint32_t notify = __atomic_load_n(&header->notify, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE) > reader->next_sequence) return 1;
+        if (__atomic_load_n(&header->closed, __ATOMIC_ACQUIRE)) return -1;
+
+        uint64_t now = monotonic_ns();
+        if (now >= deadline) return 0;
+        uint64_t remaining = deadline - now;
+
+#if defined(__linux__)
+        struct timespec timeout = { (time_t)(remaining / 1000000000ull), (long)(remaining % 1000000000ull) };
+        // Returns immediately if a commit bumped `notify` since it was loaded
+        syscall(SYS_futex, &header->notify, FUTEX_WAIT, notify, &timeout, NULL, 0);
+#else
+        (void)notify;
+        if (reader->notify_fd >= 0) {
+            struct pollfd descriptor = { reader->notify_fd, POLLIN, 0 };
+            int wait_ms = (int)((remaining + 999999) / 1000000);
+            if (poll(&descriptor, 1, wait_ms) > 0) {
+                int token;
+                while (read(reader->notify_fd, &token, sizeof(token)) == sizeof(token)) {
+                    if (poll(&descriptor, 1, 0) <= 0) break;
+                }
+            }
+        } else {
+            usleep(remaining > 2000000 ? 2000 : (useconds_t)(remaining / 1000));
+        }
+#endif
+    }
+}
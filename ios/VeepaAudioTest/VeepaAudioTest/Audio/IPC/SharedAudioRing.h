@@ -0,0 +1,164 @@
+//
+//  SharedAudioRing.h
+//  VeepaAudioTest
+//
+//  Created for cross-process audio publishing
+//  Purpose: Publish decoded per-stream audio into a named shared-memory ring
+//           that any number of local processes map read-only
+//
+//  One writer, any number of readers, no sockets and no per-reader copies:
+//  the writer copies each frame into the ring once and readers consume it
+//  in place from their own read-only mapping. Readers never write to the
+//  ring, so a stalled or crashed reader cannot affect the writer or other
+//  readers - a reader that falls more than slot_count frames behind is
+//  told how many frames it lost and resumes at the oldest frame still held.
+//
+//  Layout (shm object "/<name>", little-endian, host-aligned):
+//    shm_audio_ring_header   one page
+//    slot_count × slot       shm_audio_slot_header + slot_samples int16
+//
+//  Each slot is a seqlock: `state` is 2*seq+1 while frame `seq` is being
+//  written and 2*seq+2 once it is complete. Readers check `state` before
+//  and after using the samples. `write_sequence` counts committed frames.
+//  Fields marked (atomic) are accessed with acquire/release semantics.
+//
+//  Wakeups: Linux readers wait on the `notify` word with a shared futex;
+//  Darwin readers register for "com.veepatest.audio-ring.<name>" (notify(3)).
+//
+
+#ifndef SharedAudioRing_h
+#define SharedAudioRing_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHM_AUDIO_MAGIC             0x52534156u  /* "VASR" */
+#define SHM_AUDIO_VERSION           1
+#define SHM_AUDIO_FORMAT_S16        1
+/// Darwin limits shm names to 31 bytes including the leading '/'
+#define SHM_AUDIO_MAX_NAME          30
+
+/// Slot flag: the frame was larger than a slot; more chunks follow
+#define SHM_AUDIO_FRAME_CONTINUED   0x1
+
+/// Ring header (first page of the shared-memory object)
+typedef struct {
+    uint32_t magic;              ///< SHM_AUDIO_MAGIC
+    uint16_t version;            ///< SHM_AUDIO_VERSION
+    uint16_t format;             ///< SHM_AUDIO_FORMAT_S16
+    uint32_t header_size;        ///< Offset of slot 0
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t slot_count;         ///< Power of two
+    uint32_t slot_samples;       ///< Sample capacity of each slot
+    uint32_t slot_stride;        ///< Bytes per slot including its header
+    uint32_t writer_pid;
+    uint32_t reserved;
+    char     stream[32];         ///< NUL-terminated stream name
+
+    uint64_t write_sequence __attribute__((aligned(64)));  ///< (atomic) Frames committed
+    uint32_t notify;             ///< (atomic) Incremented per commit; futex word
+    uint32_t closed;             ///< (atomic) Writer has shut down
+} shm_audio_ring_header;
+
+/// Per-slot header, followed by slot_samples int16 samples
+typedef struct {
+    uint64_t state;              ///< (atomic) Seqlock word, see above
+    uint64_t sequence;           ///< Ring sequence number of this frame
+    uint64_t host_time_ns;       ///< Writer's CLOCK_MONOTONIC at publish
+    uint32_t frame_no;           ///< app_frame_header.frameno
+    uint32_t timestamp_ms;       ///< app_frame_header.timestamp
+    uint32_t sample_count;
+    uint32_t flags;              ///< SHM_AUDIO_FRAME_*
+} shm_audio_slot_header;
+
+/// Error codes (negative return values)
+enum {
+    SHM_AUDIO_OK            = 0,
+    SHM_AUDIO_ERR_NAME      = -1,  ///< Name empty, too long or contains '/'
+    SHM_AUDIO_ERR_SHM       = -2,  ///< shm_open/ftruncate/mmap failed (see errno)
+    SHM_AUDIO_ERR_FORMAT    = -3,  ///< Not a ring, or an unsupported version
+    SHM_AUDIO_ERR_ARGUMENT  = -4,
+};
+
+/// Results of shm_audio_reader_next
+enum {
+    SHM_AUDIO_FRAME         = 1,   ///< A frame view was returned
+    SHM_AUDIO_EMPTY         = 0,   ///< Nothing new yet
+};
+
+#pragma mark - Writer
+
+typedef struct shm_audio_writer shm_audio_writer;
+
+/// Create (or replace) the ring "/<name>"
+/// @param slot_count Frames held; rounded up to a power of two
+/// @param slot_samples Largest frame in one slot; larger frames are chunked
+/// @param error Receives a SHM_AUDIO_ERR_* code on failure (may be NULL)
+shm_audio_writer *shm_audio_writer_create(const char *name, uint32_t sample_rate,
+                                          uint32_t slot_count, uint32_t slot_samples, int *error);
+
+/// Mark the ring closed, wake readers and unlink the name
+/// (readers keep their mapping until they close it)
+void shm_audio_writer_destroy(shm_audio_writer *writer);
+
+/// Copy one frame into the ring and wake waiting readers
+/// Wait-free: never blocks on readers. Single writer thread only.
+/// @return Ring sequence number of the (last chunk of the) frame
+uint64_t shm_audio_writer_publish(shm_audio_writer *writer, const int16_t *samples, uint32_t count,
+                                  uint32_t frame_no, uint32_t timestamp_ms);
+
+/// Frames committed so far
+uint64_t shm_audio_writer_sequence(const shm_audio_writer *writer);
+
+#pragma mark - Reader
+
+typedef struct shm_audio_reader shm_audio_reader;
+
+/// Zero-copy view of one frame inside the reader's mapping
+typedef struct {
+    uint64_t sequence;
+    uint64_t host_time_ns;
+    uint32_t frame_no;
+    uint32_t timestamp_ms;
+    uint32_t sample_count;
+    uint32_t flags;
+    const int16_t *samples;      ///< Valid until shm_audio_reader_validate says otherwise
+    uint64_t lost;               ///< Frames overwritten before this reader got to them
+} shm_audio_frame_view;
+
+/// Map the ring "/<name>" read-only; the reader starts with the next frame published
+/// @param error Receives a SHM_AUDIO_ERR_* code on failure (may be NULL)
+shm_audio_reader *shm_audio_reader_open(const char *name, int *error);
+
+void shm_audio_reader_close(shm_audio_reader *reader);
+
+/// Ring parameters as published by the writer
+const shm_audio_ring_header *shm_audio_reader_header(const shm_audio_reader *reader);
+
+/// Return the next unread frame in place (no copy)
+/// @return SHM_AUDIO_FRAME or SHM_AUDIO_EMPTY
+int shm_audio_reader_next(shm_audio_reader *reader, shm_audio_frame_view *view);
+
+/// After using view->samples: 1 if the writer has not overwritten them meanwhile
+/// (if 0, discard what was computed from the view; `lost` on the next frame says how much was missed)
+int shm_audio_reader_validate(const shm_audio_reader *reader, const shm_audio_frame_view *view);
+
+/// Copying convenience: next frame into `samples` (validated)
+/// @return Samples copied, 0 if nothing new
+uint32_t shm_audio_reader_read(shm_audio_reader *reader, int16_t *samples, uint32_t capacity,
+                               shm_audio_frame_view *info);
+
+/// Block until a frame newer than the last one read is committed
+/// @return 1 if data is available, 0 on timeout, -1 if the writer has closed the ring
+int shm_audio_reader_wait(shm_audio_reader *reader, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SharedAudioRing_h */
@@ -0,0 +1,268 @@
+//
+//  CongestionController.swift
+//  VeepaAudioTest
+//
+//  Created for congestion-aware bitrate adaptation
+//  Purpose: Step the camera down to cheaper audio settings while the link
+//           loses frames or jitters, and back up once it is clean again
+//
+//  Settings form a ladder from the negotiated ones (G.711a, 64 kbit/s per
+//  8 kHz) down through ADPCM at half the payload to longer ADPCM frames,
+//  which also cut the per-packet overhead. Each period the controller
+//  reads the session's frame, loss and jitter counters (SessionTable
+//  columns, via AudioHookBridge.frameActivity):
+//
+//  - congested (loss or jitter above the degrade thresholds) for
+//    `degradeAfter` periods in a row: one rung down
+//  - clean (both below the much lower recover thresholds) for
+//    `recoverAfter` periods in a row: one rung up
+//  - anything between resets both streaks
+//
+//  After any switch the controller waits `minDwell` before switching
+//  again. A step up that is followed by congestion within its own probe
+//  time doubles the clean streak the next step up needs (up to
+//  `maxRecoverAfter`), so a link that only just carries the better
+//  setting is not switched back and forth.
+//
+//  The switch is seamless at the decoder: AudioHookBridge decodes each
+//  frame in the codec it arrived in (see expectFrameCodec), and ADPCM
+//  frames carry their own predictor state. It tells the codecs apart by
+//  payload size, so neighbouring rungs never share one (ADPCM at 2N ms is
+//  as many bytes as G.711a at N ms).
+//
+
+import Foundation
+
+/// Adapts camera audio settings to link quality with hysteresis
+final class CongestionController {
+
+    // MARK: - Types
+
+    struct Configuration {
+        /// Evaluation period
+        var interval: TimeInterval = 1
+
+        var degradeLossRatio = 0.03
+        var degradeJitterMs = 60.0
+        var recoverLossRatio = 0.005
+        var recoverJitterMs = 20.0
+
+        /// Consecutive congested periods before stepping down
+        var degradeAfter = 2
+        /// Consecutive clean periods before stepping up (doubles after a failed step up)
+        var recoverAfter = 10
+        var maxRecoverAfter = 80
+
+        /// Minimum time between switches
+        var minDwell: TimeInterval = 3
+
+        /// Jitter thresholds scaled to the profile's latency budget: a
+        /// profile with an 80 ms ring cannot ride out the jitter a 2 s one can
+        init(for profile: PlayoutProfile = .standard) {
+            degradeJitterMs = max(Double(profile.jitterMaxMs) / 4, 30)
+            recoverJitterMs = degradeJitterMs / 3
+        }
+    }
+
+    /// Cumulative per-session counters
+    struct Statistics {
+        var frames: UInt64
+        var lostFrames: UInt64
+        var jitterMs: Double
+
+        init(frames: UInt64, lostFrames: UInt64, jitterMs: Double) {
+            self.frames = frames
+            self.lostFrames = lostFrames
+            self.jitterMs = jitterMs
+        }
+
+        init(_ activity: AudioFrameActivity) {
+            self.init(frames: activity.frames, lostFrames: activity.lostFrames, jitterMs: activity.jitterMs)
+        }
+    }
+
+    enum Condition: Equatable {
+        case congested
+        case clean
+        case fair
+    }
+
+    // MARK: - Properties
+
+    let configuration: Configuration
+
+    /// Settings from best to cheapest
+    let ladder: [AudioStreamParameters]
+
+    /// Current rung of `ladder`
+    private(set) var level = 0
+
+    var current: AudioStreamParameters { ladder[level] }
+
+    /// Switches so far (down, up)
+    private(set) var switches = (down: 0, up: 0)
+
+    private var previous: Statistics?
+    private var congestedStreak = 0
+    private var cleanStreak = 0
+    private var lastSwitch = -Double.infinity
+    private var lastStepUp: TimeInterval?
+    private var recoverAfter: Int
+
+    private var timer: Timer?
+    private var applying = false
+
+    // MARK: - Initialization
+
+    init(ladder: [AudioStreamParameters], configuration: Configuration = Configuration()) {
+        precondition(!ladder.isEmpty, "A ladder needs at least the starting settings")
+        self.ladder = ladder
+        self.configuration = configuration
+        self.recoverAfter = configuration.recoverAfter
+    }
+
+    /// Rungs below the settings chosen for `profile`: the same frames in
+    /// ADPCM, then up to `longerFrames` longer ADPCM frame durations. A rung
+    /// with the payload size of the one above it is left out: the capture
+    /// path could not tell when the camera switched to it.
+    static func ladder(from capabilities: AudioCapabilities, for profile: PlayoutProfile,
+                       maxSampleRate: Int = 16000, longerFrames: Int = 2) -> [AudioStreamParameters] {
+        guard let start = AudioParameterNegotiator.choose(from: capabilities, for: profile,
+                                                          maxSampleRate: maxSampleRate) else {
+            return []
+        }
+
+        var rungs = [start]
+        func add(_ rung: AudioStreamParameters) {
+            if rung.frameBytes != rungs[rungs.count - 1].frameBytes {
+                rungs.append(rung)
+            }
+        }
+        let cheapest: AudioCodec = capabilities.codecs.contains(.adpcm) ? .adpcm : start.codec
+        if cheapest != start.codec {
+            add(AudioStreamParameters(codec: cheapest, sampleRate: start.sampleRate, frameMs: start.frameMs))
+        }
+        for frameMs in capabilities.frameMs.filter({ $0 > start.frameMs }).prefix(longerFrames) {
+            add(AudioStreamParameters(codec: cheapest, sampleRate: start.sampleRate, frameMs: frameMs))
+        }
+        return rungs
+    }
+
+    // MARK: - Evaluation
+
+    /// Classify one period from the change in the counters
+    func condition(from old: Statistics, to new: Statistics) -> Condition {
+        let received = new.frames &- old.frames
+        let lost = new.lostFrames &- old.lostFrames
+        // Nothing at all arrived: a stall is the strongest congestion signal
+        guard received > 0 else { return .congested }
+
+        let lossRatio = Double(lost) / Double(received + lost)
+        if lossRatio >= configuration.degradeLossRatio || new.jitterMs >= configuration.degradeJitterMs {
+            return .congested
+        }
+        if lossRatio <= configuration.recoverLossRatio && new.jitterMs <= configuration.recoverJitterMs {
+            return .clean
+        }
+        return .fair
+    }
+
+    /// Feed one period's counters
+    /// - Parameter time: Seconds on any monotonic clock
+    /// - Returns: New settings to apply, or nil to stay
+    func update(_ statistics: Statistics, at time: TimeInterval) -> AudioStreamParameters? {
+        defer { previous = statistics }
+        // Wait for the stream to start before judging it
+        guard let previous = previous, previous.frames > 0 else { return nil }
+
+        switch condition(from: previous, to: statistics) {
+        case .congested:
+            congestedStreak += 1
+            cleanStreak = 0
+        case .clean:
+            cleanStreak += 1
+            congestedStreak = 0
+        case .fair:
+            congestedStreak = 0
+            cleanStreak = 0
+        }
+
+        // A step up that held for its whole probe time restores the base streak
+        if let stepUp = lastStepUp, time - stepUp >= Double(recoverAfter) * configuration.interval {
+            recoverAfter = configuration.recoverAfter
+            lastStepUp = nil
+        }
+
+        guard time - lastSwitch >= configuration.minDwell else { return nil }
+
+        if congestedStreak >= configuration.degradeAfter && level + 1 < ladder.count {
+            if lastStepUp != nil {
+                recoverAfter = min(recoverAfter * 2, configuration.maxRecoverAfter)
+                lastStepUp = nil
+            }
+            return step(to: level + 1, at: time)
+        }
+        if cleanStreak >= recoverAfter && level > 0 {
+            lastStepUp = time
+            return step(to: level - 1, at: time)
+        }
+        return nil
+    }
+
+    private func step(to newLevel: Int, at time: TimeInterval) -> AudioStreamParameters {
+        if newLevel > level { switches.down += 1 } else { switches.up += 1 }
+        level = newLevel
+        lastSwitch = time
+        congestedStreak = 0
+        cleanStreak = 0
+        return ladder[newLevel]
+    }
+
+    /// Undo the last switch (the camera refused it)
+    private func revert(to oldLevel: Int) {
+        level = oldLevel
+        lastStepUp = nil
+    }
+
+    // MARK: - Live Adaptation
+
+    var isRunning: Bool { timer != nil }
+
+    /// Evaluate AudioHookBridge's stream every `interval` and apply
+    /// switches through `negotiator` (main thread)
+    /// - Parameter onSwitch: Called after the camera accepted new settings,
+    ///   e.g. to resize the engine's jitter bounds for a new frame duration
+    func start(negotiator: AudioParameterNegotiator, onSwitch: @escaping (AudioStreamParameters) -> Void) {
+        guard timer == nil else { return }
+        print("[CongestionController] 📶 Adapting over \(ladder.map(String.init(describing:)).joined(separator: " → "))")
+
+        let started = ProcessInfo.processInfo.systemUptime
+        timer = Timer.scheduledTimer(withTimeInterval: configuration.interval, repeats: true) { [weak self] _ in
+            guard let self = self, !self.applying else { return }
+            let statistics = Statistics(AudioHookBridge.shared.frameActivity())
+            let oldLevel = self.level
+            guard let parameters = self.update(statistics, at: ProcessInfo.processInfo.systemUptime - started) else {
+                return
+            }
+
+            print("[CongestionController] 📶 \(self.ladder[oldLevel]) → \(parameters) "
+                  + "(jitter \(String(format: "%.0f", statistics.jitterMs)) ms)")
+            self.applying = true
+            Task { @MainActor in
+                defer { self.applying = false }
+                do {
+                    try await negotiator.apply(parameters, verify: false)
+                    onSwitch(parameters)
+                } catch {
+                    print("[CongestionController] ⚠️ Switch failed: \(error.localizedDescription)")
+                    self.revert(to: oldLevel)
+                }
+            }
+        }
+    }
+
+    func stop() {
+        timer?.invalidate()
+        timer = nil
+    }
+}
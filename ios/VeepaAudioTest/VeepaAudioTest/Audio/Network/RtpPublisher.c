@@ -0,0 +1,327 @@
+//
+//  RtpPublisher.c
+//  VeepaAudioTest
+//
+//  Created for RTP republishing
+//  Purpose: RTP/PCMA packetizer and batched UDP fan-out
+//
+
+#if defined(__linux__)
+#define _GNU_SOURCE  // sendmmsg
+#endif
+
+#include "RtpPublisher.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    struct sockaddr_storage address;
+    socklen_t length;
+} rtp_subscriber;
+
+struct rtp_publisher {
+    pthread_mutex_t lock;
+
+    int socket4;
+    int socket6;                 ///< Opened on the first IPv6 subscriber
+    rtp_subscriber subscribers[RTP_MAX_SUBSCRIBERS];
+    uint32_t subscriber_count;
+
+    uint32_t sample_rate;
+    uint8_t payload_type;
+    uint32_t ssrc;
+
+    // Stream state
+    int started;
+    uint16_t sequence;
+    uint32_t rtp_timestamp;
+    uint32_t last_frame_no;
+    uint32_t last_timestamp_ms;
+    uint32_t last_length;
+
+    rtp_publisher_stats stats;
+};
+
+#pragma mark - Helpers
+
+static uint32_t rtp_random32(void) {
+#if defined(__APPLE__)
+    return arc4random();
+#else
+    static int seeded = 0;
+    if (!seeded) {
+        srandom((unsigned)time(NULL) ^ (unsigned)getpid());
+        seeded = 1;
+    }
+    return ((uint32_t)random() << 16) ^ (uint32_t)random();
+#endif
+}
+
+static int open_udp_socket(int family) {
+    int fd = socket(family, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) return -1;
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    return fd;
+}
+
+static int parse_address(const char *host, uint16_t port, rtp_subscriber *out) {
+    memset(out, 0, sizeof(*out));
+
+    struct sockaddr_in *v4 = (struct sockaddr_in *)&out->address;
+    if (inet_pton(AF_INET, host, &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        out->length = sizeof(*v4);
+        return 0;
+    }
+
+    struct sockaddr_in6 *v6 = (struct sockaddr_in6 *)&out->address;
+    if (inet_pton(AF_INET6, host, &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        out->length = sizeof(*v6);
+        return 0;
+    }
+    return -1;
+}
+
+static void write_header(const rtp_publisher *p, int marker, uint16_t sequence, uint32_t timestamp,
+                         uint8_t header[RTP_HEADER_SIZE]) {
+    header[0] = 0x80;  // V=2, no padding/extension/CSRC
+    header[1] = (uint8_t)((marker ? 0x80 : 0) | p->payload_type);
+    header[2] = (uint8_t)(sequence >> 8);
+    header[3] = (uint8_t)sequence;
+    header[4] = (uint8_t)(timestamp >> 24);
+    header[5] = (uint8_t)(timestamp >> 16);
+    header[6] = (uint8_t)(timestamp >> 8);
+    header[7] = (uint8_t)timestamp;
+    header[8] = (uint8_t)(p->ssrc >> 24);
+    header[9] = (uint8_t)(p->ssrc >> 16);
+    header[10] = (uint8_t)(p->ssrc >> 8);
+    header[11] = (uint8_t)p->ssrc;
+}
+
+#pragma mark - Sending
+
+/// Send one packet (header + payload, gathered) to every subscriber of one family
+/// @return Datagrams sent
+static int send_to_family(rtp_publisher *p, int family, int fd, struct iovec iov[2]) {
+    if (fd < 0) return 0;
+
+#if defined(__linux__)
+    struct mmsghdr messages[RTP_MAX_SUBSCRIBERS];
+    unsigned count = 0;
+    for (uint32_t i = 0; i < p->subscriber_count; i++) {
+        rtp_subscriber *s = &p->subscribers[i];
+        if (s->address.ss_family != family) continue;
+        memset(&messages[count], 0, sizeof(messages[count]));
+        messages[count].msg_hdr.msg_name = &s->address;
+        messages[count].msg_hdr.msg_namelen = s->length;
+        messages[count].msg_hdr.msg_iov = iov;
+        messages[count].msg_hdr.msg_iovlen = 2;
+        count++;
+    }
+
+    // sendmmsg stops at the first failing datagram; skip it and continue
+    int sent = 0;
+    unsigned next = 0;
+    while (next < count) {
+        int n = sendmmsg(fd, messages + next, count - next, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            p->stats.send_errors++;
+            next++;
+        } else {
+            sent += n;
+            next += (unsigned)n;
+        }
+    }
+    return sent;
+#else
+    int sent = 0;
+    for (uint32_t i = 0; i < p->subscriber_count; i++) {
+        rtp_subscriber *s = &p->subscribers[i];
+        if (s->address.ss_family != family) continue;
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_name = &s->address;
+        message.msg_namelen = s->length;
+        message.msg_iov = iov;
+        message.msg_iovlen = 2;
+
+        if (sendmsg(fd, &message, MSG_DONTWAIT) >= 0) {
+            sent++;
+        } else {
+            p->stats.send_errors++;
+        }
+    }
+    return sent;
+#endif
+}
+
+#pragma mark - Public API
+
+rtp_publisher *rtp_publisher_create(uint32_t sample_rate) {
+    if (sample_rate == 0) return NULL;
+
+    rtp_publisher *p = calloc(1, sizeof(rtp_publisher));
+    if (p == NULL) return NULL;
+
+    p->socket4 = open_udp_socket(AF_INET);
+    p->socket6 = -1;
+    if (p->socket4 < 0) {
+        free(p);
+        return NULL;
+    }
+
+    pthread_mutex_init(&p->lock, NULL);
+    p->sample_rate = sample_rate;
+    p->payload_type = sample_rate == 8000 ? RTP_PAYLOAD_TYPE_PCMA : RTP_PAYLOAD_TYPE_DYNAMIC;
+    p->ssrc = rtp_random32();
+    p->stats.ssrc = p->ssrc;
+    return p;
+}
+
+void rtp_publisher_destroy(rtp_publisher *p) {
+    if (p == NULL) return;
+    if (p->socket4 >= 0) close(p->socket4);
+    if (p->socket6 >= 0) close(p->socket6);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+}
+
+uint8_t rtp_publisher_payload_type(const rtp_publisher *p) {
+    return p->payload_type;
+}
+
+int rtp_publisher_add_subscriber(rtp_publisher *p, const char *host, uint16_t port) {
+    rtp_subscriber subscriber;
+    if (parse_address(host, port, &subscriber) != 0) return -1;
+
+    pthread_mutex_lock(&p->lock);
+    int status = -1;
+    for (uint32_t i = 0; i < p->subscriber_count; i++) {
+        if (p->subscribers[i].length == subscriber.length &&
+            memcmp(&p->subscribers[i].address, &subscriber.address, subscriber.length) == 0) {
+            status = 0;  // Already subscribed
+            goto done;
+        }
+    }
+    if (p->subscriber_count >= RTP_MAX_SUBSCRIBERS) goto done;
+    if (subscriber.address.ss_family == AF_INET6 && p->socket6 < 0) {
+        p->socket6 = open_udp_socket(AF_INET6);
+        if (p->socket6 < 0) goto done;
+    }
+
+    p->subscribers[p->subscriber_count++] = subscriber;
+    p->stats.subscribers = p->subscriber_count;
+    status = 0;
+
+done:
+    pthread_mutex_unlock(&p->lock);
+    return status;
+}
+
+int rtp_publisher_remove_subscriber(rtp_publisher *p, const char *host, uint16_t port) {
+    rtp_subscriber subscriber;
+    if (parse_address(host, port, &subscriber) != 0) return -1;
+
+    pthread_mutex_lock(&p->lock);
+    int status = -1;
+    for (uint32_t i = 0; i < p->subscriber_count; i++) {
+        if (p->subscribers[i].length == subscriber.length &&
+            memcmp(&p->subscribers[i].address, &subscriber.address, subscriber.length) == 0) {
+            p->subscribers[i] = p->subscribers[--p->subscriber_count];
+            p->stats.subscribers = p->subscriber_count;
+            status = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return status;
+}
+
+int rtp_publisher_publish(rtp_publisher *p, const uint8_t *alaw, uint32_t length,
+                          uint32_t frame_no, uint32_t timestamp_ms) {
+    if (alaw == NULL || length == 0) return 0;
+
+    pthread_mutex_lock(&p->lock);
+
+    int marker = 0;
+    if (!p->started) {
+        p->started = 1;
+        p->sequence = (uint16_t)rtp_random32();
+        p->rtp_timestamp = rtp_random32();
+        marker = 1;  // Start of the talkspurt
+    } else {
+        uint32_t delta = frame_no - p->last_frame_no;
+        if (delta == 0) {
+            pthread_mutex_unlock(&p->lock);
+            return 0;  // Duplicate
+        }
+
+        // Small forward gaps are loss; anything else is a stream restart
+        uint32_t missing = delta < 0x8000 ? delta - 1 : 0;
+        p->stats.upstream_lost += missing;
+        p->sequence = (uint16_t)(p->sequence + missing);
+
+        uint32_t elapsedMs = timestamp_ms - p->last_timestamp_ms;
+        if (timestamp_ms != 0 && p->last_timestamp_ms != 0 && elapsedMs > 0 && elapsedMs < 10000) {
+            p->rtp_timestamp += (uint32_t)((uint64_t)elapsedMs * p->sample_rate / 1000);
+        } else {
+            p->rtp_timestamp += p->last_length * (missing + 1);
+        }
+        marker = missing > 0 || delta >= 0x8000;
+    }
+    p->last_frame_no = frame_no;
+    p->last_timestamp_ms = timestamp_ms;
+    p->last_length = length;
+    p->stats.frames++;
+
+    // Payloads above the MTU budget go out as consecutive packets
+    int sent = 0;
+    for (uint32_t offset = 0; offset < length; offset += RTP_MAX_PAYLOAD) {
+        uint32_t chunk = length - offset < RTP_MAX_PAYLOAD ? length - offset : RTP_MAX_PAYLOAD;
+        uint8_t header[RTP_HEADER_SIZE];
+        write_header(p, marker && offset == 0, p->sequence++, p->rtp_timestamp + offset, header);
+
+        struct iovec iov[2] = {
+            { header, RTP_HEADER_SIZE },
+            { (void *)(alaw + offset), chunk },
+        };
+        int datagrams = send_to_family(p, AF_INET, p->socket4, iov) +
+                        send_to_family(p, AF_INET6, p->socket6, iov);
+
+        p->stats.packets++;
+        p->stats.datagrams += (uint64_t)datagrams;
+        p->stats.bytes += (uint64_t)datagrams * (RTP_HEADER_SIZE + chunk);
+        sent += datagrams;
+    }
+
+    pthread_mutex_unlock(&p->lock);
+    return sent;
+}
+
+void rtp_publisher_get_stats(rtp_publisher *p, rtp_publisher_stats *stats) {
+    pthread_mutex_lock(&p->lock);
+    *stats = p->stats;
+    pthread_mutex_unlock(&p->lock);
+}
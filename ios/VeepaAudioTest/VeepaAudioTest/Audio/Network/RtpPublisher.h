@@ -0,0 +1,80 @@
+//
+//  RtpPublisher.h
+//  VeepaAudioTest
+//
+//  Created for RTP republishing
+//  Purpose: Republish camera G.711 A-law frames as RTP/PCMA to local UDP
+//           subscribers - no decode, no re-encode
+//
+//  The A-law payload goes out exactly as it arrived. Per packet the only
+//  work is a 12-byte RTP header and one batched send to every subscriber
+//  (sendmmsg on Linux; one sendmsg per subscriber with a header+payload
+//  iovec on Darwin, which has no sendmmsg). The payload is never copied.
+//
+//  RTP timestamps follow the camera clock: app_frame_header.timestamp (ms)
+//  when it advances, otherwise the sample count of the previous frame.
+//  Gaps in frameno advance the sequence number too, so receivers' loss
+//  statistics include loss upstream of this device.
+//
+
+#ifndef RtpPublisher_h
+#define RtpPublisher_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// RFC 3551 static payload type for PCMA (8 kHz only)
+#define RTP_PAYLOAD_TYPE_PCMA       8
+/// Dynamic payload type used for PCMA at other rates (announced in the SDP)
+#define RTP_PAYLOAD_TYPE_DYNAMIC    96
+
+#define RTP_HEADER_SIZE             12
+#define RTP_MAX_PAYLOAD             1200
+#define RTP_MAX_SUBSCRIBERS         32
+
+typedef struct rtp_publisher rtp_publisher;
+
+typedef struct {
+    uint64_t frames;          ///< Frames published
+    uint64_t packets;         ///< RTP packets built
+    uint64_t datagrams;       ///< Datagrams sent (packets × subscribers)
+    uint64_t bytes;           ///< Bytes sent including RTP headers
+    uint64_t send_errors;     ///< Datagrams the kernel refused (full buffer, no route)
+    uint64_t upstream_lost;   ///< Frames missing from the camera's frameno sequence
+    uint32_t subscribers;
+    uint32_t ssrc;
+} rtp_publisher_stats;
+
+/// Create a publisher with its own non-blocking UDP socket
+/// @param sample_rate A-law sample rate; PT 8 at 8000 Hz, PT 96 otherwise
+/// @return NULL if the socket cannot be created
+rtp_publisher *rtp_publisher_create(uint32_t sample_rate);
+
+void rtp_publisher_destroy(rtp_publisher *publisher);
+
+/// Payload type in use (RTP_PAYLOAD_TYPE_PCMA or RTP_PAYLOAD_TYPE_DYNAMIC)
+uint8_t rtp_publisher_payload_type(const rtp_publisher *publisher);
+
+/// Add a UDP subscriber (IPv4 or IPv6 literal)
+/// @return 0, or -1 for a bad address / full subscriber table
+int rtp_publisher_add_subscriber(rtp_publisher *publisher, const char *host, uint16_t port);
+
+/// Remove a subscriber; returns 0 if it was present
+int rtp_publisher_remove_subscriber(rtp_publisher *publisher, const char *host, uint16_t port);
+
+/// Packetize and send one received frame (safe to call from the capture thread)
+/// @return Number of datagrams sent
+int rtp_publisher_publish(rtp_publisher *publisher, const uint8_t *alaw, uint32_t length,
+                          uint32_t frame_no, uint32_t timestamp_ms);
+
+void rtp_publisher_get_stats(rtp_publisher *publisher, rtp_publisher_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RtpPublisher_h */
@@ -0,0 +1,131 @@
+//
+//  RtpRepublisher.swift
+//  VeepaAudioTest
+//
+//  Created for RTP republishing
+//  Purpose: Forward camera audio to local VMS/SIP consumers as RTP/PCMA
+//
+//  Camera audio already is G.711 A-law, so frames are taken from
+//  AudioHookBridge before decoding and sent on unchanged (RtpPublisher.c).
+//  Consumers that cannot take the payload type from an SDP should run the
+//  camera at 8 kHz, where the static PT 8 applies.
+//
+
+import Foundation
+
+/// Republishes received A-law frames as RTP to UDP subscribers
+final class RtpRepublisher {
+
+    struct Subscriber: Hashable {
+        let host: String
+        let port: UInt16
+    }
+
+    /// Owns the C publisher; observer blocks retain it, so a frame being
+    /// sent while `stop()` runs never touches a freed publisher
+    private final class Handle {
+        let pointer: OpaquePointer
+
+        init?(sampleRate: Int) {
+            guard let pointer = rtp_publisher_create(UInt32(sampleRate)) else { return nil }
+            self.pointer = pointer
+        }
+
+        deinit {
+            rtp_publisher_destroy(pointer)
+        }
+    }
+
+    // MARK: - Properties
+
+    let sampleRate: Int
+    private let handle: Handle
+    private var observerToken: UInt?
+    private(set) var subscribers: Set<Subscriber> = []
+
+    var isRunning: Bool { observerToken != nil }
+
+    /// RTP payload type (8 at 8 kHz, dynamic 96 otherwise)
+    var payloadType: UInt8 { rtp_publisher_payload_type(handle.pointer) }
+
+    var stats: rtp_publisher_stats {
+        var stats = rtp_publisher_stats()
+        rtp_publisher_get_stats(handle.pointer, &stats)
+        return stats
+    }
+
+    // MARK: - Initialization
+
+    /// - Parameter sampleRate: Sample rate of the camera's A-law stream
+    init?(sampleRate: Int = 16000) {
+        guard let handle = Handle(sampleRate: sampleRate) else {
+            print("[RtpRepublisher] ❌ Could not create UDP socket")
+            return nil
+        }
+        self.sampleRate = sampleRate
+        self.handle = handle
+    }
+
+    deinit {
+        stop()
+    }
+
+    // MARK: - Subscribers
+
+    /// Add a UDP subscriber (IPv4/IPv6 literal, e.g. "127.0.0.1")
+    @discardableResult
+    func addSubscriber(host: String = "127.0.0.1", port: UInt16) -> Bool {
+        guard rtp_publisher_add_subscriber(handle.pointer, host, port) == 0 else {
+            print("[RtpRepublisher] ❌ Cannot add subscriber \(host):\(port)")
+            return false
+        }
+        subscribers.insert(Subscriber(host: host, port: port))
+        print("[RtpRepublisher] ➕ Subscriber \(host):\(port)")
+        return true
+    }
+
+    func removeSubscriber(host: String = "127.0.0.1", port: UInt16) {
+        rtp_publisher_remove_subscriber(handle.pointer, host, port)
+        subscribers.remove(Subscriber(host: host, port: port))
+    }
+
+    // MARK: - Control
+
+    /// Start forwarding frames from AudioHookBridge
+    func start() {
+        guard observerToken == nil else { return }
+
+        let handle = self.handle
+        observerToken = AudioHookBridge.shared.addRawFrameObserver { alaw, length, frameNo, timestampMs in
+            rtp_publisher_publish(handle.pointer, alaw, length, frameNo, timestampMs)
+        }
+        print("[RtpRepublisher] ▶️ Publishing PCMA/\(sampleRate) as PT \(payloadType) to \(subscribers.count) subscriber(s)")
+    }
+
+    func stop() {
+        guard let token = observerToken else { return }
+        AudioHookBridge.shared.removeRawFrameObserver(token)
+        observerToken = nil
+
+        let stats = self.stats
+        print("[RtpRepublisher] ⏹️ Stopped: \(stats.frames) frames, \(stats.datagrams) datagrams, \(stats.send_errors) send errors")
+    }
+
+    // MARK: - SDP
+
+    /// Session description for one subscriber (open with VLC/ffplay, or hand to the VMS)
+    func sdp(for subscriber: Subscriber) -> String {
+        let family = subscriber.host.contains(":") ? "IP6" : "IP4"
+        return """
+        v=0
+        o=- \(stats.ssrc) 0 IN \(family) \(subscriber.host)
+        s=Veepa camera audio
+        c=IN \(family) \(subscriber.host)
+        t=0 0
+        m=audio \(subscriber.port) RTP/AVP \(payloadType)
+        a=rtpmap:\(payloadType) PCMA/\(sampleRate)
+        a=recvonly
+
+        """
+    }
+}
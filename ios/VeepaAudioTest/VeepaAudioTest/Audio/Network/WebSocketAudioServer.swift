@@ -0,0 +1,173 @@
+//
+//  WebSocketAudioServer.swift
+//  VeepaAudioTest
+//
+//  Created for WebSocket live audio
+//  Purpose: Serve the camera's live audio to browsers and tools over WebSocket
+//
+//  Frames are taken from AudioHookBridge once - raw A-law before decoding, or
+//  the PCM the app already decoded for playback - and handed to the C fan-out
+//  server (WebSocketFanout.c). Adding listeners adds no work to the capture
+//  thread: each frame is framed once and every connection sends it by
+//  reference from the server's own event-loop thread.
+//
+//  Listeners connect to ws://<host>:<port>/ and first receive a JSON text
+//  message describing the stream, then one binary message per frame:
+//  frameNo (u32 LE) | timestampMs (u32 LE) | audio.
+//
+
+import Foundation
+
+/// Fans live camera audio out to WebSocket listeners
+final class WebSocketAudioServer {
+
+    enum Payload {
+        /// Camera G.711 A-law bytes, unchanged (1 byte per sample)
+        case alaw
+        /// Decoded 16-bit little-endian PCM
+        case pcm16
+
+        var codecName: String {
+            switch self {
+            case .alaw: return "pcma"
+            case .pcm16: return "pcm_s16le"
+            }
+        }
+    }
+
+    enum SlowClientPolicy {
+        /// Close listeners that fall `maxQueuedFrames` behind
+        case disconnect
+        /// Keep them connected and skip frames until they catch up
+        case skipFrames
+    }
+
+    enum ServerError: Error, LocalizedError {
+        case cannotListen(port: UInt16)
+
+        var errorDescription: String? {
+            switch self {
+            case .cannotListen(let port):
+                return "Cannot listen for WebSocket connections on port \(port)"
+            }
+        }
+    }
+
+    /// Owns the C server; observer blocks retain it, so a frame being
+    /// published while `stop()` runs never touches a freed server
+    private final class Handle {
+        let pointer: OpaquePointer
+
+        init?(config: inout ws_fanout_config) {
+            guard let pointer = ws_fanout_create(&config) else { return nil }
+            self.pointer = pointer
+        }
+
+        deinit {
+            ws_fanout_destroy(pointer)
+        }
+    }
+
+    // MARK: - Properties
+
+    let payload: Payload
+    let sampleRate: Int
+    private let handle: Handle
+    private var observerToken: UInt?
+
+    var isRunning: Bool { observerToken != nil }
+
+    /// Bound TCP port (useful when created with port 0)
+    var port: UInt16 { ws_fanout_port(handle.pointer) }
+
+    var stats: ws_fanout_stats {
+        var stats = ws_fanout_stats()
+        ws_fanout_get_stats(handle.pointer, &stats)
+        return stats
+    }
+
+    // MARK: - Initialization
+
+    /// Start listening (frames flow once `start()` is called)
+    /// - Parameters:
+    ///   - port: TCP port; 0 picks a free one
+    ///   - payload: Send A-law as received or decoded PCM
+    ///   - sampleRate: Stream sample rate announced to listeners
+    ///   - loopbackOnly: Accept connections from this device only
+    ///   - maxClients: Concurrent listeners (at most WS_FANOUT_MAX_CLIENTS)
+    ///   - maxQueuedFrames: How far a listener may fall behind before `policy` applies
+    ///   - policy: What to do with slow listeners
+    init(
+        port: UInt16 = 0,
+        payload: Payload = .pcm16,
+        sampleRate: Int = 16000,
+        loopbackOnly: Bool = true,
+        maxClients: Int = 16,
+        maxQueuedFrames: Int = 50,
+        policy: SlowClientPolicy = .disconnect
+    ) throws {
+        let hello = """
+        {"type":"format","codec":"\(payload.codecName)","sampleRate":\(sampleRate),"channels":1,\
+        "prefix":["frameNo:u32le","timestampMs:u32le"]}
+        """
+
+        var config = ws_fanout_config()
+        ws_fanout_config_init(&config)
+        config.port = port
+        config.loopback_only = loopbackOnly ? 1 : 0
+        config.max_clients = UInt32(maxClients)
+        config.max_queued_frames = UInt32(maxQueuedFrames)
+        config.policy = policy == .disconnect ? WS_SLOW_CLIENT_DISCONNECT : WS_SLOW_CLIENT_SKIP_FRAMES
+
+        // The C server copies the hello string during create
+        let created: Handle? = hello.withCString { text in
+            config.hello = text
+            return Handle(config: &config)
+        }
+        guard let handle = created else {
+            print("[WebSocketAudioServer] ❌ Cannot listen on port \(port)")
+            throw ServerError.cannotListen(port: port)
+        }
+
+        self.payload = payload
+        self.sampleRate = sampleRate
+        self.handle = handle
+        print("[WebSocketAudioServer] 🌐 Listening on port \(ws_fanout_port(handle.pointer)) (\(payload.codecName)/\(sampleRate))")
+    }
+
+    deinit {
+        stop()
+    }
+
+    // MARK: - Control
+
+    /// Start publishing frames from AudioHookBridge
+    func start() {
+        guard observerToken == nil else { return }
+
+        let handle = self.handle
+        switch payload {
+        case .alaw:
+            observerToken = AudioHookBridge.shared.addRawFrameObserver { alaw, length, frameNo, timestampMs in
+                ws_fanout_publish(handle.pointer, alaw, length, frameNo, timestampMs)
+            }
+        case .pcm16:
+            observerToken = AudioHookBridge.shared.addDecodedFrameObserver { samples, count, frameNo, timestampMs in
+                ws_fanout_publish(handle.pointer, samples, count * 2, frameNo, timestampMs)
+            }
+        }
+        print("[WebSocketAudioServer] ▶️ Publishing to ws://127.0.0.1:\(port)/")
+    }
+
+    func stop() {
+        guard let token = observerToken else { return }
+        switch payload {
+        case .alaw: AudioHookBridge.shared.removeRawFrameObserver(token)
+        case .pcm16: AudioHookBridge.shared.removeDecodedFrameObserver(token)
+        }
+        observerToken = nil
+
+        let stats = self.stats
+        print("[WebSocketAudioServer] ⏹️ Stopped: \(stats.frames_published) frames, \(stats.connections) connections, \(stats.clients_dropped) slow listeners dropped")
+    }
+}
@@ -0,0 +1,902 @@
+//
+//  WebSocketFanout.c
+//  VeepaAudioTest
+//
+//  Created for WebSocket live audio
+//  Purpose: Edge-triggered WebSocket fan-out server (kqueue/epoll)
+//
+
+#include "WebSocketFanout.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define WS_SEND_FLAGS MSG_NOSIGNAL
+#else
+#include <sys/event.h>
+#define WS_SEND_FLAGS 0
+#endif
+
+/// Bytes buffered from a client: the HTTP request, then control frames
+#define WS_INPUT_CAPACITY   4096
+/// Buffers handed to one sendmsg call
+#define WS_IOV_BATCH        64
+/// Frames waiting for the loop thread
+#define WS_PENDING_CAPACITY 64
+#define WS_EVENT_BATCH      64
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/// One framed message shared by every client queue that references it
+typedef struct {
+    atomic_int refs;
+    uint32_t length;
+    uint8_t bytes[];
+} ws_buffer;
+
+typedef enum {
+    WS_CLIENT_HANDSHAKE = 0,
+    WS_CLIENT_OPEN,
+    WS_CLIENT_CLOSING,      ///< Flushing a final response, then close
+    WS_CLIENT_CLOSED,       ///< Freed at the end of the event batch
+} ws_client_state;
+
+typedef struct ws_client {
+    int fd;
+    ws_client_state state;
+    int writable;
+
+    ws_buffer *queue[WS_FANOUT_QUEUE_CAPACITY];
+    uint32_t head;
+    uint32_t count;
+    uint32_t offset;        ///< Bytes of queue[head] already sent
+
+    uint8_t input[WS_INPUT_CAPACITY];
+    size_t input_length;
+
+    struct ws_client *next;
+} ws_client;
+
+struct ws_fanout_server {
+    ws_fanout_config config;
+    char *hello;
+
+    int listen_fd;
+    int poll_fd;
+#if defined(__linux__)
+    int wake_fd;
+#endif
+    uint16_t port;
+
+    pthread_t thread;
+    atomic_int running;
+
+    // Publisher → loop thread handoff
+    pthread_mutex_t pending_lock;
+    ws_buffer *pending[WS_PENDING_CAPACITY];
+    uint32_t pending_head;
+    uint32_t pending_count;
+
+    // Loop thread only
+    ws_client *clients;
+    ws_client *closed;
+    uint32_t client_count;
+
+    struct {
+        atomic_uint_fast64_t frames_published;
+        atomic_uint_fast64_t messages_sent;
+        atomic_uint_fast64_t bytes_sent;
+        atomic_uint_fast64_t frames_skipped;
+        atomic_uint_fast64_t clients_dropped;
+        atomic_uint_fast64_t connections;
+        atomic_uint_fast64_t rejected;
+        atomic_uint_fast64_t publish_overruns;
+        atomic_uint_fast32_t clients;
+    } stats;
+};
+
+/// Poller tags for the two non-client descriptors
+static char kListenTag;
+static char kWakeTag;
+
+#define STAT_ADD(server, field, value) \
+    atomic_fetch_add_explicit(&(server)->stats.field, (value), memory_order_relaxed)
+
+#pragma mark - SHA-1 / Base64 (handshake only)
+
+typedef struct {
+    uint32_t h[5];
+    uint64_t length;
+    uint8_t block[64];
+    size_t used;
+} sha1_context;
+
+static uint32_t rol32(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1_block(sha1_context *ctx, const uint8_t *block) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = ctx->h[0], b = ctx->h[1], c = ctx->h[2], d = ctx->h[3], e = ctx->h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+        uint32_t t = rol32(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = rol32(b, 30); b = a; a = t;
+    }
+    ctx->h[0] += a; ctx->h[1] += b; ctx->h[2] += c; ctx->h[3] += d; ctx->h[4] += e;
+}
+
+static void sha1_init(sha1_context *ctx) {
+    ctx->h[0] = 0x67452301; ctx->h[1] = 0xEFCDAB89; ctx->h[2] = 0x98BADCFE;
+    ctx->h[3] = 0x10325476; ctx->h[4] = 0xC3D2E1F0;
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+static void sha1_update(sha1_context *ctx, const void *data, size_t length) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    ctx->length += length;
+    while (length > 0) {
+        size_t take = 64 - ctx->used;
+        if (take > length) take = length;
+        memcpy(ctx->block + ctx->used, bytes, take);
+        ctx->used += take;
+        bytes += take;
+        length -= take;
+        if (ctx->used == 64) {
+            sha1_block(ctx, ctx->block);
+            ctx->used = 0;
+        }
+    }
+}
+
+static void sha1_final(sha1_context *ctx, uint8_t digest[20]) {
+    uint64_t bits = ctx->length * 8;
+    uint8_t pad = 0x80;
+    sha1_update(ctx, &pad, 1);
+    pad = 0;
+    while (ctx->used != 56) sha1_update(ctx, &pad, 1);
+    uint8_t size[8];
+    for (int i = 0; i < 8; i++) size[i] = (uint8_t)(bits >> (56 - i * 8));
+    sha1_update(ctx, size, 8);
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = (uint8_t)(ctx->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)ctx->h[i];
+    }
+}
+
+void ws_fanout_accept_key(const char *key, size_t key_length, char accept[29]) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    sha1_context ctx;
+    uint8_t digest[21] = {0};
+    sha1_init(&ctx);
+    sha1_update(&ctx, key, key_length);
+    sha1_update(&ctx, WS_GUID, strlen(WS_GUID));
+    sha1_final(&ctx, digest);
+
+    // 20 bytes → 28 base64 characters (last group has one '=' of padding)
+    char *out = accept;
+    for (int i = 0; i < 21; i += 3) {
+        uint32_t group = ((uint32_t)digest[i] << 16) | ((uint32_t)digest[i + 1] << 8) | digest[i + 2];
+        *out++ = alphabet[(group >> 18) & 63];
+        *out++ = alphabet[(group >> 12) & 63];
+        *out++ = alphabet[(group >> 6) & 63];
+        *out++ = alphabet[group & 63];
+    }
+    accept[27] = '=';
+    accept[28] = '\0';
+}
+
+#pragma mark - Buffers
+
+static ws_buffer *buffer_create(uint32_t length) {
+    ws_buffer *buffer = (ws_buffer *)malloc(sizeof(ws_buffer) + length);
+    if (buffer == NULL) return NULL;
+    atomic_init(&buffer->refs, 1);
+    buffer->length = length;
+    return buffer;
+}
+
+static void buffer_retain(ws_buffer *buffer) {
+    atomic_fetch_add_explicit(&buffer->refs, 1, memory_order_relaxed);
+}
+
+static void buffer_release(ws_buffer *buffer) {
+    if (atomic_fetch_sub_explicit(&buffer->refs, 1, memory_order_acq_rel) == 1) {
+        free(buffer);
+    }
+}
+
+/// Write a server (unmasked, FIN) frame header; returns its size
+static size_t write_frame_header(uint8_t *out, uint8_t opcode, uint64_t length) {
+    out[0] = (uint8_t)(0x80 | opcode);
+    if (length < 126) {
+        out[1] = (uint8_t)length;
+        return 2;
+    }
+    if (length <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = (uint8_t)(length >> 8);
+        out[3] = (uint8_t)length;
+        return 4;
+    }
+    out[1] = 127;
+    for (int i = 0; i < 8; i++) out[2 + i] = (uint8_t)(length >> (56 - i * 8));
+    return 10;
+}
+
+/// Build a complete message: header + prefix + payload in one buffer
+static ws_buffer *message_create(uint8_t opcode, const void *prefix, size_t prefix_length,
+                                 const void *payload, size_t length) {
+    uint8_t header[10];
+    size_t header_length = write_frame_header(header, opcode, prefix_length + length);
+    ws_buffer *buffer = buffer_create((uint32_t)(header_length + prefix_length + length));
+    if (buffer == NULL) return NULL;
+
+    memcpy(buffer->bytes, header, header_length);
+    if (prefix_length > 0) memcpy(buffer->bytes + header_length, prefix, prefix_length);
+    if (length > 0) memcpy(buffer->bytes + header_length + prefix_length, payload, length);
+    return buffer;
+}
+
+static ws_buffer *raw_create(const char *text) {
+    size_t length = strlen(text);
+    ws_buffer *buffer = buffer_create((uint32_t)length);
+    if (buffer != NULL) memcpy(buffer->bytes, text, length);
+    return buffer;
+}
+
+#pragma mark - Poller
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return -1;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return 0;
+}
+
+/// Normalized readiness event
+typedef struct {
+    void *tag;
+    int readable;
+    int writable;
+    int hangup;
+} ws_event;
+
+static int poller_create(ws_fanout_server *server) {
+#if defined(__linux__)
+    server->poll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server->poll_fd < 0) return -1;
+
+    server->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server->wake_fd < 0) return -1;
+
+    struct epoll_event listen_event = { .events = EPOLLIN | EPOLLET, .data.ptr = &kListenTag };
+    struct epoll_event wake_event = { .events = EPOLLIN | EPOLLET, .data.ptr = &kWakeTag };
+    if (epoll_ctl(server->poll_fd, EPOLL_CTL_ADD, server->listen_fd, &listen_event) < 0) return -1;
+    if (epoll_ctl(server->poll_fd, EPOLL_CTL_ADD, server->wake_fd, &wake_event) < 0) return -1;
+    return 0;
+#else
+    server->poll_fd = kqueue();
+    if (server->poll_fd < 0) return -1;
+    fcntl(server->poll_fd, F_SETFD, FD_CLOEXEC);
+
+    struct kevent changes[2];
+    EV_SET(&changes[0], server->listen_fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, &kListenTag);
+    EV_SET(&changes[1], 1, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, &kWakeTag);
+    return kevent(server->poll_fd, changes, 2, NULL, 0, NULL) < 0 ? -1 : 0;
+#endif
+}
+
+static int poller_add_client(ws_fanout_server *server, ws_client *client) {
+#if defined(__linux__)
+    struct epoll_event event = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = client };
+    return epoll_ctl(server->poll_fd, EPOLL_CTL_ADD, client->fd, &event);
+#else
+    struct kevent changes[2];
+    EV_SET(&changes[0], client->fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, client);
+    EV_SET(&changes[1], client->fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, client);
+    return kevent(server->poll_fd, changes, 2, NULL, 0, NULL);
+#endif
+}
+
+static void poller_wake(ws_fanout_server *server) {
+#if defined(__linux__)
+    uint64_t one = 1;
+    ssize_t ignored = write(server->wake_fd, &one, sizeof(one));
+    (void)ignored;
+#else
+    struct kevent change;
+    EV_SET(&change, 1, EVFILT_USER, 0, NOTE_TRIGGER, 0, &kWakeTag);
+    kevent(server->poll_fd, &change, 1, NULL, 0, NULL);
+#endif
+}
+
+static void poller_drain_wake(ws_fanout_server *server) {
+#if defined(__linux__)
+    uint64_t value;
+    while (read(server->wake_fd, &value, sizeof(value)) > 0) {}
+#else
+    (void)server;  // EV_CLEAR resets the user event
+#endif
+}
+
+/// Block for events; returns the number written to `events`
+static int poller_wait(ws_fanout_server *server, ws_event *events, int capacity) {
+#if defined(__linux__)
+    struct epoll_event raw[WS_EVENT_BATCH];
+    int n = epoll_wait(server->poll_fd, raw, capacity < WS_EVENT_BATCH ? capacity : WS_EVENT_BATCH, -1);
+    for (int i = 0; i < n; i++) {
+        events[i].tag = raw[i].data.ptr;
+        events[i].readable = (raw[i].events & EPOLLIN) != 0;
+        events[i].writable = (raw[i].events & EPOLLOUT) != 0;
+        events[i].hangup = (raw[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+    }
+    return n;
+#else
+    struct kevent raw[WS_EVENT_BATCH];
+    int n = kevent(server->poll_fd, NULL, 0, raw, capacity < WS_EVENT_BATCH ? capacity : WS_EVENT_BATCH, NULL);
+    for (int i = 0; i < n; i++) {
+        events[i].tag = raw[i].udata;
+        events[i].readable = raw[i].filter == EVFILT_READ || raw[i].filter == EVFILT_USER;
+        events[i].writable = raw[i].filter == EVFILT_WRITE;
+        // EOF on the read side is handled by read() returning 0
+        events[i].hangup = (raw[i].flags & EV_ERROR) != 0;
+    }
+    return n;
+#endif
+}
+
+#pragma mark - Clients
+
+static void client_close(ws_fanout_server *server, ws_client *client) {
+    if (client->state == WS_CLIENT_CLOSED) return;
+
+    // Unlink now; free after the event batch (other events may still name it)
+    ws_client **link = &server->clients;
+    while (*link != NULL && *link != client) link = &(*link)->next;
+    if (*link == client) *link = client->next;
+
+    close(client->fd);  // Also removes it from the poller
+    client->fd = -1;
+    client->state = WS_CLIENT_CLOSED;
+
+    for (uint32_t i = 0; i < client->count; i++) {
+        buffer_release(client->queue[(client->head + i) % WS_FANOUT_QUEUE_CAPACITY]);
+    }
+    client->count = 0;
+
+    client->next = server->closed;
+    server->closed = client;
+    server->client_count--;
+    atomic_store_explicit(&server->stats.clients, server->client_count, memory_order_relaxed);
+}
+
+/// Queue a buffer reference; returns -1 if the hard capacity is reached
+static int client_enqueue(ws_client *client, ws_buffer *buffer) {
+    if (client->count == WS_FANOUT_QUEUE_CAPACITY) return -1;
+    buffer_retain(buffer);
+    client->queue[(client->head + client->count) % WS_FANOUT_QUEUE_CAPACITY] = buffer;
+    client->count++;
+    return 0;
+}
+
+/// Send as much of the queue as the socket takes (until EAGAIN)
+static void client_flush(ws_fanout_server *server, ws_client *client) {
+    while (client->count > 0 && client->writable) {
+        struct iovec iov[WS_IOV_BATCH];
+        int n = 0;
+        for (uint32_t i = 0; i < client->count && n < WS_IOV_BATCH; i++) {
+            ws_buffer *buffer = client->queue[(client->head + i) % WS_FANOUT_QUEUE_CAPACITY];
+            uint32_t skip = (i == 0) ? client->offset : 0;
+            iov[n].iov_base = buffer->bytes + skip;
+            iov[n].iov_len = buffer->length - skip;
+            n++;
+        }
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = n;
+
+        ssize_t sent = sendmsg(client->fd, &message, WS_SEND_FLAGS);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                client->writable = 0;  // Wait for the next writable edge
+                return;
+            }
+            client_close(server, client);
+            return;
+        }
+        STAT_ADD(server, bytes_sent, (uint64_t)sent);
+
+        size_t left = (size_t)sent;
+        while (left > 0) {
+            ws_buffer *buffer = client->queue[client->head];
+            size_t remaining = buffer->length - client->offset;
+            if (left < remaining) {
+                client->offset += (uint32_t)left;
+                break;
+            }
+            left -= remaining;
+            buffer_release(buffer);
+            client->head = (client->head + 1) % WS_FANOUT_QUEUE_CAPACITY;
+            client->count--;
+            client->offset = 0;
+            STAT_ADD(server, messages_sent, 1);
+        }
+    }
+
+    if (client->count == 0 && client->state == WS_CLIENT_CLOSING) {
+        client_close(server, client);
+    }
+}
+
+/// Queue a one-off message for a single client
+static void client_send(ws_fanout_server *server, ws_client *client, ws_buffer *buffer) {
+    if (buffer == NULL) {
+        client_close(server, client);
+        return;
+    }
+    if (client_enqueue(client, buffer) < 0) {
+        client_close(server, client);
+    }
+    buffer_release(buffer);
+}
+
+/// Reply with an HTTP error and close once it is sent
+static void client_reject(ws_fanout_server *server, ws_client *client, const char *response) {
+    STAT_ADD(server, rejected, 1);
+    client->state = WS_CLIENT_CLOSING;
+    client_send(server, client, raw_create(response));
+    if (client->state != WS_CLIENT_CLOSED) client_flush(server, client);
+}
+
+/// Case-insensitive header lookup; returns the trimmed value
+static const char *find_header(const char *request, const char *name, size_t *value_length) {
+    size_t name_length = strlen(name);
+    for (const char *line = strstr(request, "\r\n"); line != NULL; line = strstr(line + 2, "\r\n")) {
+        const char *field = line + 2;
+        if (strncasecmp(field, name, name_length) != 0 || field[name_length] != ':') continue;
+
+        const char *value = field + name_length + 1;
+        while (*value == ' ' || *value == '\t') value++;
+        const char *end = strstr(value, "\r\n");
+        if (end == NULL) return NULL;
+        while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        *value_length = (size_t)(end - value);
+        return value;
+    }
+    return NULL;
+}
+
+static void client_handshake(ws_fanout_server *server, ws_client *client) {
+    client->input[client->input_length] = '\0';
+    const char *request = (const char *)client->input;
+    const char *end = strstr(request, "\r\n\r\n");
+    if (end == NULL) {
+        if (client->input_length >= WS_INPUT_CAPACITY - 1) {
+            client_reject(server, client, "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\n\r\n");
+        }
+        return;  // Wait for the rest of the request
+    }
+
+    size_t key_length = 0;
+    const char *key = find_header(request, "Sec-WebSocket-Key", &key_length);
+    if (strncmp(request, "GET ", 4) != 0 || key == NULL || key_length == 0 || key_length > 64) {
+        client_reject(server, client,
+                      "HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\n"
+                      "Sec-WebSocket-Version: 13\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+        return;
+    }
+
+    char accept[29];
+    ws_fanout_accept_key(key, key_length, accept);
+
+    char response[256];
+    snprintf(response, sizeof(response),
+             "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+             "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n", accept);
+    client_send(server, client, raw_create(response));
+    if (client->state == WS_CLIENT_CLOSED) return;
+
+    if (server->hello != NULL) {
+        client_send(server, client, message_create(0x1, NULL, 0, server->hello, strlen(server->hello)));
+        if (client->state == WS_CLIENT_CLOSED) return;
+    }
+
+    // Anything after the request is the start of the first client frame
+    size_t consumed = (size_t)(end + 4 - request);
+    memmove(client->input, client->input + consumed, client->input_length - consumed);
+    client->input_length -= consumed;
+
+    client->state = WS_CLIENT_OPEN;
+    STAT_ADD(server, connections, 1);
+}
+
+/// Handle client frames: close and ping; data from listeners is ignored
+static void client_process_frames(ws_fanout_server *server, ws_client *client) {
+    size_t position = 0;
+    while (client->state == WS_CLIENT_OPEN) {
+        const uint8_t *frame = client->input + position;
+        size_t available = client->input_length - position;
+        if (available < 2) break;
+
+        uint8_t opcode = frame[0] & 0x0F;
+        int masked = (frame[1] & 0x80) != 0;
+        uint64_t length = frame[1] & 0x7F;
+        size_t header = 2;
+        if (length == 126) {
+            if (available < 4) break;
+            length = ((uint64_t)frame[2] << 8) | frame[3];
+            header = 4;
+        } else if (length == 127) {
+            if (available < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | frame[2 + i];
+            header = 10;
+        }
+        if (masked) header += 4;
+
+        if (length > WS_INPUT_CAPACITY - 14) {
+            client_close(server, client);  // Listeners don't send large messages
+            return;
+        }
+        if (available < header + length) break;
+
+        uint8_t payload[125];
+        size_t payload_length = length <= sizeof(payload) ? (size_t)length : 0;
+        for (size_t i = 0; i < payload_length; i++) {
+            payload[i] = frame[header + i] ^ (masked ? frame[header - 4 + (i & 3)] : 0);
+        }
+
+        if (opcode == 0x8) {
+            // Echo the close and hang up once it is sent
+            client->state = WS_CLIENT_CLOSING;
+            client_send(server, client, message_create(0x8, NULL, 0, payload, payload_length >= 2 ? 2 : 0));
+            break;
+        }
+        if (opcode == 0x9) {
+            client_send(server, client, message_create(0xA, NULL, 0, payload, payload_length));
+        }
+        position += header + (size_t)length;
+    }
+
+    if (client->state == WS_CLIENT_CLOSED) return;
+    memmove(client->input, client->input + position, client->input_length - position);
+    client->input_length -= position;
+}
+
+static void client_read(ws_fanout_server *server, ws_client *client) {
+    while (client->state == WS_CLIENT_HANDSHAKE || client->state == WS_CLIENT_OPEN) {
+        size_t space = WS_INPUT_CAPACITY - 1 - client->input_length;
+        if (space == 0) {
+            client_close(server, client);
+            return;
+        }
+
+        ssize_t n = read(client->fd, client->input + client->input_length, space);
+        if (n == 0) {
+            client_close(server, client);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) client_close(server, client);
+            break;
+        }
+        client->input_length += (size_t)n;
+
+        if (client->state == WS_CLIENT_HANDSHAKE) client_handshake(server, client);
+        if (client->state == WS_CLIENT_OPEN) client_process_frames(server, client);
+    }
+
+    if (client->state != WS_CLIENT_CLOSED) client_flush(server, client);
+}
+
+static void accept_clients(ws_fanout_server *server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;  // EAGAIN: backlog drained
+        }
+
+        if (server->client_count >= server->config.max_clients || set_nonblocking(fd) < 0) {
+            STAT_ADD(server, rejected, 1);
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if defined(SO_NOSIGPIPE)
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        ws_client *client = (ws_client *)calloc(1, sizeof(ws_client));
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+        client->fd = fd;
+        client->state = WS_CLIENT_HANDSHAKE;
+        client->writable = 1;
+
+        if (poller_add_client(server, client) < 0) {
+            close(fd);
+            free(client);
+            continue;
+        }
+
+        client->next = server->clients;
+        server->clients = client;
+        server->client_count++;
+        atomic_store_explicit(&server->stats.clients, server->client_count, memory_order_relaxed);
+
+        // Edge-triggered: data may already be waiting
+        client_read(server, client);
+    }
+}
+
+#pragma mark - Fan-out
+
+/// Hand every pending frame to every open client, then flush
+static void fan_out(ws_fanout_server *server) {
+    ws_buffer *frames[WS_PENDING_CAPACITY];
+    uint32_t count;
+
+    pthread_mutex_lock(&server->pending_lock);
+    count = server->pending_count;
+    for (uint32_t i = 0; i < count; i++) {
+        frames[i] = server->pending[(server->pending_head + i) % WS_PENDING_CAPACITY];
+    }
+    server->pending_head = (server->pending_head + count) % WS_PENDING_CAPACITY;
+    server->pending_count = 0;
+    pthread_mutex_unlock(&server->pending_lock);
+
+    if (count == 0) return;
+
+    ws_client *client = server->clients;
+    while (client != NULL) {
+        ws_client *next = client->next;  // client_close unlinks
+        if (client->state == WS_CLIENT_OPEN) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (client->count >= server->config.max_queued_frames) {
+                    if (server->config.policy == WS_SLOW_CLIENT_DISCONNECT) {
+                        STAT_ADD(server, clients_dropped, 1);
+                        client_close(server, client);
+                        break;
+                    }
+                    STAT_ADD(server, frames_skipped, 1);
+                    continue;
+                }
+                client_enqueue(client, frames[i]);
+            }
+            if (client->state == WS_CLIENT_OPEN) client_flush(server, client);
+        }
+        client = next;
+    }
+
+    for (uint32_t i = 0; i < count; i++) buffer_release(frames[i]);
+}
+
+static void free_closed_clients(ws_fanout_server *server) {
+    while (server->closed != NULL) {
+        ws_client *client = server->closed;
+        server->closed = client->next;
+        free(client);
+    }
+}
+
+static void *event_loop(void *context) {
+    ws_fanout_server *server = (ws_fanout_server *)context;
+    ws_event events[WS_EVENT_BATCH];
+
+    while (atomic_load_explicit(&server->running, memory_order_acquire)) {
+        int n = poller_wait(server, events, WS_EVENT_BATCH);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].tag == &kListenTag) {
+                accept_clients(server);
+            } else if (events[i].tag == &kWakeTag) {
+                poller_drain_wake(server);
+                fan_out(server);
+            } else {
+                ws_client *client = (ws_client *)events[i].tag;
+                if (client->state == WS_CLIENT_CLOSED) continue;
+                if (events[i].hangup) {
+                    client_close(server, client);
+                    continue;
+                }
+                if (events[i].writable) {
+                    client->writable = 1;
+                    client_flush(server, client);
+                }
+                if (events[i].readable && client->state != WS_CLIENT_CLOSED) {
+                    client_read(server, client);
+                }
+            }
+        }
+        free_closed_clients(server);
+    }
+    return NULL;
+}
+
+#pragma mark - Public API
+
+void ws_fanout_config_init(ws_fanout_config *config) {
+    memset(config, 0, sizeof(*config));
+    config->loopback_only = 1;
+    config->max_clients = 16;
+    config->max_queued_frames = 50;  // 1.5 s of 30 ms frames
+    config->policy = WS_SLOW_CLIENT_DISCONNECT;
+}
+
+ws_fanout_server *ws_fanout_create(const ws_fanout_config *config) {
+    ws_fanout_server *server = (ws_fanout_server *)calloc(1, sizeof(ws_fanout_server));
+    if (server == NULL) return NULL;
+
+    server->config = *config;
+    if (server->config.max_clients == 0 || server->config.max_clients > WS_FANOUT_MAX_CLIENTS) {
+        server->config.max_clients = WS_FANOUT_MAX_CLIENTS;
+    }
+    if (server->config.max_queued_frames == 0 || server->config.max_queued_frames >= WS_FANOUT_QUEUE_CAPACITY) {
+        server->config.max_queued_frames = WS_FANOUT_QUEUE_CAPACITY - 8;  // Room for control messages
+    }
+    server->config.hello = NULL;
+    server->hello = config->hello ? strdup(config->hello) : NULL;
+    server->poll_fd = -1;
+#if defined(__linux__)
+    server->wake_fd = -1;
+#endif
+    pthread_mutex_init(&server->pending_lock, NULL);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (server->listen_fd < 0) goto fail;
+
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config->port);
+    address.sin_addr.s_addr = htonl(config->loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+    if (bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0) goto fail;
+    if (listen(server->listen_fd, 16) < 0) goto fail;
+    if (set_nonblocking(server->listen_fd) < 0) goto fail;
+
+    socklen_t address_length = sizeof(address);
+    getsockname(server->listen_fd, (struct sockaddr *)&address, &address_length);
+    server->port = ntohs(address.sin_port);
+
+    if (poller_create(server) < 0) goto fail;
+
+    atomic_store(&server->running, 1);
+    if (pthread_create(&server->thread, NULL, event_loop, server) != 0) goto fail;
+    return server;
+
+fail:
+    if (server->listen_fd >= 0) close(server->listen_fd);
+    if (server->poll_fd >= 0) close(server->poll_fd);
+#if defined(__linux__)
+    if (server->wake_fd >= 0) close(server->wake_fd);
+#endif
+    pthread_mutex_destroy(&server->pending_lock);
+    free(server->hello);
+    free(server);
+    return NULL;
+}
+
+void ws_fanout_destroy(ws_fanout_server *server) {
+    if (server == NULL) return;
+
+    atomic_store_explicit(&server->running, 0, memory_order_release);
+    poller_wake(server);
+    pthread_join(server->thread, NULL);
+
+    while (server->clients != NULL) client_close(server, server->clients);
+    free_closed_clients(server);
+
+    for (uint32_t i = 0; i < server->pending_count; i++) {
+        buffer_release(server->pending[(server->pending_head + i) % WS_PENDING_CAPACITY]);
+    }
+
+    close(server->listen_fd);
+    close(server->poll_fd);
+#if defined(__linux__)
+    close(server->wake_fd);
+#endif
+    pthread_mutex_destroy(&server->pending_lock);
+    free(server->hello);
+    free(server);
+}
+
+uint16_t ws_fanout_port(const ws_fanout_server *server) {
+    return server->port;
+}
+
+int ws_fanout_publish(ws_fanout_server *server, const void *payload, uint32_t length,
+                      uint32_t frame_no, uint32_t timestamp_ms) {
+    uint8_t prefix[WS_FANOUT_FRAME_PREFIX];
+    for (int i = 0; i < 4; i++) {
+        prefix[i] = (uint8_t)(frame_no >> (i * 8));
+        prefix[4 + i] = (uint8_t)(timestamp_ms >> (i * 8));
+    }
+
+    // Framed once; every client queue shares this buffer
+    ws_buffer *buffer = message_create(0x2, prefix, sizeof(prefix), payload, length);
+    if (buffer == NULL) return -1;
+
+    ws_buffer *overrun = NULL;
+    pthread_mutex_lock(&server->pending_lock);
+    int was_empty = server->pending_count == 0;
+    if (server->pending_count == WS_PENDING_CAPACITY) {
+        // Loop thread is stalled; keep the newest audio
+        overrun = server->pending[server->pending_head];
+        server->pending_head = (server->pending_head + 1) % WS_PENDING_CAPACITY;
+        server->pending_count--;
+    }
+    server->pending[(server->pending_head + server->pending_count) % WS_PENDING_CAPACITY] = buffer;
+    server->pending_count++;
+    pthread_mutex_unlock(&server->pending_lock);
+
+    if (overrun != NULL) {
+        buffer_release(overrun);
+        STAT_ADD(server, publish_overruns, 1);
+    }
+    STAT_ADD(server, frames_published, 1);
+
+    // One wakeup per batch: the loop drains everything queued since
+    if (was_empty) poller_wake(server);
+    return 0;
+}
+
+void ws_fanout_get_stats(ws_fanout_server *server, ws_fanout_stats *stats) {
+    stats->frames_published = atomic_load_explicit(&server->stats.frames_published, memory_order_relaxed);
+    stats->messages_sent = atomic_load_explicit(&server->stats.messages_sent, memory_order_relaxed);
+    stats->bytes_sent = atomic_load_explicit(&server->stats.bytes_sent, memory_order_relaxed);
+    stats->frames_skipped = atomic_load_explicit(&server->stats.frames_skipped, memory_order_relaxed);
+    stats->clients_dropped = atomic_load_explicit(&server->stats.clients_dropped, memory_order_relaxed);
+    stats->connections = atomic_load_explicit(&server->stats.connections, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&server->stats.rejected, memory_order_relaxed);
+    stats->publish_overruns = atomic_load_explicit(&server->stats.publish_overruns, memory_order_relaxed);
+    stats->clients = (uint32_t)atomic_load_explicit(&server->stats.clients, memory_order_relaxed);
+}
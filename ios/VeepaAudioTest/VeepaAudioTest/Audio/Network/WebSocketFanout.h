@@ -0,0 +1,99 @@
+//
+//  WebSocketFanout.h
+//  VeepaAudioTest
+//
+//  Created for WebSocket live audio
+//  Purpose: Serve one camera's live audio to many WebSocket listeners with
+//           O(1) work per frame on the capture thread
+//
+//  A published frame is framed once (WebSocket header + frame prefix +
+//  payload) into a reference-counted buffer. The event-loop thread hands
+//  that buffer to every client queue by reference and sends each queue
+//  with one sendmsg/iovec call - payload bytes are never copied per client.
+//
+//  The loop is edge-triggered: kqueue with EV_CLEAR on Darwin, epoll with
+//  EPOLLET on Linux. Sockets are drained until EAGAIN and a client is only
+//  retried once the kernel reports it writable again.
+//
+//  Wire format (after the RFC 6455 handshake):
+//    text message    hello string from the config, once per connection
+//    binary message  frame_no u32 LE | timestamp_ms u32 LE | payload
+//
+
+#ifndef WebSocketFanout_h
+#define WebSocketFanout_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS_FANOUT_MAX_CLIENTS       64
+/// Hard per-client queue capacity (frames + control messages)
+#define WS_FANOUT_QUEUE_CAPACITY    256
+/// Size of the frame_no/timestamp prefix in each binary message
+#define WS_FANOUT_FRAME_PREFIX      8
+
+/// What to do with a client whose queue reaches max_queued_frames
+typedef enum {
+    /// Close the connection (the listener reconnects and resyncs)
+    WS_SLOW_CLIENT_DISCONNECT = 0,
+    /// Keep the connection and skip frames for that client until it drains
+    WS_SLOW_CLIENT_SKIP_FRAMES = 1,
+} ws_slow_client_policy;
+
+typedef struct {
+    uint16_t port;                  ///< 0 picks an ephemeral port
+    int loopback_only;              ///< Bind 127.0.0.1 instead of all interfaces
+    uint32_t max_clients;           ///< <= WS_FANOUT_MAX_CLIENTS
+    uint32_t max_queued_frames;     ///< Slow-client threshold, < WS_FANOUT_QUEUE_CAPACITY
+    ws_slow_client_policy policy;
+    const char *hello;              ///< Text message sent after the handshake (copied; may be NULL)
+} ws_fanout_config;
+
+typedef struct {
+    uint64_t frames_published;      ///< Frames accepted by ws_fanout_publish
+    uint64_t messages_sent;         ///< Messages fully written to a client
+    uint64_t bytes_sent;
+    uint64_t frames_skipped;        ///< Frames not queued for a slow client (SKIP_FRAMES)
+    uint64_t clients_dropped;       ///< Clients closed as slow (DISCONNECT)
+    uint64_t connections;           ///< WebSocket handshakes completed
+    uint64_t rejected;              ///< Connections refused (full, bad handshake)
+    uint64_t publish_overruns;      ///< Frames dropped because the loop thread fell behind
+    uint32_t clients;               ///< Currently connected listeners
+} ws_fanout_stats;
+
+typedef struct ws_fanout_server ws_fanout_server;
+
+/// Defaults: ephemeral port, loopback only, 16 clients, 50 queued frames, DISCONNECT
+void ws_fanout_config_init(ws_fanout_config *config);
+
+/// Bind, listen and start the event-loop thread
+/// @return NULL if the socket, poller or thread cannot be created
+ws_fanout_server *ws_fanout_create(const ws_fanout_config *config);
+
+/// Stop the loop thread and close every connection
+void ws_fanout_destroy(ws_fanout_server *server);
+
+/// Port actually bound (useful with port 0)
+uint16_t ws_fanout_port(const ws_fanout_server *server);
+
+/// Publish one frame to every connected listener. Cost does not depend on the
+/// number of listeners: one allocation, one copy and at most one wakeup.
+/// @return 0, or -1 if the frame could not be buffered
+int ws_fanout_publish(ws_fanout_server *server, const void *payload, uint32_t length,
+                      uint32_t frame_no, uint32_t timestamp_ms);
+
+void ws_fanout_get_stats(ws_fanout_server *server, ws_fanout_stats *stats);
+
+/// Sec-WebSocket-Accept for a Sec-WebSocket-Key (RFC 6455 section 4.2.2)
+/// @param accept Receives a NUL-terminated base64 string (29 bytes)
+void ws_fanout_accept_key(const char *key, size_t key_length, char accept[29]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WebSocketFanout_h */
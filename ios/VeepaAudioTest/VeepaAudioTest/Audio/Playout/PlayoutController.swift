@@ -0,0 +1,256 @@
+//
+//  PlayoutController.swift
+//  VeepaAudioTest
+//
+//  Created for playout tuning
+//  Purpose: Render-side playout policy - jitter prefill, latency cap and
+//           loss concealment - between the playback ring and the output
+//
+//  AudioBridgeEngine's render callback asks the controller for each output
+//  block. Keeping the policy here (rather than inline in the callback)
+//  lets tests drive exactly the same code with a simulated network and
+//  clock to measure latency and glitches per profile.
+//
+//  Threading: `render` runs on the audio thread; `apply` and `configure`
+//  come from one configuring thread (the main thread in the app). They
+//  keep `profile` and `bounds` for that thread and publish what render
+//  needs as a plain-data snapshot (PlayoutSettings.c); render reads only
+//  the snapshot, once per block. Concealment history is preallocated and
+//  the ring is lock-free - render never allocates or waits.
+//
+
+import Foundation
+
+// MARK: - Jitter Bounds
+
+/// How much decoded audio the playback ring holds before and during playout
+struct JitterBufferBounds {
+
+    /// Samples buffered before playout starts or resumes after an underflow
+    /// (0 = play whatever is there)
+    var targetSamples: Int
+
+    /// Above this the oldest samples are dropped back to the target
+    var maxSamples: Int
+
+    /// No prefill, no cap (the ring's capacity is the only limit)
+    static let unbounded = JitterBufferBounds(targetSamples: 0, maxSamples: .max)
+
+    init(targetSamples: Int, maxSamples: Int) {
+        self.targetSamples = targetSamples
+        self.maxSamples = maxSamples
+    }
+
+    /// Bounds for a stream: `targetFrames` frames of cushion, at most `maxMs` of audio
+    init(sampleRate: Int, frameSamples: Int, targetFrames: Int = 2, maxMs: Int = 300) {
+        targetSamples = frameSamples * targetFrames
+        maxSamples = max(sampleRate * maxMs / 1000, targetSamples + 2 * frameSamples)
+    }
+
+    /// Bounds a profile gives a stream; `keepAll` profiles are never trimmed
+    init(profile: PlayoutProfile, sampleRate: Int, frameSamples: Int) {
+        self.init(sampleRate: sampleRate, frameSamples: frameSamples,
+                  targetFrames: profile.jitterTargetFrames, maxMs: profile.jitterMaxMs)
+        if profile.backpressure == .keepAll {
+            maxSamples = .max
+        }
+    }
+}
+
+// MARK: - Controller
+
+final class PlayoutController {
+
+    struct Statistics {
+        /// Starvation events after playout had started (one per run of short renders)
+        var underflows: UInt64 = 0
+        /// Samples filled by concealment
+        var concealedSamples: UInt64 = 0
+        /// Samples of silence output while playing (not counting prefill)
+        var silentSamples: UInt64 = 0
+        /// Times the oldest audio was dropped to respect the latency cap
+        var latencyTrims: UInt64 = 0
+        var trimmedSamples: UInt64 = 0
+    }
+
+    /// Configuring thread's view; render uses the published snapshot
+    private(set) var profile: PlayoutProfile
+    private(set) var bounds = JitterBufferBounds.unbounded
+    private(set) var statistics = Statistics()
+
+    private var sampleRate = 16000
+    private var frameSamples = 0
+    private var prefillEpoch: UInt32 = 0
+    private let settings: OpaquePointer
+
+    // Render thread only
+    private var renderEpoch: UInt32 = 0
+    private var isPrefilling = false
+    private var isStarving = false
+
+    /// Last played audio, for concealment (circular)
+    private static let historyCapacity = 1024
+    private let history = UnsafeMutablePointer<Int16>.allocate(capacity: PlayoutController.historyCapacity)
+    private var historyCount = 0
+    private var historyIndex = 0
+
+    /// Position within the current concealment run
+    private var concealedRun = 0
+
+    init(profile: PlayoutProfile = .standard) {
+        self.profile = profile
+        // The property defaults (self is not usable before init completes)
+        var initial = PlayoutController.snapshot(profile: profile, bounds: .unbounded, sampleRate: 16000,
+                                                 frameSamples: 0, prefillEpoch: 0)
+        guard let settings = playout_settings_create(&initial) else {
+            fatalError("Cannot allocate playout settings")
+        }
+        self.settings = settings
+        history.initialize(repeating: 0, count: PlayoutController.historyCapacity)
+    }
+
+    deinit {
+        playout_settings_destroy(settings)
+        history.deallocate()
+    }
+
+    // MARK: - Configuration
+
+    /// Switch profile; takes effect on the next render, buffered audio is kept
+    func apply(_ profile: PlayoutProfile) {
+        self.profile = profile
+        if frameSamples > 0 {
+            bounds = JitterBufferBounds(profile: profile, sampleRate: sampleRate, frameSamples: frameSamples)
+        }
+        publish()
+    }
+
+    /// Size the bounds for a stream's format and wait for the new target
+    func configure(sampleRate: Int, frameSamples: Int) {
+        self.sampleRate = sampleRate
+        self.frameSamples = frameSamples
+        bounds = JitterBufferBounds(profile: profile, sampleRate: sampleRate, frameSamples: frameSamples)
+        prefillEpoch &+= 1  // render starts a new cushion when it sees this
+        publish()
+    }
+
+    private func publish() {
+        var snapshot = PlayoutController.snapshot(profile: profile, bounds: bounds, sampleRate: sampleRate,
+                                                  frameSamples: frameSamples, prefillEpoch: prefillEpoch)
+        playout_settings_publish(settings, &snapshot)
+    }
+
+    private static func snapshot(profile: PlayoutProfile, bounds: JitterBufferBounds, sampleRate: Int,
+                                 frameSamples: Int, prefillEpoch: UInt32) -> playout_settings {
+        var fadeMs: Int32 = 0
+        if case .repeatAndFade(let maxMs) = profile.concealment {
+            fadeMs = Int32(max(1, maxMs))
+        }
+        return playout_settings(target_samples: Int64(bounds.targetSamples),
+                                max_samples: bounds.maxSamples == .max ? .max : Int64(bounds.maxSamples),
+                                sample_rate: Int32(sampleRate), frame_samples: Int32(frameSamples),
+                                conceal_fade_ms: fadeMs, prefill_epoch: prefillEpoch)
+    }
+
+    func resetStatistics() {
+        statistics = Statistics()
+    }
+
+    // MARK: - Render
+
+    /// Fill `count` output samples from `ring`
+    /// - Returns: Samples of received audio at the start of the block, and
+    ///   samples of concealment after them (the rest is silence)
+    func render(into output: UnsafeMutablePointer<Int16>, count: Int,
+                from ring: CircularAudioBuffer) -> (received: Int, concealed: Int) {
+        var current = playout_settings()
+        playout_settings_load(settings, &current)
+        if current.prefill_epoch != renderEpoch {
+            renderEpoch = current.prefill_epoch
+            isPrefilling = true
+        }
+        let targetSamples = Int(current.target_samples)
+        let available = ring.availableSamples
+
+        // Jitter cushion: after a start or an underflow, hold playout until
+        // the target depth is buffered
+        if isPrefilling {
+            guard available >= targetSamples else {
+                return (0, conceal(output, count: count, settings: current))
+            }
+            isPrefilling = false
+        }
+
+        // Latency cap: a burst after a stall would otherwise delay everything after it
+        if Int64(available) > current.max_samples {
+            let dropped = ring.discard(count: available - targetSamples)
+            statistics.latencyTrims += 1
+            statistics.trimmedSamples += UInt64(dropped)
+        }
+
+        let read = ring.read(into: output, count: count)
+        remember(output, count: read)
+        guard read < count else {
+            isStarving = false
+            return (read, 0)
+        }
+
+        if !isStarving {
+            isStarving = true
+            statistics.underflows += 1
+        }
+        if targetSamples > 0 {
+            isPrefilling = true
+        }
+        return (read, conceal(output + read, count: count - read, settings: current))
+    }
+
+    // MARK: - Concealment
+
+    private func remember(_ samples: UnsafePointer<Int16>, count: Int) {
+        guard count > 0 else { return }
+        concealedRun = 0
+        let capacity = PlayoutController.historyCapacity
+        let start = max(0, count - capacity)
+        for i in start..<count {
+            history[historyIndex] = samples[i]
+            historyIndex = (historyIndex + 1) % capacity
+        }
+        historyCount = min(capacity, historyCount + count - start)
+    }
+
+    /// Fill a gap per the profile (silence if nothing has been played yet)
+    /// - Returns: Samples concealed; the rest of the gap is zeros
+    @discardableResult
+    private func conceal(_ output: UnsafeMutablePointer<Int16>, count: Int, settings: playout_settings) -> Int {
+        guard settings.conceal_fade_ms > 0, historyCount > 0 else {
+            output.update(repeating: 0, count: count)
+            if isStarving {
+                statistics.silentSamples += UInt64(count)
+            }
+            return 0
+        }
+
+        // Repeat the last period (up to one frame of history) with a linear fade
+        let frameSamples = Int(settings.frame_samples)
+        let period = max(1, min(historyCount, frameSamples > 0 ? frameSamples : historyCount))
+        let fadeSamples = max(1, Int(settings.sample_rate) * Int(settings.conceal_fade_ms) / 1000)
+        let capacity = PlayoutController.historyCapacity
+        let periodStart = (historyIndex - period + capacity) % capacity
+        var concealed = 0
+        for i in 0..<count {
+            let position = concealedRun + i
+            guard position < fadeSamples else {
+                output[i] = 0
+                continue
+            }
+            let source = Int(history[(periodStart + position % period) % capacity])
+            output[i] = Int16(source * (fadeSamples - position) / fadeSamples)
+            concealed += 1
+        }
+        concealedRun += count
+        statistics.concealedSamples += UInt64(concealed)
+        statistics.silentSamples += UInt64(count - concealed)
+        return concealed
+    }
+}
@@ -0,0 +1,114 @@
+//
+//  PlayoutProfile.swift
+//  VeepaAudioTest
+//
+//  Created for playout tuning
+//  Purpose: Named playout presets that set every latency/resilience knob
+//           of the playback path together
+//
+//  Jitter depth, latency cap, loss concealment, resampling, IO buffer size,
+//  the frame poll interval and the frame duration asked of the camera all
+//  trade latency against glitches, and only make sense as a set: a 20 ms
+//  jitter target is pointless behind a 2 s ring that is never trimmed. A
+//  profile names one consistent set; AudioBridgeEngine.playoutProfile
+//  switches between them at runtime.
+//
+
+import Foundation
+
+struct PlayoutProfile: Equatable {
+
+    /// What happens when the ring holds more than `jitterMaxMs`
+    enum Backpressure: Equatable {
+        /// Drop the oldest audio back to the jitter target (latency stays bounded)
+        case trimToTarget
+        /// Keep everything; latency grows until the ring itself overflows
+        case keepAll
+    }
+
+    /// What fills the output when the ring runs dry mid-stream
+    enum Concealment: Equatable {
+        /// Zeros
+        case silence
+        /// Repeat the last played period, fading to silence over `maxMs`
+        case repeatAndFade(maxMs: Int)
+    }
+
+    /// How the stream rate reaches the hardware rate
+    enum Resampling: Equatable {
+        /// Ask the hardware for the stream's rate; no conversion when granted
+        /// (lowest latency, no converter filter)
+        case streamRate
+        /// Run the hardware at 48 kHz and let AVAudioEngine's converter resample
+        case converter48k
+    }
+
+    let name: String
+
+    /// Whole frames buffered before playout starts or resumes after an underflow
+    let jitterTargetFrames: Int
+
+    /// Ring depth beyond which `backpressure` applies
+    let jitterMaxMs: Int
+
+    let backpressure: Backpressure
+    let concealment: Concealment
+    let resampling: Resampling
+
+    /// AVAudioSession IO buffer duration (render block size)
+    let ioBufferDuration: TimeInterval
+
+    /// How often AudioHookBridge polls the SDK's voice_frame
+    let framePollIntervalMs: Int
+
+    /// Frame duration to ask the camera for (AudioParameterNegotiator):
+    /// shorter frames arrive sooner but cost more packets per second
+    let sourceFrameMs: Int
+
+    // MARK: - Presets
+
+    /// Two-way talk: ~40 ms from arrival to speaker; glitches are concealed
+    /// rather than buffered away
+    static let liveIntercom = PlayoutProfile(
+        name: "live-intercom",
+        jitterTargetFrames: 1,
+        jitterMaxMs: 80,
+        backpressure: .trimToTarget,
+        concealment: .repeatAndFade(maxMs: 40),
+        resampling: .streamRate,
+        ioBufferDuration: 0.005,
+        framePollIntervalMs: 5,
+        sourceFrameMs: 10)
+
+    /// What the playback path did before profiles: 10 ms polls and IO
+    /// buffer, two frames of cushion, 300 ms cap
+    static let standard = PlayoutProfile(
+        name: "standard",
+        jitterTargetFrames: 2,
+        jitterMaxMs: 300,
+        backpressure: .trimToTarget,
+        concealment: .repeatAndFade(maxMs: 60),
+        resampling: .converter48k,
+        ioBufferDuration: 0.01,
+        framePollIntervalMs: 10,
+        sourceFrameMs: 20)
+
+    /// Watching a recording-grade feed: never drop or invent audio, absorb
+    /// long network stalls with a deep buffer
+    static let evidenceMonitoring = PlayoutProfile(
+        name: "evidence-monitoring",
+        jitterTargetFrames: 8,
+        jitterMaxMs: 2000,
+        backpressure: .keepAll,
+        concealment: .silence,
+        resampling: .converter48k,
+        ioBufferDuration: 0.02,
+        framePollIntervalMs: 20,
+        sourceFrameMs: 40)
+
+    static let all: [PlayoutProfile] = [.liveIntercom, .standard, .evidenceMonitoring]
+
+    static func named(_ name: String) -> PlayoutProfile? {
+        all.first { $0.name == name }
+    }
+}
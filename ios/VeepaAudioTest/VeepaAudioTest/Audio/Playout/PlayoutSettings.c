@@ -0,0 +1,73 @@
+//
+//  PlayoutSettings.c
+//  VeepaAudioTest
+//
+//  Created for playout tuning
+//  Purpose: Double-buffered playout settings behind a publication counter
+//
+
+#include "PlayoutSettings.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SETTINGS_WORDS (sizeof(playout_settings) / sizeof(uint64_t))
+
+_Static_assert(sizeof(playout_settings) % sizeof(uint64_t) == 0,
+               "playout_settings is copied as whole 64-bit words");
+
+struct playout_settings_box {
+    uint64_t published;                       ///< (atomic) Publishes so far; low bit = current slot
+    uint8_t pad[56];
+    uint64_t slots[2][SETTINGS_WORDS];        ///< (atomic, per word)
+};
+
+#pragma mark - Lifecycle
+
+playout_settings_box *playout_settings_create(const playout_settings *initial) {
+    playout_settings_box *box = (playout_settings_box *)aligned_alloc(64, (sizeof(playout_settings_box) + 63) & ~(size_t)63);
+    if (box == NULL) return NULL;
+    memset(box, 0, sizeof(playout_settings_box));
+    memcpy(box->slots[0], initial, sizeof(playout_settings));
+    return box;
+}
+
+void playout_settings_destroy(playout_settings_box *box) {
+    free(box);
+}
+
+#pragma mark - Writer
+
+void playout_settings_publish(playout_settings_box *box, const playout_settings *settings) {
+    uint64_t published = __atomic_load_n(&box->published, __ATOMIC_RELAXED);
+    uint64_t *slot = box->slots[(published + 1) & 1];
+
+    uint64_t words[SETTINGS_WORDS];
+    memcpy(words, settings, sizeof(playout_settings));
+
+    // A reader that sees any of the stores below also sees `published` at
+    // least as new as the value loaded above, so it notices the reuse
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < SETTINGS_WORDS; i++) {
+        __atomic_store_n(&slot[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&box->published, published + 1, __ATOMIC_RELEASE);
+}
+
+#pragma mark - Reader
+
+void playout_settings_load(const playout_settings_box *box, playout_settings *settings) {
+    uint64_t words[SETTINGS_WORDS];
+    uint64_t published = __atomic_load_n(&box->published, __ATOMIC_ACQUIRE);
+    for (;;) {
+        const uint64_t *slot = box->slots[published & 1];
+        for (size_t i = 0; i < SETTINGS_WORDS; i++) {
+            words[i] = __atomic_load_n(&slot[i], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t again = __atomic_load_n(&box->published, __ATOMIC_ACQUIRE);
+        if (again == published) break;
+        published = again;
+    }
+    memcpy(settings, words, sizeof(playout_settings));
+}
@@ -0,0 +1,56 @@
+//
+//  PlayoutSettings.h
+//  VeepaAudioTest
+//
+//  Created for playout tuning
+//  Purpose: Hand the playout policy from the configuring thread to the
+//           audio render thread as a plain-data snapshot, without locks
+//
+//  Two slots and a publication counter: the writer fills the slot the
+//  reader is not pointed at, then bumps the counter (its low bit names the
+//  current slot). A reader copies the current slot and checks the counter
+//  did not move meanwhile; if it did, the slot may have been reused and it
+//  copies again. The writer never waits; a reader only repeats a copy of a
+//  few words when a publish lands in the middle of it.
+//
+//  Threading: one writer thread calls publish; load is safe from any thread.
+//
+
+#ifndef PlayoutSettings_h
+#define PlayoutSettings_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// What render needs of a profile and the stream format (no pointers, no strings)
+typedef struct {
+    int64_t target_samples;      ///< Jitter prefill depth
+    int64_t max_samples;         ///< Latency cap (INT64_MAX = never trimmed)
+    int32_t sample_rate;
+    int32_t frame_samples;       ///< 0 until the stream format is known
+    int32_t conceal_fade_ms;     ///< Repeat-and-fade length (0 = conceal with silence)
+    uint32_t prefill_epoch;      ///< Bumped when render must rebuild its cushion
+} playout_settings;
+
+typedef struct playout_settings_box playout_settings_box;
+
+/// @param initial Settings load returns until the first publish
+/// @return NULL if allocation fails
+playout_settings_box *playout_settings_create(const playout_settings *initial);
+
+void playout_settings_destroy(playout_settings_box *box);
+
+/// Replace the settings (writer thread)
+void playout_settings_publish(playout_settings_box *box, const playout_settings *settings);
+
+/// Copy of the latest published settings (any thread; never blocks)
+void playout_settings_load(const playout_settings_box *box, playout_settings *settings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PlayoutSettings_h */
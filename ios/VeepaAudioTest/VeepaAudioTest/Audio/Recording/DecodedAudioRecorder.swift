@@ -0,0 +1,224 @@
+//
+//  DecodedAudioRecorder.swift
+//  VeepaAudioTest
+//
+//  Created for lossless recording
+//  Purpose: Record the decoded PCM stream (what actually gets played) to
+//           WAV or lossless FLAC without blocking the capture path
+//
+//  Samples are collected into chunks of whole FLAC blocks under a lock on the
+//  capture thread. A serial background queue takes one chunk at a time,
+//  encodes its blocks in parallel (FlacBlockEncoder) and appends the frames,
+//  so chunk order is preserved while every core helps with the encode.
+//  The stream header is rewritten with the final totals in `finish`.
+//
+
+import Foundation
+
+/// Writes decoded 16-bit mono PCM to disk
+final class DecodedAudioRecorder {
+
+    // MARK: - Types
+
+    enum Format: String, CaseIterable {
+        case wav
+        case flac
+
+        var fileExtension: String { rawValue }
+    }
+
+    enum RecorderError: Error, LocalizedError {
+        case cannotCreateFile(URL)
+
+        var errorDescription: String? {
+            switch self {
+            case .cannotCreateFile(let url):
+                return "Cannot create recording at \(url.path)"
+            }
+        }
+    }
+
+    /// Summary delivered when the recording is finished
+    struct Summary {
+        let url: URL
+        let format: Format
+        let samples: UInt64
+        let fileBytes: UInt64
+        let error: Error?
+
+        /// Raw 16-bit size divided by file size
+        var compressionRatio: Double {
+            fileBytes > 0 ? Double(samples * 2) / Double(fileBytes) : 0
+        }
+    }
+
+    // MARK: - Properties
+
+    let url: URL
+    let format: Format
+    let sampleRate: Int
+
+    /// Blocks per background encode job (~4 s of 16 kHz audio)
+    private static let blocksPerChunk = 16
+
+    private let encoder: FlacBlockEncoder
+    private let chunkSamples: Int
+    private let handle: FileHandle
+
+    private let lock = NSLock()
+    private var pending: [Int16] = []
+    private var isFinished = false
+
+    /// Serial: chunks are encoded and written in arrival order
+    private let encodeQueue = DispatchQueue(label: "com.veepatest.recorder-encode", qos: .utility)
+
+    // Owned by encodeQueue
+    private var nextFrameNumber: UInt32 = 0
+    private var samplesWritten: UInt64 = 0
+    private var bytesWritten: UInt64 = 0
+    private var minFrameBytes = Int.max
+    private var maxFrameBytes = 0
+    private var writeError: Error?
+
+    // MARK: - Initialization
+
+    /// Create the file and write a placeholder header
+    init(url: URL, format: Format, sampleRate: Int = 16000) throws {
+        guard FileManager.default.createFile(atPath: url.path, contents: nil) else {
+            throw RecorderError.cannotCreateFile(url)
+        }
+        self.url = url
+        self.format = format
+        self.sampleRate = sampleRate
+        let encoder = FlacBlockEncoder(sampleRate: sampleRate)
+        self.encoder = encoder
+        self.chunkSamples = encoder.blockSize * Self.blocksPerChunk
+        self.handle = try FileHandle(forWritingTo: url)
+
+        let header = Self.header(format: format, encoder: encoder, sampleRate: sampleRate)
+        try handle.write(contentsOf: header)
+        bytesWritten = UInt64(header.count)
+        pending.reserveCapacity(chunkSamples * 2)
+
+        print("[DecodedAudioRecorder] 🔴 Recording \(format.rawValue) at \(sampleRate) Hz to \(url.lastPathComponent)")
+    }
+
+    // MARK: - Recording
+
+    /// Append decoded samples (any thread; never blocks on I/O or encoding)
+    func append(_ samples: UnsafePointer<Int16>, count: Int) {
+        var chunk: [Int16]?
+
+        lock.lock()
+        if !isFinished {
+            pending.append(contentsOf: UnsafeBufferPointer(start: samples, count: count))
+            if pending.count >= chunkSamples {
+                // Whole blocks only - FLAC allows a short block only at the end
+                let take = pending.count - pending.count % encoder.blockSize
+                chunk = Array(pending[..<take])
+                pending.removeFirst(take)
+            }
+        }
+        lock.unlock()
+
+        if let chunk = chunk {
+            encodeQueue.async { self.write(chunk) }
+        }
+    }
+
+    /// Flush, rewrite the header with the final totals and close the file
+    /// - Parameter completion: Called on the main queue
+    func finish(completion: ((Summary) -> Void)? = nil) {
+        lock.lock()
+        let alreadyFinished = isFinished
+        isFinished = true
+        let rest = pending
+        pending = []
+        lock.unlock()
+        guard !alreadyFinished else { return }
+
+        encodeQueue.async {
+            self.write(rest)
+            self.finalizeHeader()
+            try? self.handle.close()
+
+            let summary = Summary(url: self.url, format: self.format, samples: self.samplesWritten,
+                                  fileBytes: self.bytesWritten, error: self.writeError)
+            print(String(format: "[DecodedAudioRecorder] 💾 Finished %@: %.1fs, %.2fx smaller than raw PCM",
+                         self.url.lastPathComponent,
+                         Double(summary.samples) / Double(self.sampleRate),
+                         summary.compressionRatio))
+
+            DispatchQueue.main.async { completion?(summary) }
+        }
+    }
+
+    // MARK: - Encoding (encodeQueue)
+
+    private func write(_ chunk: [Int16]) {
+        guard writeError == nil, !chunk.isEmpty else { return }
+
+        let data: Data
+        switch format {
+        case .wav:
+            data = chunk.withUnsafeBytes { Data($0) }
+        case .flac:
+            let frames = chunk.withUnsafeBufferPointer {
+                encoder.encodeFrames($0, firstFrameNumber: nextFrameNumber)
+            }
+            nextFrameNumber &+= UInt32(frames.frameCount)
+            minFrameBytes = min(minFrameBytes, frames.minFrameBytes)
+            maxFrameBytes = max(maxFrameBytes, frames.maxFrameBytes)
+            data = frames.data
+        }
+
+        do {
+            try handle.write(contentsOf: data)
+            samplesWritten += UInt64(chunk.count)
+            bytesWritten += UInt64(data.count)
+        } catch {
+            writeError = error
+            print("[DecodedAudioRecorder] ❌ Write failed, recording stopped: \(error)")
+        }
+    }
+
+    private func finalizeHeader() {
+        let header: Data
+        switch format {
+        case .wav:
+            header = Self.wavHeader(sampleRate: sampleRate, dataBytes: samplesWritten * 2)
+        case .flac:
+            header = encoder.streamHeader(
+                totalSamples: samplesWritten,
+                minFrameBytes: nextFrameNumber > 0 ? minFrameBytes : 0,
+                maxFrameBytes: maxFrameBytes
+            )
+        }
+
+        do {
+            try handle.seek(toOffset: 0)
+            try handle.write(contentsOf: header)
+        } catch {
+            writeError = writeError ?? error
+            print("[DecodedAudioRecorder] ❌ Could not finalize header: \(error)")
+        }
+    }
+
+    // MARK: - Headers
+
+    private static func header(format: Format, encoder: FlacBlockEncoder, sampleRate: Int) -> Data {
+        switch format {
+        case .wav: return wavHeader(sampleRate: sampleRate, dataBytes: 0)
+        case .flac: return encoder.streamHeader()
+        }
+    }
+
+    private static func wavHeader(sampleRate: Int, dataBytes: UInt64) -> Data {
+        var header = Data(count: Int(WAV_HEADER_SIZE))
+        header.withUnsafeMutableBytes { bytes in
+            wav_write_header(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                             UInt32(sampleRate), 1, 16, UInt32(min(dataBytes, UInt64(UInt32.max - 36))))
+        }
+        return header
+    }
+}
@@ -0,0 +1,97 @@
+//
+//  FlacBlockEncoder.swift
+//  VeepaAudioTest
+//
+//  Created for lossless recording
+//  Purpose: Encode PCM into FLAC frames with the blocks spread over all cores
+//
+//  FLAC frames are independent, so each block is encoded into its own slot
+//  concurrently and the slots are concatenated in order afterwards. Shared
+//  by DecodedAudioRecorder and the veepa-archive tool.
+//
+
+import Foundation
+
+/// Block-parallel front end for the C FLAC encoder (DSP/FlacEncoder.c)
+struct FlacBlockEncoder {
+
+    /// Consecutive encoded frames
+    struct EncodedFrames {
+        var data = Data()
+        var frameCount = 0
+        var minFrameBytes = Int.max
+        var maxFrameBytes = 0
+    }
+
+    private(set) var config = flac_encoder_config()
+
+    /// Samples per FLAC frame
+    var blockSize: Int { Int(config.block_size) }
+
+    init(sampleRate: Int, maxLPCOrder: Int = Int(FLAC_MAX_LPC_ORDER)) {
+        flac_encoder_config_init(&config, UInt32(sampleRate))
+        config.max_lpc_order = UInt32(max(0, min(maxLPCOrder, Int(FLAC_MAX_LPC_ORDER))))
+    }
+
+    /// Encode `samples` as consecutive frames numbered from `firstFrameNumber`
+    /// - Note: Every block but the last must be full, so callers streaming a
+    ///         recording pass multiples of `blockSize` until the final call
+    func encodeFrames(_ samples: UnsafeBufferPointer<Int16>, firstFrameNumber: UInt32) -> EncodedFrames {
+        guard let base = samples.baseAddress, !samples.isEmpty else { return EncodedFrames() }
+
+        let blockSize = self.blockSize
+        let blockCount = (samples.count + blockSize - 1) / blockSize
+        let capacity = flac_frame_capacity(config.block_size)
+
+        let slots = UnsafeMutableRawPointer.allocate(byteCount: blockCount * capacity, alignment: 16)
+        let sizes = UnsafeMutableBufferPointer<Int>.allocate(capacity: blockCount)
+        defer {
+            slots.deallocate()
+            sizes.deallocate()
+        }
+
+        withUnsafePointer(to: config) { config in
+            DispatchQueue.concurrentPerform(iterations: blockCount) { block in
+                let start = block * blockSize
+                let count = min(blockSize, samples.count - start)
+                let out = (slots + block * capacity).assumingMemoryBound(to: UInt8.self)
+                sizes[block] = flac_encode_frame(config, base + start, UInt32(count),
+                                                 firstFrameNumber &+ UInt32(block), out, capacity)
+            }
+        }
+
+        var result = EncodedFrames()
+        result.data.reserveCapacity(sizes.reduce(0, +))
+        for block in 0..<blockCount {
+            let size = sizes[block]
+            result.data.append((slots + block * capacity).assumingMemoryBound(to: UInt8.self), count: size)
+            result.minFrameBytes = min(result.minFrameBytes, size)
+            result.maxFrameBytes = max(result.maxFrameBytes, size)
+        }
+        result.frameCount = blockCount
+        return result
+    }
+
+    /// "fLaC" + STREAMINFO; pass zeros while the totals are still unknown
+    func streamHeader(totalSamples: UInt64 = 0, minFrameBytes: Int = 0, maxFrameBytes: Int = 0) -> Data {
+        var config = self.config
+        var header = Data(count: Int(FLAC_STREAM_HEADER_SIZE))
+        header.withUnsafeMutableBytes { bytes in
+            flac_write_stream_header(&config, totalSamples, UInt32(minFrameBytes), UInt32(maxFrameBytes),
+                                     bytes.baseAddress!.assumingMemoryBound(to: UInt8.self))
+        }
+        return header
+    }
+
+    /// Encode a whole recording into a complete .flac file image
+    func encodeFile(_ samples: UnsafeBufferPointer<Int16>) -> Data {
+        let frames = encodeFrames(samples, firstFrameNumber: 0)
+        var file = streamHeader(
+            totalSamples: UInt64(samples.count),
+            minFrameBytes: frames.frameCount > 0 ? frames.minFrameBytes : 0,
+            maxFrameBytes: frames.maxFrameBytes
+        )
+        file.append(frames.data)
+        return file
+    }
+}
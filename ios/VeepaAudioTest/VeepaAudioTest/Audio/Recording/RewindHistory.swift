@@ -0,0 +1,259 @@
+//
+//  RewindHistory.swift
+//  VeepaAudioTest
+//
+//  Created for live rewind
+//  Purpose: Keep the last minutes of a stream in memory as received A-law
+//           frames, for rewind playback, clip export and recording pre-roll
+//
+//  Frames are stored as they arrive - one byte per sample, half the size of
+//  decoded PCM - in a frames-only flight_recorder (FlightRecorder.c): a
+//  payload ring plus an index of arrival times. Memory is fixed at creation
+//  by `seconds` × `maxSampleRate` (rounded up to a power of two). Ranges are
+//  looked up by binary search on the index, so a clip from anywhere in the
+//  history copies and decodes only that clip.
+//
+//  Times are pipeline_trace_now() nanoseconds (arrival at the bridge), so
+//  "30 seconds ago" means 30 seconds of wall time, whatever gaps the camera
+//  left in its own timestamps.
+//
+
+import Foundation
+
+final class RewindHistory {
+
+    // MARK: - Types
+
+    struct Configuration {
+        /// History kept; 240 s at 16 kHz fills a 4 MB ring exactly
+        var seconds = 240
+        /// Highest stream rate and frame rate the rings are sized for
+        var maxSampleRate = 16000
+        var maxFramesPerSecond = 50
+    }
+
+    enum ClipFormat: String, CaseIterable {
+        /// Decoded PCM
+        case wav
+        /// Frames as received (capture archive segment)
+        case vaca
+
+        var fileExtension: String { rawValue }
+    }
+
+    enum HistoryError: Error, LocalizedError {
+        case allocationFailed(seconds: Int)
+        case emptyClip
+        case cannotWrite(URL)
+
+        var errorDescription: String? {
+            switch self {
+            case .allocationFailed(let seconds):
+                return "Cannot allocate \(seconds) s of rewind history"
+            case .emptyClip:
+                return "No audio in the requested range"
+            case .cannotWrite(let url):
+                return "Cannot write clip \(url.path)"
+            }
+        }
+    }
+
+    /// Frames copied out of the history, oldest first
+    struct Clip {
+        let frames: [flight_recorder_frame]
+        /// Payloads back to back (`frames[i].offset` indexes this)
+        let payload: [UInt8]
+        let sampleRate: Int
+
+        var isEmpty: Bool { frames.isEmpty }
+        var sampleCount: Int { payload.count }
+        var duration: TimeInterval { Double(sampleCount) / Double(max(sampleRate, 1)) }
+
+        /// Arrival of the first frame and end of the last (0 when empty)
+        var startNanoseconds: UInt64 { frames.first?.arrival_ns ?? 0 }
+        var endNanoseconds: UInt64 {
+            guard let last = frames.last else { return 0 }
+            return last.arrival_ns + UInt64(last.length) * 1_000_000_000 / UInt64(max(sampleRate, 1))
+        }
+
+        /// G.711a-decoded samples
+        func decoded() -> [Int16] {
+            var samples = [Int16](repeating: 0, count: payload.count)
+            payload.withUnsafeBufferPointer { alaw in
+                samples.withUnsafeMutableBufferPointer { pcm in
+                    if let source = alaw.baseAddress, let target = pcm.baseAddress {
+                        g711_alaw_decode(source, target, alaw.count)
+                    }
+                }
+            }
+            return samples
+        }
+
+        func write(as format: ClipFormat, to url: URL, startTimeMs: Int64) throws {
+            switch format {
+            case .wav:
+                var data = Data(count: Int(WAV_HEADER_SIZE))
+                data.withUnsafeMutableBytes { bytes in
+                    wav_write_header(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                                     UInt32(sampleRate), 1, 16, UInt32(sampleCount * 2))
+                }
+                decoded().withUnsafeBytes { data.append(contentsOf: $0) }
+                do {
+                    try data.write(to: url)
+                } catch {
+                    throw HistoryError.cannotWrite(url)
+                }
+
+            case .vaca:
+                let fd = open(url.path, O_WRONLY | O_CREAT | O_TRUNC, 0o644)
+                guard fd >= 0 else { throw HistoryError.cannotWrite(url) }
+                defer { close(fd) }
+                guard capture_archive_write_header(fd, UInt32(sampleRate), startTimeMs) == Int32(CAPTURE_ARCHIVE_OK) else {
+                    throw HistoryError.cannotWrite(url)
+                }
+                try payload.withUnsafeBufferPointer { bytes in
+                    for frame in frames where frame.length <= UInt32(UInt16.max) {
+                        let result = capture_archive_append(fd, frame.frame_no, frame.timestamp_ms,
+                                                            bytes.baseAddress! + Int(frame.offset), UInt16(frame.length))
+                        guard result == Int32(CAPTURE_ARCHIVE_OK) else { throw HistoryError.cannotWrite(url) }
+                    }
+                }
+            }
+        }
+    }
+
+    /// Owns the C rings; captured by the frame observer so they outlive it
+    private final class Rings {
+        let pointer: OpaquePointer
+
+        init(_ pointer: OpaquePointer) {
+            self.pointer = pointer
+        }
+
+        deinit {
+            flight_recorder_destroy(pointer)
+        }
+    }
+
+    static let defaultClipDirectory: URL = FileManager.default
+        .urls(for: .documentDirectory, in: .userDomainMask)[0]
+        .appendingPathComponent("Clips", isDirectory: true)
+
+    // MARK: - Properties
+
+    let name: String
+    let configuration: Configuration
+
+    /// Stream rate of the recorded frames (set on format changes)
+    var sampleRate: Int
+
+    /// Bytes held by the rings
+    let memoryBytes: Int
+
+    private let rings: Rings
+    private var observerToken: UInt?
+
+    var isRecording: Bool { observerToken != nil }
+
+    // MARK: - Initialization
+
+    init(name: String, sampleRate: Int, configuration: Configuration = Configuration()) throws {
+        var config = flight_recorder_config()
+        config.seconds = UInt32(configuration.seconds)
+        config.sample_rate = UInt32(configuration.maxSampleRate)
+        config.frames_per_second = UInt32(configuration.maxFramesPerSecond)
+        config.frames_only = 1
+        guard let pointer = flight_recorder_create(&config) else {
+            throw HistoryError.allocationFailed(seconds: configuration.seconds)
+        }
+        let capacity = flight_recorder_get_capacity(pointer)
+        self.name = name
+        self.sampleRate = sampleRate
+        self.configuration = configuration
+        self.rings = Rings(pointer)
+        self.memoryBytes = Int(capacity.payload_bytes) + Int(capacity.frames) * 32
+        print("[RewindHistory] ⏪ \(name): \(configuration.seconds) s, \(memoryBytes / 1024) KB")
+    }
+
+    deinit {
+        stop()
+    }
+
+    // MARK: - Recording
+
+    /// Keep every frame AudioHookBridge receives from now on
+    func start() {
+        guard observerToken == nil else { return }
+
+        let rings = self.rings
+        observerToken = AudioHookBridge.shared.addRawFrameObserver { alaw, length, frameNo, timestampMs in
+            flight_recorder_record_frame(rings.pointer, alaw, length, frameNo, timestampMs)
+        }
+    }
+
+    func stop() {
+        guard let token = observerToken else { return }
+        AudioHookBridge.shared.removeRawFrameObserver(token)
+        observerToken = nil
+    }
+
+    /// Keep one frame (the observer calls this path; also for injected audio)
+    func record(_ payload: UnsafePointer<UInt8>, length: Int, frameNo: UInt32, timestamp: UInt32) {
+        flight_recorder_record_frame(rings.pointer, payload, UInt32(length), frameNo, timestamp)
+    }
+
+    // MARK: - Reading
+
+    /// How far back the history currently reaches
+    var availableSeconds: TimeInterval {
+        let oldest = flight_recorder_oldest_ns(rings.pointer)
+        let now = pipeline_trace_now()
+        return oldest > 0 && now > oldest ? Double(now - oldest) / 1e9 : 0
+    }
+
+    /// Frames that arrived in [start, end)
+    func clip(from start: UInt64, to end: UInt64) -> Clip {
+        guard end > start else { return Clip(frames: [], payload: [], sampleRate: sampleRate) }
+
+        // Size the copy for the range, not the whole history
+        let capacity = flight_recorder_get_capacity(rings.pointer)
+        let seconds = Double(end - start) / 1e9
+        let frameCapacity = min(Int(capacity.frames), Int(seconds * Double(configuration.maxFramesPerSecond)) * 2 + 16)
+        let payloadCapacity = min(Int(capacity.payload_bytes), Int(seconds * Double(configuration.maxSampleRate)) * 2 + 4096)
+
+        var frames = [flight_recorder_frame](repeating: flight_recorder_frame(), count: frameCapacity)
+        var payload = [UInt8](repeating: 0, count: payloadCapacity)
+        var used: UInt32 = 0
+        let count = Int(flight_recorder_copy_range(rings.pointer, start, end, &frames, UInt32(frameCapacity),
+                                                   &payload, UInt32(payloadCapacity), &used))
+        return Clip(frames: Array(frames.prefix(count)), payload: Array(payload.prefix(Int(used))),
+                    sampleRate: sampleRate)
+    }
+
+    /// The last `seconds` up to `now` (pre-roll, "save what I just heard")
+    func clip(last seconds: TimeInterval, until now: UInt64 = pipeline_trace_now()) -> Clip {
+        let span = UInt64(max(seconds, 0) * 1e9)
+        return clip(from: now > span ? now - span : 0, to: now &+ 1)
+    }
+
+    /// Write the last `seconds` to `directory`
+    /// - Returns: The clip file
+    @discardableResult
+    func exportClip(last seconds: TimeInterval, as format: ClipFormat = .wav,
+                    to directory: URL = RewindHistory.defaultClipDirectory) throws -> URL {
+        let now = pipeline_trace_now()
+        let clip = self.clip(last: seconds, until: now)
+        guard !clip.isEmpty else { throw HistoryError.emptyClip }
+
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        let created = Date()
+        let url = directory
+            .appendingPathComponent("\(name)-clip-\(Int(created.timeIntervalSince1970))")
+            .appendingPathExtension(format.fileExtension)
+        let startTimeMs = Int64(created.timeIntervalSince1970 * 1000) - Int64((now - min(clip.startNanoseconds, now)) / 1_000_000)
+        try clip.write(as: format, to: url, startTimeMs: startTimeMs)
+
+        print("[RewindHistory] 💾 \(url.lastPathComponent): \(String(format: "%.1f", clip.duration)) s, \(clip.frames.count) frames")
+        return url
+    }
+}
@@ -0,0 +1,155 @@
+//
+//  SessionCpuMeter.c
+//  VeepaAudioTest
+//
+//  Created for many-session hosts
+//  Purpose: Lock-free per-session, per-stage thread CPU time totals
+//
+
+#include "SessionCpuMeter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROW_ALIGN 64
+
+/// One slot's totals: a cache line of its own
+typedef struct {
+    uint64_t ns[SESSION_CPU_STAGE_COUNT];   ///< (atomic)
+} __attribute__((aligned(ROW_ALIGN))) cpu_row;
+
+_Static_assert(sizeof(cpu_row) == ROW_ALIGN, "one row per cache line");
+
+struct session_cpu_meter {
+    cpu_row *rows;
+    cpu_row *sampled;           ///< Totals at the previous sample (sampler only)
+    uint64_t sampled_at_ns;     ///< CLOCK_MONOTONIC of the previous sample
+    uint32_t capacity;
+};
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+#pragma mark - Lifecycle
+
+session_cpu_meter *session_cpu_meter_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+
+    session_cpu_meter *meter = (session_cpu_meter *)calloc(1, sizeof(session_cpu_meter));
+    if (meter == NULL) return NULL;
+
+    size_t bytes = (size_t)capacity * sizeof(cpu_row);
+    meter->rows = (cpu_row *)aligned_alloc(ROW_ALIGN, bytes);
+    meter->sampled = (cpu_row *)aligned_alloc(ROW_ALIGN, bytes);
+    if (meter->rows == NULL || meter->sampled == NULL) {
+        session_cpu_meter_destroy(meter);
+        return NULL;
+    }
+    memset(meter->rows, 0, bytes);
+    memset(meter->sampled, 0, bytes);
+
+    meter->capacity = capacity;
+    meter->sampled_at_ns = clock_ns(CLOCK_MONOTONIC);
+    return meter;
+}
+
+void session_cpu_meter_destroy(session_cpu_meter *meter) {
+    if (meter == NULL) return;
+    free(meter->rows);
+    free(meter->sampled);
+    free(meter);
+}
+
+uint32_t session_cpu_meter_capacity(const session_cpu_meter *meter) {
+    return meter->capacity;
+}
+
+uint64_t session_cpu_thread_ns(void) {
+    return clock_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+#pragma mark - Charging
+
+void session_cpu_charge(session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage, uint64_t ns) {
+    if (meter == NULL || slot >= meter->capacity || (unsigned)stage >= SESSION_CPU_STAGE_COUNT) return;
+    __atomic_fetch_add(&meter->rows[slot].ns[stage], ns, __ATOMIC_RELAXED);
+}
+
+uint64_t session_cpu_lap(session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage, uint64_t since) {
+    uint64_t now = session_cpu_thread_ns();
+    session_cpu_charge(meter, slot, stage, now - since);
+    return now;
+}
+
+void session_cpu_meter_reset_slot(session_cpu_meter *meter, uint32_t slot) {
+    if (slot >= meter->capacity) return;
+    for (int stage = 0; stage < SESSION_CPU_STAGE_COUNT; stage++) {
+        __atomic_store_n(&meter->rows[slot].ns[stage], 0, __ATOMIC_RELAXED);
+    }
+}
+
+#pragma mark - Reading
+
+uint64_t session_cpu_total_ns(const session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage) {
+    if (slot >= meter->capacity || (unsigned)stage >= SESSION_CPU_STAGE_COUNT) return 0;
+    return __atomic_load_n(&meter->rows[slot].ns[stage], __ATOMIC_RELAXED);
+}
+
+uint32_t session_cpu_meter_sample(session_cpu_meter *meter, session_cpu_usage *usage, uint32_t capacity,
+                                  session_cpu_usage *host, uint64_t *window_ns) {
+    uint64_t now = clock_ns(CLOCK_MONOTONIC);
+    uint64_t window = now - meter->sampled_at_ns;
+    meter->sampled_at_ns = now;
+    if (window == 0) window = 1;
+    if (window_ns != NULL) *window_ns = window;
+
+    // ns per ns of wall time × 1000 = ms per s
+    const double scale = 1000.0 / (double)window;
+    if (host != NULL) memset(host, 0, sizeof(*host));
+
+    uint32_t written = 0;
+    for (uint32_t slot = 0; slot < meter->capacity; slot++) {
+        session_cpu_usage rates = {0};
+        for (int stage = 0; stage < SESSION_CPU_STAGE_COUNT; stage++) {
+            uint64_t total = __atomic_load_n(&meter->rows[slot].ns[stage], __ATOMIC_RELAXED);
+            uint64_t previous = meter->sampled[slot].ns[stage];
+            // Below the previous total means the slot was reset in between
+            uint64_t delta = total >= previous ? total - previous : total;
+            meter->sampled[slot].ns[stage] = total;
+
+            double rate = (double)delta * scale;
+            rates.stage_ms_per_s[stage] = rate;
+            rates.ms_per_s += rate;
+        }
+
+        if (host != NULL) {
+            for (int stage = 0; stage < SESSION_CPU_STAGE_COUNT; stage++) {
+                host->stage_ms_per_s[stage] += rates.stage_ms_per_s[stage];
+            }
+            host->ms_per_s += rates.ms_per_s;
+        }
+        if (slot < capacity && usage != NULL) {
+            usage[slot] = rates;
+            written++;
+        }
+    }
+    return written;
+}
+
+const char *session_cpu_stage_name(session_cpu_stage stage) {
+    switch (stage) {
+        case SESSION_CPU_RECEIVE: return "receive";
+        case SESSION_CPU_DECODE:  return "decode";
+        case SESSION_CPU_PROCESS: return "process";
+        case SESSION_CPU_DELIVER: return "deliver";
+        case SESSION_CPU_RENDER:  return "render";
+        case SESSION_CPU_ENCODE:  return "encode";
+        case SESSION_CPU_PUBLISH: return "publish";
+        case SESSION_CPU_OTHER:   return "other";
+        default:                  return "unknown";
+    }
+}
@@ -0,0 +1,103 @@
+//
+//  SessionCpuMeter.h
+//  VeepaAudioTest
+//
+//  Created for many-session hosts
+//  Purpose: Per-stream CPU time accounting - each pipeline task charges the
+//           thread CPU time it spent to its session and stage
+//
+//  Tasks read CLOCK_THREAD_CPUTIME_ID before and after their work (or once
+//  per stage boundary with session_cpu_lap) and add the delta to a counter
+//  indexed by session slot (the same slots as SessionTable) and stage.
+//  Thread CPU time is not charged while a thread is descheduled or blocked,
+//  so a stream that waits on the network costs nothing; one that defeats
+//  VAD or needs resampling shows up as the expensive one.
+//
+//  Each slot's counters fill exactly one 64-byte row, so threads serving
+//  different sessions never share a cache line. Charging is a relaxed
+//  fetch-add - any number of threads may charge the same slot, nothing
+//  locks or allocates, and it is safe on real-time threads.
+//
+//  Sampling turns totals into CPU-ms per second of wall time (1000 = one
+//  core fully busy) over the window since the previous sample. The previous
+//  totals are sampler state: call session_cpu_meter_sample from one thread.
+//
+
+#ifndef SessionCpuMeter_h
+#define SessionCpuMeter_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Pipeline stages time is charged to
+typedef enum {
+    SESSION_CPU_RECEIVE = 0,    ///< Polling, deduplication, activity, format detection
+    SESSION_CPU_DECODE,         ///< G.711 / ADPCM → PCM
+    SESSION_CPU_PROCESS,        ///< DSP: DC block, resampling, VAD, gain
+    SESSION_CPU_DELIVER,        ///< Capture callback and playout ring writes
+    SESSION_CPU_RENDER,         ///< Render callback pulls
+    SESSION_CPU_ENCODE,         ///< Recording and archive encoders
+    SESSION_CPU_PUBLISH,        ///< Observers and network republishing
+    SESSION_CPU_OTHER,
+    SESSION_CPU_STAGE_COUNT
+} session_cpu_stage;
+
+/// CPU rates over one sampling window
+typedef struct {
+    double ms_per_s;                                ///< All stages
+    double stage_ms_per_s[SESSION_CPU_STAGE_COUNT];
+} session_cpu_usage;
+
+typedef struct session_cpu_meter session_cpu_meter;
+
+/// @param capacity Session slots (match the SessionTable's capacity)
+/// @return NULL if allocation fails
+session_cpu_meter *session_cpu_meter_create(uint32_t capacity);
+
+void session_cpu_meter_destroy(session_cpu_meter *meter);
+
+uint32_t session_cpu_meter_capacity(const session_cpu_meter *meter);
+
+/// CPU time consumed by the calling thread, in nanoseconds (CLOCK_THREAD_CPUTIME_ID)
+uint64_t session_cpu_thread_ns(void);
+
+#pragma mark - Charging (any thread)
+
+/// Add CPU time to a session's stage (out-of-range slots are ignored)
+void session_cpu_charge(session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage, uint64_t ns);
+
+/// Charge the thread CPU time since `since` (a session_cpu_thread_ns
+/// reading) and return the current reading, so consecutive stages cost one
+/// clock read each:
+///
+///     uint64_t lap = session_cpu_thread_ns();
+///     decode(...);  lap = session_cpu_lap(meter, slot, SESSION_CPU_DECODE, lap);
+///     deliver(...); lap = session_cpu_lap(meter, slot, SESSION_CPU_DELIVER, lap);
+uint64_t session_cpu_lap(session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage, uint64_t since);
+
+/// Zero a slot's totals, e.g. when SessionTable hands it to a new stream
+void session_cpu_meter_reset_slot(session_cpu_meter *meter, uint32_t slot);
+
+#pragma mark - Reading
+
+/// Nanoseconds charged to a session's stage since it was reset
+uint64_t session_cpu_total_ns(const session_cpu_meter *meter, uint32_t slot, session_cpu_stage stage);
+
+/// Rates since the previous sample (or since creation), one entry per slot
+/// @param usage Receives min(capacity, meter capacity) entries
+/// @param host Optional: every slot's rates summed (per stage and overall)
+/// @param window_ns Optional: length of the window sampled
+/// @return Entries written
+uint32_t session_cpu_meter_sample(session_cpu_meter *meter, session_cpu_usage *usage, uint32_t capacity,
+                                  session_cpu_usage *host, uint64_t *window_ns);
+
+const char *session_cpu_stage_name(session_cpu_stage stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SessionCpuMeter_h */
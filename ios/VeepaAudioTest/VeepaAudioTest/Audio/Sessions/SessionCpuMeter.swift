@@ -0,0 +1,139 @@
+//
+//  SessionCpuMeter.swift
+//  VeepaAudioTest
+//
+//  Created for many-session hosts
+//  Purpose: Swift access to per-session CPU accounting - charge pipeline
+//           work to a session and stage, and sample CPU-ms/s per session,
+//           per stage and for the whole host
+//
+//  The counters live in SessionCpuMeter.c. The bridge's meter covers the
+//  SDK voice session (AudioHookBridge.cpuMeter); a gateway serving many
+//  cameras creates one sized like its SessionTable and charges each
+//  camera's reader, worker and render tasks to that camera's slot.
+//
+
+import Foundation
+
+final class SessionCpuMeter {
+
+    enum MeterError: Error, LocalizedError {
+        case creationFailed(capacity: Int)
+
+        var errorDescription: String? {
+            switch self {
+            case .creationFailed(let capacity):
+                return "Cannot allocate a CPU meter for \(capacity) sessions"
+            }
+        }
+    }
+
+    /// Pipeline stage CPU time is charged to
+    enum Stage: Int, CaseIterable {
+        case receive, decode, process, deliver, render, encode, publish, other
+
+        var cValue: session_cpu_stage { session_cpu_stage(UInt32(rawValue)) }
+        var name: String { String(cString: session_cpu_stage_name(cValue)) }
+    }
+
+    /// CPU-ms per second of wall time (1000 = one core) over a sample window
+    struct Usage {
+        let msPerSecond: Double
+        let stageMsPerSecond: [Double]   // Indexed by Stage.rawValue
+
+        subscript(stage: Stage) -> Double { stageMsPerSecond[stage.rawValue] }
+
+        fileprivate init(_ usage: session_cpu_usage) {
+            var stages = usage.stage_ms_per_s
+            stageMsPerSecond = withUnsafeBytes(of: &stages) { Array($0.bindMemory(to: Double.self)) }
+            msPerSecond = usage.ms_per_s
+        }
+
+        /// "1.24 ms/s (decode 0.61, render 0.40, …)", stages above 0.005 ms/s, most expensive first
+        var description: String {
+            let stages = Stage.allCases
+                .filter { self[$0] >= 0.005 }
+                .sorted { self[$0] > self[$1] }
+                .map { "\($0.name) \(String(format: "%.2f", self[$0]))" }
+            let total = String(format: "%.2f ms/s", msPerSecond)
+            return stages.isEmpty ? total : "\(total) (\(stages.joined(separator: ", ")))"
+        }
+    }
+
+    /// One sampling window
+    struct Sample {
+        let windowSeconds: Double
+        let sessions: [Usage]            // Indexed by session slot
+        let host: Usage
+
+        /// Slots ordered by cost, most expensive first (noisy neighbours on top)
+        var ranked: [(slot: session_slot, usage: Usage)] {
+            sessions.indices
+                .map { (session_slot($0), sessions[$0]) }
+                .filter { $0.1.msPerSecond > 0 }
+                .sorted { $0.1.msPerSecond > $1.1.msPerSecond }
+        }
+    }
+
+    let meter: OpaquePointer
+    private let owned: Bool
+
+    /// New meter with its own counters
+    init(capacity: Int) throws {
+        guard let meter = session_cpu_meter_create(UInt32(capacity)) else {
+            throw MeterError.creationFailed(capacity: capacity)
+        }
+        self.meter = meter
+        self.owned = true
+    }
+
+    /// Wrap a meter owned elsewhere (e.g. AudioHookBridge.cpuMeter)
+    init(unowned meter: OpaquePointer) {
+        self.meter = meter
+        self.owned = false
+    }
+
+    deinit {
+        if owned {
+            session_cpu_meter_destroy(meter)
+        }
+    }
+
+    var capacity: Int { Int(session_cpu_meter_capacity(meter)) }
+
+    // MARK: - Charging
+
+    /// Run `body` and charge the thread CPU time it used (safe on real-time threads)
+    @inline(__always)
+    func measure<T>(_ slot: session_slot, _ stage: Stage, _ body: () throws -> T) rethrows -> T {
+        let start = session_cpu_thread_ns()
+        defer { _ = session_cpu_lap(meter, slot, stage.cValue, start) }
+        return try body()
+    }
+
+    func charge(_ slot: session_slot, _ stage: Stage, nanoseconds: UInt64) {
+        session_cpu_charge(meter, slot, stage.cValue, nanoseconds)
+    }
+
+    /// Zero a slot when it is handed to a new stream
+    func resetSession(_ slot: session_slot) {
+        session_cpu_meter_reset_slot(meter, slot)
+    }
+
+    // MARK: - Reading
+
+    func totalNanoseconds(_ slot: session_slot, _ stage: Stage) -> UInt64 {
+        session_cpu_total_ns(meter, slot, stage.cValue)
+    }
+
+    /// Rates since the previous sample; call from one thread (e.g. the health check timer)
+    func sample() -> Sample {
+        var usage = [session_cpu_usage](repeating: session_cpu_usage(), count: capacity)
+        var host = session_cpu_usage()
+        var window: UInt64 = 0
+        let count = Int(session_cpu_meter_sample(meter, &usage, UInt32(usage.count), &host, &window))
+        return Sample(windowSeconds: Double(window) / 1e9,
+                      sessions: usage.prefix(count).map(Usage.init),
+                      host: Usage(host))
+    }
+}
@@ -0,0 +1,308 @@
+//
+//  SessionTable.c
+//  VeepaAudioTest
+//
+//  Created for many-session hosts
+//  Purpose: Structure-of-arrays per-stream state indexed by session slot
+//
+
+#include "SessionTable.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define COLUMN_ALIGN 64
+
+struct session_table {
+    session_hot_columns columns;
+    session_cold *cold;
+    uint32_t capacity;
+    uint32_t high_water;
+    uint64_t epoch_ns;
+    void *block;                ///< Backing allocation of every hot column
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static size_t align_up(size_t value) {
+    return (value + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1);
+}
+
+/// Carve the next 64-byte aligned column out of the block
+static void *take_column(uint8_t **cursor, size_t bytes) {
+    void *column = *cursor;
+    *cursor += align_up(bytes);
+    return column;
+}
+
+static inline void store_u32(uint32_t *column, session_slot slot, uint32_t value) {
+    __atomic_store_n(&column[slot], value, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t load_u32(const uint32_t *column, session_slot slot) {
+    return __atomic_load_n(&column[slot], __ATOMIC_RELAXED);
+}
+
+#pragma mark - Lifecycle
+
+session_table *session_table_create(uint32_t capacity) {
+    if (capacity == 0) return NULL;
+
+    session_table *table = (session_table *)calloc(1, sizeof(session_table));
+    if (table == NULL) return NULL;
+
+    size_t n = capacity;
+    size_t bytes = align_up(n)                       // state
+                 + 10 * align_up(n * sizeof(uint32_t))
+                 + 2 * align_up(n * sizeof(int16_t));
+    table->block = aligned_alloc(COLUMN_ALIGN, bytes);
+    table->cold = (session_cold *)calloc(n, sizeof(session_cold));
+    if (table->block == NULL || table->cold == NULL) {
+        session_table_destroy(table);
+        return NULL;
+    }
+    memset(table->block, 0, bytes);
+
+    uint8_t *cursor = (uint8_t *)table->block;
+    session_hot_columns *columns = &table->columns;
+    columns->state             = (uint8_t *)take_column(&cursor, n);
+    columns->last_frame_no     = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->last_timestamp_ms = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->last_arrival_ms   = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->frames            = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->lost_frames       = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->jitter_q4         = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->decode_skipped    = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->level_cb          = (int16_t *)take_column(&cursor, n * sizeof(int16_t));
+    columns->peak_cb           = (int16_t *)take_column(&cursor, n * sizeof(int16_t));
+    columns->ring_write        = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->ring_read         = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+    columns->keepalive_due_ms  = (uint32_t *)take_column(&cursor, n * sizeof(uint32_t));
+
+    table->capacity = capacity;
+    table->epoch_ns = monotonic_ns();
+    return table;
+}
+
+void session_table_destroy(session_table *table) {
+    if (table == NULL) return;
+    free(table->block);
+    free(table->cold);
+    free(table);
+}
+
+uint32_t session_table_capacity(const session_table *table) {
+    return table->capacity;
+}
+
+uint32_t session_table_high_water(const session_table *table) {
+    return __atomic_load_n(&table->high_water, __ATOMIC_ACQUIRE);
+}
+
+uint32_t session_table_now_ms(const session_table *table) {
+    return (uint32_t)((monotonic_ns() - table->epoch_ns) / 1000000ull);
+}
+
+#pragma mark - Slots
+
+session_slot session_table_acquire(session_table *table) {
+    session_hot_columns *columns = &table->columns;
+    for (uint32_t slot = 0; slot < table->capacity; slot++) {
+        if (__atomic_load_n(&columns->state[slot], __ATOMIC_RELAXED) != SESSION_STATE_FREE) continue;
+
+        store_u32(columns->last_frame_no, slot, 0);
+        store_u32(columns->last_timestamp_ms, slot, 0);
+        store_u32(columns->last_arrival_ms, slot, 0);
+        store_u32(columns->frames, slot, 0);
+        store_u32(columns->lost_frames, slot, 0);
+        store_u32(columns->jitter_q4, slot, 0);
+        store_u32(columns->decode_skipped, slot, 0);
+        __atomic_store_n(&columns->level_cb[slot], SESSION_LEVEL_SILENT, __ATOMIC_RELAXED);
+        __atomic_store_n(&columns->peak_cb[slot], SESSION_LEVEL_SILENT, __ATOMIC_RELAXED);
+        store_u32(columns->ring_write, slot, 0);
+        store_u32(columns->ring_read, slot, 0);
+        store_u32(columns->keepalive_due_ms, slot, 0);
+        memset(&table->cold[slot], 0, sizeof(session_cold));
+        table->cold[slot].created_ms = session_table_now_ms(table);
+
+        // Publish the reset columns before the slot becomes visible to sweeps
+        __atomic_store_n(&columns->state[slot], SESSION_STATE_ACTIVE, __ATOMIC_RELEASE);
+        if (slot >= table->high_water) {
+            __atomic_store_n(&table->high_water, slot + 1, __ATOMIC_RELEASE);
+        }
+        return slot;
+    }
+    return SESSION_SLOT_NONE;
+}
+
+void session_table_release(session_table *table, session_slot slot) {
+    if (slot >= table->capacity) return;
+    __atomic_store_n(&table->columns.state[slot], SESSION_STATE_FREE, __ATOMIC_RELEASE);
+
+    uint32_t high_water = table->high_water;
+    while (high_water > 0 &&
+           __atomic_load_n(&table->columns.state[high_water - 1], __ATOMIC_RELAXED) == SESSION_STATE_FREE) {
+        high_water--;
+    }
+    __atomic_store_n(&table->high_water, high_water, __ATOMIC_RELEASE);
+}
+
+session_cold *session_table_cold(session_table *table, session_slot slot) {
+    return slot < table->capacity ? &table->cold[slot] : NULL;
+}
+
+const session_hot_columns *session_table_columns(const session_table *table) {
+    return &table->columns;
+}
+
+#pragma mark - Updates
+
+int16_t session_level_from_dbfs(double dbfs) {
+    if (!(dbfs > -327.0)) return SESSION_LEVEL_SILENT;   // also catches -inf / NaN
+    if (dbfs > 327.0) return INT16_MAX;
+    return (int16_t)lrint(dbfs * 100.0);
+}
+
+double session_level_to_dbfs(int16_t centibels) {
+    return centibels == SESSION_LEVEL_SILENT ? -INFINITY : centibels / 100.0;
+}
+
+void session_table_on_frame(session_table *table, session_slot slot, uint32_t frame_no,
+                            uint32_t timestamp_ms, double level_dbfs, double peak_dbfs, int decoded) {
+    if (slot >= table->capacity) return;
+    session_hot_columns *columns = &table->columns;
+
+    uint32_t frames = load_u32(columns->frames, slot);
+    uint32_t gap = frame_no - load_u32(columns->last_frame_no, slot);
+    if (frames > 0 && gap > 1 && gap < 0x10000) {
+        store_u32(columns->lost_frames, slot, load_u32(columns->lost_frames, slot) + gap - 1);
+    }
+    if (!decoded) {
+        store_u32(columns->decode_skipped, slot, load_u32(columns->decode_skipped, slot) + 1);
+    }
+
+    // Jitter: how much the arrival spacing differs from the timestamp
+    // spacing, smoothed over ~16 frames (RFC 3550 6.4.1, kept scaled by 16)
+    uint32_t arrival_ms = session_table_now_ms(table);
+    if (frames > 0) {
+        int32_t transit_change = (int32_t)(arrival_ms - load_u32(columns->last_arrival_ms, slot))
+                               - (int32_t)(timestamp_ms - load_u32(columns->last_timestamp_ms, slot));
+        uint32_t deviation = transit_change < 0 ? (uint32_t)-transit_change : (uint32_t)transit_change;
+        uint32_t jitter = load_u32(columns->jitter_q4, slot);
+        store_u32(columns->jitter_q4, slot, jitter + deviation - ((jitter + 8) >> 4));
+    }
+
+    store_u32(columns->frames, slot, frames + 1);
+    store_u32(columns->last_frame_no, slot, frame_no);
+    store_u32(columns->last_timestamp_ms, slot, timestamp_ms);
+    store_u32(columns->last_arrival_ms, slot, arrival_ms);
+    __atomic_store_n(&columns->level_cb[slot], session_level_from_dbfs(level_dbfs), __ATOMIC_RELAXED);
+    __atomic_store_n(&columns->peak_cb[slot], session_level_from_dbfs(peak_dbfs), __ATOMIC_RELAXED);
+}
+
+void session_table_set_state(session_table *table, session_slot slot, uint8_t state) {
+    if (slot >= table->capacity || state == SESSION_STATE_FREE) return;
+    __atomic_store_n(&table->columns.state[slot], state, __ATOMIC_RELEASE);
+}
+
+void session_table_set_last_frame_no(session_table *table, session_slot slot, uint32_t frame_no) {
+    if (slot >= table->capacity) return;
+    store_u32(table->columns.last_frame_no, slot, frame_no);
+}
+
+void session_table_set_ring(session_table *table, session_slot slot, uint32_t write, uint32_t read) {
+    if (slot >= table->capacity) return;
+    store_u32(table->columns.ring_write, slot, write);
+    store_u32(table->columns.ring_read, slot, read);
+}
+
+void session_table_schedule_keepalive(session_table *table, session_slot slot, uint32_t due_ms) {
+    if (slot >= table->capacity) return;
+    store_u32(table->columns.keepalive_due_ms, slot, due_ms);
+}
+
+#pragma mark - Sweep
+
+void session_table_sweep(session_table *table, uint32_t now_ms, const session_sweep_config *config,
+                         session_sweep_result *result) {
+    const uint32_t end = session_table_high_water(table);
+    const session_hot_columns *columns = &table->columns;
+    // Plain loads: the sweep tolerates a slot that changes under it (it is
+    // reported with either value this pass), and this keeps the loops vectorizable
+    const uint8_t *restrict state = columns->state;
+    const int16_t *restrict level = columns->level_cb;
+    const uint32_t *restrict ring_write = columns->ring_write;
+    const uint32_t *restrict ring_read = columns->ring_read;
+    const uint32_t *restrict frames = columns->frames;
+    const uint32_t *restrict arrival = columns->last_arrival_ms;
+    uint32_t *restrict keepalive = columns->keepalive_due_ms;
+
+    const uint32_t low_watermark = config->low_watermark;
+    const uint32_t stale_after = config->stale_after_ms;
+    const int16_t silence = config->silence_cb;
+
+    // Pass 1: counters over four narrow columns, branch-free
+    uint32_t active = 0, audible = 0, starving = 0;
+    int16_t loudest_cb = SESSION_LEVEL_SILENT;
+    for (uint32_t slot = 0; slot < end; slot++) {
+        uint32_t live = state[slot] != SESSION_STATE_FREE;
+        int16_t cb = live ? level[slot] : SESSION_LEVEL_SILENT;
+        active += live;
+        audible += cb > silence;
+        starving += live & (ring_write[slot] - ring_read[slot] < low_watermark);
+        loudest_cb = cb > loudest_cb ? cb : loudest_cb;
+    }
+
+    session_slot loudest = SESSION_SLOT_NONE;
+    if (loudest_cb > silence) {
+        for (uint32_t slot = 0; slot < end; slot++) {
+            if (state[slot] != SESSION_STATE_FREE && level[slot] == loudest_cb) {
+                loudest = slot;
+                break;
+            }
+        }
+    } else {
+        loudest_cb = SESSION_LEVEL_SILENT;
+    }
+
+    // Pass 2: stale sessions and due keep-alives are rare per sweep, so
+    // these branches predict well
+    session_slot *const stale_list = result->stale;
+    session_slot *const due_list = result->due;
+    const uint32_t stale_capacity = result->stale_capacity;
+    const uint32_t due_capacity = result->due_capacity;
+    uint32_t next_keepalive = now_ms + config->keepalive_interval_ms;
+    if (next_keepalive == 0) next_keepalive = 1;
+
+    uint32_t stale = 0, due = 0;
+    for (uint32_t slot = 0; slot < end; slot++) {
+        if (state[slot] == SESSION_STATE_FREE) continue;
+
+        if (frames[slot] > 0 && now_ms - arrival[slot] > stale_after) {
+            if (stale < stale_capacity) stale_list[stale] = slot;
+            stale++;
+        }
+
+        // Signed distance copes with the millisecond clock wrapping
+        uint32_t due_ms = keepalive[slot];
+        if (due_ms != 0 && (int32_t)(now_ms - due_ms) >= 0) {
+            if (due < due_capacity) due_list[due] = slot;
+            due++;
+            __atomic_store_n(&keepalive[slot], next_keepalive, __ATOMIC_RELAXED);
+        }
+    }
+
+    result->active = active;
+    result->audible = audible;
+    result->starving = starving;
+    result->stale_count = stale;
+    result->due_count = due;
+    result->loudest = loudest;
+    result->loudest_cb = loudest_cb;
+}
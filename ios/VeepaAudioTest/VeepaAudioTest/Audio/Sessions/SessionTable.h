@@ -0,0 +1,150 @@
+//
+//  SessionTable.h
+//  VeepaAudioTest
+//
+//  Created for many-session hosts
+//  Purpose: Per-stream state in structure-of-arrays form, indexed by
+//           session slot, so sweeps over thousands of sessions are linear
+//           scans of a few contiguous arrays
+//
+//  Hot fields - the ones touched per frame or by periodic sweeps (health
+//  check, metering, keep-alive) - live in separate 64-byte aligned columns
+//  (session_hot_columns). Everything else about a session (name, client
+//  pointer, configuration) lives in session_cold, which sweeps never read.
+//
+//  Threading: one writer per slot (its capture thread) and one sweeper;
+//  acquire/release are called from a single control thread.
+//  Per-frame updates store each column with a relaxed atomic, so readers on
+//  other threads see every field whole, though not necessarily all fields
+//  of the same frame; a sweep reports a slot updated under it with either
+//  value. Levels are int16 centibels so they stay integral and narrow.
+//
+
+#ifndef SessionTable_h
+#define SessionTable_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t session_slot;
+
+#define SESSION_SLOT_NONE       UINT32_MAX
+/// Level column value for "no signal measured" (-inf dBFS)
+#define SESSION_LEVEL_SILENT    (-32768)
+
+/// Values of the state column
+enum {
+    SESSION_STATE_FREE   = 0,
+    SESSION_STATE_ACTIVE = 1,
+    SESSION_STATE_MUTED  = 2,   ///< Active, but nobody is listening (lazy decode)
+};
+
+/// Hot columns; element i belongs to slot i
+typedef struct {
+    uint8_t  *state;             ///< SESSION_STATE_*
+    uint32_t *last_frame_no;     ///< Deduplication / loss detection
+    uint32_t *last_timestamp_ms; ///< app_frame_header.timestamp
+    uint32_t *last_arrival_ms;   ///< session_table_now_ms() at the last frame
+    uint32_t *frames;
+    uint32_t *lost_frames;
+    uint32_t *jitter_q4;         ///< Interarrival jitter (RFC 3550), ms × 16
+    uint32_t *decode_skipped;
+    int16_t  *level_cb;          ///< RMS of the last frame, centibels (dBFS × 100)
+    int16_t  *peak_cb;
+    uint32_t *ring_write;        ///< Playout ring indices (samples, wrapping)
+    uint32_t *ring_read;
+    uint32_t *keepalive_due_ms;  ///< 0 = no keep-alive scheduled
+} session_hot_columns;
+
+/// Cold per-session state (never touched by sweeps)
+typedef struct {
+    char     name[64];
+    void    *client;             ///< P2P client pointer
+    uint32_t sample_rate;
+    uint32_t created_ms;
+    void    *context;            ///< Owner's object
+} session_cold;
+
+typedef struct {
+    uint32_t stale_after_ms;      ///< No frame for this long → stale
+    uint32_t keepalive_interval_ms; ///< Due keep-alives are rescheduled by this much
+    uint32_t low_watermark;       ///< Fewer buffered samples → starving
+    int16_t  silence_cb;          ///< Level at or below → silent
+} session_sweep_config;
+
+typedef struct {
+    // Caller-provided output lists (may be NULL with capacity 0; counts still total)
+    session_slot *stale;
+    uint32_t stale_capacity;
+    session_slot *due;
+    uint32_t due_capacity;
+
+    uint32_t active;
+    uint32_t audible;             ///< Active with level above silence_cb
+    uint32_t starving;            ///< Active with ring below low_watermark
+    uint32_t stale_count;
+    uint32_t due_count;
+    session_slot loudest;
+    int16_t loudest_cb;
+} session_sweep_result;
+
+typedef struct session_table session_table;
+
+/// @param capacity Maximum concurrent sessions
+/// @return NULL if allocation fails
+session_table *session_table_create(uint32_t capacity);
+
+void session_table_destroy(session_table *table);
+
+uint32_t session_table_capacity(const session_table *table);
+
+/// Slots in use are all below this bound (sweeps stop here)
+uint32_t session_table_high_water(const session_table *table);
+
+/// Milliseconds since the table was created (CLOCK_MONOTONIC)
+uint32_t session_table_now_ms(const session_table *table);
+
+/// Claim the lowest free slot and reset its columns
+/// @return Slot, or SESSION_SLOT_NONE when full
+session_slot session_table_acquire(session_table *table);
+
+void session_table_release(session_table *table, session_slot slot);
+
+session_cold *session_table_cold(session_table *table, session_slot slot);
+
+/// Column pointers for custom sweeps
+const session_hot_columns *session_table_columns(const session_table *table);
+
+/// Record one received frame: sequence, loss, arrival, jitter and level
+/// @param level_dbfs RMS of the frame (-inf for silence)
+/// @param decoded Whether the frame was decoded (else counts as decode-skipped)
+void session_table_on_frame(session_table *table, session_slot slot, uint32_t frame_no,
+                            uint32_t timestamp_ms, double level_dbfs, double peak_dbfs, int decoded);
+
+void session_table_set_state(session_table *table, session_slot slot, uint8_t state);
+
+/// Reset deduplication (the next frame is never treated as a duplicate of an old one)
+void session_table_set_last_frame_no(session_table *table, session_slot slot, uint32_t frame_no);
+
+void session_table_set_ring(session_table *table, session_slot slot, uint32_t write, uint32_t read);
+
+void session_table_schedule_keepalive(session_table *table, session_slot slot, uint32_t due_ms);
+
+/// One linear pass over the hot columns: health (stale, starving), metering
+/// (audible, loudest) and keep-alives due at `now_ms` (rescheduled)
+void session_table_sweep(session_table *table, uint32_t now_ms, const session_sweep_config *config,
+                         session_sweep_result *result);
+
+/// Centibel helpers
+int16_t session_level_from_dbfs(double dbfs);
+double session_level_to_dbfs(int16_t centibels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SessionTable_h */
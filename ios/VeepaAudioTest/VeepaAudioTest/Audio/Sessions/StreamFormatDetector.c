@@ -0,0 +1,159 @@
+//
+//  StreamFormatDetector.c
+//  VeepaAudioTest
+//
+//  Created for mixed 8 kHz / 16 kHz camera fleets
+//  Purpose: Sample rate and frame size from timestamps and arrival cadence
+//
+
+#include "StreamFormatDetector.h"
+
+#include <math.h>
+#include <string.h>
+
+static const uint32_t kStandardRates[] = { 8000, 11025, 16000, 22050, 32000, 44100, 48000 };
+
+/// Arrival time needed before arrival cadence may veto the timestamps
+static const uint32_t kArrivalCheckMs = 300;
+
+void stream_format_config_init(stream_format_config *config) {
+    config->window_ms = 1000;
+    config->min_frames = 4;
+    config->min_span_ms = 150;
+    config->tolerance_permille = 80;
+    config->fallback_rate = 8000;
+}
+
+void stream_format_detector_init(stream_format_detector *detector, const stream_format_config *config) {
+    memset(detector, 0, sizeof(*detector));
+    if (config) {
+        detector->config = *config;
+    } else {
+        stream_format_config_init(&detector->config);
+    }
+}
+
+uint32_t stream_format_snap_rate(double estimate, uint32_t tolerance_permille) {
+    if (!(estimate > 0)) return 0;
+    uint32_t best = 0;
+    double best_error = 0;
+    for (size_t i = 0; i < sizeof(kStandardRates) / sizeof(kStandardRates[0]); i++) {
+        double error = fabs(estimate - kStandardRates[i]) / kStandardRates[i];
+        if (best == 0 || error < best_error) {
+            best = kStandardRates[i];
+            best_error = error;
+        }
+    }
+    return best_error * 1000 <= tolerance_permille ? best : 0;
+}
+
+#pragma mark - Evidence
+
+static void count_size(stream_format_detector *detector, uint32_t length) {
+    uint32_t rarest = 0;
+    for (uint32_t i = 0; i < STREAM_FORMAT_SIZE_BINS; i++) {
+        if (detector->size_counts[i] > 0 && detector->sizes[i] == length) {
+            detector->size_counts[i]++;
+            return;
+        }
+        if (detector->size_counts[i] < detector->size_counts[rarest]) rarest = i;
+    }
+    // New size replaces the rarest one (sizes beyond the bins are noise)
+    detector->sizes[rarest] = length;
+    detector->size_counts[rarest] = 1;
+}
+
+static uint32_t common_size(const stream_format_detector *detector) {
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < STREAM_FORMAT_SIZE_BINS; i++) {
+        if (detector->size_counts[i] > detector->size_counts[best]) best = i;
+    }
+    return detector->size_counts[best] > 0 ? detector->sizes[best] : 0;
+}
+
+/// Samples per second of stream time, from frames spanned and timestamps
+static double timestamp_rate(const stream_format_detector *detector, uint32_t frame_samples) {
+    uint32_t span_ms = detector->last_timestamp_ms - detector->first_timestamp_ms;
+    uint32_t frames_spanned = detector->last_frame_no - detector->first_frame_no;
+    // Frame numbers that jump or run backwards say nothing about losses
+    if (frames_spanned == 0 || frames_spanned > 4 * detector->frames) {
+        frames_spanned = detector->frames - 1;
+    }
+    if (span_ms == 0 || span_ms > 0x7FFFFFFF || frames_spanned == 0) return 0;
+    return (double)frames_spanned * frame_samples * 1000.0 / span_ms;
+}
+
+/// Bytes per second of wall-clock time
+static double arrival_rate(const stream_format_detector *detector) {
+    uint32_t span_ms = detector->last_arrival_ms - detector->first_arrival_ms;
+    if (span_ms == 0) return 0;
+    return (double)detector->bytes_after_first * 1000.0 / span_ms;
+}
+
+static void decide(stream_format_detector *detector, uint32_t rate, uint32_t frame_samples,
+                   stream_format_source source) {
+    detector->format.sample_rate = rate;
+    detector->format.frame_samples = frame_samples;
+    detector->format.frame_ms = rate ? (uint32_t)(((uint64_t)frame_samples * 1000 + rate / 2) / rate) : 0;
+    detector->format.source = source;
+    detector->decided = 1;
+}
+
+#pragma mark - Detection
+
+int stream_format_detector_observe(stream_format_detector *detector, uint32_t frame_no, uint32_t length,
+                                   uint32_t timestamp_ms, uint32_t arrival_ms) {
+    if (detector->decided || length == 0) return 0;
+
+    if (detector->frames == 0) {
+        detector->first_frame_no = frame_no;
+        detector->first_timestamp_ms = timestamp_ms;
+        detector->first_arrival_ms = arrival_ms;
+    } else {
+        detector->bytes_after_first += length;
+    }
+    detector->frames++;
+    detector->last_frame_no = frame_no;
+    detector->last_timestamp_ms = timestamp_ms;
+    detector->last_arrival_ms = arrival_ms;
+    count_size(detector, length);
+
+    const stream_format_config *config = &detector->config;
+    uint32_t frame_samples = common_size(detector);
+    uint32_t arrival_span = arrival_ms - detector->first_arrival_ms;
+
+    if (detector->frames >= config->min_frames &&
+        timestamp_ms - detector->first_timestamp_ms >= config->min_span_ms) {
+        uint32_t rate = stream_format_snap_rate(timestamp_rate(detector, frame_samples), config->tolerance_permille);
+        if (rate != 0) {
+            // Timestamps in some other unit would be off by a large factor;
+            // arrival cadence catches that once it has seen enough time
+            double arrival = arrival_span >= kArrivalCheckMs ? arrival_rate(detector) : 0;
+            if (arrival == 0 || (arrival > rate / 2.0 && arrival < rate * 2.0)) {
+                decide(detector, rate, frame_samples, STREAM_FORMAT_TIMESTAMPS);
+                return 1;
+            }
+        }
+    }
+
+    if (arrival_span >= config->window_ms) {
+        stream_format_detector_finish(detector);
+        return 1;
+    }
+    return 0;
+}
+
+stream_format stream_format_detector_finish(stream_format_detector *detector) {
+    if (!detector->decided) {
+        uint32_t frame_samples = common_size(detector);
+        uint32_t rate = detector->frames > 1
+                      ? stream_format_snap_rate(arrival_rate(detector), detector->config.tolerance_permille * 2)
+                      : 0;
+        if (rate != 0) {
+            decide(detector, rate, frame_samples, STREAM_FORMAT_ARRIVAL);
+        } else {
+            decide(detector, detector->config.fallback_rate, frame_samples, STREAM_FORMAT_FALLBACK);
+        }
+    }
+    return detector->format;
+}
@@ -0,0 +1,103 @@
+//
+//  StreamFormatDetector.h
+//  VeepaAudioTest
+//
+//  Created for mixed 8 kHz / 16 kHz camera fleets
+//  Purpose: Infer a stream's sample rate and frame size from its first
+//           second of frames, so playback needs no per-camera setting
+//
+//  G.711 carries one byte per sample, so a frame's payload size is its
+//  sample count - but nothing in the frame says how long those samples
+//  last. Two clocks do:
+//
+//    - head.timestamp (ms): samples spanned between two frames over the
+//      timestamp difference gives the rate directly. Frame numbers account
+//      for lost frames, so losses do not bias the estimate.
+//    - Arrival time: bytes received over wall-clock time. Noisier (network
+//      jitter, startup bursts) and biased by loss, so it is used to confirm
+//      the timestamps, or alone when timestamps do not advance.
+//
+//  Estimates snap to the nearest standard rate within a tolerance. The
+//  decision is made as soon as timestamps give a consistent answer (a few
+//  frames), or at the end of the window from arrival cadence, or falls back
+//  to the configured default rate.
+//
+//  Threading: one detector per stream, fed from that stream's capture
+//  thread. Plain struct, no allocation - embed it wherever the stream
+//  state lives.
+//
+
+#ifndef StreamFormatDetector_h
+#define StreamFormatDetector_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STREAM_FORMAT_SIZE_BINS 4
+
+/// Which evidence decided the format
+typedef enum {
+    STREAM_FORMAT_UNDECIDED  = 0,
+    STREAM_FORMAT_TIMESTAMPS = 1,  ///< head.timestamp progression (confirmed by arrival if available)
+    STREAM_FORMAT_ARRIVAL    = 2,  ///< Arrival cadence over the window
+    STREAM_FORMAT_FALLBACK   = 3,  ///< No usable evidence; default rate
+} stream_format_source;
+
+typedef struct {
+    uint32_t sample_rate;           ///< Hz
+    uint32_t frame_samples;         ///< Most common payload size (= samples for G.711)
+    uint32_t frame_ms;              ///< Duration of one frame, rounded
+    stream_format_source source;
+} stream_format;
+
+typedef struct {
+    uint32_t window_ms;             ///< Decide by this much arrival time at the latest
+    uint32_t min_frames;            ///< Frames before timestamps may decide
+    uint32_t min_span_ms;           ///< Timestamp span before timestamps may decide
+    uint32_t tolerance_permille;    ///< Max distance from a standard rate
+    uint32_t fallback_rate;         ///< Used when nothing else decides
+} stream_format_config;
+
+typedef struct {
+    stream_format_config config;
+    stream_format format;           ///< Valid once `decided`
+    int decided;
+
+    uint32_t frames;
+    uint32_t first_frame_no, last_frame_no;
+    uint32_t first_timestamp_ms, last_timestamp_ms;
+    uint32_t first_arrival_ms, last_arrival_ms;
+    uint64_t bytes_after_first;     ///< Payload received after the first frame
+    uint32_t sizes[STREAM_FORMAT_SIZE_BINS];
+    uint32_t size_counts[STREAM_FORMAT_SIZE_BINS];
+} stream_format_detector;
+
+/// Defaults: 1000 ms window, 4 frames / 150 ms of timestamps, 8% tolerance,
+/// 8000 Hz fallback (the rate the vendor documents as common)
+void stream_format_config_init(stream_format_config *config);
+
+/// @param config NULL for defaults
+void stream_format_detector_init(stream_format_detector *detector, const stream_format_config *config);
+
+/// Feed one received (deduplicated) frame
+/// @param arrival_ms Local monotonic receive time
+/// @return 1 if this frame completed the detection, 0 otherwise
+int stream_format_detector_observe(stream_format_detector *detector, uint32_t frame_no, uint32_t length,
+                                   uint32_t timestamp_ms, uint32_t arrival_ms);
+
+/// Decide now with whatever has been seen (e.g. the stream stopped early)
+/// @return The decided format
+stream_format stream_format_detector_finish(stream_format_detector *detector);
+
+/// Standard rate nearest to `estimate` within `tolerance_permille`, or 0
+uint32_t stream_format_snap_rate(double estimate, uint32_t tolerance_permille);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* StreamFormatDetector_h */
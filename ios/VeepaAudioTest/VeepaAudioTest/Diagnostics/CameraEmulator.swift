@@ -0,0 +1,270 @@
+//
+//  CameraEmulator.swift
+//  VeepaAudioTest
+//
+//  Created for time-to-first-audio work
+//  Purpose: Local stand-in for a camera so the capture → decode → playout
+//           pipeline can be driven (and benchmarked) without a device
+//
+//  Produces G.711 A-law (or IMA ADPCM) voice frames at real-time cadence
+//  with the same header fields the SDK's voice_frame carries (frameno,
+//  timestamp in ms, ADPCM predictor state).
+//  Frames are handed to `onFrame`; `feedHookBridge()` wires them into
+//  AudioHookBridge's decode path exactly like SDK frames. `handleCgi(_:)`
+//  answers the audio CGI commands, so parameter negotiation can be tested
+//  against it as well, and `Link` models a congested connection for
+//  benchmarks in virtual time.
+//
+
+import Foundation
+
+/// Synthetic camera audio source
+final class CameraEmulator {
+
+    // MARK: - Types
+
+    struct Configuration {
+        /// Audio sample rate of the emulated camera
+        var sampleRate: Int = 16000
+
+        /// Samples (= A-law bytes) per voice frame
+        var frameSamples: Int = 480
+
+        /// Tone frequency; 0 produces digital silence
+        var toneFrequency: Double = 440
+
+        /// Peak amplitude (0.0 - 1.0)
+        var amplitude: Double = 0.5
+
+        /// Number of silent frames sent before the tone starts
+        var leadingSilentFrames: Int = 0
+
+        /// Settings the emulated firmware accepts through audiostream.cgi
+        var supportedCodecs: [String] = ["g711a", "adpcm"]
+        var supportedSampleRates: [Int] = [8000, 16000]
+        var supportedFrameMs: [Int] = [10, 20, 30, 40, 60]
+    }
+
+    /// One voice frame as the SDK would hand it over
+    struct Frame {
+        let payload: [UInt8]
+        let frameNo: UInt32
+
+        /// Stream time in milliseconds (app_frame_header.timestamp)
+        let timestamp: UInt32
+
+        /// .g711a or .adpcm
+        let codec: AudioCodec
+
+        /// ADPCM predictor state at the start of the frame
+        /// (app_frame_header.sample / .index)
+        let adpcmState: ima_adpcm_state
+
+        /// Samples the frame decodes to
+        var samples: Int { codec == .adpcm ? payload.count * 2 : payload.count }
+    }
+
+    /// Bottleneck between camera and app, in virtual time (benchmarks):
+    /// frames queue behind each other at `bitsPerSecond` and are dropped
+    /// once the queue holds more than `maxQueueMs`
+    struct Link {
+        var bitsPerSecond: Int
+
+        /// Per-frame packet headers (IP/UDP/P2P framing)
+        var overheadBytes = 48
+
+        /// Propagation delay
+        var baseDelayMs = 20.0
+
+        var maxQueueMs = 200.0
+
+        private var busyUntilMs = 0.0
+
+        init(bitsPerSecond: Int) {
+            self.bitsPerSecond = bitsPerSecond
+        }
+
+        /// Send `bytes` of payload at `sentMs`
+        /// - Returns: Arrival time in ms, nil if the frame was dropped
+        mutating func send(bytes: Int, at sentMs: Double) -> Double? {
+            let start = max(busyUntilMs, sentMs)
+            guard start - sentMs <= maxQueueMs else { return nil }
+            busyUntilMs = start + Double((bytes + overheadBytes) * 8) * 1000 / Double(max(bitsPerSecond, 1))
+            return busyUntilMs + baseDelayMs
+        }
+    }
+
+    // MARK: - Properties
+
+    /// Sample rate and frame size change through audiostream.cgi
+    private(set) var configuration: Configuration
+
+    /// Receives every generated frame (on the emulator's queue)
+    var onFrame: ((Frame) -> Void)?
+
+    private let queue = DispatchQueue(label: "com.veepatest.camera-emulator", qos: .userInteractive)
+    private var timer: DispatchSourceTimer?
+    private var nextFrameNo: UInt32 = 1
+    private var samplesGenerated: Int = 0
+    private var phase: Double = 0
+
+    /// Codec set over CGI ("g711a" and "adpcm" frames are generated; other
+    /// codecs are reported but sent as A-law)
+    private var codec: String
+
+    /// ADPCM encoder state carried from frame to frame
+    private var adpcmState = ima_adpcm_state()
+
+    /// Duration of one frame in seconds
+    var frameDuration: TimeInterval {
+        Double(configuration.frameSamples) / Double(configuration.sampleRate)
+    }
+
+    private var frameInterval: DispatchTimeInterval {
+        .nanoseconds(Int(frameDuration * 1_000_000_000))
+    }
+
+    private(set) var isRunning = false
+
+    // MARK: - Initialization
+
+    init(configuration: Configuration = Configuration()) {
+        self.configuration = configuration
+        self.codec = configuration.supportedCodecs.first ?? "g711a"
+    }
+
+    // MARK: - Control
+
+    /// Start emitting frames at real-time cadence; the first frame is sent immediately
+    func start() {
+        guard timer == nil else { return }
+
+        let source = DispatchSource.makeTimerSource(queue: queue)
+        source.schedule(deadline: .now(), repeating: frameInterval, leeway: .milliseconds(1))
+        source.setEventHandler { [weak self] in
+            guard let self = self else { return }
+            let frame = self.nextFrame()
+            self.onFrame?(frame)
+        }
+        timer = source
+        isRunning = true
+        source.resume()
+
+        print("[CameraEmulator] ▶️ Emitting \(configuration.frameSamples)-sample frames at \(configuration.sampleRate) Hz")
+    }
+
+    /// Stop emitting frames
+    func stop() {
+        timer?.cancel()
+        timer = nil
+        isRunning = false
+    }
+
+    /// Route frames into AudioHookBridge's decode path
+    func feedHookBridge() {
+        onFrame = { frame in
+            frame.payload.withUnsafeBufferPointer { bytes in
+                guard let base = bytes.baseAddress else { return }
+                if frame.codec == .adpcm {
+                    AudioHookBridge.shared.injectAdpcmFrame(base, length: bytes.count, state: frame.adpcmState,
+                                                            frameNo: frame.frameNo, timestamp: frame.timestamp)
+                } else {
+                    AudioHookBridge.shared.injectAlawFrame(base, length: bytes.count, frameNo: frame.frameNo, timestamp: frame.timestamp)
+                }
+            }
+        }
+    }
+
+    // MARK: - Frame Generation
+
+    /// Generate the next frame synchronously (also usable without `start()`)
+    func nextFrame() -> Frame {
+        let frameNo = nextFrameNo
+        let timestamp = UInt32(samplesGenerated * 1000 / configuration.sampleRate)
+
+        var samples = [Int16](repeating: 0, count: configuration.frameSamples)
+        let silent = Int(frameNo) <= configuration.leadingSilentFrames || configuration.toneFrequency == 0
+        let step = 2.0 * Double.pi * configuration.toneFrequency / Double(configuration.sampleRate)
+
+        if !silent {
+            for i in 0..<samples.count {
+                samples[i] = Int16(sin(phase) * configuration.amplitude * Double(Int16.max))
+                phase += step
+                if phase > 2.0 * Double.pi { phase -= 2.0 * Double.pi }
+            }
+        }
+
+        // The ADPCM encoder runs on every frame so its predictor follows the
+        // signal and a switch to ADPCM starts without a ramp from zero
+        let frameCodec: AudioCodec = codec == AudioCodec.adpcm.rawValue ? .adpcm : .g711a
+        let startState = adpcmState
+        var adpcm = [UInt8](repeating: 0, count: (samples.count + 1) / 2)
+        _ = ima_adpcm_encode(samples, samples.count, &adpcmState, &adpcm)
+        let payload = frameCodec == .adpcm ? adpcm : samples.map(g711_alaw_encode_sample)
+
+        nextFrameNo &+= 1
+        samplesGenerated += configuration.frameSamples
+
+        return Frame(payload: payload, frameNo: frameNo, timestamp: timestamp,
+                     codec: frameCodec, adpcmState: startState)
+    }
+
+    // MARK: - CGI
+
+    /// Answer a CGI command the way the camera firmware would
+    ///
+    /// get_params.cgi reports the audio settings and the lists the emulated
+    /// firmware accepts; audiostream.cgi changes them from the next frame
+    /// (result -1 for a value outside the lists). Other commands get -1.
+    func handleCgi(_ command: String) -> String {
+        typealias Keys = AudioParameterNegotiator.Keys
+        let path = command.split(separator: "?", maxSplits: 1).first.map(String.init) ?? command
+
+        switch path {
+        case "get_params.cgi":
+            return queue.sync {
+                let lines = [
+                    (Keys.codec, codec),
+                    (Keys.sampleRate, String(configuration.sampleRate)),
+                    (Keys.frameMs, String(configuration.frameSamples * 1000 / configuration.sampleRate)),
+                    (Keys.codecList, configuration.supportedCodecs.joined(separator: ",")),
+                    (Keys.sampleRateList, configuration.supportedSampleRates.map(String.init).joined(separator: ",")),
+                    (Keys.frameMsList, configuration.supportedFrameMs.map(String.init).joined(separator: ","))
+                ]
+                return lines.map { "var \($0.0)=\"\($0.1)\";\r\n" }.joined()
+            }
+
+        case "audiostream.cgi":
+            let values = AudioParameterNegotiator.queryParameters(command)
+            return queue.sync {
+                let codec = values[Keys.codec] ?? self.codec
+                let sampleRate = values[Keys.sampleRate].flatMap { Int($0) } ?? configuration.sampleRate
+                let frameMs = values[Keys.frameMs].flatMap { Int($0) }
+                    ?? configuration.frameSamples * 1000 / configuration.sampleRate
+                guard configuration.supportedCodecs.contains(codec),
+                      configuration.supportedSampleRates.contains(sampleRate),
+                      configuration.supportedFrameMs.contains(frameMs) else {
+                    return "var \(Keys.result)=-1;\r\n"
+                }
+
+                // Keep the stream clock continuous across a rate change
+                samplesGenerated = samplesGenerated * sampleRate / configuration.sampleRate
+                self.codec = codec
+                configuration.sampleRate = sampleRate
+                configuration.frameSamples = sampleRate * frameMs / 1000
+                timer?.schedule(deadline: .now() + frameInterval, repeating: frameInterval, leeway: .milliseconds(1))
+                print("[CameraEmulator] 🎚️ audiostream.cgi: \(codec), \(sampleRate) Hz, \(frameMs) ms frames")
+                return "var \(Keys.result)=0;\r\n"
+            }
+
+        default:
+            return "var \(Keys.result)=-1;\r\n"
+        }
+    }
+}
+
+extension CameraEmulator: CameraCgiTransport {
+    func sendCgi(_ command: String) async throws -> String {
+        handleCgi(command)
+    }
+}
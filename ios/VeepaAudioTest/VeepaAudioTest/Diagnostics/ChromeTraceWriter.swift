@@ -0,0 +1,134 @@
+//
+//  ChromeTraceWriter.swift
+//  VeepaAudioTest
+//
+//  Created for time-to-first-audio work
+//  Purpose: Write Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+//
+//  Format reference: "Trace Event Format" (Chromium) - only the subset we
+//  need: complete spans ("X"), instants ("i"), counters ("C") and thread
+//  name metadata ("M"). Timestamps are in microseconds.
+//
+
+import Foundation
+
+/// Trace events shared by the Chrome JSON and Perfetto protobuf writers, so
+/// one exporter can produce either file
+protocol TraceEventWriter {
+    mutating func addSpan(_ name: String, category: String, startNanoseconds: UInt64,
+                          durationNanoseconds: UInt64, threadID: Int, args: [String: Any])
+    mutating func addInstant(_ name: String, category: String, atNanoseconds: UInt64,
+                             threadID: Int, args: [String: Any])
+    mutating func addCounter(_ name: String, category: String, atNanoseconds: UInt64, values: [String: Double])
+    mutating func nameThread(_ threadID: Int, _ name: String)
+
+    /// Serialized trace document
+    func data() throws -> Data
+}
+
+extension TraceEventWriter {
+    /// Write the trace document to a file
+    func write(to url: URL) throws {
+        try FileManager.default.createDirectory(
+            at: url.deletingLastPathComponent(),
+            withIntermediateDirectories: true
+        )
+        try data().write(to: url, options: .atomic)
+    }
+}
+
+/// Builds a Chrome trace event JSON document
+struct ChromeTraceWriter: TraceEventWriter {
+
+    /// Process ID written into every event (one process per trace)
+    var processID: Int = 1
+
+    /// Uptime (ns) that maps to ts = 0 in the trace
+    let originNanoseconds: UInt64
+
+    private(set) var events: [[String: Any]] = []
+
+    init(originNanoseconds: UInt64) {
+        self.originNanoseconds = originNanoseconds
+    }
+
+    // MARK: - Events
+
+    /// Add a span with a known start and duration
+    mutating func addSpan(
+        _ name: String,
+        category: String,
+        startNanoseconds: UInt64,
+        durationNanoseconds: UInt64,
+        threadID: Int = 1,
+        args: [String: Any] = [:]
+    ) {
+        var event = baseEvent(name, category: category, phase: "X", at: startNanoseconds, threadID: threadID)
+        event["dur"] = Double(durationNanoseconds) / 1000
+        if !args.isEmpty { event["args"] = args }
+        events.append(event)
+    }
+
+    /// Add a zero-duration marker
+    mutating func addInstant(
+        _ name: String,
+        category: String,
+        atNanoseconds: UInt64,
+        threadID: Int = 1,
+        args: [String: Any] = [:]
+    ) {
+        var event = baseEvent(name, category: category, phase: "i", at: atNanoseconds, threadID: threadID)
+        event["s"] = "t"  // Thread-scoped instant
+        if !args.isEmpty { event["args"] = args }
+        events.append(event)
+    }
+
+    /// Add a counter sample; each key becomes one series of the counter track
+    mutating func addCounter(
+        _ name: String,
+        category: String,
+        atNanoseconds: UInt64,
+        values: [String: Double]
+    ) {
+        var event = baseEvent(name, category: category, phase: "C", at: atNanoseconds, threadID: 0)
+        event["args"] = values
+        events.append(event)
+    }
+
+    /// Give a thread track a readable name
+    mutating func nameThread(_ threadID: Int, _ name: String) {
+        events.append([
+            "name": "thread_name",
+            "ph": "M",
+            "pid": processID,
+            "tid": threadID,
+            "args": ["name": name]
+        ])
+    }
+
+    // MARK: - Output
+
+    /// Serialized trace document
+    func data() throws -> Data {
+        let document: [String: Any] = [
+            "traceEvents": events,
+            "displayTimeUnit": "ms"
+        ]
+        return try JSONSerialization.data(withJSONObject: document, options: [.sortedKeys])
+    }
+
+    // MARK: - Helpers
+
+    private func baseEvent(_ name: String, category: String, phase: String, at nanoseconds: UInt64, threadID: Int) -> [String: Any] {
+        // Events recorded before the origin are clamped to 0
+        let relative = nanoseconds > originNanoseconds ? nanoseconds - originNanoseconds : 0
+        return [
+            "name": name,
+            "cat": category,
+            "ph": phase,
+            "ts": Double(relative) / 1000,
+            "pid": processID,
+            "tid": threadID
+        ]
+    }
+}
@@ -0,0 +1,296 @@
+//
+//  FlightRecorder.c
+//  VeepaAudioTest
+//
+//  Created for glitch forensics
+//  Purpose: Fixed-memory rings of recent frames and decoded audio
+//
+
+#include "FlightRecorder.h"
+#include "PipelineTrace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_ALIGN 64
+
+/// A frame in the index ring; `position` is the payload stream offset
+typedef struct {
+    uint64_t position;
+    uint64_t arrival_ns;
+    uint32_t frame_no;
+    uint32_t timestamp_ms;
+    uint32_t length;
+    uint32_t reserved;
+} frame_slot;
+
+/// Published/claimed pair for one ring; each gets its own cache line so the
+/// reader polling one never bounces the writer's other counters
+typedef struct {
+    uint64_t written;        ///< (atomic) Units published
+    uint64_t claimed;        ///< (atomic) Units the writer may be overwriting up to
+} __attribute__((aligned(RING_ALIGN))) ring_position;
+
+struct flight_recorder {
+    ring_position frames;
+    ring_position payload;
+    ring_position pcm;
+    uint64_t pcm_end_ns;     ///< (atomic) When the last PCM block was recorded
+
+    frame_slot *slots;
+    uint8_t *bytes;
+    int16_t *samples;
+    uint32_t frame_mask;
+    uint32_t payload_mask;
+    uint32_t pcm_mask;
+};
+
+static uint32_t next_power_of_two(uint32_t value) {
+    uint32_t power = 2;
+    while (power < value && power < (1u << 30)) power <<= 1;
+    return power;
+}
+
+/// Copy `length` units in or out of a power-of-two ring starting at `position`
+static void ring_copy_in(void *ring, uint32_t mask, size_t unit, uint64_t position, const void *source, uint32_t length) {
+    uint32_t start = (uint32_t)(position & mask);
+    uint32_t first = mask + 1 - start;
+    if (first > length) first = length;
+    memcpy((uint8_t *)ring + (size_t)start * unit, source, (size_t)first * unit);
+    memcpy(ring, (const uint8_t *)source + (size_t)first * unit, (size_t)(length - first) * unit);
+}
+
+static void ring_copy_out(const void *ring, uint32_t mask, size_t unit, uint64_t position, void *target, uint32_t length) {
+    uint32_t start = (uint32_t)(position & mask);
+    uint32_t first = mask + 1 - start;
+    if (first > length) first = length;
+    memcpy(target, (const uint8_t *)ring + (size_t)start * unit, (size_t)first * unit);
+    memcpy((uint8_t *)target + (size_t)first * unit, ring, (size_t)(length - first) * unit);
+}
+
+/// Announce that [written, end) is about to be overwritten
+static void ring_claim(ring_position *ring, uint64_t end) {
+    __atomic_store_n(&ring->claimed, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/// Oldest unit a copy taken before now can still trust
+static uint64_t ring_oldest_intact(const ring_position *ring, uint32_t mask) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t claimed = __atomic_load_n(&ring->claimed, __ATOMIC_RELAXED);
+    uint64_t size = (uint64_t)mask + 1;
+    return claimed > size ? claimed - size : 0;
+}
+
+#pragma mark - Lifecycle
+
+void flight_recorder_config_init(flight_recorder_config *config) {
+    config->seconds = 30;
+    config->sample_rate = 16000;
+    config->frames_per_second = 100;
+}
+
+flight_recorder *flight_recorder_create(const flight_recorder_config *config) {
+    if (config == NULL || config->seconds == 0 || config->sample_rate == 0 || config->frames_per_second == 0) {
+        return NULL;
+    }
+    // One A-law byte per sample, so the payload and PCM rings hold the same span
+    uint64_t samples = (uint64_t)config->seconds * config->sample_rate;
+    uint64_t frames = (uint64_t)config->seconds * config->frames_per_second;
+    if (samples > (1u << 30) || frames > (1u << 30)) return NULL;
+
+    flight_recorder *recorder = (flight_recorder *)aligned_alloc(RING_ALIGN, sizeof(flight_recorder));
+    if (recorder == NULL) return NULL;
+    memset(recorder, 0, sizeof(*recorder));
+
+    uint32_t frame_count = next_power_of_two((uint32_t)frames);
+    uint32_t sample_count = next_power_of_two((uint32_t)samples);
+    recorder->slots = (frame_slot *)calloc(frame_count, sizeof(frame_slot));
+    recorder->bytes = (uint8_t *)calloc(sample_count, 1);
+    recorder->samples = (int16_t *)calloc(config->frames_only ? 2 : sample_count, sizeof(int16_t));
+    if (recorder->slots == NULL || recorder->bytes == NULL || recorder->samples == NULL) {
+        flight_recorder_destroy(recorder);
+        return NULL;
+    }
+    recorder->frame_mask = frame_count - 1;
+    recorder->payload_mask = sample_count - 1;
+    recorder->pcm_mask = config->frames_only ? 0 : sample_count - 1;
+    return recorder;
+}
+
+void flight_recorder_destroy(flight_recorder *recorder) {
+    if (recorder == NULL) return;
+    free(recorder->slots);
+    free(recorder->bytes);
+    free(recorder->samples);
+    free(recorder);
+}
+
+flight_recorder_capacity flight_recorder_get_capacity(const flight_recorder *recorder) {
+    flight_recorder_capacity capacity = {
+        .frames = recorder->frame_mask + 1,
+        .payload_bytes = recorder->payload_mask + 1,
+        .pcm_samples = recorder->pcm_mask ? recorder->pcm_mask + 1 : 0,
+    };
+    return capacity;
+}
+
+#pragma mark - Recording
+
+void flight_recorder_record_frame(flight_recorder *recorder, const uint8_t *payload, uint32_t length,
+                                  uint32_t frame_no, uint32_t timestamp_ms) {
+    if (recorder == NULL || payload == NULL || length > recorder->payload_mask + 1) return;
+
+    // Payload first, so a published index entry never points at bytes still in flight
+    uint64_t position = __atomic_load_n(&recorder->payload.written, __ATOMIC_RELAXED);
+    ring_claim(&recorder->payload, position + length);
+    ring_copy_in(recorder->bytes, recorder->payload_mask, 1, position, payload, length);
+    __atomic_store_n(&recorder->payload.written, position + length, __ATOMIC_RELEASE);
+
+    frame_slot slot = {
+        .position = position,
+        .arrival_ns = pipeline_trace_now(),
+        .frame_no = frame_no,
+        .timestamp_ms = timestamp_ms,
+        .length = length,
+    };
+    uint64_t index = __atomic_load_n(&recorder->frames.written, __ATOMIC_RELAXED);
+    ring_claim(&recorder->frames, index + 1);
+    memcpy(&recorder->slots[index & recorder->frame_mask], &slot, sizeof(slot));
+    __atomic_store_n(&recorder->frames.written, index + 1, __ATOMIC_RELEASE);
+}
+
+void flight_recorder_record_pcm(flight_recorder *recorder, const int16_t *samples, uint32_t count) {
+    if (recorder == NULL || samples == NULL || count == 0 || recorder->pcm_mask == 0) return;
+
+    // Only the newest ring-full of an oversized block can survive anyway
+    uint32_t size = recorder->pcm_mask + 1;
+    uint64_t position = __atomic_load_n(&recorder->pcm.written, __ATOMIC_RELAXED);
+    if (count > size) {
+        position += count - size;
+        samples += count - size;
+        count = size;
+    }
+    ring_claim(&recorder->pcm, position + count);
+    ring_copy_in(recorder->samples, recorder->pcm_mask, sizeof(int16_t), position, samples, count);
+    __atomic_store_n(&recorder->pcm_end_ns, pipeline_trace_now(), __ATOMIC_RELAXED);
+    __atomic_store_n(&recorder->pcm.written, position + count, __ATOMIC_RELEASE);
+}
+
+#pragma mark - Copying
+
+/// First index in [first, end) whose frame arrived at or after `since_ns`
+/// with its payload still held. Arrival times and positions both grow with
+/// the index, so one binary search covers both; a slot torn by the writer
+/// can only misplace the start, which the copy then validates.
+static uint64_t find_first_frame(const flight_recorder *recorder, uint64_t first, uint64_t end, uint64_t since_ns) {
+    uint64_t payload_intact = ring_oldest_intact(&recorder->payload, recorder->payload_mask);
+    while (first < end) {
+        uint64_t middle = first + (end - first) / 2;
+        frame_slot slot;
+        memcpy(&slot, &recorder->slots[middle & recorder->frame_mask], sizeof(slot));
+        if (slot.arrival_ns < since_ns || slot.position < payload_intact) {
+            first = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return first;
+}
+
+uint32_t flight_recorder_copy_frames(const flight_recorder *recorder, uint64_t since_ns,
+                                     flight_recorder_frame *frames, uint32_t capacity,
+                                     uint8_t *payload, uint32_t payload_capacity, uint32_t *payload_used) {
+    return flight_recorder_copy_range(recorder, since_ns, UINT64_MAX, frames, capacity,
+                                      payload, payload_capacity, payload_used);
+}
+
+uint32_t flight_recorder_copy_range(const flight_recorder *recorder, uint64_t since_ns, uint64_t until_ns,
+                                    flight_recorder_frame *frames, uint32_t capacity,
+                                    uint8_t *payload, uint32_t payload_capacity, uint32_t *payload_used) {
+    if (payload_used != NULL) *payload_used = 0;
+    if (recorder == NULL || frames == NULL || payload == NULL || capacity == 0) return 0;
+
+    uint64_t end = __atomic_load_n(&recorder->frames.written, __ATOMIC_ACQUIRE);
+    uint64_t size = (uint64_t)recorder->frame_mask + 1;
+    uint64_t first = end > size ? end - size : 0;
+    first = find_first_frame(recorder, first, end, since_ns);
+
+    uint32_t count = 0;
+    uint32_t used = 0;
+    for (uint64_t index = first; index < end && count < capacity; index++) {
+        frame_slot slot;
+        memcpy(&slot, &recorder->slots[index & recorder->frame_mask], sizeof(slot));
+        // The writer lapped us: what was copied so far is older still, so
+        // restart from here rather than leave a hole in the sequence
+        if (index < ring_oldest_intact(&recorder->frames, recorder->frame_mask)) {
+            count = used = 0;
+            continue;
+        }
+        if (slot.arrival_ns < since_ns) continue;
+        if (slot.arrival_ns >= until_ns) break;
+        if (slot.length > payload_capacity - used) break;
+
+        ring_copy_out(recorder->bytes, recorder->payload_mask, 1, slot.position, payload + used, slot.length);
+        if (slot.position < ring_oldest_intact(&recorder->payload, recorder->payload_mask)) {
+            count = used = 0;
+            continue;
+        }
+
+        frames[count].arrival_ns = slot.arrival_ns;
+        frames[count].frame_no = slot.frame_no;
+        frames[count].timestamp_ms = slot.timestamp_ms;
+        frames[count].offset = used;
+        frames[count].length = slot.length;
+        used += slot.length;
+        count++;
+    }
+    if (payload_used != NULL) *payload_used = used;
+    return count;
+}
+
+uint64_t flight_recorder_oldest_ns(const flight_recorder *recorder) {
+    if (recorder == NULL) return 0;
+
+    uint64_t end = __atomic_load_n(&recorder->frames.written, __ATOMIC_ACQUIRE);
+    uint64_t size = (uint64_t)recorder->frame_mask + 1;
+    uint64_t first = find_first_frame(recorder, end > size ? end - size : 0, end, 0);
+    for (; first < end; first++) {
+        frame_slot slot;
+        memcpy(&slot, &recorder->slots[first & recorder->frame_mask], sizeof(slot));
+        if (first >= ring_oldest_intact(&recorder->frames, recorder->frame_mask)) return slot.arrival_ns;
+    }
+    return 0;
+}
+
+uint32_t flight_recorder_copy_pcm(const flight_recorder *recorder, int16_t *samples, uint32_t capacity,
+                                  uint64_t *end_ns) {
+    if (end_ns != NULL) *end_ns = 0;
+    if (recorder == NULL || samples == NULL || capacity == 0 || recorder->pcm_mask == 0) return 0;
+
+    uint64_t end = __atomic_load_n(&recorder->pcm.written, __ATOMIC_ACQUIRE);
+    uint64_t recorded_ns = __atomic_load_n(&recorder->pcm_end_ns, __ATOMIC_RELAXED);
+    uint64_t size = (uint64_t)recorder->pcm_mask + 1;
+    uint64_t first = end > size ? end - size : 0;
+    if (end - first > capacity) first = end - capacity;
+    uint32_t count = (uint32_t)(end - first);
+    ring_copy_out(recorder->samples, recorder->pcm_mask, sizeof(int16_t), first, samples, count);
+
+    // Slide out the oldest samples if the writer reached them during the copy
+    uint64_t intact = ring_oldest_intact(&recorder->pcm, recorder->pcm_mask);
+    if (intact > first) {
+        uint32_t lost = intact - first >= count ? count : (uint32_t)(intact - first);
+        memmove(samples, samples + lost, (size_t)(count - lost) * sizeof(int16_t));
+        count -= lost;
+    }
+    if (end_ns != NULL && count > 0) *end_ns = recorded_ns;
+    return count;
+}
+
+uint64_t flight_recorder_frames_recorded(const flight_recorder *recorder) {
+    return __atomic_load_n(&recorder->frames.written, __ATOMIC_ACQUIRE);
+}
+
+uint64_t flight_recorder_samples_recorded(const flight_recorder *recorder) {
+    return __atomic_load_n(&recorder->pcm.written, __ATOMIC_ACQUIRE);
+}
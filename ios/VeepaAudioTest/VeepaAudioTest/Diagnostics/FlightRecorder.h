@@ -0,0 +1,117 @@
+//
+//  FlightRecorder.h
+//  VeepaAudioTest
+//
+//  Created for glitch forensics
+//  Purpose: Always-on, fixed-memory history of one stream's last seconds -
+//           raw A-law frames and decoded PCM - that can be copied out
+//           while recording continues
+//
+//  Three rings sized once at creation:
+//    - frame index: frame_no, timestamp, arrival time, position and length
+//    - payload bytes: the A-law payloads back to back (wrapping)
+//    - PCM samples: decoded audio as pushed to playout (optional - the
+//      live-rewind history keeps frames only, at half the memory)
+//  Recording a frame or a block of samples is a memcpy into the ring and a
+//  release store of the position; nothing allocates or locks, so it can run
+//  on the capture thread for every frame.
+//
+//  Copies run concurrently with the writer, seqlock style (as SharedAudioRing):
+//  the writer announces how far it is about to write before copying, the
+//  reader copies and then drops whatever that announcement says may have
+//  been overwritten meanwhile. One writer per recorder; any number of readers.
+//
+//  Pipeline events for the same window come from PipelineTrace;
+//  FlightRecorder.swift bundles all three into a dump.
+//
+
+#ifndef FlightRecorder_h
+#define FlightRecorder_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t seconds;            ///< History to keep
+    uint32_t sample_rate;        ///< Highest stream rate (sizes the payload and PCM rings)
+    uint32_t frames_per_second;  ///< Highest frame rate (sizes the index)
+    uint32_t frames_only;        ///< Non-zero: no PCM ring (frame history only)
+} flight_recorder_config;
+
+/// One frame as copied out; `offset` indexes the caller's payload buffer
+typedef struct {
+    uint64_t arrival_ns;         ///< pipeline_trace_now() when recorded
+    uint32_t frame_no;
+    uint32_t timestamp_ms;
+    uint32_t offset;
+    uint32_t length;
+} flight_recorder_frame;
+
+/// Ring sizes, for sizing copy buffers
+typedef struct {
+    uint32_t frames;
+    uint32_t payload_bytes;
+    uint32_t pcm_samples;
+} flight_recorder_capacity;
+
+typedef struct flight_recorder flight_recorder;
+
+/// Fill in defaults: 30 s at up to 16 kHz, up to 100 frames/s, with PCM
+void flight_recorder_config_init(flight_recorder_config *config);
+
+/// Sizes are rounded up to powers of two
+/// @return NULL if allocation fails or the config is empty
+flight_recorder *flight_recorder_create(const flight_recorder_config *config);
+
+void flight_recorder_destroy(flight_recorder *recorder);
+
+flight_recorder_capacity flight_recorder_get_capacity(const flight_recorder *recorder);
+
+#pragma mark - Recording (single writer)
+
+/// Keep one received frame (frames larger than the payload ring are skipped)
+void flight_recorder_record_frame(flight_recorder *recorder, const uint8_t *payload, uint32_t length,
+                                  uint32_t frame_no, uint32_t timestamp_ms);
+
+/// Keep decoded samples
+void flight_recorder_record_pcm(flight_recorder *recorder, const int16_t *samples, uint32_t count);
+
+#pragma mark - Copying (any thread)
+
+/// Copy the frames that arrived at or after `since_ns`, oldest first, with
+/// their payloads packed into `payload`
+/// @param payload_used Receives the payload bytes written
+/// @return Frames copied
+uint32_t flight_recorder_copy_frames(const flight_recorder *recorder, uint64_t since_ns,
+                                     flight_recorder_frame *frames, uint32_t capacity,
+                                     uint8_t *payload, uint32_t payload_capacity, uint32_t *payload_used);
+
+/// Same, limited to frames that arrived before `until_ns`. The start is found
+/// by binary search, so a short range out of a long history copies only
+/// that range.
+uint32_t flight_recorder_copy_range(const flight_recorder *recorder, uint64_t since_ns, uint64_t until_ns,
+                                    flight_recorder_frame *frames, uint32_t capacity,
+                                    uint8_t *payload, uint32_t payload_capacity, uint32_t *payload_used);
+
+/// Arrival time of the oldest frame whose payload is still held (0 if none)
+uint64_t flight_recorder_oldest_ns(const flight_recorder *recorder);
+
+/// Copy the most recent decoded samples, oldest first (none if frames_only)
+/// @param end_ns Receives the time the last sample was recorded (0 if none)
+/// @return Samples copied
+uint32_t flight_recorder_copy_pcm(const flight_recorder *recorder, int16_t *samples, uint32_t capacity,
+                                  uint64_t *end_ns);
+
+/// Frames and samples recorded since creation
+uint64_t flight_recorder_frames_recorded(const flight_recorder *recorder);
+uint64_t flight_recorder_samples_recorded(const flight_recorder *recorder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FlightRecorder_h */
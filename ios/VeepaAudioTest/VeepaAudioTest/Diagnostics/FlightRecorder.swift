@@ -0,0 +1,304 @@
+//
+//  FlightRecorder.swift
+//  VeepaAudioTest
+//
+//  Created for glitch forensics
+//  Purpose: Keep the last seconds of a stream and dump them when it glitches
+//
+//  Recording is always on and costs a memcpy per frame into rings allocated
+//  up front (FlightRecorder.c): raw A-law frames from the capture path and
+//  decoded PCM from the engine. Pipeline events come from PipelineTrace,
+//  which the recorder keeps running.
+//
+//  A trigger - an underflow burst, an engine restart or a manual request -
+//  copies the rings on a background queue and writes a self-contained
+//  bundle directory under Caches/FlightRecordings:
+//    frames.vaca      raw frames (capture archive segment, veepa-archive reads it)
+//    decoded.wav      decoded audio as pushed to playout
+//    events.json      pipeline events (Chrome JSON, opens in ui.perfetto.dev)
+//    manifest.json    trigger, stream format and how the files line up in time
+//  Triggers within `cooldown` of the last dump are ignored, so a glitch storm
+//  produces one bundle rather than dozens.
+//
+
+import Foundation
+
+final class FlightRecorder {
+
+    // MARK: - Types
+
+    enum Trigger {
+        /// `count` underflows within `window` seconds
+        case underflowBurst(count: Int, window: TimeInterval)
+        /// The health check rebuilt the engine
+        case engineRestart(attempt: Int)
+        case manual(reason: String)
+
+        var name: String {
+            switch self {
+            case .underflowBurst: return "underflowBurst"
+            case .engineRestart: return "engineRestart"
+            case .manual: return "manual"
+            }
+        }
+
+        var details: [String: Any] {
+            switch self {
+            case .underflowBurst(let count, let window):
+                return ["underflows": count, "windowSeconds": window]
+            case .engineRestart(let attempt):
+                return ["attempt": attempt]
+            case .manual(let reason):
+                return ["reason": reason]
+            }
+        }
+    }
+
+    struct Configuration {
+        /// History kept (and dumped)
+        var seconds = 30
+        /// Highest stream rate and frame rate the rings are sized for
+        var maxSampleRate = 16000
+        var maxFramesPerSecond = 100
+        /// Underflows within `burstWindow` that count as a burst
+        var burstUnderflows = 5
+        var burstWindow: TimeInterval = 5
+        /// Minimum time between dumps
+        var cooldown: TimeInterval = 30
+        var directory = FlightRecorder.defaultDirectory
+    }
+
+    /// A written dump
+    struct Bundle {
+        let url: URL
+        let trigger: Trigger
+        let frames: Int
+        let samples: Int
+        let events: Int
+    }
+
+    enum RecorderError: Error, LocalizedError {
+        case allocationFailed(seconds: Int)
+        case cannotWrite(URL)
+
+        var errorDescription: String? {
+            switch self {
+            case .allocationFailed(let seconds):
+                return "Cannot allocate a \(seconds) s flight recorder"
+            case .cannotWrite(let url):
+                return "Cannot write flight recording file \(url.path)"
+            }
+        }
+    }
+
+    static let defaultDirectory: URL = FileManager.default
+        .urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        .appendingPathComponent("FlightRecordings", isDirectory: true)
+
+    // MARK: - Properties
+
+    /// Stream name, used in bundle names
+    let name: String
+    let configuration: Configuration
+
+    /// The C recorder, for writers that record directly (AudioHookBridge)
+    let recorder: OpaquePointer
+
+    /// Stream rate of the recorded audio (set on format changes)
+    var sampleRate: Int
+
+    /// Called on the dump queue when a bundle is written or fails
+    var onDump: ((Result<Bundle, Error>) -> Void)?
+
+    private let dumpQueue = DispatchQueue(label: "com.veepa.flightrecorder", qos: .utility)
+    private let stateLock = NSLock()
+    private var lastTrigger: Date?
+    private var underflowHistory: [(time: Date, total: UInt64)] = []
+
+    // MARK: - Initialization
+
+    init(name: String, sampleRate: Int, configuration: Configuration = Configuration()) throws {
+        var config = flight_recorder_config()
+        config.seconds = UInt32(configuration.seconds)
+        config.sample_rate = UInt32(configuration.maxSampleRate)
+        config.frames_per_second = UInt32(configuration.maxFramesPerSecond)
+        guard let recorder = flight_recorder_create(&config) else {
+            throw RecorderError.allocationFailed(seconds: configuration.seconds)
+        }
+        self.name = name
+        self.sampleRate = sampleRate
+        self.configuration = configuration
+        self.recorder = recorder
+
+        // Events for the dump; sized once, pages are only touched by threads that record
+        if !PipelineTrace.isRecording {
+            try PipelineTrace.start()
+        }
+        let capacity = flight_recorder_get_capacity(recorder)
+        print("[FlightRecorder] ✈️ \(name): \(configuration.seconds) s, "
+              + "\((capacity.payload_bytes + capacity.pcm_samples * 2 + capacity.frames * 32) / 1024) KB")
+    }
+
+    deinit {
+        flight_recorder_destroy(recorder)
+    }
+
+    // MARK: - Recording (capture thread)
+
+    func recordFrame(_ payload: UnsafePointer<UInt8>, length: Int, frameNo: UInt32, timestamp: UInt32) {
+        flight_recorder_record_frame(recorder, payload, UInt32(length), frameNo, timestamp)
+    }
+
+    func recordSamples(_ samples: UnsafePointer<Int16>, count: Int) {
+        flight_recorder_record_pcm(recorder, samples, UInt32(count))
+    }
+
+    // MARK: - Triggers
+
+    /// Feed the running underflow total (once a second is plenty); fires a
+    /// dump when `burstUnderflows` accumulate within `burstWindow`
+    /// - Returns: Whether a dump was triggered
+    @discardableResult
+    func noteUnderflows(total: UInt64, at now: Date = Date()) -> Bool {
+        stateLock.lock()
+        underflowHistory.append((now, total))
+        underflowHistory.removeAll { now.timeIntervalSince($0.time) > configuration.burstWindow }
+        let oldest = underflowHistory.first?.total ?? total
+        let burst = total >= oldest ? Int(total - oldest) : 0
+        if burst >= configuration.burstUnderflows {
+            underflowHistory = [(now, total)]
+        }
+        stateLock.unlock()
+
+        guard burst >= configuration.burstUnderflows else { return false }
+        return trigger(.underflowBurst(count: burst, window: configuration.burstWindow), at: now)
+    }
+
+    /// Dump the recent history in the background (ignored during the cooldown)
+    /// - Returns: Whether a dump was started
+    @discardableResult
+    func trigger(_ trigger: Trigger, at now: Date = Date()) -> Bool {
+        stateLock.lock()
+        if let last = lastTrigger, now.timeIntervalSince(last) < configuration.cooldown {
+            stateLock.unlock()
+            print("[FlightRecorder] ⏳ \(trigger.name) ignored (cooldown)")
+            return false
+        }
+        lastTrigger = now
+        stateLock.unlock()
+
+        print("[FlightRecorder] 🚨 \(trigger.name) - dumping last \(configuration.seconds) s of \(name)")
+        let until = pipeline_trace_now()
+        dumpQueue.async { [self] in
+            let result = Result { try dump(trigger, until: until) }
+            if case .failure(let error) = result {
+                print("[FlightRecorder] ❌ Dump failed: \(error.localizedDescription)")
+            }
+            onDump?(result)
+        }
+        return true
+    }
+
+    // MARK: - Dump
+
+    /// Copy the rings and write a bundle (synchronous; `trigger` calls this
+    /// on the dump queue)
+    /// - Parameter until: End of the window, pipeline_trace_now() time base
+    func dump(_ trigger: Trigger, until: UInt64 = pipeline_trace_now()) throws -> Bundle {
+        let windowNs = UInt64(configuration.seconds) * 1_000_000_000
+        let since = until > windowNs ? until - windowNs : 0
+        let capacity = flight_recorder_get_capacity(recorder)
+
+        // Copy first: the writers keep going and the rings keep wrapping
+        var frames = [flight_recorder_frame](repeating: flight_recorder_frame(), count: Int(capacity.frames))
+        var payload = [UInt8](repeating: 0, count: Int(capacity.payload_bytes))
+        var payloadUsed: UInt32 = 0
+        let frameCount = Int(flight_recorder_copy_frames(recorder, since, &frames, capacity.frames,
+                                                         &payload, capacity.payload_bytes, &payloadUsed))
+        var samples = [Int16](repeating: 0, count: Int(capacity.pcm_samples))
+        var samplesEndNs: UInt64 = 0
+        let sampleRate = max(self.sampleRate, 1)
+        let maxSamples = min(Int(capacity.pcm_samples), configuration.seconds * sampleRate)
+        let sampleCount = Int(flight_recorder_copy_pcm(recorder, &samples, UInt32(maxSamples), &samplesEndNs))
+        let tracks = PipelineTrace.collect().map { track in
+            PipelineTrace.ThreadTrack(threadID: track.threadID, name: track.name,
+                                      events: track.events.filter { $0.time_ns + UInt64($0.duration_ns) >= since },
+                                      overwritten: track.overwritten)
+        }.filter { !$0.events.isEmpty }
+        PipelineTrace.releaseExitedThreads()
+
+        let created = Date()
+        let bundleURL = configuration.directory
+            .appendingPathComponent("\(name)-\(trigger.name)-\(Int(created.timeIntervalSince1970))", isDirectory: true)
+        try FileManager.default.createDirectory(at: bundleURL, withIntermediateDirectories: true)
+
+        // Raw frames: wall-clock start estimated from the oldest arrival
+        let startMs = Int64(created.timeIntervalSince1970 * 1000)
+            - Int64((until - (frameCount > 0 ? min(frames[0].arrival_ns, until) : until)) / 1_000_000)
+        let framesURL = bundleURL.appendingPathComponent("frames").appendingPathExtension(CAPTURE_ARCHIVE_EXTENSION)
+        try writeArchive(to: framesURL, frames: frames.prefix(frameCount), payload: payload, startMs: startMs)
+
+        var wav = Data(count: Int(WAV_HEADER_SIZE))
+        wav.withUnsafeMutableBytes { bytes in
+            wav_write_header(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                             UInt32(sampleRate), 1, 16, UInt32(sampleCount * 2))
+        }
+        samples.withUnsafeBytes { wav.append(contentsOf: $0.prefix(sampleCount * 2)) }
+        try wav.write(to: bundleURL.appendingPathComponent("decoded.wav"))
+
+        var chrome = ChromeTraceWriter(originNanoseconds: since)
+        PipelineTrace.render(tracks, into: &chrome)
+        try chrome.write(to: bundleURL.appendingPathComponent("events.json"))
+
+        // Offsets are seconds from the window start (time 0 in events.json)
+        let samplesStartNs = samplesEndNs.subtractingReportingOverflow(
+            UInt64(sampleCount) * 1_000_000_000 / UInt64(sampleRate)).partialValue
+        func offset(_ ns: UInt64) -> Double { ns >= since ? Double(ns - since) / 1e9 : -Double(since - ns) / 1e9 }
+        let events = tracks.reduce(0) { $0 + $1.events.count }
+        var manifest: [String: Any] = [
+            "stream": name,
+            "trigger": trigger.name,
+            "triggerDetails": trigger.details,
+            "created": ISO8601DateFormatter().string(from: created),
+            "windowSeconds": configuration.seconds,
+            "sampleRate": sampleRate,
+            "frames": frameCount,
+            "payloadBytes": Int(payloadUsed),
+            "samples": sampleCount,
+            "events": events,
+            "eventsDropped": Int(PipelineTrace.droppedEvents),
+            "framesRecorded": Int(flight_recorder_frames_recorded(recorder)),
+        ]
+        if frameCount > 0 {
+            manifest["firstFrameNo"] = Int(frames[0].frame_no)
+            manifest["lastFrameNo"] = Int(frames[frameCount - 1].frame_no)
+            manifest["firstFrameOffsetSeconds"] = offset(frames[0].arrival_ns)
+        }
+        if sampleCount > 0 {
+            manifest["decodedStartOffsetSeconds"] = offset(samplesStartNs)
+        }
+        let json = try JSONSerialization.data(withJSONObject: manifest, options: [.prettyPrinted, .sortedKeys])
+        try json.write(to: bundleURL.appendingPathComponent("manifest.json"))
+
+        print("[FlightRecorder] 💾 \(bundleURL.lastPathComponent): \(frameCount) frames, "
+              + "\(sampleCount) samples, \(events) events")
+        return Bundle(url: bundleURL, trigger: trigger, frames: frameCount, samples: sampleCount, events: events)
+    }
+
+    private func writeArchive(to url: URL, frames: ArraySlice<flight_recorder_frame>, payload: [UInt8], startMs: Int64) throws {
+        let fd = open(url.path, O_WRONLY | O_CREAT | O_TRUNC, 0o644)
+        guard fd >= 0 else { throw RecorderError.cannotWrite(url) }
+        defer { close(fd) }
+
+        guard capture_archive_write_header(fd, UInt32(sampleRate), startMs) == Int32(CAPTURE_ARCHIVE_OK) else {
+            throw RecorderError.cannotWrite(url)
+        }
+        try payload.withUnsafeBufferPointer { bytes in
+            for frame in frames {
+                let result = capture_archive_append(fd, frame.frame_no, frame.timestamp_ms,
+                                                    bytes.baseAddress! + Int(frame.offset), UInt16(frame.length))
+                guard result == Int32(CAPTURE_ARCHIVE_OK) else { throw RecorderError.cannotWrite(url) }
+            }
+        }
+    }
+}
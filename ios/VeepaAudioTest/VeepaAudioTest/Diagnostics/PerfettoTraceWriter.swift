@@ -0,0 +1,294 @@
+//
+//  PerfettoTraceWriter.swift
+//  VeepaAudioTest
+//
+//  Created for pipeline timeline tracing
+//  Purpose: Write Perfetto protobuf traces (ui.perfetto.dev, trace_processor)
+//
+//  Format reference: perfetto/protos/perfetto/trace - only the subset we
+//  need, encoded by hand: a Trace of TracePackets carrying TrackDescriptors
+//  (process, thread and counter tracks) and TrackEvents (slice begin/end,
+//  instants, counters). Names are written inline rather than interned, so
+//  every packet stands alone. Timestamps are nanoseconds from the origin.
+//
+
+import Foundation
+
+/// Builds a Perfetto protobuf trace with the same events as ChromeTraceWriter
+struct PerfettoTraceWriter: TraceEventWriter {
+
+    /// Process ID of the single process track
+    var processID: Int = 1
+    var processName = "VeepaAudioTest"
+
+    /// Uptime (ns) that maps to timestamp 0 in the trace
+    let originNanoseconds: UInt64
+
+    private struct Event {
+        enum Kind { case begin, end, instant, counter(Double) }
+
+        let timestamp: UInt64
+        let kind: Kind
+        let track: UInt64
+        let name: String
+        let category: String
+        let args: [String: Any]
+        /// Orders events at the same timestamp: ends first, then longer spans open first
+        let tieBreak: Int64
+
+        /// Slice ends and counters are identified by their track alone
+        var carriesName: Bool {
+            switch kind {
+            case .begin, .instant: return true
+            case .end, .counter: return false
+            }
+        }
+    }
+
+    private var events: [Event] = []
+    private var threadNames: [Int: String] = [:]
+    private var counterTracks: [String: UInt64] = [:]
+
+    init(originNanoseconds: UInt64) {
+        self.originNanoseconds = originNanoseconds
+    }
+
+    // MARK: - Events
+
+    mutating func addSpan(
+        _ name: String,
+        category: String,
+        startNanoseconds: UInt64,
+        durationNanoseconds: UInt64,
+        threadID: Int = 1,
+        args: [String: Any] = [:]
+    ) {
+        let start = relative(startNanoseconds)
+        let track = threadTrack(threadID)
+        let duration = Int64(clamping: durationNanoseconds)
+        events.append(Event(timestamp: start, kind: .begin, track: track, name: name,
+                            category: category, args: args, tieBreak: -duration))
+        events.append(Event(timestamp: start + durationNanoseconds, kind: .end, track: track, name: name,
+                            category: category, args: [:], tieBreak: Int64.min + duration))
+    }
+
+    mutating func addInstant(
+        _ name: String,
+        category: String,
+        atNanoseconds: UInt64,
+        threadID: Int = 1,
+        args: [String: Any] = [:]
+    ) {
+        events.append(Event(timestamp: relative(atNanoseconds), kind: .instant, track: threadTrack(threadID),
+                            name: name, category: category, args: args, tieBreak: 0))
+    }
+
+    /// Each key becomes its own counter track, named "<name> <key>"
+    mutating func addCounter(
+        _ name: String,
+        category: String,
+        atNanoseconds: UInt64,
+        values: [String: Double]
+    ) {
+        for (series, value) in values.sorted(by: { $0.key < $1.key }) {
+            let trackName = values.count == 1 && series.isEmpty ? name : "\(name) \(series)"
+            if counterTracks[trackName] == nil {
+                counterTracks[trackName] = Self.counterTrackBase + UInt64(counterTracks.count)
+            }
+            let track = counterTracks[trackName]!
+            events.append(Event(timestamp: relative(atNanoseconds), kind: .counter(value), track: track,
+                                name: trackName, category: category, args: [:], tieBreak: 0))
+        }
+    }
+
+    mutating func nameThread(_ threadID: Int, _ name: String) {
+        threadNames[threadID] = name
+    }
+
+    // MARK: - Output
+
+    func data() throws -> Data {
+        var trace = ProtobufMessage()
+        var first = true
+
+        func append(_ packet: inout ProtobufMessage, timestamp: UInt64? = nil) {
+            if let timestamp = timestamp {
+                packet.uint(Field.timestamp, timestamp)
+            }
+            packet.uint(Field.trustedPacketSequenceID, Self.sequenceID)
+            if first {
+                packet.uint(Field.sequenceFlags, 1)  // SEQ_INCREMENTAL_STATE_CLEARED
+                first = false
+            }
+            trace.message(Field.tracePacket, packet)
+        }
+
+        // Track descriptors: the process, its threads, its counters
+        var process = ProtobufMessage()
+        process.int(1, Int64(processID))             // ProcessDescriptor.pid
+        process.string(6, processName)               // ProcessDescriptor.process_name
+        var processTrack = ProtobufMessage()
+        processTrack.uint(1, Self.processTrackUUID)  // TrackDescriptor.uuid
+        processTrack.message(3, process)             // TrackDescriptor.process
+        var packet = ProtobufMessage()
+        packet.message(Field.trackDescriptor, processTrack)
+        append(&packet)
+
+        let threadIDs = Set(events.compactMap { Self.threadID(ofTrack: $0.track) }).union(threadNames.keys)
+        for threadID in threadIDs.sorted() {
+            var thread = ProtobufMessage()
+            thread.int(1, Int64(processID))          // ThreadDescriptor.pid
+            thread.int(2, Int64(threadID))           // ThreadDescriptor.tid
+            thread.string(5, threadNames[threadID] ?? "thread \(threadID)")
+            var track = ProtobufMessage()
+            track.uint(1, threadTrack(threadID))
+            track.uint(5, Self.processTrackUUID)     // TrackDescriptor.parent_uuid
+            track.message(4, thread)                 // TrackDescriptor.thread
+            var packet = ProtobufMessage()
+            packet.message(Field.trackDescriptor, track)
+            append(&packet)
+        }
+
+        for (name, uuid) in counterTracks.sorted(by: { $0.value < $1.value }) {
+            var track = ProtobufMessage()
+            track.uint(1, uuid)
+            track.string(2, name)                    // TrackDescriptor.name
+            track.uint(5, Self.processTrackUUID)
+            track.message(8, ProtobufMessage())      // TrackDescriptor.counter (defaults)
+            var packet = ProtobufMessage()
+            packet.message(Field.trackDescriptor, track)
+            append(&packet)
+        }
+
+        // Track events in time order (slices must nest on each track)
+        let ordered = events.sorted {
+            ($0.timestamp, $0.tieBreak) < ($1.timestamp, $1.tieBreak)
+        }
+        for event in ordered {
+            var trackEvent = ProtobufMessage()
+            trackEvent.uint(11, event.track)         // TrackEvent.track_uuid
+            switch event.kind {
+            case .begin:
+                trackEvent.uint(9, 1)                // TYPE_SLICE_BEGIN
+            case .end:
+                trackEvent.uint(9, 2)                // TYPE_SLICE_END
+            case .instant:
+                trackEvent.uint(9, 3)                // TYPE_INSTANT
+            case .counter(let value):
+                trackEvent.uint(9, 4)                // TYPE_COUNTER
+                trackEvent.double(44, value)         // TrackEvent.double_counter_value
+            }
+            if event.carriesName {
+                trackEvent.string(22, event.category)    // TrackEvent.categories
+                trackEvent.string(23, event.name)        // TrackEvent.name
+                for (key, value) in event.args.sorted(by: { $0.key < $1.key }) {
+                    trackEvent.message(4, Self.debugAnnotation(key, value))
+                }
+            }
+
+            var packet = ProtobufMessage()
+            packet.message(Field.trackEvent, trackEvent)
+            append(&packet, timestamp: event.timestamp)
+        }
+
+        return Data(trace.bytes)
+    }
+
+    // MARK: - Helpers
+
+    private enum Field {
+        static let tracePacket = 1          // Trace.packet
+        static let timestamp = 8            // TracePacket.timestamp
+        static let trustedPacketSequenceID = 10
+        static let trackEvent = 11
+        static let sequenceFlags = 13
+        static let trackDescriptor = 60
+    }
+
+    private static let sequenceID: UInt64 = 1
+    private static let processTrackUUID: UInt64 = 1
+    private static let counterTrackBase: UInt64 = 1 << 16
+    private static let threadTrackBase: UInt64 = 1 << 32
+
+    private func threadTrack(_ threadID: Int) -> UInt64 {
+        Self.threadTrackBase + UInt64(UInt32(truncatingIfNeeded: threadID))
+    }
+
+    private static func threadID(ofTrack track: UInt64) -> Int? {
+        guard track >= threadTrackBase else { return nil }
+        return Int(track - threadTrackBase)
+    }
+
+    private func relative(_ nanoseconds: UInt64) -> UInt64 {
+        // Events recorded before the origin are clamped to 0
+        nanoseconds > originNanoseconds ? nanoseconds - originNanoseconds : 0
+    }
+
+    private static func debugAnnotation(_ name: String, _ value: Any) -> ProtobufMessage {
+        var annotation = ProtobufMessage()
+        annotation.string(10, name)                  // DebugAnnotation.name
+        switch value {
+        case let flag as Bool:
+            annotation.uint(2, flag ? 1 : 0)         // bool_value
+        case let integer as Int:
+            annotation.int(4, Int64(integer))        // int_value
+        case let integer as Int64:
+            annotation.int(4, integer)
+        case let integer as UInt64:
+            annotation.uint(3, integer)              // uint_value
+        case let number as Double:
+            annotation.double(5, number)             // double_value
+        default:
+            annotation.string(6, String(describing: value))  // string_value
+        }
+        return annotation
+    }
+}
+
+/// Minimal protobuf encoder (varint, fixed64 and length-delimited fields)
+private struct ProtobufMessage {
+
+    private(set) var bytes: [UInt8] = []
+
+    mutating func uint(_ field: Int, _ value: UInt64) {
+        key(field, wireType: 0)
+        varint(value)
+    }
+
+    /// int32/int64 fields: two's complement, so negatives take ten bytes
+    mutating func int(_ field: Int, _ value: Int64) {
+        uint(field, UInt64(bitPattern: value))
+    }
+
+    mutating func double(_ field: Int, _ value: Double) {
+        key(field, wireType: 1)
+        withUnsafeBytes(of: value.bitPattern.littleEndian) { bytes.append(contentsOf: $0) }
+    }
+
+    mutating func string(_ field: Int, _ value: String) {
+        lengthDelimited(field, Array(value.utf8))
+    }
+
+    mutating func message(_ field: Int, _ message: ProtobufMessage) {
+        lengthDelimited(field, message.bytes)
+    }
+
+    private mutating func lengthDelimited(_ field: Int, _ payload: [UInt8]) {
+        key(field, wireType: 2)
+        varint(UInt64(payload.count))
+        bytes.append(contentsOf: payload)
+    }
+
+    private mutating func key(_ field: Int, wireType: UInt64) {
+        varint(UInt64(field) << 3 | wireType)
+    }
+
+    private mutating func varint(_ value: UInt64) {
+        var value = value
+        while value >= 0x80 {
+            bytes.append(UInt8(value & 0x7F) | 0x80)
+            value >>= 7
+        }
+        bytes.append(UInt8(value))
+    }
+}
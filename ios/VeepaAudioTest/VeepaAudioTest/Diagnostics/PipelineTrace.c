@@ -0,0 +1,385 @@
+//
+//  PipelineTrace.c
+//  VeepaAudioTest
+//
+//  Created for pipeline timeline tracing
+//  Purpose: Per-thread lock-free event rings for pipeline tracing
+//
+
+#include "PipelineTrace.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BUFFER_ALIGN 64
+
+/// One event in a ring; every field is stored atomically so a concurrent
+/// reader never tears a word (it discards overwritten slots instead)
+typedef struct {
+    uint64_t time_ns;
+    uint64_t value;
+    uint64_t meta;           ///< duration (32) | session (16) | event (8) | kind (8)
+} trace_slot;
+
+/// Ring ownership: FREE (on the free list) → CLAIMING → ACTIVE (its
+/// thread records) → RETIRED (thread exited) → FREE once its events were
+/// copied out and released (pipeline_trace_release_exited), or by a start
+enum {
+    BUFFER_FREE = 0,
+    BUFFER_CLAIMING,
+    BUFFER_ACTIVE,
+    BUFFER_RETIRED,
+};
+
+/// One thread's ring; the header owns a cache line so writers never share one
+typedef struct {
+    uint64_t head;           ///< (atomic) Events published
+    uint64_t claimed;        ///< (atomic) Events started (head, or head + 1 mid-write)
+    uint64_t tail;           ///< (atomic) Reader's lower bound, set by start and each new owner
+    uint64_t thread_id;
+    char name[32];
+    uint32_t state;          ///< (atomic) BUFFER_*; id and name are set before ACTIVE
+    uint32_t free_next;      ///< (atomic) Next free ring + 1 (0 = end of the free list)
+    uint32_t flushed;        ///< Copied out since it retired (readers, under g_controlLock)
+    trace_slot *slots;
+} __attribute__((aligned(BUFFER_ALIGN))) trace_buffer;
+
+static trace_buffer *g_buffers = NULL;     ///< (atomic) Allocated by the first start, never freed
+static trace_slot *g_slots = NULL;
+static uint32_t g_bufferCount = 0;
+static uint64_t g_mask = 0;                ///< Events per ring - 1
+static uint32_t g_registered = 0;          ///< (atomic) Rings ever handed out (high-water mark)
+static uint64_t g_freeList = 0;            ///< (atomic) Pop count (32) | top ring + 1 (32)
+static uint64_t g_dropped = 0;             ///< (atomic)
+static int g_enabled = 0;                  ///< (atomic)
+
+static pthread_key_t g_threadKey;
+static pthread_once_t g_threadKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_controlLock = PTHREAD_MUTEX_INITIALIZER;
+
+/// Thread-specific marker for "no ring available": such a thread only
+/// checks the free list per event, it does not take a fresh ring again
+static trace_buffer g_noBuffer;
+
+/// Thread exit: the ring keeps its events until they are read and released
+static void retire_thread_buffer(void *value) {
+    trace_buffer *buffer = (trace_buffer *)value;
+    if (buffer == NULL || buffer == &g_noBuffer) return;
+    __atomic_store_n(&buffer->state, BUFFER_RETIRED, __ATOMIC_RELEASE);
+}
+
+static void create_thread_key(void) {
+    pthread_key_create(&g_threadKey, retire_thread_buffer);
+}
+
+static uint64_t current_thread_id(void) {
+#ifdef __APPLE__
+    uint64_t tid = 0;
+    pthread_threadid_np(NULL, &tid);
+    return tid;
+#else
+    return (uint64_t)pthread_self();
+#endif
+}
+
+static uint32_t next_power_of_two(uint32_t value) {
+    uint32_t power = 2;
+    while (power < value && power < (1u << 30)) power <<= 1;
+    return power;
+}
+
+#pragma mark - Free List
+
+/// Return a retired ring for reuse (with g_controlLock held: one pusher)
+static void free_buffer(uint32_t index) {
+    trace_buffer *buffer = &g_buffers[index];
+    __atomic_store_n(&buffer->state, BUFFER_FREE, __ATOMIC_RELAXED);
+    uint64_t top = __atomic_load_n(&g_freeList, __ATOMIC_RELAXED);
+    uint64_t next;
+    buffer->flushed = 0;
+    do {
+        __atomic_store_n(&buffer->free_next, (uint32_t)top, __ATOMIC_RELAXED);
+        next = (top & 0xFFFFFFFF00000000ull) | (index + 1);
+    } while (!__atomic_compare_exchange_n(&g_freeList, &top, next, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/// Take a freed ring (any thread, lock-free; the pop count in the top word
+/// keeps a ring popped and pushed back meanwhile from being mistaken)
+static trace_buffer *pop_free_buffer(trace_buffer *buffers) {
+    uint64_t top = __atomic_load_n(&g_freeList, __ATOMIC_ACQUIRE);
+    while ((uint32_t)top != 0) {
+        trace_buffer *buffer = &buffers[(uint32_t)top - 1];
+        uint32_t after = __atomic_load_n(&buffer->free_next, __ATOMIC_RELAXED);  // Stale if popped meanwhile: the CAS fails
+        uint64_t next = ((top >> 32) + 1) << 32 | after;
+        if (__atomic_compare_exchange_n(&g_freeList, &top, next, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+/// A retired ring whose events are no longer wanted goes back on the free
+/// list (with g_controlLock held)
+static void free_retired_buffer(uint32_t index) {
+    uint32_t retired = BUFFER_RETIRED;
+    if (__atomic_compare_exchange_n(&g_buffers[index].state, &retired, BUFFER_CLAIMING, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        free_buffer(index);
+    }
+}
+
+#pragma mark - Control
+
+int pipeline_trace_start(uint32_t max_threads, uint32_t events_per_thread) {
+    if (max_threads == 0 || events_per_thread == 0) return PIPELINE_TRACE_ERR_ARGS;
+    pthread_once(&g_threadKeyOnce, create_thread_key);
+
+    pthread_mutex_lock(&g_controlLock);
+    if (__atomic_load_n(&g_buffers, __ATOMIC_ACQUIRE) == NULL) {
+        uint32_t threads = max_threads < PIPELINE_TRACE_MAX_THREADS ? max_threads : PIPELINE_TRACE_MAX_THREADS;
+        uint32_t events = next_power_of_two(events_per_thread);
+
+        trace_buffer *buffers = (trace_buffer *)aligned_alloc(BUFFER_ALIGN, threads * sizeof(trace_buffer));
+        trace_slot *slots = (trace_slot *)calloc((size_t)threads * events, sizeof(trace_slot));
+        if (buffers == NULL || slots == NULL) {
+            free(buffers);
+            free(slots);
+            pthread_mutex_unlock(&g_controlLock);
+            return PIPELINE_TRACE_ERR_NOMEM;
+        }
+        memset(buffers, 0, threads * sizeof(trace_buffer));
+        for (uint32_t index = 0; index < threads; index++) {
+            buffers[index].slots = slots + (size_t)index * events;
+        }
+
+        g_slots = slots;
+        g_bufferCount = threads;
+        g_mask = events - 1;
+        __atomic_store_n(&g_buffers, buffers, __ATOMIC_RELEASE);
+    }
+
+    // Discard earlier events without touching the writers' positions; rings
+    // of threads that have exited are free again
+    uint32_t registered = pipeline_trace_thread_count();
+    for (uint32_t index = 0; index < registered; index++) {
+        trace_buffer *buffer = &g_buffers[index];
+        __atomic_store_n(&buffer->tail, __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+        free_retired_buffer(index);
+    }
+    __atomic_store_n(&g_dropped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_enabled, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_controlLock);
+    return PIPELINE_TRACE_OK;
+}
+
+void pipeline_trace_stop(void) {
+    __atomic_store_n(&g_enabled, 0, __ATOMIC_RELEASE);
+}
+
+int pipeline_trace_enabled(void) {
+    return __atomic_load_n(&g_enabled, __ATOMIC_RELAXED);
+}
+
+uint64_t pipeline_trace_dropped(void) {
+    return __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+}
+
+#pragma mark - Recording
+
+uint64_t pipeline_trace_now(void) {
+#ifdef __APPLE__
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t pipeline_trace_begin(void) {
+    return pipeline_trace_enabled() ? pipeline_trace_now() : 0;
+}
+
+/// The calling thread's ring, claimed on its first event: a ring an exited
+/// thread left (once its events were read), else a fresh one; NULL while
+/// every ring is owned
+static trace_buffer *thread_buffer(void) {
+    trace_buffer *buffer = (trace_buffer *)pthread_getspecific(g_threadKey);
+    if (buffer != NULL && buffer != &g_noBuffer) return buffer;
+
+    trace_buffer *buffers = __atomic_load_n(&g_buffers, __ATOMIC_ACQUIRE);
+    if (buffers == NULL) return NULL;
+    trace_buffer *freed = pop_free_buffer(buffers);
+    if (freed != NULL) {
+        __atomic_store_n(&freed->state, BUFFER_CLAIMING, __ATOMIC_RELAXED);
+        // The previous owner's events were read or discarded; start after them
+        __atomic_store_n(&freed->tail, __atomic_load_n(&freed->head, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        buffer = freed;
+    } else {
+        if (buffer == &g_noBuffer) return NULL;  // Already had its fresh ring attempt
+        uint32_t index = __atomic_fetch_add(&g_registered, 1, __ATOMIC_RELAXED);
+        if (index >= g_bufferCount) {
+            pthread_setspecific(g_threadKey, &g_noBuffer);
+            return NULL;
+        }
+        buffer = &buffers[index];
+    }
+
+    buffer->thread_id = current_thread_id();
+    memset(buffer->name, 0, sizeof(buffer->name));
+#ifdef __APPLE__
+    pthread_getname_np(pthread_self(), buffer->name, sizeof(buffer->name));
+#endif
+    __atomic_store_n(&buffer->state, BUFFER_ACTIVE, __ATOMIC_RELEASE);
+    pthread_setspecific(g_threadKey, buffer);
+    return buffer;
+}
+
+static void record(pipeline_trace_kind kind, pipeline_trace_event event, uint32_t session,
+                   uint64_t time_ns, uint64_t duration_ns, int64_t value) {
+    if (!__atomic_load_n(&g_enabled, __ATOMIC_ACQUIRE)) return;
+    trace_buffer *buffer = thread_buffer();
+    if (buffer == NULL) {
+        __atomic_fetch_add(&g_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (duration_ns > UINT32_MAX) duration_ns = UINT32_MAX;
+    if (session > PIPELINE_TRACE_NO_SESSION) session = PIPELINE_TRACE_NO_SESSION;
+    uint64_t meta = duration_ns << 32 | (uint64_t)session << 16 | (uint64_t)(event & 0xFF) << 8 | (kind & 0xFF);
+
+    // Announce the slot before overwriting it, so a concurrent copy can tell
+    // which of the slots it read may be half new
+    uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&buffer->claimed, head + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    trace_slot *slot = &buffer->slots[head & g_mask];
+    __atomic_store_n(&slot->time_ns, time_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->value, (uint64_t)value, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->meta, meta, __ATOMIC_RELAXED);
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void pipeline_trace_span(pipeline_trace_event event, uint64_t start_ns, uint32_t session, int64_t value) {
+    if (start_ns == 0) return;
+    uint64_t now = pipeline_trace_now();
+    record(PIPELINE_TRACE_SPAN, event, session, start_ns, now > start_ns ? now - start_ns : 0, value);
+}
+
+void pipeline_trace_instant(pipeline_trace_event event, uint32_t session, int64_t value) {
+    record(PIPELINE_TRACE_INSTANT, event, session, pipeline_trace_now(), 0, value);
+}
+
+void pipeline_trace_counter(pipeline_trace_event event, uint32_t session, int64_t value) {
+    record(PIPELINE_TRACE_COUNTER, event, session, pipeline_trace_now(), 0, value);
+}
+
+#pragma mark - Reading
+
+uint32_t pipeline_trace_thread_count(void) {
+    if (__atomic_load_n(&g_buffers, __ATOMIC_ACQUIRE) == NULL) return 0;
+    uint32_t registered = __atomic_load_n(&g_registered, __ATOMIC_RELAXED);
+    return registered < g_bufferCount ? registered : g_bufferCount;
+}
+
+/// Copy one ring (with g_controlLock held, so it is not freed and renamed
+/// by a new owner mid-copy)
+static uint32_t copy_buffer(trace_buffer *buffer, pipeline_trace_thread *thread,
+                            pipeline_trace_record *events, uint32_t capacity) {
+    uint32_t state = __atomic_load_n(&buffer->state, __ATOMIC_ACQUIRE);
+    if (state != BUFFER_ACTIVE && state != BUFFER_RETIRED) return 0;
+    // Retired before the copy: no event can follow, so this copy has them all
+    if (state == BUFFER_RETIRED) buffer->flushed = 1;
+
+    const uint64_t size = g_mask + 1;
+    uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_RELAXED);
+    uint64_t first = head > size ? head - size : 0;
+    if (first < tail) first = tail;
+    if (head - first > capacity) first = head - capacity;
+
+    uint32_t count = 0;
+    for (uint64_t position = first; position < head; position++) {
+        const trace_slot *slot = &buffer->slots[position & g_mask];
+        uint64_t meta = __atomic_load_n(&slot->meta, __ATOMIC_RELAXED);
+        pipeline_trace_record *out = &events[count++];
+        out->time_ns = __atomic_load_n(&slot->time_ns, __ATOMIC_RELAXED);
+        out->value = (int64_t)__atomic_load_n(&slot->value, __ATOMIC_RELAXED);
+        out->duration_ns = (uint32_t)(meta >> 32);
+        out->session = (uint16_t)(meta >> 16);
+        out->event = (uint8_t)(meta >> 8);
+        out->kind = (uint8_t)meta;
+    }
+
+    // Anything the writer started overwriting while we copied is unreliable
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t claimed = __atomic_load_n(&buffer->claimed, __ATOMIC_RELAXED);
+    uint64_t valid = claimed > size ? claimed - size : 0;
+    uint32_t stale = valid > first ? (uint32_t)(valid - first < count ? valid - first : count) : 0;
+    if (stale > 0) {
+        memmove(events, events + stale, (count - stale) * sizeof(pipeline_trace_record));
+        count -= stale;
+    }
+
+    if (thread != NULL) {
+        thread->thread_id = buffer->thread_id;
+        memcpy(thread->name, buffer->name, sizeof(thread->name));
+        thread->name[sizeof(thread->name) - 1] = '\0';
+        thread->recorded = head - tail;
+        thread->overwritten = head - tail > size ? head - tail - size : 0;
+    }
+    return count;
+}
+
+uint32_t pipeline_trace_copy_thread(uint32_t index, pipeline_trace_thread *thread,
+                                    pipeline_trace_record *events, uint32_t capacity) {
+    trace_buffer *buffers = __atomic_load_n(&g_buffers, __ATOMIC_ACQUIRE);
+    if (buffers == NULL || index >= pipeline_trace_thread_count()) return 0;
+
+    pthread_mutex_lock(&g_controlLock);
+    uint32_t count = copy_buffer(&buffers[index], thread, events, capacity);
+    pthread_mutex_unlock(&g_controlLock);
+    return count;
+}
+
+void pipeline_trace_release_exited(void) {
+    pthread_mutex_lock(&g_controlLock);
+    uint32_t registered = pipeline_trace_thread_count();
+    for (uint32_t index = 0; index < registered; index++) {
+        if (g_buffers[index].flushed) {
+            free_retired_buffer(index);
+        }
+    }
+    pthread_mutex_unlock(&g_controlLock);
+}
+
+const char *pipeline_trace_event_name(pipeline_trace_event event) {
+    switch (event) {
+        case PIPELINE_TRACE_FRAME_ARRIVAL:  return "frameArrival";
+        case PIPELINE_TRACE_DECODE:         return "decode";
+        case PIPELINE_TRACE_RING_WRITE:     return "ringWrite";
+        case PIPELINE_TRACE_RENDER_PULL:    return "renderPull";
+        case PIPELINE_TRACE_UNDERFLOW:      return "underflow";
+        case PIPELINE_TRACE_ENGINE_RESTART: return "engineRestart";
+        case PIPELINE_TRACE_KEEPALIVE:      return "keepAlive";
+        case PIPELINE_TRACE_RING_FILL:      return "ringFill";
+        default:                            return "unknown";
+    }
+}
+
+const char *pipeline_trace_event_category(pipeline_trace_event event) {
+    switch (event) {
+        case PIPELINE_TRACE_FRAME_ARRIVAL:
+        case PIPELINE_TRACE_KEEPALIVE:      return "network";
+        case PIPELINE_TRACE_DECODE:         return "decode";
+        case PIPELINE_TRACE_RING_WRITE:
+        case PIPELINE_TRACE_RENDER_PULL:
+        case PIPELINE_TRACE_UNDERFLOW:
+        case PIPELINE_TRACE_RING_FILL:      return "playout";
+        case PIPELINE_TRACE_ENGINE_RESTART: return "engine";
+        default:                            return "other";
+    }
+}
@@ -0,0 +1,149 @@
+//
+//  PipelineTrace.h
+//  VeepaAudioTest
+//
+//  Created for pipeline timeline tracing
+//  Purpose: Record pipeline events (frame arrival, decode, ring write,
+//           render pull, underflow, engine restart, keep-alive) into
+//           per-thread lock-free buffers for Chrome/Perfetto export
+//
+//  Every thread that records gets its own fixed ring of events, claimed
+//  from a pool allocated by pipeline_trace_start, so recording never
+//  allocates, locks or shares a cache line with another thread - the render
+//  callback can trace itself. A ring keeps the most recent events; older
+//  ones are overwritten and counted.
+//
+//  When a thread exits its ring keeps its events until they have been
+//  copied out and pipeline_trace_release_exited is called (after a dump),
+//  or until the next start; then it goes on a free list for the next new
+//  thread. Events of a thread that finds no ring are dropped and counted
+//  (pipeline_trace_dropped).
+//
+//  Three kinds of event:
+//    - spans: start time and duration (recorded when the work ends)
+//    - instants: a point in time with one integer argument
+//    - counters: a sampled value (e.g. ring fill), one series per session
+//
+//  Reading (pipeline_trace_copy_thread) runs concurrently with recording:
+//  it copies a thread's ring, then drops anything the writer may have
+//  overwritten meanwhile. PipelineTrace.swift turns the copies into Chrome
+//  JSON or Perfetto protobuf files.
+//
+//  Timestamps are uptime nanoseconds (DispatchTime.uptimeNanoseconds, the
+//  clock of StartupTrace and AudioTimeStamp.mHostTime).
+//
+
+#ifndef PipelineTrace_h
+#define PipelineTrace_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Threads that can own a ring at once (events of any more are dropped)
+#define PIPELINE_TRACE_MAX_THREADS      64
+/// Session value for events not tied to a stream
+#define PIPELINE_TRACE_NO_SESSION       0xFFFF
+
+typedef enum {
+    PIPELINE_TRACE_FRAME_ARRIVAL = 0,   ///< Instant; value = frameNo
+    PIPELINE_TRACE_DECODE,              ///< Span; value = samples
+    PIPELINE_TRACE_RING_WRITE,          ///< Span; value = samples
+    PIPELINE_TRACE_RENDER_PULL,         ///< Span; value = samples read from the ring
+    PIPELINE_TRACE_UNDERFLOW,           ///< Instant; value = samples concealed or silent
+    PIPELINE_TRACE_ENGINE_RESTART,      ///< Instant; value = attempt
+    PIPELINE_TRACE_KEEPALIVE,           ///< Instant; value = keep-alives sent
+    PIPELINE_TRACE_RING_FILL,           ///< Counter; value = buffered samples
+    PIPELINE_TRACE_EVENT_COUNT
+} pipeline_trace_event;
+
+typedef enum {
+    PIPELINE_TRACE_SPAN = 0,
+    PIPELINE_TRACE_INSTANT,
+    PIPELINE_TRACE_COUNTER,
+} pipeline_trace_kind;
+
+/// One recorded event as read back
+typedef struct {
+    uint64_t time_ns;        ///< Start (spans) or occurrence
+    int64_t  value;          ///< Argument or counter value
+    uint32_t duration_ns;    ///< Spans only (saturates at ~4.3 s)
+    uint16_t session;        ///< Session slot or PIPELINE_TRACE_NO_SESSION
+    uint8_t  event;          ///< pipeline_trace_event
+    uint8_t  kind;           ///< pipeline_trace_kind
+} pipeline_trace_record;
+
+/// A recording thread
+typedef struct {
+    uint64_t thread_id;      ///< pthread_threadid_np
+    char     name[32];       ///< Thread name when it first recorded ("" if unnamed)
+    uint64_t recorded;       ///< Events recorded since the last start
+    uint64_t overwritten;    ///< Of those, lost to the ring wrapping
+} pipeline_trace_thread;
+
+/// Error codes (negative return values)
+enum {
+    PIPELINE_TRACE_OK           = 0,
+    PIPELINE_TRACE_ERR_NOMEM    = -1,
+    PIPELINE_TRACE_ERR_ARGS     = -2,
+};
+
+#pragma mark - Control
+
+/// Start recording. The first start allocates `max_threads` rings of
+/// `events_per_thread` events (rounded up to a power of two); later starts
+/// keep those sizes and only discard what was recorded before.
+int pipeline_trace_start(uint32_t max_threads, uint32_t events_per_thread);
+
+/// Stop recording (events stay readable until the next start)
+void pipeline_trace_stop(void);
+
+/// 1 while recording
+int pipeline_trace_enabled(void);
+
+/// Events dropped since the last start because their thread found no free ring
+uint64_t pipeline_trace_dropped(void);
+
+#pragma mark - Recording (any thread, real-time safe)
+
+/// Uptime in nanoseconds
+uint64_t pipeline_trace_now(void);
+
+/// Span start: the current time while recording, else 0
+uint64_t pipeline_trace_begin(void);
+
+/// Record a span from `start_ns` (pipeline_trace_begin) to now; no-op for a 0 start
+void pipeline_trace_span(pipeline_trace_event event, uint64_t start_ns, uint32_t session, int64_t value);
+
+void pipeline_trace_instant(pipeline_trace_event event, uint32_t session, int64_t value);
+
+void pipeline_trace_counter(pipeline_trace_event event, uint32_t session, int64_t value);
+
+#pragma mark - Reading
+
+/// Rings handed out since the first start (indices for copy_thread; a
+/// ring may have had several threads)
+uint32_t pipeline_trace_thread_count(void);
+
+/// Copy the surviving events of the thread that owns ring `index`, oldest first
+/// @param events Receives up to `capacity` events (the most recent ones)
+/// @return Events copied
+uint32_t pipeline_trace_copy_thread(uint32_t index, pipeline_trace_thread *thread,
+                                    pipeline_trace_record *events, uint32_t capacity);
+
+/// Free the rings of exited threads whose events a copy has already
+/// returned, for new threads to claim
+void pipeline_trace_release_exited(void);
+
+const char *pipeline_trace_event_name(pipeline_trace_event event);
+
+/// Trace category ("network", "decode", "playout", "engine")
+const char *pipeline_trace_event_category(pipeline_trace_event event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PipelineTrace_h */
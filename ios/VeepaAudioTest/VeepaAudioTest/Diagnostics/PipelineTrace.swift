@@ -0,0 +1,168 @@
+//
+//  PipelineTrace.swift
+//  VeepaAudioTest
+//
+//  Created for pipeline timeline tracing
+//  Purpose: Start/stop pipeline tracing and dump the per-thread event rings
+//           as Chrome JSON or Perfetto protobuf trace files
+//
+//  Recording happens in PipelineTrace.c, called straight from the capture,
+//  decode, ring and render paths. A dump copies every thread's ring and
+//  lays the events out one track per thread, so jitter between frame
+//  arrival, ring writes and render pulls is visible on one timeline. Ring
+//  fill is a counter track per session. Once dumped, the rings of threads
+//  that have exited are handed to new threads.
+//
+
+import Foundation
+
+enum PipelineTrace {
+
+    /// Trace file formats a dump can write
+    enum Format: String, CaseIterable {
+        case chromeJSON
+        case perfetto
+
+        var fileExtension: String {
+            switch self {
+            case .chromeJSON: return "json"
+            case .perfetto: return "perfetto-trace"
+            }
+        }
+    }
+
+    enum TraceError: Error, LocalizedError {
+        case startFailed(code: Int32)
+
+        var errorDescription: String? {
+            switch self {
+            case .startFailed(let code):
+                return "Cannot start pipeline tracing (error \(code))"
+            }
+        }
+    }
+
+    /// One thread's events as copied out of its ring
+    struct ThreadTrack {
+        let threadID: UInt64
+        let name: String
+        let events: [pipeline_trace_record]
+        /// Events lost to the ring wrapping before the dump
+        let overwritten: UInt64
+    }
+
+    /// Directory dumps are written to
+    static let traceDirectory: URL = FileManager.default
+        .urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        .appendingPathComponent("PipelineTraces", isDirectory: true)
+
+    static var isRecording: Bool {
+        pipeline_trace_enabled() != 0
+    }
+
+    /// Events lost since the last start because every ring was owned by a
+    /// live thread (or an exited one not dumped yet)
+    static var droppedEvents: UInt64 {
+        pipeline_trace_dropped()
+    }
+
+    // MARK: - Control
+
+    /// Start recording (discarding earlier events). Ring sizes are fixed by
+    /// the first start: 32 threads × 16384 events is about 12 MB.
+    static func start(threads: Int = 32, eventsPerThread: Int = 16384) throws {
+        let result = pipeline_trace_start(UInt32(threads), UInt32(eventsPerThread))
+        guard result == Int32(PIPELINE_TRACE_OK) else {
+            throw TraceError.startFailed(code: result)
+        }
+        print("[PipelineTrace] ⏺️ Recording")
+    }
+
+    static func stop() {
+        pipeline_trace_stop()
+    }
+
+    // MARK: - Reading
+
+    /// Free the rings of exited threads whose events collect() has returned
+    static func releaseExitedThreads() {
+        pipeline_trace_release_exited()
+    }
+
+    /// Copy every thread's surviving events (recording may continue)
+    static func collect() -> [ThreadTrack] {
+        var records = [pipeline_trace_record](repeating: pipeline_trace_record(), count: 1 << 16)
+        return (0..<pipeline_trace_thread_count()).compactMap { index in
+            var thread = pipeline_trace_thread()
+            let count = Int(pipeline_trace_copy_thread(index, &thread, &records, UInt32(records.count)))
+            guard count > 0 else { return nil }
+            let name = withUnsafeBytes(of: &thread.name) { String(cString: $0.bindMemory(to: CChar.self).baseAddress!) }
+            return ThreadTrack(threadID: thread.thread_id, name: name,
+                               events: Array(records.prefix(count)), overwritten: thread.overwritten)
+        }
+    }
+
+    /// Lay tracks out on a writer: one track per thread, counters per session
+    static func render<Writer: TraceEventWriter>(_ tracks: [ThreadTrack], into writer: inout Writer) {
+        for track in tracks {
+            let tid = Int(truncatingIfNeeded: track.threadID)
+            writer.nameThread(tid, track.name.isEmpty ? "thread \(track.threadID)" : track.name)
+
+            for record in track.events {
+                let event = pipeline_trace_event(UInt32(record.event))
+                let name = String(cString: pipeline_trace_event_name(event))
+                let category = String(cString: pipeline_trace_event_category(event))
+                var args: [String: Any] = ["value": Int(record.value)]
+                if record.session != UInt16(PIPELINE_TRACE_NO_SESSION) {
+                    args["session"] = Int(record.session)
+                }
+
+                switch pipeline_trace_kind(UInt32(record.kind)) {
+                case PIPELINE_TRACE_SPAN:
+                    writer.addSpan(name, category: category, startNanoseconds: record.time_ns,
+                                   durationNanoseconds: UInt64(record.duration_ns), threadID: tid, args: args)
+                case PIPELINE_TRACE_COUNTER:
+                    let series = record.session == UInt16(PIPELINE_TRACE_NO_SESSION) ? "" : "session \(record.session)"
+                    writer.addCounter(name, category: category, atNanoseconds: record.time_ns,
+                                      values: [series: Double(record.value)])
+                default:
+                    writer.addInstant(name, category: category, atNanoseconds: record.time_ns,
+                                      threadID: tid, args: args)
+                }
+            }
+        }
+    }
+
+    // MARK: - Dump
+
+    /// Write what the rings hold now to `directory`
+    /// - Returns: The trace file
+    @discardableResult
+    static func dump(as format: Format, to directory: URL = traceDirectory) throws -> URL {
+        let tracks = collect()
+        defer { releaseExitedThreads() }
+        let origin = tracks.compactMap { $0.events.first?.time_ns }.min() ?? pipeline_trace_now()
+        let url = directory
+            .appendingPathComponent("pipeline-\(Int(Date().timeIntervalSince1970))")
+            .appendingPathExtension(format.fileExtension)
+
+        switch format {
+        case .chromeJSON:
+            var writer = ChromeTraceWriter(originNanoseconds: origin)
+            render(tracks, into: &writer)
+            try writer.write(to: url)
+        case .perfetto:
+            var writer = PerfettoTraceWriter(originNanoseconds: origin)
+            render(tracks, into: &writer)
+            try writer.write(to: url)
+        }
+
+        let events = tracks.reduce(0) { $0 + $1.events.count }
+        let overwritten = tracks.reduce(0) { $0 + $1.overwritten }
+        let dropped = droppedEvents
+        print("[PipelineTrace] 💾 \(events) events from \(tracks.count) threads → \(url.lastPathComponent)"
+              + (overwritten > 0 ? " (\(overwritten) older events overwritten)" : "")
+              + (dropped > 0 ? " (\(dropped) events dropped: no free thread ring)" : ""))
+        return url
+    }
+}
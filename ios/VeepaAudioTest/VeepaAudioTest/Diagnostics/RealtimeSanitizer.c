@@ -0,0 +1,645 @@
+//
+//  RealtimeSanitizer.c
+//  VeepaAudioTest
+//
+//  Created for real-time safety checks
+//  Purpose: Interposers, lock-free violation log and stack table
+//
+
+#include "RealtimeSanitizer.h"
+
+#include <stddef.h>
+
+#if RT_SANITIZER
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <mach/mach.h>
+#include <mach-o/dyld.h>
+#include <mach-o/loader.h>
+#include <mach-o/nlist.h>
+#include <malloc/malloc.h>
+#include <objc/runtime.h>
+#include <os/lock.h>
+#include <stdarg.h>
+#include <unistd.h>
+#endif
+
+#pragma mark - State
+
+/// Log slot: seqlock word (2*seq+1 while writing, 2*seq+2 when complete)
+typedef struct {
+    uint64_t state;                  ///< (atomic)
+    rt_violation violation;
+} rt_log_slot;
+
+typedef struct {
+    uint64_t hash;                   ///< (atomic) 0 = free
+    uint32_t ready;                  ///< (atomic) Frames written
+    uint32_t depth;
+    void *frames[RT_SANITIZER_STACK_DEPTH];
+} rt_stack_slot;
+
+static rt_log_slot g_log[RT_SANITIZER_LOG_CAPACITY];
+static rt_stack_slot g_stacks[RT_SANITIZER_STACK_SLOTS];
+
+static uint64_t g_next_sequence;                      ///< (atomic) Violations ever recorded
+static uint64_t g_reset_sequence;                     ///< (atomic) g_next_sequence at the last reset
+static uint64_t g_kind_counts[RT_VIOLATION_KIND_COUNT];   ///< (atomic)
+
+static uint32_t g_active;                             ///< (atomic)
+static uint32_t g_hooked_symbols;
+static pthread_key_t g_scope_key;
+static pthread_once_t g_install_once = PTHREAD_ONCE_INIT;
+static int g_install_result = RT_SANITIZER_OK;
+
+/// Per-thread scope word: nesting depth, plus a bit set while recording
+/// (pthread TSD, not _Thread_local: TLV setup may itself call malloc)
+#define RT_SCOPE_DEPTH_MASK   0xFFFF
+#define RT_SCOPE_RECORDING    0x10000
+
+/// Frames of the sanitizer itself at the top of every captured stack
+#define RT_SKIPPED_FRAMES     3
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t current_thread_id(void) {
+#if defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np(NULL, &tid);
+    return tid;
+#else
+    return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+static inline uintptr_t scope_word(void) {
+    return (uintptr_t)pthread_getspecific(g_scope_key);
+}
+
+#pragma mark - Stack Table
+
+static uint32_t intern_stack(void **frames, int depth) {
+    // FNV-1a over the return addresses
+    uint64_t hash = 1469598103934665603ull;
+    for (int i = 0; i < depth; i++) {
+        hash = (hash ^ (uint64_t)(uintptr_t)frames[i]) * 1099511628211ull;
+    }
+    if (hash == 0) hash = 1;
+
+    for (uint32_t probe = 0; probe < RT_SANITIZER_STACK_SLOTS; probe++) {
+        uint32_t index = (uint32_t)(hash + probe) & (RT_SANITIZER_STACK_SLOTS - 1);
+        rt_stack_slot *slot = &g_stacks[index];
+        uint64_t existing = __atomic_load_n(&slot->hash, __ATOMIC_ACQUIRE);
+        if (existing == 0) {
+            uint64_t expected = 0;
+            if (__atomic_compare_exchange_n(&slot->hash, &expected, hash, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                memcpy(slot->frames, frames, (size_t)depth * sizeof(void *));
+                slot->depth = (uint32_t)depth;
+                __atomic_store_n(&slot->ready, 1, __ATOMIC_RELEASE);
+                return index + 1;
+            }
+            existing = expected;
+        }
+        if (existing == hash) return index + 1;
+    }
+    return 0;
+}
+
+#pragma mark - Recording
+
+__attribute__((noinline))
+static void record(rt_violation_kind kind, const char *function) {
+    void *frames[RT_SANITIZER_STACK_DEPTH + RT_SKIPPED_FRAMES];
+    int depth = backtrace(frames, RT_SANITIZER_STACK_DEPTH + RT_SKIPPED_FRAMES);
+    int skipped = depth > RT_SKIPPED_FRAMES ? RT_SKIPPED_FRAMES : 0;
+    uint32_t stack_id = intern_stack(frames + skipped, depth - skipped);
+
+    __atomic_fetch_add(&g_kind_counts[kind], 1, __ATOMIC_RELAXED);
+
+    // Claim the slot; if a writer a whole lap behind still holds it, the
+    // record is counted but not logged rather than waiting
+    uint64_t sequence = __atomic_fetch_add(&g_next_sequence, 1, __ATOMIC_RELAXED);
+    rt_log_slot *slot = &g_log[sequence & (RT_SANITIZER_LOG_CAPACITY - 1)];
+    uint64_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+    if ((state & 1) || !__atomic_compare_exchange_n(&slot->state, &state, 2 * sequence + 1, 0,
+                                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->violation.sequence = sequence;
+    slot->violation.time_ns = monotonic_ns();
+    slot->violation.thread_id = current_thread_id();
+    slot->violation.function = function;
+    slot->violation.kind = (uint32_t)kind;
+    slot->violation.stack_id = stack_id;
+    __atomic_store_n(&slot->state, 2 * sequence + 2, __ATOMIC_RELEASE);
+}
+
+/// Called by every interposer before forwarding (not inlined: the stack
+/// capture skips exactly record, check and the interposer)
+__attribute__((noinline))
+static void check(rt_violation_kind kind, const char *function) {
+    if (!__atomic_load_n(&g_active, __ATOMIC_ACQUIRE)) return;
+    uintptr_t word = scope_word();
+    if ((word & RT_SCOPE_DEPTH_MASK) == 0 || (word & RT_SCOPE_RECORDING)) return;
+
+    pthread_setspecific(g_scope_key, (void *)(word | RT_SCOPE_RECORDING));
+    record(kind, function);
+    pthread_setspecific(g_scope_key, (void *)word);
+}
+
+#if defined(__APPLE__)
+
+#pragma mark - Malloc Zone Hooks
+
+static malloc_zone_t g_zone_original;
+
+static void *zone_malloc(malloc_zone_t *zone, size_t size) {
+    check(RT_VIOLATION_ALLOCATION, "malloc");
+    return g_zone_original.malloc(zone, size);
+}
+
+static void *zone_calloc(malloc_zone_t *zone, size_t count, size_t size) {
+    check(RT_VIOLATION_ALLOCATION, "calloc");
+    return g_zone_original.calloc(zone, count, size);
+}
+
+static void *zone_valloc(malloc_zone_t *zone, size_t size) {
+    check(RT_VIOLATION_ALLOCATION, "valloc");
+    return g_zone_original.valloc(zone, size);
+}
+
+static void *zone_realloc(malloc_zone_t *zone, void *pointer, size_t size) {
+    check(RT_VIOLATION_ALLOCATION, "realloc");
+    return g_zone_original.realloc(zone, pointer, size);
+}
+
+static void *zone_memalign(malloc_zone_t *zone, size_t alignment, size_t size) {
+    check(RT_VIOLATION_ALLOCATION, "memalign");
+    return g_zone_original.memalign(zone, alignment, size);
+}
+
+static void zone_free(malloc_zone_t *zone, void *pointer) {
+    if (pointer) check(RT_VIOLATION_DEALLOCATION, "free");
+    g_zone_original.free(zone, pointer);
+}
+
+static void zone_free_definite_size(malloc_zone_t *zone, void *pointer, size_t size) {
+    if (pointer) check(RT_VIOLATION_DEALLOCATION, "free");
+    g_zone_original.free_definite_size(zone, pointer, size);
+}
+
+static int install_zone_hooks(void) {
+    malloc_zone_t *zone = malloc_default_zone();
+    if (zone == NULL) return RT_SANITIZER_ERR_ZONE;
+
+    // Zones are read-only after their first allocation
+    vm_address_t start = trunc_page((vm_address_t)zone);
+    vm_size_t length = round_page((vm_address_t)(zone + 1)) - start;
+    if (vm_protect(mach_task_self(), start, length, 0, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS) {
+        return RT_SANITIZER_ERR_ZONE;
+    }
+
+    g_zone_original = *zone;
+    zone->malloc = zone_malloc;
+    zone->calloc = zone_calloc;
+    zone->valloc = zone_valloc;
+    zone->realloc = zone_realloc;
+    zone->free = zone_free;
+    if (zone->version >= 5 && g_zone_original.memalign) zone->memalign = zone_memalign;
+    if (zone->version >= 6 && g_zone_original.free_definite_size) zone->free_definite_size = zone_free_definite_size;
+    // Version 15+ adds malloc_with_options and 16+ typed allocation entry
+    // points; reporting 14 makes libmalloc route those through the hooks above
+    if (zone->version > 14) zone->version = 14;
+
+    vm_protect(mach_task_self(), start, length, 0, VM_PROT_READ);
+    return RT_SANITIZER_OK;
+}
+
+#pragma mark - Symbol Interposers
+
+static int (*real_pthread_mutex_lock)(pthread_mutex_t *);
+static int (*real_pthread_rwlock_rdlock)(pthread_rwlock_t *);
+static int (*real_pthread_rwlock_wrlock)(pthread_rwlock_t *);
+static int (*real_pthread_cond_wait)(pthread_cond_t *, pthread_mutex_t *);
+static int (*real_pthread_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *);
+static void (*real_os_unfair_lock_lock)(os_unfair_lock_t);
+static void (*real_dispatch_sync)(dispatch_queue_t, dispatch_block_t);
+static long (*real_dispatch_semaphore_wait)(dispatch_semaphore_t, dispatch_time_t);
+static long (*real_dispatch_group_wait)(dispatch_group_t, dispatch_time_t);
+static int (*real_usleep)(useconds_t);
+static int (*real_nanosleep)(const struct timespec *, struct timespec *);
+static unsigned int (*real_sleep)(unsigned int);
+static ssize_t (*real_read)(int, void *, size_t);
+static ssize_t (*real_write)(int, const void *, size_t);
+static int (*real_open)(const char *, int, ...);
+static int (*real_close)(int);
+static int (*real_fsync)(int);
+
+static int hook_pthread_mutex_lock(pthread_mutex_t *mutex) {
+    check(RT_VIOLATION_LOCK, "pthread_mutex_lock");
+    return real_pthread_mutex_lock(mutex);
+}
+
+static int hook_pthread_rwlock_rdlock(pthread_rwlock_t *lock) {
+    check(RT_VIOLATION_LOCK, "pthread_rwlock_rdlock");
+    return real_pthread_rwlock_rdlock(lock);
+}
+
+static int hook_pthread_rwlock_wrlock(pthread_rwlock_t *lock) {
+    check(RT_VIOLATION_LOCK, "pthread_rwlock_wrlock");
+    return real_pthread_rwlock_wrlock(lock);
+}
+
+static int hook_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+    check(RT_VIOLATION_WAIT, "pthread_cond_wait");
+    return real_pthread_cond_wait(cond, mutex);
+}
+
+static int hook_pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline) {
+    check(RT_VIOLATION_WAIT, "pthread_cond_timedwait");
+    return real_pthread_cond_timedwait(cond, mutex, deadline);
+}
+
+static void hook_os_unfair_lock_lock(os_unfair_lock_t lock) {
+    check(RT_VIOLATION_LOCK, "os_unfair_lock_lock");
+    real_os_unfair_lock_lock(lock);
+}
+
+static void hook_dispatch_sync(dispatch_queue_t queue, dispatch_block_t block) {
+    check(RT_VIOLATION_WAIT, "dispatch_sync");
+    real_dispatch_sync(queue, block);
+}
+
+static long hook_dispatch_semaphore_wait(dispatch_semaphore_t semaphore, dispatch_time_t timeout) {
+    if (timeout != DISPATCH_TIME_NOW) check(RT_VIOLATION_WAIT, "dispatch_semaphore_wait");
+    return real_dispatch_semaphore_wait(semaphore, timeout);
+}
+
+static long hook_dispatch_group_wait(dispatch_group_t group, dispatch_time_t timeout) {
+    if (timeout != DISPATCH_TIME_NOW) check(RT_VIOLATION_WAIT, "dispatch_group_wait");
+    return real_dispatch_group_wait(group, timeout);
+}
+
+static int hook_usleep(useconds_t microseconds) {
+    check(RT_VIOLATION_SLEEP, "usleep");
+    return real_usleep(microseconds);
+}
+
+static int hook_nanosleep(const struct timespec *duration, struct timespec *remaining) {
+    check(RT_VIOLATION_SLEEP, "nanosleep");
+    return real_nanosleep(duration, remaining);
+}
+
+static unsigned int hook_sleep(unsigned int seconds) {
+    check(RT_VIOLATION_SLEEP, "sleep");
+    return real_sleep(seconds);
+}
+
+static ssize_t hook_read(int fd, void *buffer, size_t length) {
+    check(RT_VIOLATION_IO, "read");
+    return real_read(fd, buffer, length);
+}
+
+static ssize_t hook_write(int fd, const void *buffer, size_t length) {
+    check(RT_VIOLATION_IO, "write");
+    return real_write(fd, buffer, length);
+}
+
+static int hook_open(const char *path, int flags, ...) {
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list arguments;
+        va_start(arguments, flags);
+        mode = (mode_t)va_arg(arguments, int);
+        va_end(arguments);
+    }
+    check(RT_VIOLATION_IO, "open");
+    return real_open(path, flags, mode);
+}
+
+static int hook_close(int fd) {
+    check(RT_VIOLATION_IO, "close");
+    return real_close(fd);
+}
+
+static int hook_fsync(int fd) {
+    check(RT_VIOLATION_IO, "fsync");
+    return real_fsync(fd);
+}
+
+typedef struct {
+    const char *name;                ///< Without the leading underscore
+    void *replacement;
+    void **original;
+} rt_symbol_hook;
+
+#define RT_HOOK(symbol) { #symbol, (void *)hook_##symbol, (void **)&real_##symbol }
+
+static rt_symbol_hook g_symbol_hooks[] = {
+    RT_HOOK(pthread_mutex_lock),
+    RT_HOOK(pthread_rwlock_rdlock),
+    RT_HOOK(pthread_rwlock_wrlock),
+    RT_HOOK(pthread_cond_wait),
+    RT_HOOK(pthread_cond_timedwait),
+    RT_HOOK(os_unfair_lock_lock),
+    RT_HOOK(dispatch_sync),
+    RT_HOOK(dispatch_semaphore_wait),
+    RT_HOOK(dispatch_group_wait),
+    RT_HOOK(usleep),
+    RT_HOOK(nanosleep),
+    RT_HOOK(sleep),
+    RT_HOOK(read),
+    RT_HOOK(write),
+    RT_HOOK(open),
+    RT_HOOK(close),
+    RT_HOOK(fsync),
+};
+
+#define RT_SYMBOL_HOOK_COUNT (sizeof(g_symbol_hooks) / sizeof(g_symbol_hooks[0]))
+
+#pragma mark - Symbol Rebinding
+
+/// Point every symbol pointer in one section at its interposer
+static void rebind_section(const struct section_64 *section, intptr_t slide, const struct nlist_64 *symbols,
+                           const char *strings, const uint32_t *indirect_symbols) {
+    const uint32_t *indices = indirect_symbols + section->reserved1;
+    void **pointers = (void **)((uintptr_t)slide + section->addr);
+    size_t count = section->size / sizeof(void *);
+    int writable = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index = indices[i];
+        if (index & (INDIRECT_SYMBOL_ABS | INDIRECT_SYMBOL_LOCAL)) continue;
+        const char *name = strings + symbols[index].n_un.n_strx;
+        if (name[0] != '_') continue;
+
+        for (size_t h = 0; h < RT_SYMBOL_HOOK_COUNT; h++) {
+            if (strcmp(name + 1, g_symbol_hooks[h].name) != 0) continue;
+            if (*g_symbol_hooks[h].original == NULL) break;   // Unresolved: leave the call alone
+            if (!writable) {
+                // __DATA_CONST is read-only once dyld has bound it
+                vm_address_t start = trunc_page((vm_address_t)pointers);
+                vm_size_t length = round_page((vm_address_t)(pointers + count)) - start;
+                if (vm_protect(mach_task_self(), start, length, 0,
+                               VM_PROT_READ | VM_PROT_WRITE | VM_PROT_COPY) != KERN_SUCCESS) {
+                    return;
+                }
+                writable = 1;
+            }
+            pointers[i] = g_symbol_hooks[h].replacement;
+            g_hooked_symbols++;
+            break;
+        }
+    }
+}
+
+/// Rebind the main executable's lazy and non-lazy symbol pointers
+/// (system images are left alone: their pointers may be signed or shared)
+static void rebind_main_image(void) {
+    const struct mach_header_64 *header = (const struct mach_header_64 *)_dyld_get_image_header(0);
+    intptr_t slide = _dyld_get_image_vmaddr_slide(0);
+    if (header == NULL || header->magic != MH_MAGIC_64) return;
+
+    const struct segment_command_64 *linkedit = NULL;
+    const struct symtab_command *symtab = NULL;
+    const struct dysymtab_command *dysymtab = NULL;
+
+    uintptr_t cursor = (uintptr_t)(header + 1);
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        const struct load_command *command = (const struct load_command *)cursor;
+        if (command->cmd == LC_SEGMENT_64 &&
+            strcmp(((const struct segment_command_64 *)command)->segname, SEG_LINKEDIT) == 0) {
+            linkedit = (const struct segment_command_64 *)command;
+        } else if (command->cmd == LC_SYMTAB) {
+            symtab = (const struct symtab_command *)command;
+        } else if (command->cmd == LC_DYSYMTAB) {
+            dysymtab = (const struct dysymtab_command *)command;
+        }
+        cursor += command->cmdsize;
+    }
+    if (!linkedit || !symtab || !dysymtab || dysymtab->nindirectsyms == 0) return;
+
+    uintptr_t linkedit_base = (uintptr_t)slide + linkedit->vmaddr - linkedit->fileoff;
+    const struct nlist_64 *symbols = (const struct nlist_64 *)(linkedit_base + symtab->symoff);
+    const char *strings = (const char *)(linkedit_base + symtab->stroff);
+    const uint32_t *indirect_symbols = (const uint32_t *)(linkedit_base + dysymtab->indirectsymoff);
+
+    cursor = (uintptr_t)(header + 1);
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        const struct load_command *command = (const struct load_command *)cursor;
+        cursor += command->cmdsize;
+        if (command->cmd != LC_SEGMENT_64) continue;
+
+        const struct segment_command_64 *segment = (const struct segment_command_64 *)command;
+        if (strcmp(segment->segname, SEG_DATA) != 0 && strcmp(segment->segname, "__DATA_CONST") != 0) continue;
+
+        const struct section_64 *sections = (const struct section_64 *)(segment + 1);
+        for (uint32_t s = 0; s < segment->nsects; s++) {
+            uint32_t type = sections[s].flags & SECTION_TYPE;
+            if (type == S_LAZY_SYMBOL_POINTERS || type == S_NON_LAZY_SYMBOL_POINTERS) {
+                rebind_section(&sections[s], slide, symbols, strings, indirect_symbols);
+            }
+        }
+    }
+}
+
+#pragma mark - Objective-C Locks
+
+static IMP g_nslock_lock;
+static IMP g_nsrecursivelock_lock;
+static IMP g_nscondition_lock;
+static IMP g_nscondition_wait;
+
+static void hook_nslock_lock(id self, SEL selector) {
+    check(RT_VIOLATION_LOCK, "-[NSLock lock]");
+    ((void (*)(id, SEL))g_nslock_lock)(self, selector);
+}
+
+static void hook_nsrecursivelock_lock(id self, SEL selector) {
+    check(RT_VIOLATION_LOCK, "-[NSRecursiveLock lock]");
+    ((void (*)(id, SEL))g_nsrecursivelock_lock)(self, selector);
+}
+
+static void hook_nscondition_lock(id self, SEL selector) {
+    check(RT_VIOLATION_LOCK, "-[NSCondition lock]");
+    ((void (*)(id, SEL))g_nscondition_lock)(self, selector);
+}
+
+static void hook_nscondition_wait(id self, SEL selector) {
+    check(RT_VIOLATION_WAIT, "-[NSCondition wait]");
+    ((void (*)(id, SEL))g_nscondition_wait)(self, selector);
+}
+
+static void swizzle(const char *class_name, const char *selector_name, IMP replacement, IMP *original) {
+    Class cls = objc_getClass(class_name);
+    Method method = cls ? class_getInstanceMethod(cls, sel_registerName(selector_name)) : NULL;
+    if (method) *original = method_setImplementation(method, replacement);
+}
+
+static void install_objc_hooks(void) {
+    swizzle("NSLock", "lock", (IMP)hook_nslock_lock, &g_nslock_lock);
+    swizzle("NSRecursiveLock", "lock", (IMP)hook_nsrecursivelock_lock, &g_nsrecursivelock_lock);
+    swizzle("NSCondition", "lock", (IMP)hook_nscondition_lock, &g_nscondition_lock);
+    swizzle("NSCondition", "wait", (IMP)hook_nscondition_wait, &g_nscondition_wait);
+}
+
+#endif /* __APPLE__ */
+
+#pragma mark - Install
+
+static void install_once(void) {
+    if (pthread_key_create(&g_scope_key, NULL) != 0) {
+        g_install_result = RT_SANITIZER_ERR_DISABLED;
+        return;
+    }
+
+    // backtrace() may load its unwinder on first use; do it off the audio thread
+    void *warmup[4];
+    backtrace(warmup, 4);
+
+#if defined(__APPLE__)
+    for (size_t h = 0; h < RT_SYMBOL_HOOK_COUNT; h++) {
+        *g_symbol_hooks[h].original = dlsym(RTLD_DEFAULT, g_symbol_hooks[h].name);
+    }
+    rebind_main_image();
+    install_objc_hooks();
+    g_install_result = install_zone_hooks();
+#endif
+
+    __atomic_store_n(&g_active, 1, __ATOMIC_RELEASE);
+}
+
+int rt_sanitizer_install(void) {
+    pthread_once(&g_install_once, install_once);
+    return g_install_result;
+}
+
+int rt_sanitizer_is_active(void) {
+    return (int)__atomic_load_n(&g_active, __ATOMIC_ACQUIRE);
+}
+
+uint32_t rt_sanitizer_hooked_symbols(void) {
+    return g_hooked_symbols;
+}
+
+#pragma mark - Real-Time Scopes
+
+void rt_sanitizer_enter(void) {
+    if (!__atomic_load_n(&g_active, __ATOMIC_ACQUIRE)) return;
+    pthread_setspecific(g_scope_key, (void *)(scope_word() + 1));
+}
+
+void rt_sanitizer_leave(void) {
+    if (!__atomic_load_n(&g_active, __ATOMIC_ACQUIRE)) return;
+    uintptr_t word = scope_word();
+    if ((word & RT_SCOPE_DEPTH_MASK) > 0) {
+        pthread_setspecific(g_scope_key, (void *)(word - 1));
+    }
+}
+
+int rt_sanitizer_in_realtime(void) {
+    if (!__atomic_load_n(&g_active, __ATOMIC_ACQUIRE)) return 0;
+    return (scope_word() & RT_SCOPE_DEPTH_MASK) > 0;
+}
+
+void rt_sanitizer_report(rt_violation_kind kind, const char *function) {
+    if (kind >= RT_VIOLATION_KIND_COUNT) kind = RT_VIOLATION_REPORTED;
+    check(kind, function);
+}
+
+#pragma mark - Results
+
+uint64_t rt_sanitizer_violation_count(void) {
+    return __atomic_load_n(&g_next_sequence, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&g_reset_sequence, __ATOMIC_ACQUIRE);
+}
+
+uint64_t rt_sanitizer_kind_count(rt_violation_kind kind) {
+    if (kind >= RT_VIOLATION_KIND_COUNT) return 0;
+    return __atomic_load_n(&g_kind_counts[kind], __ATOMIC_RELAXED);
+}
+
+uint32_t rt_sanitizer_copy_violations(rt_violation *violations, uint32_t capacity) {
+    uint64_t end = __atomic_load_n(&g_next_sequence, __ATOMIC_ACQUIRE);
+    uint64_t start = __atomic_load_n(&g_reset_sequence, __ATOMIC_ACQUIRE);
+    if (end - start > RT_SANITIZER_LOG_CAPACITY) start = end - RT_SANITIZER_LOG_CAPACITY;
+    if (end - start > capacity) start = end - capacity;
+
+    uint32_t copied = 0;
+    for (uint64_t sequence = start; sequence < end; sequence++) {
+        const rt_log_slot *slot = &g_log[sequence & (RT_SANITIZER_LOG_CAPACITY - 1)];
+        if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != 2 * sequence + 2) continue;
+        rt_violation copy = slot->violation;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        // Overwritten (or still being written) while copying
+        if (__atomic_load_n(&slot->state, __ATOMIC_RELAXED) != 2 * sequence + 2) continue;
+        violations[copied++] = copy;
+    }
+    return copied;
+}
+
+uint32_t rt_sanitizer_stack(uint32_t stack_id, void **frames, uint32_t capacity) {
+    if (stack_id == 0 || stack_id > RT_SANITIZER_STACK_SLOTS) return 0;
+    const rt_stack_slot *slot = &g_stacks[stack_id - 1];
+    if (!__atomic_load_n(&slot->ready, __ATOMIC_ACQUIRE)) return 0;
+    uint32_t depth = slot->depth < capacity ? slot->depth : capacity;
+    memcpy(frames, slot->frames, depth * sizeof(void *));
+    return depth;
+}
+
+void rt_sanitizer_reset(void) {
+    __atomic_store_n(&g_reset_sequence, __atomic_load_n(&g_next_sequence, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    for (int kind = 0; kind < RT_VIOLATION_KIND_COUNT; kind++) {
+        __atomic_store_n(&g_kind_counts[kind], 0, __ATOMIC_RELAXED);
+    }
+}
+
+#else /* !RT_SANITIZER */
+
+int rt_sanitizer_install(void) { return RT_SANITIZER_ERR_DISABLED; }
+int rt_sanitizer_is_active(void) { return 0; }
+uint32_t rt_sanitizer_hooked_symbols(void) { return 0; }
+void rt_sanitizer_enter(void) {}
+void rt_sanitizer_leave(void) {}
+int rt_sanitizer_in_realtime(void) { return 0; }
+void rt_sanitizer_report(rt_violation_kind kind, const char *function) { (void)kind; (void)function; }
+uint64_t rt_sanitizer_violation_count(void) { return 0; }
+uint64_t rt_sanitizer_kind_count(rt_violation_kind kind) { (void)kind; return 0; }
+uint32_t rt_sanitizer_copy_violations(rt_violation *violations, uint32_t capacity) {
+    (void)violations; (void)capacity;
+    return 0;
+}
+uint32_t rt_sanitizer_stack(uint32_t stack_id, void **frames, uint32_t capacity) {
+    (void)stack_id; (void)frames; (void)capacity;
+    return 0;
+}
+void rt_sanitizer_reset(void) {}
+
+#endif /* RT_SANITIZER */
+
+const char *rt_sanitizer_kind_name(rt_violation_kind kind) {
+    switch (kind) {
+        case RT_VIOLATION_ALLOCATION:   return "allocation";
+        case RT_VIOLATION_DEALLOCATION: return "deallocation";
+        case RT_VIOLATION_LOCK:         return "lock";
+        case RT_VIOLATION_WAIT:         return "wait";
+        case RT_VIOLATION_SLEEP:        return "sleep";
+        case RT_VIOLATION_IO:           return "io";
+        case RT_VIOLATION_REPORTED:     return "reported";
+        default:                        return "unknown";
+    }
+}
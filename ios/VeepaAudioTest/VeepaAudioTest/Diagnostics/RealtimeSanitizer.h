@@ -0,0 +1,120 @@
+//
+//  RealtimeSanitizer.h
+//  VeepaAudioTest
+//
+//  Created for real-time safety checks
+//  Purpose: Flag allocations, locks, sleeps and blocking I/O made on
+//           real-time audio threads
+//
+//  Real-time code (render callbacks) brackets itself with
+//  rt_sanitizer_enter/leave. Once installed, the sanitizer interposes:
+//    - malloc/calloc/realloc/valloc/memalign/free on the default malloc zone
+//      (catches C, Objective-C, Swift and NSLog allocations from any image)
+//    - pthread mutex/rwlock/cond, os_unfair_lock_lock, dispatch_sync and
+//      semaphore/group waits, sleeps and read/write/open/close/fsync, by
+//      rebinding the main executable's symbol pointers (calls made from
+//      inside system frameworks are only seen through their allocations)
+//    - -[NSLock lock], -[NSRecursiveLock lock], -[NSCondition lock/wait]
+//  A call from a tagged thread is recorded as a violation: which function,
+//  which thread, when, and a stack ID. Stacks are interned in a fixed table
+//  so repeated violations from the same place share one ID.
+//
+//  Recording is lock-free and allocation-free: a fetch-add picks a slot in
+//  a fixed ring (seqlock per slot, like SharedAudioRing), the stack table
+//  claims entries with a CAS. Reading the log never blocks the recorder.
+//
+//  Only builds with RT_SANITIZER=1 (the app's Debug configuration) install
+//  hooks; elsewhere every entry point is a cheap no-op and
+//  rt_sanitizer_install returns RT_SANITIZER_ERR_DISABLED.
+//
+
+#ifndef RealtimeSanitizer_h
+#define RealtimeSanitizer_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Violations held in the log (the oldest are overwritten)
+#define RT_SANITIZER_LOG_CAPACITY   1024
+/// Distinct violating stacks remembered
+#define RT_SANITIZER_STACK_SLOTS    256
+/// Return addresses kept per stack
+#define RT_SANITIZER_STACK_DEPTH    24
+
+typedef enum {
+    RT_VIOLATION_ALLOCATION = 0,     ///< malloc family
+    RT_VIOLATION_DEALLOCATION,       ///< free
+    RT_VIOLATION_LOCK,               ///< Blocking lock acquisition
+    RT_VIOLATION_WAIT,               ///< Condition, semaphore, group or dispatch_sync wait
+    RT_VIOLATION_SLEEP,
+    RT_VIOLATION_IO,                 ///< File descriptor system calls
+    RT_VIOLATION_REPORTED,           ///< rt_sanitizer_report from instrumented code
+    RT_VIOLATION_KIND_COUNT
+} rt_violation_kind;
+
+typedef struct {
+    uint64_t sequence;               ///< Position in the log since install
+    uint64_t time_ns;                ///< CLOCK_MONOTONIC
+    uint64_t thread_id;
+    const char *function;            ///< Interposed function (static string)
+    uint32_t kind;                   ///< rt_violation_kind
+    uint32_t stack_id;               ///< rt_sanitizer_stack; 0 if the table was full
+} rt_violation;
+
+/// Error codes (negative return values)
+enum {
+    RT_SANITIZER_OK             = 0,
+    RT_SANITIZER_ERR_DISABLED   = -1,  ///< Built without RT_SANITIZER
+    RT_SANITIZER_ERR_ZONE       = -2,  ///< Could not hook the malloc zone (other hooks still active)
+};
+
+/// Install the hooks (idempotent). Call early, from a non-real-time thread.
+int rt_sanitizer_install(void);
+
+/// 1 when built with RT_SANITIZER and installed
+int rt_sanitizer_is_active(void);
+
+/// Symbol pointers rebound in the main executable
+uint32_t rt_sanitizer_hooked_symbols(void);
+
+#pragma mark - Real-Time Scopes
+
+/// Tag the calling thread as real-time until the matching leave (nests)
+void rt_sanitizer_enter(void);
+void rt_sanitizer_leave(void);
+
+/// 1 if the calling thread is inside a real-time scope
+int rt_sanitizer_in_realtime(void);
+
+/// Record a violation for code that knows it is unsafe (no-op outside real-time scopes)
+void rt_sanitizer_report(rt_violation_kind kind, const char *function);
+
+#pragma mark - Results
+
+/// Violations recorded since install or the last reset
+uint64_t rt_sanitizer_violation_count(void);
+
+/// Violations of one kind since install or the last reset
+uint64_t rt_sanitizer_kind_count(rt_violation_kind kind);
+
+/// Copy the most recent violations since the last reset, oldest first
+/// @return Violations copied
+uint32_t rt_sanitizer_copy_violations(rt_violation *violations, uint32_t capacity);
+
+/// Return addresses of an interned stack (innermost first)
+/// @return Frames copied, 0 for an unknown ID
+uint32_t rt_sanitizer_stack(uint32_t stack_id, void **frames, uint32_t capacity);
+
+/// Start counting afresh (stacks stay interned)
+void rt_sanitizer_reset(void);
+
+const char *rt_sanitizer_kind_name(rt_violation_kind kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RealtimeSanitizer_h */
@@ -0,0 +1,111 @@
+//
+//  RealtimeSanitizer.swift
+//  VeepaAudioTest
+//
+//  Created for real-time safety checks
+//  Purpose: Swift access to the real-time safety sanitizer - install it,
+//           tag real-time work, and read back symbolized violations
+//
+//  The interposers and the lock-free log live in RealtimeSanitizer.c. Render
+//  callbacks tag themselves with rt_sanitizer_enter/leave directly; tests and
+//  benchmarks use `realtime { }` around the work that must stay real-time
+//  safe and fail when `violationCount` moves (see RealtimeSafeTestCase).
+//
+
+import Foundation
+
+enum RealtimeSanitizer {
+
+    /// One recorded call from a real-time thread
+    struct Violation {
+        let kind: String
+        let function: String
+        let threadID: UInt64
+        let timeNanoseconds: UInt64
+        let stackID: UInt32
+    }
+
+    /// Whether this build interposes anything (Debug builds, RT_SANITIZER=1)
+    static var isActive: Bool {
+        rt_sanitizer_is_active() != 0
+    }
+
+    /// Install the hooks; false in builds without the sanitizer
+    @discardableResult
+    static func install() -> Bool {
+        let result = rt_sanitizer_install()
+        switch result {
+        case Int32(RT_SANITIZER_OK):
+            print("[RealtimeSanitizer] 🛡️ Active (\(rt_sanitizer_hooked_symbols()) symbol pointers rebound)")
+        case Int32(RT_SANITIZER_ERR_ZONE):
+            print("[RealtimeSanitizer] ⚠️ Active without malloc zone hooks - allocations are not checked")
+        default:
+            return false
+        }
+        return true
+    }
+
+    /// Run `body` as real-time work: anything it allocates, locks or blocks on is a violation
+    static func realtime<T>(_ body: () throws -> T) rethrows -> T {
+        rt_sanitizer_enter()
+        defer { rt_sanitizer_leave() }
+        return try body()
+    }
+
+    // MARK: - Results
+
+    /// Violations since install or the last `reset()`
+    static var violationCount: UInt64 {
+        rt_sanitizer_violation_count()
+    }
+
+    static func reset() {
+        rt_sanitizer_reset()
+    }
+
+    /// The most recent violations, oldest first
+    static func violations(limit: Int = Int(RT_SANITIZER_LOG_CAPACITY)) -> [Violation] {
+        var records = [rt_violation](repeating: rt_violation(), count: limit)
+        let count = Int(rt_sanitizer_copy_violations(&records, UInt32(limit)))
+        return records.prefix(count).map { record in
+            Violation(kind: String(cString: rt_sanitizer_kind_name(rt_violation_kind(record.kind))),
+                      function: record.function.map { String(cString: $0) } ?? "?",
+                      threadID: record.thread_id,
+                      timeNanoseconds: record.time_ns,
+                      stackID: record.stack_id)
+        }
+    }
+
+    /// Symbolized frames of an interned stack, innermost first
+    static func stack(_ stackID: UInt32) -> [String] {
+        var frames = [UnsafeMutableRawPointer?](repeating: nil, count: Int(RT_SANITIZER_STACK_DEPTH))
+        let depth = Int(rt_sanitizer_stack(stackID, &frames, UInt32(frames.count)))
+        return frames.prefix(depth).map { address in
+            var info = Dl_info()
+            guard let address, dladdr(address, &info) != 0, let name = info.dli_sname else {
+                return String(describing: address)
+            }
+            return String(cString: name)
+        }
+    }
+
+    /// Violations grouped by call site, most frequent first, with one stack each
+    static func report() -> String {
+        let recent = violations()
+        guard !recent.isEmpty else { return "No real-time violations" }
+
+        var sites: [UInt32: (violation: Violation, count: Int)] = [:]
+        for violation in recent {
+            sites[violation.stackID, default: (violation, 0)].count += 1
+        }
+
+        var lines = ["\(violationCount) real-time violation(s):"]
+        for (stackID, site) in sites.sorted(by: { $0.value.count > $1.value.count }) {
+            lines.append("  \(site.count)× \(site.violation.kind) in \(site.violation.function) (stack \(stackID))")
+            for frame in stack(stackID).prefix(8) {
+                lines.append("      \(frame)")
+            }
+        }
+        return lines.joined(separator: "\n")
+    }
+}
@@ -0,0 +1,123 @@
+//
+//  StartupBenchmark.swift
+//  VeepaAudioTest
+//
+//  Created for time-to-first-audio work
+//  Purpose: Reproducible cold/warm time-to-first-audio measurement that runs
+//           headless (unit tests, simulator) with CameraEmulator as the camera
+//
+//  The run follows the app's own start sequence - bring-up warm-up steps,
+//  AudioBridgeEngine start, G.711a decode in AudioHookBridge, ring buffer,
+//  render - so only the P2P network leg is replaced by the emulator.
+//
+
+import Foundation
+
+/// Drives one time-to-first-audio measurement end to end
+@MainActor
+enum StartupBenchmark {
+
+    enum BenchmarkError: Error, LocalizedError {
+        case timedOut(TimeInterval)
+
+        var errorDescription: String? {
+            switch self {
+            case .timedOut(let timeout):
+                return "No non-silent audio rendered within \(timeout) s"
+            }
+        }
+    }
+
+    /// Thread-safe slot for the result delivered on the render thread
+    private final class ResultSlot {
+        private let lock = NSLock()
+        private var value: StartupTrace.Result?
+
+        func set(_ result: StartupTrace.Result) {
+            lock.lock()
+            value = result
+            lock.unlock()
+        }
+
+        func get() -> StartupTrace.Result? {
+            lock.lock()
+            defer { lock.unlock() }
+            return value
+        }
+    }
+
+    /// Run one measurement
+    /// - Parameters:
+    ///   - kind: `.cold` tears the audio graph down first; `.warm` prewarms it
+    ///   - configuration: Emulated camera stream
+    ///   - timeout: Give up if no audible sample is rendered in this time
+    /// - Returns: Milestones, phases and the path of the exported trace
+    static func run(
+        _ kind: StartupTrace.StartKind,
+        emulator configuration: CameraEmulator.Configuration = CameraEmulator.Configuration(),
+        timeout: TimeInterval = 5.0
+    ) async throws -> StartupTrace.Result {
+        let engine = AudioBridgeEngine.shared
+        let bridge = AudioHookBridge.shared
+        let trace = StartupTrace.shared
+
+        // Establish the starting condition
+        engine.reset()
+        bridge.stopVoiceFrameCapture()  // Also frees the decode buffer
+        if kind == .warm {
+            try engine.prewarm()
+            bridge.preallocateDecodeBuffers(4096)
+        }
+
+        let emulator = CameraEmulator(configuration: configuration)
+        emulator.feedHookBridge()
+
+        let previousCallback = bridge.captureCallback
+        bridge.captureCallback = { samples, count in
+            AudioBridgeEngine.shared.pushSamples(samples, count: Int(count))
+        }
+
+        let slot = ResultSlot()
+        trace.onComplete = { result in slot.set(result) }
+
+        defer {
+            emulator.stop()
+            trace.onComplete = nil
+            bridge.captureCallback = previousCallback
+            engine.stop()
+        }
+
+        // connect requested
+        trace.begin(kind)
+
+        let report = try await BringUpOrchestrator().run([
+            BringUpStep(.audioEngine, critical: false) { @MainActor in
+                try AudioBridgeEngine.shared.prewarm()
+            },
+            BringUpStep(.decoderBuffers, critical: false) {
+                AudioHookBridge.shared.preallocateDecodeBuffers(4096)
+            },
+            BringUpStep(.sdkSymbols, critical: false) {
+                AudioHookBridge.shared.resolveSDKSymbols()
+            }
+        ])
+        trace.record(report)
+        trace.mark(.p2pConnected)
+
+        // startVoice → camera starts sending
+        trace.mark(.startVoiceRequested)
+        try engine.start()
+        emulator.start()
+
+        let deadline = StartupTrace.now() + UInt64(timeout * 1_000_000_000)
+        while slot.get() == nil {
+            if StartupTrace.now() > deadline {
+                trace.finish(export: false)
+                throw BenchmarkError.timedOut(timeout)
+            }
+            try await Task.sleep(nanoseconds: 2_000_000)  // 2ms
+        }
+
+        return slot.get()!
+    }
+}
@@ -0,0 +1,223 @@
+//
+//  StartupTrace.swift
+//  VeepaAudioTest
+//
+//  Created for time-to-first-audio work
+//  Purpose: Measure "connect requested" → "first non-silent sample rendered",
+//           broken down by phase, and export it as a Chrome/Perfetto trace
+//
+//  Milestones are recorded once per start (the first occurrence wins), so the
+//  hooks in the capture and render paths cost one flag check after the first
+//  hit. Bring-up steps from ConnectionBringUp are added as spans.
+//
+
+import Foundation
+
+/// Records and exports the time-to-first-audio of one connection start
+final class StartupTrace {
+
+    // MARK: - Singleton
+
+    static let shared = StartupTrace()
+
+    // MARK: - Types
+
+    /// Cold: Flutter engine and audio graph not yet up. Warm: both already live.
+    enum StartKind: String {
+        case cold
+        case warm
+    }
+
+    /// Points on the way from tap to audible audio, in pipeline order
+    enum Milestone: String, CaseIterable {
+        case connectRequested
+        case p2pConnected
+        case startVoiceRequested
+        case firstSamplesBuffered
+        case firstNonSilentRender
+    }
+
+    /// One measured phase between two milestones
+    struct Phase {
+        let name: String
+        let from: Milestone
+        let to: Milestone
+    }
+
+    /// The phases reported in every result (consecutive milestone pairs)
+    static let phases: [Phase] = [
+        Phase(name: "bringUp", from: .connectRequested, to: .p2pConnected),
+        Phase(name: "audioRequest", from: .p2pConnected, to: .startVoiceRequested),
+        Phase(name: "firstFrame", from: .startVoiceRequested, to: .firstSamplesBuffered),
+        Phase(name: "playout", from: .firstSamplesBuffered, to: .firstNonSilentRender)
+    ]
+
+    /// Finished measurement
+    struct Result {
+        let kind: StartKind
+        let milestones: [Milestone: UInt64]
+        let bringUp: BringUpReport?
+        let traceURL: URL?
+
+        /// Seconds from connect requested to first non-silent render
+        var timeToFirstAudio: TimeInterval? {
+            interval(from: .connectRequested, to: .firstNonSilentRender)
+        }
+
+        func interval(from start: Milestone, to end: Milestone) -> TimeInterval? {
+            guard let a = milestones[start], let b = milestones[end], b >= a else { return nil }
+            return TimeInterval(b - a) / 1_000_000_000
+        }
+
+        var description: String {
+            var lines = ["Time-to-first-audio (\(kind.rawValue)): \(Self.ms(timeToFirstAudio))"]
+            for phase in StartupTrace.phases {
+                lines.append("  \(phase.name): \(Self.ms(interval(from: phase.from, to: phase.to)))")
+            }
+            if let traceURL = traceURL {
+                lines.append("  trace: \(traceURL.path)")
+            }
+            return lines.joined(separator: "\n")
+        }
+
+        private static func ms(_ interval: TimeInterval?) -> String {
+            guard let interval = interval else { return "n/a" }
+            return String(format: "%.1f ms", interval * 1000)
+        }
+    }
+
+    // MARK: - State
+
+    private let lock = NSLock()
+    private var kind: StartKind = .cold
+    private var milestones: [Milestone: UInt64] = [:]
+    private var bringUp: BringUpReport?
+    private var isActive = false
+
+    /// Called once when the first non-silent sample has been rendered
+    /// (on the thread that recorded it)
+    var onComplete: ((Result) -> Void)?
+
+    /// Directory trace files are written to
+    let traceDirectory: URL = FileManager.default
+        .urls(for: .cachesDirectory, in: .userDomainMask)[0]
+        .appendingPathComponent("StartupTraces", isDirectory: true)
+
+    private init() {}
+
+    // MARK: - Recording
+
+    /// Start a new measurement; "connect requested" is now
+    func begin(_ kind: StartKind) {
+        lock.lock()
+        self.kind = kind
+        milestones = [.connectRequested: Self.now()]
+        bringUp = nil
+        isActive = true
+        lock.unlock()
+
+        print("[StartupTrace] ⏱️ Started \(kind.rawValue) measurement")
+    }
+
+    /// Record a milestone (ignored if already recorded or no measurement is active)
+    /// - Parameters:
+    ///   - milestone: The milestone reached
+    ///   - nanoseconds: Uptime of the event; defaults to now
+    func mark(_ milestone: Milestone, at nanoseconds: UInt64 = StartupTrace.now()) {
+        lock.lock()
+        guard isActive, milestones[milestone] == nil else {
+            lock.unlock()
+            return
+        }
+        milestones[milestone] = nanoseconds
+        let completed = milestone == .firstNonSilentRender
+        lock.unlock()
+
+        if completed, let result = finish() {
+            print("[StartupTrace] \(result.description)")
+            onComplete?(result)
+        }
+    }
+
+    /// Attach the bring-up step timings of this start
+    func record(_ report: BringUpReport) {
+        lock.lock()
+        if isActive { bringUp = report }
+        lock.unlock()
+    }
+
+    /// End the measurement, write the trace file and return the result
+    /// - Parameter export: Write a Chrome JSON trace to `traceDirectory`
+    @discardableResult
+    func finish(export: Bool = true) -> Result? {
+        lock.lock()
+        guard isActive else {
+            lock.unlock()
+            return nil
+        }
+        isActive = false
+        let kind = self.kind
+        let milestones = self.milestones
+        let bringUp = self.bringUp
+        lock.unlock()
+
+        var traceURL: URL?
+        if export {
+            let url = traceDirectory.appendingPathComponent(
+                "ttfa-\(kind.rawValue)-\(Int(Date().timeIntervalSince1970)).json"
+            )
+            do {
+                try makeTrace(kind: kind, milestones: milestones, bringUp: bringUp).write(to: url)
+                traceURL = url
+            } catch {
+                print("[StartupTrace] ⚠️ Failed to write trace: \(error)")
+            }
+        }
+
+        return Result(kind: kind, milestones: milestones, bringUp: bringUp, traceURL: traceURL)
+    }
+
+    // MARK: - Trace Export
+
+    private func makeTrace(kind: StartKind, milestones: [Milestone: UInt64], bringUp: BringUpReport?) -> ChromeTraceWriter {
+        let origin = milestones[.connectRequested] ?? Self.now()
+        var writer = ChromeTraceWriter(originNanoseconds: origin)
+
+        writer.nameThread(1, "Startup (\(kind.rawValue))")
+        for milestone in Milestone.allCases {
+            if let at = milestones[milestone] {
+                writer.addInstant(milestone.rawValue, category: "milestone", atNanoseconds: at)
+            }
+        }
+        for phase in Self.phases {
+            if let start = milestones[phase.from], let end = milestones[phase.to], end >= start {
+                writer.addSpan(phase.name, category: "phase", startNanoseconds: start, durationNanoseconds: end - start)
+            }
+        }
+
+        // One track per bring-up step - they overlap, so they cannot share a thread
+        if let bringUp = bringUp {
+            for (index, timing) in bringUp.timings.enumerated() {
+                let threadID = 10 + index
+                writer.nameThread(threadID, "bringUp.\(timing.id.rawValue)")
+                writer.addSpan(
+                    timing.id.rawValue,
+                    category: "bringUp",
+                    startNanoseconds: bringUp.startNanoseconds + UInt64(timing.startOffset * 1_000_000_000),
+                    durationNanoseconds: UInt64(timing.duration * 1_000_000_000),
+                    threadID: threadID,
+                    args: ["succeeded": timing.succeeded]
+                )
+            }
+        }
+
+        return writer
+    }
+
+    // MARK: - Clock
+
+    /// Monotonic uptime in nanoseconds (same clock as AudioTimeStamp.mHostTime)
+    static func now() -> UInt64 {
+        DispatchTime.now().uptimeNanoseconds
+    }
+}
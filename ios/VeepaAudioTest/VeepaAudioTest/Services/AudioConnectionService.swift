@@ -1,8 +1,9 @@
 // ADAPTED FROM: SciSymbioLens service architecture patterns
 // Changes: Adapted to work with VeepaConnectionBridge from Sub-Story 2.6
+//   - Connection bring-up runs as a concurrent dependency graph (ConnectionBringUp.swift)
 //   - Uses P2PCredentials struct instead of separate uid/serviceParam
 //   - Maps VeepaConnectionState to ConnectionState
-//   - Removed clientPtr tracking (not exposed by bridge)
+//   - clientPtr is read through from the bridge
 //   - Added debug logging for UI display
 //
 import Foundation
@@ -14,6 +15,12 @@ final class AudioConnectionService: ObservableObject {
     @Published var connectionState: ConnectionState = .disconnected
     @Published var debugLogs: [String] = []
 
+    /// Per-step timings of the most recent connection bring-up
+    @Published private(set) var lastBringUpReport: BringUpReport?
+
+    /// SDK client handle of the current connection
+    var clientPtr: Int? { connectionBridge.clientPtr }
+
     // MARK: - Connection State
 
     enum ConnectionState {
@@ -62,46 +69,19 @@ final class AudioConnectionService: ObservableObject {
         log("🔌 Connecting to camera...")
         log("   UID: \(uid)")
 
-        connectionState = .connecting
-
-        do {
-            // Initialize Flutter if needed
-            if !flutterEngine.isFlutterReady {
-                log("   Initializing Flutter engine...")
-                try await flutterEngine.initializeAndWaitForReady(timeout: 10.0)
-                log("   ✅ Flutter ready")
-            }
-
-            // Step 1: Get credentials (from cache or cloud)
-            log("   Fetching P2P credentials...")
-            let credentials = await getOrFetchCredentials(uid: uid, password: password)
-
-            guard let credentials = credentials else {
-                let errorMsg = credentialService.errorMessage ?? "Failed to fetch credentials"
-                connectionState = .error(errorMsg)
-                log("   ❌ Credential fetch failed: \(errorMsg)")
-                return
-            }
-
-            log("   ✅ Got credentials (cached: \(credentials.cacheAgeDescription))")
-            log("   ClientId: \(credentials.maskedClientId)")
-
-            // Step 2: Connect via VeepaConnectionBridge
-            log("   Establishing P2P connection...")
-            let success = await connectionBridge.connectWithCredentials(credentials, password: password)
+        await bringUp(password: password) { [weak self] in
+            guard let self = self else { throw CancellationError() }
 
-            if success {
-                connectionState = .connected
-                log("   ✅ Connected successfully!")
-            } else {
-                let errorMsg = connectionBridge.lastError?.message ?? "Unknown error"
-                connectionState = .error(errorMsg)
-                log("   ❌ Connection failed: \(errorMsg)")
+            // Get credentials (from cache or cloud)
+            self.log("   Fetching P2P credentials...")
+            guard let credentials = await self.getOrFetchCredentials(uid: uid, password: password) else {
+                let errorMsg = self.credentialService.errorMessage ?? "Failed to fetch credentials"
+                throw ConnectionBridgeError.connectionFailed(errorMsg)
             }
 
-        } catch {
-            connectionState = .error(error.localizedDescription)
-            log("   ❌ Connection failed: \(error.localizedDescription)")
+            self.log("   ✅ Got credentials (cached: \(credentials.cacheAgeDescription))")
+            self.log("   ClientId: \(credentials.maskedClientId)")
+            return credentials
         }
     }
 
@@ -115,18 +95,9 @@ final class AudioConnectionService: ObservableObject {
         log("   UID: \(uid)")
         log("   ServiceParam: \(serviceParam.prefix(20))...")
 
-        connectionState = .connecting
-
-        do {
-            // Initialize Flutter if needed
-            if !flutterEngine.isFlutterReady {
-                log("   Initializing Flutter engine...")
-                try await flutterEngine.initializeAndWaitForReady(timeout: 10.0)
-                log("   ✅ Flutter ready")
-            }
-
+        await bringUp(password: password) {
             // Create P2P credentials with provided serviceParam
-            let credentials = P2PCredentials(
+            P2PCredentials(
                 cameraUid: uid,
                 clientId: uid,  // Use UID as clientId for manual mode
                 serviceParam: serviceParam,
@@ -135,21 +106,98 @@ final class AudioConnectionService: ObservableObject {
                 supplier: nil,
                 cluster: nil
             )
+        }
+    }
 
-            // Connect via VeepaConnectionBridge
-            log("   Establishing P2P connection...")
-            let success = await connectionBridge.connectWithCredentials(credentials, password: password)
-
-            if success {
-                connectionState = .connected
-                log("   ✅ Connected successfully!")
-            } else {
-                let errorMsg = connectionBridge.lastError?.message ?? "Unknown error"
-                connectionState = .error(errorMsg)
-                log("   ❌ Connection failed: \(errorMsg)")
+    // MARK: - Bring-up
+
+    /// Holds values produced by one bring-up step for its dependents
+    @MainActor
+    private final class BringUpContext {
+        var credentials: P2PCredentials?
+    }
+
+    /// Run the connection bring-up as a dependency graph
+    ///
+    /// Flutter engine boot and credential lookup run concurrently and gate the
+    /// P2P connect; audio engine warm-up, decode buffer preallocation and SDK
+    /// symbol resolution run alongside them so `startAudio` finds everything ready.
+    private func bringUp(
+        password: String,
+        credentials resolveCredentials: @escaping @MainActor () async throws -> P2PCredentials
+    ) async {
+        connectionState = .connecting
+
+        // Warm start: engine already booted by a previous connection
+        StartupTrace.shared.begin(flutterEngine.isFlutterReady ? .warm : .cold)
+
+        let context = BringUpContext()
+        let flutterEngine = self.flutterEngine
+        let connectionBridge = self.connectionBridge
+
+        let steps = [
+            BringUpStep(.flutterEngine) { @MainActor in
+                // Initialize Flutter if needed
+                if !flutterEngine.isFlutterReady {
+                    try await flutterEngine.initializeAndWaitForReady(timeout: 10.0)
+                }
+            },
+            BringUpStep(.credentials) { @MainActor in
+                context.credentials = try await resolveCredentials()
+            },
+            BringUpStep(.p2pConnect, dependsOn: [.flutterEngine, .credentials]) { @MainActor in
+                guard let credentials = context.credentials else {
+                    throw ConnectionBridgeError.connectionFailed("No credentials")
+                }
+                let success = await connectionBridge.connectWithCredentials(credentials, password: password)
+                if !success {
+                    throw ConnectionBridgeError.connectionFailed(connectionBridge.lastError?.message ?? "Unknown error")
+                }
+            },
+            BringUpStep(.audioEngine, critical: false) { @MainActor in
+                try AudioBridgeEngine.shared.prewarm()
+            },
+            BringUpStep(.decoderBuffers, critical: false) {
+                AudioHookBridge.shared.preallocateDecodeBuffers(4096)
+            },
+            BringUpStep(.sdkSymbols, critical: false) {
+                AudioHookBridge.shared.resolveSDKSymbols()
             }
+        ]
 
+        var orchestrator = BringUpOrchestrator()
+        orchestrator.onStepFinished = { [weak self] timing in
+            Task { @MainActor in
+                let status = timing.succeeded ? "✅" : "⚠️"
+                self?.log("   \(status) \(timing.id.rawValue) done in \(Int(timing.duration * 1000)) ms")
+            }
+        }
+
+        // Connected once the P2P link is up; warm-up steps finish in the background
+        orchestrator.onCriticalStepsFinished = { [weak self] _ in
+            let connectedAt = StartupTrace.now()
+            Task { @MainActor in
+                StartupTrace.shared.mark(.p2pConnected, at: connectedAt)
+                self?.connectionState = .connected
+                self?.log("   ✅ Connected successfully!")
+            }
+        }
+
+        log("   Running bring-up (\(steps.count) steps, concurrent)...")
+
+        do {
+            let report = try await orchestrator.run(steps)
+            lastBringUpReport = report
+            StartupTrace.shared.record(report)
+            log(report.description)
+        } catch BringUpError.stepFailed(let id, let error, let report) {
+            lastBringUpReport = report
+            StartupTrace.shared.finish(export: false)
+            connectionState = .error(error.localizedDescription)
+            log("   ❌ Connection failed at \(id.rawValue): \(error.localizedDescription)")
+            log(report.description)
         } catch {
+            StartupTrace.shared.finish(export: false)
             connectionState = .error(error.localizedDescription)
             log("   ❌ Connection failed: \(error.localizedDescription)")
         }
@@ -0,0 +1,321 @@
+//
+//  AudioParameterNegotiator.swift
+//  VeepaAudioTest
+//
+//  Created for latency tuning
+//  Purpose: Ask the camera which audio settings it supports and set the
+//           ones that best fit the playout profile
+//
+//  The camera reports its audio settings in get_params.cgi (current codec,
+//  sample rate and frame duration, plus the lists it accepts) and takes new
+//  ones with audiostream.cgi. Firmware without the lists only reports what
+//  it is doing now; negotiation then leaves the stream alone.
+//
+//  The choice keeps to codecs the pipeline decodes (G.711a before the
+//  half-rate ADPCM that CongestionController falls back to), takes the
+//  highest rate the decode and recording rings are sized for, and the
+//  frame duration nearest the profile's `sourceFrameMs` - 10 ms frames for
+//  live intercom halve the packetisation delay of the default 20 ms, while
+//  evidence monitoring asks for longer frames and fewer packets.
+//
+//  Parameter names live in `Keys`: the manual extract in docs/ lists
+//  audiostream.cgi but not its parameter table.
+//
+
+import Foundation
+
+/// Sends a CGI command to a camera and returns its text response
+protocol CameraCgiTransport {
+    func sendCgi(_ command: String) async throws -> String
+}
+
+extension VeepaConnectionBridge: CameraCgiTransport {
+    func sendCgi(_ command: String) async throws -> String {
+        try await sendCgi(command, timeout: 5)
+    }
+}
+
+/// Audio codecs a camera may offer
+enum AudioCodec: String, CaseIterable {
+    case g711a
+    case g711u
+    case adpcm
+    case aac
+
+    /// Codecs the capture → decode path handles, in order of preference
+    static let decodable: [AudioCodec] = [.g711a, .adpcm]
+
+    /// Payload bits per sample (nil for variable-rate codecs)
+    var bitsPerSample: Int? {
+        switch self {
+        case .g711a, .g711u: return 8
+        case .adpcm: return 4
+        case .aac: return nil
+        }
+    }
+
+    /// AudioHookBridge's name for frames in this codec
+    var frameCodec: AudioFrameCodec? {
+        switch self {
+        case .g711a: return .g711a
+        case .adpcm: return .imaAdpcm
+        case .g711u, .aac: return nil
+        }
+    }
+}
+
+/// One complete set of stream settings
+struct AudioStreamParameters: Equatable, CustomStringConvertible {
+    var codec: AudioCodec
+    var sampleRate: Int
+    var frameMs: Int
+
+    /// Samples (= A-law bytes) per frame
+    var frameSamples: Int { sampleRate * frameMs / 1000 }
+
+    /// Bytes per frame on the wire (payload only)
+    var frameBytes: Int { frameSamples * (codec.bitsPerSample ?? 8) / 8 }
+
+    /// Link rate the stream needs, counting `packetOverheadBytes` per frame
+    func bitsPerSecond(packetOverheadBytes: Int = 0) -> Int {
+        (frameBytes + packetOverheadBytes) * 8 * 1000 / max(frameMs, 1)
+    }
+
+    var description: String { "\(codec.rawValue)/\(sampleRate) Hz/\(frameMs) ms" }
+}
+
+/// What a camera reports it can send
+struct AudioCapabilities: Equatable {
+    var codecs: [AudioCodec]
+    var sampleRates: [Int]
+    var frameMs: [Int]
+
+    /// Settings in use (nil when the camera does not report them)
+    var current: AudioStreamParameters?
+
+    /// Whether the camera lists alternatives to its current settings
+    var isNegotiable: Bool {
+        codecs.count > 1 || sampleRates.count > 1 || frameMs.count > 1
+    }
+
+    /// Read capabilities from get_params.cgi values
+    ///
+    /// A missing list falls back to the current value alone, and a camera
+    /// reporting nothing at all to the stream the SDK documents
+    /// (G.711a, 8 kHz, 20 ms frames).
+    static func parse(_ values: [String: String]) -> AudioCapabilities {
+        typealias Keys = AudioParameterNegotiator.Keys
+        let currentCodec = values[Keys.codec].flatMap(AudioCodec.init(rawValue:))
+        let currentRate = values[Keys.sampleRate].flatMap { Int($0) }
+        let currentFrame = values[Keys.frameMs].flatMap { Int($0) }
+
+        func list(_ key: String) -> [String] {
+            (values[key] ?? "").split(separator: ",").map { $0.trimmingCharacters(in: .whitespaces) }
+        }
+
+        var codecs = list(Keys.codecList).compactMap(AudioCodec.init(rawValue:))
+        var rates = list(Keys.sampleRateList).compactMap { Int($0) }.filter { $0 > 0 }
+        var frames = list(Keys.frameMsList).compactMap { Int($0) }.filter { $0 > 0 }
+        if codecs.isEmpty { codecs = [currentCodec ?? .g711a] }
+        if rates.isEmpty { rates = [currentRate ?? 8000] }
+        if frames.isEmpty { frames = [currentFrame ?? 20] }
+
+        var current: AudioStreamParameters?
+        if let codec = currentCodec, let rate = currentRate, let frame = currentFrame {
+            current = AudioStreamParameters(codec: codec, sampleRate: rate, frameMs: frame)
+        }
+        return AudioCapabilities(codecs: codecs, sampleRates: rates.sorted(), frameMs: frames.sorted(), current: current)
+    }
+}
+
+/// Queries and sets a camera's audio stream parameters
+final class AudioParameterNegotiator {
+
+    // MARK: - Types
+
+    /// CGI commands and parameter names
+    enum Keys {
+        static let queryCommand = "get_params.cgi?"
+        static let applyCommand = "audiostream.cgi?streamid=0&"
+
+        static let codec = "audio_codec"
+        static let sampleRate = "audio_samplerate"
+        static let frameMs = "audio_frame_ms"
+        static let codecList = "audio_codec_list"
+        static let sampleRateList = "audio_samplerate_list"
+        static let frameMsList = "audio_frame_ms_list"
+        static let result = "result"
+    }
+
+    struct Negotiation {
+        let capabilities: AudioCapabilities
+        let chosen: AudioStreamParameters
+        /// False when the camera already used the chosen settings
+        let applied: Bool
+    }
+
+    enum NegotiationError: Error, LocalizedError {
+        case noDecodableCodec([AudioCodec])
+        case rejected(command: String, result: String)
+        case notApplied(requested: AudioStreamParameters, reported: AudioStreamParameters?)
+        case indistinguishable(AudioStreamParameters)
+
+        var errorDescription: String? {
+            switch self {
+            case .noDecodableCodec(let offered):
+                return "Camera offers no decodable codec (\(offered.map(\.rawValue).joined(separator: ", ")))"
+            case .rejected(let command, let result):
+                return "Camera rejected \(command) (result \(result))"
+            case .notApplied(let requested, let reported):
+                return "Camera reports \(reported.map(String.init(describing:)) ?? "nothing") after setting \(requested)"
+            case .indistinguishable(let parameters):
+                return "Frames in \(parameters) have the current payload size in another codec; not switching"
+            }
+        }
+    }
+
+    // MARK: - Properties
+
+    private let transport: CameraCgiTransport
+
+    /// Called with new settings just before they are sent; by default tells
+    /// AudioHookBridge which frames to expect, so it switches decoders on
+    /// the first frame in the new settings. Throwing keeps them from being sent.
+    var willApply: (AudioStreamParameters) throws -> Void = { parameters in
+        guard let codec = parameters.codec.frameCodec else { return }
+        guard AudioHookBridge.shared.expectFrameCodec(codec, frameSamples: UInt32(parameters.frameSamples)) else {
+            throw NegotiationError.indistinguishable(parameters)
+        }
+    }
+
+    /// Called when settings announced through `willApply` were not taken
+    /// (sending failed, rejected, or not reported back); by default
+    /// withdraws them from AudioHookBridge, so a frame that happens to have
+    /// their payload size is not decoded in their codec
+    var didNotApply: (AudioStreamParameters) -> Void = { parameters in
+        guard let codec = parameters.codec.frameCodec else { return }
+        AudioHookBridge.shared.cancelFrameCodecExpectation(codec, frameSamples: UInt32(parameters.frameSamples))
+    }
+
+    /// Highest stream rate the decode, rewind and flight recorder rings are sized for
+    let maxSampleRate: Int
+
+    // MARK: - Initialization
+
+    init(transport: CameraCgiTransport, maxSampleRate: Int = 16000) {
+        self.transport = transport
+        self.maxSampleRate = maxSampleRate
+    }
+
+    // MARK: - Negotiation
+
+    /// Read what the camera supports and is using now
+    func queryCapabilities() async throws -> AudioCapabilities {
+        let response = try await transport.sendCgi(Keys.queryCommand)
+        return AudioCapabilities.parse(Self.parseResponse(response))
+    }
+
+    /// Choose the settings for `profile` and apply them if they differ from
+    /// the camera's current ones
+    func negotiate(for profile: PlayoutProfile) async throws -> Negotiation {
+        let capabilities = try await queryCapabilities()
+        guard let chosen = Self.choose(from: capabilities, for: profile, maxSampleRate: maxSampleRate) else {
+            throw NegotiationError.noDecodableCodec(capabilities.codecs)
+        }
+
+        guard capabilities.isNegotiable, chosen != capabilities.current else {
+            print("[AudioParameterNegotiator] ✅ Camera sends \(chosen); nothing to change")
+            return Negotiation(capabilities: capabilities, chosen: chosen, applied: false)
+        }
+
+        try await apply(chosen, verify: capabilities.current != nil)
+        print("[AudioParameterNegotiator] 🎚️ \(profile.name): "
+              + "\(capabilities.current.map(String.init(describing:)) ?? "unknown") → \(chosen)")
+        return Negotiation(capabilities: capabilities, chosen: chosen, applied: true)
+    }
+
+    /// Send settings to the camera
+    /// - Parameter verify: Read the settings back (for cameras that report them)
+    func apply(_ parameters: AudioStreamParameters, verify: Bool = true) async throws {
+        try willApply(parameters)
+        do {
+            try await send(parameters, verify: verify)
+        } catch {
+            didNotApply(parameters)
+            throw error
+        }
+    }
+
+    private func send(_ parameters: AudioStreamParameters, verify: Bool) async throws {
+        let command = Keys.applyCommand
+            + "\(Keys.codec)=\(parameters.codec.rawValue)&"
+            + "\(Keys.sampleRate)=\(parameters.sampleRate)&"
+            + "\(Keys.frameMs)=\(parameters.frameMs)&"
+        let values = Self.parseResponse(try await transport.sendCgi(command))
+        if let result = values[Keys.result], result != "0" {
+            throw NegotiationError.rejected(command: command, result: result)
+        }
+
+        if verify {
+            let reported = try await queryCapabilities().current
+            guard reported == parameters else {
+                throw NegotiationError.notApplied(requested: parameters, reported: reported)
+            }
+        }
+    }
+
+    /// Best settings for `profile` among `capabilities` (nil when no codec decodes)
+    ///
+    /// - Codec: the first of `AudioCodec.decodable` the camera offers
+    /// - Rate: the highest up to `maxSampleRate`, else the lowest offered
+    /// - Frame: nearest `profile.sourceFrameMs`, the shorter one on a tie
+    static func choose(from capabilities: AudioCapabilities, for profile: PlayoutProfile,
+                       maxSampleRate: Int = 16000) -> AudioStreamParameters? {
+        guard let codec = AudioCodec.decodable.first(where: { capabilities.codecs.contains($0) }),
+              let lowestRate = capabilities.sampleRates.min(),
+              !capabilities.frameMs.isEmpty else {
+            return nil
+        }
+
+        let sampleRate = capabilities.sampleRates.filter { $0 <= maxSampleRate }.max() ?? lowestRate
+        let frameMs = capabilities.frameMs.min { a, b in
+            let da = abs(a - profile.sourceFrameMs)
+            let db = abs(b - profile.sourceFrameMs)
+            return da != db ? da < db : a < b
+        }!
+        return AudioStreamParameters(codec: codec, sampleRate: sampleRate, frameMs: frameMs)
+    }
+
+    // MARK: - CGI Text
+
+    /// Values of a CGI response: `var name=value;` statements, values
+    /// optionally quoted
+    static func parseResponse(_ text: String) -> [String: String] {
+        var values: [String: String] = [:]
+        for statement in text.split(whereSeparator: { $0 == ";" || $0 == "\n" || $0 == "\r" }) {
+            var line = statement.trimmingCharacters(in: .whitespaces)
+            if line.hasPrefix("var ") { line.removeFirst(4) }
+            guard let equals = line.firstIndex(of: "=") else { continue }
+
+            let name = line[..<equals].trimmingCharacters(in: .whitespaces)
+            var value = line[line.index(after: equals)...].trimmingCharacters(in: .whitespaces)
+            if value.count >= 2, let quote = value.first, quote == "\"" || quote == "'", value.last == quote {
+                value = String(value.dropFirst().dropLast())
+            }
+            if !name.isEmpty { values[name] = value }
+        }
+        return values
+    }
+
+    /// Parameters of a CGI command's query ("name.cgi?a=1&b=2&")
+    static func queryParameters(_ command: String) -> [String: String] {
+        guard let query = command.split(separator: "?", maxSplits: 1).dropFirst().first else { return [:] }
+        var values: [String: String] = [:]
+        for pair in query.split(separator: "&") {
+            let parts = pair.split(separator: "=", maxSplits: 1)
+            guard let name = parts.first else { continue }
+            values[String(name)] = parts.count > 1 ? String(parts[1]).removingPercentEncoding ?? String(parts[1]) : ""
+        }
+        return values
+    }
+}
@@ -49,6 +49,7 @@ final class AudioStreamService: ObservableObject {
 
         // Call Flutter method
         do {
+            StartupTrace.shared.mark(.startVoiceRequested)
             log("   Calling startVoice()...")
             let result = try await flutterEngine.invoke("startAudio")
             log("   startVoice result: \(result ?? "nil")")
@@ -70,6 +71,7 @@ final class AudioStreamService: ObservableObject {
 
         // Skip audio session configuration - just call startVoice
         do {
+            StartupTrace.shared.mark(.startVoiceRequested)
             log("   Calling startVoice()...")
             let result = try await flutterEngine.invoke("startAudio")
             log("   startVoice result: \(result ?? "nil")")
@@ -110,6 +112,8 @@ final class AudioStreamService: ObservableObject {
             log("   setMute result: \(result ?? "nil")")
 
             isMuted = muted
+            // The hooked stream plays through AudioBridgeEngine, not the SDK player
+            AudioBridgeEngine.shared.isOutputMuted = muted
             log("   ✅ Mute set to \(muted)")
 
         } catch {
@@ -0,0 +1,212 @@
+//
+//  ConnectionBringUp.swift
+//  VeepaAudioTest
+//
+//  Created for time-to-first-audio work
+//  Purpose: Run the independent connection bring-up steps concurrently
+//           instead of strictly one after another
+//
+//  The steps form a small dependency graph:
+//
+//  ```
+//  flutterEngine ──┐
+//                  ├──▶ p2pConnect
+//  credentials ────┘
+//
+//  audioEngine      (no dependencies - warms the playback graph on the main actor)
+//  decoderBuffers   (no dependencies - preallocates G.711 buffers)
+//  sdkSymbols       (no dependencies - dlsym of pcmp2/CGI/CSession)
+//  ```
+//
+//  Every step that has all of its dependencies satisfied is started
+//  immediately, so the cloud credential lookup overlaps the Flutter engine
+//  boot and the audio warm-up steps overlap both.
+//
+
+import Foundation
+
+/// Identifier of a single bring-up step
+enum BringUpStepID: String, CaseIterable {
+    case flutterEngine
+    case credentials
+    case p2pConnect
+    case audioEngine
+    case decoderBuffers
+    case sdkSymbols
+}
+
+/// One node of the bring-up dependency graph
+struct BringUpStep {
+    let id: BringUpStepID
+
+    /// Steps that must finish successfully before this one may start
+    let dependencies: Set<BringUpStepID>
+
+    /// Critical steps abort the whole bring-up when they fail.
+    /// Warm-up steps only log their failure (the work is redone lazily later).
+    let isCritical: Bool
+
+    let work: @Sendable () async throws -> Void
+
+    init(
+        _ id: BringUpStepID,
+        dependsOn dependencies: Set<BringUpStepID> = [],
+        critical isCritical: Bool = true,
+        work: @escaping @Sendable () async throws -> Void
+    ) {
+        self.id = id
+        self.dependencies = dependencies
+        self.isCritical = isCritical
+        self.work = work
+    }
+}
+
+/// Wall-clock timing of one step, relative to the start of the bring-up
+struct BringUpStepTiming {
+    let id: BringUpStepID
+    let startOffset: TimeInterval
+    let duration: TimeInterval
+    let succeeded: Bool
+}
+
+/// Per-step timings of a finished (or aborted) bring-up
+struct BringUpReport {
+    /// Uptime (ns) at which the bring-up started; step offsets are relative to it
+    let startNanoseconds: UInt64
+    let timings: [BringUpStepTiming]
+    let totalDuration: TimeInterval
+
+    /// Sum of all step durations - compare with `totalDuration` to see
+    /// how much the concurrency actually saved
+    var serialDuration: TimeInterval {
+        timings.reduce(0) { $0 + $1.duration }
+    }
+
+    func timing(for id: BringUpStepID) -> BringUpStepTiming? {
+        timings.first { $0.id == id }
+    }
+
+    var description: String {
+        var lines = ["Bring-up: \(Self.ms(totalDuration)) total (\(Self.ms(serialDuration)) if run serially)"]
+        for timing in timings.sorted(by: { $0.startOffset < $1.startOffset }) {
+            let status = timing.succeeded ? "✅" : "❌"
+            lines.append("  \(status) \(timing.id.rawValue): +\(Self.ms(timing.startOffset)) for \(Self.ms(timing.duration))")
+        }
+        return lines.joined(separator: "\n")
+    }
+
+    private static func ms(_ interval: TimeInterval) -> String {
+        String(format: "%.0f ms", interval * 1000)
+    }
+}
+
+/// Errors raised by the orchestrator
+enum BringUpError: Error, LocalizedError {
+    case stepFailed(BringUpStepID, Error, BringUpReport)
+    case unsatisfiableDependencies([BringUpStepID])
+
+    var errorDescription: String? {
+        switch self {
+        case .stepFailed(let id, let error, _):
+            return "\(id.rawValue) failed: \(error.localizedDescription)"
+        case .unsatisfiableDependencies(let ids):
+            return "Bring-up steps can never run: \(ids.map(\.rawValue).joined(separator: ", "))"
+        }
+    }
+}
+
+/// Runs a set of `BringUpStep`s as a dependency DAG with maximal concurrency
+struct BringUpOrchestrator {
+
+    /// Called when each step finishes (on an arbitrary executor)
+    var onStepFinished: (@Sendable (BringUpStepTiming) -> Void)?
+
+    /// Called once, as soon as every critical step has succeeded, with the
+    /// report so far; warm-up steps may still be running (arbitrary executor)
+    var onCriticalStepsFinished: (@Sendable (BringUpReport) -> Void)?
+
+    /// Run all steps, starting each as soon as its dependencies have succeeded
+    /// - Returns: The per-step timing report
+    /// - Throws: `BringUpError.stepFailed` if a critical step fails; the remaining
+    ///           steps are cancelled and the partial report is attached
+    func run(_ steps: [BringUpStep]) async throws -> BringUpReport {
+        let origin = DispatchTime.now().uptimeNanoseconds
+        let stepsByID = Dictionary(uniqueKeysWithValues: steps.map { ($0.id, $0) })
+
+        var pending = Set(steps.map(\.id))
+        var succeeded = Set<BringUpStepID>()
+        var timings: [BringUpStepTiming] = []
+        var criticalRemaining = Set(steps.filter(\.isCritical).map(\.id))
+
+        func offset(_ nanos: UInt64) -> TimeInterval {
+            TimeInterval(nanos - origin) / 1_000_000_000
+        }
+
+        func report() -> BringUpReport {
+            BringUpReport(startNanoseconds: origin, timings: timings, totalDuration: offset(DispatchTime.now().uptimeNanoseconds))
+        }
+
+        try await withThrowingTaskGroup(of: (BringUpStepTiming, Error?).self) { group in
+            var running = 0
+
+            func launchReadySteps() {
+                let ready = pending.filter { stepsByID[$0]!.dependencies.isSubset(of: succeeded) }
+                for id in ready {
+                    pending.remove(id)
+                    running += 1
+                    let step = stepsByID[id]!
+                    group.addTask {
+                        let start = DispatchTime.now().uptimeNanoseconds
+                        var failure: Error?
+                        do {
+                            try await step.work()
+                        } catch {
+                            failure = error
+                        }
+                        let end = DispatchTime.now().uptimeNanoseconds
+                        let timing = BringUpStepTiming(
+                            id: id,
+                            startOffset: TimeInterval(start - origin) / 1_000_000_000,
+                            duration: TimeInterval(end - start) / 1_000_000_000,
+                            succeeded: failure == nil
+                        )
+                        return (timing, failure)
+                    }
+                }
+            }
+
+            launchReadySteps()
+            if criticalRemaining.isEmpty {
+                onCriticalStepsFinished?(report())
+            }
+
+            while let result = try await group.next() {
+                let (timing, failure) = result
+                running -= 1
+                timings.append(timing)
+                onStepFinished?(timing)
+
+                if let failure = failure {
+                    if stepsByID[timing.id]!.isCritical {
+                        group.cancelAll()
+                        throw BringUpError.stepFailed(timing.id, failure, report())
+                    }
+                } else {
+                    succeeded.insert(timing.id)
+                    if criticalRemaining.remove(timing.id) != nil && criticalRemaining.isEmpty {
+                        onCriticalStepsFinished?(report())
+                    }
+                }
+
+                launchReadySteps()
+
+                // Anything still pending with nothing running depends on a failed step
+                if running == 0 && !pending.isEmpty {
+                    throw BringUpError.unsatisfiableDependencies(Array(pending))
+                }
+            }
+        }
+
+        return report()
+    }
+}
@@ -6,6 +6,7 @@
 //   - Removed streaming methods (startStreaming/stopStreaming - handled by audio bridge)
 //   - Simplified state enum: 7 states → 4 states (idle, connecting, connected, error)
 //   - Kept: P2P connection (connectWithCredentials), disconnect, error tracking
+//   - Added: clientPtr of the connection, CGI round trip (sendCgi)
 //
 import Foundation
 import Flutter
@@ -71,6 +72,9 @@ final class VeepaConnectionBridge: ObservableObject {
     @Published private(set) var state: VeepaConnectionState = .idle
     @Published private(set) var lastError: VeepaConnectionError?
 
+    /// SDK client handle of the current connection (nil when disconnected)
+    @Published private(set) var clientPtr: Int?
+
     private let engineManager = FlutterEngineManager.shared
 
     private init() {}
@@ -184,7 +188,8 @@ final class VeepaConnectionBridge: ObservableObject {
             if success {
                 // SIMPLIFIED: No state polling - Flutter will send events
                 state = .connected
-                if let clientPtr = resultMap["clientPtr"] as? Int {
+                clientPtr = resultMap["clientPtr"] as? Int
+                if let clientPtr = clientPtr {
                     NSLog("🔵 [VeepaConnectionBridge] State set to connected (clientPtr: %d)", clientPtr)
                 } else {
                     NSLog("🔵 [VeepaConnectionBridge] State set to connected")
@@ -218,18 +223,41 @@ final class VeepaConnectionBridge: ObservableObject {
         do {
             try await engineManager.invoke("disconnect")
             state = .idle
+            clientPtr = nil
             NSLog("🔵 [VeepaConnectionBridge] Disconnected successfully")
         } catch {
             NSLog("🔵 [VeepaConnectionBridge] Disconnect error: \(error)")
             // Still mark as idle even if disconnect fails
             state = .idle
+            clientPtr = nil
+        }
+    }
+
+    /// Send a CGI command and wait for the camera's response
+    /// - Parameters:
+    ///   - command: CGI path and query, e.g. "get_params.cgi?"
+    ///   - timeout: Seconds to wait for the write and the response
+    /// - Returns: The response text (`var name=value;` lines)
+    func sendCgi(_ command: String, timeout: Int) async throws -> String {
+        guard state.isConnected, clientPtr != nil else {
+            throw ConnectionBridgeError.notConnected
+        }
+
+        let result = try await engineManager.invoke("writeCgi", arguments: ["cgi": command, "timeout": timeout])
+        guard let resultMap = result as? [String: Any],
+              resultMap["success"] as? Bool == true,
+              let response = resultMap["response"] as? String else {
+            let errorMsg = (result as? [String: Any])?["error"] as? String ?? "Invalid result"
+            throw ConnectionBridgeError.cgiFailed(command: command, reason: errorMsg)
         }
+        return response
     }
 
     /// Reset bridge state (for testing)
     func reset() {
         state = .idle
         lastError = nil
+        clientPtr = nil
     }
 }
 
@@ -241,6 +269,7 @@ final class VeepaConnectionBridge: ObservableObject {
 enum ConnectionBridgeError: Error, LocalizedError {
     case notConnected
     case connectionFailed(String)
+    case cgiFailed(command: String, reason: String)
 
     var errorDescription: String? {
         switch self {
@@ -248,6 +277,8 @@ enum ConnectionBridgeError: Error, LocalizedError {
             return "Not connected to camera"
         case .connectionFailed(let reason):
             return "Connection failed: \(reason)"
+        case .cgiFailed(let command, let reason):
+            return "CGI \(command) failed: \(reason)"
         }
     }
 }
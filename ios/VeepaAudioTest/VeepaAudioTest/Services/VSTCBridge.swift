@@ -204,6 +204,7 @@ final class VSTCBridge {
         }
 
         keepAliveCount += 1
+        pipeline_trace_instant(PIPELINE_TRACE_KEEPALIVE, UInt32(PIPELINE_TRACE_NO_SESSION), Int64(keepAliveCount))
         let timestamp = DateFormatter.localizedString(from: Date(), dateStyle: .none, timeStyle: .medium)
 
         // DISABLED: Send_Pkt_Alive crashes - wrong signature/parameters
@@ -15,6 +15,10 @@ struct VeepaAudioTestApp: App {
     init() {
         print("🚀 VeepaAudioTest app initializing...")
 
+        // Debug builds: flag allocations and locks on audio threads
+        // (no-op in builds without RT_SANITIZER)
+        RealtimeSanitizer.install()
+
         // CRITICAL: Configure audio session FIRST, before anything else
         // This must happen before Flutter engine initializes the SDK
         configureAudioSessionEarly()
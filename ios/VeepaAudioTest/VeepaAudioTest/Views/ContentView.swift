@@ -28,6 +28,12 @@ struct ContentView: View {
     @State private var showingError = false
     @State private var errorMessage = ""
     @State private var selectedStrategyIndex = 0
+    @State private var isTracingPipeline = false
+    @State private var isRewinding = false
+    @State private var isAutoGainOn = false
+    @State private var filterPreset = AudioFilterBank.Preset.off
+    @State private var isNormalizingLoudness = false
+    @State private var congestionController: CongestionController?
 
     // MARK: - Body
 
@@ -171,6 +177,57 @@ struct ContentView: View {
             }
             .disabled(!isConnected || !audioService.isPlaying)
 
+            Button(action: cycleFilterPreset) {
+                HStack {
+                    Image(systemName: "waveform.path")
+                    Text(filterPreset == .off ? "Clean-up Filter Off" : "Filter: \(filterPreset.name)")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(filterPreset == .off ? Color.gray : Color.green)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+
+            Text("Removes DC offset, low rumble below 80/120 Hz or 50/60 Hz mains hum and its harmonics")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
+            Button(action: toggleAutoGain) {
+                HStack {
+                    Image(systemName: isAutoGainOn ? "dial.high.fill" : "dial.low")
+                    Text(isAutoGainOn ? "Auto Gain On" : "Auto Gain Off")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(isAutoGainOn ? Color.green : Color.gray)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+
+            Text("Levels quiet and loud camera microphones to -20 dBFS, gates background noise and limits peaks")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
+            Button(action: toggleLoudnessNormalization) {
+                HStack {
+                    Image(systemName: isNormalizingLoudness ? "speaker.wave.3.fill" : "speaker.wave.1")
+                    Text(isNormalizingLoudness ? "Normalize -16 LUFS On" : "Normalize Loudness Off")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(isNormalizingLoudness ? Color.green : Color.gray)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+
+            Text("Plays every camera at the same EBU R128 programme loudness (integrated LUFS since the stream started)")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
             // PROOF OF CONCEPT: Test P2P Audio Channel Read
             Divider()
                 .padding(.vertical, 4)
@@ -198,6 +255,71 @@ struct ContentView: View {
                 .foregroundColor(.secondary)
                 .multilineTextAlignment(.leading)
 
+            Button(action: togglePipelineTrace) {
+                HStack {
+                    Image(systemName: isTracingPipeline ? "stop.circle.fill" : "timeline.selection")
+                    Text(isTracingPipeline ? "Dump Pipeline Trace" : "Trace Pipeline")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(isTracingPipeline ? Color.red : Color.teal)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+
+            Text("Records frame arrival, decode, ring and render events; the dump writes Chrome JSON and Perfetto files to Caches/PipelineTraces")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
+            Button(action: dumpFlightRecorder) {
+                HStack {
+                    Image(systemName: "airplane.circle.fill")
+                    Text("Dump Flight Recorder")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(Color.indigo)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+
+            Text("Saves the last 30 s of raw frames, decoded audio and pipeline events to Caches/FlightRecordings (also done automatically on underflow bursts and engine restarts)")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
+            HStack {
+                Button(action: toggleRewind) {
+                    HStack {
+                        Image(systemName: isRewinding ? "forward.end.fill" : "gobackward.30")
+                        Text(isRewinding ? "Back to Live" : "Rewind 30 s")
+                    }
+                    .frame(maxWidth: .infinity)
+                    .padding()
+                    .background(isRewinding ? Color.red : Color.brown)
+                    .foregroundColor(.white)
+                    .cornerRadius(8)
+                }
+
+                Button(action: saveRecentClip) {
+                    HStack {
+                        Image(systemName: "scissors")
+                        Text("Save Last 30 s")
+                    }
+                    .frame(maxWidth: .infinity)
+                    .padding()
+                    .background(Color.brown)
+                    .foregroundColor(.white)
+                    .cornerRadius(8)
+                }
+            }
+
+            Text("Replays the stream from 30 s ago out of the in-memory history, or saves the last 30 s as a WAV clip to Documents/Clips")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
             Button(action: testP2PChannelDirect) {
                 HStack {
                     Image(systemName: "antenna.radiowaves.left.and.right")
@@ -271,6 +393,42 @@ struct ContentView: View {
                 .foregroundColor(.secondary)
                 .multilineTextAlignment(.leading)
 
+            Button(action: negotiateAudioParameters) {
+                HStack {
+                    Image(systemName: "slider.horizontal.3")
+                    Text("Negotiate Audio Parameters")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(isConnected ? Color.teal : Color.gray)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+            .disabled(!isConnected)
+
+            Text("Asks the camera for the codec, rate and frame duration that suit the current playout profile")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
+            Button(action: toggleCongestionAdaptation) {
+                HStack {
+                    Image(systemName: congestionController == nil ? "chart.line.downtrend.xyaxis" : "stop.circle")
+                    Text(congestionController == nil ? "Adapt to Congestion" : "Stop Adapting")
+                }
+                .frame(maxWidth: .infinity)
+                .padding()
+                .background(isConnected ? (congestionController == nil ? Color.teal : Color.red) : Color.gray)
+                .foregroundColor(.white)
+                .cornerRadius(8)
+            }
+            .disabled(!isConnected)
+
+            Text("Steps the camera down to ADPCM and longer frames while frames are lost or jitter, and back up when the link recovers")
+                .font(.caption2)
+                .foregroundColor(.secondary)
+                .multilineTextAlignment(.leading)
+
             // Story 10.3: P2P Audio Interception
             Button(action: testStory103) {
                 HStack {
@@ -606,6 +764,105 @@ struct ContentView: View {
         }
     }
 
+    /// Step the SDK stream's clean-up filter through the presets (takes effect on the next frame)
+    private func cycleFilterPreset() {
+        guard let filters = AudioFilterBank.bridge else {
+            errorMessage = "Clean-up filters are unavailable"
+            showingError = true
+            return
+        }
+        let slot = AudioHookBridge.shared.sdkSessionSlot
+        let presets = AudioFilterBank.Preset.allCases
+        let next = presets[(presets.firstIndex(of: filters[slot])! + 1) % presets.count]
+        filters[slot] = next
+        filterPreset = next
+        print("[ContentView] 〰️ Clean-up filter: \(next.name)")
+    }
+
+    /// Switch the SDK stream's automatic gain control (takes effect on the next frame)
+    private func toggleAutoGain() {
+        guard let agc = AutoGainControl.bridge else {
+            errorMessage = "Automatic gain is unavailable"
+            showingError = true
+            return
+        }
+        let slot = AudioHookBridge.shared.sdkSessionSlot
+        agc[slot].enabled.toggle()
+        isAutoGainOn = agc[slot].enabled
+        print("[ContentView] 🎛️ Auto gain \(isAutoGainOn ? "on" : "off") "
+              + "(now \(String(format: "%+.1f", agc.currentGainDb(slot))) dB)")
+    }
+
+    /// Switch loudness normalization of the SDK stream's playback
+    private func toggleLoudnessNormalization() {
+        let engine = AudioBridgeEngine.shared
+        isNormalizingLoudness.toggle()
+        engine.loudnessTarget = isNormalizingLoudness ? -16 : nil
+        let integrated = engine.loudnessMeter?.reading.integrated.map { String(format: "%.1f LUFS", $0) } ?? "not measured yet"
+        print("[ContentView] 🔊 Loudness normalization \(isNormalizingLoudness ? "on" : "off") (stream \(integrated))")
+    }
+
+    /// Start recording pipeline trace events, or stop and dump them in both formats
+    private func togglePipelineTrace() {
+        do {
+            if isTracingPipeline {
+                // The flight recorder keeps tracing running for its own dumps
+                if AudioBridgeEngine.shared.flightRecorder == nil {
+                    PipelineTrace.stop()
+                }
+                isTracingPipeline = false
+                for format in PipelineTrace.Format.allCases {
+                    let url = try PipelineTrace.dump(as: format)
+                    print("[ContentView] 📈 Pipeline trace: \(url.path)")
+                }
+            } else {
+                try PipelineTrace.start()
+                isTracingPipeline = true
+            }
+        } catch {
+            errorMessage = error.localizedDescription
+            showingError = true
+        }
+    }
+
+    /// Dump the flight recorder's history now (written in the background)
+    private func dumpFlightRecorder() {
+        guard let recorder = AudioBridgeEngine.shared.flightRecorder else {
+            errorMessage = "The flight recorder starts with the audio engine"
+            showingError = true
+            return
+        }
+        recorder.trigger(.manual(reason: "ContentView"))
+    }
+
+    /// Rewind live playback 30 s into the history, or return to live
+    private func toggleRewind() {
+        let engine = AudioBridgeEngine.shared
+        if isRewinding {
+            engine.returnToLive()
+            isRewinding = false
+        } else if engine.startRewind(seconds: 30) {
+            isRewinding = true
+        } else {
+            errorMessage = "Nothing to rewind yet - the history fills while audio is playing"
+            showingError = true
+        }
+    }
+
+    /// Save the last 30 s of the stream as a WAV clip
+    private func saveRecentClip() {
+        do {
+            guard let history = AudioBridgeEngine.shared.rewindHistory else {
+                throw RewindHistory.HistoryError.emptyClip
+            }
+            let url = try history.exportClip(last: 30)
+            print("[ContentView] ✂️ Clip: \(url.path)")
+        } catch {
+            errorMessage = error.localizedDescription
+            showingError = true
+        }
+    }
+
     /// Test the AudioHookBridge SDK discovery and hooking
     /// This runs the Objective-C bridge to find AppIOSPlayer
     private func testAudioHook() {
@@ -662,6 +919,11 @@ struct ContentView: View {
             }
             print("[ContentView] ✅ Capture callback set")
 
+            // Follow the camera's actual rate and frame size once detected
+            bridge.streamFormatCallback = { format in
+                AudioBridgeEngine.shared.configureInput(for: format)
+            }
+
             // STEP 3: Discover SDK classes (informational)
             print("[ContentView] Step 3: Discovering SDK classes...")
             let discoveries = bridge.discoverSDKClasses()
@@ -748,6 +1010,66 @@ struct ContentView: View {
         }
     }
 
+    /// Set the camera's audio parameters for the engine's playout profile and
+    /// match the engine's input to them
+    private func negotiateAudioParameters() {
+        Task {
+            do {
+                let engine = AudioBridgeEngine.shared
+                let negotiator = AudioParameterNegotiator(transport: VeepaConnectionBridge.shared)
+                let negotiation = try await negotiator.negotiate(for: engine.playoutProfile)
+                if negotiation.applied {
+                    engine.configureInput(sampleRate: negotiation.chosen.sampleRate,
+                                          frameSamples: negotiation.chosen.frameSamples)
+                }
+                print("[ContentView] 🎚️ Audio parameters: \(negotiation.chosen)"
+                      + (negotiation.applied ? "" : " (unchanged)"))
+            } catch {
+                errorMessage = error.localizedDescription
+                showingError = true
+            }
+        }
+    }
+
+    /// Start or stop stepping the camera's audio settings with link quality
+    private func toggleCongestionAdaptation() {
+        if let controller = congestionController {
+            controller.stop()
+            congestionController = nil
+            return
+        }
+
+        Task {
+            do {
+                let engine = AudioBridgeEngine.shared
+                let negotiator = AudioParameterNegotiator(transport: VeepaConnectionBridge.shared)
+                let capabilities = try await negotiator.queryCapabilities()
+                let ladder = CongestionController.ladder(from: capabilities, for: engine.playoutProfile)
+                guard ladder.count > 1 else {
+                    errorMessage = "The camera offers no cheaper audio settings to fall back to"
+                    showingError = true
+                    return
+                }
+
+                // Start from the top rung so the ladder matches what the camera sends
+                if capabilities.current != ladder[0] {
+                    try await negotiator.apply(ladder[0])
+                    engine.configureInput(sampleRate: ladder[0].sampleRate, frameSamples: ladder[0].frameSamples)
+                }
+
+                let controller = CongestionController(ladder: ladder,
+                                                      configuration: .init(for: engine.playoutProfile))
+                controller.start(negotiator: negotiator) { parameters in
+                    engine.configureInput(sampleRate: parameters.sampleRate, frameSamples: parameters.frameSamples)
+                }
+                congestionController = controller
+            } catch {
+                errorMessage = error.localizedDescription
+                showingError = true
+            }
+        }
+    }
+
     /// Story 10.2: Test Audio CGI Commands
     /// This sends CGI commands to the camera and monitors the buffer for audio data
     private func testAudioCgi() {
@@ -0,0 +1,153 @@
+//
+//  AudioParameterNegotiatorTests.swift
+//  VeepaAudioTestTests
+//
+//  Audio parameter negotiation against the camera emulator: CGI text
+//  parses, each profile gets its frame duration, undecodable codecs and
+//  out-of-range rates are passed over, applied settings change the frames
+//  the emulator sends, and settings the decoder could not follow are
+//  never sent.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class AudioParameterNegotiatorTests: XCTestCase {
+
+    private typealias Keys = AudioParameterNegotiator.Keys
+
+    // MARK: - CGI Text
+
+    func testParsesCgiResponses() {
+        let values = AudioParameterNegotiator.parseResponse(
+            "var result=0;\r\nvar audio_codec=\"g711a\";\r\nvar alias='front door';\nvar audio_frame_ms = 20;")
+        XCTAssertEqual(values["result"], "0")
+        XCTAssertEqual(values[Keys.codec], "g711a")
+        XCTAssertEqual(values["alias"], "front door")
+        XCTAssertEqual(values[Keys.frameMs], "20")
+
+        let query = AudioParameterNegotiator.queryParameters("audiostream.cgi?streamid=0&audio_frame_ms=10&")
+        XCTAssertEqual(query, ["streamid": "0", Keys.frameMs: "10"])
+    }
+
+    func testFirmwareWithoutListsIsLeftAlone() async throws {
+        final class LegacyCamera: CameraCgiTransport {
+            var commands: [String] = []
+            func sendCgi(_ command: String) async throws -> String {
+                commands.append(command)
+                return "var audio_codec=\"g711a\";\r\nvar audio_samplerate=8000;\r\nvar audio_frame_ms=20;\r\n"
+            }
+        }
+
+        let camera = LegacyCamera()
+        let negotiation = try await AudioParameterNegotiator(transport: camera).negotiate(for: .liveIntercom)
+        XCTAssertFalse(negotiation.capabilities.isNegotiable)
+        XCTAssertFalse(negotiation.applied)
+        XCTAssertEqual(camera.commands, [Keys.queryCommand])
+    }
+
+    // MARK: - Choice
+
+    func testEachProfileGetsItsFrameDuration() {
+        let capabilities = AudioCapabilities(codecs: [.aac, .g711a], sampleRates: [8000, 16000, 48000],
+                                             frameMs: [10, 20, 40, 60], current: nil)
+
+        let intercom = AudioParameterNegotiator.choose(from: capabilities, for: .liveIntercom)
+        XCTAssertEqual(intercom, AudioStreamParameters(codec: .g711a, sampleRate: 16000, frameMs: 10))
+        XCTAssertEqual(intercom?.frameSamples, 160)
+        XCTAssertEqual(AudioParameterNegotiator.choose(from: capabilities, for: .standard)?.frameMs, 20)
+        XCTAssertEqual(AudioParameterNegotiator.choose(from: capabilities, for: .evidenceMonitoring)?.frameMs, 40)
+
+        // No exact match: nearest, the shorter one on a tie
+        let coarse = AudioCapabilities(codecs: [.g711a], sampleRates: [8000], frameMs: [30, 50], current: nil)
+        XCTAssertEqual(AudioParameterNegotiator.choose(from: coarse, for: .evidenceMonitoring)?.frameMs, 30)
+        XCTAssertEqual(AudioParameterNegotiator.choose(from: coarse, for: .liveIntercom)?.frameMs, 30)
+
+        let undecodable = AudioCapabilities(codecs: [.aac], sampleRates: [16000], frameMs: [20], current: nil)
+        XCTAssertNil(AudioParameterNegotiator.choose(from: undecodable, for: .standard))
+    }
+
+    // MARK: - Emulator
+
+    func testNegotiatesIntercomSettingsWithTheEmulator() async throws {
+        var configuration = CameraEmulator.Configuration()
+        configuration.sampleRate = 8000
+        configuration.frameSamples = 320
+        let emulator = CameraEmulator(configuration: configuration)
+        _ = emulator.nextFrame()
+
+        let negotiator = AudioParameterNegotiator(transport: emulator)
+        let before = try await negotiator.queryCapabilities()
+        XCTAssertEqual(before.current, AudioStreamParameters(codec: .g711a, sampleRate: 8000, frameMs: 40))
+        XCTAssertTrue(before.isNegotiable)
+
+        let negotiation = try await negotiator.negotiate(for: .liveIntercom)
+        XCTAssertTrue(negotiation.applied)
+        XCTAssertEqual(negotiation.chosen, AudioStreamParameters(codec: .g711a, sampleRate: 16000, frameMs: 10))
+
+        // The next frame is 10 ms at 16 kHz and continues the stream clock
+        let frame = emulator.nextFrame()
+        XCTAssertEqual(frame.payload.count, 160)
+        XCTAssertEqual(frame.timestamp, 40)
+        XCTAssertEqual(emulator.frameDuration, 0.010, accuracy: 1e-9)
+
+        // Already there: nothing to send
+        let again = try await negotiator.negotiate(for: .liveIntercom)
+        XCTAssertFalse(again.applied)
+    }
+
+    func testSettingsTheDecoderCannotFollowAreNotSent() async throws {
+        var configuration = CameraEmulator.Configuration()
+        configuration.sampleRate = 8000
+        configuration.frameSamples = 320
+        let emulator = CameraEmulator(configuration: configuration)
+        _ = emulator.nextFrame()
+        let negotiator = AudioParameterNegotiator(transport: emulator)
+
+        // As AudioHookBridge refuses ADPCM at 80 ms after G.711a at 40 ms (both 320 bytes)
+        let adpcm = AudioStreamParameters(codec: .adpcm, sampleRate: 8000, frameMs: 80)
+        negotiator.willApply = { throw AudioParameterNegotiator.NegotiationError.indistinguishable($0) }
+        do {
+            try await negotiator.apply(adpcm)
+            XCTFail("Expected indistinguishable")
+        } catch AudioParameterNegotiator.NegotiationError.indistinguishable(let parameters) {
+            XCTAssertEqual(parameters, adpcm)
+        }
+        let current = try await negotiator.queryCapabilities().current
+        XCTAssertEqual(current, AudioStreamParameters(codec: .g711a, sampleRate: 8000, frameMs: 40),
+                       "The camera was never asked")
+    }
+
+    func testSettingsTheCameraRejectsAreWithdrawn() async throws {
+        let negotiator = AudioParameterNegotiator(transport: CameraEmulator())
+        let unsupported = AudioStreamParameters(codec: .g711a, sampleRate: 8000, frameMs: 15)
+        var announced: [AudioStreamParameters] = []
+        var withdrawn: [AudioStreamParameters] = []
+        negotiator.willApply = { announced.append($0) }
+        negotiator.didNotApply = { withdrawn.append($0) }
+
+        do {
+            try await negotiator.apply(unsupported, verify: false)
+            XCTFail("Expected rejected")
+        } catch AudioParameterNegotiator.NegotiationError.rejected {
+        }
+        XCTAssertEqual(announced, [unsupported])
+        XCTAssertEqual(withdrawn, [unsupported])
+    }
+
+    func testRejectedSettingsSurfaceAsErrors() async throws {
+        let emulator = CameraEmulator()
+        let response = emulator.handleCgi(Keys.applyCommand + "\(Keys.frameMs)=15&")
+        XCTAssertEqual(AudioParameterNegotiator.parseResponse(response)[Keys.result], "-1")
+
+        var configuration = CameraEmulator.Configuration()
+        configuration.supportedCodecs = ["aac"]
+        let aacOnly = CameraEmulator(configuration: configuration)
+        do {
+            _ = try await AudioParameterNegotiator(transport: aacOnly).negotiate(for: .standard)
+            XCTFail("Expected noDecodableCodec")
+        } catch AudioParameterNegotiator.NegotiationError.noDecodableCodec(let offered) {
+            XCTAssertEqual(offered, [.aac])
+        }
+    }
+}
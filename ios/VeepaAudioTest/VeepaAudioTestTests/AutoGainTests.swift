@@ -0,0 +1,237 @@
+//
+//  AutoGainTests.swift
+//  VeepaAudioTestTests
+//
+//  Automatic gain: a -43 dBFS microphone is brought to the -20 dBFS target,
+//  a loud burst is pulled down within a few frames but released slowly,
+//  gated noise is not boosted, peaks stay under the limiter ceiling, and
+//  the bridge applies the gain to decoded frames. Levels come from the
+//  A-law level meter, as on the live path.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class AutoGainTests: RealtimeSafeTestCase {
+
+    private let slot: session_slot = 1
+    private var agc: AutoGainControl!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        agc = try AutoGainControl(capacity: 4)
+        var parameters = AutoGainControl.Parameters()
+        parameters.enabled = true
+        agc[slot] = parameters
+    }
+
+    /// 20 ms of a 440 Hz tone at 16 kHz, through A-law like a camera frame
+    private struct Source {
+        var phase = 0.0
+        mutating func frame(amplitude: Double) -> [UInt8] {
+            (0..<320).map { _ in
+                defer { phase += 2 * Double.pi * 440 / 16000 }
+                return g711_alaw_encode_sample(Int16(sin(phase) * amplitude * Double(Int16.max)))
+            }
+        }
+    }
+
+    /// Measure, decode and gain one frame the way AudioHookBridge does
+    @discardableResult
+    private func process(_ alaw: [UInt8], in agc: AutoGainControl? = nil) -> (pcm: [Int16], gainDb: Double) {
+        var level = g711_alaw_level()
+        g711_alaw_measure(alaw, alaw.count, &level)
+        var pcm = [Int16](repeating: 0, count: alaw.count)
+        g711_alaw_decode(alaw, &pcm, alaw.count)
+        let gain = auto_gain_process((agc ?? self.agc).bank, slot, &pcm, pcm.count, 16000,
+                                     session_level_from_dbfs(g711_alaw_level_rms_dbfs(&level)),
+                                     session_level_from_dbfs(g711_alaw_level_peak_dbfs(&level)))
+        return (pcm, Double(gain) / 100)
+    }
+
+    private func rmsDbfs(_ pcm: [Int16]) -> Double {
+        let power = pcm.reduce(0.0) { $0 + Double($1) * Double($1) } / Double(pcm.count)
+        return 10 * log10(power) - 20 * log10(32768)
+    }
+
+    // MARK: - Envelope
+
+    func testQuietMicrophoneReachesTarget() {
+        var source = Source()
+        var output: [Int16] = []
+        for _ in 0..<100 {
+            output = process(source.frame(amplitude: 0.01)).pcm
+        }
+        XCTAssertEqual(rmsDbfs(output), -20, accuracy: 1, "-43 dBFS in, target out")
+        XCTAssertEqual(agc.currentGainDb(slot), 23, accuracy: 0.5)
+
+        // Boost is capped
+        var capped = agc[slot]
+        capped.maxGainDb = 12
+        agc[slot] = capped
+        XCTAssertEqual(process(source.frame(amplitude: 0.01)).gainDb, 12, accuracy: 0.1)
+    }
+
+    func testAttackIsFastAndReleaseSlow() {
+        var source = Source()
+        for _ in 0..<100 { process(source.frame(amplitude: 0.1)) }
+        let settled = agc.currentGainDb(slot)
+        XCTAssertEqual(settled, -20 - 20 * log10(0.1 / 2.0.squareRoot()), accuracy: 1)
+
+        // A 20 dB louder talker: most of the cut lands within three frames
+        for _ in 0..<3 { process(source.frame(amplitude: 1.0)) }
+        XCTAssertLessThan(agc.currentGainDb(slot), settled - 15)
+        for _ in 0..<50 { process(source.frame(amplitude: 1.0)) }
+        let loud = agc.currentGainDb(slot)
+
+        // Back to the quiet talker: after half a second the gain has
+        // recovered less than half of the way
+        for _ in 0..<25 { process(source.frame(amplitude: 0.1)) }
+        XCTAssertLessThan(agc.currentGainDb(slot), loud + (settled - loud) / 2)
+    }
+
+    // MARK: - Gate and Limiter
+
+    func testGatedNoiseIsNotBoosted() {
+        var source = Source()
+        for _ in 0..<100 { process(source.frame(amplitude: 0.05)) }
+        let speech = agc.currentGainDb(slot)
+
+        // Background hiss at -65 dBFS: the envelope holds and the gate fades
+        // the gain down by its depth instead of raising it towards +24 dB
+        var noise = SeededNoise()
+        for _ in 0..<250 { process(noise.frame(amplitude: 0.0008)) }
+        XCTAssertEqual(agc.currentGainDb(slot), speech - 12, accuracy: 0.5)
+
+        // Speech opens the gate at the attack rate, at the old gain
+        for _ in 0..<5 { process(source.frame(amplitude: 0.05)) }
+        XCTAssertEqual(agc.currentGainDb(slot), speech, accuracy: 0.5)
+    }
+
+    func testLimiterKeepsPeaksUnderCeiling() {
+        var source = Source()
+        for _ in 0..<100 { process(source.frame(amplitude: 0.01)) }
+        XCTAssertGreaterThan(agc.currentGainDb(slot), 20)
+
+        // A door slam at full boost: limited from the frame's first sample
+        var slam = source.frame(amplitude: 0.01)
+        for i in 100..<110 { slam[i] = g711_alaw_encode_sample(i % 2 == 0 ? 30000 : -30000) }
+        let (pcm, gainDb) = process(slam)
+        let ceiling = 32768 * pow(10, -1.0 / 20)
+        XCTAssertLessThanOrEqual(Double(pcm.map { abs(Int($0)) }.max()!), ceiling * 1.02)
+        XCTAssertLessThan(gainDb, 1)
+    }
+
+    // MARK: - Kernel
+
+    func testRampMatchesReferenceAndDisabledIsPassThrough() {
+        let input = (0..<333).map { Int16(truncatingIfNeeded: $0 * 197 - 32768) }
+        var output = input
+        auto_gain_apply_ramp(&output, output.count, 1000, 60000)
+
+        let step = Int32((Int64(60000 - 1000) * 16) / Int64(input.count))
+        var acc = Int32(1000 * 16)
+        for i in input.indices {
+            acc += step
+            let product = (Int64(input[i]) * Int64(acc >> 4) + 1024) >> 11
+            XCTAssertEqual(Int64(output[i]), min(max(product, -32768), 32767), "sample \(i)")
+        }
+
+        let bypass = try! AutoGainControl(capacity: 2)
+        var source = Source()
+        let frame = source.frame(amplitude: 0.01)
+        var decoded = [Int16](repeating: 0, count: frame.count)
+        g711_alaw_decode(frame, &decoded, frame.count)
+        XCTAssertEqual(process(frame, in: bypass).pcm, decoded, "Disabled by default")
+    }
+
+    func testParametersUpdateWithoutTearing() {
+        var a = AutoGainControl.Parameters()
+        a.enabled = true
+        var b = a
+        b.targetDbfs = -30
+        b.maxGainDb = 6
+        b.releaseMs = 250
+
+        let done = DispatchSemaphore(value: 0)
+        let agc = self.agc!
+        let slot = self.slot
+        DispatchQueue.global().async {
+            for i in 0..<20_000 { agc[slot] = i % 2 == 0 ? a : b }
+            done.signal()
+        }
+        for _ in 0..<20_000 {
+            let seen = agc[slot]
+            XCTAssertTrue(seen == a || seen == b)
+        }
+        done.wait()
+    }
+
+    func testProcessingCost() {
+        var source = Source()
+        let frames = (0..<50).map { _ in source.frame(amplitude: 0.02) }
+        let levels = frames.map { frame -> (Int16, Int16) in
+            var level = g711_alaw_level()
+            g711_alaw_measure(frame, frame.count, &level)
+            return (session_level_from_dbfs(g711_alaw_level_rms_dbfs(&level)),
+                    session_level_from_dbfs(g711_alaw_level_peak_dbfs(&level)))
+        }
+        var pcm = [Int16](repeating: 1000, count: 320)
+
+        let iterations = 20_000
+        let start = DispatchTime.now().uptimeNanoseconds
+        for i in 0..<iterations {
+            let (level, peak) = levels[i % levels.count]
+            _ = auto_gain_process(agc.bank, slot, &pcm, pcm.count, 16000, level, peak)
+        }
+        let nsPerSample = Double(DispatchTime.now().uptimeNanoseconds - start) / Double(iterations * 320)
+
+        print(String(format: "[AutoGainTests] %.2f ns per sample (%.0f ns per 20 ms frame)", nsPerSample, nsPerSample * 320))
+        XCTAssertLessThan(nsPerSample, 20, "Thousands of times faster than real time")
+    }
+
+    // MARK: - Bridge
+
+    func testBridgeGainsDecodedFrames() throws {
+        let bridge = AudioHookBridge.shared
+        let agc = try XCTUnwrap(AutoGainControl.bridge)
+        let slot = bridge.sdkSessionSlot
+        let previous = agc[slot]
+        var parameters = AutoGainControl.Parameters()
+        parameters.enabled = true
+        agc[slot] = parameters
+        agc.resetSession(slot)
+        defer { agc[slot] = previous }
+
+        var lastRms = -Double.infinity
+        let token = bridge.addDecodedFrameObserver { samples, count, _, _ in
+            guard let samples = samples else { return }
+            lastRms = self.rmsDbfs(Array(UnsafeBufferPointer(start: samples, count: Int(count))))
+        }
+        defer { bridge.removeDecodedFrameObserver(token) }
+
+        var configuration = CameraEmulator.Configuration()
+        configuration.frameSamples = 320
+        configuration.amplitude = 0.01
+        let emulator = CameraEmulator(configuration: configuration)
+        for _ in 0..<100 {
+            let frame = emulator.nextFrame()
+            frame.payload.withUnsafeBufferPointer {
+                bridge.injectAlawFrame($0.baseAddress!, length: $0.count, frameNo: frame.frameNo, timestamp: frame.timestamp)
+            }
+        }
+        XCTAssertEqual(lastRms, -20, accuracy: 1.5, "Observers see the levelled stream")
+    }
+}
+
+/// Deterministic white noise through A-law
+private struct SeededNoise {
+    var state: UInt64 = 7
+    mutating func frame(amplitude: Double) -> [UInt8] {
+        (0..<320).map { _ in
+            state = state &* 6364136223846793005 &+ 1442695040888963407
+            let unit = Double(Int64(bitPattern: state) >> 11) / Double(1 << 52)
+            return g711_alaw_encode_sample(Int16(unit * amplitude * Double(Int16.max)))
+        }
+    }
+}
@@ -0,0 +1,118 @@
+//
+//  BatchDecoderTests.swift
+//  VeepaAudioTestTests
+//
+//  Cross-stream batched decode: rings hold exactly what per-frame decoding
+//  produces, and many-session throughput (streams per core) beats decoding
+//  each stream's frame into its CircularAudioBuffer as it arrives.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class BatchDecoderTests: RealtimeSafeTestCase {
+
+    private func makeDecoder(streams: Int, ringSamples: Int = 4096, frameBytes: Int) throws -> OpaquePointer {
+        var config = batch_decoder_config()
+        batch_decoder_config_init(&config)
+        config.max_streams = UInt32(streams)
+        config.ring_samples = UInt32(ringSamples)
+        config.max_frames = UInt32(streams * 2)
+        config.arena_bytes = UInt32(streams * 2 * frameBytes)
+        return try XCTUnwrap(batch_decoder_create(&config))
+    }
+
+    func testRingsMatchPerFrameDecode() throws {
+        let decoder = try makeDecoder(streams: 8, ringSamples: 1000, frameBytes: 480)
+        defer { batch_decoder_destroy(decoder) }
+
+        let emulator = CameraEmulator()
+        var output = [Int16](repeating: 0, count: 2048)
+        let capacity = UInt32(output.count)
+
+        // Several quanta so rings wrap; streams get 1-2 frames per quantum
+        for _ in 0..<6 {
+            var expected: [[Int16]] = Array(repeating: [], count: 8)
+            for stream in 0..<8 {
+                for _ in 0..<(stream % 2 + 1) {
+                    let frame = emulator.nextFrame()
+                    XCTAssertEqual(batch_decoder_submit(decoder, UInt32(stream), frame.payload, UInt32(frame.payload.count)), 0)
+                    var pcm = [Int16](repeating: 0, count: frame.payload.count)
+                    g711_alaw_decode(frame.payload, &pcm, frame.payload.count)
+                    expected[stream] += pcm
+                }
+            }
+            XCTAssertEqual(batch_decoder_run(decoder), 12)
+
+            for stream in 0..<8 {
+                let count = output.withUnsafeMutableBufferPointer {
+                    batch_decoder_read(decoder, UInt32(stream), $0.baseAddress!, capacity)
+                }
+                XCTAssertEqual(Array(output[0..<Int(count)]), expected[stream], "Stream \(stream)")
+            }
+        }
+
+        var stats = batch_decoder_stats()
+        batch_decoder_get_stats(decoder, &stats)
+        XCTAssertEqual(stats.frames, 72)
+        XCTAssertEqual(stats.dropped_frames, 0)
+        XCTAssertGreaterThan(stats.jobs, stats.frames, "Some frames should have wrapped their ring")
+    }
+
+    /// 500 sessions × 30 ms / 480-byte frames (16 kHz), readers keeping up
+    func testBatchedThroughputBeatsPerStreamDecoding() throws {
+        let streams = 500
+        let frameBytes = 480
+        let quanta = 200
+        let framesPerSecond = 1000.0 / 30.0
+
+        let payload = (0..<(streams * frameBytes)).map { UInt8(truncatingIfNeeded: ($0 &* 2654435761) >> 13) }
+        var scratch = [Int16](repeating: 0, count: frameBytes)
+        var output = [Int16](repeating: 0, count: frameBytes)
+
+        // Per-stream: decode into scratch, copy into the stream's ring as frames arrive
+        let rings = (0..<streams).map { _ in CircularAudioBuffer(capacity: 4096) }
+        let perStreamStart = Date()
+        payload.withUnsafeBufferPointer { bytes in
+            for _ in 0..<quanta {
+                for stream in 0..<streams {
+                    scratch.withUnsafeMutableBufferPointer { pcm in
+                        g711_alaw_decode(bytes.baseAddress! + stream * frameBytes, pcm.baseAddress!, frameBytes)
+                        _ = rings[stream].write(from: pcm.baseAddress!, count: frameBytes)
+                    }
+                    output.withUnsafeMutableBufferPointer {
+                        _ = rings[stream].read(into: $0.baseAddress!, count: frameBytes)
+                    }
+                }
+            }
+        }
+        let perStream = Date().timeIntervalSince(perStreamStart)
+
+        // Batched: stage the quantum, one decode pass into the rings
+        let decoder = try makeDecoder(streams: streams, frameBytes: frameBytes)
+        defer { batch_decoder_destroy(decoder) }
+        let batchedStart = Date()
+        payload.withUnsafeBufferPointer { bytes in
+            for _ in 0..<quanta {
+                for stream in 0..<streams {
+                    batch_decoder_submit(decoder, UInt32(stream), bytes.baseAddress! + stream * frameBytes, UInt32(frameBytes))
+                }
+                batch_decoder_run(decoder)
+                output.withUnsafeMutableBufferPointer { pcm in
+                    for stream in 0..<streams {
+                        _ = batch_decoder_read(decoder, UInt32(stream), pcm.baseAddress!, UInt32(frameBytes))
+                    }
+                }
+            }
+        }
+        let batched = Date().timeIntervalSince(batchedStart)
+
+        let frames = Double(streams * quanta)
+        let perStreamPerCore = 1.0 / (perStream / frames * framesPerSecond)
+        let batchedPerCore = 1.0 / (batched / frames * framesPerSecond)
+        print("⏱️ Streams per core: per-stream \(Int(perStreamPerCore)), batched \(Int(batchedPerCore)) "
+              + "(×\(String(format: "%.2f", perStream / batched)))")
+
+        XCTAssertLessThan(batched, perStream)
+    }
+}
@@ -0,0 +1,233 @@
+//
+//  BiquadFilterTests.swift
+//  VeepaAudioTestTests
+//
+//  Clean-up presets: the hum notch removes 50 Hz and its harmonics while
+//  speech frequencies pass, the high-pass has its corner where it says,
+//  the DC blocker removes offset, four-stream batches match filtering each
+//  stream alone bit for bit, and the bridge filters decoded frames. The
+//  cost test prints ns per sample per section for both modes.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class BiquadFilterTests: RealtimeSafeTestCase {
+
+    /// Steady-state gain of a preset at `frequency`, in dB
+    private func responseDb(_ preset: biquad_preset, frequency: Double, sampleRate: Int = 16000,
+                            offset: Double = 0) -> Double {
+        var cascade = biquad_cascade()
+        XCTAssertEqual(biquad_preset_init(&cascade, preset, UInt32(sampleRate)), 0)
+        var state = biquad_state()
+
+        let amplitude = 8000.0
+        var pcm = (0..<(sampleRate * 2)).map {
+            Int16((offset + amplitude * sin(2 * Double.pi * frequency * Double($0) / Double(sampleRate))).rounded())
+        }
+        biquad_process_s16(&cascade, &state, &pcm, pcm.count)
+
+        // Skip the first second: the notches ring in for a few hundred ms
+        let tail = pcm[sampleRate...].map(Double.init)
+        let rms = sqrt(tail.reduce(0) { $0 + $1 * $1 } / Double(tail.count))
+        let reference = offset == 0 ? amplitude / 2.squareRoot() : abs(offset)
+        return 20 * log10(max(rms, 0.5) / reference)
+    }
+
+    private func noise(_ count: Int, seed: UInt64) -> [Int16] {
+        var state = seed
+        return (0..<count).map { _ in
+            state = state &* 6364136223846793005 &+ 1442695040888963407
+            return Int16(truncatingIfNeeded: Int64(bitPattern: state) >> 50)
+        }
+    }
+
+    // MARK: - Presets
+
+    func testHumNotchRemovesMainsAndHarmonics() {
+        for (preset, mains) in [(BIQUAD_PRESET_HUM_50, 50.0), (BIQUAD_PRESET_HUM_60, 60.0)] {
+            for harmonic in 1...3 {
+                XCTAssertLessThan(responseDb(preset, frequency: mains * Double(harmonic)), -40,
+                                  "\(mains) Hz harmonic \(harmonic)")
+            }
+            for voice in [300.0, 1000.0, 3000.0] {
+                XCTAssertEqual(responseDb(preset, frequency: voice), 0, accuracy: 0.5, "\(voice) Hz passes")
+            }
+        }
+    }
+
+    func testHighPassCorners() {
+        for rate in [8000, 16000] {
+            XCTAssertEqual(responseDb(BIQUAD_PRESET_HIGHPASS_80, frequency: 80, sampleRate: rate), -3, accuracy: 0.3)
+            XCTAssertEqual(responseDb(BIQUAD_PRESET_HIGHPASS_120, frequency: 120, sampleRate: rate), -3, accuracy: 0.3)
+            XCTAssertLessThan(responseDb(BIQUAD_PRESET_HIGHPASS_80, frequency: 40, sampleRate: rate), -20,
+                              "Fourth order: 24 dB per octave")
+            XCTAssertEqual(responseDb(BIQUAD_PRESET_HIGHPASS_120, frequency: 1000, sampleRate: rate), 0, accuracy: 0.2)
+        }
+    }
+
+    func testDcBlockerRemovesOffset() {
+        XCTAssertLessThan(responseDb(BIQUAD_PRESET_DC_BLOCK, frequency: 0, offset: 3000), -60)
+        XCTAssertEqual(responseDb(BIQUAD_PRESET_DC_BLOCK, frequency: 100), 0, accuracy: 0.2)
+    }
+
+    func testPresetNames() {
+        XCTAssertEqual(AudioFilterBank.Preset.off.name, "off")
+        XCTAssertEqual(AudioFilterBank.Preset.hum60.name, "60 Hz hum notch")
+        XCTAssertNotEqual(biquad_preset_init(nil, BIQUAD_PRESET_HUM_50, 16000), 0)
+        var cascade = biquad_cascade()
+        XCTAssertNotEqual(biquad_preset_init(&cascade, BIQUAD_PRESET_COUNT, 16000), 0)
+    }
+
+    // MARK: - Batch
+
+    func testBatchMatchesSingleStream() {
+        var cascade = biquad_cascade()
+        XCTAssertEqual(biquad_preset_init(&cascade, BIQUAD_PRESET_HUM_50, 8000), 0)
+
+        let inputs = (0..<4).map { noise(1000, seed: UInt64($0) + 1) }
+        var expected = inputs
+        var expectedStates = [biquad_state](repeating: biquad_state(), count: 4)
+        for lane in 0..<4 {
+            // Two frames, so the state carried between calls is compared too
+            expected[lane].withUnsafeMutableBufferPointer {
+                biquad_process_s16(&cascade, &expectedStates[lane], $0.baseAddress!, 333)
+                biquad_process_s16(&cascade, &expectedStates[lane], $0.baseAddress! + 333, 667)
+            }
+        }
+
+        // Lane 2 left empty: NULL lanes are skipped
+        var outputs = inputs
+        var states = [biquad_state](repeating: biquad_state(), count: 4)
+        for (start, length) in [(0, 333), (333, 667)] {
+            states.withUnsafeMutableBufferPointer { states in
+                outputs[0].withUnsafeMutableBufferPointer { a in
+                outputs[1].withUnsafeMutableBufferPointer { b in
+                outputs[3].withUnsafeMutableBufferPointer { d in
+                    let base = states.baseAddress!
+                    var statePointers: [UnsafeMutablePointer<biquad_state>?] = [base, base + 1, nil, base + 3]
+                    var pcmPointers: [UnsafeMutablePointer<Int16>?] = [
+                        a.baseAddress! + start, b.baseAddress! + start, nil, d.baseAddress! + start]
+                    biquad_process_s16_batch(&cascade, &statePointers, &pcmPointers, length)
+                }}}
+            }
+        }
+
+        for lane in [0, 1, 3] {
+            XCTAssertEqual(outputs[lane], expected[lane], "lane \(lane)")
+            XCTAssertEqual(withUnsafeBytes(of: states[lane]) { Array($0) },
+                           withUnsafeBytes(of: expectedStates[lane]) { Array($0) }, "lane \(lane) state")
+        }
+        XCTAssertEqual(outputs[2], inputs[2])
+    }
+
+    func testBankJobsMatchPerSlotProcessing() throws {
+        let presets: [AudioFilterBank.Preset] = [.hum50, .hum50, .off, .highPass80, .hum50,
+                                                 .hum50, .hum50, .dcBlock, .highPass80, .off]
+        let single = try AudioFilterBank(capacity: presets.count)
+        let batched = try AudioFilterBank(capacity: presets.count)
+        for (slot, preset) in presets.enumerated() {
+            single[session_slot(slot)] = preset
+            batched[session_slot(slot)] = preset
+        }
+
+        var expected = (0..<presets.count).map { noise(320, seed: UInt64($0) + 11) }
+        var frames = expected
+        for _ in 0..<3 {
+            for slot in presets.indices {
+                single.process(slot: session_slot(slot), samples: &expected[slot], count: 320, sampleRate: 16000)
+            }
+
+            let pointers = frames.indices.map { slot -> UnsafeMutablePointer<Int16> in
+                let pointer = UnsafeMutablePointer<Int16>.allocate(capacity: 320)
+                pointer.initialize(from: frames[slot], count: 320)
+                return pointer
+            }
+            let jobs = pointers.enumerated().map { filter_bank_job(slot: UInt32($0.offset), pcm: $0.element) }
+            XCTAssertEqual(batched.process(jobs: jobs, count: 320, sampleRate: 16000), 8)
+            for slot in frames.indices {
+                frames[slot] = Array(UnsafeBufferPointer(start: pointers[slot], count: 320))
+                pointers[slot].deallocate()
+            }
+        }
+        XCTAssertEqual(frames, expected)
+    }
+
+    // MARK: - Cost
+
+    func testFilterCost() throws {
+        let bank = try AudioFilterBank(capacity: 4)
+        let frameSamples = 320
+        var frames = (0..<4).map { noise(frameSamples, seed: UInt64($0) + 21) }
+        let iterations = 5_000
+
+        for preset in AudioFilterBank.Preset.allCases where preset != .off {
+            var cascade = biquad_cascade()
+            XCTAssertEqual(biquad_preset_init(&cascade, preset.cValue, 16000), 0)
+            let sections = Double(cascade.sections)
+            for slot in 0..<4 { bank[session_slot(slot)] = preset }
+
+            var start = DispatchTime.now().uptimeNanoseconds
+            for _ in 0..<iterations {
+                bank.process(slot: 0, samples: &frames[0], count: frameSamples, sampleRate: 16000)
+            }
+            let singleNs = Double(DispatchTime.now().uptimeNanoseconds - start) / Double(iterations * frameSamples) / sections
+
+            let batchNs: Double = frames.withUnsafeMutableBufferPointer { frames in
+                frames[0].withUnsafeMutableBufferPointer { a in
+                frames[1].withUnsafeMutableBufferPointer { b in
+                frames[2].withUnsafeMutableBufferPointer { c in
+                frames[3].withUnsafeMutableBufferPointer { d in
+                    let jobs = [a, b, c, d].enumerated().map { filter_bank_job(slot: UInt32($0.offset), pcm: $0.element.baseAddress!) }
+                    start = DispatchTime.now().uptimeNanoseconds
+                    for _ in 0..<iterations {
+                        bank.process(jobs: jobs, count: frameSamples, sampleRate: 16000)
+                    }
+                    return Double(DispatchTime.now().uptimeNanoseconds - start) / Double(iterations * frameSamples * 4) / sections
+                }}}}
+            }
+
+            print(String(format: "[BiquadFilterTests] %@: %.0f sections, %.2f ns per sample per section (%.2f batched)",
+                         preset.name, sections, singleNs, batchNs))
+            XCTAssertLessThan(singleNs, 10, preset.name)
+            XCTAssertLessThan(batchNs, 10, preset.name)
+        }
+    }
+
+    // MARK: - Bridge
+
+    func testBridgeFiltersDecodedFrames() throws {
+        let bridge = AudioHookBridge.shared
+        let filters = try XCTUnwrap(AudioFilterBank.bridge)
+        let slot = bridge.sdkSessionSlot
+        let previous = filters[slot]
+        filters[slot] = .hum50
+        filters.resetSession(slot)
+        defer { filters[slot] = previous }
+
+        var peak: Int16 = 0
+        var frames = 0
+        let token = bridge.addDecodedFrameObserver { samples, count, _, _ in
+            guard let samples = samples else { return }
+            frames += 1
+            if frames > 25 {
+                peak = max(peak, UnsafeBufferPointer(start: samples, count: Int(count)).map { abs($0) }.max() ?? 0)
+            }
+        }
+        defer { bridge.removeDecodedFrameObserver(token) }
+
+        var configuration = CameraEmulator.Configuration()
+        configuration.frameSamples = 320
+        configuration.toneFrequency = 50
+        configuration.amplitude = 0.3
+        let emulator = CameraEmulator(configuration: configuration)
+        for _ in 0..<100 {
+            let frame = emulator.nextFrame()
+            frame.payload.withUnsafeBufferPointer {
+                bridge.injectAlawFrame($0.baseAddress!, length: $0.count, frameNo: frame.frameNo, timestamp: frame.timestamp)
+            }
+        }
+        XCTAssertEqual(frames, 100)
+        XCTAssertLessThan(Int(peak), Int(0.3 * Double(Int16.max) * 0.05), "50 Hz hum down by more than 25 dB")
+    }
+}
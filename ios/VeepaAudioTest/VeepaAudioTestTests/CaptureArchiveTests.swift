@@ -0,0 +1,81 @@
+//
+//  CaptureArchiveTests.swift
+//  VeepaAudioTestTests
+//
+//  G.711 kernel and capture archive format checks. On Apple silicon
+//  (device or simulator) this exercises the NEON decode path.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class CaptureArchiveTests: XCTestCase {
+
+    func testVectorDecodeMatchesTable() {
+        // Every code, at every alignment, with a tail that is not a multiple of 16
+        let codes = (0..<(256 * 3 + 7)).map { UInt8(truncatingIfNeeded: $0 &* 37) }
+        var pcm = [Int16](repeating: 0, count: codes.count)
+        g711_alaw_decode(codes, &pcm, codes.count)
+
+        let table = withUnsafeBytes(of: g711_alaw_to_linear) { Array($0.bindMemory(to: Int16.self)) }
+        for (i, code) in codes.enumerated() {
+            XCTAssertEqual(pcm[i], table[Int(code)], "Code 0x\(String(code, radix: 16)) at index \(i)")
+        }
+    }
+
+    func testEncodeRoundTripsTableValues() {
+        let table = withUnsafeBytes(of: g711_alaw_to_linear) { Array($0.bindMemory(to: Int16.self)) }
+        for code in 0..<256 {
+            let value = table[code]
+            XCTAssertEqual(table[Int(g711_alaw_encode_sample(value))], value)
+        }
+    }
+
+    func testSegmentRoundTripAndAnalysis() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("roundtrip-\(UUID().uuidString).vaca")
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        let fd = open(url.path, O_RDWR | O_CREAT | O_TRUNC, 0o644)
+        XCTAssertGreaterThanOrEqual(fd, 0)
+        defer { close(fd) }
+
+        // 10 silent frames, then tone; frame 30 lost, frame 40 repeated
+        let emulator = CameraEmulator(configuration: CameraEmulator.Configuration(leadingSilentFrames: 10))
+        XCTAssertEqual(capture_archive_write_header(fd, 16000, 0), Int32(CAPTURE_ARCHIVE_OK))
+        for _ in 1...50 {
+            let frame = emulator.nextFrame()
+            if frame.frameNo == 30 { continue }
+            let copies = frame.frameNo == 40 ? 2 : 1
+            for _ in 0..<copies {
+                XCTAssertEqual(
+                    capture_archive_append(fd, frame.frameNo, frame.timestamp, frame.payload, UInt16(frame.payload.count)),
+                    Int32(CAPTURE_ARCHIVE_OK)
+                )
+            }
+        }
+
+        let data = try Data(contentsOf: url)
+        let (status, stats) = data.withUnsafeBytes { bytes -> (Int32, capture_archive_stats) in
+            var frames: UInt64 = 0
+            var samples: UInt64 = 0
+            capture_archive_scan(bytes.baseAddress, bytes.count, &frames, &samples)
+
+            var pcm = [Int16](repeating: 0, count: Int(samples))
+            var written = 0
+            var stats = capture_archive_stats()
+            capture_archive_stats_init(&stats, CAPTURE_ARCHIVE_SILENCE_DBFS)
+            let status = capture_archive_decode(bytes.baseAddress, bytes.count, &pcm, pcm.count, &written, &stats)
+            return (status, stats)
+        }
+
+        XCTAssertEqual(status, Int32(CAPTURE_ARCHIVE_OK))
+        XCTAssertEqual(stats.frames, 49)
+        XCTAssertEqual(stats.lost_frames, 1)
+        XCTAssertEqual(stats.duplicate_frames, 1)
+        XCTAssertEqual(stats.samples, 49 * 480)
+        XCTAssertEqual(stats.silent_windows, 10 * 480 / 320)
+
+        var total = stats
+        XCTAssertEqual(capture_archive_peak_dbfs(&total), 20 * log10(0.5), accuracy: 0.5)
+    }
+}
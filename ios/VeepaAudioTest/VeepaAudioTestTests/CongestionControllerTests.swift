@@ -0,0 +1,302 @@
+//
+//  CongestionControllerTests.swift
+//  VeepaAudioTestTests
+//
+//  Congestion adaptation: IMA ADPCM frames decode on their own from the
+//  header state, the bridge plays across a G.711a → ADPCM switch without a
+//  gap, the controller's hysteresis holds, and an emulated camera behind a
+//  bottleneck that drops from 128 to 60 kbit/s for a minute glitches less
+//  when it adapts than when it stays on G.711a.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class CongestionControllerTests: RealtimeSafeTestCase {
+
+    private func sine(count: Int, amplitude: Double = 0.5, period: Double = 18.2) -> [Int16] {
+        (0..<count).map { Int16(sin(2 * Double.pi * Double($0) / period) * amplitude * Double(Int16.max)) }
+    }
+
+    private func decode(_ frame: CameraEmulator.Frame) -> [Int16] {
+        var pcm = [Int16](repeating: 0, count: frame.samples)
+        if frame.codec == .adpcm {
+            var state = frame.adpcmState
+            ima_adpcm_decode(frame.payload, frame.payload.count, &state, &pcm)
+        } else {
+            g711_alaw_decode(frame.payload, &pcm, frame.payload.count)
+        }
+        return pcm
+    }
+
+    // MARK: - ADPCM
+
+    func testAdpcmRoundTripsAndFramesDecodeIndependently() {
+        let input = sine(count: 1600)
+        var encoder = ima_adpcm_state()
+        var adpcm = [UInt8](repeating: 0, count: 800)
+        XCTAssertEqual(ima_adpcm_encode(input, input.count, &encoder, &adpcm), 800)
+
+        var decoder = ima_adpcm_state()
+        var output = [Int16](repeating: 0, count: 1600)
+        ima_adpcm_decode(adpcm, adpcm.count, &decoder, &output)
+        XCTAssertEqual(decoder.predictor, encoder.predictor, "Decoder tracks the encoder exactly")
+        XCTAssertEqual(decoder.step_index, encoder.step_index)
+
+        // Skip the first 10 ms while the step size adapts
+        var signal = 0.0, noise = 0.0
+        for i in 80..<input.count {
+            signal += Double(input[i]) * Double(input[i])
+            noise += Double(Int(input[i]) - Int(output[i])) * Double(Int(input[i]) - Int(output[i]))
+        }
+        XCTAssertGreaterThan(10 * log10(signal / noise), 30, "4-bit ADPCM of a sine is well above 30 dB SNR")
+
+        // A frame decoded alone from its header state matches the continuous decode
+        var configuration = CameraEmulator.Configuration()
+        configuration.supportedCodecs = ["adpcm"]
+        let emulator = CameraEmulator(configuration: configuration)
+        let frames = (0..<4).map { _ in emulator.nextFrame() }
+        XCTAssertEqual(frames[2].payload.count, configuration.frameSamples / 2)
+
+        var continuous = ima_adpcm_state()
+        var expected = [Int16](repeating: 0, count: frames[2].samples)
+        for frame in frames[0...2] {
+            ima_adpcm_decode(frame.payload, frame.payload.count, &continuous, &expected)
+        }
+        XCTAssertEqual(decode(frames[2]), expected)
+    }
+
+    func testBridgePlaysAcrossACodecSwitch() throws {
+        let bridge = AudioHookBridge.shared
+        var configuration = CameraEmulator.Configuration()
+        configuration.sampleRate = 8000
+        configuration.frameSamples = 160
+        let emulator = CameraEmulator(configuration: configuration)
+
+        var decoded: [(count: UInt32, frameNo: UInt32)] = []
+        var last: Int16 = 0
+        var largestStep = 0
+        let token = bridge.addDecodedFrameObserver { samples, count, frameNo, _ in
+            guard let samples = samples else { return }
+            decoded.append((count, frameNo))
+            for i in 0..<Int(count) {
+                largestStep = max(largestStep, abs(Int(samples[i]) - Int(last)))
+                last = samples[i]
+            }
+        }
+        defer { bridge.removeDecodedFrameObserver(token) }
+
+        func inject(_ frame: CameraEmulator.Frame) {
+            frame.payload.withUnsafeBufferPointer { bytes in
+                if frame.codec == .adpcm {
+                    bridge.injectAdpcmFrame(bytes.baseAddress!, length: bytes.count, state: frame.adpcmState,
+                                            frameNo: frame.frameNo, timestamp: frame.timestamp)
+                } else {
+                    bridge.injectAlawFrame(bytes.baseAddress!, length: bytes.count,
+                                           frameNo: frame.frameNo, timestamp: frame.timestamp)
+                }
+            }
+        }
+
+        let before = bridge.frameActivity()
+        let g711 = (0..<5).map { _ in emulator.nextFrame() }
+        let switched = AudioParameterNegotiator.parseResponse(
+            emulator.handleCgi(AudioParameterNegotiator.Keys.applyCommand + "\(AudioParameterNegotiator.Keys.codec)=adpcm&"))
+        XCTAssertEqual(switched[AudioParameterNegotiator.Keys.result], "0")
+        let adpcm = (0..<5).map { _ in emulator.nextFrame() }
+        (g711 + adpcm).forEach(inject)
+
+        XCTAssertEqual(adpcm[0].payload.count, 80, "Half the bytes for the same 20 ms")
+        XCTAssertEqual(decoded.map { $0.frameNo }, (g711 + adpcm).map(\.frameNo))
+        XCTAssertTrue(decoded.allSatisfy { $0.count == 160 }, "Every frame decodes to 20 ms")
+        XCTAssertEqual(bridge.frameActivity().lostFrames, before.lostFrames, "Nothing dropped at the switch")
+
+        // A 440 Hz sine at half scale moves at most ~5.6k per 8 kHz sample;
+        // a gap or a desynchronised predictor would jump far more
+        XCTAssertLessThan(largestStep, 8000)
+    }
+
+    // MARK: - Hysteresis
+
+    private let ladder = [
+        AudioStreamParameters(codec: .g711a, sampleRate: 8000, frameMs: 20),
+        AudioStreamParameters(codec: .adpcm, sampleRate: 8000, frameMs: 20),
+        AudioStreamParameters(codec: .adpcm, sampleRate: 8000, frameMs: 40)
+    ]
+
+    func testLadderStepsThroughAdpcmToLongerFrames() {
+        let capabilities = AudioCapabilities(codecs: [.g711a, .adpcm], sampleRates: [8000],
+                                             frameMs: [10, 20, 40, 60, 80], current: nil)
+        XCTAssertEqual(CongestionController.ladder(from: capabilities, for: .standard), [
+            ladder[0], ladder[1], ladder[2],
+            AudioStreamParameters(codec: .adpcm, sampleRate: 8000, frameMs: 60)
+        ])
+        XCTAssertEqual(AudioStreamParameters(codec: .adpcm, sampleRate: 8000, frameMs: 20).frameBytes, 80)
+
+        // Neighbours always differ in payload size, or the decoder could not follow a step
+        for profile in PlayoutProfile.all {
+            let rungs = CongestionController.ladder(from: capabilities, for: profile, longerFrames: 4)
+            for (upper, lower) in zip(rungs, rungs.dropFirst()) {
+                XCTAssertNotEqual(upper.frameBytes, lower.frameBytes, "\(upper) → \(lower)")
+            }
+        }
+
+        // G.711a only: longer frames are the only way down
+        let legacy = AudioCapabilities(codecs: [.g711a], sampleRates: [8000], frameMs: [20, 40], current: nil)
+        XCTAssertEqual(CongestionController.ladder(from: legacy, for: .standard).map(\.frameMs), [20, 40])
+    }
+
+    func testHysteresisDwellAndBackoff() {
+        var configuration = CongestionController.Configuration()
+        configuration.recoverAfter = 4
+        let controller = CongestionController(ladder: ladder, configuration: configuration)
+
+        var statistics = CongestionController.Statistics(frames: 0, lostFrames: 0, jitterMs: 0)
+        var time = 0.0
+        /// One second of 50 frames, `lost` of them lost
+        func period(lost: UInt64 = 0, jitterMs: Double = 2) -> AudioStreamParameters? {
+            statistics.frames += 50 - lost
+            statistics.lostFrames += lost
+            statistics.jitterMs = jitterMs
+            time += 1
+            return controller.update(statistics, at: time)
+        }
+
+        XCTAssertNil(period())
+        XCTAssertNil(period())
+        XCTAssertNil(period(lost: 5), "One bad period is not enough")
+        XCTAssertNil(period())
+        XCTAssertNil(period(lost: 5))
+        XCTAssertEqual(period(lost: 5), ladder[1], "Two in a row step down")
+
+        // Still congested, but within the dwell time
+        XCTAssertNil(period(lost: 5))
+        XCTAssertNil(period(lost: 5))
+        XCTAssertEqual(period(jitterMs: 200), ladder[2], "Jitter alone counts as congestion")
+        XCTAssertNil(period(lost: 5), "Already at the cheapest rung")
+
+        // Fair periods (between the thresholds) reset the clean streak
+        for _ in 0..<3 { XCTAssertNil(period()) }
+        XCTAssertNil(period(lost: 1))
+        for _ in 0..<3 { XCTAssertNil(period()) }
+        XCTAssertEqual(period(), ladder[1], "Four clean periods step up")
+
+        // The step up fails at once: the next one needs twice the clean streak
+        XCTAssertNil(period(lost: 5))
+        XCTAssertNil(period(lost: 5))
+        XCTAssertEqual(period(lost: 5), ladder[2])
+        for _ in 0..<7 { XCTAssertNil(period()) }
+        XCTAssertEqual(period(), ladder[1])
+        XCTAssertEqual(controller.switches.down, 3)
+        XCTAssertEqual(controller.switches.up, 2)
+
+        // A stall (no frames at all) is congestion
+        let stalled = CongestionController.Statistics(frames: statistics.frames, lostFrames: statistics.lostFrames,
+                                                      jitterMs: 2)
+        XCTAssertEqual(controller.condition(from: statistics, to: stalled), .congested)
+    }
+
+    // MARK: - Benchmark
+
+    private struct Measurement {
+        let underflows: UInt64
+        let lostFrames: Int
+        let switches: (down: Int, up: Int)
+        let final: AudioStreamParameters
+    }
+
+    /// Two virtual minutes of an 8 kHz camera behind a 128 kbit/s link that
+    /// drops to 60 kbit/s from 30 s to 90 s, played through the standard profile
+    private func simulate(adaptive: Bool) async throws -> Measurement {
+        var configuration = CameraEmulator.Configuration()
+        configuration.sampleRate = 8000
+        configuration.frameSamples = 160
+        let emulator = CameraEmulator(configuration: configuration)
+        let negotiator = AudioParameterNegotiator(transport: emulator)
+        negotiator.willApply = { _ in }
+
+        let capabilities = try await negotiator.queryCapabilities()
+        let controller = CongestionController(ladder: CongestionController.ladder(from: capabilities, for: .standard),
+                                              configuration: .init(for: .standard))
+        XCTAssertEqual(controller.current, capabilities.current)
+
+        let profile = PlayoutProfile.standard
+        let playout = PlayoutController(profile: profile)
+        playout.configure(sampleRate: 8000, frameSamples: 160)
+        let ring = CircularAudioBuffer(capacity: 16000)
+        let blockMs = Int(profile.ioBufferDuration * 1000)
+        let blockSamples = 8000 * blockMs / 1000
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: blockSamples)
+        defer { output.deallocate() }
+
+        var link = CameraEmulator.Link(bitsPerSecond: 128_000)
+        var inFlight: [(arrivalMs: Double, frame: CameraEmulator.Frame)] = []
+        var nextSendMs = 0.0
+
+        // What SessionTable would count for the session
+        var statistics = CongestionController.Statistics(frames: 0, lostFrames: 0, jitterMs: 0)
+        var lastFrameNo: UInt32?
+        var lastTransitMs: Double?
+
+        for now in 0..<120_000 {
+            link.bitsPerSecond = (30_000..<90_000).contains(now) ? 60_000 : 128_000
+
+            while nextSendMs <= Double(now) {
+                let frame = emulator.nextFrame()
+                if let arrival = link.send(bytes: frame.payload.count, at: nextSendMs) {
+                    inFlight.append((arrival, frame))
+                }
+                nextSendMs += emulator.frameDuration * 1000
+            }
+
+            while let first = inFlight.first, first.arrivalMs <= Double(now) {
+                inFlight.removeFirst()
+                let frame = first.frame
+                if let last = lastFrameNo {
+                    statistics.lostFrames += UInt64(frame.frameNo &- last &- 1)
+                }
+                lastFrameNo = frame.frameNo
+                statistics.frames += 1
+
+                // RFC 3550 interarrival jitter
+                let transit = first.arrivalMs - Double(frame.timestamp)
+                if let previous = lastTransitMs {
+                    statistics.jitterMs += (abs(transit - previous) - statistics.jitterMs) / 16
+                }
+                lastTransitMs = transit
+
+                ring.write(from: decode(frame))
+            }
+
+            if adaptive && now % 1000 == 0,
+               let parameters = controller.update(statistics, at: Double(now) / 1000) {
+                try await negotiator.apply(parameters, verify: false)
+                playout.configure(sampleRate: parameters.sampleRate, frameSamples: parameters.frameSamples)
+            }
+
+            if now % blockMs == 0 {
+                _ = playout.render(into: output, count: blockSamples, from: ring)
+            }
+        }
+
+        return Measurement(underflows: playout.statistics.underflows, lostFrames: Int(statistics.lostFrames),
+                           switches: controller.switches, final: controller.current)
+    }
+
+    func testAdaptationCutsGlitchesUnderConstrainedBandwidth() async throws {
+        let fixed = try await simulate(adaptive: false)
+        let adaptive = try await simulate(adaptive: true)
+        for (name, result) in [("fixed G.711a", fixed), ("adaptive", adaptive)] {
+            print("📶 \(name): \(result.underflows) underflows, \(result.lostFrames) frames lost, "
+                  + "\(result.switches.down) down / \(result.switches.up) up, ends on \(result.final)")
+        }
+
+        XCTAssertGreaterThan(fixed.lostFrames, 500, "83 kbit/s of G.711a cannot fit through 60 kbit/s")
+        XCTAssertGreaterThan(adaptive.switches.down, 0)
+        XCTAssertGreaterThan(adaptive.switches.up, 0)
+        XCTAssertLessThan(adaptive.switches.down, 6, "Backoff keeps probing rare")
+        XCTAssertEqual(adaptive.final.codec, .g711a, "Back on G.711a once the link recovers")
+        XCTAssertLessThan(adaptive.lostFrames * 4, fixed.lostFrames)
+        XCTAssertLessThan(adaptive.underflows * 2, fixed.underflows)
+    }
+}
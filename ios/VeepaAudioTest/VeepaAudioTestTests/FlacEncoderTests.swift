@@ -0,0 +1,100 @@
+//
+//  FlacEncoderTests.swift
+//  VeepaAudioTestTests
+//
+//  Lossless round trip of the FLAC recorder format through Apple's own
+//  FLAC decoder (AVAudioFile), plus the compression target on camera-like
+//  audio: long stretches of near-silence with occasional speech.
+//
+
+import AVFoundation
+import XCTest
+@testable import VeepaAudioTest
+
+final class FlacEncoderTests: RealtimeSafeTestCase {
+
+    /// ~30 s at 16 kHz: quiet noise floor, one second of tone every six,
+    /// and a length that leaves a short final block
+    private func cameraLikeSamples() -> [Int16] {
+        var generator = SystemRandomNumberGenerator()
+        return (0..<(16000 * 30 + 123)).map { i in
+            let t = Double(i) / 16000
+            var value = Double(Int.random(in: -8...8, using: &generator))
+            if Int(t) % 6 == 0 {
+                value += 6000 * sin(2 * .pi * 180 * t) * sin(2 * .pi * 3 * t)
+            }
+            return Int16(value)
+        }
+    }
+
+    private func decode(_ url: URL) throws -> [Int16] {
+        let file = try AVAudioFile(forReading: url, commonFormat: .pcmFormatInt16, interleaved: true)
+        let buffer = try XCTUnwrap(AVAudioPCMBuffer(pcmFormat: file.processingFormat, frameCapacity: AVAudioFrameCount(file.length)))
+        try file.read(into: buffer)
+        let channel = try XCTUnwrap(buffer.int16ChannelData)
+        return Array(UnsafeBufferPointer(start: channel[0], count: Int(buffer.frameLength)))
+    }
+
+    func testEncodedFileDecodesBitExact() throws {
+        let samples = cameraLikeSamples()
+        let encoder = FlacBlockEncoder(sampleRate: 16000)
+        let file = samples.withUnsafeBufferPointer { encoder.encodeFile($0) }
+
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("roundtrip-\(UUID().uuidString).flac")
+        defer { try? FileManager.default.removeItem(at: url) }
+        try file.write(to: url)
+
+        XCTAssertEqual(try decode(url), samples)
+
+        let ratio = Double(samples.count * 2) / Double(file.count)
+        print(String(format: "[FlacEncoderTests] Compression %.2fx", ratio))
+        XCTAssertGreaterThan(ratio, 2.0, "Mostly-quiet camera audio should compress at least 2x")
+    }
+
+    func testRecorderStreamsChunksAndFinalizesHeader() throws {
+        let samples = cameraLikeSamples()
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("recorder-\(UUID().uuidString).flac")
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        // Feed 480-sample frames like the capture path does
+        let recorder = try DecodedAudioRecorder(url: url, format: .flac, sampleRate: 16000)
+        samples.withUnsafeBufferPointer { all in
+            for start in stride(from: 0, to: all.count, by: 480) {
+                recorder.append(all.baseAddress! + start, count: min(480, all.count - start))
+            }
+        }
+
+        let finished = expectation(description: "recording finished")
+        var summary: DecodedAudioRecorder.Summary?
+        recorder.finish { summary = $0; finished.fulfill() }
+        wait(for: [finished], timeout: 10)
+
+        XCTAssertNil(summary?.error)
+        XCTAssertEqual(summary?.samples, UInt64(samples.count))
+        XCTAssertEqual(try decode(url), samples)
+    }
+
+    func testEncodeSpeedPerCore() {
+        let samples = cameraLikeSamples()
+        var config = flac_encoder_config()
+        flac_encoder_config_init(&config, 16000)
+        let capacity = flac_frame_capacity(config.block_size)
+        var out = [UInt8](repeating: 0, count: capacity)
+
+        // Single thread, so this is the per-core rate
+        let start = DispatchTime.now().uptimeNanoseconds
+        samples.withUnsafeBufferPointer { pcm in
+            var frame: UInt32 = 0
+            for offset in stride(from: 0, to: pcm.count, by: Int(config.block_size)) {
+                let count = min(Int(config.block_size), pcm.count - offset)
+                _ = flac_encode_frame(&config, pcm.baseAddress! + offset, UInt32(count), frame, &out, capacity)
+                frame += 1
+            }
+        }
+        let seconds = Double(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000_000
+        let realtime = (Double(samples.count) / 16000) / seconds
+
+        print(String(format: "[FlacEncoderTests] Encode speed %.0fx realtime per core", realtime))
+        XCTAssertGreaterThan(realtime, 100)
+    }
+}
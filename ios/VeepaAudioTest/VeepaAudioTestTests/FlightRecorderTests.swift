@@ -0,0 +1,150 @@
+//
+//  FlightRecorderTests.swift
+//  VeepaAudioTestTests
+//
+//  Flight recorder: recording is real-time safe, the rings keep the most
+//  recent history, bursts and cooldown gate the triggers, and a dump writes
+//  a bundle the archive tooling can read back.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class FlightRecorderTests: RealtimeSafeTestCase {
+
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        directory = FileManager.default.temporaryDirectory
+            .appendingPathComponent("FlightRecorderTests-\(UUID().uuidString)", isDirectory: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: directory)
+        super.tearDown()
+    }
+
+    private func makeRecorder(seconds: Int = 2) throws -> FlightRecorder {
+        var configuration = FlightRecorder.Configuration()
+        configuration.seconds = seconds
+        configuration.burstUnderflows = 3
+        configuration.burstWindow = 5
+        configuration.cooldown = 60
+        configuration.directory = directory
+        return try FlightRecorder(name: "test", sampleRate: 8000, configuration: configuration)
+    }
+
+    /// Record `count` 20 ms frames at 8 kHz (payload bytes and samples = frame number)
+    private func record(_ recorder: FlightRecorder, frames count: Int, from first: Int = 0) {
+        var payload = [UInt8](repeating: 0, count: 160)
+        var samples = [Int16](repeating: 0, count: 160)
+        RealtimeSanitizer.realtime {
+            for frameNo in first..<(first + count) {
+                for index in 0..<160 {
+                    payload[index] = UInt8(truncatingIfNeeded: frameNo)
+                    samples[index] = Int16(truncatingIfNeeded: frameNo)
+                }
+                recorder.recordFrame(payload, length: 160, frameNo: UInt32(frameNo), timestamp: UInt32(frameNo * 20))
+                recorder.recordSamples(samples, count: 160)
+            }
+        }
+    }
+
+    // MARK: - Rings
+
+    func testRingsKeepTheMostRecentHistory() throws {
+        let recorder = try makeRecorder(seconds: 1)
+        record(recorder, frames: 1000)
+
+        let capacity = flight_recorder_get_capacity(recorder.recorder)
+        var frames = [flight_recorder_frame](repeating: flight_recorder_frame(), count: Int(capacity.frames))
+        var payload = [UInt8](repeating: 0, count: Int(capacity.payload_bytes))
+        var used: UInt32 = 0
+        let count = Int(flight_recorder_copy_frames(recorder.recorder, 0, &frames, capacity.frames,
+                                                    &payload, capacity.payload_bytes, &used))
+
+        // 16384 payload bytes hold the last 102 frames, the index 128 entries
+        XCTAssertEqual(count, Int(capacity.payload_bytes) / 160)
+        XCTAssertEqual(frames[count - 1].frame_no, 999)
+        XCTAssertEqual(Int(used), count * 160)
+        for frame in frames.prefix(count) {
+            XCTAssertEqual(payload[Int(frame.offset)], UInt8(truncatingIfNeeded: frame.frame_no))
+        }
+
+        var samples = [Int16](repeating: 0, count: Int(capacity.pcm_samples))
+        var endNs: UInt64 = 0
+        let sampleCount = Int(flight_recorder_copy_pcm(recorder.recorder, &samples, capacity.pcm_samples, &endNs))
+        XCTAssertEqual(sampleCount, Int(capacity.pcm_samples))
+        XCTAssertEqual(samples[sampleCount - 1], 999)
+        XCTAssertGreaterThan(endNs, 0)
+        XCTAssertEqual(flight_recorder_frames_recorded(recorder.recorder), 1000)
+    }
+
+    // MARK: - Triggers
+
+    func testUnderflowBurstTriggersOnceWithinCooldown() throws {
+        let recorder = try makeRecorder()
+        let dumped = expectation(description: "dump")
+        recorder.onDump = { result in
+            if case .success(let bundle) = result, case .underflowBurst(let count, _) = bundle.trigger {
+                XCTAssertEqual(count, 3)
+                dumped.fulfill()
+            }
+        }
+
+        let start = Date()
+        XCTAssertFalse(recorder.noteUnderflows(total: 10, at: start))
+        XCTAssertFalse(recorder.noteUnderflows(total: 12, at: start + 1))
+        XCTAssertFalse(recorder.noteUnderflows(total: 12, at: start + 7), "Older underflows left the window")
+        XCTAssertTrue(recorder.noteUnderflows(total: 15, at: start + 8))
+        wait(for: [dumped], timeout: 5)
+
+        XCTAssertFalse(recorder.noteUnderflows(total: 30, at: start + 9), "Cooldown")
+        XCTAssertFalse(recorder.trigger(.engineRestart(attempt: 1), at: start + 20), "Cooldown")
+
+        let manual = expectation(description: "manual dump")
+        recorder.onDump = { result in
+            if case .success(let bundle) = result, case .manual = bundle.trigger {
+                manual.fulfill()
+            }
+        }
+        XCTAssertTrue(recorder.trigger(.manual(reason: "test"), at: start + 70))
+        wait(for: [manual], timeout: 5)
+    }
+
+    // MARK: - Dump
+
+    func testDumpWritesASelfContainedBundle() throws {
+        let recorder = try makeRecorder()
+        record(recorder, frames: 50)
+        pipeline_trace_instant(PIPELINE_TRACE_UNDERFLOW, 0, 160)
+
+        let bundle = try recorder.dump(.manual(reason: "test"))
+        XCTAssertEqual(bundle.frames, 50)
+        XCTAssertEqual(bundle.samples, 50 * 160)
+        XCTAssertGreaterThan(bundle.events, 0)
+
+        let archive = try Data(contentsOf: bundle.url.appendingPathComponent("frames.vaca"))
+        var frames: UInt64 = 0
+        var samples: UInt64 = 0
+        archive.withUnsafeBytes { capture_archive_scan($0.baseAddress!, archive.count, &frames, &samples) }
+        XCTAssertEqual(frames, 50)
+        XCTAssertEqual(samples, 50 * 160)
+
+        let wav = try Data(contentsOf: bundle.url.appendingPathComponent("decoded.wav"))
+        XCTAssertEqual(wav.count, Int(WAV_HEADER_SIZE) + 50 * 160 * 2)
+
+        let events = try Data(contentsOf: bundle.url.appendingPathComponent("events.json"))
+        let trace = try XCTUnwrap(JSONSerialization.jsonObject(with: events) as? [String: Any])
+        let traceEvents = try XCTUnwrap(trace["traceEvents"] as? [[String: Any]])
+        XCTAssertTrue(traceEvents.contains { $0["name"] as? String == "underflow" })
+
+        let manifestData = try Data(contentsOf: bundle.url.appendingPathComponent("manifest.json"))
+        let manifest = try XCTUnwrap(JSONSerialization.jsonObject(with: manifestData) as? [String: Any])
+        XCTAssertEqual(manifest["trigger"] as? String, "manual")
+        XCTAssertEqual(manifest["sampleRate"] as? Int, 8000)
+        XCTAssertEqual(manifest["firstFrameNo"] as? Int, 0)
+        XCTAssertEqual(manifest["lastFrameNo"] as? Int, 49)
+    }
+}
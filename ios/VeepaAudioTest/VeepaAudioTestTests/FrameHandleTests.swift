@@ -0,0 +1,189 @@
+//
+//  FrameHandleTests.swift
+//  VeepaAudioTestTests
+//
+//  Pooled frame handles: consumers share one payload, buffers go back to the
+//  pool when the last handle goes away, and fan-out beats per-consumer copies.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class FrameHandleTests: RealtimeSafeTestCase {
+
+    /// Stand-ins for recorder, relay, analytics and playback
+    private final class Consumer {
+        var kept: [FrameReference] = []
+        var checksum = 0
+
+        func take(_ frame: borrowing FrameHandle) {
+            checksum &+= Int(frame.bytes[0]) &+ frame.count
+            kept.append(frame.share().escape())
+        }
+
+        func drain() {
+            for reference in kept {
+                let frame = FrameHandle(adopting: reference)
+                checksum &+= Int(frame.frameNo)
+            }
+            kept.removeAll()
+        }
+    }
+
+    // MARK: - Sharing
+
+    func testConsumersShareOnePayload() throws {
+        let pool = try FramePool(smallBuffers: 4, largeBuffers: 0)
+        let payload = [UInt8](repeating: 0x55, count: 320)
+
+        let frame = try pool.copy(payload, frameNo: 7, timestampMs: 210)
+        for _ in 0..<3 {
+            _ = frame.share()  // Taken and dropped
+        }
+
+        let second = frame.share()
+        let sharedStorage = second.storage == frame.storage
+        let frameNo = second.frameNo
+        let timestampMs = second.timestampMs
+        let bytes = Array(second.bytes)
+        XCTAssertTrue(sharedStorage)
+        XCTAssertEqual(frameNo, 7)
+        XCTAssertEqual(timestampMs, 210)
+        XCTAssertEqual(bytes, payload)
+        XCTAssertEqual(pool.stats.acquired, 1, "Sharing must not copy")
+        XCTAssertEqual(pool.stats.outstanding, 1)
+    }
+
+    func testBufferReturnsWhenLastHandleGoes() throws {
+        let pool = try FramePool(smallBuffers: 2, largeBuffers: 0)
+        let consumers = (0..<4).map { _ in Consumer() }
+        let payload = [UInt8](repeating: 0xD5, count: 160)
+
+        do {
+            let frame = try pool.copy(payload, frameNo: 1, timestampMs: 0)
+            for consumer in consumers {
+                consumer.take(frame)
+            }
+        }
+        XCTAssertEqual(pool.stats.outstanding, 1, "Held by the consumers after the producer let go")
+
+        for consumer in consumers {
+            consumer.drain()
+        }
+        XCTAssertEqual(pool.stats.outstanding, 0)
+        XCTAssertEqual(pool.stats.returned, 1)
+    }
+
+    func testHandleCrossesQueues() throws {
+        let pool = try FramePool(smallBuffers: 8, largeBuffers: 0)
+        let payload = [UInt8](repeating: 0x2A, count: 640)
+        let queue = DispatchQueue(label: "frame-handle-test")
+        let done = expectation(description: "received")
+
+        let frame = try pool.copy(payload, frameNo: 3, timestampMs: 90)
+        let reference = frame.escape()
+        queue.async {
+            let received = FrameHandle(adopting: reference)
+            let frameNo = received.frameNo
+            let last = received.bytes.last
+            XCTAssertEqual(frameNo, 3)
+            XCTAssertEqual(last, 0x2A)
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 2)
+        queue.sync {}
+        XCTAssertEqual(pool.stats.outstanding, 0)
+    }
+
+    // MARK: - Limits
+
+    func testExhaustionAndSizeClasses() throws {
+        let pool = try FramePool(smallBuffers: 1, largeBuffers: 1, largeBytes: 1280)
+        let small = [UInt8](repeating: 1, count: 160)
+        let large = [UInt8](repeating: 2, count: 1280)
+
+        let first = try pool.copy(small, frameNo: 1, timestampMs: 0)
+        // The small class is empty, so this spills into the large one
+        let second = try pool.copy(small, frameNo: 2, timestampMs: 0)
+        let distinct = first.storage != second.storage
+        XCTAssertTrue(distinct)
+
+        XCTAssertThrowsError(try pool.copy(large, frameNo: 3, timestampMs: 0)) {
+            guard case FramePool.PoolError.exhausted = $0 else { return XCTFail("\($0)") }
+        }
+        let oversized = [UInt8](repeating: 3, count: 2000)
+        XCTAssertThrowsError(try pool.copy(oversized, frameNo: 4, timestampMs: 0)) {
+            guard case FramePool.PoolError.tooLarge(2000) = $0 else { return XCTFail("\($0)") }
+        }
+        XCTAssertEqual(pool.stats.exhausted, 1)
+        XCTAssertEqual(pool.stats.peak_outstanding, 2)
+    }
+
+    func testBridgeSharesOneBufferAcrossObservers() {
+        let bridge = AudioHookBridge.shared
+        var seen: [UnsafeMutableRawPointer] = []
+        let tokens = (0..<3).map { _ in
+            bridge.addFrameBufferObserver { buffer in
+                seen.append(UnsafeMutableRawPointer(buffer))
+            }
+        }
+        defer { tokens.forEach { bridge.removeFrameBufferObserver($0) } }
+
+        let frame = [UInt8](repeating: 0xD5, count: 160)
+        let before = bridge.framePoolStats()
+        bridge.injectAlawFrame(frame, length: frame.count, frameNo: 900_001, timestamp: 0)
+
+        XCTAssertEqual(seen.count, 3)
+        XCTAssertEqual(Set(seen).count, 1, "Every observer gets the same buffer")
+        let after = bridge.framePoolStats()
+        XCTAssertEqual(after.acquired - before.acquired, 1)
+        XCTAssertEqual(after.outstanding, 0)
+    }
+
+    // MARK: - Benchmark
+
+    /// 4 consumers keep every 320-byte frame briefly: shared handles vs one
+    /// [UInt8] copy per consumer
+    func testSharedHandlesBeatPerConsumerCopies() throws {
+        let pool = try FramePool()
+        let payload = [UInt8](repeating: 0xD5, count: 320)
+        let consumers = 4
+        let frames = 20_000
+
+        var copies: [[UInt8]] = []
+        copies.reserveCapacity(consumers)
+        let copyStart = Date()
+        for _ in 0..<frames {
+            payload.withUnsafeBufferPointer { bytes in
+                for _ in 0..<consumers {
+                    copies.append(Array(bytes))
+                }
+            }
+            copies.removeAll(keepingCapacity: true)
+        }
+        let copyTime = Date().timeIntervalSince(copyStart)
+
+        var references: [FrameReference] = []
+        references.reserveCapacity(consumers)
+        let shareStart = Date()
+        for index in 0..<frames {
+            let frame = try pool.copy(payload, frameNo: UInt32(index), timestampMs: 0)
+            for _ in 0..<consumers {
+                references.append(frame.share().escape())
+            }
+            for reference in references {
+                _ = FrameHandle(adopting: reference)
+            }
+            references.removeAll(keepingCapacity: true)
+        }
+        let shareTime = Date().timeIntervalSince(shareStart)
+
+        let perFrame = { (seconds: TimeInterval) in seconds / Double(frames) * 1e9 }
+        print("⏱️ 320-byte frame to \(consumers) consumers: copies \(String(format: "%.0f", perFrame(copyTime))) ns, "
+              + "shared handles \(String(format: "%.0f", perFrame(shareTime))) ns")
+
+        XCTAssertEqual(pool.stats.outstanding, 0)
+        XCTAssertEqual(pool.stats.exhausted, 0)
+        XCTAssertLessThan(shareTime, copyTime)
+    }
+}
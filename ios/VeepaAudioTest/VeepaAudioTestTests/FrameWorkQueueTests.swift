@@ -0,0 +1,200 @@
+//
+//  FrameWorkQueueTests.swift
+//  VeepaAudioTestTests
+//
+//  Reader → worker handoff: every frame arrives exactly once, batches keep
+//  order, and the lock-free queue holds up against a mutex-protected queue
+//  at 8, 32 and 64 threads.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class FrameWorkQueueTests: RealtimeSafeTestCase {
+
+    // MARK: - Handles
+
+    func testFramesCrossInOrderAndReturnToPool() throws {
+        let pool = try FramePool(smallBuffers: 32, largeBuffers: 0)
+        let queue = try FrameWorkQueue(capacity: 16, batchSize: 4)
+        let payload = [UInt8](repeating: 0xD5, count: 160)
+
+        for frameNo in 1...16 {
+            XCTAssertTrue(queue.enqueue(try pool.copy(payload, frameNo: UInt32(frameNo), timestampMs: 0)))
+        }
+        XCTAssertFalse(queue.enqueue(try pool.copy(payload, frameNo: 17, timestampMs: 0)), "Full")
+        XCTAssertEqual(queue.droppedFrames, 1)
+        XCTAssertEqual(queue.count, 16)
+
+        var received: [UInt32] = []
+        while queue.drain({ received.append($0.frameNo) }) > 0 {}
+        XCTAssertEqual(received, Array(1...16))
+        XCTAssertEqual(pool.stats.outstanding, 0)
+    }
+
+    func testUndrainedFramesAreReleased() throws {
+        let pool = try FramePool(smallBuffers: 8, largeBuffers: 0)
+        do {
+            let queue = try FrameWorkQueue(capacity: 8)
+            for frameNo in 1...5 {
+                queue.enqueue(try pool.copy([1, 2, 3], frameNo: UInt32(frameNo), timestampMs: 0))
+            }
+        }
+        XCTAssertEqual(pool.stats.outstanding, 0)
+    }
+
+    // MARK: - Contention Benchmark
+
+    /// The handoff as it would be written with a lock (cf. CircularAudioBuffer)
+    private final class MutexQueue {
+        private var slots: [UnsafeMutablePointer<frame_buffer>?]
+        private var head = 0
+        private var tail = 0
+        private let lock = NSLock()
+
+        init(capacity: Int) {
+            slots = Array(repeating: nil, count: capacity)
+        }
+
+        func enqueue(_ frame: UnsafeMutablePointer<frame_buffer>) -> Bool {
+            lock.lock()
+            defer { lock.unlock() }
+            guard tail - head < slots.count else { return false }
+            slots[tail % slots.count] = frame
+            tail += 1
+            return true
+        }
+
+        func dequeue() -> UnsafeMutablePointer<frame_buffer>? {
+            lock.lock()
+            defer { lock.unlock() }
+            guard tail > head else { return nil }
+            let frame = slots[head % slots.count]
+            head += 1
+            return frame
+        }
+    }
+
+    private enum Handoff {
+        case mutex, lockFree, lockFreeBatched
+    }
+
+    /// Half the threads produce `perProducer` tagged pointers, half consume
+    /// them; returns ns per frame and checks each frame arrived exactly once
+    private func runHandoff(_ handoff: Handoff, threads: Int, perProducer: Int) -> Double {
+        let producers = threads / 2
+        let consumers = threads - producers
+        let total = producers * perProducer
+        let batch = 8
+
+        let queue = frame_queue_create(1024)!
+        defer { frame_queue_destroy(queue) }
+        let mutexQueue = MutexQueue(capacity: 1024)
+
+        let seen = UnsafeMutablePointer<UInt8>.allocate(capacity: total)
+        seen.initialize(repeating: 0, count: total)
+        defer { seen.deallocate() }
+        let consumed = UnsafeMutablePointer<Int>.allocate(capacity: consumers)
+        consumed.initialize(repeating: 0, count: consumers)
+        defer { consumed.deallocate() }
+
+        let group = DispatchGroup()
+        let countLock = NSLock()
+        var remaining = total
+        let start = Date()
+
+        // Tag = index + 1 (a null pointer is not a frame)
+        func tag(_ index: Int) -> UnsafeMutablePointer<frame_buffer> {
+            UnsafeMutablePointer(bitPattern: index + 1)!
+        }
+
+        for producer in 0..<producers {
+            group.enter()
+            Thread {
+                var next = producer * perProducer
+                let end = next + perProducer
+                var frames = [UnsafeMutablePointer<frame_buffer>?](repeating: nil, count: batch)
+                while next < end {
+                    switch handoff {
+                    case .mutex:
+                        if mutexQueue.enqueue(tag(next)) { next += 1 } else { sched_yield() }
+                    case .lockFree:
+                        if frame_queue_enqueue(queue, tag(next)) != 0 { next += 1 } else { sched_yield() }
+                    case .lockFreeBatched:
+                        let count = min(batch, end - next)
+                        for i in 0..<count { frames[i] = tag(next + i) }
+                        let queued = Int(frame_queue_enqueue_batch(queue, &frames, UInt32(count)))
+                        next += queued
+                        if queued == 0 { sched_yield() }
+                    }
+                }
+                group.leave()
+            }.start()
+        }
+
+        for consumer in 0..<consumers {
+            group.enter()
+            Thread {
+                var frames = [UnsafeMutablePointer<frame_buffer>?](repeating: nil, count: batch)
+                var taken = 0
+                func flush() -> Bool {
+                    countLock.lock()
+                    remaining -= taken
+                    let done = remaining <= 0
+                    countLock.unlock()
+                    consumed[consumer] += taken
+                    taken = 0
+                    return done
+                }
+                while true {
+                    var got = 0
+                    switch handoff {
+                    case .mutex:
+                        if let frame = mutexQueue.dequeue() { frames[0] = frame; got = 1 }
+                    case .lockFree:
+                        var frame: UnsafeMutablePointer<frame_buffer>?
+                        if frame_queue_dequeue(queue, &frame) != 0 { frames[0] = frame; got = 1 }
+                    case .lockFreeBatched:
+                        got = Int(frame_queue_dequeue_batch(queue, &frames, UInt32(batch)))
+                    }
+                    for i in 0..<got {
+                        seen[Int(bitPattern: frames[i]!) - 1] += 1
+                    }
+                    taken += got
+                    if got == 0 {
+                        if flush() { break }
+                        sched_yield()
+                    } else if taken >= 256 {
+                        _ = flush()
+                    }
+                }
+                group.leave()
+            }.start()
+        }
+
+        group.wait()
+        let elapsed = Date().timeIntervalSince(start)
+
+        XCTAssertEqual((0..<consumers).reduce(0) { $0 + consumed[$1] }, total, "\(handoff) at \(threads) threads")
+        XCTAssertTrue((0..<total).allSatisfy { seen[$0] == 1 }, "\(handoff): every frame exactly once")
+        return elapsed / Double(total) * 1e9
+    }
+
+    func testHandoffContention() {
+        let perProducer = 20_000
+        var results: [Int: (mutex: Double, lockFree: Double, batched: Double)] = [:]
+
+        for threads in [8, 32, 64] {
+            let mutex = runHandoff(.mutex, threads: threads, perProducer: perProducer)
+            let lockFree = runHandoff(.lockFree, threads: threads, perProducer: perProducer)
+            let batched = runHandoff(.lockFreeBatched, threads: threads, perProducer: perProducer)
+            results[threads] = (mutex, lockFree, batched)
+            print("⏱️ \(threads) threads: mutex \(String(format: "%.0f", mutex)) ns/frame, "
+                  + "lock-free \(String(format: "%.0f", lockFree)) ns, "
+                  + "batched ×8 \(String(format: "%.0f", batched)) ns")
+        }
+
+        let heaviest = results[64]!
+        XCTAssertLessThan(heaviest.batched, heaviest.mutex, "Batched handoff should beat the mutex under contention")
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  LazyDecodeTests.swift
+//  VeepaAudioTestTests
+//
+//  Unobserved streams skip G.711a decode but keep sequence, timing and level;
+//  decoding resumes with the first frame after a consumer attaches, and an
+//  idle capture callback (muted engine) does not count as one.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class LazyDecodeTests: RealtimeSafeTestCase {
+
+    private let bridge = AudioHookBridge.shared
+    private var previousCallback: AudioCaptureBlock?
+
+    override func setUp() {
+        super.setUp()
+        previousCallback = bridge.captureCallback
+        bridge.captureCallback = nil
+        bridge.captureCallbackIdle = false
+        bridge.lazyDecodeEnabled = true
+    }
+
+    override func tearDown() {
+        bridge.captureCallback = previousCallback
+        bridge.captureCallbackIdle = false
+        super.tearDown()
+    }
+
+    private func inject(_ frame: CameraEmulator.Frame) {
+        frame.payload.withUnsafeBufferPointer {
+            bridge.injectAlawFrame($0.baseAddress!, length: $0.count,
+                                   frameNo: frame.frameNo, timestamp: frame.timestamp)
+        }
+    }
+
+    func testUnobservedFramesAreTrackedButNotDecoded() {
+        XCTAssertFalse(bridge.needsDecodedAudio)
+
+        var configuration = CameraEmulator.Configuration()
+        configuration.amplitude = 0.25
+        let emulator = CameraEmulator(configuration: configuration)
+        let before = bridge.frameActivity()
+
+        let frames = (0..<5).map { _ in emulator.nextFrame() }
+        frames.forEach(inject)
+
+        let activity = bridge.frameActivity()
+        XCTAssertEqual(activity.frames - before.frames, 5)
+        XCTAssertEqual(activity.decodeSkipped - before.decodeSkipped, 5)
+        XCTAssertEqual(activity.lastFrameNo, frames.last!.frameNo)
+        XCTAssertEqual(activity.lastTimestampMs, frames.last!.timestamp)
+
+        // Level from the A-law bytes matches the decoded RMS of a 0.25 sine (-15 dBFS)
+        XCTAssertEqual(activity.levelDbfs, 20 * log10(0.25 / 2.0.squareRoot()), accuracy: 0.5)
+        XCTAssertEqual(activity.peakDbfs, 20 * log10(0.25), accuracy: 0.5)
+    }
+
+    func testDecodingResumesOnTheFrameAfterAConsumerAttaches() {
+        let emulator = CameraEmulator()
+        inject(emulator.nextFrame())
+        let skipped = bridge.frameActivity().decodeSkipped
+
+        var decodedFrameNos: [UInt32] = []
+        let token = bridge.addDecodedFrameObserver { _, _, frameNo, _ in
+            decodedFrameNos.append(frameNo)
+        }
+        XCTAssertTrue(bridge.needsDecodedAudio)
+
+        let next = emulator.nextFrame()
+        inject(next)
+        XCTAssertEqual(decodedFrameNos, [next.frameNo], "First frame after attaching must be decoded")
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped, skipped)
+
+        bridge.removeDecodedFrameObserver(token)
+        XCTAssertFalse(bridge.needsDecodedAudio)
+        inject(emulator.nextFrame())
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped, skipped + 1)
+    }
+
+    func testIdleCaptureCallbackIsNotAConsumer() {
+        let emulator = CameraEmulator()
+        var delivered = 0
+        bridge.captureCallback = { _, count in delivered += Int(count) }
+        bridge.captureCallbackIdle = true
+        XCTAssertFalse(bridge.needsDecodedAudio)
+
+        let skipped = bridge.frameActivity().decodeSkipped
+        inject(emulator.nextFrame())
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped, skipped + 1)
+        XCTAssertEqual(delivered, 0)
+
+        // Unmuted: the very next frame is decoded and delivered
+        bridge.captureCallbackIdle = false
+        XCTAssertTrue(bridge.needsDecodedAudio)
+        let next = emulator.nextFrame()
+        inject(next)
+        XCTAssertEqual(delivered, next.payload.count)
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped, skipped + 1)
+    }
+
+    func testLostFramesAreCountedWithoutDecoding() {
+        let emulator = CameraEmulator()
+        let before = bridge.frameActivity()
+
+        let frames = (0..<6).map { _ in emulator.nextFrame() }
+        for frame in frames where frame.frameNo != 3 && frame.frameNo != 4 {
+            inject(frame)
+        }
+
+        XCTAssertEqual(bridge.frameActivity().lostFrames - before.lostFrames, 2)
+    }
+
+    func testOnlyConsumedFramesAreDecoded() {
+        let emulator = CameraEmulator()
+        let frames = (0..<200).map { _ in emulator.nextFrame() }
+        let before = bridge.frameActivity().decodeSkipped
+
+        frames[..<100].forEach(inject)
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped - before, 100)
+
+        var delivered = 0
+        bridge.captureCallback = { _, count in delivered += Int(count) }
+        frames[100...].forEach(inject)
+        bridge.captureCallback = nil
+
+        XCTAssertEqual(bridge.frameActivity().decodeSkipped - before, 100, "Every consumed frame was decoded")
+        XCTAssertEqual(delivered, frames[100...].reduce(0) { $0 + $1.payload.count })
+    }
+}
@@ -0,0 +1,194 @@
+//
+//  LoudnessMeterTests.swift
+//  VeepaAudioTestTests
+//
+//  EBU R128 meter: a -20 dBFS 1 kHz sine reads -23 LUFS at the camera
+//  rates, quiet passages are removed by the relative gate, histograms of
+//  consecutive segments add up to the loudness of the whole, the archive
+//  writes each segment's loudness into its index, and the wavefront
+//  cascade matches a plain section-by-section filter.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class LoudnessMeterTests: RealtimeSafeTestCase {
+
+    /// Feed `seconds` of a sine in 20 ms frames, continuing from `phase`
+    private func feed(_ meter: LoudnessMeter, dbfs: Double, frequency: Double = 1000,
+                      seconds: Double, phase: inout Double) {
+        let amplitude = pow(10, dbfs / 20) * Double(Int16.max)
+        let frameSamples = meter.sampleRate / 50
+        var frame = [Int16](repeating: 0, count: frameSamples)
+        for _ in 0..<Int(seconds * 50) {
+            for i in frame.indices {
+                frame[i] = Int16((sin(phase) * amplitude).rounded())
+                phase += 2 * Double.pi * frequency / Double(meter.sampleRate)
+            }
+            meter.add(frame, count: frame.count)
+        }
+    }
+
+    // MARK: - Reference Levels
+
+    func testSineReadsReferenceLoudness() throws {
+        for rate in [8000, 16000] {
+            let meter = try LoudnessMeter(sampleRate: rate)
+            var phase = 0.0
+            feed(meter, dbfs: -20, seconds: 10, phase: &phase)
+
+            // Mono sine: mean square -23.01 dB, K-weighting +0.69 dB at 1 kHz
+            let reading = meter.reading
+            XCTAssertEqual(try XCTUnwrap(reading.momentary), -23, accuracy: 0.1, "\(rate) Hz")
+            XCTAssertEqual(try XCTUnwrap(reading.shortTerm), -23, accuracy: 0.1, "\(rate) Hz")
+            XCTAssertEqual(try XCTUnwrap(reading.integrated), -23, accuracy: 0.1, "\(rate) Hz")
+            XCTAssertEqual(reading.gatedBlocks, 97, "One block per 100 ms once 400 ms are in")
+        }
+    }
+
+    func testWindowsFillBeforeReporting() throws {
+        let meter = try LoudnessMeter(sampleRate: 16000)
+        var phase = 0.0
+        feed(meter, dbfs: -20, seconds: 0.3, phase: &phase)
+        XCTAssertNil(meter.reading.momentary)
+        feed(meter, dbfs: -20, seconds: 0.1, phase: &phase)
+        XCTAssertNotNil(meter.reading.momentary)
+        XCTAssertNil(meter.reading.shortTerm, "3 s window not full yet")
+
+        meter.reset()
+        feed(meter, dbfs: -20, seconds: 0.1, phase: &phase)
+        XCTAssertNil(meter.reading.momentary, "Reset takes effect on the next samples")
+        XCTAssertNil(meter.reading.integrated)
+        XCTAssertEqual(meter.reading.gatedBlocks, 0)
+    }
+
+    // MARK: - Gating
+
+    func testRelativeGateIgnoresQuietPassages() throws {
+        let meter = try LoudnessMeter(sampleRate: 16000)
+        var phase = 0.0
+        feed(meter, dbfs: -20, seconds: 20, phase: &phase)
+        feed(meter, dbfs: -50, seconds: 20, phase: &phase)
+
+        // The quiet half is 30 LU down: gated out, not averaged in
+        let reading = meter.reading
+        XCTAssertEqual(try XCTUnwrap(reading.momentary), -53, accuracy: 0.1)
+        XCTAssertEqual(try XCTUnwrap(reading.integrated), -23, accuracy: 0.1)
+        XCTAssertEqual(try XCTUnwrap(reading.maxShortTerm), -23, accuracy: 0.1)
+
+        // Below the absolute gate nothing is counted at all (once the
+        // blocks overlapping the -50 dBFS tone have passed)
+        feed(meter, dbfs: -75, seconds: 1, phase: &phase)
+        let blocks = meter.reading.gatedBlocks
+        feed(meter, dbfs: -75, seconds: 5, phase: &phase)
+        XCTAssertEqual(meter.reading.gatedBlocks, blocks)
+    }
+
+    func testSegmentHistogramsAddUp() throws {
+        let whole = try LoudnessMeter(sampleRate: 16000)
+        let first = try LoudnessMeter(sampleRate: 16000)
+        let second = try LoudnessMeter(sampleRate: 16000)
+        var phase = 0.0
+        var firstPhase = 0.0
+        var secondPhase = 0.0
+        feed(whole, dbfs: -18, seconds: 20, phase: &phase)
+        feed(whole, dbfs: -30, seconds: 20, phase: &phase)
+        feed(first, dbfs: -18, seconds: 20, phase: &firstPhase)
+        feed(second, dbfs: -30, seconds: 20, phase: &secondPhase)
+
+        let merged = zip(first.histogram, second.histogram).map { $0 + $1 }
+        let integrated = try XCTUnwrap(LoudnessMeter.integratedLoudness(histogram: merged))
+        XCTAssertEqual(integrated, try XCTUnwrap(whole.reading.integrated), accuracy: 0.1,
+                       "Only the blocks across the cut differ")
+    }
+
+    // MARK: - Filter
+
+    func testWavefrontCascadeMatchesDirectFilter() {
+        var sections = [biquad_coefficients](repeating: biquad_coefficients(), count: 2)
+        loudness_k_weighting(16000, &sections)
+        var cascade = biquad_cascade()
+        XCTAssertEqual(biquad_cascade_init(&cascade, sections, 2), 0)
+        var state = biquad_state()
+
+        let input = (0..<4000).map { Float(sin(Double($0) * 0.37) * 0.5 + cos(Double($0) * 0.011) * 0.25) }
+        var output = [Float](repeating: 0, count: input.count)
+        biquad_process(&cascade, &state, input, &output, input.count)
+
+        // Reference: one section after the other in double precision
+        var reference = input.map(Double.init)
+        for c in sections {
+            var (x1, x2, y1, y2) = (0.0, 0.0, 0.0, 0.0)
+            for i in reference.indices {
+                let x = reference[i]
+                let y = c.b0 * x + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2
+                (x2, x1, y2, y1) = (x1, x, y1, y)
+                reference[i] = y
+            }
+        }
+        let latency = Int(BIQUAD_LATENCY)
+        XCTAssertTrue(output[0..<latency].allSatisfy { $0 == 0 })
+        for i in latency..<input.count {
+            XCTAssertEqual(Double(output[i]), reference[i - latency], accuracy: 1e-4, "sample \(i)")
+        }
+    }
+
+    func testMeteringCost() throws {
+        let meter = try LoudnessMeter(sampleRate: 16000)
+        let samples = (0..<16000).map { Int16(truncatingIfNeeded: ($0 &* 7919) % 4000 - 2000) }
+
+        let iterations = 60
+        let start = DispatchTime.now().uptimeNanoseconds
+        for _ in 0..<iterations {
+            meter.add(samples, count: samples.count)
+        }
+        let nsPerSample = Double(DispatchTime.now().uptimeNanoseconds - start) / Double(iterations * samples.count)
+
+        print(String(format: "[LoudnessMeterTests] %.2f ns per sample (%.2f ms per minute of audio)",
+                     nsPerSample, nsPerSample * 16000 * 60 / 1e6))
+        XCTAssertLessThan(nsPerSample, 20)
+    }
+
+    // MARK: - Archive Index
+
+    func testArchiveIndexCarriesSegmentLoudness() throws {
+        let directory = FileManager.default.temporaryDirectory.appendingPathComponent("loudness-\(UUID().uuidString)")
+        defer { try? FileManager.default.removeItem(at: directory) }
+
+        let bridge = AudioHookBridge.shared
+        XCTAssertTrue(bridge.startArchiving(toDirectory: directory.path, segmentDuration: 600))
+
+        var configuration = CameraEmulator.Configuration()
+        configuration.frameSamples = 320
+        configuration.amplitude = 0.1
+        let emulator = CameraEmulator(configuration: configuration)
+        let meter = try LoudnessMeter(sampleRate: 16000)
+        var decoded = [Int16](repeating: 0, count: 320)
+        for _ in 0..<250 {
+            let frame = emulator.nextFrame()
+            frame.payload.withUnsafeBufferPointer {
+                bridge.injectAlawFrame($0.baseAddress!, length: $0.count, frameNo: frame.frameNo, timestamp: frame.timestamp)
+            }
+            g711_alaw_decode(frame.payload, &decoded, frame.payload.count)
+            meter.add(decoded, count: decoded.count)
+        }
+        bridge.stopArchiving()
+
+        let files = try FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)
+        let indexURL = try XCTUnwrap(files.first { $0.pathExtension == CAPTURE_ARCHIVE_INDEX_EXTENSION })
+        let data = try Data(contentsOf: indexURL)
+        try data.withUnsafeBytes { bytes in
+            var index = capture_archive_index()
+            var histogram: UnsafePointer<UInt32>?
+            XCTAssertEqual(capture_archive_read_index(bytes.baseAddress, bytes.count, &index, &histogram),
+                           Int32(CAPTURE_ARCHIVE_OK))
+            XCTAssertEqual(index.frames, 250)
+            XCTAssertEqual(index.samples, 250 * 320)
+
+            // Same samples, same meter: the index holds exactly what a fresh pass would find
+            let counts = Array(UnsafeBufferPointer(start: try XCTUnwrap(histogram), count: Int(index.histogram_bins)))
+            XCTAssertEqual(counts, meter.histogram)
+            XCTAssertEqual(LoudnessMeter.lufs(index.integrated_clu), meter.reading.integrated)
+        }
+    }
+}
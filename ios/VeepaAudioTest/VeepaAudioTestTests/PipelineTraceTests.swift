@@ -0,0 +1,165 @@
+//
+//  PipelineTraceTests.swift
+//  VeepaAudioTestTests
+//
+//  Pipeline tracing: events land on their thread's track, recording is
+//  real-time safe, a restart discards earlier events, rings of exited
+//  threads are reused once dumped, and the rings export as Chrome JSON and
+//  Perfetto protobuf.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class PipelineTraceTests: RealtimeSafeTestCase {
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        try PipelineTrace.start(threads: 32, eventsPerThread: 4096)
+    }
+
+    override func tearDown() {
+        PipelineTrace.stop()
+        super.tearDown()
+    }
+
+    /// Record on a named thread and wait for it to finish
+    private func onThread(_ name: String, _ body: @escaping () -> Void) {
+        let done = expectation(description: name)
+        let thread = Thread {
+            body()
+            done.fulfill()
+        }
+        thread.name = name
+        thread.start()
+        wait(for: [done], timeout: 5)
+    }
+
+    private func track(named name: String) -> PipelineTrace.ThreadTrack? {
+        PipelineTrace.collect().first { $0.name == name }
+    }
+
+    // MARK: - Recording
+
+    func testEventsLandOnTheirThreadsTrack() throws {
+        onThread("trace.capture") {
+            pipeline_trace_instant(PIPELINE_TRACE_FRAME_ARRIVAL, 2, 41)
+            let start = pipeline_trace_begin()
+            usleep(1000)
+            pipeline_trace_span(PIPELINE_TRACE_DECODE, start, 2, 320)
+        }
+        onThread("trace.render") {
+            RealtimeSanitizer.realtime {
+                let start = pipeline_trace_begin()
+                pipeline_trace_span(PIPELINE_TRACE_RENDER_PULL, start, 2, 160)
+                pipeline_trace_instant(PIPELINE_TRACE_UNDERFLOW, 2, 96)
+                pipeline_trace_counter(PIPELINE_TRACE_RING_FILL, 2, 480)
+            }
+        }
+
+        let capture = try XCTUnwrap(track(named: "trace.capture"))
+        XCTAssertEqual(capture.events.map(\.event), [UInt8(PIPELINE_TRACE_FRAME_ARRIVAL.rawValue),
+                                                     UInt8(PIPELINE_TRACE_DECODE.rawValue)])
+        XCTAssertEqual(capture.events[0].value, 41)
+        XCTAssertEqual(capture.events[1].kind, UInt8(PIPELINE_TRACE_SPAN.rawValue))
+        XCTAssertGreaterThanOrEqual(capture.events[1].duration_ns, 1_000_000)
+        XCTAssertEqual(capture.events[1].session, 2)
+
+        let render = try XCTUnwrap(track(named: "trace.render"))
+        XCTAssertEqual(render.events.count, 3)
+        XCTAssertEqual(render.events[2].kind, UInt8(PIPELINE_TRACE_COUNTER.rawValue))
+        XCTAssertNotEqual(render.threadID, capture.threadID)
+    }
+
+    func testRestartDiscardsAndStopIgnores() throws {
+        onThread("trace.before") {
+            pipeline_trace_instant(PIPELINE_TRACE_KEEPALIVE, UInt32(PIPELINE_TRACE_NO_SESSION), 1)
+        }
+        XCTAssertNotNil(track(named: "trace.before"))
+
+        try PipelineTrace.start()
+        XCTAssertNil(track(named: "trace.before"), "A new start drops earlier events")
+
+        PipelineTrace.stop()
+        XCTAssertEqual(pipeline_trace_begin(), 0)
+        onThread("trace.stopped") {
+            pipeline_trace_instant(PIPELINE_TRACE_KEEPALIVE, UInt32(PIPELINE_TRACE_NO_SESSION), 2)
+        }
+        XCTAssertNil(track(named: "trace.stopped"))
+    }
+
+    func testRingKeepsTheMostRecentEvents() throws {
+        onThread("trace.flood") {
+            for frameNo in 0..<10_000 {
+                pipeline_trace_instant(PIPELINE_TRACE_FRAME_ARRIVAL, 0, Int64(frameNo))
+            }
+        }
+        let flood = try XCTUnwrap(track(named: "trace.flood"))
+        XCTAssertEqual(flood.events.count, 4096)
+        XCTAssertEqual(flood.events.last?.value, 9_999)
+        XCTAssertEqual(flood.events.first?.value, 10_000 - 4096)
+        XCTAssertEqual(flood.overwritten, 10_000 - 4096)
+    }
+
+    func testRingsOfExitedThreadsAreReused() throws {
+        // More short-lived threads than rings, each dumped once it has run
+        for index in 0..<Int(PIPELINE_TRACE_MAX_THREADS) + 16 {
+            let name = "trace.short-\(index)"
+            onThread(name) {
+                pipeline_trace_instant(PIPELINE_TRACE_KEEPALIVE, UInt32(PIPELINE_TRACE_NO_SESSION), Int64(index))
+            }
+            XCTAssertEqual(track(named: name)?.events.first?.value, Int64(index), name)
+            PipelineTrace.releaseExitedThreads()
+        }
+        XCTAssertEqual(PipelineTrace.droppedEvents, 0, "Every thread found a ring")
+    }
+
+    // MARK: - Export
+
+    func testExportsChromeJSONAndPerfetto() throws {
+        onThread("trace.export") {
+            let start = pipeline_trace_begin()
+            pipeline_trace_span(PIPELINE_TRACE_RING_WRITE, start, 0, 320)
+            pipeline_trace_instant(PIPELINE_TRACE_ENGINE_RESTART, 0, 1)
+            pipeline_trace_counter(PIPELINE_TRACE_RING_FILL, 0, 640)
+        }
+        let tracks = PipelineTrace.collect().filter { $0.name == "trace.export" }
+        let origin = try XCTUnwrap(tracks.first?.events.first?.time_ns)
+
+        var chrome = ChromeTraceWriter(originNanoseconds: origin)
+        PipelineTrace.render(tracks, into: &chrome)
+        let document = try XCTUnwrap(JSONSerialization.jsonObject(with: chrome.data()) as? [String: Any])
+        let events = try XCTUnwrap(document["traceEvents"] as? [[String: Any]])
+        let phases = events.compactMap { $0["ph"] as? String }
+        XCTAssertEqual(Set(phases), ["M", "X", "i", "C"])
+        XCTAssertTrue(events.contains { $0["name"] as? String == "engineRestart" })
+
+        var perfetto = PerfettoTraceWriter(originNanoseconds: origin)
+        PipelineTrace.render(tracks, into: &perfetto)
+        let bytes = [UInt8](try perfetto.data())
+
+        // Walk the top-level Trace.packet fields: process + thread + counter
+        // descriptors, then slice begin/end, instant and counter events
+        var packets = 0
+        var offset = 0
+        while offset < bytes.count {
+            XCTAssertEqual(bytes[offset], 0x0A, "Trace.packet, length-delimited")
+            offset += 1
+            var length = 0, shift = 0
+            while bytes[offset] & 0x80 != 0 {
+                length |= Int(bytes[offset] & 0x7F) << shift
+                shift += 7
+                offset += 1
+            }
+            length |= Int(bytes[offset]) << shift
+            offset += 1 + length
+            packets += 1
+        }
+        XCTAssertEqual(offset, bytes.count)
+        XCTAssertEqual(packets, 3 + 4)
+
+        let url = try PipelineTrace.dump(as: .perfetto, to: FileManager.default.temporaryDirectory)
+        XCTAssertEqual(url.pathExtension, "perfetto-trace")
+        try? FileManager.default.removeItem(at: url)
+    }
+}
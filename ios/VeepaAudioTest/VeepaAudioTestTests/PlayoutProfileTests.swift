@@ -0,0 +1,167 @@
+//
+//  PlayoutProfileTests.swift
+//  VeepaAudioTestTests
+//
+//  Playout profiles: each preset is run through the same simulated network
+//  (16 kHz, 20 ms frames, up to 30 ms jitter, a 150 ms stall every 5 s) to
+//  measure latency and glitch rate, and switching at runtime keeps audio.
+//  Renders run in a real-time scope, so the sanitizer fails any that allocate.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class PlayoutProfileTests: RealtimeSafeTestCase {
+
+    /// Deterministic generator so every profile sees the same network
+    private struct SeededGenerator {
+        var state: UInt64
+        mutating func next(_ bound: Int) -> Int {
+            state = state &* 6364136223846793005 &+ 1442695040888963407
+            return Int((state >> 33) % UInt64(bound))
+        }
+    }
+
+    private struct Measurement {
+        let meanLatencyMs: Double
+        let underflowsPerMinute: UInt64
+        let latencyTrims: UInt64
+    }
+
+    /// Play one simulated minute through a profile at its own render block size
+    private func simulate(_ profile: PlayoutProfile) -> Measurement {
+        let sampleRate = 16000, frameSamples = 320, frameMs = 20
+        let durationMs = 60_000
+
+        // Arrival time per frame: network delay + jitter, stalls release in a burst
+        var generator = SeededGenerator(state: 42)
+        var arrivals: [Int] = []
+        var previous = 0
+        for frameNo in 0..<(durationMs / frameMs) {
+            let sent = frameNo * frameMs
+            var arrival = sent + 20 + generator.next(30)
+            if sent % 5000 >= 4850 {
+                arrival = max(arrival, sent - sent % 5000 + 5000)
+            }
+            previous = max(previous, arrival)
+            arrivals.append(previous)
+        }
+
+        let ring = CircularAudioBuffer(capacity: 32000)
+        let controller = PlayoutController(profile: profile)
+        controller.configure(sampleRate: sampleRate, frameSamples: frameSamples)
+
+        let frame = (0..<frameSamples).map { Int16(truncatingIfNeeded: ($0 % 40) * 400 - 8000) }
+        let blockMs = Int(profile.ioBufferDuration * 1000)
+        let blockSamples = sampleRate * blockMs / 1000
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: blockSamples)
+        defer { output.deallocate() }
+
+        var next = 0
+        var latencyTotal = 0.0
+        var renders = 0
+        var playing = false
+        for now in 0..<durationMs {
+            while next < arrivals.count && arrivals[next] <= now {
+                ring.write(from: frame)
+                next += 1
+            }
+            guard now % blockMs == 0 else { continue }
+
+            let (received, _) = RealtimeSanitizer.realtime {
+                controller.render(into: output, count: blockSamples, from: ring)
+            }
+            playing = playing || received > 0
+            if playing {
+                // Audio still queued after this block, plus the block itself
+                latencyTotal += Double(ring.availableSamples * 1000 / sampleRate + blockMs)
+                renders += 1
+            }
+        }
+
+        return Measurement(meanLatencyMs: latencyTotal / Double(max(renders, 1)),
+                           underflowsPerMinute: controller.statistics.underflows,
+                           latencyTrims: controller.statistics.latencyTrims)
+    }
+
+    // MARK: - Profiles
+
+    func testProfilesTradeLatencyForGlitches() {
+        var results: [String: Measurement] = [:]
+        for profile in PlayoutProfile.all {
+            let result = simulate(profile)
+            results[profile.name] = result
+            print("⏱️ \(profile.name): \(String(format: "%.1f", result.meanLatencyMs)) ms mean latency, "
+                  + "\(result.underflowsPerMinute) underflows/min, \(result.latencyTrims) trims")
+        }
+
+        let live = results["live-intercom"]!
+        let standard = results["standard"]!
+        let evidence = results["evidence-monitoring"]!
+
+        XCTAssertLessThan(live.meanLatencyMs, 60, "Live intercom targets ~40 ms")
+        XCTAssertLessThan(live.meanLatencyMs, standard.meanLatencyMs)
+        XCTAssertLessThan(standard.meanLatencyMs, evidence.meanLatencyMs)
+
+        XCTAssertEqual(evidence.underflowsPerMinute, 0, "150 ms stalls fit in the evidence cushion")
+        XCTAssertEqual(evidence.latencyTrims, 0, "Evidence monitoring never drops audio")
+        XCTAssertLessThanOrEqual(standard.underflowsPerMinute, live.underflowsPerMinute)
+    }
+
+    func testProfilesAreLookedUpByName() {
+        XCTAssertEqual(PlayoutProfile.named("live-intercom"), .liveIntercom)
+        XCTAssertEqual(PlayoutProfile.named("evidence-monitoring"), .evidenceMonitoring)
+        XCTAssertNil(PlayoutProfile.named("studio"))
+    }
+
+    // MARK: - Runtime Switching
+
+    func testSwitchingKeepsBufferedAudio() {
+        let ring = CircularAudioBuffer(capacity: 32000)
+        let controller = PlayoutController(profile: .evidenceMonitoring)
+        controller.configure(sampleRate: 16000, frameSamples: 320)
+        XCTAssertEqual(controller.bounds.maxSamples, .max, "Evidence monitoring keeps everything")
+
+        ring.write(from: [Int16](repeating: 100, count: 3200))
+        controller.apply(.liveIntercom)
+        XCTAssertEqual(controller.bounds.targetSamples, 320)
+        XCTAssertEqual(controller.bounds.maxSamples, 1280, "80 ms at 16 kHz")
+        XCTAssertEqual(ring.availableSamples, 3200, "Switching alone drops nothing")
+
+        // The next render trims the backlog down to the new target
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: 80)
+        defer { output.deallocate() }
+        let (received, _) = controller.render(into: output, count: 80, from: ring)
+        XCTAssertEqual(received, 80)
+        XCTAssertEqual(ring.availableSamples, 240)
+        XCTAssertEqual(controller.statistics.latencyTrims, 1)
+    }
+
+    // MARK: - Concealment
+
+    func testConcealmentFadesToSilence() {
+        let ring = CircularAudioBuffer(capacity: 4096)
+        let controller = PlayoutController(profile: .liveIntercom)
+        controller.configure(sampleRate: 16000, frameSamples: 320)
+        ring.write(from: [Int16](repeating: 10000, count: 320))
+
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: 1600)
+        defer { output.deallocate() }
+        let (received, concealed) = controller.render(into: output, count: 1600, from: ring)
+
+        XCTAssertEqual(received, 320)
+        XCTAssertEqual(concealed, 640, "40 ms of fade at 16 kHz")
+        XCTAssertEqual(output[320], 10000)
+        XCTAssertLessThan(output[320 + 320], 10000)
+        XCTAssertEqual(output[320 + 639], 15)
+        XCTAssertEqual(output[1599], 0)
+        XCTAssertEqual(controller.statistics.underflows, 1)
+
+        // Silence profile invents nothing
+        let silent = PlayoutController(profile: .evidenceMonitoring)
+        ring.write(from: [Int16](repeating: 10000, count: 160))
+        let (_, none) = silent.render(into: output, count: 320, from: ring)
+        XCTAssertEqual(none, 0)
+        XCTAssertEqual(output[200], 0)
+    }
+}
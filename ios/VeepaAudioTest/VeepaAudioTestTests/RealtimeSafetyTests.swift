@@ -0,0 +1,198 @@
+//
+//  RealtimeSafetyTests.swift
+//  VeepaAudioTestTests
+//
+//  Real-time safety sanitizer: allocations and locks inside a real-time
+//  scope are recorded with a stack, nothing outside is, and the playout
+//  render path (also while profiles change) and the lock-free playback
+//  ring stay clean. RealtimeSafeTestCase makes any violation during
+//  a benchmark fail it.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+/// Base class for tests and benchmarks of real-time code: a violation
+/// recorded while the test runs fails it, listing the call sites. Every
+/// benchmark class derives from it, so Scripts/run-benchmarks.sh fails on
+/// any allocation or lock on a real-time thread during a benchmark.
+class RealtimeSafeTestCase: XCTestCase {
+
+    override func setUp() {
+        super.setUp()
+        RealtimeSanitizer.install()
+        RealtimeSanitizer.reset()
+    }
+
+    override func tearDown() {
+        if RealtimeSanitizer.violationCount > 0 {
+            XCTFail(RealtimeSanitizer.report())
+            RealtimeSanitizer.reset()
+        }
+        super.tearDown()
+    }
+}
+
+final class RealtimeSafetyTests: XCTestCase {
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        guard RealtimeSanitizer.install() else {
+            throw XCTSkip("Built without RT_SANITIZER")
+        }
+        RealtimeSanitizer.reset()
+    }
+
+    override func tearDown() {
+        RealtimeSanitizer.reset()
+        super.tearDown()
+    }
+
+    // MARK: - Detection
+
+    func testFlagsAllocationAndLocksInRealtimeScope() {
+        let lock = NSLock()
+        RealtimeSanitizer.realtime {
+            for _ in 0..<3 {
+                let block = malloc(64)
+                free(block)
+            }
+            lock.lock()
+            lock.unlock()
+        }
+
+        let violations = RealtimeSanitizer.violations()
+        let functions = Set(violations.map(\.function))
+        XCTAssertTrue(functions.contains("malloc"), "\(functions)")
+        XCTAssertTrue(functions.contains("free"))
+        XCTAssertTrue(functions.contains("-[NSLock lock]"))
+        XCTAssertGreaterThanOrEqual(rt_sanitizer_kind_count(RT_VIOLATION_ALLOCATION), 3)
+        XCTAssertGreaterThanOrEqual(rt_sanitizer_kind_count(RT_VIOLATION_LOCK), 1)
+
+        // The same call site interns to one stack
+        let mallocStacks = Set(violations.filter { $0.function == "malloc" }.map(\.stackID))
+        XCTAssertEqual(mallocStacks.count, 1)
+        XCTAssertNotEqual(mallocStacks.first, 0)
+        XCTAssertFalse(RealtimeSanitizer.stack(mallocStacks.first ?? 0).isEmpty)
+        print(RealtimeSanitizer.report())
+    }
+
+    func testIgnoresOtherThreadsAndClosedScopes() {
+        rt_sanitizer_enter()
+        rt_sanitizer_enter()
+        rt_sanitizer_leave()
+        XCTAssertEqual(rt_sanitizer_in_realtime(), 1, "Scopes nest")
+        rt_sanitizer_leave()
+        XCTAssertEqual(rt_sanitizer_in_realtime(), 0)
+
+        let block = malloc(64)
+        free(block)
+        XCTAssertEqual(RealtimeSanitizer.violationCount, 0, "Not a real-time thread")
+    }
+
+    func testReportedViolationsCarryTheirKind() {
+        RealtimeSanitizer.realtime {
+            rt_sanitizer_report(RT_VIOLATION_REPORTED, "custom_unsafe_call")
+        }
+        let last = RealtimeSanitizer.violations().last
+        XCTAssertEqual(last?.function, "custom_unsafe_call")
+        XCTAssertEqual(last?.kind, "reported")
+    }
+
+    // MARK: - Hot Path
+
+    func testPlayoutRenderIsRealtimeSafe() {
+        let ring = CircularAudioBuffer(capacity: 32000)
+        let controller = PlayoutController(profile: .liveIntercom)
+        controller.configure(sampleRate: 16000, frameSamples: 320)
+        let frame = [Int16](repeating: 1000, count: 320)
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: 160)
+        defer { output.deallocate() }
+
+        // Prefill, steady playout, a burst past the cap, then starvation
+        for block in 0..<400 {
+            if block < 100 || (block >= 200 && block < 210) {
+                ring.write(from: frame)
+            }
+            RealtimeSanitizer.realtime {
+                _ = controller.render(into: output, count: 160, from: ring)
+            }
+        }
+
+        XCTAssertGreaterThan(controller.statistics.latencyTrims, 0)
+        XCTAssertGreaterThan(controller.statistics.underflows, 0)
+        XCTAssertEqual(RealtimeSanitizer.violationCount, 0, RealtimeSanitizer.report())
+    }
+
+    func testPlayoutRenderPicksUpProfilesWithoutLocks() {
+        let ring = CircularAudioBuffer(capacity: 32000)
+        let controller = PlayoutController(profile: .liveIntercom)
+        controller.configure(sampleRate: 16000, frameSamples: 320)
+        let frame = [Int16](repeating: 1000, count: 160)
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: 160)
+        defer { output.deallocate() }
+
+        // Profile switches and format changes from another thread, mid-render
+        let configurer = Thread {
+            for round in 0..<2_000 {
+                controller.apply(round % 2 == 0 ? .evidenceMonitoring : .liveIntercom)
+                if round % 100 == 0 {
+                    controller.configure(sampleRate: round % 200 == 0 ? 8000 : 16000, frameSamples: 160)
+                }
+            }
+        }
+        configurer.start()
+        while !configurer.isFinished {
+            ring.write(from: frame)
+            RealtimeSanitizer.realtime {
+                _ = controller.render(into: output, count: 160, from: ring)
+            }
+        }
+
+        // A new format restarts the cushion: one 320-sample frame for live intercom
+        XCTAssertEqual(controller.profile.name, "live-intercom")
+        controller.configure(sampleRate: 16000, frameSamples: 320)
+        let shallow = CircularAudioBuffer(capacity: 1000)
+        shallow.write(from: [Int16](repeating: 1000, count: 200))
+        XCTAssertEqual(controller.render(into: output, count: 160, from: shallow).received, 0)
+        shallow.write(from: [Int16](repeating: 1000, count: 200))
+        XCTAssertEqual(controller.render(into: output, count: 160, from: shallow).received, 160)
+        XCTAssertEqual(RealtimeSanitizer.violationCount, 0, RealtimeSanitizer.report())
+    }
+
+    func testRingHandsOffWithoutLocksOrTornReads() {
+        // Small ring and a fast producer: reads race overflows all the time
+        let ring = CircularAudioBuffer(capacity: 1000)
+        let blocks = 20_000
+        let producer = Thread {
+            var frame = [Int16](repeating: 0, count: 333)
+            var next: Int16 = 0
+            for _ in 0..<blocks {
+                for i in frame.indices {
+                    frame[i] = next
+                    next = next == .max ? 0 : next + 1
+                }
+                ring.write(from: frame)
+            }
+        }
+        producer.start()
+
+        let output = UnsafeMutablePointer<Int16>.allocate(capacity: 160)
+        defer { output.deallocate() }
+        var torn = 0
+        var read = 0
+        while !producer.isFinished || ring.availableSamples > 0 {
+            let count = RealtimeSanitizer.realtime { ring.read(into: output, count: 160) }
+            read += count
+            for i in 1..<max(count, 1) where output[i] != (output[i - 1] == .max ? 0 : output[i - 1] + 1) {
+                torn += 1
+            }
+        }
+
+        XCTAssertGreaterThan(read, 0)
+        XCTAssertEqual(torn, 0, "Every block read is a contiguous run of what was written")
+        XCTAssertEqual(ring.totalSamplesWritten, UInt64(blocks * 333))
+        XCTAssertEqual(ring.totalSamplesRead + ring.overflowCount, ring.totalSamplesWritten)
+        XCTAssertEqual(RealtimeSanitizer.violationCount, 0, RealtimeSanitizer.report())
+    }
+}
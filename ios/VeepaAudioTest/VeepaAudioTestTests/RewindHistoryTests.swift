@@ -0,0 +1,99 @@
+//
+//  RewindHistoryTests.swift
+//  VeepaAudioTestTests
+//
+//  Live-rewind history: memory is fixed by the configuration, ranges come
+//  back by arrival time, the oldest frames give way, and clips export as
+//  WAV and capture archive segments.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class RewindHistoryTests: XCTestCase {
+
+    private func makeHistory(seconds: Int) throws -> RewindHistory {
+        var configuration = RewindHistory.Configuration()
+        configuration.seconds = seconds
+        configuration.maxSampleRate = 8000
+        return try RewindHistory(name: "test", sampleRate: 8000, configuration: configuration)
+    }
+
+    /// Record 20 ms frames whose bytes are the frame number, 1 ms apart
+    @discardableResult
+    private func record(_ history: RewindHistory, frames count: Int) -> [UInt64] {
+        var arrivals: [UInt64] = []
+        var payload = [UInt8](repeating: 0, count: 160)
+        for frameNo in 0..<count {
+            for index in payload.indices {
+                payload[index] = UInt8(truncatingIfNeeded: frameNo)
+            }
+            arrivals.append(pipeline_trace_now())
+            history.record(payload, length: 160, frameNo: UInt32(frameNo), timestamp: UInt32(frameNo * 20))
+            usleep(1000)
+        }
+        return arrivals
+    }
+
+    func testMemoryIsBoundedByConfiguration() throws {
+        let history = try makeHistory(seconds: 60)
+        // 60 s × 8000 bytes → 512 KB payload ring, 60 × 50 frames → 4096-entry index
+        XCTAssertEqual(history.memoryBytes, 512 * 1024 + 4096 * 32)
+    }
+
+    func testClipsComeBackByArrivalTime() throws {
+        let history = try makeHistory(seconds: 10)
+        let arrivals = record(history, frames: 50)
+
+        let all = history.clip(last: 10)
+        XCTAssertEqual(all.frames.map(\.frame_no), Array(0..<50))
+        XCTAssertEqual(all.sampleCount, 50 * 160)
+        XCTAssertEqual(all.duration, 1.0, accuracy: 0.001)
+
+        let middle = history.clip(from: arrivals[20], to: arrivals[30])
+        XCTAssertEqual(middle.frames.map(\.frame_no), Array(20..<30))
+        XCTAssertEqual(middle.payload[0], 20)
+        XCTAssertEqual(middle.payload[middle.payload.count - 1], 29)
+        var expected: Int16 = 0
+        var alaw: UInt8 = 20
+        g711_alaw_decode(&alaw, &expected, 1)
+        let decoded = middle.decoded()
+        XCTAssertEqual(decoded.count, 10 * 160)
+        XCTAssertEqual(decoded[0], expected)
+    }
+
+    func testOldestFramesGiveWay() throws {
+        let history = try makeHistory(seconds: 1)
+        record(history, frames: 100)
+
+        // 8192 payload bytes hold 51 whole frames
+        let clip = history.clip(last: 60)
+        XCTAssertEqual(clip.frames.count, 51)
+        XCTAssertEqual(clip.frames.first?.frame_no, 49)
+        XCTAssertEqual(clip.frames.last?.frame_no, 99)
+        XCTAssertGreaterThan(history.availableSeconds, 0)
+    }
+
+    func testExportsWAVAndArchiveClips() throws {
+        let history = try makeHistory(seconds: 10)
+        record(history, frames: 25)
+        let directory = FileManager.default.temporaryDirectory
+            .appendingPathComponent("RewindHistoryTests-\(UUID().uuidString)", isDirectory: true)
+        defer { try? FileManager.default.removeItem(at: directory) }
+
+        let wavURL = try history.exportClip(last: 10, as: .wav, to: directory)
+        let wav = try Data(contentsOf: wavURL)
+        XCTAssertEqual(wav.count, Int(WAV_HEADER_SIZE) + 25 * 160 * 2)
+
+        let archiveURL = try history.exportClip(last: 10, as: .vaca, to: directory)
+        let archive = try Data(contentsOf: archiveURL)
+        var frames: UInt64 = 0
+        var samples: UInt64 = 0
+        archive.withUnsafeBytes { capture_archive_scan($0.baseAddress!, archive.count, &frames, &samples) }
+        XCTAssertEqual(frames, 25)
+        XCTAssertEqual(samples, 25 * 160)
+
+        let empty = try makeHistory(seconds: 10)
+        XCTAssertThrowsError(try empty.exportClip(last: 10, to: directory))
+    }
+}
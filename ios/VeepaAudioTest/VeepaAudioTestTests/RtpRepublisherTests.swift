@@ -0,0 +1,86 @@
+//
+//  RtpRepublisherTests.swift
+//  VeepaAudioTestTests
+//
+//  Emulator frames → AudioHookBridge → RTP/PCMA on a loopback socket:
+//  payload untouched, header fields derived from frameno/timestamp.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class RtpRepublisherTests: XCTestCase {
+
+    /// Bound non-blocking loopback UDP socket and its port
+    private func makeReceiver() throws -> (fd: Int32, port: UInt16) {
+        let fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)
+        XCTAssertGreaterThanOrEqual(fd, 0)
+
+        var address = sockaddr_in()
+        address.sin_family = sa_family_t(AF_INET)
+        address.sin_addr.s_addr = inet_addr("127.0.0.1")
+        var length = socklen_t(MemoryLayout<sockaddr_in>.size)
+        let bound = withUnsafeMutablePointer(to: &address) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) { pointer -> Bool in
+                bind(fd, pointer, length) == 0 && getsockname(fd, pointer, &length) == 0
+            }
+        }
+        XCTAssertTrue(bound)
+        _ = fcntl(fd, F_SETFL, O_NONBLOCK)
+        return (fd, UInt16(bigEndian: address.sin_port))
+    }
+
+    private func receiveAll(_ fd: Int32) -> [[UInt8]] {
+        var packets: [[UInt8]] = []
+        let capacity = 2048
+        var buffer = [UInt8](repeating: 0, count: capacity)
+        while true {
+            let n = recv(fd, &buffer, capacity, 0)
+            if n <= 0 { break }
+            packets.append(Array(buffer[0..<n]))
+        }
+        return packets
+    }
+
+    func testFramesArePublishedUnchangedWithDerivedHeaders() throws {
+        let receiver = try makeReceiver()
+        defer { close(receiver.fd) }
+
+        let republisher = try XCTUnwrap(RtpRepublisher(sampleRate: 16000))
+        XCTAssertTrue(republisher.addSubscriber(port: receiver.port))
+        republisher.start()
+        defer { republisher.stop() }
+
+        // Frame 3 is "lost" upstream
+        let emulator = CameraEmulator()
+        var sent: [CameraEmulator.Frame] = []
+        for _ in 1...5 {
+            let frame = emulator.nextFrame()
+            if frame.frameNo == 3 { continue }
+            sent.append(frame)
+            frame.payload.withUnsafeBufferPointer {
+                AudioHookBridge.shared.injectAlawFrame($0.baseAddress!, length: $0.count,
+                                                       frameNo: frame.frameNo, timestamp: frame.timestamp)
+            }
+        }
+
+        let packets = receiveAll(receiver.fd)
+        XCTAssertEqual(packets.count, sent.count)
+        guard packets.count == sent.count else { return }
+
+        func sequence(_ p: [UInt8]) -> UInt16 { UInt16(p[2]) << 8 | UInt16(p[3]) }
+        func timestamp(_ p: [UInt8]) -> UInt32 { p[4...7].reduce(0) { $0 << 8 | UInt32($1) } }
+
+        for (packet, frame) in zip(packets, sent) {
+            XCTAssertEqual(packet[0], 0x80, "RTP version 2")
+            XCTAssertEqual(packet[1] & 0x7F, republisher.payloadType)
+            XCTAssertEqual(Array(packet[12...]), frame.payload, "Payload must be the original A-law bytes")
+        }
+
+        // Sequence skips the lost frame; timestamps advance by samples
+        XCTAssertEqual(sequence(packets[1]) &- sequence(packets[0]), 1)
+        XCTAssertEqual(sequence(packets[2]) &- sequence(packets[1]), 2)
+        XCTAssertEqual(timestamp(packets[2]) &- timestamp(packets[1]), 2 * 480)
+        XCTAssertEqual(republisher.stats.upstream_lost, 1)
+    }
+}
@@ -0,0 +1,79 @@
+//
+//  SessionCpuMeterTests.swift
+//  VeepaAudioTestTests
+//
+//  Per-session CPU accounting: work is charged to the right session and
+//  stage, sleeping costs nothing, concurrent charges add up exactly, and
+//  samples report CPU-ms/s since the previous sample.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class SessionCpuMeterTests: RealtimeSafeTestCase {
+
+    /// Spin for roughly `milliseconds` of CPU time
+    private func burn(milliseconds: Double) {
+        let start = session_cpu_thread_ns()
+        var x = 0.0
+        while Double(session_cpu_thread_ns() - start) < milliseconds * 1e6 {
+            for i in 0..<1000 { x += sqrt(Double(i)) }
+        }
+        XCTAssertGreaterThan(x, 0)
+    }
+
+    func testWorkIsChargedToItsSessionAndStage() throws {
+        let meter = try SessionCpuMeter(capacity: 4)
+
+        meter.measure(1, .decode) { burn(milliseconds: 20) }
+        meter.measure(2, .receive) { Thread.sleep(forTimeInterval: 0.05) }
+
+        let decode = meter.totalNanoseconds(1, .decode)
+        XCTAssertGreaterThanOrEqual(decode, 20_000_000)
+        XCTAssertLessThan(decode, 200_000_000)
+        XCTAssertEqual(meter.totalNanoseconds(1, .render), 0)
+        XCTAssertEqual(meter.totalNanoseconds(0, .decode), 0)
+        XCTAssertLessThan(meter.totalNanoseconds(2, .receive), 5_000_000, "Sleeping is not CPU time")
+
+        // Out-of-range slots are ignored rather than corrupting a neighbour
+        meter.charge(session_slot.max, .decode, nanoseconds: 1)
+        meter.charge(4, .decode, nanoseconds: 1)
+        XCTAssertEqual(meter.totalNanoseconds(3, .decode), 0)
+    }
+
+    func testConcurrentChargesAddUp() throws {
+        let meter = try SessionCpuMeter(capacity: 8)
+        DispatchQueue.concurrentPerform(iterations: 8) { worker in
+            for _ in 0..<10_000 {
+                meter.charge(session_slot(worker % 2), .process, nanoseconds: 3)
+            }
+        }
+        XCTAssertEqual(meter.totalNanoseconds(0, .process), 4 * 10_000 * 3)
+        XCTAssertEqual(meter.totalNanoseconds(1, .process), 4 * 10_000 * 3)
+    }
+
+    func testSamplesReportRatesSinceThePreviousSample() throws {
+        let meter = try SessionCpuMeter(capacity: 4)
+        _ = meter.sample()
+
+        meter.measure(0, .render) { burn(milliseconds: 10) }
+        meter.charge(3, .publish, nanoseconds: 1_000_000)
+        let sample = meter.sample()
+
+        XCTAssertGreaterThan(sample.windowSeconds, 0)
+        XCTAssertEqual(sample.sessions.count, 4)
+        XCTAssertGreaterThan(sample.sessions[0][.render], 0)
+        XCTAssertEqual(sample.sessions[0].msPerSecond, sample.sessions[0][.render], accuracy: 1e-9)
+        XCTAssertEqual(sample.sessions[3][.publish], 1.0 / sample.windowSeconds, accuracy: 1e-6)
+        XCTAssertEqual(sample.host.msPerSecond, sample.sessions[0].msPerSecond + sample.sessions[3].msPerSecond,
+                       accuracy: 1e-6)
+        XCTAssertEqual(sample.ranked.map(\.slot), [0, 3], "Most expensive first")
+        print("⏱️ \(sample.sessions[0].description)")
+
+        // Nothing charged since: zero, and a reset slot never goes negative
+        meter.resetSession(0)
+        let idle = meter.sample()
+        XCTAssertEqual(idle.host.msPerSecond, 0)
+        XCTAssertTrue(idle.ranked.isEmpty)
+    }
+}
@@ -0,0 +1,174 @@
+//
+//  SessionTableTests.swift
+//  VeepaAudioTestTests
+//
+//  Structure-of-arrays session state: slot lifecycle, per-frame updates and
+//  sweep results, and the cost of sweeping 5,000 sessions compared with the
+//  same fields spread across per-session objects.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class SessionTableTests: RealtimeSafeTestCase {
+
+    private let config = session_sweep_config(stale_after_ms: 20_000, keepalive_interval_ms: 500,
+                                              low_watermark: 100, silence_cb: -6000)
+
+    func testFramesAndSweep() throws {
+        let table = try XCTUnwrap(session_table_create(8))
+        defer { session_table_destroy(table) }
+
+        let a = session_table_acquire(table)
+        let b = session_table_acquire(table)
+        XCTAssertEqual([a, b], [0, 1])
+
+        session_table_on_frame(table, a, 5, 100, -20.0, -10.0, 1)
+        session_table_on_frame(table, a, 8, 160, -18.5, -9.0, 0)
+        let columns = session_table_columns(table)!.pointee
+        XCTAssertEqual(columns.frames[Int(a)], 2)
+        XCTAssertEqual(columns.lost_frames[Int(a)], 2)
+        XCTAssertEqual(columns.decode_skipped[Int(a)], 1)
+        XCTAssertEqual(columns.level_cb[Int(a)], -1850)
+        XCTAssertEqual(columns.level_cb[Int(b)], Int16(SESSION_LEVEL_SILENT))
+
+        session_table_schedule_keepalive(table, b, 1)
+        var stale = [session_slot](repeating: 0, count: 4)
+        var due = [session_slot](repeating: 0, count: 4)
+        var result = session_sweep_result()
+        stale.withUnsafeMutableBufferPointer { staleList in
+            due.withUnsafeMutableBufferPointer { dueList in
+                result.stale = staleList.baseAddress
+                result.stale_capacity = 4
+                result.due = dueList.baseAddress
+                result.due_capacity = 4
+                var sweepConfig = config
+                session_table_sweep(table, 25_000, &sweepConfig, &result)
+            }
+        }
+        XCTAssertEqual(result.active, 2)
+        XCTAssertEqual(result.audible, 1)
+        XCTAssertEqual(result.loudest, a)
+        XCTAssertEqual(result.stale_count, 1)
+        XCTAssertEqual(stale[0], a)
+        XCTAssertEqual(result.due_count, 1)
+        XCTAssertEqual(due[0], b)
+        XCTAssertEqual(columns.keepalive_due_ms[Int(b)], 25_500, "Due keep-alive is rescheduled")
+
+        session_table_release(table, b)
+        XCTAssertEqual(session_table_high_water(table), 1)
+        XCTAssertEqual(session_table_acquire(table), 1, "Lowest free slot is reused")
+    }
+
+    // MARK: - Sweep Benchmark
+
+    /// The same hot fields as per-session objects: a session with its stats
+    /// and keep-alive timer as separate heap objects
+    private final class SessionStats {
+        var frames: UInt32 = 0
+        var arrivalMs: UInt32 = 0
+        var levelCb: Int16 = Int16(SESSION_LEVEL_SILENT)
+    }
+
+    private final class KeepAlive {
+        var dueMs: UInt32 = 0
+    }
+
+    private final class Session {
+        var name = ""
+        var active = true
+        var ringWrite: UInt32 = 0
+        var ringRead: UInt32 = 0
+        let stats = SessionStats()
+        let keepAlive = KeepAlive()
+    }
+
+    func testSweepOf5000Sessions() throws {
+        let count = 5000
+        let sweeps = 1000
+        let table = try XCTUnwrap(session_table_create(UInt32(count)))
+        defer { session_table_destroy(table) }
+        let columns = session_table_columns(table)!.pointee
+
+        var generator = SystemRandomNumberGenerator()
+        var objects: [Session] = []
+        var scatter: [[UInt8]] = []
+        for index in 0..<count {
+            let slot = session_table_acquire(table)
+            let level = -Double(Int.random(in: 0..<90, using: &generator))
+            session_table_on_frame(table, slot, 1, 0, level, level, 1)
+            session_table_schedule_keepalive(table, slot, UInt32.random(in: 1...10_000, using: &generator))
+            session_table_set_ring(table, slot, UInt32.random(in: 0..<2000, using: &generator), 0)
+
+            let session = Session()
+            session.name = "camera-\(index)"
+            session.stats.frames = 1
+            session.stats.arrivalMs = columns.last_arrival_ms[Int(slot)]
+            session.stats.levelCb = columns.level_cb[Int(slot)]
+            session.keepAlive.dueMs = columns.keepalive_due_ms[Int(slot)]
+            session.ringWrite = columns.ring_write[Int(slot)]
+            objects.append(session)
+            scatter.append([UInt8](repeating: 0, count: Int.random(in: 64..<512, using: &generator)))
+        }
+        objects.shuffle(using: &generator)
+        scatter.removeAll()
+
+        var staleList = [session_slot](repeating: 0, count: count)
+        var dueList = [session_slot](repeating: 0, count: count)
+
+        // Structure of arrays
+        var soaTotal = 0
+        let soaStart = Date()
+        staleList.withUnsafeMutableBufferPointer { stale in
+            dueList.withUnsafeMutableBufferPointer { due in
+                var sweepConfig = config
+                for sweep in 0..<sweeps {
+                    var result = session_sweep_result()
+                    result.stale = stale.baseAddress
+                    result.stale_capacity = UInt32(count)
+                    result.due = due.baseAddress
+                    result.due_capacity = UInt32(count)
+                    session_table_sweep(table, UInt32(sweep * 5), &sweepConfig, &result)
+                    soaTotal += Int(result.audible + result.due_count + result.starving)
+                }
+            }
+        }
+        let soa = Date().timeIntervalSince(soaStart)
+
+        // Per-session objects
+        var objectTotal = 0
+        let objectStart = Date()
+        for sweep in 0..<sweeps {
+            let now = UInt32(sweep * 5)
+            var audible = 0, due = 0, starving = 0, stale = 0
+            var loudest = Int16(SESSION_LEVEL_SILENT)
+            for (index, session) in objects.enumerated() where session.active {
+                if session.stats.frames > 0 && now &- session.stats.arrivalMs > config.stale_after_ms {
+                    staleList[stale] = session_slot(index)
+                    stale += 1
+                }
+                if session.ringWrite &- session.ringRead < config.low_watermark { starving += 1 }
+                if session.stats.levelCb > config.silence_cb {
+                    audible += 1
+                    loudest = max(loudest, session.stats.levelCb)
+                }
+                let dueMs = session.keepAlive.dueMs
+                if dueMs != 0 && Int32(bitPattern: now &- dueMs) >= 0 {
+                    dueList[due] = session_slot(index)
+                    due += 1
+                    session.keepAlive.dueMs = now &+ config.keepalive_interval_ms
+                }
+            }
+            objectTotal += audible + due + starving
+        }
+        let objectSweep = Date().timeIntervalSince(objectStart)
+
+        let perSession = { (seconds: TimeInterval) in seconds / Double(sweeps * count) * 1e9 }
+        print("⏱️ Sweep of \(count) sessions: SoA \(String(format: "%.1f", perSession(soa))) ns/session, "
+              + "objects \(String(format: "%.1f", perSession(objectSweep))) ns/session "
+              + "(×\(String(format: "%.2f", objectSweep / soa)))")
+
+        XCTAssertEqual(soaTotal, objectTotal, "Both layouts must compute the same sweep")
+        XCTAssertLessThan(soa, objectSweep)
+    }
+}
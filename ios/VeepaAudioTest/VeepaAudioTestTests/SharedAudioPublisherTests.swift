@@ -0,0 +1,79 @@
+//
+//  SharedAudioPublisherTests.swift
+//  VeepaAudioTestTests
+//
+//  Emulator frames → AudioHookBridge → shared-memory ring → read-only reader:
+//  frames arrive decoded, in order, with frameNo/timestamp, and a reader that
+//  falls behind is told how many frames it lost.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class SharedAudioPublisherTests: XCTestCase {
+
+    private func inject(_ frame: CameraEmulator.Frame) {
+        frame.payload.withUnsafeBufferPointer {
+            AudioHookBridge.shared.injectAlawFrame($0.baseAddress!, length: $0.count,
+                                                   frameNo: frame.frameNo, timestamp: frame.timestamp)
+        }
+    }
+
+    func testReaderSeesDecodedFramesInOrder() throws {
+        let publisher = try SharedAudioPublisher(streamName: "vat-test-\(getpid())", slotCount: 16)
+        publisher.start()
+        defer { publisher.stop() }
+
+        var error: Int32 = 0
+        let reader = try XCTUnwrap(shm_audio_reader_open(publisher.streamName, &error))
+        defer { shm_audio_reader_close(reader) }
+        XCTAssertEqual(shm_audio_reader_header(reader).pointee.sample_rate, 16000)
+
+        let emulator = CameraEmulator()
+        let frames = (0..<4).map { _ in emulator.nextFrame() }
+        frames.forEach(inject)
+        XCTAssertEqual(shm_audio_reader_wait(reader, 100), 1)
+
+        var samples = [Int16](repeating: 0, count: 1024)
+        let capacity = UInt32(samples.count)
+        for frame in frames {
+            var info = shm_audio_frame_view()
+            let count = samples.withUnsafeMutableBufferPointer {
+                shm_audio_reader_read(reader, $0.baseAddress!, capacity, &info)
+            }
+            XCTAssertEqual(Int(count), frame.payload.count)
+            XCTAssertEqual(info.frame_no, frame.frameNo)
+            XCTAssertEqual(info.timestamp_ms, frame.timestamp)
+            XCTAssertEqual(info.lost, 0)
+
+            var expected = [Int16](repeating: 0, count: frame.payload.count)
+            g711_alaw_decode(frame.payload, &expected, frame.payload.count)
+            XCTAssertEqual(Array(samples[0..<Int(count)]), expected)
+        }
+        XCTAssertEqual(shm_audio_reader_wait(reader, 0), 0, "Nothing left to read")
+    }
+
+    func testSlowReaderIsToldWhatItLost() throws {
+        let publisher = try SharedAudioPublisher(streamName: "vat-slow-\(getpid())", slotCount: 8)
+        publisher.start()
+        defer { publisher.stop() }
+
+        var error: Int32 = 0
+        let reader = try XCTUnwrap(shm_audio_reader_open(publisher.streamName, &error))
+        defer { shm_audio_reader_close(reader) }
+
+        let emulator = CameraEmulator()
+        let frames = (0..<20).map { _ in emulator.nextFrame() }
+        frames.forEach(inject)
+
+        var view = shm_audio_frame_view()
+        XCTAssertEqual(shm_audio_reader_next(reader, &view), Int32(SHM_AUDIO_FRAME))
+        XCTAssertEqual(view.lost, 12, "Only the newest 8 frames are still in the ring")
+        XCTAssertEqual(view.frame_no, frames[12].frameNo)
+        XCTAssertEqual(shm_audio_reader_validate(reader, &view), 1)
+    }
+
+    func testInvalidNameIsRejected() {
+        XCTAssertThrowsError(try SharedAudioPublisher(streamName: "bad/name"))
+    }
+}
@@ -0,0 +1,55 @@
+//
+//  StartupBenchmarkTests.swift
+//  VeepaAudioTestTests
+//
+//  Time-to-first-audio benchmark (cold and warm) against CameraEmulator.
+//  Fails when a start exceeds its budget so startup regressions break the build.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+@MainActor
+final class StartupBenchmarkTests: RealtimeSafeTestCase {
+
+    /// Budgets for "connect requested" → "first non-silent sample rendered"
+    /// on the local pipeline (the P2P leg is replaced by the emulator).
+    /// Tighten these when a startup optimization lands.
+    private let coldBudget: TimeInterval = 0.60
+    private let warmBudget: TimeInterval = 0.25
+
+    func testColdStartTimeToFirstAudio() async throws {
+        print("\n🧪 TEST: Cold start time-to-first-audio")
+
+        let result = try await StartupBenchmark.run(.cold)
+        let ttfa = try XCTUnwrap(result.timeToFirstAudio)
+
+        print(result.description)
+        XCTAssertNotNil(result.traceURL, "Trace should be exported")
+        XCTAssertLessThan(ttfa, coldBudget, "Cold time-to-first-audio regressed")
+    }
+
+    func testWarmStartTimeToFirstAudio() async throws {
+        print("\n🧪 TEST: Warm start time-to-first-audio")
+
+        let result = try await StartupBenchmark.run(.warm)
+        let ttfa = try XCTUnwrap(result.timeToFirstAudio)
+
+        print(result.description)
+        XCTAssertLessThan(ttfa, warmBudget, "Warm time-to-first-audio regressed")
+    }
+
+    func testEveryPhaseIsMeasured() async throws {
+        print("\n🧪 TEST: Phase breakdown is complete")
+
+        let result = try await StartupBenchmark.run(.warm)
+
+        for phase in StartupTrace.phases {
+            XCTAssertNotNil(
+                result.interval(from: phase.from, to: phase.to),
+                "Phase \(phase.name) missing from the trace"
+            )
+        }
+        XCTAssertNotNil(result.bringUp?.timing(for: .audioEngine), "Bring-up steps should be attached")
+    }
+}
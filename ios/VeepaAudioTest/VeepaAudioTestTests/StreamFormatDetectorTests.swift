@@ -0,0 +1,110 @@
+//
+//  StreamFormatDetectorTests.swift
+//  VeepaAudioTestTests
+//
+//  Stream format detection: emulated 8 kHz and 16 kHz cameras are told
+//  apart within the first second from timestamps, from arrival cadence
+//  when timestamps are useless, and the playback bounds follow.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class StreamFormatDetectorTests: XCTestCase {
+
+    /// Feed emulator frames with simulated arrival times until detection completes
+    /// - Parameters:
+    ///   - jitterMs: Random extra delay per frame
+    ///   - lossEvery: Drop every n-th frame (0 = none)
+    ///   - timestamps: Rewrites the emulator's timestamp (e.g. to break it)
+    /// - Returns: Detected format and the arrival time it took
+    private func detect(sampleRate: Int, frameSamples: Int, jitterMs: Int = 0, lossEvery: Int = 0,
+                        timestamps: (UInt32) -> UInt32 = { $0 }) -> (stream_format, UInt32) {
+        var configuration = CameraEmulator.Configuration()
+        configuration.sampleRate = sampleRate
+        configuration.frameSamples = frameSamples
+        let emulator = CameraEmulator(configuration: configuration)
+
+        var detector = stream_format_detector()
+        stream_format_detector_init(&detector, nil)
+        var generator = SystemRandomNumberGenerator()
+
+        let start: UInt32 = 5000
+        var arrival = start
+        for index in 0..<200 {
+            let frame = emulator.nextFrame()
+            if lossEvery > 0 && index % lossEvery == lossEvery - 1 { continue }
+            let jitter = jitterMs > 0 ? UInt32(Int.random(in: 0..<jitterMs, using: &generator)) : 0
+            arrival = start + frame.timestamp + jitter
+            if stream_format_detector_observe(&detector, frame.frameNo, UInt32(frame.payload.count),
+                                              timestamps(frame.timestamp), arrival) != 0 {
+                break
+            }
+        }
+        XCTAssertEqual(detector.decided, 1)
+        return (detector.format, arrival - start)
+    }
+
+    // MARK: - Detection
+
+    func testDetectsRateFromTimestamps() {
+        for (rate, frameSamples, frameMs) in [(8000, 480, 60), (16000, 480, 30), (8000, 160, 20), (16000, 320, 20)] {
+            let (format, elapsed) = detect(sampleRate: rate, frameSamples: frameSamples, jitterMs: 25, lossEvery: 7)
+            XCTAssertEqual(format.sample_rate, UInt32(rate), "\(rate) Hz / \(frameSamples)")
+            XCTAssertEqual(format.frame_samples, UInt32(frameSamples))
+            XCTAssertEqual(format.frame_ms, UInt32(frameMs))
+            XCTAssertEqual(format.source, STREAM_FORMAT_TIMESTAMPS)
+            XCTAssertLessThan(elapsed, 400, "Timestamps should decide well within the first second")
+        }
+    }
+
+    func testFallsBackToArrivalCadence() {
+        // Timestamps that never advance, and timestamps in seconds
+        for broken in [{ (_: UInt32) in UInt32(0) }, { (ms: UInt32) in ms / 1000 }] {
+            for rate in [8000, 16000] {
+                let (format, elapsed) = detect(sampleRate: rate, frameSamples: 320, jitterMs: 20, timestamps: broken)
+                XCTAssertEqual(format.sample_rate, UInt32(rate))
+                XCTAssertEqual(format.source, STREAM_FORMAT_ARRIVAL)
+                XCTAssertLessThanOrEqual(elapsed, 1100)
+            }
+        }
+    }
+
+    func testFinishWithoutEvidenceUsesFallback() {
+        var detector = stream_format_detector()
+        stream_format_detector_init(&detector, nil)
+        _ = stream_format_detector_observe(&detector, 1, 480, 0, 0)
+
+        let format = stream_format_detector_finish(&detector)
+        XCTAssertEqual(format.sample_rate, 8000)
+        XCTAssertEqual(format.frame_samples, 480)
+        XCTAssertEqual(format.source, STREAM_FORMAT_FALLBACK)
+    }
+
+    func testSnapRejectsOddRates() {
+        XCTAssertEqual(stream_format_snap_rate(15_700, 80), 16000)
+        XCTAssertEqual(stream_format_snap_rate(8_150, 80), 8000)
+        XCTAssertEqual(stream_format_snap_rate(12_500, 80), 0)
+    }
+
+    // MARK: - Playback Configuration
+
+    func testJitterBoundsScaleWithFormat() {
+        let narrow = JitterBufferBounds(sampleRate: 8000, frameSamples: 480)
+        XCTAssertEqual(narrow.targetSamples, 960, "Two 60 ms frames")
+        XCTAssertEqual(narrow.maxSamples, 2400, "300 ms at 8 kHz")
+
+        let wide = JitterBufferBounds(sampleRate: 16000, frameSamples: 320)
+        XCTAssertEqual(wide.targetSamples, 640)
+        XCTAssertEqual(wide.maxSamples, 4800)
+    }
+
+    func testDiscardDropsOldestSamples() {
+        let ring = CircularAudioBuffer(capacity: 16)
+        ring.write(from: (1...10).map { Int16($0) })
+
+        XCTAssertEqual(ring.discard(count: 4), 4)
+        XCTAssertEqual(ring.read(count: 6), (5...10).map { Int16($0) })
+        XCTAssertEqual(ring.discard(count: 3), 0)
+    }
+}
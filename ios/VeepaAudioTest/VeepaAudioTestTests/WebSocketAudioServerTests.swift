@@ -0,0 +1,73 @@
+//
+//  WebSocketAudioServerTests.swift
+//  VeepaAudioTestTests
+//
+//  Emulator frames → AudioHookBridge → WebSocket fan-out: every listener
+//  gets the format message, then each frame once with its frameNo/timestamp.
+//
+
+import XCTest
+@testable import VeepaAudioTest
+
+final class WebSocketAudioServerTests: XCTestCase {
+
+    private func receive(_ task: URLSessionWebSocketTask) async throws -> URLSessionWebSocketTask.Message {
+        try await task.receive()
+    }
+
+    private func littleEndian32(_ data: Data, at offset: Int) -> UInt32 {
+        data[data.startIndex + offset..<data.startIndex + offset + 4].reversed().reduce(0) { $0 << 8 | UInt32($1) }
+    }
+
+    func testEveryListenerReceivesEachDecodedFrame() async throws {
+        let server = try WebSocketAudioServer(payload: .pcm16)
+        server.start()
+        defer { server.stop() }
+
+        let url = try XCTUnwrap(URL(string: "ws://127.0.0.1:\(server.port)/"))
+        let listeners = (0..<3).map { _ in URLSession.shared.webSocketTask(with: url) }
+        listeners.forEach { $0.resume() }
+        defer { listeners.forEach { $0.cancel(with: .goingAway, reason: nil) } }
+
+        // The format message doubles as "handshake complete"
+        for listener in listeners {
+            guard case .string(let hello) = try await receive(listener) else {
+                return XCTFail("First message should be the format description")
+            }
+            XCTAssertTrue(hello.contains("\"codec\":\"pcm_s16le\""))
+            XCTAssertTrue(hello.contains("\"sampleRate\":16000"))
+        }
+
+        let emulator = CameraEmulator()
+        let frames = (0..<5).map { _ in emulator.nextFrame() }
+        for frame in frames {
+            frame.payload.withUnsafeBufferPointer {
+                AudioHookBridge.shared.injectAlawFrame($0.baseAddress!, length: $0.count,
+                                                       frameNo: frame.frameNo, timestamp: frame.timestamp)
+            }
+        }
+
+        for listener in listeners {
+            for frame in frames {
+                guard case .data(let message) = try await receive(listener) else {
+                    return XCTFail("Audio frames should be binary messages")
+                }
+                XCTAssertEqual(message.count, 8 + frame.payload.count * 2)
+                XCTAssertEqual(littleEndian32(message, at: 0), frame.frameNo)
+                XCTAssertEqual(littleEndian32(message, at: 4), frame.timestamp)
+            }
+        }
+
+        let stats = server.stats
+        XCTAssertEqual(stats.frames_published, UInt64(frames.count))
+        XCTAssertEqual(stats.connections, 3)
+        XCTAssertEqual(stats.clients_dropped, 0)
+    }
+
+    func testAcceptKeyMatchesRfc6455Example() {
+        var accept = [CChar](repeating: 0, count: 29)
+        let key = "dGhlIHNhbXBsZSBub25jZQ=="
+        ws_fanout_accept_key(key, key.utf8.count, &accept)
+        XCTAssertEqual(String(cString: accept), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=")
+    }
+}